@@ -0,0 +1,42 @@
+#define ARCH_BIT 64
+/* #undef HAVE_LIBFFTW3 */
+/* #undef HAVE_LIBFFTW3F */
+#define HAVE_LIBZ
+#define HAVE_LIBXML2
+/* #undef HAVE_LIBPNG */
+/* #undef HAVE_LIBJANSSON */
+
+#define HAVE_STDDEF_H
+#define HAVE_STDINT_H
+#define HAVE_STDLIB_H
+#define HAVE_STRING_H
+#define HAVE_STRINGS_H
+#define HAVE_SYS_TIME_H
+#define HAVE_UNISTD_H
+#define HAVE_REGEX_H
+#define HAVE_DIRENT_H
+
+#define HAVE_BZERO
+/* #undef HAVE_FLOOR */
+/* #undef HAVE_ROUND */
+/* #undef HAVE_LRNT */
+#define HAVE_GETTIMEOFDAY
+#define HAVE_MEMMOVE
+#define HAVE_MEMSET 
+#define HAVE_REGCOMP
+/* #undef HAVE_SQRT */
+/* #undef HAVE_MEMSET_PATTERN4 */
+/* #undef HAVE_GETLN */
+
+#define SIZEOF_CHAR 1
+#define SIZEOF_INT 4
+#define SIZEOF_SHORT 2
+#define SIZEOF_LONG 8
+
+#define INTERFACE_PROGRESS_OFF
+
+/* Define to 'inline', '__inline__' or '__inline' if that's what the C compiler
+   calls it, or to nothing if 'inline' is not supported under any name.  */
+#ifndef __cplusplus
+#define inline inline
+#endif
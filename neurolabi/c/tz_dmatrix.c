@@ -0,0 +1,1376 @@
+/* tz_matrix.a.t
+ * 
+ * 14-Aug-2007  Initial write:  Ting Zhao
+ */
+
+/*
+ * Template functions for matrix operation
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tz_cdefs.h"
+#ifdef HAVE_STRINGS_H
+#include <strings.h>
+#endif
+#include <math.h>
+#include "tz_objdef.h"
+#include "tz_error.h"
+#include "utilities.h"
+#include "tz_utilities.h"
+#include "tz_math.h"
+#include "tz_dmatrix.h"
+#include "tz_darray.h"
+
+static void dmatrix_error(const char *msg,const char *arg)
+{
+  fprintf(stderr,"\nError in tz_dmatrix:\n");
+  fprintf(stderr,msg,arg);
+  fprintf(stderr,"\n");
+  exit(1);
+}
+
+static inline size_t dmatrix_asize(const DMatrix* dm)
+{ return (matrix_size(dm->dim,dm->ndim)*sizeof(double)); }
+
+void Default_DMatrix(DMatrix *dm)
+{
+  dm->ndim = 0;
+  dm->array = NULL;
+}
+
+DEFINE_OBJECT_MANAGEMENT(DMatrix, array, asize, dmatrix)
+
+/* Make_DMatrix(): Create a double matrix.
+ *
+ * Args: dim - dimensions of the matrix
+ *       ndim - number of dimensions
+ *
+ * Return: a double matrix.
+ */
+DMatrix* Make_DMatrix(const dim_type dim[],ndim_type ndim)
+{
+  check_matrix(dim,ndim);
+
+  DMatrix *dm;
+  ndim_type i;
+
+  dm = new_dmatrix(matrix_size(dim,ndim)*sizeof(double),"Make_DMatrix");
+  dm->ndim = ndim;
+  for(i=0;i<ndim;i++)
+    dm->dim[i] = dim[i];
+
+  return dm;
+}
+
+DMatrix* Make_3d_DMatrix(dim_type width, dim_type height, dim_type depth)
+{
+  dim_type dim[3];
+  dim[0] = width;
+  dim[1] = height;
+  dim[2] = depth;
+  
+  return Make_DMatrix(dim,  3);
+}
+
+void DMatrix_Copy(DMatrix *des, const DMatrix *src)
+{
+  memcpy(des->array, src->array, dmatrix_asize(src));
+}
+
+/* Crop_DMatrix(): Crop matrix.
+ * 
+ * Note: The caller is responsible for clearing the returned matix.
+ *
+ * Args: dm - input matrix
+ *       offset - the offset from the starting corner of the cropped matrix to 
+ *                the starting corner of the original matrix.
+ *       dim - size of the output matrix
+ *
+ * Return: a double matrix.
+ */
+DMatrix* Crop_DMatrix(const DMatrix* dm,const int offset[],const dim_type dim[],
+		DMatrix *out)
+{
+  int crop = 0;
+  tz_uint32 i;
+
+  for(i=0;i<dm->ndim;i++) {
+    if(offset[i]!=0) {
+      crop = 1;
+      break;
+    }
+
+    if(dm->dim[i]!=dim[i]) {
+      crop = 1;
+      break;
+    }
+  }
+
+  if (out == NULL) {
+    out = Make_DMatrix(dim, dm->ndim);
+  }
+
+  if(!crop) {
+    DMatrix_Copy(out, dm);
+    return out;
+  }
+
+  dim_type src_start[TZ_MATRIX_MAX_DIM],des_start[TZ_MATRIX_MAX_DIM],
+    src_end[TZ_MATRIX_MAX_DIM],des_end[TZ_MATRIX_MAX_DIM];
+  
+  dim_type src_plane_offset[TZ_MATRIX_MAX_DIM],des_plane_offset[TZ_MATRIX_MAX_DIM],
+    src_offset[TZ_MATRIX_MAX_DIM],des_offset[TZ_MATRIX_MAX_DIM],src_pos,des_pos;
+  dim_type copy_length,total_rows,copy_dim[TZ_MATRIX_MAX_DIM];
+  int cur_dim,status[TZ_MATRIX_MAX_DIM];
+  
+  src_plane_offset[0] = 1;
+  des_plane_offset[0] = 1;
+
+  src_pos = 0;
+  des_pos = 0;
+  src_offset[0] = dm->dim[0];
+  des_offset[0] = dim[0];
+  total_rows = 1;
+  for(i=0;i<dm->ndim;i++) {
+    src_start[i] = imax2(offset[i],0);
+    des_start[i] = imax2(0,-offset[i]);
+    src_end[i] = imin2(dm->dim[i]-1,dim[i]+offset[i]-1);
+    des_end[i] = imin2(dim[i]-1,dm->dim[i]-offset[i]-1);
+    copy_dim[i] = des_end[i]-des_start[i]+1;
+    if(i>0) {
+      src_plane_offset[i] = src_plane_offset[i-1]*dm->dim[i-1];
+      des_plane_offset[i] = des_plane_offset[i-1]*dim[i-1];
+      src_offset[i] = src_offset[i-1]+(dm->dim[i]-1-src_end[i]+src_start[i])*src_plane_offset[i];
+      des_offset[i] = des_offset[i-1]+(dim[i]-1-des_end[i]+des_start[i])*des_plane_offset[i];
+      total_rows *= copy_dim[i];
+    }
+    src_pos += src_plane_offset[i]*src_start[i];
+    des_pos += des_plane_offset[i]*des_start[i];
+    
+    status[i] = 0;
+  }
+
+  copy_length = sizeof(double)*(des_end[0]-des_start[0]+1);
+
+  DMatrix_Set_Zero(out);
+  DMatrix* dm2 = out;
+
+  cur_dim = 0;
+  for(i=0;i<total_rows;i++) {
+    memcpy(dm2->array+des_pos,dm->array+src_pos,copy_length);
+
+    status[0]++; /* move one row */
+
+    if(cur_dim>0)
+      cur_dim = 0;
+    else {
+      while(status[cur_dim]==copy_dim[cur_dim+1]) {
+	status[cur_dim] = 0;
+	cur_dim++;	
+	if(cur_dim==dm->ndim-1)
+	  break;
+	status[cur_dim]++;
+      }
+    }
+
+#if 0
+    iarray_print2(status,dm->ndim,1);
+#endif
+
+    /* cur_dim>0: jump; cur_dim==0: move one row */
+    src_pos += src_offset[cur_dim];
+    des_pos += des_offset[cur_dim];
+  }
+
+  return out;
+}
+
+#define MATRIX_BLOCK_STATE_INC(state, inc_dim, ndim, dim)	\
+  {								\
+    state[1]++;							\
+    inc_dim = 1;						\
+    ndim_type k;						\
+    for (k = 1; k < ndim - 1; k++) {				\
+      if (state[k] == dim[k]) {					\
+	state[k] = src_offset[k];				\
+	state[k+1]++;						\
+	inc_dim = k + 1;					\
+      }								\
+    }								\
+  }
+
+
+void DMatrix_Copy_Block(DMatrix *des, const dim_type des_offset[], const DMatrix *src,
+		     const dim_type src_offset[])
+{
+  ASSERT(des->ndim == src->ndim, "Dimension unmatched");
+  
+  size_t row_size = sizeof(double) * (src->dim[0] - src_offset[0]);
+
+  ndim_t i;
+  dim_t state[TZ_MATRIX_MAX_DIM];
+  for (i = 0; i < TZ_MATRIX_MAX_DIM; i++) {
+    state[i] = src_offset[i];
+  }
+
+  int src_block_offset[TZ_MATRIX_MAX_DIM];
+  int src_area[TZ_MATRIX_MAX_DIM];
+  int des_area[TZ_MATRIX_MAX_DIM];
+  dim_t src_jump[TZ_MATRIX_MAX_DIM];
+  dim_t des_jump[TZ_MATRIX_MAX_DIM];
+  
+  src_jump[0] = 0;
+  des_jump[0] = 0; 
+  src_block_offset[0] = 1;
+  src_area[0] = src->dim[0];
+  des_area[0] = des->dim[0];
+
+  for (i = 1; i < src->ndim; i++) {
+    src_block_offset[i] = src->dim[i] - src_offset[i];
+    src_area[i] = src_area[i-1] * src->dim[i];
+    des_area[i] = des_area[i-1] * des->dim[i];
+    if (i == 1) {
+      src_jump[i] = 0;
+      des_jump[i] = 0;
+    } else {
+      src_jump[i] = src_jump[i-1] + (src_block_offset[i-1] - 1) * src_area[i-2];
+      des_jump[i] = des_jump[i-1] + (src_block_offset[i-1] - 1) * des_area[i-2];
+    }
+  }
+
+  for (i = 1; i < src->ndim; i++) {
+    /* jump on the i^th dimension */
+    src_jump[i] = src_area[i-1] - src_jump[i];
+    des_jump[i] = des_area[i-1] - des_jump[i];
+  }
+
+  size_t offset1, offset2;
+
+  offset1 = Sub_To_Ind(src->dim, src->ndim, src_offset);
+  offset2 = Sub_To_Ind(des->dim, des->ndim, des_offset);
+
+  ndim_t inc_dim;
+
+  while (state[src->ndim-1] < src->dim[src->ndim-1]) {
+    memcpy(des->array + offset2, src->array + offset1, row_size);
+    MATRIX_BLOCK_STATE_INC(state, inc_dim, src->ndim, src->dim);    
+    offset1 += src_jump[inc_dim];
+    offset2 += des_jump[inc_dim];
+  }
+}
+
+/* DMatrix_Blocksum(): Local sum of a matrix.
+ *
+ * Note: Calculate the sum of each block defined by the template size. The 
+ *       returned matrix will have size 
+ *       (dm->dim[0]+bdim[0]-1) x ... x (dm->dim[n]+bdim[n]-1)
+ *       for n+1 dimensional matrix. 
+ *       The caller is resposible for clearing the returned matrix.
+ *
+ * Args: dm - input matrix
+ *       bdim - size of the template or block
+ *       dm2 - where the result is stored. If it is NULL, a new matrix will be
+ *             created. Otherwise its size must be the same as expected.
+ *  
+ * Return: the matrix of block sum. The (t1,t2,...,tn)th element of the output 
+ *         is the sum of the block with the rightmost corner 
+ *         (t1-1,t2-1,...,tn-1).
+ */
+DMatrix* DMatrix_Blocksum(const DMatrix *dm, const dim_type bdim[], DMatrix *dm2)
+{
+  if(dm->ndim > 3) {
+    fprintf(stderr, "DMatrix_Blocksum does not support dimension greater than 3 currently.");
+    TZ_ERROR(ERROR_DATA_TYPE);
+  }
+
+  check_matrix(dm->dim,dm->ndim);
+  check_matrix(bdim,dm->ndim);
+
+  //int org_width,org_height,width,height,bwidth,bheight;
+  //dim_type org_offset=0, offset = 0;
+  size_t org_offset=0, offset = 0;
+  ndim_type idim;
+  //dim_type i,plane_offset,org_plane_offset;
+  size_t i,plane_offset,org_plane_offset;
+  tz_int32 zero_size;
+  dim_type new_dim[TZ_MATRIX_MAX_DIM];
+ 
+  for(idim=0;idim<dm->ndim;idim++)
+    new_dim[idim] = dm->dim[idim]+bdim[idim]-1;
+  
+  if (dm2 == NULL)
+    dm2 = Make_DMatrix(new_dim,dm->ndim);
+  else {
+    if (dm2->ndim != dm->ndim)
+      dmatrix_error("Matrix dimension error.",NULL);
+
+    for(idim = 0; idim < dm->ndim; idim++) {
+      if (dm2->dim[idim] != new_dim[idim])
+	dmatrix_error("Matrix size error.",NULL);
+    }
+  }
+
+  if(dm->ndim==1) { //1D array
+    darray_linsum1(dm->array,dm2->array, 
+		   dm->dim[0],1,bdim[0],1);
+    return dm2;
+  }
+
+  zero_size = (bdim[dm->ndim-1]-1)*matrix_subsize(dm2->dim,0,dm->ndim-2);
+  for(i=0;i<zero_size;i++) {
+    dm2->array[offset] = 0;
+    offset++;
+  }
+
+  if(dm->ndim==2) { //2D matrix
+    darray_linsum1(dm->array,dm2->array, 
+		   dm->dim[0],dm->dim[1],bdim[0],bdim[1]);
+    darray_linsum2(dm2->array,dm2->dim[0],dm->dim[1],bdim[1]);
+  } else {
+    plane_offset = dm2->dim[0]*dm2->dim[1];
+    org_plane_offset = dm->dim[0]*dm->dim[1];
+    
+    /*sum up each slice*/
+    for(i=0;i<dm->dim[2];i++) {
+      darray_linsum1(dm->array+org_offset,dm2->array+offset, 
+		     dm->dim[0],dm->dim[1],bdim[0],bdim[1]);
+      darray_linsum2(dm2->array+offset,dm2->dim[0],dm->dim[1],bdim[1]);
+      offset += plane_offset;
+      org_offset += org_plane_offset;
+    }
+  
+    /*sum up Z axis*/
+    darray_linsum2(dm2->array,dm2->dim[0]*dm2->dim[1],dm->dim[2],bdim[2]);
+  }
+
+  return dm2;
+  
+  /* for future development
+  check_dmatrix(dm->dim,dm->ndim);
+  check_dmatrix(bdim,dm->ndim);
+
+  for(i=0;i<dm->ndim;i++)
+    new_dim[i] = dm->dim[i]+bdim[i]-1;
+    
+  dm2 = Make_DMatrix(new_dim,dm->ndim);
+
+  //first dimension
+  int org_width,org_height,width,height,bwidth,bheight;
+  int offset = 0;
+  int i,j,plane_offset;
+  int zero_size;
+  int ndim_left;
+
+  plane_offset = 0;
+
+  zero_size = bdim[dm->ndim-1]*dmatrix_subsize(dm2->dim,0,dm->ndim-2);
+  for(i=0;i<zero_size;i++) {
+    dm2->array[offset] = 0;
+    offset++;
+  }
+  
+  //process first dimension
+  if(dm->ndim>2) {
+    for(i=dm->ndim-2;i==1;i--) {
+      for(j=0;j<dm2->dim[i];j++) {
+	if(i==1)
+	  darray_linsum1(dm->array+offset1,dm2->array+offset,dm->dim[0],dm->dim[1],bdim[0],bdim[1]);
+	else {	  
+	  zero_size = dmatrix_subsize(dm2->dim,0,dm->ndim-i-1);
+	  for(j=0;j<zero_size;j++) {
+	    dm2->array[offset+j] = 0;
+	  }
+	}
+	plane_offset = dmatrix_subsize(dm2->dim,0,dm->ndim-i-2);
+	offset += plane_offset; 	
+      }
+    }
+  }
+    
+  org_width = dm->dim[0];
+  org_height = dmatrix_subsize(dm->dim,1,dm->ndim-1);
+  width = dm2->dim[0];
+  height = dmatrix_subsize(dm2->dim,1,dm2->ndim-1);  
+  bwidth = bdim[0];
+  bheight = dmatrix_subsize(bdim,1,dm->ndim-1);
+  
+  int ndim_left = dm->ndim-1;
+
+  for(i=1;i<ndim_left;i++) {
+    org_width = dmatrix_subsize(dm->dim,0,i-1);
+    org_height = dm->dim[i];
+   
+    bwidth = dmatrix_subsize(bdim,0,i-1);
+    bheight = bdim[i];
+
+    width = dmatrix_subsize(dm2->dim,0,i-1);
+    height = dm2->dim[i];
+    depth = dmatrix_subsize(dm2->dim,i+1,dm2->ndim-1);
+    
+    plane_offset = width*height;
+
+    for(j=0;j<depth;j++) {
+      darray_linsum2(dm2->array+offset,org_width,org_height,bwidth,bheight);
+      offset += plane_offset;
+    }
+  }
+  
+  darray_linsum2(dm2->array,org_width,org_height,bwidth,bheight);
+  */
+}
+
+/* DMatrix_Blocksum_Part: Partial local sum.
+ *
+ * Note: This function is similar to DMatrix_Blocksum, except that it only
+ *       calculates a part of the matrix.
+ *       The caller is responsible for clearing the returned matrix.
+ *  
+ * Args: dm - input matrix
+ *       bdim - size of the block
+ *       start - starting corner of the partial matrix
+ *       end - ending corner of the partial matrix
+ *
+ * Return: the matrix of local sum.
+ */
+DMatrix* DMatrix_Blocksum_Part(const DMatrix* dm,const dim_type bdim[],const dim_type start[],const dim_type end[])
+{
+  if(dm->ndim != 3)
+    dmatrix_error("DMatrix_Blocksum_Part does not support dimension other than 3 currently.",NULL);
+
+  dim_type i,j,k;
+  dim_type i1,j1,k1;
+  dim_type dim2[3];
+  for(i=0;i<3;i++)
+    dim2[i] = end[i]-start[i]+1;
+  
+  DMatrix* dm2 = DMatrix_Zeros(dim2,3);
+  size_t offset,offset2,tmpoffset,tmpoffset2;
+  dim_type suboffset[3],tmpsuboffset[3],start2[3],end2[3];
+  dim_type plane_offset = dm->dim[0]*dm->dim[1];
+  for(i=0;i<3;i++) {
+    suboffset[i] = start[i];
+    tmpsuboffset[i] = suboffset[i]; //initial offset
+  }
+
+  offset2 = 0;
+
+  double inc,dec;
+  int leftin,rightin,orgleft,orgright;
+
+  for(k=0;k<dim2[2];k++) {
+    suboffset[2] = tmpsuboffset[2]+k; //current depth offset
+    //block depth start
+    start2[2] = imax2(0,suboffset[2]-bdim[2]+1);
+    //block depth end
+    end2[2] = imin2(suboffset[2]+1,dm->dim[2]);
+    for(j=0;j<dim2[1];j++) {
+      suboffset[1] = tmpsuboffset[1]+j;
+      //block column start
+      start2[1] = imax2(0,suboffset[1]-bdim[1]+1); 
+      //block column end
+      end2[1] = imin2(suboffset[1]+1,dm->dim[1]);
+      inc = 0;
+      dec = 0;
+      for(i=0;i<dim2[0];i++) {
+	suboffset[0] = tmpsuboffset[0]+i;
+	orgleft = suboffset[0]-bdim[0]+1;
+	if(orgleft<0) {
+	  leftin = 0;
+	  start2[0] = 0;
+	} else {
+	  leftin = 1;
+	  start2[0] = orgleft;
+	}
+
+	orgright = suboffset[0]+1;
+	if(orgright>=dm->dim[0]) {
+	  rightin = 0;
+	  end2[0] = dm->dim[0];
+	} else {
+	  rightin = 1;
+	  end2[0] = orgright;
+	}
+
+	offset = sub2ind(dm->dim,3,start2);
+
+	if(i==0) {
+	  inc = 0;
+	  dec = 0;
+	  for(k1=start2[2];k1<end2[2];k1++) {	 
+	    tmpoffset2 = offset;
+	    for(j1=start2[1];j1<end2[1];j1++) {
+	      if(leftin) dec += dm->array[offset];
+	      if(rightin) inc += dm->array[offset+end2[0]-start2[0]];
+
+	      tmpoffset = offset;
+	      double inc2 = 0;
+	      for(i1=start2[0];i1<end2[0];i1++) {
+		//dm2->array[offset2] += dm->array[offset];
+		inc2 += dm->array[offset];
+		offset++;
+	      }
+	      dm2->array[offset2] += inc2;
+
+	      offset = tmpoffset+dm->dim[0];
+	    }
+	    offset = tmpoffset2+plane_offset;
+	  }
+	}
+	else {
+	  dm2->array[offset2] = dm2->array[offset2-1]+inc-dec;
+	  inc = 0;
+	  dec = 0;
+	  //if(!leftin) leftin = (orgleft+i==0);
+	  //if(rightin) rightin = (orgright+i<dm->dim[0]);
+
+	  for(k1=start2[2];k1<end2[2];k1++) {
+	    tmpoffset2 = offset;
+	    for(j1=start2[1];j1<end2[1];j1++) {
+	      if(leftin)
+		dec += dm->array[offset];
+
+	      if(rightin)
+		inc += dm->array[offset+end2[0]-start2[0]];
+
+	      offset += dm->dim[0];
+	    }
+	    offset = tmpoffset2+plane_offset;
+	  }
+	}
+
+	offset2++;
+      }
+    }
+  }
+
+  return dm2;
+}
+
+/* DMatrix_Blocksum_Part2(): Another version of  DMatrix_Blocksum_Part
+ */
+DMatrix* DMatrix_Blocksum_Part2(const DMatrix* dm,const dim_type bdim[],const dim_type start[],const dim_type end[])
+{
+  dim_type offset[TZ_MATRIX_MAX_DIM];
+  dim_type offset2[TZ_MATRIX_MAX_DIM];
+  dim_type dim_part[TZ_MATRIX_MAX_DIM];
+  dim_type final_dim[TZ_MATRIX_MAX_DIM]; /* dimensions of the returned matrix */
+  ndim_type i;
+  
+  for (i=0; i<dm->ndim; i++) {
+    final_dim[i] = end[i] - start[i] + 1;
+    dim_part[i] = final_dim[i] + bdim[i] * 2 - 2;
+    offset[i] = start[i] - bdim[i] + 1;
+    offset2[i] = bdim[i] - 1;
+  }
+  DMatrix *matrix_part = Crop_DMatrix(dm, offset, dim_part, NULL);
+  DMatrix *matrix_sum = DMatrix_Blocksum(matrix_part, bdim, NULL);
+  DMatrix *matrix_final = Crop_DMatrix(matrix_sum, offset2, final_dim, NULL);
+
+  Kill_DMatrix(matrix_part);
+  Kill_DMatrix(matrix_sum);
+
+  return matrix_final;
+}
+
+/**
+ * Calcualte the block sum of a certain dimension
+ *
+ */
+/*
+DMatrix* DMatrix_Linsum(DMatrix* dm,int idim,int bdim)
+{
+  int offset_size = 1,rest_size=1;
+  int i,j;
+  int new_dim[MAX_DIM];
+
+  for(i=0;i<dm->ndim;i++)
+    new_dim[i] = dm->dim[i]+bdim[i]-1;
+    
+  dm2 = Make_DMatrix(new_dim,dm->ndim);
+0
+  for(i=0;i<idim-1;i++) {
+    offset_size *= dm->dim[i];
+  }
+
+  for(i=idim;i<dm->ndim;i++) {
+    rest_size *= dm->dim[i];
+  }
+  
+  if(bdim<=dm->dim[idim]) {
+    for(j=0;j<rest_size;j++) {
+      
+    }
+  } else {
+  }
+}
+*/
+
+/** 
+ * Calculate the mean of each block defined by the template size bdim.
+ * The calculation is performed out place if itype is 0. If itype is 
+ * not 0, dm should already be the block sum and the calculation will be done
+ * in place.
+ */
+DMatrix* DMatrix_Blockmean(DMatrix* dm,const dim_type bdim[],int itype)
+{
+  DMatrix* dm2;
+  ndim_type idim;
+  dim_type i,j,k;
+  dim_type dim[TZ_MATRIX_MAX_DIM];
+
+  if(itype) {
+    dm2 = dm;
+    for(idim=0;idim<dm->ndim;idim++)
+      dim[idim] = dm->dim[idim]-bdim[idim]+1;
+  }
+  else {
+    dm2 = DMatrix_Blocksum(dm, bdim, NULL);
+    for(idim=0;idim<dm->ndim;idim++)
+      dim[idim] = dm->dim[idim];    
+  }
+
+  dim_type mindim,maxdim;
+  dim_type* valid_size[3];
+
+
+  for(idim=0;idim<3;idim++) {
+    mindim = imin2(dim[idim],bdim[idim]);
+    maxdim = imax2(dim[idim],bdim[idim]);
+    valid_size[idim] = (dim_type*)malloc(dm2->dim[idim]*sizeof(dim_type));
+
+    for(j=0;j<dm2->dim[idim];j++) {
+      if(j<mindim)
+	valid_size[idim][j] = j+1;
+      else { 
+	if(j>=maxdim)
+	  valid_size[idim][j] = dm2->dim[idim]-j;
+	else
+	  valid_size[idim][j] = mindim;
+      }
+    }
+  }
+  
+  size_t offset=0;
+  for(k=0;k<dm2->dim[2];k++)
+    for(j=0;j<dm2->dim[1];j++)
+      for(i=0;i<dm2->dim[0];i++) {
+	dm2->array[offset] /= 
+          valid_size[0][i] * valid_size[1][j] * valid_size[2][k];
+	offset++;
+      }
+
+  for(idim=0;idim<3;idim++) {
+    free(valid_size[idim]);
+  }
+
+  return dm2;
+}
+
+
+DMatrix* DMatrix_Blockmean_Part(DMatrix* dm,const dim_type dim[],const dim_type bdim[],const dim_type start[],const dim_type end[],int itype)
+{
+  DMatrix* dm2;
+  ndim_type idim;
+  dim_type i,j,k;
+
+  if(itype)
+    dm2 = dm;
+  else 
+    dm2 = DMatrix_Blocksum_Part(dm,bdim,start,end);  
+
+  dim_type* valid_size[3];
+  const dim_type* cur_dim;
+  if(itype)
+    cur_dim = dim;
+  else
+    cur_dim = dm->dim;
+
+  for(idim=0;idim<3;idim++) {
+    valid_size[idim] = (dim_type*)malloc(dm2->dim[idim]*sizeof(dim_type));
+    for(j=start[idim];j<=end[idim];j++) {
+      valid_size[idim][j-start[idim]] = 
+	imin2(j+bdim[idim]-1,cur_dim[idim]+bdim[idim]-2) -
+	imax2(bdim[idim]-1,j)+1;
+    }
+  }  
+  
+  size_t offset=0;
+  for(k=0;k<dm2->dim[2];k++)
+    for(j=0;j<dm2->dim[1];j++)
+      for(i=0;i<dm2->dim[0];i++) {
+	dm2->array[offset] /= 
+          valid_size[0][i] * valid_size[1][j] * valid_size[2][k];
+	offset++;
+      }
+
+  for(idim=0;idim<3;idim++)
+    free(valid_size[idim]);
+
+  return dm2;
+}
+
+void DMatrix_Print(const DMatrix* dm)
+{
+  check_matrix(dm->dim,dm->ndim);
+
+  if(dm->ndim==1)
+    darray_print2(dm->array,dm->dim[0],1);
+
+  if(dm->ndim==2)
+    darray_print2(dm->array,dm->dim[0],dm->dim[1]);
+
+  if(dm->ndim==3)
+    darray_print3(dm->array,dm->dim[0],dm->dim[1],dm->dim[2]);
+
+  if(dm->ndim>3) {
+    ndim_type idim;
+    dim_type j;
+    dim_type plane_offset = dm->dim[0]*dm->dim[1];
+    size_t length=1;
+    for(idim=2;idim<dm->ndim;idim++)
+      length *= dm->dim[idim];
+
+    size_t offset=0;
+    dim_type sub[TZ_MATRIX_MAX_DIM];
+    int k;
+
+    for(j=0;j<length;j++) {
+      ind2sub(dm->dim+2,dm->ndim-2,j,sub);
+      printf("Plane: ");
+      for(k=0;k<dm->ndim-2;k++)
+	printf("%d ",sub[k]);
+      printf("\n");
+      darray_print2(dm->array+offset,dm->dim[0],dm->dim[1]);
+      offset += plane_offset;
+    } 
+  }
+}
+
+void DMatrix_Print_Part(const DMatrix* dm,const dim_type start[],const dim_type end[])
+{
+  if(dm->ndim != 3)
+    dmatrix_error("DMatrix_Print_Part does not support dimension other than 3 currently.",NULL);
+
+  dim_type i,j,k;
+    
+  size_t offset,tmpoffset,tmpoffset2;
+  dim_type suboffset[3],end2[3];
+  dim_type plane_offset = dm->dim[0]*dm->dim[1];
+  for(i=0;i<3;i++) {
+    suboffset[i] = imax2(0,start[i]);
+    end2[i] = imin2(dm->dim[i],end[i]+1);
+  }
+
+  offset = sub2ind(dm->dim,3,suboffset);
+  for(k=suboffset[2];k<end2[2];k++) {
+    printf("plane %d\n",k);
+    tmpoffset2 = offset;
+    for(j=suboffset[1];j<end2[1];j++) {
+      tmpoffset = offset;
+      for(i=suboffset[0];i<end2[0];i++) {
+	
+	printf("%.3f ",dm->array[offset]);
+	
+	    
+	offset++;
+      }
+      printf("\n");
+      offset = tmpoffset+dm->dim[0];
+    }
+    offset = tmpoffset2+plane_offset;
+    printf("\n");
+  }
+}
+
+
+/**
+ * Write double matrix. The first 4 bytes is for the number of dimension.
+ * Then the following bytes are the dimensions.
+ */
+void DMatrix_Write(const char* filename,const DMatrix* dm)
+{
+  FILE* fp;
+  if( !(fp=fopen(filename,"wb+")) )
+    dmatrix_error("Unable to open the file %s for writing.",filename);
+
+  fwrite(&(dm->ndim),sizeof(ndim_type),1,fp);
+  fwrite(dm->dim,sizeof(dim_type),dm->ndim,fp);
+  fwrite(dm->array,sizeof(double),matrix_size(dm->dim,dm->ndim),fp);
+  
+  fclose(fp);
+}
+
+DMatrix* DMatrix_Read(const char* filename)
+{
+  FILE* fp;
+  if( !(fp=fopen(filename,"rb")) )
+    dmatrix_error("Unable to open the file %s for reading.",filename);
+  
+  ndim_type ndim;
+  dim_type dim[TZ_MATRIX_MAX_DIM];
+
+  fread(&(ndim),sizeof(ndim_type),1,fp);
+  fread(dim,sizeof(dim_type),ndim,fp);
+
+  DMatrix* dm = Make_DMatrix(dim,ndim);
+  fread(dm->array,sizeof(double),matrix_size(dm->dim,dm->ndim),fp);
+
+  fclose(fp);
+
+  return dm;
+}
+
+
+double DMatrix_Max(const DMatrix* dm,dim_type* sub)
+{
+  size_t length = matrix_size(dm->dim,dm->ndim);
+  size_t idx;
+  double max_value;
+  max_value = darray_max(dm->array,length,&idx);
+  if (sub != NULL) {
+    ind2sub(dm->dim,dm->ndim,(dim_type)idx,sub);
+  }
+
+  return max_value;
+}
+
+double DMatrix_Max_P(const DMatrix *dm, const dim_type *start, const dim_type *end,
+		dim_type *sub)
+{
+  double max_value;
+  dim_t i[TZ_MATRIX_MAX_DIM];
+  size_t jump_offset[TZ_MATRIX_MAX_DIM];
+  size_t area[TZ_MATRIX_MAX_DIM];
+  size_t subarea[TZ_MATRIX_MAX_DIM];
+  size_t subdim[TZ_MATRIX_MAX_DIM];
+
+  area[0] = 1;
+  subarea[0] = 1;
+  i[0] = start[0];
+  sub[0] = start[0];
+  jump_offset[0] = 1;
+  subdim[0] = end[0] - start[0] + 1;
+
+  ndim_t k;
+  for (k = 1; k < dm->ndim; k++) {
+    area[k] = area[k-1] * dm->dim[k-1];
+    subdim[k] = end[k] - start[k] + 1;
+    subarea[k] = subarea[k-1] * subdim[k-1];
+    /* see the M document for jump offset calculation. */
+    jump_offset[k] = jump_offset[k-1] + area[k] - subdim[k-1] * area[k-1];
+    i[k] = start[k];
+    sub[k] = start[k];
+  }
+
+  size_t offset = Sub_To_Ind(dm->dim, dm->ndim, start);
+  ndim_t cur_dim = 0;
+  ndim_t lastdim = dm->ndim - 1;
+  BOOL overflow = FALSE;
+
+  max_value = dm->array[offset];
+
+  while (!overflow) {
+    if (cur_dim == 0) {
+      if (max_value < dm->array[offset]) {
+	max_value = dm->array[offset];
+	for (k = 0; k < dm->ndim; k++) {
+	  sub[k] = i[k];
+	}
+      }
+      offset++;
+      i[0]++;
+    } else {
+      offset += jump_offset[cur_dim] - 1;
+      cur_dim = 0;
+    }
+
+    while (i[cur_dim] > end[cur_dim]) {
+      /* reset */
+      i[cur_dim] = start[cur_dim];
+      cur_dim++;
+      if (cur_dim > lastdim) {
+	overflow = TRUE;
+	break;
+      } else {
+	i[cur_dim]++;
+      }
+    }
+  }
+
+  return max_value;
+}
+
+void DMatrix_Clean_Edge(DMatrix* dm)
+{
+  size_t offset = 0;
+  dim_type i,j,k;
+  for(k=0;k<dm->dim[2];k++)
+    for(j=0;j<dm->dim[1];j++)
+      for(i=0;i<dm->dim[0];i++) {
+	if(i==0 || j==0 || k==0)
+	  dm->array[offset] = 0;
+	offset++;
+      }
+}
+
+double DMatrix_Scale(DMatrix* dm)
+{
+  size_t length = matrix_size(dm->dim,dm->ndim);
+  size_t idx;
+  double max_value = darray_max(dm->array,length,&idx);
+  darray_divc(dm->array,max_value,length);
+  return max_value;
+}
+
+/**
+ * Convert an array to a matrix.
+ */
+DMatrix* darray2dmatrix(double* array,ndim_type ndim,...)
+{
+  int idim;
+  va_list ap;
+  _DMatrix *object;
+
+  object = (_DMatrix *) Guarded_Malloc(sizeof(_DMatrix),"Copy_DMatrix");
+  DMatrix_Offset = ((char *) &(object->dmatrix)) - ((char *) object);
+  object->dmatrix.array = array;
+
+  object->dmatrix.ndim = ndim;
+
+  va_start(ap,ndim);
+  for(idim=0;idim<ndim;idim++)
+    object->dmatrix.dim[idim] = va_arg(ap,dim_type);
+  va_end(ap);
+
+  object->asize = matrix_size(object->dmatrix.dim,object->dmatrix.ndim)*sizeof(double);
+
+  DMatrix_Inuse += 1;
+
+  return (&(object->dmatrix));
+}
+
+
+
+DMatrix DMatrix_View_Array(double* array, ndim_type ndim, ...)
+{
+  int idim;
+  va_list ap;
+  DMatrix matrix;
+
+  matrix.ndim = ndim;
+
+  va_start(ap,ndim);
+  for (idim=0; idim<ndim; idim++) {
+    matrix.dim[idim] = va_arg(ap,dim_type);
+  }
+  va_end(ap);
+
+  matrix.array = array;
+
+  return matrix;  
+}
+
+void DMatrix_Set_Zero(DMatrix *dm)
+{
+  size_t size = matrix_size(dm->dim, dm->ndim);
+  size_t i;
+  
+  for(i=0;i<size;i++) {
+    dm->array[i] = 0;
+  }
+}
+
+DMatrix* Constant_DMatrix(const dim_type dim[],ndim_type ndim,double value)
+{
+  DMatrix* dm = Make_DMatrix(dim,ndim);
+  size_t size = matrix_size(dim,ndim);
+  size_t i;
+  
+  for(i=0;i<size;i++)
+    dm->array[i] = value;
+
+  return dm;  
+}
+
+DMatrix* DMatrix_Zeros(const dim_type dim[],ndim_type ndim)
+{
+  return Constant_DMatrix(dim,ndim,0);
+
+  /* Another way to make zeros. Not reliable. */
+  /*
+  DMatrix* dm = Make_DMatrix(dim,ndim);
+  bzero(dm->array,dmatrix_asize(dm));
+  return dm;
+  */
+}
+
+DMatrix* DMatrix_Ones(const dim_type dim[],ndim_type ndim)
+{
+  return Constant_DMatrix(dim,ndim,1);
+}
+
+DMatrix* DMatrix_Add(DMatrix* dm1,const DMatrix*  dm2)
+{
+  if(Compare_Dim(dm1->dim,dm1->ndim,dm2->dim,dm2->ndim))
+    dmatrix_error("Unmatched matrix size in %s","DMatrix_Add");
+
+  size_t length = matrix_size(dm1->dim,dm1->ndim);
+  darray_add(dm1->array,dm2->array,length);
+  
+  return dm1;
+}
+
+DMatrix* DMatrix_Addc(DMatrix* dm1,double d)
+{
+  size_t length = matrix_size(dm1->dim,dm1->ndim);
+  darray_addc(dm1->array,d,length);
+  
+  return dm1;
+}
+
+DMatrix* DMatrix_Sub(DMatrix* dm1,const DMatrix*  dm2)
+{
+  if(Compare_Dim(dm1->dim,dm1->ndim,dm2->dim,dm2->ndim))
+    dmatrix_error("Unmatched matrix size in %s","DMatrix_Add");
+
+  size_t length = matrix_size(dm1->dim,dm1->ndim);
+  darray_sub(dm1->array,dm2->array,length);
+  
+  return dm1;
+}
+
+DMatrix* DMatrix_Subc(DMatrix* dm1,double d)
+{
+  size_t length = matrix_size(dm1->dim,dm1->ndim);
+  darray_subc(dm1->array,d,length);
+  
+  return dm1;  
+}
+
+DMatrix* DMatrix_Mul(DMatrix* dm1,const DMatrix*  dm2)
+{
+  if(Compare_Dim(dm1->dim,dm1->ndim,dm2->dim,dm2->ndim))
+    dmatrix_error("Unmatched matrix size in %s","DMatrix_Add");
+
+  size_t length = matrix_size(dm1->dim,dm1->ndim);
+  darray_mul(dm1->array,dm2->array,length);
+  
+  return dm1;
+}
+
+DMatrix* DMatrix_Div(DMatrix* dm1,const DMatrix*  dm2)
+{
+  if(Compare_Dim(dm1->dim,dm1->ndim,dm2->dim,dm2->ndim))
+    dmatrix_error("Unmatched matrix size in %s","DMatrix_Add");
+
+  size_t length = matrix_size(dm1->dim,dm1->ndim);
+  darray_div(dm1->array,dm2->array,length);
+  
+  return dm1;  
+}
+
+DMatrix* DMatrix_Sqr(DMatrix* dm1)
+{
+  size_t length = matrix_size(dm1->dim,dm1->ndim);
+  darray_sqr(dm1->array,length);
+  
+  return dm1;  
+}
+
+DMatrix* DMatrix_Sqrt(DMatrix* dm1)
+{
+  size_t length = matrix_size(dm1->dim,dm1->ndim);
+  darray_sqrt(dm1->array,length);
+  
+  return dm1;  
+}
+
+DMatrix* DMatrix_Negative(DMatrix *dm)
+{
+  size_t length = matrix_size(dm->dim,dm->ndim);
+  size_t i;
+  for (i = 0; i < length; i++) {
+    dm->array[i] = -dm->array[i];
+  }
+
+  return dm;
+}
+
+DMatrix* DMatrix_Max2(DMatrix *dm1, const DMatrix *dm2)
+{
+  if(Compare_Dim(dm1->dim,dm1->ndim,dm2->dim,dm2->ndim)) {
+    dmatrix_error("Unmatched matrix size in %s","DMatrix_Max2");
+  }
+
+  size_t length = matrix_size(dm1->dim,dm1->ndim);
+  darray_max2(dm1->array,dm2->array,length);
+  
+  return dm1;  
+}
+
+DMatrix* DMatrix_Min2(DMatrix *dm1, const DMatrix *dm2)
+{
+  if(Compare_Dim(dm1->dim,dm1->ndim,dm2->dim,dm2->ndim)) {
+    dmatrix_error("Unmatched matrix size in %s","DMatrix_Min2");
+  }
+
+  size_t length = matrix_size(dm1->dim,dm1->ndim);
+  darray_min2(dm1->array,dm2->array,length);
+  
+  return dm1;    
+}
+
+DMatrix* DMatrix_Partial_Diff(const DMatrix *dm, ndim_type dim, DMatrix *result)
+{
+  if (result == NULL) {
+    result = Make_DMatrix(dm->dim, dm->ndim); 
+  }
+
+  size_t stride = 1;
+  size_t i, j;
+  for (i = 0; i < dim; i++) {
+    stride *= dm->dim[i];
+  }
+
+  size_t nline = 1;
+  for (i = 0; i < dm->ndim; i++) {
+    if (i != dim) {
+      nline *= dm->dim[i];
+    }
+  }
+  
+  size_t offset = 0;
+  size_t offset2 = 0;
+  size_t counter = 1;
+
+  for (i = 0; i < nline; i++) {
+    /* reset offset */
+    offset = offset2;
+    result->array[offset] = dm->array[offset + stride] - dm->array[offset];
+    offset += stride;
+    /* internal points */
+    for (j = 2; j < dm->dim[dim]; j++) {
+      result->array[offset] = 
+	(dm->array[offset + stride] - dm->array[offset - stride]) / 2.0;
+      offset += stride;
+    }
+    result->array[offset] = dm->array[offset] - dm->array[offset - stride];
+    
+    counter++;
+    if (counter > stride) {
+      counter = 1;
+      offset2 += stride * (dm->dim[dim] - 1) + 1;
+    } else {
+      offset2++;
+    }
+  }
+
+  return result;
+}
+
+void DMatrix_Threshold(DMatrix *dm, double threshold)
+{
+  size_t length = Matrix_Size(dm->dim, dm->ndim);
+  size_t i;
+  for (i = 0; i < length; i++) {
+    if (dm->array[i] <= threshold) {
+      dm->array[i] = 0;
+    }
+  }
+}
+
+
+void DMatrix_Abs_Threshold(DMatrix *dm, double threshold)
+{
+  size_t length = Matrix_Size(dm->dim, dm->ndim);
+  size_t i;
+  for (i = 0; i < length; i++) {
+    if (fabs(dm->array[i]) <= threshold) {
+      dm->array[i] = 0;
+    }
+  }
+}
+
+
+#define MATRIX_ABS abs
+
+#undef MATRIX_ABS
+#define MATRIX_ABS fabs
+
+
+
+
+DMatrix* DMatrix_Eigen3_Coeff2(DMatrix *a, DMatrix *b, DMatrix *c, DMatrix *result)
+{
+  if (result == NULL) {
+    result = Make_DMatrix(a->dim, a->ndim);
+  }
+
+  size_t length = Matrix_Size(a->dim, a->ndim);
+  size_t i;
+  for (i = 0; i < length; i++) {
+    result->array[i] = a->array[i] + b->array[i] + c->array[i];
+  }  
+
+  return result;
+}
+
+DMatrix* DMatrix_Eigen3_Coeff1(DMatrix *a, DMatrix *b, DMatrix *c, DMatrix *d, DMatrix *e, DMatrix *f,
+			 DMatrix *result)
+{
+  if (result == NULL) {
+    result = Make_DMatrix(a->dim, a->ndim);
+  }
+
+  size_t length = Matrix_Size(a->dim, a->ndim);
+  size_t i;
+  for (i = 0; i < length; i++) {
+    result->array[i] = a->array[i] * b->array[i] + b->array[i] * c->array[i] +
+      a->array[i] * c->array[i] - e->array[i] * e->array[i] - 
+      d->array[i] * d->array[i] - f->array[i] * f->array[i];
+  }  
+
+  return result;
+}
+
+DMatrix* DMatrix_Eigen3_Coeff0(DMatrix *a, DMatrix *b, DMatrix *c, DMatrix *d, DMatrix *e, DMatrix *f,
+			 DMatrix *result)
+{
+  if (result == NULL) {
+    result = Make_DMatrix(a->dim, a->ndim);
+  }
+
+  size_t length = Matrix_Size(a->dim, a->ndim);
+  size_t i;
+  for (i = 0; i < length; i++) {
+    result->array[i] = a->array[i] * b->array[i] * c->array[i] + 
+      2.0 * d->array[i] * e->array[i] * f->array[i] -
+      a->array[i] * f->array[i] * f->array[i] - 
+      c->array[i] * d->array[i] * d->array[i] - 
+      b->array[i] * e->array[i] * e->array[i];
+  }  
+
+  return result;
+}
+
+DMatrix* DMatrix_Eigen3_Coeffd(DMatrix *a, DMatrix *b, DMatrix *c, DMatrix *d, DMatrix *e, DMatrix *f,
+			 DMatrix *result)
+{
+  if (result == NULL) {
+    result = Make_DMatrix(a->dim, a->ndim);
+  }
+
+  size_t length = Matrix_Size(a->dim, a->ndim);
+  size_t i;
+  for (i = 0; i < length; i++) {
+    if (a->array[i] + b->array[i] + c->array[i] >= 0.0) {
+      result->array[i] = 0.0;
+    } else {
+      result->array[i] =  a->array[i] * b->array[i] + 
+	b->array[i] * c->array[i] +
+	a->array[i] * c->array[i] - e->array[i] * e->array[i] - 
+	d->array[i] * d->array[i] - f->array[i] * f->array[i];
+      
+      if (result->array[i] <= 0.0) {
+	result->array[i] = 0.0;
+      } else {
+	result->array[i] /= 1.0 +
+	  Cube_Root(MATRIX_ABS(a->array[i] * b->array[i] * c->array[i] + 
+			       2.0 * d->array[i] * e->array[i] * f->array[i] -
+			       a->array[i] * f->array[i] * f->array[i] - 
+			       c->array[i] * d->array[i] * d->array[i] - 
+			       b->array[i] * e->array[i] * e->array[i]));
+	
+      }
+      
+    }
+  }
+
+  return result;
+}
+
+#ifdef _DEBUG_
+#include "tz_image_lib_defs.h"
+#include "tz_stack_lib.h"
+#endif
+
+DMatrix* DMatrix_Eigen3_Solution_Score(DMatrix *a, DMatrix *b, DMatrix *c, DMatrix *d, 
+				 DMatrix *e, DMatrix *f, DMatrix *result)
+{
+  if (result == NULL) {
+    result = Make_DMatrix(a->dim, a->ndim);
+  }
+
+  size_t length = Matrix_Size(a->dim, a->ndim);
+  size_t i;
+ 
+  for (i = 0; i < length; i++) {
+    if (a->array[i] + b->array[i] + c->array[i] >= 0.0) {
+      result->array[i] = 0.0;
+    } else {
+      double coeff[3];
+      coeff[0] = -a->array[i] - b->array[i] - c->array[i];
+      coeff[1] = a->array[i] * b->array[i] + 
+	b->array[i] * c->array[i] +
+	a->array[i] * c->array[i] - e->array[i] * e->array[i] - 
+	d->array[i] * d->array[i] - f->array[i] * f->array[i];
+      coeff[2] = -a->array[i] * b->array[i] * c->array[i] - 
+	2.0 * d->array[i] * e->array[i] * f->array[i] +
+	a->array[i] * f->array[i] * f->array[i] + 
+	c->array[i] * d->array[i] * d->array[i] + 
+	b->array[i] * e->array[i] * e->array[i];
+      if (Solve_Cubic(1.0, coeff[0], coeff[1], coeff[2], coeff) > 0){
+	double tmp;
+	if (coeff[0] < coeff[1]) {
+	  SWAP2(coeff[0], coeff[1], tmp);
+	  if (coeff[0] < coeff[2]) {
+	    SWAP2(coeff[0], coeff[2], tmp);
+	  }
+	}
+
+
+	if ((coeff[1] >= 0) || (coeff[2] >= 0)) {
+	  result->array[i] = 0.0;
+	} else {
+	  result->array[i] = sqrt(coeff[1] * coeff[2]);
+	  if (coeff[0] > 0.0) {
+	    coeff[0] = -coeff[0] / 2.0;
+	  }
+	}
+	result->array[i] += coeff[0];
+	if (result->array[i] < 0.0) {
+	  result->array[i] = 0.0;
+	}
+      } else {
+	result->array[i] = 0.0;
+      }
+    }
+  }
+
+  return result;
+}
+
+DMatrix* DMatrix_Eigen3_Curvature(DMatrix *xx, DMatrix *yy, DMatrix *zz, 
+			    DMatrix *x, DMatrix *y, DMatrix *z, DMatrix *result)
+{
+  if (result == NULL) {
+    result = Make_DMatrix(xx->dim, xx->ndim);
+  }
+
+  size_t length = Matrix_Size(xx->dim, xx->ndim);
+  size_t i;
+  double t;
+  for (i = 0; i < length; i++) {
+    t = sqrt(1.0 + x->array[i] * x->array[i]);
+    result->array[i] = xx->array[i] / t /t /t;
+    t = sqrt(1.0 + y->array[i] * y->array[i]);
+    result->array[i] += yy->array[i] / t /t /t;
+    t = sqrt(1.0 + z->array[i] * z->array[i]);
+    result->array[i] += zz->array[i] / t /t /t;
+  }  
+
+  DMatrix_Negative(result);
+
+  return result;  
+}
@@ -0,0 +1,1973 @@
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include "tz_error.h"
+#include "tz_iarray.h"
+#include "tz_string.h"
+#if defined(HAVE_LIBGSL)
+#  if defined(HAVE_INLINE)
+#    undef HAVE_INLINE
+#    define INLINE_SUPPRESSED
+#  endif
+#  include <gsl/gsl_vector.h>
+#  include <gsl/gsl_cblas.h>
+#  if defined(INLINE_SUPPRESSED)
+#    define HAVE_INLINE
+#  endif
+#endif
+#include "tz_utilities.h"
+
+
+void iarray_error(const char *msg,const char *arg)
+{
+  fprintf(stderr,"\nError in tz_iarray.c:\n");
+  fprintf(stderr,msg,arg);
+  fprintf(stderr,"\n");
+  exit(1);
+}
+
+void iarray_warning(const char *msg,const char *arg)
+{
+  fprintf(stderr,"\nWarning in tz_iarray.c:\n");
+  fprintf(stderr,msg,arg);
+  fprintf(stderr,"\n");
+}
+
+int iarray_max(const int* d1,size_t length, size_t* idx)
+{
+  TZ_ASSERT(d1 != NULL, "Null pointer");
+  TZ_ASSERT(length > 0, "Array length is zero");
+
+  size_t max_idx = 0;
+  size_t i;
+  for(i = 1; i < length; i++) {
+    if(d1[i] > d1[max_idx]) {
+      max_idx = i;
+    }
+  }
+
+  if (idx != NULL) {
+    *idx = max_idx;
+  }
+
+  return d1[max_idx];
+}
+
+/* find max. <idx> is the last occurrence. */
+int iarray_max_l(const int* d1,size_t length,size_t *idx)
+{
+  TZ_ASSERT(d1 != NULL, "Null pointer");
+  TZ_ASSERT(length > 0, "Array length is zero");
+
+  size_t max_idx = length - 1;
+
+  size_t i;
+  for(i = length - 1; i > 0; i--) {
+    if(d1[i - 1] > d1[max_idx]) {
+      max_idx = i - 1;
+    }
+  }
+
+  if (idx != NULL) {
+    *idx = max_idx;
+  }
+
+  return d1[max_idx];
+}
+
+int iarray_min(const int* d1, size_t length, size_t* idx)
+{
+  TZ_ASSERT(d1 != NULL, "Null pointer");
+  TZ_ASSERT(length > 0, "Array length is zero");
+
+  size_t min_idx = 0;
+  size_t i;
+  for(i = 1; i < length; i++) {
+    if(d1[i] < d1[min_idx]) {
+      min_idx = i;
+    }
+  }
+
+  if (idx != NULL) {
+    *idx = min_idx;
+  }
+
+  return d1[min_idx];
+}
+
+/* find min. <idx> is the last occurrence. */
+int iarray_min_l(const int* d1, size_t length, size_t *idx)
+{
+  TZ_ASSERT(d1 != NULL, "Null pointer");
+  TZ_ASSERT(length > 0, "Array length is zero");
+
+  size_t min_idx = length - 1;
+
+  size_t i;
+  for(i = length - 1; i > 0; i--) {
+    if(d1[i - 1] < d1[min_idx]) {
+      min_idx = i - 1;
+    }
+  }
+
+  if (idx != NULL) {
+    *idx = min_idx;
+  }
+
+  return d1[min_idx];
+}
+
+/* find max from elements of interest. */
+int iarray_max_m(const int *d1, size_t length, const int *mask, size_t *idx)
+{
+  TZ_ASSERT(d1 != NULL, "Null pointer");
+  TZ_ASSERT(length > 0, "Array length is zero");
+
+  BOOL found_first = FALSE;
+
+  size_t max_idx = INVALID_ARRAY_INDEX;
+  size_t i;
+  for (i = 0; i < length; i++) {
+    if (mask[i]) {
+      max_idx = i;
+      found_first = TRUE;
+      break;
+    }
+  }
+
+  if (found_first == TRUE) {    
+    for (i = max_idx; i < length; i++) {
+      if (mask[i]) {
+	if(d1[i] > d1[max_idx]) {
+	  max_idx = i;
+	}
+      }
+    }
+  }
+  
+  if (idx != NULL) {
+    *idx = max_idx;
+  }
+  
+  if (found_first == FALSE) {
+    return 0;
+  } else {
+    return d1[max_idx];
+  }
+}
+
+
+
+
+/* last occurrence */
+int iarray_max_ml(const int *d1, size_t length, const int *mask, size_t *idx)
+{
+  BOOL found_first = FALSE;
+
+  size_t max_idx = length;
+  size_t i;
+  for (i = length; i > 0; i--) {
+    if (mask[i - 1] != 0) {
+      found_first = TRUE;
+      max_idx = i - 1;
+      break;
+    }
+  }
+
+  if (found_first == TRUE) {    
+    for (i = max_idx + 1; i > 0; i--) {
+      if (mask[i - 1] != 0) {
+	if(d1[i - 1] > d1[max_idx]) {
+	  max_idx = i - 1;
+	}
+      }
+    }
+  }
+  
+  if (idx != NULL) {
+    *idx = max_idx;
+  }
+  
+  if (found_first == FALSE) {
+    return 0;
+  } else {
+    return d1[max_idx];
+  }
+}
+
+int iarray_min_m(const int *d1, size_t length, const int *mask, size_t *idx)
+{
+  BOOL found_first = FALSE;
+  size_t min_idx = INVALID_ARRAY_INDEX;
+  size_t i;
+  for (i = 0; i < length; i++) {
+    if (mask[i] != 0) {
+      found_first = TRUE;
+      min_idx = i;
+      break;
+    }
+  }
+
+  if (found_first == TRUE) {    
+    for (i = min_idx; i < length; i++) {
+      if (mask[i] != 0) {
+	if(d1[i] < d1[min_idx]) {
+	  min_idx = i;
+	}
+      }
+    }
+  }
+  
+  if (idx != NULL) {
+    *idx = min_idx;
+  }
+  
+  if (found_first == FALSE) {
+    return 0.0;
+  } else {
+    return d1[min_idx];
+  }
+}
+
+int iarray_min_ml(const int *d1, size_t length, const int *mask, size_t *idx)
+{
+  size_t min_idx = length;
+  size_t i;
+  for (i = length; i > 0; i--) {
+    if (mask[i - 1] != 0) {
+      min_idx = i - 1;
+      break;
+    }
+  }
+
+  if (min_idx < length) {    
+    for (i = min_idx + 1; i > 0; i--) {
+      if (mask[i - 1] != 0) {
+	if(d1[i - 1] < d1[min_idx]) {
+	  min_idx = i - 1;
+	}
+      }
+    }
+  }
+  
+  if (idx != NULL) {
+    *idx = min_idx;
+  }
+  
+  if (min_idx >= length) {
+    return 0;
+  } else {
+    return d1[min_idx];
+  }
+}
+
+
+int* iarray_abs(int* d1, size_t length)
+{
+  size_t i;
+  for(i=0;i<length;i++) {
+    d1[i] = abs(d1[i]);
+  }
+
+  return d1;
+}
+
+int* iarray_neg(int* d1,size_t length)
+{
+  size_t i;
+  for(i=0;i<length;i++) {
+    d1[i] = -d1[i];
+  }
+
+  return d1;
+}
+
+
+int* iarray_add(int* d1, const int* d2, size_t length)
+{
+  size_t i;
+  for(i=0;i<length;i++)
+    d1[i] += d2[i];
+  return d1;
+}
+
+int* iarray_addc(int*d1,int d2, size_t length)
+{
+  size_t i;
+  for(i=0;i<length;i++)
+    d1[i] += d2;
+  return d1;
+}
+
+int* iarray_cadd(int d2, int*d1, size_t length)
+{
+  return iarray_addc(d1,d2,length);
+}
+
+
+int* iarray_sub(int* d1,int* d2, size_t length)
+{
+  size_t i;
+  for(i=0;i<length;i++)
+    d1[i] -= d2[i];
+  return d1;
+}
+
+int* iarray_subc(int*d1,int d2, size_t length)
+{
+  size_t i;
+  for(i=0;i<length;i++)
+    d1[i] -= d2;
+  return d1;
+}
+
+int* iarray_csub(int d2, int*d1, size_t length)
+{
+  return iarray_subc(d1,d2,length);
+}
+
+int* iarray_mul(int* d1,int* d2, size_t length)
+{
+  size_t i;
+  for(i=0;i<length;i++) {
+    d1[i] *= d2[i];
+  }
+  return d1;
+}
+
+int* iarray_mulc(int* d1,int d2, size_t length)
+{
+  size_t i;
+  for(i=0;i<length;i++)
+    d1[i] *= d2;
+  return d1;
+}
+
+int* iarray_div(int* d1,int* d2, size_t length)
+{
+  size_t i;
+  int warned = 0;
+
+  for(i=0;i<length;i++) {
+    //if(fabs(d1[i])>MIN_int && fabs(d2[i])>MIN_int)
+
+
+    if(d2[i]==0) {
+
+      if (!warned) {
+        iarray_warning("Divide by zero: %s\n","iarray_div");
+        warned = 1;
+      }
+      d1[i] = 0;
+    } else {
+      d1[i] /= d2[i];
+    }
+  }
+  
+  return d1;
+}
+
+int* iarray_div_i(int* d1,int* d2, size_t length)
+{
+  size_t i;
+  int warned = 0;
+
+  for(i=0;i<length;i++) {
+    //if(fabs(d1[i])>MIN_int && fabs(d2[i])>MIN_int)
+    if(d2[i]==0 && !warned) {
+      iarray_warning("Divide by zero: %s\n","iarray_div");
+      warned = 1;
+    }
+
+    if(d2[i]!=0)
+      d1[i] /= d2[i];
+  }
+  
+  return d1;
+}
+
+int* iarray_divc(int* d1,int d2, size_t length)
+{
+  size_t i;
+
+
+    
+  if(d2==0)
+
+    iarray_warning("Divide by zero: %s\n","iarray_divc");
+
+  for(i=0;i<length;i++)
+
+
+    if(d1[i]==0)
+
+      d1[i] /= d2;
+
+  return d1;
+}
+
+double iarray_dot(const int *d1, const int *d2,  size_t length)
+{
+  size_t i;
+  double d = 0.0;
+  for (i = 0; i < length; i++) {
+    d += d1[i] * d2[i];
+  }
+
+  return d;
+}
+
+
+
+int* iarray_sqr(int* d1, size_t length)
+{
+  size_t i;
+  for(i=0;i<length;i++)
+    d1[i] *= d1[i];
+  return d1;
+}
+
+int* iarray_sqrt(int* d1, size_t length)
+{
+  size_t i;
+  int warned = 0;
+  for(i=0;i<length;i++) {
+    if(d1[i]<0.0) {
+      warned++;
+      d1[i] = -sqrt(-d1[i]);
+    } else {
+      d1[i] =sqrt(d1[i]);
+    }
+  }
+
+  if (warned > 0) {
+    iarray_warning("%s \n","iarray_sqrt");
+    fprintf(stderr, "Square root of %d negative numbers\n", warned);
+  }
+
+  return d1;
+}
+
+int* iarray_scale(int *d1, size_t length, int min, int max)
+{
+  size_t i;
+
+  int array_min = iarray_min(d1, length, &i);
+  int array_max = iarray_max(d1, length, &i);
+  double coef = (double) (max - min) / (array_max - array_min);
+  for (i = 0; i < length; i++) {
+    d1[i] = (int) ((double) (d1[i] - array_min) * coef + min);
+  }
+
+  return d1;
+}
+
+int* iarray_max2(int* d1,const int* d2, size_t length)
+{
+  size_t i;
+  for (i = 0; i < length; i++) {
+    if (d1[i] < d2[i]) {
+      d1[i] = d2[i];
+    }
+  }
+
+  return d1;
+}
+
+
+int* iarray_min2(int* d1,const int* d2, size_t length)
+{
+  size_t i;
+  for (i = 0; i < length; i++) {
+    if (d1[i] > d2[i]) {
+      d1[i] = d2[i];
+    }
+  }
+
+  return d1;
+}
+
+void iarray_threshold(int *d, size_t length, const int *min, const int *max)
+{
+  size_t i;
+  for (i = 0; i < length; i++) {
+    TZ_ASSERT(max[i] >= min[i], "Invalid threshold");
+    if (d[i] < min[i]) {
+      d[i] = min[i];
+    } else if (d[i] > max[i]) {
+      d[i] = max[i];
+    }
+  }
+}
+
+/*calculate d1*sqrt((d2-2)./(1-d1.^2)). The result is 0 if d2 is 
+  less than thr. The result is stored in d1.*/
+int* iarray_fun1(int* d1,int *d2,int thr, size_t length)
+{
+  size_t i;
+  for(i=0;i<length;i++) {
+    if(d2[i]<thr)
+      d1[i] = 0;
+    else {
+      if (d1[i] > 0) {
+	d1[i] *= log(d1[i]*sqrt((d2[i]-2)/(1.0001-d1[i]*d1[i])));
+      }
+    }     
+  }
+  return d1;  
+}
+
+int* iarray_fun1_max(int* d1,int *d2,int thr, size_t length,int *maxv)
+{
+  size_t i;
+  int tmpv = d1[0];
+  *maxv = tmpv;
+
+  if(d2[0]<thr)
+      d1[0] = 0;
+  else {
+    if (d1[0] > 0) {
+      d1[0] *= log(d1[0]*sqrt((d2[0]-2)/(1.0001-d1[0]*d1[0])));
+    }
+  }
+  int tmpmaxv = d1[0];
+  
+  for(i=1;i<length;i++) {
+    tmpv = d1[i];
+    if(d2[i]<thr)
+      d1[i] = 0;
+    else {
+      if (d1[i] > 0) {
+	d1[i] *= log(d1[i]*sqrt((d2[i]-2)/(1.01-d1[i]*d1[i])));
+      }
+    }
+    if(d1[i] > tmpmaxv) {
+      tmpmaxv = d1[i];
+      *maxv = tmpv;
+    }
+  }
+
+  return d1;  
+}
+
+int* iarray_fun1_i2(int* d1,int *d2,int thr,size_t length)
+{
+  size_t i;
+  for(i=0;i<length;i++) {
+    if(d2[i]<thr)
+      d1[i] = 0;
+    else
+      d1[i] = d1[i]*sqrt(((int)d2[i]-2)/(1.0001-d1[i]*d1[i]));
+  }
+  return d1; 
+}
+
+int* iarray_fun1_i2_max(int* d1,int *d2,int thr,size_t length,int *maxv)
+{
+  size_t i;
+  int tmpv = d1[0];
+  *maxv = tmpv;
+
+  if(d2[0]<thr)
+      d1[0] = 0;
+    else
+      d1[0] = d1[0]*sqrt((d2[0]-2)/(1.0001-d1[0]*d1[0]));
+  
+  int tmpmaxv = d1[0];
+  
+  for(i=1;i<length;i++) {
+    tmpv = d1[i];
+    if(d2[i]<thr)
+      d1[i] = 0;
+    else
+      d1[i] = d1[i]*sqrt((d2[i]-2)/(1.01-d1[i]*d1[i]));
+
+    if(d1[i] > tmpmaxv) {
+      tmpmaxv = d1[i];
+      *maxv = tmpv;
+    }
+  }
+
+  return d1;  
+}
+
+/**
+ *  sqrt(d1-d2*d3). results stored in d1.
+ */
+int* iarray_fun2(int *d1,int *d2,int *d3, size_t length)
+{
+  size_t i;
+  for(i=0;i<length;i++)
+    d1[i] = sqrt(d1[i]-d2[i]*d3[i]);
+ 
+  return d1;
+}
+ 
+/**
+ * (d1-d2*d3)/d4. results stored in d1.
+ */
+int* iarray_fun3(int *d1,int *d2,int *d3,int *d4, size_t length)
+{
+  size_t i;
+  for(i=0;i<length;i++) {
+    if (d4[i] == 0.0) {
+      d1[i] = 0.0;
+    } else {
+      //d1[i] = (d1[i]-d2[i]*d3[i])/d4[i];
+      d1[i] = d1[i]/d4[i] - (d2[i]/d4[i])*d3[i];
+    }
+
+    /* calibrate invalid values */
+    if ((double) (d1[i]) > 1.01) {
+      d1[i] = 0.0;
+    } else if ((double) (d1[i]) > 1.0) {
+      d1[i] = 1.0;
+    }
+    
+  }
+  
+  return d1;
+}
+
+int* iarray_cumsum(int* d1, size_t length)
+{
+  size_t i;
+  for(i=1;i<length;i++)
+    d1[i] += d1[i-1];
+  return d1;
+}
+
+int* iarray_cumsum_m(int* d1,size_t length,const int *mask)
+{
+  size_t i, j;
+  j = 0;
+  for(i=0;i<length;i++) {
+    if (mask[i] > 0) {
+      if (j > 0) {
+	d1[i] += d1[j - 1];
+      }
+      j = i + 1;
+    }
+  }
+  return d1;
+}
+
+int* iarray_cumsum2(int* d1,int width,int height)
+{
+  int cur_state = 0;
+  int x,y;
+  size_t offset=1;
+  for(x=1;x<width;x++) {
+    d1[offset] += d1[offset-1];
+    offset++;
+  }
+
+  for(y=1;y<height;y++) {
+    cur_state = 0;
+    for(x=0;x<width;x++) {
+      cur_state += d1[offset];
+      d1[offset] = d1[offset-width]+cur_state;
+      offset++;
+    }
+  }
+
+  return d1;
+}
+
+int iarray_sum(const int* d1, size_t length)
+{
+  size_t i;
+  int sum=0;
+  for(i=0;i<length;i++)
+    sum += d1[i];
+  return sum;
+}
+
+
+
+int iarray_abssum(int* d1, size_t length)
+{
+  size_t i;
+  int sum=0;
+  for(i=0;i<length;i++) {
+    sum += abs(d1[i]);
+  }
+  return sum;
+}
+
+/**
+ * same as iarray_sum. but it might be more precise for summing
+ * large amount of floating data.
+ */
+int iarray_sum_h(int* d1, size_t length)
+{
+  if(length==1)
+    return d1[0];
+
+  if(length==2)
+    return d1[0]+d1[1];
+
+  size_t sublen = length/2;
+  return iarray_sum_h(d1,sublen)+iarray_sum_h(d1+sublen,length-sublen);
+}
+
+
+int iarray_centroid(const int* d1, size_t length)
+{
+  size_t i;
+  int totalWeight,totalPos;
+  totalWeight = totalPos = 0;
+
+  for(i=0;i<length;i++) {
+    totalWeight += d1[i];
+    totalPos += d1[i]*i;
+  }
+
+  int c = totalPos/totalWeight;
+
+
+   if( (totalPos % totalWeight) * 2 >= totalWeight )
+     c++;
+
+
+  return c;
+}
+
+double iarray_centroid_d(const int* d1, size_t length)
+{
+  size_t i;
+  double totalWeight,totalPos;
+  totalWeight = totalPos = 0;
+
+  for(i=0;i<length;i++) {
+    totalWeight += d1[i];
+    totalPos += ((double) d1[i]) * i;
+  }
+
+  if (totalWeight == 0.0) {
+    return (double) length / 2.0;
+  } else {
+    return totalPos/totalWeight;
+  }
+}
+
+/**
+ * Local sum of an array. It assumes that the array has 2D subscripts with
+ * column-major order and processes the first dimension. The results will be 
+ * stored in d2, which should be long enough to hold the data.
+ */
+void iarray_linsum1(int* d1,int* d2,int width,int height,int bwidth,int bheight)
+{
+  int width2 = width+bwidth-1;
+  int height2 = height+bheight-1;
+  int i,j;
+  size_t offset = 0,offset1=0;
+
+  /* rowwise */
+  for(j=0;j<bheight-1;j++)
+    for(i=0;i<width2;i++) {
+      d2[offset] = 0;
+      offset++;
+    }
+
+  if(bwidth==1) {
+    size_t row_offset = ((size_t) bheight - 1) * width;
+    size_t src_offset = 0;
+    size_t row_size = sizeof(int) * width;
+    for(j = 0; j < height; j++) {
+      memcpy(d2 + row_offset, d1 + src_offset, row_size);
+      row_offset += width;
+      src_offset += width;
+    }
+    return;
+  }
+
+  if(width>=bwidth) {
+    for(j=bheight-1;j<height2;j++) {
+      d2[offset] = d1[offset1];
+      offset++;
+      offset1++;
+      for(i=1;i<bwidth;i++) {
+	d2[offset] = d2[offset-1]+d1[offset1];
+	offset++;
+	offset1++;
+      }
+      for(i=bwidth;i<width;i++) {
+	d2[offset] = d2[offset-1]+d1[offset1]-d1[offset1-bwidth];
+	offset++;
+	offset1++;
+      }
+      offset1 -= bwidth;
+      for(i=width;i<width2;i++) {
+	d2[offset] = d2[offset-1]-d1[offset1];
+	offset++;
+	offset1++;
+      }
+      offset1++;
+    }
+  } else {
+    for(j=bheight-1;j<height2;j++) {
+      d2[offset] = d1[offset1];
+      offset++;
+      offset1++;
+      for(i=1;i<width;i++) {
+	d2[offset] = d2[offset-1]+d1[offset1];
+	offset++;
+	offset1++;
+      }
+      for(i=width;i<bwidth;i++) {
+	d2[offset] = d2[offset-1];
+	offset++;
+      }
+      offset1 -= width;
+      for(i=bwidth;i<width2;i++) {
+	d2[offset] = d2[offset-1]-d1[offset1];
+	offset++;
+	offset1++;
+      }
+      offset1++;
+    }
+  } 
+}
+
+/**
+ * Local sum of an array. It assumes that the array has 2D subscripts with
+ * column-major order and processes the second dimension. It's done in place.
+ */
+void iarray_linsum2(int* d2,int width2,int height,int bheight)
+{
+  if(bheight==1)
+    return;
+
+  //int i,j,offset,offset1;
+  size_t i,j,offset,offset1;
+  int height2 = height+bheight-1;
+  int* cur_row = iarray_malloc(width2);
+  int* prev_row = iarray_malloc(width2);
+  size_t row_size = (size_t)width2*sizeof(int);
+
+  offset1 = width2*(bheight-1);
+
+  for(i=0;i<width2;i++) {
+    d2[i] = d2[offset1];
+    offset1++;
+  }
+
+  offset = width2;
+
+  if(bheight<=height) {    
+    for(j=1;j<bheight;j++){
+      if(j==bheight-1)
+	memcpy((void*)prev_row,(void*)(d2+offset),row_size);
+      for(i=0;i<width2;i++) {
+	d2[offset] = d2[offset-width2]+d2[offset1];
+	offset++;
+	offset1++;
+      }
+    }
+  
+    for(j=bheight;j<height;j++) {
+      memcpy((void*)cur_row,(void*)(d2+offset),row_size);
+      for(i=0;i<width2;i++) {
+	d2[offset] = d2[offset1]+d2[offset-width2]-prev_row[i];
+	offset++;
+	offset1++;
+      }
+      memcpy((void*)prev_row,(void*)cur_row,row_size);
+    }
+    
+    for(j=height;j<height2;j++) {
+      memcpy((void*)cur_row,(void*)(d2+offset),row_size);
+      for(i=0;i<width2;i++) {
+	d2[offset] = d2[offset-width2] - prev_row[i];
+	offset++;
+      }
+      memcpy((void*)prev_row,(void*)cur_row,row_size);
+    }
+  } else {
+    for(j=1;j<height;j++){
+      for(i=0;i<width2;i++) {
+	d2[offset] = d2[offset-width2]+d2[offset1];
+	offset++;
+	offset1++;
+      }
+    }
+      
+    memcpy((void*)prev_row,(void*)(d2+width2*(bheight-1)),row_size);
+
+    for(j=height;j<bheight;j++) {
+      memcpy((void*)(d2+offset),(void*)(d2+offset-width2),row_size);
+      offset += width2;
+    }
+
+    for(j=bheight;j<height2;j++) {
+      memcpy((void*)cur_row,(void*)(d2+offset),row_size);
+      for(i=0;i<width2;i++) {
+	d2[offset] = d2[offset-width2]-prev_row[i];
+	offset++;
+      }	
+      memcpy((void*)prev_row,(void*)cur_row,row_size);
+    }
+  }
+
+  free(prev_row);
+  free(cur_row);  
+}
+
+/** 
+ * Calculate  the sum of each block defined by the template size: 
+ * bwidth,bheight. The calculation is performed out place.
+ * d1 is supposed to have size width*height
+ * The return matrix has size (width+bwidth-1)*(height+bheight-1)
+ */
+int* iarray_blocksum(int *d1,int width,int height,int bwidth,int bheight)
+{
+  int width2 = width+bwidth-1;
+  int height2 = height+bheight-1;
+  int* d2 = iarray_malloc2(width2,height2);
+
+  /* sum up rows */
+  iarray_linsum1(d1,d2,width,height,bwidth,bheight);
+
+  /* sum columns */
+  iarray_linsum2(d2,width2,height,bheight);
+
+  
+  #ifdef _DEBUG_
+ 
+  printf("%d\n",width2);
+  printf("%d\n",height2);
+  iarray_print2(d2,width2,height2);
+
+  #endif
+  
+  return d2;
+}
+
+
+/**
+ * The size of d2 must be at least end-start+1
+ */
+void iarray_linsum1_part(const int* d1,int* d2,int width,int bwidth,
+    int start, int end)
+{
+  int width2 = end-start+1;
+  int i,minend;
+  size_t offset = 0,offset1=start;
+
+  if(bwidth==1) {
+    for(i=0;i<width2;i++) {
+      d2[i] = d1[offset1++];
+    }
+    return;
+  }
+
+  d2[offset] = 0;
+
+  if(width>=bwidth) {
+    if(start<width)
+      for(i=imax2(0,start-bwidth+1);i<=start;i++)
+	d2[offset] += d1[i];
+    else 
+      for(i=start-bwidth+1;i<width;i++)
+	d2[offset] += d1[i];
+
+    offset++;
+    offset1++;
+    
+    minend = imin2(bwidth,end+1);
+    for(i=start+1;i<minend;i++) {
+      d2[offset] = d2[offset-1]+d1[offset1];
+      offset++;
+      offset1++;
+    }
+    minend = imin2(width,end+1);
+    for(i=imax2(bwidth,start+1);i<minend;i++) {
+      d2[offset] = d2[offset-1]+d1[offset1]-d1[offset1-bwidth];
+      offset++;
+      offset1++;
+    }
+    offset1 -= bwidth;
+    for(i=imax2(width,start+1);i<end+1;i++) {
+      d2[offset] = d2[offset-1]-d1[offset1];
+      offset++;
+      offset1++;
+    }
+  } else {
+    if(start<bwidth) {
+      minend = imin2(width-1,start);
+      for(i=0;i<=minend;i++)
+	d2[offset] += d1[i];
+    }
+    else 
+      for(i=start-bwidth+1;i<width;i++)
+	d2[offset] += d1[i];
+
+    offset++;
+    offset1++;
+
+    minend = imin2(width,end+1);
+    for(i=start+1;i<minend;i++) {
+      d2[offset] = d2[offset-1]+d1[offset1];
+      offset++;
+      offset1++;
+    }
+    minend = imin2(bwidth,end+1);
+    for(i=imax2(width,start+1);i<minend;i++) {
+      d2[offset] = d2[offset-1];
+      offset++;
+      offset1++;
+    }
+    offset1 -= bwidth;
+    for(i=imax2(bwidth,start+1);i<end+1;i++) {
+      d2[offset] = d2[offset-1]-d1[offset1];
+      offset++;
+      offset1++;
+    }
+  } 
+}
+
+/**
+ * Get essential row sums.
+ */
+/*
+static void iarray_linsum1_part1(const int*d1,int *d2,int width,int bwidth,int height,int bheight,int col_start,int col_end,int row_start,int row_end)
+{
+  int i;
+  int width2 = col_start+col_end-1;
+  int height2 = row_start+row_end-1;
+  int offset1,offset2;
+  offset1 = row_start*width;
+  offset2 = 0;
+  for(i=0;i<height2;i++) {
+    iarray_linsum1_part(d1+offset1,d2+offset2,width,bwidth,col_start,col_end);
+    offset1 += width;
+    offset2 += width2;
+  }
+  
+}
+*/
+
+void iarray_linsum2_part(const int* d1,int* d2,int width2,int height,int bheight, int start, int end)
+{
+  int height2 = end-start+1;
+  int i,minend;
+  size_t offset = 0,offset1=start*width2;
+
+  if(bheight==1) {
+    for(i=0;i<height2;i++) {
+      d2[offset] = d1[offset1];
+      offset += width2;
+      offset1 += width2;
+    }
+    return;
+  }
+
+  d2[offset] = 0;
+
+  if(height>=bheight) {
+    if(start<height)
+      for(i=imax2(0,start-bheight+1);i<=start;i++)
+	d2[offset] += d1[i*width2];
+    else 
+      for(i=start-bheight+1;i<height;i++)
+	d2[offset] += d1[i*width2];
+
+    offset += width2;
+    offset1 += width2;
+    
+    minend = imin2(bheight,end+1);
+    for(i=start+1;i<minend;i++) {
+      d2[offset] = d2[offset-1]+d1[offset1];
+      offset += width2;
+      offset1 += width2;
+    }
+    minend = imin2(height,end+1);
+    for(i=imax2(bheight,start+1);i<minend;i++) {
+      d2[offset] = d2[offset-1]+d1[offset1]-d1[offset1-bheight];
+      offset += width2;
+      offset1 += width2;
+    }
+    offset1 -= bheight;
+    for(i=imax2(height,start+1);i<end+1;i++) {
+      d2[offset] = d2[offset-1]-d1[offset1];
+      offset += width2;
+      offset1 += width2;
+    }
+  } else {
+    if(start<bheight) {
+      minend = imin2(height-1,start);
+      for(i=0;i<=minend;i++)
+	d2[offset] += d1[i*width2];
+    }
+    else 
+      for(i=start-bheight+1;i<height;i++)
+	d2[offset] += d1[i*width2];
+
+    offset += width2;
+    offset1 += width2;
+
+    minend = imin2(height,end+1);
+    for(i=start+1;i<minend;i++) {
+      d2[offset] = d2[offset-1]+d1[offset1];
+      offset += width2;
+      offset1 += width2;
+    }
+    minend = imin2(bheight,end+1);
+    for(i=imax2(height,start+1);i<minend;i++) {
+      d2[offset] = d2[offset-1];
+      offset += width2;
+      offset1 += width2;
+    }
+    offset1 -= bheight;
+    for(i=imax2(bheight,start+1);i<end+1;i++) {
+      d2[offset] = d2[offset-1]-d1[offset1];
+      offset += width2;
+      offset1 += width2;
+    }
+  }   
+}
+
+
+
+/*
+ * Calculate  the mean of each block defined by the template size: 
+ * bwidth,bheight. The first row and first column will be set to 0.
+ * The calculation is performed out place if itype is 0. If itype is 
+ * not 0, d1 is already the block sum and the calculation will be done
+ * in place.
+ * The return matrix has size (width+bwidth-1)*(height+bheight-1).
+ */
+int* iarray_blockmean(int *d1,int width,int height,int bwidth,int bheight,int itype)
+{
+  int* d2;
+  if(itype)
+    d2 = d1;
+  else
+    d2 = iarray_blocksum(d1,width,height,bwidth,bheight);
+
+  int i,j;
+  size_t offset=0;
+  int minwidth = imin2(width,bwidth);
+  int minheight = imin2(height,bheight);
+  int maxwidth = imax2(width,bwidth);
+  int maxheight = imax2(height,bheight);
+
+  int width2 = width+bwidth-1;
+  int height2 = height+bheight-1;
+
+  int* cx = (int*)malloc((size_t)width2*sizeof(int));
+
+  for(i=0;i<=width2;i++) {
+    if(i<minwidth)
+      cx[i] = i+1;
+    else { 
+      if(i>=maxwidth)
+	cx[i] = width2-i;
+      else
+	cx[i] = minwidth;
+    }
+  }
+
+  int* cy = (int*)malloc((size_t)height2*sizeof(int));
+
+  for(j=0;j<=height2;j++) {
+    if(j<minheight)
+      cy[j] = j+1;
+    else {
+      if(j>=maxheight)
+	cy[j] = height2-j;
+      else
+	cy[j] = minheight;
+    }
+  }
+
+  for(j=0;j<height2;j++) {
+    for(i=0;i<width2;i++) {
+      d2[offset] /= cx[i]*cy[j];
+      offset++;
+    }
+  }
+
+  free(cx);
+  free(cy);
+
+  return d2;
+}
+
+int* iarray_shiftdim2(int* d1,int width,int height)
+{
+  int i,j;
+  int temp;
+  size_t offset1 = 0;
+  size_t offset2 = 0;
+  for(j=0;j<height;j++) {
+    for(i=0;i<width;i++) {
+      temp = d1[offset1];
+      d1[offset1] = d1[offset2];
+      d1[offset2] = temp;
+      offset1++;
+      offset2 += width;
+    }
+    offset2 = j;
+  }
+
+  return d1;
+}
+
+int iarray_mean(const int* d1,size_t length)
+{
+  return iarray_sum(d1,length)/((int)length);
+}
+
+
+
+double iarray_sum_d(const int *d1,size_t length)
+{
+  double mu=0;
+  int i;
+  for(i=0;i<length;i++)
+    mu += (double)d1[i];
+
+  return mu;
+}
+
+double iarray_mean_d(const int *d1,size_t length)
+{
+  double mu=0;
+  int i;
+  for(i=0;i<length;i++)
+    mu += (double)d1[i];
+
+  return mu/(double)length;
+}
+
+double iarray_mean_d_m(const int *d1,size_t length, const int *mask)
+{
+  double mu=0;
+  int i;
+  size_t length2 = 0;
+  for(i=0;i<length;i++) {
+    if (mask[i] == 1) {
+      mu += (double) d1[i];
+      length2++;
+    }
+  }
+  
+  if (length2 == 0) {
+    return 0.0;
+  } else {
+    return mu/(double)length2;
+  }
+}
+
+double iarray_var(const int *d1, size_t length)
+{
+  if (length <= 1) {
+    return 0.0;
+  }
+
+  double v = 0.0;
+  double mu = 0.0;
+  size_t i;
+  for(i=0; i<length; i++) {
+    v += d1[i] * d1[i];
+    mu += d1[i];
+  }
+  
+  v /= (length - 1);
+
+  return v - mu * mu / length / (length - 1);
+}
+
+double iarray_cov(const int *d1, int *d2, size_t length)
+{
+  if (length <= 1) {
+    return 0.0;
+  }
+
+  double v= 0.0;
+  double mu1 = 0.0;
+  double mu2 = 0.0;
+  size_t i;
+  for(i=0; i<length; i++) {
+    v += d1[i] * d2[i];
+    mu1 += d1[i];
+    mu2 += d2[i];
+  }
+  
+  v /= (length - 1);
+
+  return v - mu1* mu2/ length / (length - 1);
+}
+
+int* iarray_malloc(size_t length)
+{
+  if (length <= 0) {
+    return NULL;
+  }
+
+  size_t array_size = length * sizeof(int);
+  return (int*) malloc(array_size);
+}
+
+int* iarray_calloc(size_t length)
+{
+  if (length <= 0) {
+    return NULL;
+  }
+
+  return (int*) calloc(length, sizeof(int));
+}
+
+int* iarray_malloc2(int width,int height)
+{
+  size_t array_size = (size_t) width * height;
+  return iarray_malloc(array_size);
+}
+
+int* iarray_malloc3(int width,int height,int depth)
+{
+  size_t array_size = (size_t) width * height * depth;
+  return iarray_malloc(array_size);
+}
+
+int* iarray_copy(int*d1, size_t length)
+{
+  size_t array_size = length * sizeof(int);
+  int* d2 = (int*) malloc(array_size);
+  memcpy(d2,d1,array_size);
+  return d2;
+}
+
+void iarray_clean_edge3(int* d1,int width,int height,int depth,int margin)
+{
+  size_t offset = 0;
+  int i,j,k;
+  for(k=0;k<depth;k++)
+    for(j=0;j<height;j++)
+      for(i=0;i<width;i++) {
+	if(i<=margin || j<=margin || i>=width-margin || j>=height-margin )
+	  d1[offset] = 0;
+	offset++;
+      }
+}
+
+void iarray_printf(const int *d1, size_t length, const char *format)
+{
+  size_t i;
+  for (i = 0; i < length; i++) {
+    printf(format, d1[i]);
+    printf(" ");
+  }
+  printf("\n");
+}
+
+void iarray_print2(const int* d1,int width,int height)
+{
+  if (d1 == NULL) {
+    printf("Null array.\n");
+  }
+
+  int i,j;
+  size_t offset = 0;
+  for(j=0;j<height;j++) {
+    for(i=0;i<width;i++) {
+
+
+      printf("%d  ",d1[offset]);
+
+	 
+      offset++;
+    }
+    printf("\n");
+  } 
+  printf("\n");
+}
+
+void iarray_print(const int* d1,size_t length)
+{
+  iarray_print2(d1, length, 1);
+}
+
+void iarray_fprint2(FILE *fp, const int* d1,int width,int height)
+{
+  int i,j;
+  size_t offset = 0;
+  for(j=0;j<height;j++) {
+    for(i=0;i<width;i++) {
+
+
+      fprintf(fp, "%d  ",d1[offset]);
+
+	 
+      offset++;
+    }
+    fprintf(fp, "\n");
+  } 
+  fprintf(fp, "\n");
+}
+
+void iarray_print3(const int *d1,int width,int height,int depth)
+{
+  int k;
+  size_t offset=0;
+  int plane_offset=width*height;
+
+  for(k=0;k<depth;k++){
+    printf("plane %d:\n",k);
+    iarray_print2(d1+offset,width,height);
+    offset += plane_offset;
+  }
+}
+
+int iarray_write(const char* filename,const int *d1, int length)
+{
+  FILE* fp;
+  
+  if( !(fp=fopen(filename,"wb")) ) {
+    perror(strerror(errno));
+    return 0;
+  }
+  
+  fwrite(&length, sizeof(int), 1, fp);
+  fwrite(d1,sizeof(int),length,fp);
+
+  fclose(fp);
+
+  return 1;
+}
+
+int* iarray_read(const char *filename, int *length)
+{
+  FILE* fp;
+  
+  if( !(fp=fopen(filename,"rb")) ) {
+    perror(strerror(errno));
+    return NULL;
+  }
+  
+  fread(length, sizeof(int), 1, fp);
+  int *array = iarray_malloc(*length);
+  fread(array, sizeof(int), *length, fp);
+
+  fclose(fp);
+
+  return array;
+}
+
+int iarray_read2(const char* filename, int *d1,int *length)
+{
+  FILE* fp;
+  
+  if( !(fp=fopen(filename,"rb")) ) {
+    perror(strerror(errno));
+    return 0;
+  }
+  
+  fread(length, sizeof(int), 1, fp);
+  fread(d1, sizeof(int), *length, fp);
+
+  fclose(fp);
+
+  return 1;
+}
+
+
+size_t iarray_fscanf(FILE *fp, int *d1, size_t length)
+{
+
+
+
+#define IARRAY_FSCANF(arg) fscanf(fp, "%d", arg)
+
+
+  int read_length = 0;
+  char buffer;
+  while (!feof(fp)) {
+    if (IARRAY_FSCANF(d1 + read_length) == 1) {
+      read_length++;
+    } else {
+      fread(&buffer, 1, 1, fp);
+    }
+    if (read_length >= length) {
+      break;
+    }
+  }
+
+  return read_length;
+}
+
+int* iarray_load_matrix(const char *filepath, int *d, int *m, int *n)
+{
+  FILE *fp = fopen (filepath, "r");
+
+  String_Workspace *sw = New_String_Workspace();
+
+  *m = 0;
+  *n = 0;
+  int c = 0;
+  char *line = NULL;
+  while ((line = Read_Line(fp, sw)) != NULL) {
+    if ((c = Count_Word_D(line, tz_isdlm)) > 0) {
+      *m += c;
+      (*n)++;
+      if (c * (*n) != *m) {
+	PRINT_EXCEPTION("Wrong file", "Unable to read the file");
+      }
+    }
+  }
+  
+  *m /= *n;
+
+  Kill_String_Workspace(sw);
+    /*
+    int length = 0;
+    char str[100];
+    while (Read_Word_D(fp, str, 100, tz_isdlm) > 0) {
+      length++;
+    }
+    */
+
+  if (d == NULL) {
+    d = iarray_malloc((*m) * (*n));
+  }
+
+  fseek(fp, 0, SEEK_SET);
+  iarray_fscanf(fp, d, (*m) * (*n));
+
+  fclose(fp);
+
+  return d;
+}
+
+int* iarray_load_csv(const char *filepath, int *d, int *m, int *n)
+{
+  FILE *fp = fopen (filepath, "r");
+
+  String_Workspace *sw = New_String_Workspace();
+
+  *m = 0;
+  *n = 0;
+  int c = 0;
+  char *line = NULL;
+  while ((line = Read_Line(fp, sw)) != NULL) {
+    if (line[0] == '#') {
+      continue;
+    }
+
+
+
+    if ((c = Count_Integer_D(line, tz_isdlm)) > 0) {
+
+      *m += c;
+      (*n)++;
+      if (c * (*n) != *m) {
+	PRINT_EXCEPTION("Wrong file", "Unable to read the file");
+      }
+    }
+  }
+  
+  *m /= *n;
+
+  Kill_String_Workspace(sw);
+
+  if (d == NULL) {
+    d = iarray_malloc((*m) * (*n));
+  }
+
+  fseek(fp, 0, SEEK_SET);
+  iarray_fscanf(fp, d, (*m) * (*n));
+
+  fclose(fp);
+
+  return d;
+}
+
+
+
+
+void iarraycpy(int* d1, const int* d2, size_t offset, size_t length)
+{
+  memcpy(d1 + offset,d2,length*sizeof(int));
+}
+
+void iarraycpy2(int* d1,int* d2,int width1,int height1,int width2,int height2,int col_offset,int row_offset)
+{
+  int i;
+  size_t offset1,offset2;
+  int copy_length = width2*sizeof(int);
+
+  /* offset for d1 */
+  offset1 = col_offset+ (size_t) row_offset * width1;
+
+  /* offset for d2 */
+  offset2 = 0;
+
+  for(i=0;i<height2;i++) {
+    memcpy(d1+offset1,d2+offset2,copy_length);
+    offset1 += width1;
+    offset2 += width2;
+  }
+}
+
+void iarraycpy3(int* d1,int* d2,int width1,int height1,int depth1,int width2,int height2,int depth2,int col_offset,int row_offset,int dep_offset)
+{
+  int i,k;
+  size_t offset1,offset2;
+  int copy_length = width2*sizeof(int);
+
+  int plane_offset1 = width1*height1;
+  int plane_offset2 = width2*height2;
+
+  //offset for d1
+  offset1 = col_offset+row_offset*width1+dep_offset*plane_offset1;
+
+  //offset for d2
+  offset2 = 0;
+
+  int tmpoffset1,tmpoffset2;
+
+  for(k=0;k<depth2;k++) {
+    tmpoffset1 = offset1;
+    tmpoffset2 = offset2;
+    for(i=0;i<height2;i++) {
+      memcpy(d1+offset1,d2+offset2,copy_length);
+      offset1 += width1;
+      offset2 += width2;
+    }
+    offset1 = tmpoffset1 + plane_offset1;
+    offset2 = tmpoffset2 + plane_offset2;
+  }  
+}
+
+/*Modified from http://alienryderflex.com/quicksort/*/
+void iarray_qsort(int *d1, int *idx, int length)
+{
+  #define  MAX_LEVELS  100
+  
+  if (idx != NULL) {
+    int i;
+    for (i = 0; i < length; i++) {
+      idx[i] = i;
+    }
+  }
+
+  int piv;
+  int  beg[MAX_LEVELS], end[MAX_LEVELS], i=0, L, R, swap, pivL ;
+
+  beg[0]=0; end[0]=length;
+  while (i>=0) {
+    L=beg[i]; R=end[i]-1;
+    if (L<R) {
+      piv=d1[L];
+      if (idx != NULL) {
+	pivL = idx[L];
+      }
+      while (L<R) {
+        while (d1[R]>=piv && L<R) R--; 
+	if (L<R) {
+	  if (idx != NULL) {
+	    idx[L] = idx[R];
+	  }
+	  d1[L++]=d1[R];
+	}
+        while (d1[L]<=piv && L<R) L++; 
+	if (L<R) {
+	  if (idx != NULL) {
+	    idx[R] = idx[L];
+	  }
+	  d1[R--]=d1[L]; 
+	}
+      }
+      d1[L]=piv; 
+      if (idx != NULL) {
+	idx[L]=pivL;
+      }
+      beg[i+1]=L+1; 
+      end[i+1]=end[i]; end[i++]=L;
+      if (end[i]-beg[i]>end[i-1]-beg[i-1]) {
+        swap=beg[i]; beg[i]=beg[i-1]; beg[i-1]=swap;
+        swap=end[i]; end[i]=end[i-1]; end[i-1]=swap; 
+      }
+    } else {
+      i--;
+    }
+  }
+
+  #undef MAX_LEVELS
+}
+
+int iarray_binsearch(int *d1, int length, int value)
+{
+  if (length == 1) {
+    if (d1[0] == value) {
+      return 0;
+    }
+  } else {
+    int begin = 0;
+    int end = length - 1;
+    int index = 0;
+    do {
+      index = (begin + end) / 2;
+      if (value == d1[index]) {
+	return index;
+      } else if (value < d1[index]) {
+	end = index - 1;
+      } else {
+	begin = index + 1;
+      }
+    } while (begin < end);
+
+    if (value == d1[begin]) {
+      return begin;
+    }
+  }
+
+  return -1;
+}
+
+
+void iarray_myqsort(int *d1, int length)
+{
+  if ((length <= 1) || (d1 == NULL)){
+    return;
+  }
+
+  int tmp;
+
+  if (length == 2) {
+    if (d1[0] > d1[1]) {
+      tmp = d1[0];
+      d1[0] = d1[1];
+      d1[1] = tmp;
+    }
+
+    return;
+  }
+
+  int pivot_pos = (length - 1)/ 2;
+  int left = 0;
+  int right = length - 2;
+  int pivot;
+
+  /* remove the pivot to last*/
+  pivot = d1[pivot_pos];
+  d1[pivot_pos] = d1[length - 1];
+  d1[length - 1] = pivot;
+
+  while (left <= right) {
+    if ((d1[right] < pivot) && (d1[left] > pivot)) {
+      tmp = d1[left];
+      d1[left] = d1[right];
+      d1[right] = tmp;
+      left++;
+      right--;
+    } else {
+      if (d1[left] <= pivot) {
+	left++;
+      } 
+    
+      if (d1[right] >= pivot) {
+	right--;
+      }
+    }
+  }
+
+  pivot_pos = right + 1;
+  d1[length - 1] = d1[pivot_pos];
+  d1[pivot_pos] = pivot;
+
+  iarray_myqsort(d1, pivot_pos);
+  iarray_myqsort(d1 + pivot_pos + 1, length - pivot_pos - 1);
+}
+
+
+double iarray_uint8_corrcoef(const int *filter, const tz_uint8 *signal, 
+    size_t length)
+{
+  int *dsignal  = (int *) malloc(sizeof(int) * length);
+  size_t i;
+  int is_constant = 1;
+
+  for (i = 0; i < length-1; i++) {
+    if (signal[i] != signal[i+1]) {
+      is_constant = 0;
+      break;
+    }
+  }
+
+  if (is_constant == 1) {
+    free(dsignal);
+    return 0.0;
+  }
+
+  for (i = 0; i < length; i++) {
+    dsignal[i] = (int) signal[i];
+  }
+
+  double c = iarray_corrcoef(filter, dsignal, length);
+  free(dsignal);
+
+  return c;
+}
+
+double iarray_corrcoef_m(const int *d1, const int *d2, size_t length,
+		       const int *mask)
+{
+  double mu1 = iarray_mean_d_m(d1,length,mask);
+  double mu2 = iarray_mean_d_m(d2,length,mask);
+  double r,v1,v2;
+  double sd1,sd2; 
+  size_t i;
+
+  r = v1 = v2 = 0.0;
+  
+  for(i=0;i<length;i++) {
+    if (mask[i] == 1) {
+      sd1 = (double)d1[i] - mu1;
+      sd2 = (double)d2[i] - mu2;
+      r += sd1*sd2;
+      v1 += sd1*sd1;
+      v2 += sd2*sd2;
+    }
+  }
+  
+  if ((v1 == 0.0) || (v2 == 0.0)) {
+    return 0.0;
+  }
+
+  return r/sqrt(v1*v2);
+}
+
+double iarray_corrcoef(const int *d1, const int *d2, size_t length)
+{
+  double mu1 = iarray_mean_d(d1,length);
+  double mu2 = iarray_mean_d(d2,length);
+  double r,v1,v2;
+  double sd1,sd2; 
+  size_t i;
+
+  r = v1 = v2 = 0.0;
+  
+  for(i=0;i<length;i++) {
+    sd1 = (double)d1[i] - mu1;
+    sd2 = (double)d2[i] - mu2;
+    r += sd1*sd2;
+    v1 += sd1*sd1;
+    v2 += sd2*sd2;
+  }
+  
+  if ((v1 == 0.0) || (v2 == 0.0)) {
+    return 0.0;
+  }
+
+  return r/sqrt(v1*v2);
+}
+
+
+
+
+
+int* iarray_medfilter(const int *in, size_t length, int wndsize, int *out)
+{
+  if (out == NULL) {
+    out = iarray_malloc(length);
+  }
+
+  int *buffer = iarray_malloc(wndsize);
+
+  size_t i;
+  int right_span = wndsize / 2;
+  int left_span = wndsize - right_span - 1;
+
+  for (i = 0; i < length; i++) {
+    size_t left_side = 0;
+    if (i > left_span) {
+      left_side = i - left_span;
+    }
+    //imax2(i - left_span, 0);
+    size_t right_side = imin2(i + right_span, length - 1);
+    size_t size = right_side - left_side + 1;
+    memcpy(buffer, in + left_side, sizeof(int) * size);
+    //printf("%d\n", right_side - left_side + 1);
+    iarray_qsort(buffer, NULL, size);
+
+    size_t medpos = size / 2;
+    if (size % 2 == 0) {
+      if (buffer[medpos - 1] == in[i]) {
+        out[i] = in[i];
+      } else {
+        out[i] = buffer[medpos];
+      }
+    } else {
+      out[i] = buffer[medpos];
+    }
+  }
+
+  free(buffer);
+
+  return out;
+}
+
+
+
+int iarray_iszero(const int *d, size_t length)
+{
+#ifdef HAVE_LIBGSL
+  
+  
+  
+  gsl_vector_int_const_view v = gsl_vector_int_const_view_array(d, length);
+  return gsl_vector_int_isnull(&(v.vector));
+  
+#else
+  size_t i;
+  for (i = 0; i < length; i++) {
+    if (d[i] != 0) {
+      return 0;
+    }
+  }
+
+  return 1;
+#endif
+}
+
+int* iarray_contarray(size_t start, size_t end, int *d)
+{
+  if (start > end) {
+    return NULL;
+  }
+
+  if (d == NULL) {
+    d = iarray_malloc(end - start + 1);
+  }
+
+  int i;
+  int offset = 0;
+
+  for (i = start; i <= end; i++) {
+    d[offset++] = i;
+  }
+
+  return d;
+}
+
+
+void iarray_reverse(int *d, size_t length)
+{
+  if (length <= 1) {
+    return;
+  }
+
+  size_t length2 = length / 2;
+  size_t i, j;
+  int temp;
+  for (i = 0, j = length - 1; i < length2; i++, j--) {
+    temp = d[i]; 
+    d[i] = d[j];
+    d[j] = temp;
+  }
+}
@@ -1004,6 +1004,7 @@ void Write_Raw_Stack(const char *filepath, const Stack *stack)
     size_t remaining = nvoxel * dataType;
     int j = 0;
     size_t nwrite = 0;
+    int failed = 0;
     fclose(fp);
     while (remaining > 0) {
       fp = Guarded_Fopen((char*) filepath, "ab", "Write_Raw_Stack");
@@ -1015,13 +1016,15 @@ void Write_Raw_Stack(const char *filepath, const Stack *stack)
         nwrite += fwrite(stack->array + j * buffersize, 1, remaining, fp);
         remaining = 0;
       }
+      /* the stream cannot be checked after it is closed */
+      if (ferror(fp)) {
+        failed = 1;
+      }
       fclose(fp);
     }
-    if (ferror(fp) || feof(fp)) {
+    if (failed) {
       printf("num of voxel: %zd\nactual written voxel: %zd\n", nvoxel, nwrite);
       perror("fwrite");
-      printf("ferror: %d  feof: %d\n", ferror(fp), feof(fp));
-      fclose(fp);
       TZ_ERROR(ERROR_IO_WRITE);
     }
   } else {
@@ -2429,6 +2432,540 @@ Mc_Stack* Read_V3dpbd(const char *filepath, int channel)
   return stack;
 }
 
+/* clip_block(): clip the block (<x>, <y>, <z>, <width>, <height>, <depth>)
+ * against a stack of size <sw> x <sh> x <sd>. A negative size means to the end
+ * of the stack. It returns 0 if nothing is left after clipping.
+ */
+static int clip_block(int sw, int sh, int sd, int *x, int *y, int *z,
+                      int *width, int *height, int *depth)
+{
+  int *start[3] = { x, y, z };
+  int *size[3] = { width, height, depth };
+  int bound[3] = { sw, sh, sd };
+
+  int i;
+  for (i = 0; i < 3; i++) {
+    if (*size[i] < 0) {
+      *size[i] = bound[i] - *start[i];
+    }
+    if (*start[i] < 0) {
+      *size[i] += *start[i];
+      *start[i] = 0;
+    }
+    if (*start[i] + *size[i] > bound[i]) {
+      *size[i] = bound[i] - *start[i];
+    }
+    if (*size[i] <= 0) {
+      return 0;
+    }
+  }
+
+  return 1;
+}
+
+/* copy_plane_block(): copy the <width> x <height> rectangle at (<x>, <y>) of
+ * the plane <src>, whose row length is <src_width>, to <dst>.
+ */
+static void copy_plane_block(uint8 *dst, const uint8 *src, int kind,
+                             int src_width, int x, int y,
+                             int width, int height)
+{
+  size_t row_bytes = (size_t) width * kind;
+  size_t src_row_bytes = (size_t) src_width * kind;
+  src += y * src_row_bytes + (size_t) x * kind;
+
+  if (row_bytes == src_row_bytes) {
+    memcpy(dst, src, row_bytes * height);
+  } else {
+    int j;
+    for (j = 0; j < height; j++) {
+      memcpy(dst, src, row_bytes);
+      dst += row_bytes;
+      src += src_row_bytes;
+    }
+  }
+}
+
+/* read_raw_header(): read the header of a v3d raw file. The size is stored in
+ * <sz> as width, height, depth and channel number. It returns 0 if the header
+ * is invalid.
+ */
+static int read_raw_header(FILE *fp, int *kind, size_t *sz)
+{
+  char formatkey[] = "raw_image_stack_by_hpeng";
+  int lenkey = strlen(formatkey);
+  if (fread(formatkey, 1, lenkey, fp) != (size_t) lenkey) {
+    return 0;
+  }
+
+  if (strcmp(formatkey, "raw_image_stack_by_hpeng") != 0) {
+    return 0;
+  }
+
+  char endian;
+  uint16_t dataType;
+  char sz_buffer[16];
+  if (fread(&endian, 1, 1, fp) != 1 || fread(&dataType, 2, 1, fp) != 1 ||
+      fread(sz_buffer, 1, 8, fp) != 8) {
+    return 0;
+  }
+
+  int i;
+  for (i = 0; i < 4; i++) {
+    sz[i] = *((uint16_t*) (sz_buffer + i * 2));
+    if (endian == 'B') {
+      sz[i] = Flip_Endian_U16(sz[i]);
+    }
+  }
+
+  if (endian == 'B') {
+    dataType = Flip_Endian_U16(dataType);
+  }
+
+  if ((sz[0] == 0) || (sz[1] == 0) || (sz[2] == 0) || (sz[3] == 0)) {
+    if (fread(sz_buffer + 8, 1, 8, fp) != 8) {
+      return 0;
+    }
+
+    for (i = 0; i < 4; i++) {
+      sz[i] = *((uint32_t*) (sz_buffer + i * 4));
+      if (endian == 'B') {
+        sz[i] = Flip_Endian_U32(sz[i]);
+      }
+    }
+  }
+
+  *kind = dataType;
+
+  return 1;
+}
+
+/* read_in_chunks(): fread in 1G chunks to work around the fread bug for big
+ * files.
+ */
+static size_t read_in_chunks(uint8 *buffer, size_t nbyte, FILE *fp)
+{
+  size_t buffersize = (size_t) 1024 * 1024 * 1024;
+  size_t nread = 0;
+  while (nread < nbyte) {
+    size_t chunk = nbyte - nread;
+    if (chunk > buffersize) {
+      chunk = buffersize;
+    }
+    size_t n = fread(buffer + nread, 1, chunk, fp);
+    nread += n;
+    if (n < chunk) {
+      break;
+    }
+  }
+
+  return nread;
+}
+
+static Mc_Stack* read_raw_block(const char *filepath, int channel,
+                                int x, int y, int z,
+                                int width, int height, int depth)
+{
+  FILE *fp = fopen(filepath, "rb");
+  if (fp == NULL) {
+    return NULL;
+  }
+
+  int kind = 0;
+  size_t sz[4];
+  if (!read_raw_header(fp, &kind, sz)) {
+    PRINT_EXCEPTION("Invalid format", "Not a raw stack.");
+    fclose(fp);
+    return NULL;
+  }
+
+  if (channel >= (int) sz[3]) {
+    PRINT_EXCEPTION("wrong channel", "multi-channel image can not be read");
+    fclose(fp);
+    return NULL;
+  }
+
+  if (!clip_block(sz[0], sz[1], sz[2], &x, &y, &z, &width, &height, &depth)) {
+    fclose(fp);
+    return NULL;
+  }
+
+  long data_offset = ftell(fp);
+  int nchannel = (channel < 0) ? sz[3] : 1;
+  Mc_Stack *stack = Make_Mc_Stack(kind, width, height, depth, nchannel);
+
+  size_t src_row_bytes = sz[0] * kind;
+  size_t src_plane_bytes = src_row_bytes * sz[1];
+  size_t row_bytes = (size_t) width * kind;
+  size_t plane_bytes = row_bytes * height;
+  uint8 *dst = stack->array;
+  size_t nbyte = 0;
+
+  int c;
+  for (c = 0; c < nchannel; c++) {
+    int src_channel = (channel < 0) ? c : channel;
+    size_t channel_offset = data_offset + sz[2] * src_plane_bytes * src_channel;
+    if (plane_bytes == src_plane_bytes) {
+      /* whole planes are contiguous in the file */
+      fseek(fp, channel_offset + z * src_plane_bytes, SEEK_SET);
+      nbyte = plane_bytes * depth;
+      if (read_in_chunks(dst, nbyte, fp) != nbyte) {
+        break;
+      }
+      dst += nbyte;
+    } else {
+      int k;
+      for (k = 0; k < depth; k++) {
+        size_t plane_offset = channel_offset + (z + k) * src_plane_bytes;
+        if (row_bytes == src_row_bytes) {
+          fseek(fp, plane_offset + y * src_row_bytes, SEEK_SET);
+          nbyte = plane_bytes;
+          if (read_in_chunks(dst, nbyte, fp) != nbyte) {
+            break;
+          }
+          dst += nbyte;
+        } else {
+          int j;
+          nbyte = row_bytes;
+          for (j = 0; j < height; j++) {
+            fseek(fp, plane_offset + (y + j) * src_row_bytes + x * kind,
+                  SEEK_SET);
+            if (fread(dst, 1, nbyte, fp) != nbyte) {
+              break;
+            }
+            dst += nbyte;
+          }
+          if (j < height) {
+            break;
+          }
+        }
+      }
+      if (k < depth) {
+        break;
+      }
+    }
+  }
+
+  fclose(fp);
+
+  if (c < nchannel) {
+    PRINT_EXCEPTION("Reading failed", "The raw file is truncated.");
+    Kill_Mc_Stack(stack);
+    stack = NULL;
+  }
+
+  return stack;
+}
+
+/* open_tiff_stack(): open a tif or lsm stack and get its attributes. The
+ * number of planes is counted by walking through the IFD headers. It returns
+ * NULL if the file cannot be read.
+ */
+static Tiff_Reader* open_tiff_stack(const char *filepath, int *is_lsm,
+                                    int *width, int *height, int *depth,
+                                    int *kind, int *nchannel)
+{
+  *is_lsm = Is_Lsm(filepath);
+  Tiff_Reader *reader = Open_Tiff_Reader((char *) filepath, NULL, *is_lsm);
+  if (reader == NULL) {
+    return NULL;
+  }
+
+  /* The attributes come from the first plane */
+  Tiff_IFD *ifd = Read_Tiff_IFD(reader);
+  Tiff_Image *image = NULL;
+  if (ifd != NULL) {
+    image = Extract_Image_From_IFD(ifd);
+  }
+  if (image == NULL) {
+    if (ifd != NULL) {
+      Free_Tiff_IFD(ifd);
+    }
+    Kill_Tiff_Reader(reader);
+    TZ_ERROR(ERROR_POINTER_NULL);
+    return NULL;
+  }
+
+  *width = image->width;
+  *height = image->height;
+  *kind = image->channels[0]->bytes_per_pixel;
+  *nchannel = image->number_channels;
+  Free_Tiff_Image(image);
+  Free_Tiff_IFD(ifd);
+
+  /* Counting planes of a tif only walks through the IFD headers. Thumbnails
+   * in an lsm file can only be told by their tags. */
+  *depth = 0;
+  Rewind_Tiff_Reader(reader);
+  while (!End_Of_Tiff(reader)) {
+    if (*is_lsm) {
+      ifd = Read_Tiff_IFD(reader);
+      if (ifd == NULL) {
+        break;
+      }
+      if (!lsm_thumbnail_flag(ifd)) {
+        (*depth)++;
+      }
+      Free_Tiff_IFD(ifd);
+    } else {
+      if (Advance_Tiff_Reader(reader) != 0) {
+        break;
+      }
+      (*depth)++;
+    }
+  }
+
+  return reader;
+}
+
+static Mc_Stack* read_tiff_block(const char *filepath, int channel,
+                                 int x, int y, int z,
+                                 int width, int height, int depth)
+{
+  int is_lsm, stack_width, stack_height, stack_depth, kind, nchannel;
+  Tiff_Reader *reader = open_tiff_stack(filepath, &is_lsm, &stack_width,
+                                        &stack_height, &stack_depth, &kind,
+                                        &nchannel);
+  if (reader == NULL) {
+    return NULL;
+  }
+
+  Tiff_IFD *ifd = NULL;
+  Tiff_Image *image = NULL;
+
+  if (channel >= nchannel) {
+    PRINT_EXCEPTION("wrong channel", "multi-channel image can not be read");
+    channel = -1;
+    stack_depth = 0;
+  }
+
+  Mc_Stack *stack = NULL;
+  if (stack_depth > 0 &&
+      clip_block(stack_width, stack_height, stack_depth,
+                 &x, &y, &z, &width, &height, &depth)) {
+    int nchannel_out = (channel >= 0) ? 1 : nchannel;
+    stack = Make_Mc_Stack(kind, width, height, depth, nchannel_out);
+    size_t plane_bytes = (size_t) kind * width * height;
+    size_t channel_bytes = plane_bytes * depth;
+
+    Rewind_Tiff_Reader(reader);
+    int plane = 0;
+    while (!End_Of_Tiff(reader) && plane < z + depth) {
+      if (!is_lsm && plane < z) {
+        /* skip the IFD without reading its image data */
+        if (Advance_Tiff_Reader(reader) != 0) {
+          break;
+        }
+        plane++;
+        continue;
+      }
+
+      ifd = Read_Tiff_IFD(reader);
+      if (ifd == NULL) {
+        break;
+      }
+
+      if (is_lsm && lsm_thumbnail_flag(ifd)) {
+        Free_Tiff_IFD(ifd);
+        continue;
+      }
+
+      if (plane >= z) {
+        image = Extract_Image_From_IFD(ifd);
+        if (image == NULL) {
+          Free_Tiff_IFD(ifd);
+          break;
+        }
+        int c;
+        for (c = 0; c < stack->nchannel; c++) {
+          int src_channel = (channel >= 0) ? channel : c;
+          copy_plane_block(stack->array + c * channel_bytes +
+                           (plane - z) * plane_bytes,
+                           (uint8*) image->channels[src_channel]->plane,
+                           kind, stack_width, x, y, width, height);
+        }
+        Free_Tiff_Image(image);
+      }
+      Free_Tiff_IFD(ifd);
+      plane++;
+    }
+
+    if (plane < z + depth) {
+      PRINT_EXCEPTION("Reading failed", "Failed to read all planes.");
+      Kill_Mc_Stack(stack);
+      stack = NULL;
+    }
+  }
+
+  Reset_Tiff_Image();
+  Reset_Tiff_IFD();
+  Kill_Tiff_Reader(reader);
+
+  return stack;
+}
+
+/* downsample_mc_slab(): downsample the first <depth> planes of each channel
+ * of <slab>, which are the <k>th block of planes along Z, into the slice <k>
+ * of <out>.
+ */
+static void downsample_mc_slab(const Mc_Stack *slab, int depth,
+                               int wintv, int hintv, int dintv,
+                               Stack_Downsample_Method_e method,
+                               int k, Mc_Stack *out)
+{
+  int c;
+  for (c = 0; c < out->nchannel; c++) {
+    Stack src = Mc_Stack_Channel(slab, c);
+    src.depth = depth;
+    Stack dst = Mc_Stack_Channel(out, c);
+    dst.array += (size_t) k * dst.kind * dst.width * dst.height;
+    dst.depth = 1;
+    Downsample_Stack_Slab(&src, wintv, hintv, dintv, method, 0, 0, &dst);
+  }
+}
+
+static Mc_Stack* read_tiff_downsample(const char *filepath, int channel,
+                                      int wintv, int hintv, int dintv,
+                                      Stack_Downsample_Method_e method)
+{
+  int is_lsm, width, height, depth, kind, nchannel;
+  Tiff_Reader *reader = open_tiff_stack(filepath, &is_lsm, &width, &height,
+                                        &depth, &kind, &nchannel);
+  if (reader == NULL) {
+    return NULL;
+  }
+
+  if (channel >= nchannel) {
+    PRINT_EXCEPTION("wrong channel", "multi-channel image can not be read");
+    depth = 0;
+  }
+
+  Mc_Stack *stack = NULL;
+  if (depth > 0) {
+    int out_width, out_height, out_depth;
+    Downsample_Stack_Max_Size(width, height, depth, wintv, hintv, dintv,
+                              &out_width, &out_height, &out_depth);
+    int nchannel_out = (channel >= 0) ? 1 : nchannel;
+    stack = Make_Mc_Stack(kind, out_width, out_height, out_depth,
+                          nchannel_out);
+
+    /* Only the first plane of each block is needed for nearest sampling. */
+    int slab_depth = (method == STACK_DOWNSAMPLE_NEAREST) ? 1 : dintv + 1;
+    Mc_Stack *slab = Make_Mc_Stack(kind, width, height, slab_depth,
+                                   nchannel_out);
+    size_t plane_bytes = (size_t) kind * width * height;
+    size_t channel_bytes = plane_bytes * slab_depth;
+
+    Rewind_Tiff_Reader(reader);
+    int plane = 0;
+    while (!End_Of_Tiff(reader) && plane < depth) {
+      int k = plane / (dintv + 1);
+      int rk = plane % (dintv + 1);
+      if (!is_lsm && rk >= slab_depth) {
+        if (Advance_Tiff_Reader(reader) != 0) {
+          break;
+        }
+        plane++;
+        continue;
+      }
+
+      Tiff_IFD *ifd = Read_Tiff_IFD(reader);
+      if (ifd == NULL) {
+        break;
+      }
+
+      if (is_lsm && lsm_thumbnail_flag(ifd)) {
+        Free_Tiff_IFD(ifd);
+        continue;
+      }
+
+      if (rk < slab_depth) {
+        Tiff_Image *image = Extract_Image_From_IFD(ifd);
+        if (image == NULL) {
+          Free_Tiff_IFD(ifd);
+          break;
+        }
+        int c;
+        for (c = 0; c < nchannel_out; c++) {
+          int src_channel = (channel >= 0) ? channel : c;
+          memcpy(slab->array + c * channel_bytes + rk * plane_bytes,
+                 image->channels[src_channel]->plane, plane_bytes);
+        }
+        Free_Tiff_Image(image);
+
+        if (rk == slab_depth - 1 || plane == depth - 1) {
+          downsample_mc_slab(slab, rk + 1, wintv, hintv, dintv, method, k,
+                             stack);
+        }
+      }
+      Free_Tiff_IFD(ifd);
+      plane++;
+    }
+
+    Kill_Mc_Stack(slab);
+
+    if (plane < depth) {
+      PRINT_EXCEPTION("Reading failed", "Failed to read all planes.");
+      Kill_Mc_Stack(stack);
+      stack = NULL;
+    }
+  }
+
+  Reset_Tiff_Image();
+  Reset_Tiff_IFD();
+  Kill_Tiff_Reader(reader);
+
+  return stack;
+}
+
+static Mc_Stack* read_raw_downsample(const char *filepath, int channel,
+                                     int wintv, int hintv, int dintv,
+                                     Stack_Downsample_Method_e method)
+{
+  FILE *fp = fopen(filepath, "rb");
+  if (fp == NULL) {
+    return NULL;
+  }
+
+  int kind = 0;
+  size_t sz[4];
+  int valid = read_raw_header(fp, &kind, sz);
+  fclose(fp);
+
+  if (!valid) {
+    PRINT_EXCEPTION("Invalid format", "Not a raw stack.");
+    return NULL;
+  }
+
+  if (channel >= (int) sz[3]) {
+    PRINT_EXCEPTION("wrong channel", "multi-channel image can not be read");
+    return NULL;
+  }
+
+  int out_width, out_height, out_depth;
+  Downsample_Stack_Max_Size(sz[0], sz[1], sz[2], wintv, hintv, dintv,
+                            &out_width, &out_height, &out_depth);
+  int nchannel = (channel < 0) ? sz[3] : 1;
+  Mc_Stack *stack = Make_Mc_Stack(kind, out_width, out_height, out_depth,
+                                  nchannel);
+
+  int slab_depth = (method == STACK_DOWNSAMPLE_NEAREST) ? 1 : dintv + 1;
+  int k;
+  for (k = 0; k < out_depth; k++) {
+    Mc_Stack *slab = read_raw_block(filepath, channel, 0, 0, k * (dintv + 1),
+                                    -1, -1, slab_depth);
+    if (slab == NULL) {
+      Kill_Mc_Stack(stack);
+      return NULL;
+    }
+    downsample_mc_slab(slab, slab->depth, wintv, hintv, dintv, method, k,
+                       stack);
+    Kill_Mc_Stack(slab);
+  }
+
+  return stack;
+}
+
 Mc_Stack* Read_Mc_Stack(const char *filepath, int channel)
 {
   if (Is_Raw(filepath)) {
@@ -2549,113 +3086,7 @@ Mc_Stack* Read_Mc_Stack(const char *filepath, int channel)
     Stack *stack = Read_Xml_Stack(filepath);
     return Mc_Stack_Rewrap_Stack(stack);
   } else if (Is_Lsm(filepath) || Is_Tiff(filepath)) {
-    int width = 0;
-    int height = 0;
-    int depth = 0;
-    int kind = 0;
-    int nchannel = 0;
-
-    Tiff_Image *image = NULL;
-    Tiff_IFD *ifd = NULL;
-
-    /* Get stack information */
-    Tiff_Reader *reader;
-
-    if (Is_Lsm(filepath)) {
-      reader = Open_Tiff_Reader((char *) filepath,NULL,1);
-    } else {
-      reader = Open_Tiff_Reader((char *) filepath,NULL,0);
-    }
-
-    ifd = Read_Tiff_IFD(reader);
-    //Print_Tiff_IFD(ifd, stdout);
-
-    image = Extract_Image_From_IFD(ifd);
-
-    if (image == NULL) {
-      TZ_ERROR(ERROR_POINTER_NULL);
-    } else {
-      width = image->width;
-      height = image->height;
-      kind = image->channels[0]->bytes_per_pixel;
-
-      depth  = 1;
-      while (!End_Of_Tiff(reader)) {
-        ifd = Read_Tiff_IFD(reader);
-        if (!(Is_Lsm(filepath) && lsm_thumbnail_flag(ifd))) {
-          depth++;
-        }
-        Free_Tiff_IFD(ifd);
-      }
-    }
-
-    nchannel = image->number_channels;
-
-    Free_Tiff_Image(image);
-
-    int nchannel_out = nchannel;
-
-    if (channel >= 0) {
-      nchannel_out = 1;
-    }
-
-    Mc_Stack *mc_stack = Make_Mc_Stack(kind, width, height, depth, nchannel_out);
-    size_t bytes_per_plane = kind * width * height;
-    size_t offset = 0;
-    Rewind_Tiff_Reader(reader);
-    uint8 **mc_stack_array = (uint8**)malloc(sizeof(uint8*)*nchannel_out);
-    if (!mc_stack_array) { TZ_ERROR(ERROR_DATA_VALUE); }
-    if ((nchannel_out > 1) && (channel < 0)) {
-      int length = bytes_per_plane * mc_stack->depth;
-      mc_stack_array[0] = mc_stack->array;
-      int i;
-      for (i = 1; i < nchannel; i++) {
-        mc_stack_array[i] = mc_stack_array[i-1] + length;
-      }
-    } else if (nchannel == 1) {
-      channel = 0;
-    }
-
-    while (!End_Of_Tiff(reader)) {
-      ifd = Read_Tiff_IFD(reader);
-      if (!(Is_Lsm(filepath) && lsm_thumbnail_flag(ifd))) {
-        image = Extract_Image_From_IFD(ifd);
-        if (image == NULL) {
-          TZ_ERROR(ERROR_POINTER_NULL);
-        }
-
-        if (nchannel == 1) {
-          if (channel > 0) {
-            TZ_ERROR(ERROR_DATA_TYPE);
-          } else {
-            memcpy(mc_stack->array + offset, image->channels[channel]->plane,
-                bytes_per_plane);
-            offset += bytes_per_plane;
-          }
-        } else { /* multi-channel stack */
-          if (channel >= 0) { /* only extract one channel */
-            memcpy(mc_stack->array + offset, image->channels[channel]->plane,
-                bytes_per_plane);
-            offset += bytes_per_plane;
-          } else {
-            int i;
-            for (i = 0; i < nchannel; i++) {
-              memcpy(mc_stack_array[i] + offset, image->channels[i]->plane, bytes_per_plane);
-            }
-            offset += bytes_per_plane;
-          }
-        }
-        Free_Tiff_Image(image);
-      }
-      Free_Tiff_IFD(ifd);
-    }
-
-    free(mc_stack_array);
-    Reset_Tiff_Image();
-    Reset_Tiff_IFD();
-    Kill_Tiff_Reader(reader);
-
-    return mc_stack;
+    return read_tiff_block(filepath, channel, 0, 0, 0, -1, -1, -1);
   } else if (Is_Png(filepath)) {
     Stack *stack = Read_Stack_U(filepath);
     Mc_Stack *mc_stack =
@@ -2680,6 +3111,299 @@ Mc_Stack* Read_Mc_Stack(const char *filepath, int channel)
   return NULL;
 }
 
+Mc_Stack* Read_Mc_Stack_Block(const char *filepath, int channel,
+                              int x, int y, int z,
+                              int width, int height, int depth)
+{
+  if (!fexist(filepath)) {
+    return NULL;
+  }
+
+  if (Is_Raw(filepath)) {
+    return read_raw_block(filepath, channel, x, y, z, width, height, depth);
+  }
+
+  if (Is_Lsm(filepath) || Is_Tiff(filepath)) {
+    return read_tiff_block(filepath, channel, x, y, z, width, height, depth);
+  }
+
+  /* No partial reading for other formats. */
+  Mc_Stack *stack = Read_Mc_Stack(filepath, channel);
+  if (stack == NULL) {
+    return NULL;
+  }
+
+  Mc_Stack *block = NULL;
+  if (clip_block(stack->width, stack->height, stack->depth,
+                 &x, &y, &z, &width, &height, &depth)) {
+    block = Make_Mc_Stack(stack->kind, width, height, depth, stack->nchannel);
+    size_t plane_bytes = (size_t) stack->kind * stack->width * stack->height;
+    size_t block_plane_bytes = (size_t) stack->kind * width * height;
+    int c, k;
+    for (c = 0; c < stack->nchannel; c++) {
+      for (k = 0; k < depth; k++) {
+        copy_plane_block(block->array + (c * depth + k) * block_plane_bytes,
+                         stack->array +
+                         ((size_t) c * stack->depth + z + k) * plane_bytes,
+                         stack->kind, stack->width, x, y, width, height);
+      }
+    }
+  }
+  Kill_Mc_Stack(stack);
+
+  return block;
+}
+
+Mc_Stack* Read_Mc_Stack_Downsample(const char *filepath, int channel,
+                                   int wintv, int hintv, int dintv,
+                                   Stack_Downsample_Method_e method)
+{
+  if (!fexist(filepath)) {
+    return NULL;
+  }
+
+  if (Is_Raw(filepath)) {
+    return read_raw_downsample(filepath, channel, wintv, hintv, dintv,
+                               method);
+  }
+
+  if (Is_Lsm(filepath) || Is_Tiff(filepath)) {
+    return read_tiff_downsample(filepath, channel, wintv, hintv, dintv,
+                                method);
+  }
+
+  /* Other formats are downsampled after being read entirely. */
+  Mc_Stack *stack = Read_Mc_Stack(filepath, channel);
+  if (stack == NULL) {
+    return NULL;
+  }
+
+  int out_width, out_height, out_depth;
+  Downsample_Stack_Max_Size(stack->width, stack->height, stack->depth,
+                            wintv, hintv, dintv,
+                            &out_width, &out_height, &out_depth);
+  Mc_Stack *out = Make_Mc_Stack(stack->kind, out_width, out_height, out_depth,
+                                stack->nchannel);
+  int c;
+  for (c = 0; c < stack->nchannel; c++) {
+    Stack src = Mc_Stack_Channel(stack, c);
+    Stack dst = Mc_Stack_Channel(out, c);
+    Downsample_Stack_Slab(&src, wintv, hintv, dintv, method, 0, out_depth - 1,
+                          &dst);
+  }
+  Kill_Mc_Stack(stack);
+
+  return out;
+}
+
+struct _Mc_Stack_Plane_Reader {
+  int channel;
+  int kind;
+  int width;
+  int height;
+  int depth;
+  int nchannel;
+  int next_plane;
+  int is_lsm;
+  Tiff_Reader *tiff;
+  FILE *raw;
+  long raw_offset;
+};
+
+/* clean_mc_stack_plane_reader(): close the file opened by <reader>. */
+static void clean_mc_stack_plane_reader(Mc_Stack_Plane_Reader *reader)
+{
+  if (reader->tiff != NULL) {
+    Reset_Tiff_Image();
+    Reset_Tiff_IFD();
+    Kill_Tiff_Reader(reader->tiff);
+    reader->tiff = NULL;
+  }
+
+  if (reader->raw != NULL) {
+    fclose(reader->raw);
+    reader->raw = NULL;
+  }
+}
+
+Mc_Stack_Plane_Reader* Open_Mc_Stack_Plane_Reader(const char *filepath,
+                                                  int channel)
+{
+  if (!fexist(filepath)) {
+    return NULL;
+  }
+
+  Mc_Stack_Plane_Reader reader;
+  reader.channel = channel;
+  reader.next_plane = 0;
+  reader.is_lsm = 0;
+  reader.tiff = NULL;
+  reader.raw = NULL;
+  reader.raw_offset = 0;
+
+  if (Is_Raw(filepath)) {
+    reader.raw = fopen(filepath, "rb");
+    if (reader.raw == NULL) {
+      return NULL;
+    }
+    size_t sz[4];
+    if (!read_raw_header(reader.raw, &(reader.kind), sz)) {
+      PRINT_EXCEPTION("Invalid format", "Not a raw stack.");
+      fclose(reader.raw);
+      return NULL;
+    }
+    reader.width = sz[0];
+    reader.height = sz[1];
+    reader.depth = sz[2];
+    reader.nchannel = sz[3];
+    reader.raw_offset = ftell(reader.raw);
+  } else if (Is_Lsm(filepath) || Is_Tiff(filepath)) {
+    reader.tiff = open_tiff_stack(filepath, &(reader.is_lsm), &(reader.width),
+                                  &(reader.height), &(reader.depth),
+                                  &(reader.kind), &(reader.nchannel));
+    if (reader.tiff == NULL) {
+      return NULL;
+    }
+    Rewind_Tiff_Reader(reader.tiff);
+  } else {
+    return NULL;
+  }
+
+  if (channel >= reader.nchannel) {
+    PRINT_EXCEPTION("wrong channel", "multi-channel image can not be read");
+    reader.depth = 0;
+    clean_mc_stack_plane_reader(&reader);
+    return NULL;
+  }
+
+  if (channel >= 0) {
+    reader.nchannel = 1;
+  }
+
+  Mc_Stack_Plane_Reader *result =
+    (Mc_Stack_Plane_Reader*) Guarded_Malloc(sizeof(Mc_Stack_Plane_Reader),
+                                            "Open_Mc_Stack_Plane_Reader");
+  *result = reader;
+
+  return result;
+}
+
+void Mc_Stack_Plane_Reader_Attribute(const Mc_Stack_Plane_Reader *reader,
+                                     int *kind, int *width, int *height,
+                                     int *depth, int *nchannel)
+{
+  *kind = reader->kind;
+  *width = reader->width;
+  *height = reader->height;
+  *depth = reader->depth;
+  *nchannel = reader->nchannel;
+}
+
+/* read_tiff_next_planes(): decode the next <depth> planes of <reader> into
+ * <stack>. It returns the number of planes read.
+ */
+static int read_tiff_next_planes(Mc_Stack_Plane_Reader *reader,
+                                 Mc_Stack *stack, int depth)
+{
+  size_t plane_bytes = (size_t) reader->kind * reader->width * reader->height;
+  size_t channel_bytes = plane_bytes * depth;
+
+  int k = 0;
+  while (k < depth && !End_Of_Tiff(reader->tiff)) {
+    Tiff_IFD *ifd = Read_Tiff_IFD(reader->tiff);
+    if (ifd == NULL) {
+      break;
+    }
+
+    if (reader->is_lsm && lsm_thumbnail_flag(ifd)) {
+      Free_Tiff_IFD(ifd);
+      continue;
+    }
+
+    Tiff_Image *image = Extract_Image_From_IFD(ifd);
+    if (image == NULL) {
+      Free_Tiff_IFD(ifd);
+      break;
+    }
+    int c;
+    for (c = 0; c < stack->nchannel; c++) {
+      int src_channel = (reader->channel >= 0) ? reader->channel : c;
+      memcpy(stack->array + c * channel_bytes + k * plane_bytes,
+             image->channels[src_channel]->plane, plane_bytes);
+    }
+    Free_Tiff_Image(image);
+    Free_Tiff_IFD(ifd);
+    k++;
+  }
+
+  return k;
+}
+
+/* read_raw_next_planes(): read the next <depth> planes of <reader> into
+ * <stack>. It returns the number of planes read.
+ */
+static int read_raw_next_planes(Mc_Stack_Plane_Reader *reader,
+                                Mc_Stack *stack, int depth)
+{
+  size_t plane_bytes = (size_t) reader->kind * reader->width * reader->height;
+  size_t nbyte = plane_bytes * depth;
+
+  int c;
+  for (c = 0; c < stack->nchannel; c++) {
+    int src_channel = (reader->channel >= 0) ? reader->channel : c;
+    fseek(reader->raw, reader->raw_offset +
+          plane_bytes * (reader->depth * (size_t) src_channel +
+                         reader->next_plane), SEEK_SET);
+    if (read_in_chunks(stack->array + nbyte * c, nbyte, reader->raw) !=
+        nbyte) {
+      return 0;
+    }
+  }
+
+  return depth;
+}
+
+Mc_Stack* Read_Mc_Stack_Next_Planes(Mc_Stack_Plane_Reader *reader,
+                                    int depth)
+{
+  if (depth > reader->depth - reader->next_plane) {
+    depth = reader->depth - reader->next_plane;
+  }
+
+  if (depth <= 0) {
+    return NULL;
+  }
+
+  Mc_Stack *stack = Make_Mc_Stack(reader->kind, reader->width, reader->height,
+                                  depth, reader->nchannel);
+  int nplane = 0;
+  if (reader->tiff != NULL) {
+    nplane = read_tiff_next_planes(reader, stack, depth);
+  } else if (reader->raw != NULL) {
+    nplane = read_raw_next_planes(reader, stack, depth);
+  }
+
+  if (nplane < depth) {
+    PRINT_EXCEPTION("Reading failed", "Failed to read all planes.");
+    Kill_Mc_Stack(stack);
+    /* The position in the file is lost */
+    reader->next_plane = reader->depth;
+    return NULL;
+  }
+
+  reader->next_plane += depth;
+
+  return stack;
+}
+
+void Kill_Mc_Stack_Plane_Reader(Mc_Stack_Plane_Reader *reader)
+{
+  if (reader != NULL) {
+    clean_mc_stack_plane_reader(reader);
+    free(reader);
+  }
+}
+
 Stack* Read_Sc_Stack(const char *filepath, int channel)
 {
   if (!fexist(filepath)) {
@@ -2866,6 +3590,7 @@ void Write_Mc_Stack(const char *filepath, const Mc_Stack *stack,
       size_t remaining = nvoxel * dataType * stack->nchannel;
       int j = 0;
       size_t nwrite = 0;
+      int failed = 0;
       fclose(fp);
       while (remaining > 0) {
         fp = Guarded_Fopen((char*) filepath, "ab", "Write_Raw_Stack");
@@ -2878,14 +3603,16 @@ void Write_Mc_Stack(const char *filepath, const Mc_Stack *stack,
           nwrite += fwrite(stack->array + j * buffersize, 1, remaining, fp);
           remaining = 0;
         }
+        /* the stream cannot be checked after it is closed */
+        if (ferror(fp)) {
+          failed = 1;
+        }
         fclose(fp);
       }
 
-      if (ferror(fp) || feof(fp)) {
+      if (failed) {
         printf("num of voxel: %zd\nactual written voxel: %zd\n", nvoxel, nwrite);
         perror("fwrite");
-        printf("ferror: %d  feof: %d\n", ferror(fp), feof(fp));
-        fclose(fp);
         TZ_ERROR(ERROR_IO_WRITE);
       }
     } else {
@@ -249,6 +249,74 @@ void Read_Stack_Offset(const char *filepath, int *x, int *y, int *z);
  * -1.
  */
 Mc_Stack* Read_Mc_Stack(const char *filepath, int channel);
+
+/**@brief Read a block of a multi-channel stack.
+ *
+ * Read_Mc_Stack_Block() reads the block that starts at (<x>, <y>, <z>) and has
+ * the size <width> x <height> x <depth> from the stack file <filepath>.
+ * <channel> has the same meaning as in Read_Mc_Stack(). A negative size means
+ * to the end of the stack along that dimension and the block is clipped by the
+ * stack boundary. For tif and lsm files, only the planes in the block are
+ * decoded; for raw files, only the voxels in the block are read from the disk.
+ * Other formats are read entirely and then cropped. It returns NULL if the
+ * block is outside the stack or the file cannot be read.
+ */
+Mc_Stack* Read_Mc_Stack_Block(const char *filepath, int channel,
+                              int x, int y, int z,
+                              int width, int height, int depth);
+
+/**@brief Read a multi-channel stack with downsampling.
+ *
+ * Read_Mc_Stack_Downsample() reads the stack file <filepath> and downsamples
+ * each channel with the intervals <wintv>, <hintv> and <dintv> by <method>,
+ * as Downsample_Stack_Slab() does. <channel> has the same meaning as in
+ * Read_Mc_Stack(). For tif, lsm and raw files, the planes are read one block
+ * of <dintv> + 1 planes at a time and reduced right away, so the stack is
+ * never loaded at full resolution. Other formats are read entirely before
+ * downsampling. It returns NULL if the file cannot be read.
+ */
+Mc_Stack* Read_Mc_Stack_Downsample(const char *filepath, int channel,
+                                   int wintv, int hintv, int dintv,
+                                   Stack_Downsample_Method_e method);
+
+/* Reader of the planes of a stack file in order. */
+typedef struct _Mc_Stack_Plane_Reader Mc_Stack_Plane_Reader;
+
+/**@brief Open a stack file for reading its planes in order.
+ *
+ * Open_Mc_Stack_Plane_Reader() opens the tif, lsm or raw file <filepath> and
+ * keeps it open, so that consecutive calls of Read_Mc_Stack_Next_Planes()
+ * continue from where the last one stopped instead of walking through the
+ * file from the start. <channel> has the same meaning as in Read_Mc_Stack().
+ * It returns NULL if the file cannot be read or is in another format. The
+ * reader should be freed by Kill_Mc_Stack_Plane_Reader().
+ *
+ * The tif decoder shares its buffers among all readers, so only one tif or lsm
+ * file can be read at a time.
+ */
+Mc_Stack_Plane_Reader* Open_Mc_Stack_Plane_Reader(const char *filepath,
+                                                  int channel);
+
+/**@brief Attributes of the stack read by a plane reader.
+ *
+ * <nchannel> is the number of channels in the stacks returned by
+ * Read_Mc_Stack_Next_Planes().
+ */
+void Mc_Stack_Plane_Reader_Attribute(const Mc_Stack_Plane_Reader *reader,
+                                     int *kind, int *width, int *height,
+                                     int *depth, int *nchannel);
+
+/**@brief Read the next planes.
+ *
+ * Read_Mc_Stack_Next_Planes() reads at most <depth> planes following the ones
+ * that have been read by <reader>. It returns NULL if there is no plane left
+ * or reading fails, in which case no more planes can be read.
+ */
+Mc_Stack* Read_Mc_Stack_Next_Planes(Mc_Stack_Plane_Reader *reader,
+                                    int depth);
+
+void Kill_Mc_Stack_Plane_Reader(Mc_Stack_Plane_Reader *reader);
+
 void Write_Mc_Stack(const char *filepath, const Mc_Stack *stack, 
 		    const char *metafile);
 
@@ -58,6 +58,14 @@ typedef union _Image_Array {
   color_t *arrayc;      /**< rgb color array */
 } Image_Array;
 
+/**@brief Stack downsampling methods.
+ */
+typedef enum {
+  STACK_DOWNSAMPLE_NEAREST, /**< first voxel of each block */
+  STACK_DOWNSAMPLE_MEAN,    /**< mean of each block */
+  STACK_DOWNSAMPLE_MAX      /**< maximum of each block */
+} Stack_Downsample_Method_e;
+
 #define CREATE_IMAGE_ARRAY(ima, image)	\
   Image_Array ima;			\
   ima.array = image->array;
@@ -0,0 +1,484 @@
+/* tz_arraylist.c.t
+ *
+ * 15-Feb-2008 Initial write: Ting Zhao
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "tz_error.h"
+#include "tz_utilities.h"
+#include "tz_int64_arraylist.h"
+
+INIT_EXCEPTION
+
+const static int Growth_Coeff = 2; /* growth factor */
+
+/* int64_arraylist_grow(): Grow an arraylist.
+ *
+ * Args: a - the arraylist to grow.
+ *
+ * Return: void.
+ */
+static void int64_arraylist_grow(Int64_Arraylist *a)
+{
+  if (a->capacity == 0) {
+    a->capacity = Growth_Coeff;
+    a->array = (int64_t *) Guarded_Malloc(sizeof(int64_t) * a->capacity, 
+				       "int64_arraylist_grow");
+  } else {
+    int new_capacity = Growth_Coeff * a->capacity;
+  
+    int64_t *new_array = (int64_t *) Guarded_Calloc(new_capacity, sizeof(int64_t),
+					      "int64_arraylist_grow");
+    memcpy(new_array, a->array, sizeof(int64_t) * a->capacity);
+    free(a->array);
+    a->array = new_array;
+    a->capacity = new_capacity;
+  }
+}
+
+/* Print_Int64_Arraylist(): Prints an array list.
+ * 
+ * Args: a - the arraylist to print.
+ *       format - printing format. This is mainly for priliminary data elements.
+ *
+ * Return: void.
+ */
+void Print_Int64_Arraylist(const Int64_Arraylist *a, const char *format)
+{
+  int i;
+  printf("%d elements: ", a->length);
+  for  (i = 0; i < a->length; i++) {
+    printf(format, a->array[i]);
+    printf(" ");
+  }
+  
+  printf("\n");
+}
+
+Int64_Arraylist* New_Int64_Arraylist()
+{
+  return Int64_Arraylist_New(0, 1);
+}
+
+/* Int64_Arraylist_New(): New an arraylist.
+ * 
+ * Args: length - length of the arraylist;
+ *       margin - margin of the arraylist. This means the capacity of the
+ *                arraylist will be <length> + <margin>.
+ * 
+ * Return: a new arraylist.
+ */
+Int64_Arraylist* Int64_Arraylist_New(int length, int margin)
+{
+  if ((length < 0) || margin < 0) {
+    TZ_WARN(ERROR_DATA_VALUE);
+    return NULL;
+  }
+
+  Int64_Arraylist *a = (Int64_Arraylist *) Guarded_Malloc(sizeof(Int64_Arraylist), 
+							"Int64_Arraylist_New");
+  a->length = length;
+  a->capacity = length + margin;
+  if (a->capacity > 0) {
+    a->array = (int64_t *) Guarded_Malloc(sizeof(int64_t) * a->capacity, 
+				       "Int64_Arraylist_New");
+  } else {
+    a->array = NULL;
+  }
+
+  return a;
+}
+
+/* Int64_Arraylist_Free(): Free an array list.
+ *
+ * Args: a - the array list to free.
+ *
+ * Return: void.
+ */
+void Int64_Arraylist_Free(Int64_Arraylist *a)
+{
+  free(a->array);
+  free(a);
+}
+
+Int64_Arraylist* Make_Int64_Arraylist(int length, int margin)
+{
+  if ((length < 0) || margin < 0) {
+    TZ_WARN(ERROR_DATA_VALUE);
+    return NULL;
+  }
+
+  Int64_Arraylist *a = (Int64_Arraylist *) Guarded_Malloc(sizeof(Int64_Arraylist), 
+							"Int64_Arraylist_New");
+  a->length = length;
+  a->capacity = length + margin;
+  if (a->capacity > 0) {
+    a->array = (int64_t *) Guarded_Malloc(sizeof(int64_t) * a->capacity, 
+				       "Int64_Arraylist_New");
+  } else {
+    a->array = NULL;
+  }
+
+  return a;
+}
+
+void Kill_Int64_Arraylist(Int64_Arraylist *a)
+{
+  
+  
+  free(a->array);
+  free(a);
+}
+
+Int64_Arraylist* Int64_Arraylist_Wrap(int64_t *array, int n)
+{
+  if (array == NULL) {
+    return NULL;
+  }
+
+  Int64_Arraylist *a = (Int64_Arraylist *) Guarded_Malloc(sizeof(Int64_Arraylist), 
+							"Int64_Arraylist_New");
+  a->length = n;
+  a->capacity = n;
+  a->array = array;
+
+  return a;
+}
+
+int64_t Int64_Arraylist_At(const Int64_Arraylist *a, int index)
+{
+  return a->array[index];
+}
+
+int64_t Int64_Arraylist_Last(const Int64_Arraylist *a)
+{
+  return a->array[a->length - 1];
+}
+
+int64_t* Int64_Arraylist_At_R(const Int64_Arraylist *a, int index)
+{
+  return a->array + index;
+}
+
+/* Int64_Arraylist_Add(): Add an element to an array list.
+ *
+ * Args: <a> - the arraylist to manipulate;
+ *       <item> - the element to add.
+ *
+ * Return: void.
+ */
+void Int64_Arraylist_Add(Int64_Arraylist *a, int64_t item)
+{
+  a->length++;
+
+  if (a->length >= a->capacity) {
+    int64_arraylist_grow(a);
+  }
+
+  a->array[a->length - 1] = item;
+}
+
+void Int64_Arraylist_Insert(Int64_Arraylist *a, int index, int64_t item)
+{
+  if (index < a->length) {
+    a->length++;
+    if (a->length >= a->capacity) {
+      int64_arraylist_grow(a);
+    }
+
+    memmove(a->array + index + 1, a->array + index, 
+	    sizeof(int64_t) * (a->length - index - 1));
+  }
+
+  Int64_Arraylist_Set(a, index, item);
+}
+
+int64_t Int64_Arraylist_Take(Int64_Arraylist *a, int index)
+{
+  int64_t data = a->array[index];
+  a->length--;
+  memmove(a->array + index, a->array + index + 1, 
+	  sizeof(int64_t) * (a->length - index));
+
+  return data;
+}
+
+int64_t Int64_Arraylist_Take_Last(Int64_Arraylist *a)
+{
+  int64_t data = a->array[a->length - 1];
+  a->length--;
+
+  return data;
+}
+
+void Int64_Arraylist_Set_Length(Int64_Arraylist *a, int length)
+{
+  TZ_ASSERT(length >= 0, "Negative length");
+
+  a->length = length;
+
+  while (a->length > a->capacity) {
+    int64_arraylist_grow(a);
+  }
+}
+
+void Int64_Arraylist_Set(Int64_Arraylist *a, int index, int64_t item)
+{
+  if (index >= a->length) {
+    a->length = index + 1;
+  }
+
+  while (a->length > a->capacity) {
+    int64_arraylist_grow(a);
+  }
+  
+
+  a->array[index] = item;
+}
+
+/* Int64_Arraylist_Swap(): Swap two elements
+ * 
+ * Args: a - the arraylist to manipulate;
+ *       idx1 - index of the first element;
+ *       idx2 - index of the second element.
+ *
+ * Return: void.
+ */
+void Int64_Arraylist_Swap(Int64_Arraylist *a, int idx1, int idx2)
+{
+  if ((idx1 < 0) || (idx1 >= a->length) || (idx2 < 0) || (idx2 >= a->length)) {
+    TZ_WARN(ERROR_DATA_VALUE);
+    return;
+  }
+  
+  int64_t tmp;
+  tmp = a->array[idx1];
+  a->array[idx1] = a->array[idx2];
+  a->array[idx2] = tmp;
+}
+
+/* Int64_Heap_Depth(): Get the depth of a heap.
+ *
+ * Args: h - the heap.
+ *
+ * Return: the depth of the heap. It returns 0 if h is NULL.
+ */
+int Int64_Heap_Depth(const Int64_Arraylist *h)
+{
+  int depth = 0;
+  int length = h->length - 1;
+  while (length > 0) {
+    length >>= 1;
+    depth++;
+  }
+
+  return depth;
+}
+
+/* Int64_Heap_Node_At(): Get a certain node from a heap.
+ *
+ * Args: h - input heap;
+ *       depth - depth of the node;
+ *       rank - rank of the node at its depth. It's counted from left to right
+ *              and the first sibling has rank 0.
+ *
+ * Return: the value of the node.
+ */
+int64_t Int64_Heap_Node_At(const Int64_Arraylist *h, int depth, int rank)
+{
+  int index = 1;
+  index <<= (depth - 1);
+  index += rank;
+
+  if (index >= h->length) {
+    THROW(ERROR_DATA_VALUE;);
+  }
+
+  return h->array[index];
+}
+
+/* Print_Int64_Heap(): Print a heap.
+ *
+ * Args: h - the heap to print.
+ *
+ * Return: void.
+ */
+void Print_Int64_Heap(const Int64_Arraylist *h, const char *format)
+{
+  printf("A heap with depth %d:\n", Int64_Heap_Depth(h));
+  int i;
+  for (i = 1; i < h->length; i++) {
+    printf(format, h->array[i]);
+    printf(" ");
+    if ((i & (i + 1)) == 0) { /* i = 2^k - 1*/
+      printf("\n");
+    }
+  }
+  printf("\n");
+}
+
+/* Int64_Heap_Parent(): Get the parent of a node.
+ * 
+ * Args: h - the heap to query;
+ *       child_index - index of the child node.
+ *
+ * Return: the index of the parent node. It returns 0 when there is no valid
+ *         parent.
+ */
+int Int64_Heap_Parent(const Int64_Arraylist *h, int child_index)
+{
+  if ((child_index <= 1) || (child_index >= h->length)) {
+    return 0;
+  } else {
+    return child_index / 2;
+  }
+}
+
+/* Int64_Heap_Child(): Get the left child of a node.
+ * 
+ * Args: h - the heap to query;
+ *       parent_index - index of the parent node.
+ *
+ * Return: the index of the parent node. It returns 0 when there is no valid
+ *         left child.
+ */
+int Int64_Heap_Leftchild(const Int64_Arraylist *h, int parent_index)
+{
+  if ((parent_index < 1) || (parent_index >= h->length)) {
+    return 0;
+  }
+
+  int child_index = parent_index * 2;
+  if (child_index >= h->length) {
+    return 0;
+  }
+
+  return child_index;
+}
+
+/* Int64_Heap_Small_Child(): Get the index of the smaller child of a node.
+ *
+ * Args: h - the heap to query;
+ *       parent_index - index of the node whose children are examined.
+ *
+ * Return: index of the smaller child.
+ */
+int Int64_Heap_Small_Child(const Int64_Arraylist *h, int parent_index)
+{
+  int index = Int64_Heap_Leftchild(h, parent_index);
+  if ((index > 0) && (index + 1 < h->length)) {
+    if (h->array[index] > h->array[index + 1]) {
+      index++;
+    }
+  }
+
+  return index;
+}
+
+/* Int64_Heap_Add(): Add a node to a heap.
+ *
+ * Args: h - the heap to manipulate;
+ *       item - the added node.
+ *
+ * Return: void.
+ */
+void Int64_Heap_Add(Int64_Arraylist *h, int64_t item)
+{
+  if (h->length == 0) { 
+    /* ensure the preserved element */
+    Int64_Arraylist_Add(h, 0);
+  }
+
+  Int64_Arraylist_Add(h, item);
+
+  int child_index = h->length - 1;
+  int parent_index = Int64_Heap_Parent(h, child_index);
+  while (parent_index > 0) {
+    if (h->array[child_index] < h->array[parent_index]) {
+      Int64_Arraylist_Swap(h, child_index, parent_index);
+      child_index = parent_index;
+      parent_index = Int64_Heap_Parent(h, child_index);
+    } else {
+      break;
+    }
+  }
+}
+
+/* Int64_Heap_Remove(): Remove the root of a heap.
+ *
+ * Args: h - the heap to manipulate.
+ *
+ * Return: the value of the removed node.
+ */
+int64_t Int64_Heap_Remove(Int64_Arraylist *h)
+{
+  int64_t root = h->array[1];
+  h->array[1] = h->array[h->length - 1];
+  h->length--;
+  
+  int parent_index = 1;
+  int child_index = Int64_Heap_Small_Child(h, parent_index);
+  while (child_index > 0) {
+    if (h->array[parent_index] > h->array[child_index]) {
+      Int64_Arraylist_Swap(h, parent_index, child_index);
+      parent_index = child_index;
+      child_index = Int64_Heap_Small_Child(h, parent_index);
+    } else {
+      break;
+    }
+  }
+
+  return root;
+}
+
+#define PARENT_INDEX(index) ((index) / 2)
+
+/*
+static int parent_index(int index)
+{
+  return index / 2;
+}
+*/
+
+BOOL Verify_Int64_Heap(Int64_Arraylist *h)
+{
+  int i;
+  for (i = h->length - 1; i > 1; i--) {
+    int pid = PARENT_INDEX(i);
+    if (h->array[i] < h->array[pid]) {
+      //printf("%g -> %g\n", value[h->array[i]], value[h->array[pid]]);
+      return i;
+    }
+  }
+  
+  return 0;
+}
+
+
+/* Int64_Heap_Sort(): sort an array list using heap sort.
+ *
+ * Args: a - the array list to sort
+ *
+ * Return: void.
+ */
+void Int64_Heap_Sort(Int64_Arraylist *a)
+{
+  Int64_Arraylist *h = Int64_Arraylist_New(1, a->length);
+  
+  Int64_Arraylist_Add(h, a->array[0]);
+  
+  int scan_pos = 1;
+  while (scan_pos < a->length) {
+    Int64_Heap_Add(h, a->array[scan_pos++]);
+  }
+
+  int i;
+  int length = a->length;
+  a->length = 0;
+  for (i = 0; i < length; i++) {
+    Int64_Arraylist_Add(a, Int64_Heap_Remove(h));
+  }
+}
+
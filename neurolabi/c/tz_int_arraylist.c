@@ -0,0 +1,645 @@
+/* tz_arraylist.c.t
+ *
+ * 15-Feb-2008 Initial write: Ting Zhao
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "tz_error.h"
+#include "tz_utilities.h"
+#include "tz_int_arraylist.h"
+
+INIT_EXCEPTION
+
+const static int Growth_Coeff = 2; /* growth factor */
+
+/* int_arraylist_grow(): Grow an arraylist.
+ *
+ * Args: a - the arraylist to grow.
+ *
+ * Return: void.
+ */
+static void int_arraylist_grow(Int_Arraylist *a)
+{
+  if (a->capacity == 0) {
+    a->capacity = Growth_Coeff;
+    a->array = (int *) Guarded_Malloc(sizeof(int) * a->capacity, 
+				       "int_arraylist_grow");
+  } else {
+    int new_capacity = Growth_Coeff * a->capacity;
+  
+    int *new_array = (int *) Guarded_Calloc(new_capacity, sizeof(int),
+					      "int_arraylist_grow");
+    memcpy(new_array, a->array, sizeof(int) * a->capacity);
+    free(a->array);
+    a->array = new_array;
+    a->capacity = new_capacity;
+  }
+}
+
+/* Print_Int_Arraylist(): Prints an array list.
+ * 
+ * Args: a - the arraylist to print.
+ *       format - printing format. This is mainly for priliminary data elements.
+ *
+ * Return: void.
+ */
+void Print_Int_Arraylist(const Int_Arraylist *a, const char *format)
+{
+  int i;
+  printf("%d elements: ", a->length);
+  for  (i = 0; i < a->length; i++) {
+    printf(format, a->array[i]);
+    printf(" ");
+  }
+  
+  printf("\n");
+}
+
+Int_Arraylist* New_Int_Arraylist()
+{
+  return Int_Arraylist_New(0, 1);
+}
+
+/* Int_Arraylist_New(): New an arraylist.
+ * 
+ * Args: length - length of the arraylist;
+ *       margin - margin of the arraylist. This means the capacity of the
+ *                arraylist will be <length> + <margin>.
+ * 
+ * Return: a new arraylist.
+ */
+Int_Arraylist* Int_Arraylist_New(int length, int margin)
+{
+  if ((length < 0) || margin < 0) {
+    TZ_WARN(ERROR_DATA_VALUE);
+    return NULL;
+  }
+
+  Int_Arraylist *a = (Int_Arraylist *) Guarded_Malloc(sizeof(Int_Arraylist), 
+							"Int_Arraylist_New");
+  a->length = length;
+  a->capacity = length + margin;
+  if (a->capacity > 0) {
+    a->array = (int *) Guarded_Malloc(sizeof(int) * a->capacity, 
+				       "Int_Arraylist_New");
+  } else {
+    a->array = NULL;
+  }
+
+  return a;
+}
+
+/* Int_Arraylist_Free(): Free an array list.
+ *
+ * Args: a - the array list to free.
+ *
+ * Return: void.
+ */
+void Int_Arraylist_Free(Int_Arraylist *a)
+{
+  free(a->array);
+  free(a);
+}
+
+Int_Arraylist* Make_Int_Arraylist(int length, int margin)
+{
+  if ((length < 0) || margin < 0) {
+    TZ_WARN(ERROR_DATA_VALUE);
+    return NULL;
+  }
+
+  Int_Arraylist *a = (Int_Arraylist *) Guarded_Malloc(sizeof(Int_Arraylist), 
+							"Int_Arraylist_New");
+  a->length = length;
+  a->capacity = length + margin;
+  if (a->capacity > 0) {
+    a->array = (int *) Guarded_Malloc(sizeof(int) * a->capacity, 
+				       "Int_Arraylist_New");
+  } else {
+    a->array = NULL;
+  }
+
+  return a;
+}
+
+void Kill_Int_Arraylist(Int_Arraylist *a)
+{
+  
+  
+  free(a->array);
+  free(a);
+}
+
+Int_Arraylist* Int_Arraylist_Wrap(int *array, int n)
+{
+  if (array == NULL) {
+    return NULL;
+  }
+
+  Int_Arraylist *a = (Int_Arraylist *) Guarded_Malloc(sizeof(Int_Arraylist), 
+							"Int_Arraylist_New");
+  a->length = n;
+  a->capacity = n;
+  a->array = array;
+
+  return a;
+}
+
+int Int_Arraylist_At(const Int_Arraylist *a, int index)
+{
+  return a->array[index];
+}
+
+int Int_Arraylist_Last(const Int_Arraylist *a)
+{
+  return a->array[a->length - 1];
+}
+
+int* Int_Arraylist_At_R(const Int_Arraylist *a, int index)
+{
+  return a->array + index;
+}
+
+/* Int_Arraylist_Add(): Add an element to an array list.
+ *
+ * Args: <a> - the arraylist to manipulate;
+ *       <item> - the element to add.
+ *
+ * Return: void.
+ */
+void Int_Arraylist_Add(Int_Arraylist *a, int item)
+{
+  a->length++;
+
+  if (a->length >= a->capacity) {
+    int_arraylist_grow(a);
+  }
+
+  a->array[a->length - 1] = item;
+}
+
+void Int_Arraylist_Insert(Int_Arraylist *a, int index, int item)
+{
+  if (index < a->length) {
+    a->length++;
+    if (a->length >= a->capacity) {
+      int_arraylist_grow(a);
+    }
+
+    memmove(a->array + index + 1, a->array + index, 
+	    sizeof(int) * (a->length - index - 1));
+  }
+
+  Int_Arraylist_Set(a, index, item);
+}
+
+int Int_Arraylist_Take(Int_Arraylist *a, int index)
+{
+  int data = a->array[index];
+  a->length--;
+  memmove(a->array + index, a->array + index + 1, 
+	  sizeof(int) * (a->length - index));
+
+  return data;
+}
+
+int Int_Arraylist_Take_Last(Int_Arraylist *a)
+{
+  int data = a->array[a->length - 1];
+  a->length--;
+
+  return data;
+}
+
+void Int_Arraylist_Set_Length(Int_Arraylist *a, int length)
+{
+  TZ_ASSERT(length >= 0, "Negative length");
+
+  a->length = length;
+
+  while (a->length > a->capacity) {
+    int_arraylist_grow(a);
+  }
+}
+
+void Int_Arraylist_Set(Int_Arraylist *a, int index, int item)
+{
+  if (index >= a->length) {
+    a->length = index + 1;
+  }
+
+  while (a->length > a->capacity) {
+    int_arraylist_grow(a);
+  }
+  
+  int i;
+  for (i = a->length; i < a->capacity; ++i) {
+    a->array[i] = 0;
+  }
+  
+
+  a->array[index] = item;
+}
+
+/* Int_Arraylist_Swap(): Swap two elements
+ * 
+ * Args: a - the arraylist to manipulate;
+ *       idx1 - index of the first element;
+ *       idx2 - index of the second element.
+ *
+ * Return: void.
+ */
+void Int_Arraylist_Swap(Int_Arraylist *a, int idx1, int idx2)
+{
+  if ((idx1 < 0) || (idx1 >= a->length) || (idx2 < 0) || (idx2 >= a->length)) {
+    TZ_WARN(ERROR_DATA_VALUE);
+    return;
+  }
+  
+  int tmp;
+  tmp = a->array[idx1];
+  a->array[idx1] = a->array[idx2];
+  a->array[idx2] = tmp;
+}
+
+/* Int_Heap_Depth(): Get the depth of a heap.
+ *
+ * Args: h - the heap.
+ *
+ * Return: the depth of the heap. It returns 0 if h is NULL.
+ */
+int Int_Heap_Depth(const Int_Arraylist *h)
+{
+  int depth = 0;
+  int length = h->length - 1;
+  while (length > 0) {
+    length >>= 1;
+    depth++;
+  }
+
+  return depth;
+}
+
+/* Int_Heap_Node_At(): Get a certain node from a heap.
+ *
+ * Args: h - input heap;
+ *       depth - depth of the node;
+ *       rank - rank of the node at its depth. It's counted from left to right
+ *              and the first sibling has rank 0.
+ *
+ * Return: the value of the node.
+ */
+int Int_Heap_Node_At(const Int_Arraylist *h, int depth, int rank)
+{
+  int index = 1;
+  index <<= (depth - 1);
+  index += rank;
+
+  if (index >= h->length) {
+    THROW(ERROR_DATA_VALUE;);
+  }
+
+  return h->array[index];
+}
+
+/* Print_Int_Heap(): Print a heap.
+ *
+ * Args: h - the heap to print.
+ *
+ * Return: void.
+ */
+void Print_Int_Heap(const Int_Arraylist *h, const char *format)
+{
+  printf("A heap with depth %d:\n", Int_Heap_Depth(h));
+  int i;
+  for (i = 1; i < h->length; i++) {
+    printf(format, h->array[i]);
+    printf(" ");
+    if ((i & (i + 1)) == 0) { /* i = 2^k - 1*/
+      printf("\n");
+    }
+  }
+  printf("\n");
+}
+
+/* Int_Heap_Parent(): Get the parent of a node.
+ * 
+ * Args: h - the heap to query;
+ *       child_index - index of the child node.
+ *
+ * Return: the index of the parent node. It returns 0 when there is no valid
+ *         parent.
+ */
+int Int_Heap_Parent(const Int_Arraylist *h, int child_index)
+{
+  if ((child_index <= 1) || (child_index >= h->length)) {
+    return 0;
+  } else {
+    return child_index / 2;
+  }
+}
+
+/* Int_Heap_Child(): Get the left child of a node.
+ * 
+ * Args: h - the heap to query;
+ *       parent_index - index of the parent node.
+ *
+ * Return: the index of the parent node. It returns 0 when there is no valid
+ *         left child.
+ */
+int Int_Heap_Leftchild(const Int_Arraylist *h, int parent_index)
+{
+  if ((parent_index < 1) || (parent_index >= h->length)) {
+    return 0;
+  }
+
+  int child_index = parent_index * 2;
+  if (child_index >= h->length) {
+    return 0;
+  }
+
+  return child_index;
+}
+
+/* Int_Heap_Small_Child(): Get the index of the smaller child of a node.
+ *
+ * Args: h - the heap to query;
+ *       parent_index - index of the node whose children are examined.
+ *
+ * Return: index of the smaller child.
+ */
+int Int_Heap_Small_Child(const Int_Arraylist *h, int parent_index)
+{
+  int index = Int_Heap_Leftchild(h, parent_index);
+  if ((index > 0) && (index + 1 < h->length)) {
+    if (h->array[index] > h->array[index + 1]) {
+      index++;
+    }
+  }
+
+  return index;
+}
+
+/* Int_Heap_Add(): Add a node to a heap.
+ *
+ * Args: h - the heap to manipulate;
+ *       item - the added node.
+ *
+ * Return: void.
+ */
+void Int_Heap_Add(Int_Arraylist *h, int item)
+{
+  if (h->length == 0) { 
+    /* ensure the preserved element */
+    Int_Arraylist_Add(h, 0);
+  }
+
+  Int_Arraylist_Add(h, item);
+
+  int child_index = h->length - 1;
+  int parent_index = Int_Heap_Parent(h, child_index);
+  while (parent_index > 0) {
+    if (h->array[child_index] < h->array[parent_index]) {
+      Int_Arraylist_Swap(h, child_index, parent_index);
+      child_index = parent_index;
+      parent_index = Int_Heap_Parent(h, child_index);
+    } else {
+      break;
+    }
+  }
+}
+
+/* Int_Heap_Remove(): Remove the root of a heap.
+ *
+ * Args: h - the heap to manipulate.
+ *
+ * Return: the value of the removed node.
+ */
+int Int_Heap_Remove(Int_Arraylist *h)
+{
+  int root = h->array[1];
+  h->array[1] = h->array[h->length - 1];
+  h->length--;
+  
+  int parent_index = 1;
+  int child_index = Int_Heap_Small_Child(h, parent_index);
+  while (child_index > 0) {
+    if (h->array[parent_index] > h->array[child_index]) {
+      Int_Arraylist_Swap(h, parent_index, child_index);
+      parent_index = child_index;
+      child_index = Int_Heap_Small_Child(h, parent_index);
+    } else {
+      break;
+    }
+  }
+
+  return root;
+}
+
+#define PARENT_INDEX(index) ((index) / 2)
+
+/*
+static int parent_index(int index)
+{
+  return index / 2;
+}
+*/
+
+BOOL Verify_Int_Heap(Int_Arraylist *h)
+{
+  int i;
+  for (i = h->length - 1; i > 1; i--) {
+    int pid = PARENT_INDEX(i);
+    if (h->array[i] < h->array[pid]) {
+      //printf("%g -> %g\n", value[h->array[i]], value[h->array[pid]]);
+      return i;
+    }
+  }
+  
+  return 0;
+}
+
+int Int_Heap_Small_Child_I(const Int_Arraylist *h, int parent_index, double *value)
+{
+  int index = Int_Heap_Leftchild(h, parent_index);
+  if (index > 0) {
+    if (index + 1 < h->length) {
+      if (value[h->array[index]] > value[h->array[index + 1]]) {
+	index++;
+      }
+    }
+  }
+
+  return index;
+}
+
+void Int_Heap_Add_I(Int_Arraylist *h, int item, double *value, int *checked)
+{
+  if (h->length == 0) { 
+    /* ensure the preserved element */
+    Int_Arraylist_Add(h, 0);
+  }
+
+  Int_Arraylist_Add(h, item);
+
+  checked[item] = h->length;
+  int child_index = checked[item] - 1;
+  int parent_index = Int_Heap_Parent(h, child_index);
+  while (parent_index > 0) {
+    if (value[h->array[child_index]] < value[h->array[parent_index]]) {
+      Int_Arraylist_Swap(h, child_index, parent_index);
+      checked[h->array[parent_index]] = parent_index + 1;
+      checked[h->array[child_index]] = child_index + 1;
+      child_index = parent_index;
+      parent_index = Int_Heap_Parent(h, child_index);
+    } else {
+      break;
+    }
+  }
+}
+
+void Int_Heap_Update_I(Int_Arraylist *h, int item, double *value, 
+			int *checked)
+{
+  int child_index = checked[item] - 1;
+  int parent_index = Int_Heap_Parent(h, child_index);
+  while (parent_index > 0) {
+    if (value[h->array[child_index]] < value[h->array[parent_index]]) {
+      Int_Arraylist_Swap(h, child_index, parent_index);
+      checked[h->array[parent_index]] = parent_index + 1;
+      checked[h->array[child_index]] = child_index + 1;
+      child_index = parent_index;
+      parent_index = Int_Heap_Parent(h, child_index);
+    } else {
+      break;
+    }
+  }
+}
+
+int Int_Heap_Remove_I(Int_Arraylist *h, double *value, int *checked)
+{
+  int root = h->array[1];
+  checked[root] = 0;
+  h->array[1] = h->array[h->length - 1];
+  h->length--;
+  
+  int parent_index = 1;
+  checked[h->array[parent_index]] = parent_index + 1;
+  int child_index = Int_Heap_Small_Child_I(h, parent_index, value);
+
+  while (child_index > 0) {
+    if (value[h->array[parent_index]] > value[h->array[child_index]]) {
+      Int_Arraylist_Swap(h, parent_index, child_index);
+      checked[h->array[parent_index]] = parent_index + 1;
+      checked[h->array[child_index]] = child_index + 1;
+      parent_index = child_index;
+      child_index = Int_Heap_Small_Child_I(h, parent_index, value);
+    } else {
+      break;
+    }
+  }
+
+  return root;
+}
+
+int Int_Heap_Remove_I_At(Int_Arraylist *h, int index,
+			   double *value, int *checked)
+{
+  int remove_index = checked[index] - 1;
+  if (remove_index > 0) {
+    checked[h->array[remove_index]] = 0;
+    int removed = h->array[remove_index];
+    h->array[remove_index] = h->array[h->length - 1];
+    h->length--;
+  
+    int parent_index = remove_index;
+    checked[h->array[parent_index]] = parent_index + 1;
+    int child_index = Int_Heap_Small_Child_I(h, parent_index, value);
+
+    while (child_index > 0) {
+      if (value[h->array[parent_index]] > value[h->array[child_index]]) {
+	Int_Arraylist_Swap(h, parent_index, child_index);
+	checked[h->array[parent_index]] = parent_index + 1;
+	checked[h->array[child_index]] = child_index + 1;
+	parent_index = child_index;
+	child_index = Int_Heap_Small_Child_I(h, parent_index, value);
+      } else {
+	break;
+      }
+    }
+
+    return removed;
+  }
+
+  return 0;
+}
+
+void Print_Int_Heap_I(const Int_Arraylist *h, double *value)
+{
+  printf("A heap with depth %d:\n", Int_Heap_Depth(h));
+
+  int i;
+  for (i = 1; i < h->length; i++) {
+    printf("%g", value[h->array[i]]);
+    printf(" ");
+    if ((i & (i + 1)) == 0) { /* i = 2^k - 1*/
+      printf("\n");
+    }
+  }
+  printf("\n");
+
+}
+
+int Verify_Int_Heap_I(const Int_Arraylist *h, double *value)
+{
+#ifdef _DEBUG_2
+  int k = 3, m = 1;
+  for (m = 0; m < 7; m++) {
+    printf("2^%d + %d - 1 = %d\n", k, m, pow2sum(k, m));
+    
+    int n = pow2sum(k, m);
+    pow2decomp(n, &k, &m);
+    printf("2^%d + %d - 1 = %d\n", k, m, pow2sum(k, m));
+  }
+#endif
+
+  int i;
+  for (i = h->length - 1; i > 1; i--) {
+    int pid = PARENT_INDEX(i);
+    if (value[h->array[i]] < value[h->array[pid]]) {
+      //printf("%g -> %g\n", value[h->array[i]], value[h->array[pid]]);
+      return i;
+    }
+  }
+  
+  return 0;
+}
+
+
+/* Int_Heap_Sort(): sort an array list using heap sort.
+ *
+ * Args: a - the array list to sort
+ *
+ * Return: void.
+ */
+void Int_Heap_Sort(Int_Arraylist *a)
+{
+  Int_Arraylist *h = Int_Arraylist_New(1, a->length);
+  
+  Int_Arraylist_Add(h, a->array[0]);
+  
+  int scan_pos = 1;
+  while (scan_pos < a->length) {
+    Int_Heap_Add(h, a->array[scan_pos++]);
+  }
+
+  int i;
+  int length = a->length;
+  a->length = 0;
+  for (i = 0; i < length; i++) {
+    Int_Arraylist_Add(a, Int_Heap_Remove(h));
+  }
+}
+
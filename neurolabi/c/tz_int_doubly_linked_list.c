@@ -0,0 +1,434 @@
+/* tz_linked_list_c.t
+ *
+ * 27-Nov-2007 Initial write: Ting Zhao
+ */
+
+#include <stdlib.h>
+#include "tz_error.h"
+#include "utilities.h"
+#include "tz_int_doubly_linked_list.h"
+
+INIT_EXCEPTION
+
+#undef _DEBUG_
+
+/* Int_Dlist_New(): New a Int list.
+ *
+ * Return: A Int list with length 1.
+ */
+Int_Dlist* Int_Dlist_New()
+{
+  Int_Dlist *new_list = (Int_Dlist *) Guarded_Malloc(sizeof(Int_Dlist), 
+						     "Int_Dlist_New");
+  
+  new_list->data = 0x0;
+  
+  new_list->next = NULL;
+  new_list->prev = NULL;
+
+  return new_list;
+}
+
+void Int_Dlist_Remove_All(Int_Dlist *p)
+{
+  Int_Dlist *head = Int_Dlist_Head(p);
+  while (head != NULL) {
+    p = head;
+    
+	
+    
+
+    head = head->next;
+#ifdef _DEBUG_
+    printf("%p freed\n", p);
+#endif
+    free(p);
+  }
+}
+
+void Int_Dlist_Set_Data(Int_Dlist *p, int data)
+{
+  p->data = data;
+}
+
+Int_Dlist *Int_Dlist_Head(const Int_Dlist *p)
+{
+  if (p == NULL) {
+    return NULL;
+  }
+
+  while (p->prev != NULL) {
+    p = p->prev;
+  }
+
+  return (Int_Dlist *) p;
+}
+
+Int_Dlist *Int_Dlist_Tail(const Int_Dlist *p)
+{
+  if (p == NULL) {
+    return NULL;
+  }
+
+  while (p->next != NULL) {
+    p = p->next;
+  }
+
+  return (Int_Dlist *) p;
+}
+
+Int_Dlist* Int_Dlist_Next(const Int_Dlist *p, Dlist_Direction_e d)
+{
+  if (p != NULL) {
+    if (d == DL_FORWARD) {
+      return p->next;
+    } else if (d == DL_BACKWARD) {
+      return p->prev;
+    } else {
+      TZ_WARN(ERROR_DATA_VALUE);
+      return NULL;
+    }
+  }
+
+  return NULL;
+}
+
+int Int_Dlist_Length(const Int_Dlist *p, Dlist_Direction_e d)
+{
+  if (p == NULL) {
+    return 0;
+  }
+
+  int length = 0;
+
+  switch (d) {
+  case DL_FORWARD:
+    for(; p != NULL; p = p->next) {
+      length++;
+    }
+    break;
+  case DL_BACKWARD:
+    for(; p != NULL; p = p->prev) {
+      length++;
+    }
+    break;
+  case DL_BOTHDIR:
+    length = Int_Dlist_Length(p, DL_BACKWARD) + 
+      Int_Dlist_Length(p->next, DL_FORWARD);
+    break;
+  default:
+    TZ_WARN(ERROR_DATA_VALUE);
+    length = -1;
+  }
+
+  return length;  
+}
+
+Int_Dlist* Locate_Int_Dlist(const Int_Dlist *p, int n)
+{
+  if (p == NULL) {
+    return NULL;
+  }
+
+  int i;
+  
+  if (n > 0) {
+    for (i = 0; i < n; i++) {
+      p = p->next;
+      if (p == NULL) {
+	return NULL;
+      }
+    }
+  } else if (n < 0){ /* going back */
+    for (i = 0; i < -n;  i++) {
+      p = p->prev;
+      if (p == NULL) {
+	return NULL;
+      }
+    }
+  }
+
+  return (Int_Dlist *)  p;
+}
+
+Int_Dlist* Append_Int_Dlist(Int_Dlist *p1, Int_Dlist *p2)
+{
+  if (p1 == NULL) {
+    return p2;
+  }
+
+  if (p2 == NULL) {
+    return p1;
+  }
+
+  Int_Dlist *head = Int_Dlist_Head(p1);
+
+  p1 = Int_Dlist_Tail(p1);
+  p2 = Int_Dlist_Head(p2);
+
+  p1->next = p2;
+  p2->prev = p1;
+
+  return head;
+}
+
+
+Int_Dlist* Int_Dlist_Remove_End(Int_Dlist *p, Dlist_End_e e)
+{
+  ASSERT(p != NULL, "null pointer");
+
+  Int_Dlist *end;
+
+  switch (e) {
+  case DL_HEAD:
+    end = Int_Dlist_Head(p);
+    p = end->next;
+    if (p != NULL) {
+      p->prev = NULL;
+    }
+    end->next = NULL;
+    Int_Dlist_Remove_All(end);
+    break;
+  case DL_TAIL:
+    end = Int_Dlist_Tail(p);
+    p = end->prev;
+    if (p != NULL) {
+      p->next = NULL;
+    }
+    end->prev = NULL;
+    Int_Dlist_Remove_All(end);
+    break;
+  default:
+    TZ_WARN(ERROR_DATA_TYPE);
+    return NULL;
+  }
+
+  return p;
+}
+
+
+Int_Dlist* Int_Dlist_Remove_Node(Int_Dlist *p)
+{
+  if (p == NULL) {
+    return NULL;
+  }
+
+  Int_Dlist *head = Int_Dlist_Head(p);
+  Int_Dlist *prev = p->prev;
+
+  if (prev == NULL) {
+    head = p->next;
+  } else {
+    prev->next = p->next;
+    p->prev = NULL;
+  }
+
+  if (p->next != NULL) {
+    p->next->prev = prev;
+    p->next = NULL;
+  }
+
+  Int_Dlist_Remove_All(p);
+
+  return head;
+}
+
+/* Int_Dlist_Add(): Add a node to the beginning of the list.
+ * 
+ * Args: p - pointer to the list;
+ *       data - data node.
+ *
+ * Return: the old head.
+ * 
+ * Note: <data> (not its copy) will be added to the list, so be careful about
+ *       freeing the object.
+ */
+Int_Dlist* Int_Dlist_Add(Int_Dlist *p, int data, Dlist_End_e e)
+{
+  Int_Dlist *new_node = Int_Dlist_New();
+  Int_Dlist_Set_Data(new_node, data);
+
+  if (p == NULL) {
+#ifdef _DEBUG_2
+    printf("%p->%p added\n", new_node, data);
+#endif    
+    return new_node;
+  }
+  
+  switch (e) {
+  case DL_HEAD:
+    p = Int_Dlist_Head(p);
+    new_node->next = p;
+    p->prev = new_node;
+    p = new_node;
+    break;
+  case DL_TAIL:
+    p = Int_Dlist_Tail(p);
+    new_node->prev = p;
+    p->next = new_node;
+#ifdef _DEBUG_2
+    printf("%p->%p added\n", new_node, data);
+#endif
+    p = new_node;
+    break;
+  default:
+    TZ_WARN(ERROR_DATA_VALUE);
+    Int_Dlist_Remove_All(new_node);
+  }
+      
+  return p;
+}
+
+void Int_Dlist_Insert(Int_Dlist *p, int data)
+{
+  if (p == NULL) {
+    return;
+  }
+
+  Int_Dlist *new_node = Int_Dlist_New();
+  Int_Dlist_Set_Data(new_node, data);
+  
+  Int_Dlist *prev = p->prev;
+  p->prev = new_node;
+  new_node->next = p;
+  new_node->prev = prev;
+  if (prev != NULL) {
+    prev->next = new_node;
+  }
+}
+
+/* Int_Dlist_Unlink(): Unlink the head of a list.
+ *
+ * Args: p - input list, which will be changed.
+ *
+ * Return: the unlinked data.
+ */
+int Int_Dlist_Unlink(Int_Dlist **p)
+{
+  if (*p != NULL) {
+    Int_Dlist *tmp_head = *p;
+    *p = tmp_head->next;
+
+    int data = tmp_head->data;
+    free(tmp_head);
+    
+    return data;
+  }
+
+  
+  
+  return 0;
+  
+}
+
+BOOL Int_Dlist_Is_Empty(const Int_Dlist *p)
+{
+  if (p == NULL) {
+    return TRUE;
+  } else {
+    return FALSE;
+  }
+}
+
+/* Int_Dlist_To_Array(): Turn a list to an array.
+ *
+ * Args: p - input list;
+ *       array - returned array. If it is NULL, a new array will be created,
+ *               otherwise it must be large enough to hold the result.
+ *       step - The offset between an element and its right neighbor. If it is
+ *              negative, the array has a reversed order.
+ * Return: the resulted array.
+ *
+ * Note: The caller is responsible for freeing the returned array.
+ */
+int* Int_Dlist_To_Array(const Int_Dlist *p, int step, int *array, int *length)
+{
+  if (step == 0) {
+    THROW(ERROR_DATA_VALUE);
+  }
+
+  int n = Int_Dlist_Length(p, DL_FORWARD);
+  int array_length = (n - 1) * abs(step) + 1;
+
+  if (array == NULL) {
+    array = (int *) Guarded_Malloc(sizeof(int) * array_length, 
+				    "Int_Dlist_To_Array");
+  }
+
+  int begin;
+  int end;
+  
+  if (step > 0) {
+    begin = 0;
+    end = array_length - 1;
+  } else {
+    begin = array_length - 1;
+    end = 0;
+  }
+  
+  int i;
+  for (i = begin; p != NULL; i += step, p = p->next) {
+    array[i] = p->data;
+  }
+
+  if (length != NULL) {
+    *length = array_length;
+  }
+
+  return array;
+}
+
+/* Print_Int_Dlist(): Print Int list.
+ *
+ * Args: p - list to print.
+ *
+ * Return: void.
+ *
+ * Note: This function works only when Print_Int is available.
+ */
+void Print_Int_Dlist(const Int_Dlist *p)
+{
+  if (p == NULL) {
+    printf("Null list.\n");
+    return;
+  }
+
+  printf("Total length: %d\n", Int_Dlist_Length(p, DL_BOTHDIR));
+
+  
+
+}
+
+/* Print_Int_Dlist_Compact(): Print Int list briefly.
+ *
+ * Args: p - list to print.
+ *
+ * Return: void.
+ *
+ * Note: This function works only when Print_Int_Info is available.
+ */
+void Print_Int_Dlist_Compact(const Int_Dlist *p)
+{
+  if (p == NULL) {
+    printf("Null list.\n");
+    return;
+  }
+
+  
+}
+
+void Print_Int_Dlist_F(const Int_Dlist *p, const char *format)
+{
+  if (p == NULL) {
+    printf("Null list.\n");
+    return;
+  }
+
+  printf("Total length: %d\n", Int_Dlist_Length(p, DL_FORWARD));
+  while (p != NULL) {
+    printf(format, p->data);
+    printf(" ");
+    p = p->next;
+  }
+  printf("\n");
+}
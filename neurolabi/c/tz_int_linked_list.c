@@ -0,0 +1,365 @@
+/* tz_linked_list_c.t
+ *
+ * 27-Nov-2007 Initial write: Ting Zhao
+ */
+
+#include <stdlib.h>
+#include "tz_error.h"
+#include "utilities.h"
+#include "tz_int_linked_list.h"
+
+INIT_EXCEPTION
+
+/* Int_List_New(): New a Int list.
+ *
+ * Return: A Int list with length 1.
+ */
+Int_List* Int_List_New()
+{
+  Int_List *new_list = (Int_List *) Guarded_Malloc(sizeof(Int_List), 
+						     "Int_List_New");
+  new_list->next = NULL;
+
+  return new_list;
+}
+
+void Int_List_Set_Data(Int_List *p, int data)
+{
+  p->data = data;
+}
+
+/* Int_List_Removeall(): Remove all nodes in a list.
+ *
+ * Args: p - a pointer to the list. It becomes NULL after calling this function.
+ *
+ * Return: void.
+ */
+void Int_List_Removeall(Int_List **p)
+{
+  if (p != NULL) {
+    while (*p != NULL) {
+      Int_List_Remove(p);
+    }
+  }
+}
+
+/* Int_List_Unlinkall(): Unlink all nodes in a list.
+ *
+ * Args: p - a pointer to the list. It becomes NULL after calling this function.
+ *
+ * Return: void.
+ */
+void Int_List_Unlinkall(Int_List **p)
+{
+  if (p != NULL) {
+    while (*p != NULL) {
+      Int_List_Unlink(p);
+    }
+  }
+}
+
+void Kill_Int_List(Int_List *p)
+{
+  Int_List_Removeall(&p);
+}
+
+/* Int_List_Add(): Add a node to the beginning of the list.
+ * 
+ * Args: p - pointer to the list;
+ *       data - data node.
+ *
+ * Return: the old head.
+ * 
+ * Note: <data> (not its copy) will be added to the list, so be careful about
+ *       freeing the object.
+ */
+Int_List* Int_List_Add(Int_List **p, int data)
+{
+  Int_List *new_node = Int_List_New();
+  new_node->next = *p;
+  Int_List_Set_Data(new_node, data);
+  *p = new_node;
+  
+  return (*p)->next;
+}
+
+/* Int_List_Add_Last(): Add a new node to the end of the list.
+ *
+ * Return: the last node of the new list.
+ */
+Int_List* Int_List_Add_Last(Int_List *p, int data)
+{
+  p = Int_List_Last(p);
+  Int_List *new_node = Int_List_New();
+  Int_List_Set_Data(new_node, data);
+  p->next = new_node;
+
+  return new_node;
+}
+
+/* Int_List_Remove(): Remove the first node.
+ *
+ * Args: p - a pointer to the list. It becomes the new list after calling this
+ *           function.
+ *
+ * Return: void.
+ */
+void Int_List_Remove(Int_List **p)
+{
+  if (*p != NULL) {
+    Int_List *tmp_head = *p;
+    *p = tmp_head->next;
+    
+    
+    free(tmp_head);
+  }
+}
+
+void Int_List_Remove_Last(Int_List *p)
+{
+  if (p == NULL) {
+    return;
+  }
+
+  while (p->next != NULL) {
+    p = Int_List_Next(p);
+  }
+
+  Int_List_Remove(&p);
+}
+
+/* Int_List_Unlink(): Unlink the head of a list.
+ *
+ * Args: p - input list, which will be changed.
+ *
+ * Return: the unlinked data.
+ */
+int Int_List_Unlink(Int_List **p)
+{
+  if (*p != NULL) {
+    Int_List *tmp_head = *p;
+    *p = tmp_head->next;
+
+    int data = tmp_head->data;
+    free(tmp_head);
+    
+    return data;
+  }
+
+  
+  
+  return 0;
+  
+}
+
+/* Int_List_Next(): Get next node.
+ *
+ * Return: the next node of p.
+ */
+Int_List* Int_List_Next(Int_List *p)
+{
+  return p->next;
+}
+
+/* Int_List_Last(): Get the last node.
+ *
+ * Return: the last node of <p>.
+ */
+Int_List* Int_List_Last(Int_List *p)
+{
+  Int_List* prev = NULL;
+
+  while (p != NULL) {
+    prev = p;
+    p = Int_List_Next(p);
+  }
+
+  return prev;
+}
+
+BOOL Int_List_Is_Empty(const Int_List *p)
+{
+  if (p == NULL) {
+    return TRUE;
+  } else {
+    return FALSE;
+  }
+}
+
+/* Int_List_Length(): Length of the list.
+ * 
+ * Args: p - input list.
+ *
+ * Return: the length of the list.
+ */
+int Int_List_Length(const Int_List *p)
+{
+  int n = 0;
+  while (p != NULL) {
+    n++;
+    p = p->next;
+  }
+
+  return n;
+}
+
+/* Int_List_To_Array(): Turn a list to an array.
+ *
+ * Args: p - input list;
+ *       array - returned array. If it is NULL, a new array will be created,
+ *               otherwise it must be large enough to hold the result.
+ *       step - The offset between an element and its right neighbor. If it is
+ *              negative, the array has a reversed order.
+ * Return: the resulted array.
+ *
+ * Note: The caller is responsible for freeing the returned array.
+ */
+int* Int_List_To_Array(const Int_List *p, int step, int *array, int *length)
+{
+  if (step == 0) {
+    THROW(ERROR_DATA_VALUE);
+  }
+
+  int n = Int_List_Length(p);
+  int array_length = (n - 1) * abs(step) + 1;
+
+  if (array == NULL) {
+    array = (int *) Guarded_Malloc(sizeof(int) * array_length, 
+				    "Int_List_To_Array");
+  }
+
+  int begin;
+  int end;
+  
+  if (step > 0) {
+    begin = 0;
+    end = array_length - 1;
+  } else {
+    begin = array_length - 1;
+    end = 0;
+  }
+  
+  int i;
+  for (i = begin; p != NULL; i += step, p = p->next) {
+    array[i] = p->data;
+  }
+
+  if (length != NULL) {
+    *length = array_length;
+  }
+
+  return array;
+}
+
+/* Print_Int_List(): Print Int list.
+ *
+ * Args: p - list to print.
+ *
+ * Return: void.
+ *
+ * Note: This function works only when Print_Int is available.
+ */
+void Print_Int_List(const Int_List *p)
+{
+  if (p == NULL) {
+    printf("Null list.\n");
+    return;
+  }
+
+  printf("Total length: %d\n", Int_List_Length(p));
+
+  
+
+}
+
+/* Print_Int_List_Compact(): Print Int list briefly.
+ *
+ * Args: p - list to print.
+ *
+ * Return: void.
+ *
+ * Note: This function works only when Print_Int_Info is available.
+ */
+void Print_Int_List_Compact(const Int_List *p)
+{
+  if (p == NULL) {
+    printf("Null list.\n");
+    return;
+  }
+
+  
+}
+
+void Print_Int_List_F(const Int_List *p, const char *format)
+{
+  if (p == NULL) {
+    printf("Null list.\n");
+    return;
+  }
+
+  printf("Total length: %d\n", Int_List_Length(p));
+  while (p != NULL) {
+    printf(format, p->data);
+    printf(" ");
+    p = p->next;
+  }
+  printf("\n");
+}
+
+/*
+ * The following routines implement a queue based on a list.
+ */
+
+/* Int_Queue_En(): Add an item to the end of the queue.
+ */
+Int_List* Int_Queue_En(Int_List **p, int data)
+{
+  if (*p == NULL) {
+    *p = Int_List_New();
+    Int_List_Set_Data(*p, data);
+    return *p;
+  }
+
+  return Int_List_Add_Last(*p, data);
+}
+
+/* Int_Queue_De(): Removes the item from the front of the queue.
+ */
+int Int_Queue_De(Int_List **p)
+{
+  return Int_List_Unlink(p);
+}
+
+/* Int_Queue_Peek(): Get the iterm from the front of the queue without removing
+ *                    it.
+ */
+int Int_Queue_Peek(const Int_List *p)
+{
+  return p->data;
+}
+
+
+/*
+ * The following routines implement a stack based on a list.
+ */
+void Int_Stack_Push(Int_List **p, int data)
+{
+  if (*p == NULL) {
+    *p = Int_List_New();
+    Int_List_Set_Data(*p, data);
+  } else {
+    Int_List_Add(p, data);  
+  }
+}
+
+int Int_Stack_Pop(Int_List **p)
+{
+  return Int_List_Unlink(p);
+}
+
+int Int_Stack_Peek(const Int_List *p)
+{
+  return p->data;
+}
+
+
@@ -0,0 +1,443 @@
+/* tz_linked_list_c.t
+ *
+ * 27-Nov-2007 Initial write: Ting Zhao
+ */
+
+#include <stdlib.h>
+#include "tz_error.h"
+#include "utilities.h"
+#include "tz_local_neuroseg_doubly_linked_list.h"
+
+INIT_EXCEPTION
+
+#undef _DEBUG_
+
+/* Local_Neuroseg_Dlist_New(): New a Local_Neuroseg list.
+ *
+ * Return: A Local_Neuroseg list with length 1.
+ */
+Local_Neuroseg_Dlist* Local_Neuroseg_Dlist_New()
+{
+  Local_Neuroseg_Dlist *new_list = (Local_Neuroseg_Dlist *) Guarded_Malloc(sizeof(Local_Neuroseg_Dlist), 
+						     "Local_Neuroseg_Dlist_New");
+  
+  new_list->data = 0x0;
+  
+  new_list->next = NULL;
+  new_list->prev = NULL;
+
+  return new_list;
+}
+
+void Local_Neuroseg_Dlist_Remove_All(Local_Neuroseg_Dlist *p)
+{
+  Local_Neuroseg_Dlist *head = Local_Neuroseg_Dlist_Head(p);
+  while (head != NULL) {
+    p = head;
+    
+	
+    
+    if (p->data != NULL) {
+      free(p->data);
+    }
+    
+
+    head = head->next;
+#ifdef _DEBUG_
+    printf("%p freed\n", p);
+#endif
+    free(p);
+  }
+}
+
+void Local_Neuroseg_Dlist_Set_Data(Local_Neuroseg_Dlist *p, Local_Neuroseg_P data)
+{
+  p->data = data;
+}
+
+Local_Neuroseg_Dlist *Local_Neuroseg_Dlist_Head(const Local_Neuroseg_Dlist *p)
+{
+  if (p == NULL) {
+    return NULL;
+  }
+
+  while (p->prev != NULL) {
+    p = p->prev;
+  }
+
+  return (Local_Neuroseg_Dlist *) p;
+}
+
+Local_Neuroseg_Dlist *Local_Neuroseg_Dlist_Tail(const Local_Neuroseg_Dlist *p)
+{
+  if (p == NULL) {
+    return NULL;
+  }
+
+  while (p->next != NULL) {
+    p = p->next;
+  }
+
+  return (Local_Neuroseg_Dlist *) p;
+}
+
+Local_Neuroseg_Dlist* Local_Neuroseg_Dlist_Next(const Local_Neuroseg_Dlist *p, Dlist_Direction_e d)
+{
+  if (p != NULL) {
+    if (d == DL_FORWARD) {
+      return p->next;
+    } else if (d == DL_BACKWARD) {
+      return p->prev;
+    } else {
+      TZ_WARN(ERROR_DATA_VALUE);
+      return NULL;
+    }
+  }
+
+  return NULL;
+}
+
+int Local_Neuroseg_Dlist_Length(const Local_Neuroseg_Dlist *p, Dlist_Direction_e d)
+{
+  if (p == NULL) {
+    return 0;
+  }
+
+  int length = 0;
+
+  switch (d) {
+  case DL_FORWARD:
+    for(; p != NULL; p = p->next) {
+      length++;
+    }
+    break;
+  case DL_BACKWARD:
+    for(; p != NULL; p = p->prev) {
+      length++;
+    }
+    break;
+  case DL_BOTHDIR:
+    length = Local_Neuroseg_Dlist_Length(p, DL_BACKWARD) + 
+      Local_Neuroseg_Dlist_Length(p->next, DL_FORWARD);
+    break;
+  default:
+    TZ_WARN(ERROR_DATA_VALUE);
+    length = -1;
+  }
+
+  return length;  
+}
+
+Local_Neuroseg_Dlist* Locate_Local_Neuroseg_Dlist(const Local_Neuroseg_Dlist *p, int n)
+{
+  if (p == NULL) {
+    return NULL;
+  }
+
+  int i;
+  
+  if (n > 0) {
+    for (i = 0; i < n; i++) {
+      p = p->next;
+      if (p == NULL) {
+	return NULL;
+      }
+    }
+  } else if (n < 0){ /* going back */
+    for (i = 0; i < -n;  i++) {
+      p = p->prev;
+      if (p == NULL) {
+	return NULL;
+      }
+    }
+  }
+
+  return (Local_Neuroseg_Dlist *)  p;
+}
+
+Local_Neuroseg_Dlist* Append_Local_Neuroseg_Dlist(Local_Neuroseg_Dlist *p1, Local_Neuroseg_Dlist *p2)
+{
+  if (p1 == NULL) {
+    return p2;
+  }
+
+  if (p2 == NULL) {
+    return p1;
+  }
+
+  Local_Neuroseg_Dlist *head = Local_Neuroseg_Dlist_Head(p1);
+
+  p1 = Local_Neuroseg_Dlist_Tail(p1);
+  p2 = Local_Neuroseg_Dlist_Head(p2);
+
+  p1->next = p2;
+  p2->prev = p1;
+
+  return head;
+}
+
+
+Local_Neuroseg_Dlist* Local_Neuroseg_Dlist_Remove_End(Local_Neuroseg_Dlist *p, Dlist_End_e e)
+{
+  ASSERT(p != NULL, "null pointer");
+
+  Local_Neuroseg_Dlist *end;
+
+  switch (e) {
+  case DL_HEAD:
+    end = Local_Neuroseg_Dlist_Head(p);
+    p = end->next;
+    if (p != NULL) {
+      p->prev = NULL;
+    }
+    end->next = NULL;
+    Local_Neuroseg_Dlist_Remove_All(end);
+    break;
+  case DL_TAIL:
+    end = Local_Neuroseg_Dlist_Tail(p);
+    p = end->prev;
+    if (p != NULL) {
+      p->next = NULL;
+    }
+    end->prev = NULL;
+    Local_Neuroseg_Dlist_Remove_All(end);
+    break;
+  default:
+    TZ_WARN(ERROR_DATA_TYPE);
+    return NULL;
+  }
+
+  return p;
+}
+
+
+Local_Neuroseg_Dlist* Local_Neuroseg_Dlist_Remove_Node(Local_Neuroseg_Dlist *p)
+{
+  if (p == NULL) {
+    return NULL;
+  }
+
+  Local_Neuroseg_Dlist *head = Local_Neuroseg_Dlist_Head(p);
+  Local_Neuroseg_Dlist *prev = p->prev;
+
+  if (prev == NULL) {
+    head = p->next;
+  } else {
+    prev->next = p->next;
+    p->prev = NULL;
+  }
+
+  if (p->next != NULL) {
+    p->next->prev = prev;
+    p->next = NULL;
+  }
+
+  Local_Neuroseg_Dlist_Remove_All(p);
+
+  return head;
+}
+
+/* Local_Neuroseg_Dlist_Add(): Add a node to the beginning of the list.
+ * 
+ * Args: p - pointer to the list;
+ *       data - data node.
+ *
+ * Return: the old head.
+ * 
+ * Note: <data> (not its copy) will be added to the list, so be careful about
+ *       freeing the object.
+ */
+Local_Neuroseg_Dlist* Local_Neuroseg_Dlist_Add(Local_Neuroseg_Dlist *p, Local_Neuroseg_P data, Dlist_End_e e)
+{
+  Local_Neuroseg_Dlist *new_node = Local_Neuroseg_Dlist_New();
+  Local_Neuroseg_Dlist_Set_Data(new_node, data);
+
+  if (p == NULL) {
+#ifdef _DEBUG_2
+    printf("%p->%p added\n", new_node, data);
+#endif    
+    return new_node;
+  }
+  
+  switch (e) {
+  case DL_HEAD:
+    p = Local_Neuroseg_Dlist_Head(p);
+    new_node->next = p;
+    p->prev = new_node;
+    p = new_node;
+    break;
+  case DL_TAIL:
+    p = Local_Neuroseg_Dlist_Tail(p);
+    new_node->prev = p;
+    p->next = new_node;
+#ifdef _DEBUG_2
+    printf("%p->%p added\n", new_node, data);
+#endif
+    p = new_node;
+    break;
+  default:
+    TZ_WARN(ERROR_DATA_VALUE);
+    Local_Neuroseg_Dlist_Remove_All(new_node);
+  }
+      
+  return p;
+}
+
+void Local_Neuroseg_Dlist_Insert(Local_Neuroseg_Dlist *p, Local_Neuroseg_P data)
+{
+  if (p == NULL) {
+    return;
+  }
+
+  Local_Neuroseg_Dlist *new_node = Local_Neuroseg_Dlist_New();
+  Local_Neuroseg_Dlist_Set_Data(new_node, data);
+  
+  Local_Neuroseg_Dlist *prev = p->prev;
+  p->prev = new_node;
+  new_node->next = p;
+  new_node->prev = prev;
+  if (prev != NULL) {
+    prev->next = new_node;
+  }
+}
+
+/* Local_Neuroseg_Dlist_Unlink(): Unlink the head of a list.
+ *
+ * Args: p - input list, which will be changed.
+ *
+ * Return: the unlinked data.
+ */
+Local_Neuroseg_P Local_Neuroseg_Dlist_Unlink(Local_Neuroseg_Dlist **p)
+{
+  if (*p != NULL) {
+    Local_Neuroseg_Dlist *tmp_head = *p;
+    *p = tmp_head->next;
+
+    Local_Neuroseg_P data = tmp_head->data;
+    free(tmp_head);
+    
+    return data;
+  }
+
+  
+  return NULL;
+  
+  
+}
+
+BOOL Local_Neuroseg_Dlist_Is_Empty(const Local_Neuroseg_Dlist *p)
+{
+  if (p == NULL) {
+    return TRUE;
+  } else {
+    return FALSE;
+  }
+}
+
+/* Local_Neuroseg_Dlist_To_Array(): Turn a list to an array.
+ *
+ * Args: p - input list;
+ *       array - returned array. If it is NULL, a new array will be created,
+ *               otherwise it must be large enough to hold the result.
+ *       step - The offset between an element and its right neighbor. If it is
+ *              negative, the array has a reversed order.
+ * Return: the resulted array.
+ *
+ * Note: The caller is responsible for freeing the returned array.
+ */
+Local_Neuroseg_P* Local_Neuroseg_Dlist_To_Array(const Local_Neuroseg_Dlist *p, int step, Local_Neuroseg_P *array, int *length)
+{
+  if (step == 0) {
+    THROW(ERROR_DATA_VALUE);
+  }
+
+  int n = Local_Neuroseg_Dlist_Length(p, DL_FORWARD);
+  int array_length = (n - 1) * abs(step) + 1;
+
+  if (array == NULL) {
+    array = (Local_Neuroseg_P *) Guarded_Malloc(sizeof(Local_Neuroseg_P) * array_length, 
+				    "Local_Neuroseg_Dlist_To_Array");
+  }
+
+  int begin;
+  int end;
+  
+  if (step > 0) {
+    begin = 0;
+    end = array_length - 1;
+  } else {
+    begin = array_length - 1;
+    end = 0;
+  }
+  
+  int i;
+  for (i = begin; p != NULL; i += step, p = p->next) {
+    array[i] = p->data;
+  }
+
+  if (length != NULL) {
+    *length = array_length;
+  }
+
+  return array;
+}
+
+/* Print_Local_Neuroseg_Dlist(): Print Local_Neuroseg list.
+ *
+ * Args: p - list to print.
+ *
+ * Return: void.
+ *
+ * Note: This function works only when Print_Local_Neuroseg is available.
+ */
+void Print_Local_Neuroseg_Dlist(const Local_Neuroseg_Dlist *p)
+{
+  if (p == NULL) {
+    printf("Null list.\n");
+    return;
+  }
+
+  printf("Total length: %d\n", Local_Neuroseg_Dlist_Length(p, DL_BOTHDIR));
+
+  
+  while (p != NULL) {
+    Print_Local_Neuroseg(p->data);
+    p = p->next;
+  }
+  
+
+}
+
+/* Print_Local_Neuroseg_Dlist_Compact(): Print Local_Neuroseg list briefly.
+ *
+ * Args: p - list to print.
+ *
+ * Return: void.
+ *
+ * Note: This function works only when Print_Local_Neuroseg_Info is available.
+ */
+void Print_Local_Neuroseg_Dlist_Compact(const Local_Neuroseg_Dlist *p)
+{
+  if (p == NULL) {
+    printf("Null list.\n");
+    return;
+  }
+
+  
+}
+
+void Print_Local_Neuroseg_Dlist_F(const Local_Neuroseg_Dlist *p, const char *format)
+{
+  if (p == NULL) {
+    printf("Null list.\n");
+    return;
+  }
+
+  printf("Total length: %d\n", Local_Neuroseg_Dlist_Length(p, DL_FORWARD));
+  while (p != NULL) {
+    printf(format, p->data);
+    printf(" ");
+    p = p->next;
+  }
+  printf("\n");
+}
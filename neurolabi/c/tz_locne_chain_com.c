@@ -0,0 +1,639 @@
+/* tz_locne_chain.c
+ *
+ * 06-May-2008 Initial write: Ting Zhao
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#if defined(_WIN32) || defined(_WIN64)
+  #define PCRE_STATIC
+  #include <pcre2posix.h>
+#else
+  #include <regex.h>
+#endif
+#include <string.h>
+#ifndef _MSC_VER
+#include <dirent.h>
+#else
+#include "tz_dirent.h"
+#endif
+#include "tz_utilities.h"
+#include "tz_constant.h"
+#include "tz_error.h"
+#include "tz_interface.h"
+#include "tz_stack_sampling.h"
+#include "tz_trace_utils.h"
+#include "tz_darray.h"
+#include "tz_cont_fun.h"
+#include "tz_locne_chain_com.h"
+#include "tz_vrml_material.h"
+#include "tz_vrml_io.h"
+#include "tz_geo3d_utils.h"
+#include "tz_string.h"
+#include "tz_geo3d_point_array.h"
+#include "tz_stack_graph.h"
+#include "tz_image_array.h"
+#include "tz_swc_cell.h"
+#include "tz_u8array.h"
+
+
+Locne_Chain* New_Locne_Chain(void)
+{
+  Locne_Chain *chain = 
+    (Locne_Chain *) Guarded_Malloc(sizeof(Locne_Chain), "New_Locne_Chain");
+
+  chain->list = NULL;
+  chain->iterator = NULL;
+
+  return chain;
+}
+
+void Delete_Locne_Chain(Locne_Chain *chain)
+{
+  if (chain != NULL) {
+    free(chain);
+  }
+}
+
+void Construct_Locne_Chain(Locne_Chain *chain, Locne_Node *p)
+{
+  chain->list = Locne_Node_Dlist_New();
+  Locne_Node_Dlist_Set_Data(chain->list, p);
+}
+
+void Clean_Locne_Chain(Locne_Chain *chain)
+{
+  if (chain != NULL) {
+    Locne_Node_Dlist_Remove_All(chain->list);
+    chain->list = NULL;
+    chain->iterator = NULL;
+  }
+}
+
+Locne_Chain* Make_Locne_Chain(Locne_Node *p)
+{
+  Locne_Chain *chain = New_Locne_Chain();
+  Construct_Locne_Chain(chain, p);
+
+  return chain;
+}
+
+void Kill_Locne_Chain(Locne_Chain *chain)
+{
+  Clean_Locne_Chain(chain);
+  Delete_Locne_Chain(chain);
+}
+
+int Locne_Chain_Length(Locne_Chain *chain)
+{
+  if (chain == NULL) {
+    return 0;
+  }
+
+  return Locne_Node_Dlist_Length(chain->list, DL_BOTHDIR);
+}
+
+BOOL Locne_Chain_Is_Empty(Locne_Chain *chain)
+{
+  if (chain == NULL) {
+    return TRUE;
+  }
+
+  if (chain->list == NULL) {
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+Locne_Node_Dlist* Locne_Chain_Iterator_Start(Locne_Chain *chain, 
+					       Dlist_End_e d)
+{
+  Locne_Node_Dlist *old_iter = chain->iterator;
+
+  switch (d) {
+  case DL_HEAD:
+    chain->iterator = Locne_Node_Dlist_Head(chain->list);
+    break;
+  case DL_TAIL:
+    chain->iterator = Locne_Node_Dlist_Tail(chain->list);
+    break;
+  default:
+    TZ_ERROR(ERROR_DATA_VALUE);
+    break;
+  }
+
+  return old_iter;
+}
+
+Locne_Node_Dlist* Locne_Chain_Iterator_Locate(Locne_Chain *chain, int index)
+{
+  Locne_Node_Dlist *old_iter = NULL;
+  
+  if (index >= 0) {
+    old_iter = Locne_Chain_Iterator_Start(chain, DL_HEAD);
+  } else {
+    old_iter = Locne_Chain_Iterator_Start(chain, DL_TAIL);
+  }
+
+  chain->iterator = Locate_Locne_Node_Dlist(chain->iterator, index);
+  
+  return old_iter;
+}
+
+Locne_Node* Locne_Chain_Next(Locne_Chain *chain)
+{
+  if (chain == NULL) {
+    return NULL;
+  }
+
+  if ((chain->list == NULL) || (chain->iterator == NULL)) {
+    return NULL;
+  }
+
+  Locne_Node *p = chain->iterator->data;
+
+  chain->iterator = chain->iterator->next;
+
+  return p;
+}
+
+Locne_Node* Locne_Chain_Prev(Locne_Chain *chain)
+{
+  if (chain == NULL) {
+    return NULL;
+  }
+
+  if ((chain->list == NULL) || (chain->iterator == NULL)) {
+    return NULL;
+  }
+
+  Locne_Node *p = chain->iterator->data;
+
+  chain->iterator = chain->iterator->prev;
+
+  return p;
+}
+
+Locne_Node* Locne_Chain_Next_D(Locne_Chain *chain, Dlist_End_e d)
+{
+  if (d == DL_HEAD) {
+    return Locne_Chain_Next(chain);
+  }
+
+  if (d == DL_TAIL) {
+    return Locne_Chain_Prev(chain);
+  }
+
+  return NULL;
+}
+
+Locne_Node* Locne_Chain_Peek(const Locne_Chain *chain)
+{
+  if (chain == NULL) {
+    return NULL;
+  }
+
+  if ((chain->list == NULL) || (chain->iterator == NULL)) {
+    return NULL;
+  }
+
+  return chain->iterator->data;
+}
+
+Local_Neuroseg_Ellipse* Locne_Chain_Peek_Seg(const Locne_Chain *chain)
+{
+  Locne_Node *p = Locne_Chain_Peek(chain);
+  if (p == NULL) {
+    return NULL;
+  }
+
+  return p->locseg;
+}
+
+Locne_Node* Locne_Chain_Peek_Next(const Locne_Chain *chain)
+{
+  if (chain == NULL) {
+    return NULL;
+  }
+
+  if (chain->iterator == NULL) {
+    return NULL;
+  }
+
+  if (chain->iterator->next == NULL) {
+    return NULL;
+  }
+
+  return chain->iterator->next->data;
+}
+
+Locne_Node* Locne_Chain_Peek_Prev(const Locne_Chain *chain)
+{
+  if (chain == NULL) {
+    return NULL;
+  }
+
+  if (chain->iterator == NULL) {
+    return NULL;
+  }
+
+  if (chain->iterator->prev == NULL) {
+    return NULL;
+  }
+
+  return chain->iterator->prev->data;  
+}
+
+Local_Neuroseg_Ellipse* Locne_Chain_Next_Seg(Locne_Chain *chain)
+{
+  Locne_Node *p = Locne_Chain_Next(chain);
+  if (p == NULL) {
+    return NULL;
+  } else {
+    return p->locseg;
+  }
+}
+
+Local_Neuroseg_Ellipse* Locne_Chain_Prev_Seg(Locne_Chain *chain)
+{
+  Locne_Node *p = Locne_Chain_Prev(chain);
+  if (p == NULL) {
+    return NULL;
+  } else {
+    return p->locseg;
+  }
+}
+
+Local_Neuroseg_Ellipse* Locne_Chain_Next_Seg_D(Locne_Chain *chain, Dlist_End_e d)
+{
+  if (d == DL_HEAD) {
+    return Locne_Chain_Next_Seg(chain);
+  }
+
+  if (d == DL_TAIL) {
+    return Locne_Chain_Prev_Seg(chain);
+  }
+
+  return NULL;
+}
+
+void Print_Locne_Chain(Locne_Chain *chain)
+{
+  Locne_Node_Dlist* old_iter = Locne_Chain_Iterator_Start(chain, DL_HEAD);
+  Locne_Node *p = NULL;
+  int n = 0;
+  while ((p = Locne_Chain_Next(chain)) != NULL) {
+    Print_Locne_Node(p);
+    n++;
+  }
+
+  printf("Total length: %d\n", n);
+
+  chain->iterator = old_iter;
+}
+
+void Write_Locne_Chain(const char *file_path, Locne_Chain *chain)
+{
+  FILE *fp = Guarded_Fopen((char*) file_path, "wb", "Write_Locne_Chain");
+  
+  Locne_Node_Dlist *old_iter = Locne_Chain_Iterator_Start(chain, DL_HEAD);
+  Locne_Node *p = NULL;
+  
+  double version = CHAIN_VERSION;
+  if (version > 0.0) {
+    double start = -version;
+    fwrite(&start, sizeof(double), 1, fp);
+  }
+
+  while ((p = Locne_Chain_Next(chain)) != NULL) {
+    Locne_Node_Fwrite_V(p, fp, version);
+  }
+  
+  fclose(fp);
+
+  chain->iterator = old_iter;
+}
+
+Locne_Chain* Read_Locne_Chain(const char *file_path)
+{
+  //FILE *fp = Guarded_Fopen((char*) file_path, "r", "Read_Locne_Chain");
+  FILE *fp = NULL;
+  if ((fp = fopen(file_path, "rb")) == NULL) {
+    return NULL;
+  }
+  
+  Locne_Chain *chain = New_Locne_Chain();
+  Locne_Node *node = NULL;
+
+  double start;
+  double version = 0;
+  fread(&start, sizeof(double), 1, fp);
+  if (start >= 0) {
+    fseek(fp, 0, SEEK_SET);
+  } else {
+    version = -start;
+  }
+
+  while ((node = Locne_Node_Fread_V(NULL, fp, version)) != NULL) {
+    Locne_Chain_Add_Node(chain, node, DL_TAIL);
+  }
+
+  fclose(fp);
+
+  return chain;
+}
+
+Locne_Node* Locne_Chain_Head(Locne_Chain *chain)
+{
+  if (chain == NULL) {
+    return NULL;
+  }
+
+  if (chain->list == NULL) {
+    return NULL;
+  }
+
+  Locne_Node_Dlist *tail = Locne_Node_Dlist_Head(chain->list);
+
+  return tail->data;
+}
+
+Locne_Node* Locne_Chain_Tail(Locne_Chain *chain)
+{
+  if (chain == NULL) {
+    return NULL;
+  }
+
+  if (chain->list == NULL) {
+    return NULL;
+  }
+
+  Locne_Node_Dlist *tail = Locne_Node_Dlist_Tail(chain->list);
+
+  return tail->data;
+}
+
+Local_Neuroseg_Ellipse* Locne_Chain_Head_Seg(Locne_Chain *chain)
+{
+  Locne_Node *p = Locne_Chain_Head(chain);
+  if (p == NULL) {
+    return NULL;
+  } else {
+    return p->locseg;
+  }
+}
+
+Local_Neuroseg_Ellipse* Locne_Chain_Tail_Seg(Locne_Chain *chain)
+{
+  Locne_Node *p = Locne_Chain_Tail(chain);
+  if (p == NULL) {
+    return NULL;
+  } else {
+    return p->locseg;
+  }
+}
+
+Locne_Node* Locne_Chain_Peek_At(Locne_Chain *chain, int index)
+{
+  Locne_Node_Dlist *old_iter = Locne_Chain_Iterator_Locate(chain, index);
+  Locne_Node *node = Locne_Chain_Peek(chain);
+
+  chain->iterator = old_iter;
+  
+  return node;
+}
+
+Local_Neuroseg_Ellipse* Locne_Chain_Peek_Seg_At(Locne_Chain *chain, int index)
+{
+  Locne_Node_Dlist *old_iter = Locne_Chain_Iterator_Locate(chain, index);
+  Local_Neuroseg_Ellipse *locseg = Locne_Chain_Peek_Seg(chain);
+  chain->iterator = old_iter;
+  
+  return locseg;
+}
+
+void Locne_Chain_Add(Locne_Chain *chain, Local_Neuroseg_Ellipse *locseg, 
+		      Trace_Record *tr, Dlist_End_e end)
+{
+  TZ_ASSERT(chain != NULL, "Cannot add node to NULL chain.");
+
+  Locne_Node *p = Make_Locne_Node(locseg, tr);
+
+  if (chain->list == NULL) {
+    chain->list = Locne_Node_Dlist_New();
+    Locne_Node_Dlist_Set_Data(chain->list, p);
+  } else {
+    chain->list = Locne_Node_Dlist_Add(chain->list, p, end);
+  }
+}
+
+void Locne_Chain_Add_Node(Locne_Chain *chain, Locne_Node *p, Dlist_End_e end)
+{
+  TZ_ASSERT(chain != NULL, "Cannot add node to NULL chain.");
+  if (chain->list == NULL) {
+    chain->list = Locne_Node_Dlist_New();
+    Locne_Node_Dlist_Set_Data(chain->list, p);
+  } else {
+    if (end == DL_HEAD) {
+      chain->list = Locne_Node_Dlist_Add(chain->list, p, end);
+    } else {
+      Locne_Node_Dlist_Add(chain->list, p, end);
+    }
+  }
+}
+
+void Locne_Chain_Cat(Locne_Chain *chain1, const Locne_Chain *chain2)
+{
+  if (chain2 == NULL) {
+    return;
+  }
+
+  Locne_Node_Dlist *head = Locne_Node_Dlist_Head(chain2->list);
+  if (head == NULL) {
+    return;
+  }
+
+  if (chain1->list == NULL) {
+    chain1->list = head;
+  } else {
+    Locne_Node_Dlist *tail = Locne_Node_Dlist_Tail(chain1->list);
+    tail->next = head;
+    head->prev = tail;
+  }
+}
+
+void Locne_Chain_Insert(Locne_Chain *chain, Local_Neuroseg_Ellipse *locne, 
+		       Trace_Record *tr, int index)
+{
+  ASSERT(chain != NULL, "Cannot add node to NULL chain.");
+
+  if (index < 0) {
+    Locne_Chain_Add(chain, locne, tr, DL_HEAD);
+  } else {
+    Locne_Chain_Iterator_Locate(chain, index);
+  
+    if (chain->iterator == NULL) {
+      Locne_Chain_Add(chain, locne, tr, DL_TAIL);
+    } else {
+      Locne_Node *p = Make_Locne_Node(locne, tr);
+      Locne_Node_Dlist_Insert(chain->iterator, p);
+    }
+  }
+}
+
+void Locne_Chain_Remove_End(Locne_Chain *chain, Dlist_End_e end)
+{
+  if (Locne_Chain_Is_Empty(chain) == FALSE) {
+    chain->list = Locne_Node_Dlist_Remove_End(chain->list, end);
+  }
+}
+
+void Locne_Chain_Remove_Current(Locne_Chain *chain)
+{
+  if (Locne_Chain_Is_Empty(chain) == FALSE) {
+    if (chain->iterator != NULL) {
+      Locne_Node_Dlist *next = chain->iterator->next;
+      chain->list = Locne_Node_Dlist_Remove_Node(chain->iterator);
+      chain->iterator = next;
+    }
+  }
+}
+
+Locne_Node* Locne_Chain_Take_Current(Locne_Chain *chain)
+{
+  if (Locne_Chain_Is_Empty(chain)) {
+    return NULL;
+  }
+    
+  if (chain->iterator == NULL) {
+    return NULL;
+  }  
+
+  Locne_Node *node = chain->iterator->data;
+  chain->iterator->data = NULL;
+  Locne_Chain_Remove_Current(chain);
+
+  return node;
+}
+
+Locne_Chain* Dir_Locne_Chain_N(const char *dir_name, const char *pattern,
+				 int *n, int *file_num)
+{
+  *n = dir_fnum_p(dir_name, pattern);
+  if (*n == 0) {
+    return NULL;
+  }
+
+  Locne_Chain *chain_array =
+    (Locne_Chain*) Guarded_Malloc(sizeof(Locne_Chain) * (*n), 
+				   "Dir_Neurochain");
+  
+  DIR *dir = opendir(dir_name);
+  struct dirent *ent = readdir(dir);
+  int index = 0;
+
+  /* allocate a string for storing full path. 100 is just an initial guess */
+  char *full_path = (char *) Guarded_Malloc(strlen(dir_name) + 100, 
+					    "Dir_Neurochain");
+  strcpy(full_path, dir_name);  
+  strcat(full_path, "/");
+	
+  regex_t preg;
+  regcomp(&preg, pattern, REG_BASIC);
+
+  while (ent != NULL) {
+    if (regexec(&preg, ent->d_name, 0, NULL, REG_BASIC) ==0) {
+      int path_length = strlen(dir_name) + strlen(ent->d_name) + 1;
+      if (path_length > strlen(full_path)) {
+	full_path = (char *) Guarded_Realloc(full_path, path_length + 1, 
+					     "Dir_Neurochain");
+      }
+      strcpy(full_path + strlen(dir_name) + 1, ent->d_name);
+#ifdef _DEBUG_2
+      printf("%d: %s\n", index, full_path);
+#endif
+      if (file_num != NULL) {
+	file_num[index] = String_Last_Integer(ent->d_name);
+      }
+
+      Locne_Chain *chain = Read_Locne_Chain(full_path);
+      chain_array[index++].list = chain->list;
+      Delete_Locne_Chain(chain);
+    }
+    ent = readdir(dir);
+  }
+  free(full_path);
+  closedir(dir);
+
+  regfree(&preg);
+
+  return chain_array;
+}
+
+Locne_Chain** Dir_Locne_Chain_Nd(const char *dir_name, const char *pattern,
+			       int *n, int *file_num)
+{
+  *n = dir_fnum_p(dir_name, pattern);
+  if (*n == 0) {
+    return NULL;
+  }
+
+  Locne_Chain **chain_array =
+    (Locne_Chain**) Guarded_Malloc(sizeof(Locne_Chain*) * (*n), 
+				   "Dir_Neurochain");
+  
+  DIR *dir = opendir(dir_name);
+  struct dirent *ent = readdir(dir);
+  int index = 0;
+
+  /* allocate a string for storing full path. 100 is just an initial guess */
+  char *full_path = (char *) Guarded_Malloc(strlen(dir_name) + 100, 
+					    "Dir_Neurochain");
+  strcpy(full_path, dir_name);  
+  strcat(full_path, "/");
+	
+  regex_t preg;
+  regcomp(&preg, pattern, REG_BASIC);
+
+  while (ent != NULL) {
+    if (regexec(&preg, ent->d_name, 0, NULL, REG_BASIC) ==0) {
+      int path_length = strlen(dir_name) + strlen(ent->d_name) + 1;
+      if (path_length > strlen(full_path)) {
+	full_path = (char *) Guarded_Realloc(full_path, path_length + 1, 
+					     "Dir_Neurochain");
+      }
+      strcpy(full_path + strlen(dir_name) + 1, ent->d_name);
+#ifdef _DEBUG_2
+      printf("%d: %s\n", index, full_path);
+#endif
+      if (file_num != NULL) {
+	file_num[index] = String_Last_Integer(ent->d_name);
+      }
+
+      chain_array[index++] = Read_Locne_Chain(full_path);
+    }
+    ent = readdir(dir);
+  }
+  free(full_path);
+  closedir(dir);
+
+  regfree(&preg);
+
+  return chain_array;
+}
+
+/*
+void Neuron_Structure_Set_Locne_Chain_Array(Neuron_Structure *ns,
+					   Locne_Chain *chain_array)
+{
+  int ncomp = Neuron_Structure_Component_Number(ns);
+  int i;
+  int type = Locne_Chain_Component_Type();
+  for (i = 0; i < ncomp; i++) {
+    Neuron_Component *nc = Neuron_Structure_Get_Component(ns, i);
+    Set_Neuron_Component(nc, type, chain_array + i);
+  }
+}
+*/
@@ -0,0 +1,291 @@
+/* tz_locne_node.c
+ *
+ * 11-Aug-2008 Initial write: Ting Zhao
+ */
+
+#include <stdlib.h>
+#include "tz_utilities.h"
+#include "tz_error.h"
+#include "tz_trace_utils.h"
+#include "tz_locne_node.h"
+#include "string.h"
+
+Locne_Node* New_Locne_Node()
+{
+  Locne_Node *p = (Locne_Node*) 
+    Guarded_Malloc(sizeof(Locne_Node), "New_Locne_Node");
+  
+  p->locseg = NULL;
+  p->tr = NULL;
+
+  return p;
+}
+
+void Delete_Locne_Node(Locne_Node *p)
+{
+  if (p != NULL) {
+    free(p);
+  }
+}
+
+void Clean_Locne_Node(Locne_Node *p)
+{
+  if (p != NULL) {
+    Delete_Local_Neuroseg_Ellipse(p->locseg);
+    p->locseg = NULL;
+    free(p->tr);
+    p->tr = NULL;
+  }
+}
+
+Locne_Node* Make_Locne_Node(const Local_Neuroseg_Ellipse *locseg,
+			      const Trace_Record *tr)
+{
+  Locne_Node *p = New_Locne_Node();
+  p->locseg = (Local_Neuroseg_Ellipse *) locseg;
+  p->tr = (Trace_Record *) tr;
+
+  return p;
+}
+
+void Kill_Locne_Node(Locne_Node *p)
+{
+  Clean_Locne_Node(p);
+  Delete_Locne_Node(p);
+}
+
+Locne_Node* Copy_Locne_Node(const Locne_Node *p)
+{
+  return Make_Locne_Node(Copy_Local_Neuroseg_Ellipse(p->locseg),
+			Copy_Trace_Record(p->tr));
+}
+
+BOOL Locne_Node_Is_Identical(const Locne_Node *p1, const Locne_Node *p2)
+{
+  if (p1 == p2) {
+    return TRUE;
+  }
+
+  if ((p1 == NULL) || (p2 == NULL)) {
+    return FALSE;
+  }
+
+  if (p1->tr != p2->tr) {
+    if ((p1->tr == NULL) || (p2->tr == NULL)) {
+      return FALSE;
+    }
+    
+    if (memcmp(p1->tr, p2->tr, sizeof(Trace_Record)) != 0) {
+      return FALSE;
+    }
+  }
+
+  if (p1->locseg != p2->locseg) {
+    if ((p1->locseg == NULL) || (p2->locseg == NULL)) {
+      return FALSE;
+    }
+
+    if (memcmp(p1->locseg, p2->locseg, sizeof(Local_Neuroseg_Ellipse)) != 0) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+void Print_Locne_Node(const Locne_Node *p)
+{
+  Print_Local_Neuroseg_Ellipse(p->locseg);
+  Print_Trace_Record(p->tr);
+}
+
+void Print_Locne_Node_Info(const Locne_Node *p)
+{
+  Print_Local_Neuroseg_Ellipse(p->locseg);
+}
+
+void Locne_Node_Fwrite(const Locne_Node *p, FILE *stream)
+{
+  ASSERT(p != NULL, "Null Locne_Node");
+  ASSERT(stream != NULL, "Invalid file pointer");
+  
+  Local_Neuroseg_Ellipse_Fwrite(p->locseg, stream);
+  Trace_Record_Fwrite(p->tr, stream);
+}
+
+void Locne_Node_Fwrite_V(const Locne_Node *p, FILE *stream, double version)
+{
+  ASSERT(p != NULL, "Null Locne_Node");
+  ASSERT(stream != NULL, "Invalid file pointer");
+  
+  Local_Neuroseg_Ellipse_Fwrite(p->locseg, stream);
+  Trace_Record_Fwrite_V(p->tr, stream, version);
+}
+
+Locne_Node* Locne_Node_Fread(Locne_Node *p, FILE *stream)
+{
+  ASSERT(stream != NULL, "Invalid file pointer");
+  
+  if (feof(stream)) {
+    return NULL;
+  }
+  
+  BOOL is_local_alloc = FALSE;
+
+  if (p == NULL) {
+    p = New_Locne_Node();
+    is_local_alloc = TRUE;
+  }
+  
+  if ((p->locseg = Local_Neuroseg_Ellipse_Fread(p->locseg, stream)) == NULL) {
+    if (is_local_alloc == TRUE) {
+      Delete_Locne_Node(p);
+    }
+    p = NULL;
+  } else {
+    if ((p->tr = Trace_Record_Fread(p->tr, stream)) == NULL) {
+      if (feof(stream)) {
+	if (is_local_alloc == TRUE) {
+	  Delete_Locne_Node(p);
+	}
+	p = NULL;
+      }
+    }
+  }
+
+  return p;
+}
+
+Locne_Node* Locne_Node_Fread_V(Locne_Node *p, FILE *stream, double version)
+{
+  ASSERT(stream != NULL, "Invalid file pointer");
+  
+  if (feof(stream)) {
+    return NULL;
+  }
+  
+  BOOL is_local_alloc = FALSE;
+
+  if (p == NULL) {
+    p = New_Locne_Node();
+    is_local_alloc = TRUE;
+  }
+  
+  if ((p->locseg = Local_Neuroseg_Ellipse_Fread(p->locseg, stream)) == NULL) {
+    if (is_local_alloc == TRUE) {
+      Delete_Locne_Node(p);
+    }
+    p = NULL;
+  } else {
+    if ((p->tr = Trace_Record_Fread_V(p->tr, stream, version)) == NULL) {
+      if (feof(stream)) {
+	if (is_local_alloc == TRUE) {
+	  Delete_Locne_Node(p);
+	}
+	p = NULL;
+      }
+    }
+  }
+
+  return p;
+}
+
+void Locne_Node_Copy_Trace_Record(Locne_Node *p, const Trace_Record *tr)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Copy(p->tr, tr);
+}
+
+void Locne_Node_Set_Score(Locne_Node *p, const Stack_Fit_Score *fs)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Set_Score(p->tr, fs);
+}
+
+void Locne_Node_Set_Hit_Region(Locne_Node *p, int hit_region)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Set_Hit_Region(p->tr, hit_region);
+}
+
+void Locne_Node_Set_Index(Locne_Node *p, int index)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Set_Index(p->tr, index);
+}
+
+void Locne_Node_Set_Refit(Locne_Node *p, BOOL is_refit)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Set_Refit(p->tr, is_refit);
+}
+
+void Locne_Node_Set_Direction(Locne_Node *p, Dlist_Direction_e direction)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Set_Direction(p->tr, direction);
+}
+
+void Locne_Node_Set_Fit_Height(Locne_Node *p, int index, int value)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Set_Fit_Height(p->tr, index, value);
+}
+
+void Locne_Node_Set_Fix_Point(Locne_Node *p, double value)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Set_Fix_Point(p->tr, value);
+}
+
+double Locne_Node_Fix_Point(Locne_Node *p)
+{
+  double t = Trace_Record_Fix_Point(p->tr);
+  if ((t < 0.0) || (t > 1.0)){
+    switch (Trace_Record_Direction(p->tr)) {
+    case DL_FORWARD:
+      t = 0.0;
+      break;
+    case DL_BACKWARD:
+      t = 1.0;
+      break;
+    case DL_BOTHDIR:
+      t = -1.0;
+      break;
+    default:
+      t = 0.0;
+    }
+  }
+
+  return t;
+}
+
+BOOL Locne_Node_Fix_Pos(Locne_Node *p, double *pos)
+{
+
+   return FALSE;
+}
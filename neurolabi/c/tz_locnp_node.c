@@ -0,0 +1,291 @@
+/* tz_locnp_node.c
+ *
+ * 11-Aug-2008 Initial write: Ting Zhao
+ */
+
+#include <stdlib.h>
+#include "tz_utilities.h"
+#include "tz_error.h"
+#include "tz_trace_utils.h"
+#include "tz_locnp_node.h"
+#include "string.h"
+
+Locnp_Node* New_Locnp_Node()
+{
+  Locnp_Node *p = (Locnp_Node*) 
+    Guarded_Malloc(sizeof(Locnp_Node), "New_Locnp_Node");
+  
+  p->locseg = NULL;
+  p->tr = NULL;
+
+  return p;
+}
+
+void Delete_Locnp_Node(Locnp_Node *p)
+{
+  if (p != NULL) {
+    free(p);
+  }
+}
+
+void Clean_Locnp_Node(Locnp_Node *p)
+{
+  if (p != NULL) {
+    Delete_Local_Neuroseg_Plane(p->locseg);
+    p->locseg = NULL;
+    free(p->tr);
+    p->tr = NULL;
+  }
+}
+
+Locnp_Node* Make_Locnp_Node(const Local_Neuroseg_Plane *locseg,
+			      const Trace_Record *tr)
+{
+  Locnp_Node *p = New_Locnp_Node();
+  p->locseg = (Local_Neuroseg_Plane *) locseg;
+  p->tr = (Trace_Record *) tr;
+
+  return p;
+}
+
+void Kill_Locnp_Node(Locnp_Node *p)
+{
+  Clean_Locnp_Node(p);
+  Delete_Locnp_Node(p);
+}
+
+Locnp_Node* Copy_Locnp_Node(const Locnp_Node *p)
+{
+  return Make_Locnp_Node(Copy_Local_Neuroseg_Plane(p->locseg),
+			Copy_Trace_Record(p->tr));
+}
+
+BOOL Locnp_Node_Is_Identical(const Locnp_Node *p1, const Locnp_Node *p2)
+{
+  if (p1 == p2) {
+    return TRUE;
+  }
+
+  if ((p1 == NULL) || (p2 == NULL)) {
+    return FALSE;
+  }
+
+  if (p1->tr != p2->tr) {
+    if ((p1->tr == NULL) || (p2->tr == NULL)) {
+      return FALSE;
+    }
+    
+    if (memcmp(p1->tr, p2->tr, sizeof(Trace_Record)) != 0) {
+      return FALSE;
+    }
+  }
+
+  if (p1->locseg != p2->locseg) {
+    if ((p1->locseg == NULL) || (p2->locseg == NULL)) {
+      return FALSE;
+    }
+
+    if (memcmp(p1->locseg, p2->locseg, sizeof(Local_Neuroseg_Plane)) != 0) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+void Print_Locnp_Node(const Locnp_Node *p)
+{
+  Print_Local_Neuroseg_Plane(p->locseg);
+  Print_Trace_Record(p->tr);
+}
+
+void Print_Locnp_Node_Info(const Locnp_Node *p)
+{
+  Print_Local_Neuroseg_Plane(p->locseg);
+}
+
+void Locnp_Node_Fwrite(const Locnp_Node *p, FILE *stream)
+{
+  ASSERT(p != NULL, "Null Locnp_Node");
+  ASSERT(stream != NULL, "Invalid file pointer");
+  
+  Local_Neuroseg_Plane_Fwrite(p->locseg, stream);
+  Trace_Record_Fwrite(p->tr, stream);
+}
+
+void Locnp_Node_Fwrite_V(const Locnp_Node *p, FILE *stream, double version)
+{
+  ASSERT(p != NULL, "Null Locnp_Node");
+  ASSERT(stream != NULL, "Invalid file pointer");
+  
+  Local_Neuroseg_Plane_Fwrite(p->locseg, stream);
+  Trace_Record_Fwrite_V(p->tr, stream, version);
+}
+
+Locnp_Node* Locnp_Node_Fread(Locnp_Node *p, FILE *stream)
+{
+  ASSERT(stream != NULL, "Invalid file pointer");
+  
+  if (feof(stream)) {
+    return NULL;
+  }
+  
+  BOOL is_local_alloc = FALSE;
+
+  if (p == NULL) {
+    p = New_Locnp_Node();
+    is_local_alloc = TRUE;
+  }
+  
+  if ((p->locseg = Local_Neuroseg_Plane_Fread(p->locseg, stream)) == NULL) {
+    if (is_local_alloc == TRUE) {
+      Delete_Locnp_Node(p);
+    }
+    p = NULL;
+  } else {
+    if ((p->tr = Trace_Record_Fread(p->tr, stream)) == NULL) {
+      if (feof(stream)) {
+	if (is_local_alloc == TRUE) {
+	  Delete_Locnp_Node(p);
+	}
+	p = NULL;
+      }
+    }
+  }
+
+  return p;
+}
+
+Locnp_Node* Locnp_Node_Fread_V(Locnp_Node *p, FILE *stream, double version)
+{
+  ASSERT(stream != NULL, "Invalid file pointer");
+  
+  if (feof(stream)) {
+    return NULL;
+  }
+  
+  BOOL is_local_alloc = FALSE;
+
+  if (p == NULL) {
+    p = New_Locnp_Node();
+    is_local_alloc = TRUE;
+  }
+  
+  if ((p->locseg = Local_Neuroseg_Plane_Fread(p->locseg, stream)) == NULL) {
+    if (is_local_alloc == TRUE) {
+      Delete_Locnp_Node(p);
+    }
+    p = NULL;
+  } else {
+    if ((p->tr = Trace_Record_Fread_V(p->tr, stream, version)) == NULL) {
+      if (feof(stream)) {
+	if (is_local_alloc == TRUE) {
+	  Delete_Locnp_Node(p);
+	}
+	p = NULL;
+      }
+    }
+  }
+
+  return p;
+}
+
+void Locnp_Node_Copy_Trace_Record(Locnp_Node *p, const Trace_Record *tr)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Copy(p->tr, tr);
+}
+
+void Locnp_Node_Set_Score(Locnp_Node *p, const Stack_Fit_Score *fs)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Set_Score(p->tr, fs);
+}
+
+void Locnp_Node_Set_Hit_Region(Locnp_Node *p, int hit_region)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Set_Hit_Region(p->tr, hit_region);
+}
+
+void Locnp_Node_Set_Index(Locnp_Node *p, int index)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Set_Index(p->tr, index);
+}
+
+void Locnp_Node_Set_Refit(Locnp_Node *p, BOOL is_refit)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Set_Refit(p->tr, is_refit);
+}
+
+void Locnp_Node_Set_Direction(Locnp_Node *p, Dlist_Direction_e direction)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Set_Direction(p->tr, direction);
+}
+
+void Locnp_Node_Set_Fit_Height(Locnp_Node *p, int index, int value)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Set_Fit_Height(p->tr, index, value);
+}
+
+void Locnp_Node_Set_Fix_Point(Locnp_Node *p, double value)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Set_Fix_Point(p->tr, value);
+}
+
+double Locnp_Node_Fix_Point(Locnp_Node *p)
+{
+  double t = Trace_Record_Fix_Point(p->tr);
+  if ((t < 0.0) || (t > 1.0)){
+    switch (Trace_Record_Direction(p->tr)) {
+    case DL_FORWARD:
+      t = 0.0;
+      break;
+    case DL_BACKWARD:
+      t = 1.0;
+      break;
+    case DL_BOTHDIR:
+      t = -1.0;
+      break;
+    default:
+      t = 0.0;
+    }
+  }
+
+  return t;
+}
+
+BOOL Locnp_Node_Fix_Pos(Locnp_Node *p, double *pos)
+{
+
+   return FALSE;
+}
@@ -0,0 +1,451 @@
+/* tz_linked_list_c.t
+ *
+ * 27-Nov-2007 Initial write: Ting Zhao
+ */
+
+#include <stdlib.h>
+#include "tz_error.h"
+#include "utilities.h"
+#include "tz_locnp_node_doubly_linked_list.h"
+
+INIT_EXCEPTION
+
+#undef _DEBUG_
+
+/* Locnp_Node_Dlist_New(): New a Locnp_Node list.
+ *
+ * Return: A Locnp_Node list with length 1.
+ */
+Locnp_Node_Dlist* Locnp_Node_Dlist_New()
+{
+  Locnp_Node_Dlist *new_list = (Locnp_Node_Dlist *) Guarded_Malloc(sizeof(Locnp_Node_Dlist), 
+						     "Locnp_Node_Dlist_New");
+  
+  new_list->data = 0x0;
+  
+  new_list->next = NULL;
+  new_list->prev = NULL;
+
+  return new_list;
+}
+
+void Locnp_Node_Dlist_Remove_All(Locnp_Node_Dlist *p)
+{
+  Locnp_Node_Dlist *head = Locnp_Node_Dlist_Head(p);
+  while (head != NULL) {
+    p = head;
+    
+    if (p->data != NULL) {
+      Kill_Locnp_Node(p->data);
+    }
+    
+	
+    
+
+    head = head->next;
+#ifdef _DEBUG_
+    printf("%p freed\n", p);
+#endif
+    free(p);
+  }
+}
+
+void Locnp_Node_Dlist_Set_Data(Locnp_Node_Dlist *p, Locnp_Node_P data)
+{
+  p->data = data;
+}
+
+Locnp_Node_Dlist *Locnp_Node_Dlist_Head(const Locnp_Node_Dlist *p)
+{
+  if (p == NULL) {
+    return NULL;
+  }
+
+  while (p->prev != NULL) {
+    p = p->prev;
+  }
+
+  return (Locnp_Node_Dlist *) p;
+}
+
+Locnp_Node_Dlist *Locnp_Node_Dlist_Tail(const Locnp_Node_Dlist *p)
+{
+  if (p == NULL) {
+    return NULL;
+  }
+
+  while (p->next != NULL) {
+    p = p->next;
+  }
+
+  return (Locnp_Node_Dlist *) p;
+}
+
+Locnp_Node_Dlist* Locnp_Node_Dlist_Next(const Locnp_Node_Dlist *p, Dlist_Direction_e d)
+{
+  if (p != NULL) {
+    if (d == DL_FORWARD) {
+      return p->next;
+    } else if (d == DL_BACKWARD) {
+      return p->prev;
+    } else {
+      TZ_WARN(ERROR_DATA_VALUE);
+      return NULL;
+    }
+  }
+
+  return NULL;
+}
+
+int Locnp_Node_Dlist_Length(const Locnp_Node_Dlist *p, Dlist_Direction_e d)
+{
+  if (p == NULL) {
+    return 0;
+  }
+
+  int length = 0;
+
+  switch (d) {
+  case DL_FORWARD:
+    for(; p != NULL; p = p->next) {
+      length++;
+    }
+    break;
+  case DL_BACKWARD:
+    for(; p != NULL; p = p->prev) {
+      length++;
+    }
+    break;
+  case DL_BOTHDIR:
+    length = Locnp_Node_Dlist_Length(p, DL_BACKWARD) + 
+      Locnp_Node_Dlist_Length(p->next, DL_FORWARD);
+    break;
+  default:
+    TZ_WARN(ERROR_DATA_VALUE);
+    length = -1;
+  }
+
+  return length;  
+}
+
+Locnp_Node_Dlist* Locate_Locnp_Node_Dlist(const Locnp_Node_Dlist *p, int n)
+{
+  if (p == NULL) {
+    return NULL;
+  }
+
+  int i;
+  
+  if (n > 0) {
+    for (i = 0; i < n; i++) {
+      p = p->next;
+      if (p == NULL) {
+	return NULL;
+      }
+    }
+  } else if (n < 0){ /* going back */
+    for (i = 0; i < -n;  i++) {
+      p = p->prev;
+      if (p == NULL) {
+	return NULL;
+      }
+    }
+  }
+
+  return (Locnp_Node_Dlist *)  p;
+}
+
+Locnp_Node_Dlist* Append_Locnp_Node_Dlist(Locnp_Node_Dlist *p1, Locnp_Node_Dlist *p2)
+{
+  if (p1 == NULL) {
+    return p2;
+  }
+
+  if (p2 == NULL) {
+    return p1;
+  }
+
+  Locnp_Node_Dlist *head = Locnp_Node_Dlist_Head(p1);
+
+  p1 = Locnp_Node_Dlist_Tail(p1);
+  p2 = Locnp_Node_Dlist_Head(p2);
+
+  p1->next = p2;
+  p2->prev = p1;
+
+  return head;
+}
+
+
+Locnp_Node_Dlist* Locnp_Node_Dlist_Remove_End(Locnp_Node_Dlist *p, Dlist_End_e e)
+{
+  ASSERT(p != NULL, "null pointer");
+
+  Locnp_Node_Dlist *end;
+
+  switch (e) {
+  case DL_HEAD:
+    end = Locnp_Node_Dlist_Head(p);
+    p = end->next;
+    if (p != NULL) {
+      p->prev = NULL;
+    }
+    end->next = NULL;
+    Locnp_Node_Dlist_Remove_All(end);
+    break;
+  case DL_TAIL:
+    end = Locnp_Node_Dlist_Tail(p);
+    p = end->prev;
+    if (p != NULL) {
+      p->next = NULL;
+    }
+    end->prev = NULL;
+    Locnp_Node_Dlist_Remove_All(end);
+    break;
+  default:
+    TZ_WARN(ERROR_DATA_TYPE);
+    return NULL;
+  }
+
+  return p;
+}
+
+
+Locnp_Node_Dlist* Locnp_Node_Dlist_Remove_Node(Locnp_Node_Dlist *p)
+{
+  if (p == NULL) {
+    return NULL;
+  }
+
+  Locnp_Node_Dlist *head = Locnp_Node_Dlist_Head(p);
+  Locnp_Node_Dlist *prev = p->prev;
+
+  if (prev == NULL) {
+    head = p->next;
+  } else {
+    prev->next = p->next;
+    p->prev = NULL;
+  }
+
+  if (p->next != NULL) {
+    p->next->prev = prev;
+    p->next = NULL;
+  }
+
+  Locnp_Node_Dlist_Remove_All(p);
+
+  return head;
+}
+
+/* Locnp_Node_Dlist_Add(): Add a node to the beginning of the list.
+ * 
+ * Args: p - pointer to the list;
+ *       data - data node.
+ *
+ * Return: the old head.
+ * 
+ * Note: <data> (not its copy) will be added to the list, so be careful about
+ *       freeing the object.
+ */
+Locnp_Node_Dlist* Locnp_Node_Dlist_Add(Locnp_Node_Dlist *p, Locnp_Node_P data, Dlist_End_e e)
+{
+  Locnp_Node_Dlist *new_node = Locnp_Node_Dlist_New();
+  Locnp_Node_Dlist_Set_Data(new_node, data);
+
+  if (p == NULL) {
+#ifdef _DEBUG_2
+    printf("%p->%p added\n", new_node, data);
+#endif    
+    return new_node;
+  }
+  
+  switch (e) {
+  case DL_HEAD:
+    p = Locnp_Node_Dlist_Head(p);
+    new_node->next = p;
+    p->prev = new_node;
+    p = new_node;
+    break;
+  case DL_TAIL:
+    p = Locnp_Node_Dlist_Tail(p);
+    new_node->prev = p;
+    p->next = new_node;
+#ifdef _DEBUG_2
+    printf("%p->%p added\n", new_node, data);
+#endif
+    p = new_node;
+    break;
+  default:
+    TZ_WARN(ERROR_DATA_VALUE);
+    Locnp_Node_Dlist_Remove_All(new_node);
+  }
+      
+  return p;
+}
+
+void Locnp_Node_Dlist_Insert(Locnp_Node_Dlist *p, Locnp_Node_P data)
+{
+  if (p == NULL) {
+    return;
+  }
+
+  Locnp_Node_Dlist *new_node = Locnp_Node_Dlist_New();
+  Locnp_Node_Dlist_Set_Data(new_node, data);
+  
+  Locnp_Node_Dlist *prev = p->prev;
+  p->prev = new_node;
+  new_node->next = p;
+  new_node->prev = prev;
+  if (prev != NULL) {
+    prev->next = new_node;
+  }
+}
+
+/* Locnp_Node_Dlist_Unlink(): Unlink the head of a list.
+ *
+ * Args: p - input list, which will be changed.
+ *
+ * Return: the unlinked data.
+ */
+Locnp_Node_P Locnp_Node_Dlist_Unlink(Locnp_Node_Dlist **p)
+{
+  if (*p != NULL) {
+    Locnp_Node_Dlist *tmp_head = *p;
+    *p = tmp_head->next;
+
+    Locnp_Node_P data = tmp_head->data;
+    free(tmp_head);
+    
+    return data;
+  }
+
+  
+  return NULL;
+  
+  
+}
+
+BOOL Locnp_Node_Dlist_Is_Empty(const Locnp_Node_Dlist *p)
+{
+  if (p == NULL) {
+    return TRUE;
+  } else {
+    return FALSE;
+  }
+}
+
+/* Locnp_Node_Dlist_To_Array(): Turn a list to an array.
+ *
+ * Args: p - input list;
+ *       array - returned array. If it is NULL, a new array will be created,
+ *               otherwise it must be large enough to hold the result.
+ *       step - The offset between an element and its right neighbor. If it is
+ *              negative, the array has a reversed order.
+ * Return: the resulted array.
+ *
+ * Note: The caller is responsible for freeing the returned array.
+ */
+Locnp_Node_P* Locnp_Node_Dlist_To_Array(const Locnp_Node_Dlist *p, int step, Locnp_Node_P *array, int *length)
+{
+  if (step == 0) {
+    THROW(ERROR_DATA_VALUE);
+  }
+
+  int n = Locnp_Node_Dlist_Length(p, DL_FORWARD);
+  int array_length = (n - 1) * abs(step) + 1;
+
+  if (array == NULL) {
+    array = (Locnp_Node_P *) Guarded_Malloc(sizeof(Locnp_Node_P) * array_length, 
+				    "Locnp_Node_Dlist_To_Array");
+  }
+
+  int begin;
+  int end;
+  
+  if (step > 0) {
+    begin = 0;
+    end = array_length - 1;
+  } else {
+    begin = array_length - 1;
+    end = 0;
+  }
+  
+  int i;
+  for (i = begin; p != NULL; i += step, p = p->next) {
+    array[i] = p->data;
+  }
+
+  if (length != NULL) {
+    *length = array_length;
+  }
+
+  return array;
+}
+
+/* Print_Locnp_Node_Dlist(): Print Locnp_Node list.
+ *
+ * Args: p - list to print.
+ *
+ * Return: void.
+ *
+ * Note: This function works only when Print_Locnp_Node is available.
+ */
+void Print_Locnp_Node_Dlist(const Locnp_Node_Dlist *p)
+{
+  if (p == NULL) {
+    printf("Null list.\n");
+    return;
+  }
+
+  printf("Total length: %d\n", Locnp_Node_Dlist_Length(p, DL_BOTHDIR));
+
+  
+  while (p != NULL) {
+    Print_Locnp_Node(p->data);
+    p = p->next;
+  }
+  
+
+}
+
+/* Print_Locnp_Node_Dlist_Compact(): Print Locnp_Node list briefly.
+ *
+ * Args: p - list to print.
+ *
+ * Return: void.
+ *
+ * Note: This function works only when Print_Locnp_Node_Info is available.
+ */
+void Print_Locnp_Node_Dlist_Compact(const Locnp_Node_Dlist *p)
+{
+  if (p == NULL) {
+    printf("Null list.\n");
+    return;
+  }
+
+  
+  int i = 1;
+  while (p != NULL) {
+    printf("Item %d: ", i);
+    Print_Locnp_Node_Info(p->data);
+    i++;
+    p = p->next;
+  }
+  
+}
+
+void Print_Locnp_Node_Dlist_F(const Locnp_Node_Dlist *p, const char *format)
+{
+  if (p == NULL) {
+    printf("Null list.\n");
+    return;
+  }
+
+  printf("Total length: %d\n", Locnp_Node_Dlist_Length(p, DL_FORWARD));
+  while (p != NULL) {
+    printf(format, p->data);
+    printf(" ");
+    p = p->next;
+  }
+  printf("\n");
+}
@@ -0,0 +1,639 @@
+/* tz_locrect_chain.c
+ *
+ * 06-May-2008 Initial write: Ting Zhao
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#if defined(_WIN32) || defined(_WIN64)
+  #define PCRE_STATIC
+  #include <pcre2posix.h>
+#else
+  #include <regex.h>
+#endif
+#include <string.h>
+#ifndef _MSC_VER
+#include <dirent.h>
+#else
+#include "tz_dirent.h"
+#endif
+#include "tz_utilities.h"
+#include "tz_constant.h"
+#include "tz_error.h"
+#include "tz_interface.h"
+#include "tz_stack_sampling.h"
+#include "tz_trace_utils.h"
+#include "tz_darray.h"
+#include "tz_cont_fun.h"
+#include "tz_locrect_chain_com.h"
+#include "tz_vrml_material.h"
+#include "tz_vrml_io.h"
+#include "tz_geo3d_utils.h"
+#include "tz_string.h"
+#include "tz_geo3d_point_array.h"
+#include "tz_stack_graph.h"
+#include "tz_image_array.h"
+#include "tz_swc_cell.h"
+#include "tz_u8array.h"
+
+
+Locrect_Chain* New_Locrect_Chain(void)
+{
+  Locrect_Chain *chain = 
+    (Locrect_Chain *) Guarded_Malloc(sizeof(Locrect_Chain), "New_Locrect_Chain");
+
+  chain->list = NULL;
+  chain->iterator = NULL;
+
+  return chain;
+}
+
+void Delete_Locrect_Chain(Locrect_Chain *chain)
+{
+  if (chain != NULL) {
+    free(chain);
+  }
+}
+
+void Construct_Locrect_Chain(Locrect_Chain *chain, Locrect_Node *p)
+{
+  chain->list = Locrect_Node_Dlist_New();
+  Locrect_Node_Dlist_Set_Data(chain->list, p);
+}
+
+void Clean_Locrect_Chain(Locrect_Chain *chain)
+{
+  if (chain != NULL) {
+    Locrect_Node_Dlist_Remove_All(chain->list);
+    chain->list = NULL;
+    chain->iterator = NULL;
+  }
+}
+
+Locrect_Chain* Make_Locrect_Chain(Locrect_Node *p)
+{
+  Locrect_Chain *chain = New_Locrect_Chain();
+  Construct_Locrect_Chain(chain, p);
+
+  return chain;
+}
+
+void Kill_Locrect_Chain(Locrect_Chain *chain)
+{
+  Clean_Locrect_Chain(chain);
+  Delete_Locrect_Chain(chain);
+}
+
+int Locrect_Chain_Length(Locrect_Chain *chain)
+{
+  if (chain == NULL) {
+    return 0;
+  }
+
+  return Locrect_Node_Dlist_Length(chain->list, DL_BOTHDIR);
+}
+
+BOOL Locrect_Chain_Is_Empty(Locrect_Chain *chain)
+{
+  if (chain == NULL) {
+    return TRUE;
+  }
+
+  if (chain->list == NULL) {
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+Locrect_Node_Dlist* Locrect_Chain_Iterator_Start(Locrect_Chain *chain, 
+					       Dlist_End_e d)
+{
+  Locrect_Node_Dlist *old_iter = chain->iterator;
+
+  switch (d) {
+  case DL_HEAD:
+    chain->iterator = Locrect_Node_Dlist_Head(chain->list);
+    break;
+  case DL_TAIL:
+    chain->iterator = Locrect_Node_Dlist_Tail(chain->list);
+    break;
+  default:
+    TZ_ERROR(ERROR_DATA_VALUE);
+    break;
+  }
+
+  return old_iter;
+}
+
+Locrect_Node_Dlist* Locrect_Chain_Iterator_Locate(Locrect_Chain *chain, int index)
+{
+  Locrect_Node_Dlist *old_iter = NULL;
+  
+  if (index >= 0) {
+    old_iter = Locrect_Chain_Iterator_Start(chain, DL_HEAD);
+  } else {
+    old_iter = Locrect_Chain_Iterator_Start(chain, DL_TAIL);
+  }
+
+  chain->iterator = Locate_Locrect_Node_Dlist(chain->iterator, index);
+  
+  return old_iter;
+}
+
+Locrect_Node* Locrect_Chain_Next(Locrect_Chain *chain)
+{
+  if (chain == NULL) {
+    return NULL;
+  }
+
+  if ((chain->list == NULL) || (chain->iterator == NULL)) {
+    return NULL;
+  }
+
+  Locrect_Node *p = chain->iterator->data;
+
+  chain->iterator = chain->iterator->next;
+
+  return p;
+}
+
+Locrect_Node* Locrect_Chain_Prev(Locrect_Chain *chain)
+{
+  if (chain == NULL) {
+    return NULL;
+  }
+
+  if ((chain->list == NULL) || (chain->iterator == NULL)) {
+    return NULL;
+  }
+
+  Locrect_Node *p = chain->iterator->data;
+
+  chain->iterator = chain->iterator->prev;
+
+  return p;
+}
+
+Locrect_Node* Locrect_Chain_Next_D(Locrect_Chain *chain, Dlist_End_e d)
+{
+  if (d == DL_HEAD) {
+    return Locrect_Chain_Next(chain);
+  }
+
+  if (d == DL_TAIL) {
+    return Locrect_Chain_Prev(chain);
+  }
+
+  return NULL;
+}
+
+Locrect_Node* Locrect_Chain_Peek(const Locrect_Chain *chain)
+{
+  if (chain == NULL) {
+    return NULL;
+  }
+
+  if ((chain->list == NULL) || (chain->iterator == NULL)) {
+    return NULL;
+  }
+
+  return chain->iterator->data;
+}
+
+Local_R2_Rect* Locrect_Chain_Peek_Seg(const Locrect_Chain *chain)
+{
+  Locrect_Node *p = Locrect_Chain_Peek(chain);
+  if (p == NULL) {
+    return NULL;
+  }
+
+  return p->locseg;
+}
+
+Locrect_Node* Locrect_Chain_Peek_Next(const Locrect_Chain *chain)
+{
+  if (chain == NULL) {
+    return NULL;
+  }
+
+  if (chain->iterator == NULL) {
+    return NULL;
+  }
+
+  if (chain->iterator->next == NULL) {
+    return NULL;
+  }
+
+  return chain->iterator->next->data;
+}
+
+Locrect_Node* Locrect_Chain_Peek_Prev(const Locrect_Chain *chain)
+{
+  if (chain == NULL) {
+    return NULL;
+  }
+
+  if (chain->iterator == NULL) {
+    return NULL;
+  }
+
+  if (chain->iterator->prev == NULL) {
+    return NULL;
+  }
+
+  return chain->iterator->prev->data;  
+}
+
+Local_R2_Rect* Locrect_Chain_Next_Seg(Locrect_Chain *chain)
+{
+  Locrect_Node *p = Locrect_Chain_Next(chain);
+  if (p == NULL) {
+    return NULL;
+  } else {
+    return p->locseg;
+  }
+}
+
+Local_R2_Rect* Locrect_Chain_Prev_Seg(Locrect_Chain *chain)
+{
+  Locrect_Node *p = Locrect_Chain_Prev(chain);
+  if (p == NULL) {
+    return NULL;
+  } else {
+    return p->locseg;
+  }
+}
+
+Local_R2_Rect* Locrect_Chain_Next_Seg_D(Locrect_Chain *chain, Dlist_End_e d)
+{
+  if (d == DL_HEAD) {
+    return Locrect_Chain_Next_Seg(chain);
+  }
+
+  if (d == DL_TAIL) {
+    return Locrect_Chain_Prev_Seg(chain);
+  }
+
+  return NULL;
+}
+
+void Print_Locrect_Chain(Locrect_Chain *chain)
+{
+  Locrect_Node_Dlist* old_iter = Locrect_Chain_Iterator_Start(chain, DL_HEAD);
+  Locrect_Node *p = NULL;
+  int n = 0;
+  while ((p = Locrect_Chain_Next(chain)) != NULL) {
+    Print_Locrect_Node(p);
+    n++;
+  }
+
+  printf("Total length: %d\n", n);
+
+  chain->iterator = old_iter;
+}
+
+void Write_Locrect_Chain(const char *file_path, Locrect_Chain *chain)
+{
+  FILE *fp = Guarded_Fopen((char*) file_path, "wb", "Write_Locrect_Chain");
+  
+  Locrect_Node_Dlist *old_iter = Locrect_Chain_Iterator_Start(chain, DL_HEAD);
+  Locrect_Node *p = NULL;
+  
+  double version = CHAIN_VERSION;
+  if (version > 0.0) {
+    double start = -version;
+    fwrite(&start, sizeof(double), 1, fp);
+  }
+
+  while ((p = Locrect_Chain_Next(chain)) != NULL) {
+    Locrect_Node_Fwrite_V(p, fp, version);
+  }
+  
+  fclose(fp);
+
+  chain->iterator = old_iter;
+}
+
+Locrect_Chain* Read_Locrect_Chain(const char *file_path)
+{
+  //FILE *fp = Guarded_Fopen((char*) file_path, "r", "Read_Locrect_Chain");
+  FILE *fp = NULL;
+  if ((fp = fopen(file_path, "rb")) == NULL) {
+    return NULL;
+  }
+  
+  Locrect_Chain *chain = New_Locrect_Chain();
+  Locrect_Node *node = NULL;
+
+  double start;
+  double version = 0;
+  fread(&start, sizeof(double), 1, fp);
+  if (start >= 0) {
+    fseek(fp, 0, SEEK_SET);
+  } else {
+    version = -start;
+  }
+
+  while ((node = Locrect_Node_Fread_V(NULL, fp, version)) != NULL) {
+    Locrect_Chain_Add_Node(chain, node, DL_TAIL);
+  }
+
+  fclose(fp);
+
+  return chain;
+}
+
+Locrect_Node* Locrect_Chain_Head(Locrect_Chain *chain)
+{
+  if (chain == NULL) {
+    return NULL;
+  }
+
+  if (chain->list == NULL) {
+    return NULL;
+  }
+
+  Locrect_Node_Dlist *tail = Locrect_Node_Dlist_Head(chain->list);
+
+  return tail->data;
+}
+
+Locrect_Node* Locrect_Chain_Tail(Locrect_Chain *chain)
+{
+  if (chain == NULL) {
+    return NULL;
+  }
+
+  if (chain->list == NULL) {
+    return NULL;
+  }
+
+  Locrect_Node_Dlist *tail = Locrect_Node_Dlist_Tail(chain->list);
+
+  return tail->data;
+}
+
+Local_R2_Rect* Locrect_Chain_Head_Seg(Locrect_Chain *chain)
+{
+  Locrect_Node *p = Locrect_Chain_Head(chain);
+  if (p == NULL) {
+    return NULL;
+  } else {
+    return p->locseg;
+  }
+}
+
+Local_R2_Rect* Locrect_Chain_Tail_Seg(Locrect_Chain *chain)
+{
+  Locrect_Node *p = Locrect_Chain_Tail(chain);
+  if (p == NULL) {
+    return NULL;
+  } else {
+    return p->locseg;
+  }
+}
+
+Locrect_Node* Locrect_Chain_Peek_At(Locrect_Chain *chain, int index)
+{
+  Locrect_Node_Dlist *old_iter = Locrect_Chain_Iterator_Locate(chain, index);
+  Locrect_Node *node = Locrect_Chain_Peek(chain);
+
+  chain->iterator = old_iter;
+  
+  return node;
+}
+
+Local_R2_Rect* Locrect_Chain_Peek_Seg_At(Locrect_Chain *chain, int index)
+{
+  Locrect_Node_Dlist *old_iter = Locrect_Chain_Iterator_Locate(chain, index);
+  Local_R2_Rect *locseg = Locrect_Chain_Peek_Seg(chain);
+  chain->iterator = old_iter;
+  
+  return locseg;
+}
+
+void Locrect_Chain_Add(Locrect_Chain *chain, Local_R2_Rect *locseg, 
+		      Trace_Record *tr, Dlist_End_e end)
+{
+  TZ_ASSERT(chain != NULL, "Cannot add node to NULL chain.");
+
+  Locrect_Node *p = Make_Locrect_Node(locseg, tr);
+
+  if (chain->list == NULL) {
+    chain->list = Locrect_Node_Dlist_New();
+    Locrect_Node_Dlist_Set_Data(chain->list, p);
+  } else {
+    chain->list = Locrect_Node_Dlist_Add(chain->list, p, end);
+  }
+}
+
+void Locrect_Chain_Add_Node(Locrect_Chain *chain, Locrect_Node *p, Dlist_End_e end)
+{
+  TZ_ASSERT(chain != NULL, "Cannot add node to NULL chain.");
+  if (chain->list == NULL) {
+    chain->list = Locrect_Node_Dlist_New();
+    Locrect_Node_Dlist_Set_Data(chain->list, p);
+  } else {
+    if (end == DL_HEAD) {
+      chain->list = Locrect_Node_Dlist_Add(chain->list, p, end);
+    } else {
+      Locrect_Node_Dlist_Add(chain->list, p, end);
+    }
+  }
+}
+
+void Locrect_Chain_Cat(Locrect_Chain *chain1, const Locrect_Chain *chain2)
+{
+  if (chain2 == NULL) {
+    return;
+  }
+
+  Locrect_Node_Dlist *head = Locrect_Node_Dlist_Head(chain2->list);
+  if (head == NULL) {
+    return;
+  }
+
+  if (chain1->list == NULL) {
+    chain1->list = head;
+  } else {
+    Locrect_Node_Dlist *tail = Locrect_Node_Dlist_Tail(chain1->list);
+    tail->next = head;
+    head->prev = tail;
+  }
+}
+
+void Locrect_Chain_Insert(Locrect_Chain *chain, Local_R2_Rect *locrect, 
+		       Trace_Record *tr, int index)
+{
+  ASSERT(chain != NULL, "Cannot add node to NULL chain.");
+
+  if (index < 0) {
+    Locrect_Chain_Add(chain, locrect, tr, DL_HEAD);
+  } else {
+    Locrect_Chain_Iterator_Locate(chain, index);
+  
+    if (chain->iterator == NULL) {
+      Locrect_Chain_Add(chain, locrect, tr, DL_TAIL);
+    } else {
+      Locrect_Node *p = Make_Locrect_Node(locrect, tr);
+      Locrect_Node_Dlist_Insert(chain->iterator, p);
+    }
+  }
+}
+
+void Locrect_Chain_Remove_End(Locrect_Chain *chain, Dlist_End_e end)
+{
+  if (Locrect_Chain_Is_Empty(chain) == FALSE) {
+    chain->list = Locrect_Node_Dlist_Remove_End(chain->list, end);
+  }
+}
+
+void Locrect_Chain_Remove_Current(Locrect_Chain *chain)
+{
+  if (Locrect_Chain_Is_Empty(chain) == FALSE) {
+    if (chain->iterator != NULL) {
+      Locrect_Node_Dlist *next = chain->iterator->next;
+      chain->list = Locrect_Node_Dlist_Remove_Node(chain->iterator);
+      chain->iterator = next;
+    }
+  }
+}
+
+Locrect_Node* Locrect_Chain_Take_Current(Locrect_Chain *chain)
+{
+  if (Locrect_Chain_Is_Empty(chain)) {
+    return NULL;
+  }
+    
+  if (chain->iterator == NULL) {
+    return NULL;
+  }  
+
+  Locrect_Node *node = chain->iterator->data;
+  chain->iterator->data = NULL;
+  Locrect_Chain_Remove_Current(chain);
+
+  return node;
+}
+
+Locrect_Chain* Dir_Locrect_Chain_N(const char *dir_name, const char *pattern,
+				 int *n, int *file_num)
+{
+  *n = dir_fnum_p(dir_name, pattern);
+  if (*n == 0) {
+    return NULL;
+  }
+
+  Locrect_Chain *chain_array =
+    (Locrect_Chain*) Guarded_Malloc(sizeof(Locrect_Chain) * (*n), 
+				   "Dir_Neurochain");
+  
+  DIR *dir = opendir(dir_name);
+  struct dirent *ent = readdir(dir);
+  int index = 0;
+
+  /* allocate a string for storing full path. 100 is just an initial guess */
+  char *full_path = (char *) Guarded_Malloc(strlen(dir_name) + 100, 
+					    "Dir_Neurochain");
+  strcpy(full_path, dir_name);  
+  strcat(full_path, "/");
+	
+  regex_t preg;
+  regcomp(&preg, pattern, REG_BASIC);
+
+  while (ent != NULL) {
+    if (regexec(&preg, ent->d_name, 0, NULL, REG_BASIC) ==0) {
+      int path_length = strlen(dir_name) + strlen(ent->d_name) + 1;
+      if (path_length > strlen(full_path)) {
+	full_path = (char *) Guarded_Realloc(full_path, path_length + 1, 
+					     "Dir_Neurochain");
+      }
+      strcpy(full_path + strlen(dir_name) + 1, ent->d_name);
+#ifdef _DEBUG_2
+      printf("%d: %s\n", index, full_path);
+#endif
+      if (file_num != NULL) {
+	file_num[index] = String_Last_Integer(ent->d_name);
+      }
+
+      Locrect_Chain *chain = Read_Locrect_Chain(full_path);
+      chain_array[index++].list = chain->list;
+      Delete_Locrect_Chain(chain);
+    }
+    ent = readdir(dir);
+  }
+  free(full_path);
+  closedir(dir);
+
+  regfree(&preg);
+
+  return chain_array;
+}
+
+Locrect_Chain** Dir_Locrect_Chain_Nd(const char *dir_name, const char *pattern,
+			       int *n, int *file_num)
+{
+  *n = dir_fnum_p(dir_name, pattern);
+  if (*n == 0) {
+    return NULL;
+  }
+
+  Locrect_Chain **chain_array =
+    (Locrect_Chain**) Guarded_Malloc(sizeof(Locrect_Chain*) * (*n), 
+				   "Dir_Neurochain");
+  
+  DIR *dir = opendir(dir_name);
+  struct dirent *ent = readdir(dir);
+  int index = 0;
+
+  /* allocate a string for storing full path. 100 is just an initial guess */
+  char *full_path = (char *) Guarded_Malloc(strlen(dir_name) + 100, 
+					    "Dir_Neurochain");
+  strcpy(full_path, dir_name);  
+  strcat(full_path, "/");
+	
+  regex_t preg;
+  regcomp(&preg, pattern, REG_BASIC);
+
+  while (ent != NULL) {
+    if (regexec(&preg, ent->d_name, 0, NULL, REG_BASIC) ==0) {
+      int path_length = strlen(dir_name) + strlen(ent->d_name) + 1;
+      if (path_length > strlen(full_path)) {
+	full_path = (char *) Guarded_Realloc(full_path, path_length + 1, 
+					     "Dir_Neurochain");
+      }
+      strcpy(full_path + strlen(dir_name) + 1, ent->d_name);
+#ifdef _DEBUG_2
+      printf("%d: %s\n", index, full_path);
+#endif
+      if (file_num != NULL) {
+	file_num[index] = String_Last_Integer(ent->d_name);
+      }
+
+      chain_array[index++] = Read_Locrect_Chain(full_path);
+    }
+    ent = readdir(dir);
+  }
+  free(full_path);
+  closedir(dir);
+
+  regfree(&preg);
+
+  return chain_array;
+}
+
+/*
+void Neuron_Structure_Set_Locrect_Chain_Array(Neuron_Structure *ns,
+					   Locrect_Chain *chain_array)
+{
+  int ncomp = Neuron_Structure_Component_Number(ns);
+  int i;
+  int type = Locrect_Chain_Component_Type();
+  for (i = 0; i < ncomp; i++) {
+    Neuron_Component *nc = Neuron_Structure_Get_Component(ns, i);
+    Set_Neuron_Component(nc, type, chain_array + i);
+  }
+}
+*/
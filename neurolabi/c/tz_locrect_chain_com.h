@@ -0,0 +1,314 @@
+/**@file tz_locrect_chain_com.h
+ * @brief chain of Local_R2_Rect
+ * @author Ting Zhao
+ * @date 23-Oct-2008
+ */
+
+/* 1T Locseg 2T Local_Neuroseg */
+
+#ifndef _TZ_Locrect_CHAIN_COM_H_
+#define _TZ_Locrect_CHAIN_COM_H_
+
+#include "tz_trace_defs.h"
+#include "tz_locrect_node_doubly_linked_list.h"
+#include "tz_int_arraylist.h"
+#include "tz_neuron_structure.h"
+#include "tz_geo3d_circle.h"
+#include "tz_vrml_defs.h"
+#include "tz_stack_draw.h"
+
+__BEGIN_DECLS
+
+/**@addtogroup locrect_chain Locrect chain
+ *
+ * @{
+ */
+
+/* note for possible future revision: list should hold all the data */
+/**@struct _Locrect_Chain tz_locrect_chain.h
+ *
+ * @brief data structure of neuron chain
+ */
+typedef struct _Locrect_Chain {
+  Locrect_Node_Dlist *list;     /**< where the data are stored */
+  Locrect_Node_Dlist *iterator; /**< be careful about nesting.*/
+} Locrect_Chain;
+
+
+/**@addtogroup locrect_chain_obj general neurochain object routines
+ *
+ * @{
+ */
+Locrect_Chain* New_Locrect_Chain(void);
+Locrect_Chain* Free_Locrect_Chain(void);
+
+void Delete_Locrect_Chain(Locrect_Chain *chain);
+
+void Construct_Locrect_Chain(Locrect_Chain *chain, Locrect_Node *p);
+void Clean_Locrect_Chain(Locrect_Chain *chain);
+
+Locrect_Chain* Make_Locrect_Chain(Locrect_Node *p);
+void Kill_Locrect_Chain(Locrect_Chain *chain);
+
+/**@}
+ */
+
+/**@addtogroup locrect_chain_io_ I/O routines for locrect chain
+ *
+ * @{
+ */
+void Print_Locrect_Chain(Locrect_Chain *chain);
+void Write_Locrect_Chain(const char *file_path, Locrect_Chain *chain);
+Locrect_Chain* Read_Locrect_Chain(const char *file_path);
+
+/*@brief Load chain files under a directory
+ *
+ * Dir_Locrect_Chain_N() reads all files with a certain pattern under 
+ * \a dir_name. The pattern is specified by the regular expression \a pattern,
+ * i.e. any name that matches \a pattern in terms of regular expression will be
+ * read. The results are stored in the returned array, in which each element is
+ * a chain from a file. The number of chains is stored in \a n and the 
+ * corresponding file numbers is stored in \a file_num. Set \a file_num to NULL
+ * if you want to ignore it.
+ */
+Locrect_Chain* Dir_Locrect_Chain_N(const char *dir_name, const char *pattern,
+				 int *n, int *file_num);
+
+/*@brief Load chain files under a directory
+ *
+ * Dir_Locrect_Chain_Nd() is similar to Dir_Locrect_Chain_N, except that the return 
+ * value is a an array of chain pointers.
+ */
+Locrect_Chain** Dir_Locrect_Chain_Nd(const char *dir_name, const char *pattern,
+			       int *n, int *file_num);
+
+/**@}*/
+
+/**@addtogroup locrect_chain_attr_ Chain attributes
+ *
+ * @{
+ */
+
+/*
+ * Locrect_Chain_Length() return the number of nodes of <chain>.
+ */
+int Locrect_Chain_Length(Locrect_Chain *chain);
+double Locrect_Chain_Geolen(Locrect_Chain *chain);
+
+BOOL Locrect_Chain_Is_Empty(Locrect_Chain *chain);
+
+/**@}*/
+
+/**@addtogroup locrect_chain_trace_ Trace routines
+ * @{
+ */
+
+/**@brief Initialize a chain for tracing.
+ *
+ * Locrect_Chain_Trace_Init() retruns a chain for tracing. The starting point
+ * is <locrect>, which will be fit to <stack> after initialization. <fs> is used
+ * to store fitting score.
+ *
+ * Note: <locrect> will become a part of the returned chain.
+ */
+Locrect_Chain* Locrect_Chain_Trace_Init(const Stack *stack, double z_scale, 
+				  Local_R2_Rect *locrect, void *ws);
+
+/**@brief Test tracing status.
+ *
+ * Test if tracing should stop.
+ * Return code: See tz_trace_defs.h for more details.
+ */
+int Locrect_Chain_Trace_Test(void *argv[]);
+
+Trace_Workspace* 
+Locrect_Chain_Default_Trace_Workspace(Trace_Workspace *tw, 
+				   const Stack *stack);
+
+/*
+ * Trace neuron. 
+ * <tw->dyvar> has the following meaning:
+ *    tw->dyvar[0] : max radius
+ *    tw->dyvar[1] : min radius
+ */
+void Trace_Locrect(const Stack *stack, double z_scale, Locrect_Chain *chain, 
+		Trace_Workspace *tw);
+
+/*
+ * Locrect_Chain_Trace_Np() 
+ */
+void Locrect_Chain_Trace_Np(const Stack *stack, double z_scale, 
+			 Locrect_Chain *chain, Trace_Workspace *tw);
+
+/**@}*/
+
+/**@addtogroup locrect_chain_iter_ Traversing routines
+ * @{
+ */
+/**@brief Start the iterator.
+ *
+ * Locrect_Chain_Iterator_Locate() moves the iterator of <chain> to one of the end
+ * positions of <chain>. If <d> is DL_HEAD, it moves to the head. If <d> is 
+ * DL_TAIL, it moves to the tail. It returns the old iterator.
+ */
+Locrect_Node_Dlist* Locrect_Chain_Iterator_Start(Locrect_Chain *chain, 
+					       Dlist_End_e d);
+
+/**@brief Locate the iterator.
+ *
+ * Locrect_Chain_Iterator_Locate() moves the iterator of <chain> to the position
+ * <index>. It returns the old iterator.
+ */
+Locrect_Node_Dlist* Locrect_Chain_Iterator_Locate(Locrect_Chain *chain, 
+					    int index);
+/*
+ * Locrect_Chain_Next() makes the iterator forward by 1. It returns the node
+ * before forwarding.
+ */
+Locrect_Node* Locrect_Chain_Next(Locrect_Chain *chain);
+Locrect_Node* Locrect_Chain_Prev(Locrect_Chain *chain);
+Locrect_Node* Locrect_Chain_Next_D(Locrect_Chain *chain, Dlist_End_e d);
+
+Local_R2_Rect* Locrect_Chain_Next_Seg(Locrect_Chain *chain);
+Local_R2_Rect* Locrect_Chain_Prev_Seg(Locrect_Chain *chain);
+Local_R2_Rect* Locrect_Chain_Next_Seg_D(Locrect_Chain *chain, Dlist_End_e d);
+
+Locrect_Node* Locrect_Chain_Peek(const Locrect_Chain *chain);
+Local_R2_Rect* Locrect_Chain_Peek_Seg(const Locrect_Chain *chain);
+
+Locrect_Node* Locrect_Chain_Peek_Next(const Locrect_Chain *chain);
+Locrect_Node* Locrect_Chain_Peek_Prev(const Locrect_Chain *chain);
+
+
+BOOL Locrect_Chain_Has_More(const Locrect_Chain *chain);
+
+Locrect_Node* Locrect_Chain_Head(Locrect_Chain *chain);
+Locrect_Node* Locrect_Chain_Tail(Locrect_Chain *chain);
+
+Local_R2_Rect* Locrect_Chain_Head_Seg(Locrect_Chain *chain);
+Local_R2_Rect* Locrect_Chain_Tail_Seg(Locrect_Chain *chain);
+
+Locrect_Node* Locrect_Chain_Peek_At(Locrect_Chain *chain, int index);
+Local_R2_Rect* Locrect_Chain_Peek_Seg_At(Locrect_Chain *chain, int index);
+
+/**@}*/
+
+
+/**@addtogroup locrect_chain_opr_ Chain manipulation
+ * @{
+ */
+
+/*
+ * Locrect_Chain_Add() adds a node to the end of the chain.
+ * Locrect_Chain_Cat() appends <chain2> to <chain1>. Notice that the nodes in
+ * chain2 are appended in <chain1> by reference, so use Free_Locrect_Chain()
+ * only to free memory allocated to chain2.
+ */
+void Locrect_Chain_Add(Locrect_Chain *chain, Local_R2_Rect *locrect, 
+		      Trace_Record *tr, Dlist_End_e end);
+void Locrect_Chain_Add_Node(Locrect_Chain *chain, Locrect_Node *p, Dlist_End_e end);
+void Locrect_Chain_Cat(Locrect_Chain *chain1, const Locrect_Chain *chain2);
+
+void Locrect_Chain_Insert(Locrect_Chain *chain, Local_R2_Rect *locrect, 
+		       Trace_Record *tr, int index);
+
+/**@brief Remove current node.
+ *
+ * Locrect_Chain_Remove_Current() removes the node at the current position of the
+ * iterator of <chain>. The iterator is moved to the next node.
+ */
+void Locrect_Chain_Remove_Current(Locrect_Chain *chain);
+
+/**@brief Take current node.
+ *
+ * Locrect_Chain_Take_Current() removes the node at the current position of the
+ * iterator of <chain> and returns it. The iterator is moved to the next node.
+ */
+Locrect_Node* Locrect_Chain_Take_Current(Locrect_Chain *chain);
+
+void Locrect_Chain_Remove_End(Locrect_Chain *chain, Dlist_End_e end);
+int Locrect_Chain_Remove_Overlap_Ends(Locrect_Chain *chain);
+void Locrect_Chain_Remove_Turn_Ends(Locrect_Chain *chain, double max_angle);
+/**@}*/
+
+void Locrect_Chain_Label(Locrect_Chain *chain, Stack *stack, double z_scale);
+void Locrect_Chain_Erase(Locrect_Chain *chain, Stack *stack, double z_scale);
+
+void Locrect_Chain_Label_E(Stack *stack, Locrect_Chain *chain, double z_scale,
+			  int begin, int end, double ratio, double diff);
+void Locrect_Chain_Erase_E(Stack *stack, Locrect_Chain *chain, double z_scale,
+			  int begin, int end, double ratio, double diff);
+			
+void Locrect_Chain_Label_G(Locrect_Chain *chain, Stack *stack, double z_scale,
+			int begin, int end, double ratio, double diff, 
+			int flag, int value);
+
+void Set_Locrect_Trace_Record(Local_R2_Rect *locrect, const Trace_Record *tr);
+
+/**@brief Connection test for two locrect chains.
+ *
+ * Locrect_Chain_Connection_Test() tests if two chains are connected in \a stack.
+ * It returns TRUE if the two chains are connected. More information is stored 
+ * in \a conn, which specifies which mode is tested too. When the connection 
+ * mode is hook-loop mode (set \a conn->mode to NEUROCOMP_CONN_HL), it tests if 
+ * \a chain1 hooks to \a chain2. \a conn->info[0] stores the position of hook 
+ * of \a chain1 (0 for head and 1 for tail). \a conn->info[1] stores the 
+ * position of loop of \a chain2 and its value is the index of the hooked 
+ * segment in \a chain2. The strenth of connection is \a conn->strength. 
+ * \a ws is the workspace, which should be NULL in the current version.
+ */
+BOOL Locrect_Chain_Connection_Test(Locrect_Chain *chain1, Locrect_Chain *chain2,
+				const Stack *stack, double z_scale, 
+				Neurocomp_Conn *conn, 
+				Connection_Test_Workspace *ws);
+
+int Locrect_Chain_Hit_Test(Locrect_Chain *chain, Dlist_Direction_e d,
+			  double x, double y, double z);
+int Locrect_Chain_Hit_Test_Seg(Locrect_Chain *chain,
+			    const Local_R2_Rect *locrect);
+
+BOOL Locrect_Chain_Touched(Locrect_Chain *chain1, Locrect_Chain *chain2);
+
+Geo3d_Circle* Locrect_Chain_To_Geo3d_Circle_Array(Locrect_Chain *chain,
+						 Geo3d_Circle *circle, int *n);
+void Locrect_Chain_Vrml_Fprint(FILE *fp, Locrect_Chain *chain,
+			    const Vrml_Material *material, int indent);
+void Locrect_Chain_To_Vrml_File(Locrect_Chain *chain, const char *file_path);
+
+
+Graph* Locrect_Chain_Graph(Locrect_Chain *chain, int n, Int_Arraylist *hit_spots);
+
+void Neuron_Structure_Set_Locrect_Chain_Array(Neuron_Structure *ns,
+					   Locrect_Chain *chain_array);
+
+/**@brief Reconstruct neuron structure.
+ *
+ * Locrect_Chain_Neurostruct() reconstructs neuron structure from \a chain and
+ * returns the result. \a chain will be owned by \a Neuron_Structure.
+ */
+Neuron_Structure* Locrect_Chain_Neurostruct(Locrect_Chain *chain, int n, 
+					   const Stack *stack, double z_scale,
+					   void *ws);
+ 
+int Locrect_Chain_End_Points(Locrect_Chain *chain, int n, coordinate_3d_t pts[]);
+void Locrect_Chain_Hit_Stack(Locrect_Chain *chain, Stack *region, int hit[]);
+
+int Locrect_Chain_Swc_Fprint(FILE *fp, Locrect_Chain *chain, int type,
+  		          int start_id,
+			  int parent_id, Dlist_Direction_e direction);
+
+/*
+ * Locrect_Chain_Reach_Conn() changes one of the ends of \a chain1 so that it
+ * can touch \a chain2. How it reaches \a chain2 is defined in \a conn.
+ */
+void Locrect_Chain_Reach_Conn(Locrect_Chain *hook, Locrect_Chain *loop,
+			     const Neurocomp_Conn *conn);
+
+void Locrect_Chain_Draw_Stack(Locrect_Chain *chain, Stack *stack, 
+			   const Stack_Draw_Workspace *ws);
+
+/**@}*/
+
+__END_DECLS
+
+#endif
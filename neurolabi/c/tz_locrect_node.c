@@ -0,0 +1,291 @@
+/* tz_locrect_node.c
+ *
+ * 11-Aug-2008 Initial write: Ting Zhao
+ */
+
+#include <stdlib.h>
+#include "tz_utilities.h"
+#include "tz_error.h"
+#include "tz_trace_utils.h"
+#include "tz_locrect_node.h"
+#include "string.h"
+
+Locrect_Node* New_Locrect_Node()
+{
+  Locrect_Node *p = (Locrect_Node*) 
+    Guarded_Malloc(sizeof(Locrect_Node), "New_Locrect_Node");
+  
+  p->locseg = NULL;
+  p->tr = NULL;
+
+  return p;
+}
+
+void Delete_Locrect_Node(Locrect_Node *p)
+{
+  if (p != NULL) {
+    free(p);
+  }
+}
+
+void Clean_Locrect_Node(Locrect_Node *p)
+{
+  if (p != NULL) {
+    Delete_Local_R2_Rect(p->locseg);
+    p->locseg = NULL;
+    free(p->tr);
+    p->tr = NULL;
+  }
+}
+
+Locrect_Node* Make_Locrect_Node(const Local_R2_Rect *locseg,
+			      const Trace_Record *tr)
+{
+  Locrect_Node *p = New_Locrect_Node();
+  p->locseg = (Local_R2_Rect *) locseg;
+  p->tr = (Trace_Record *) tr;
+
+  return p;
+}
+
+void Kill_Locrect_Node(Locrect_Node *p)
+{
+  Clean_Locrect_Node(p);
+  Delete_Locrect_Node(p);
+}
+
+Locrect_Node* Copy_Locrect_Node(const Locrect_Node *p)
+{
+  return Make_Locrect_Node(Copy_Local_R2_Rect(p->locseg),
+			Copy_Trace_Record(p->tr));
+}
+
+BOOL Locrect_Node_Is_Identical(const Locrect_Node *p1, const Locrect_Node *p2)
+{
+  if (p1 == p2) {
+    return TRUE;
+  }
+
+  if ((p1 == NULL) || (p2 == NULL)) {
+    return FALSE;
+  }
+
+  if (p1->tr != p2->tr) {
+    if ((p1->tr == NULL) || (p2->tr == NULL)) {
+      return FALSE;
+    }
+    
+    if (memcmp(p1->tr, p2->tr, sizeof(Trace_Record)) != 0) {
+      return FALSE;
+    }
+  }
+
+  if (p1->locseg != p2->locseg) {
+    if ((p1->locseg == NULL) || (p2->locseg == NULL)) {
+      return FALSE;
+    }
+
+    if (memcmp(p1->locseg, p2->locseg, sizeof(Local_R2_Rect)) != 0) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+void Print_Locrect_Node(const Locrect_Node *p)
+{
+  Print_Local_R2_Rect(p->locseg);
+  Print_Trace_Record(p->tr);
+}
+
+void Print_Locrect_Node_Info(const Locrect_Node *p)
+{
+  Print_Local_R2_Rect(p->locseg);
+}
+
+void Locrect_Node_Fwrite(const Locrect_Node *p, FILE *stream)
+{
+  ASSERT(p != NULL, "Null Locrect_Node");
+  ASSERT(stream != NULL, "Invalid file pointer");
+  
+  Local_R2_Rect_Fwrite(p->locseg, stream);
+  Trace_Record_Fwrite(p->tr, stream);
+}
+
+void Locrect_Node_Fwrite_V(const Locrect_Node *p, FILE *stream, double version)
+{
+  ASSERT(p != NULL, "Null Locrect_Node");
+  ASSERT(stream != NULL, "Invalid file pointer");
+  
+  Local_R2_Rect_Fwrite(p->locseg, stream);
+  Trace_Record_Fwrite_V(p->tr, stream, version);
+}
+
+Locrect_Node* Locrect_Node_Fread(Locrect_Node *p, FILE *stream)
+{
+  ASSERT(stream != NULL, "Invalid file pointer");
+  
+  if (feof(stream)) {
+    return NULL;
+  }
+  
+  BOOL is_local_alloc = FALSE;
+
+  if (p == NULL) {
+    p = New_Locrect_Node();
+    is_local_alloc = TRUE;
+  }
+  
+  if ((p->locseg = Local_R2_Rect_Fread(p->locseg, stream)) == NULL) {
+    if (is_local_alloc == TRUE) {
+      Delete_Locrect_Node(p);
+    }
+    p = NULL;
+  } else {
+    if ((p->tr = Trace_Record_Fread(p->tr, stream)) == NULL) {
+      if (feof(stream)) {
+	if (is_local_alloc == TRUE) {
+	  Delete_Locrect_Node(p);
+	}
+	p = NULL;
+      }
+    }
+  }
+
+  return p;
+}
+
+Locrect_Node* Locrect_Node_Fread_V(Locrect_Node *p, FILE *stream, double version)
+{
+  ASSERT(stream != NULL, "Invalid file pointer");
+  
+  if (feof(stream)) {
+    return NULL;
+  }
+  
+  BOOL is_local_alloc = FALSE;
+
+  if (p == NULL) {
+    p = New_Locrect_Node();
+    is_local_alloc = TRUE;
+  }
+  
+  if ((p->locseg = Local_R2_Rect_Fread(p->locseg, stream)) == NULL) {
+    if (is_local_alloc == TRUE) {
+      Delete_Locrect_Node(p);
+    }
+    p = NULL;
+  } else {
+    if ((p->tr = Trace_Record_Fread_V(p->tr, stream, version)) == NULL) {
+      if (feof(stream)) {
+	if (is_local_alloc == TRUE) {
+	  Delete_Locrect_Node(p);
+	}
+	p = NULL;
+      }
+    }
+  }
+
+  return p;
+}
+
+void Locrect_Node_Copy_Trace_Record(Locrect_Node *p, const Trace_Record *tr)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Copy(p->tr, tr);
+}
+
+void Locrect_Node_Set_Score(Locrect_Node *p, const Stack_Fit_Score *fs)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Set_Score(p->tr, fs);
+}
+
+void Locrect_Node_Set_Hit_Region(Locrect_Node *p, int hit_region)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Set_Hit_Region(p->tr, hit_region);
+}
+
+void Locrect_Node_Set_Index(Locrect_Node *p, int index)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Set_Index(p->tr, index);
+}
+
+void Locrect_Node_Set_Refit(Locrect_Node *p, BOOL is_refit)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Set_Refit(p->tr, is_refit);
+}
+
+void Locrect_Node_Set_Direction(Locrect_Node *p, Dlist_Direction_e direction)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Set_Direction(p->tr, direction);
+}
+
+void Locrect_Node_Set_Fit_Height(Locrect_Node *p, int index, int value)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Set_Fit_Height(p->tr, index, value);
+}
+
+void Locrect_Node_Set_Fix_Point(Locrect_Node *p, double value)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Set_Fix_Point(p->tr, value);
+}
+
+double Locrect_Node_Fix_Point(Locrect_Node *p)
+{
+  double t = Trace_Record_Fix_Point(p->tr);
+  if ((t < 0.0) || (t > 1.0)){
+    switch (Trace_Record_Direction(p->tr)) {
+    case DL_FORWARD:
+      t = 0.0;
+      break;
+    case DL_BACKWARD:
+      t = 1.0;
+      break;
+    case DL_BOTHDIR:
+      t = -1.0;
+      break;
+    default:
+      t = 0.0;
+    }
+  }
+
+  return t;
+}
+
+BOOL Locrect_Node_Fix_Pos(Locrect_Node *p, double *pos)
+{
+
+   return FALSE;
+}
@@ -0,0 +1,451 @@
+/* tz_linked_list_c.t
+ *
+ * 27-Nov-2007 Initial write: Ting Zhao
+ */
+
+#include <stdlib.h>
+#include "tz_error.h"
+#include "utilities.h"
+#include "tz_locrect_node_doubly_linked_list.h"
+
+INIT_EXCEPTION
+
+#undef _DEBUG_
+
+/* Locrect_Node_Dlist_New(): New a Locrect_Node list.
+ *
+ * Return: A Locrect_Node list with length 1.
+ */
+Locrect_Node_Dlist* Locrect_Node_Dlist_New()
+{
+  Locrect_Node_Dlist *new_list = (Locrect_Node_Dlist *) Guarded_Malloc(sizeof(Locrect_Node_Dlist), 
+						     "Locrect_Node_Dlist_New");
+  
+  new_list->data = 0x0;
+  
+  new_list->next = NULL;
+  new_list->prev = NULL;
+
+  return new_list;
+}
+
+void Locrect_Node_Dlist_Remove_All(Locrect_Node_Dlist *p)
+{
+  Locrect_Node_Dlist *head = Locrect_Node_Dlist_Head(p);
+  while (head != NULL) {
+    p = head;
+    
+    if (p->data != NULL) {
+      Kill_Locrect_Node(p->data);
+    }
+    
+	
+    
+
+    head = head->next;
+#ifdef _DEBUG_
+    printf("%p freed\n", p);
+#endif
+    free(p);
+  }
+}
+
+void Locrect_Node_Dlist_Set_Data(Locrect_Node_Dlist *p, Locrect_Node_P data)
+{
+  p->data = data;
+}
+
+Locrect_Node_Dlist *Locrect_Node_Dlist_Head(const Locrect_Node_Dlist *p)
+{
+  if (p == NULL) {
+    return NULL;
+  }
+
+  while (p->prev != NULL) {
+    p = p->prev;
+  }
+
+  return (Locrect_Node_Dlist *) p;
+}
+
+Locrect_Node_Dlist *Locrect_Node_Dlist_Tail(const Locrect_Node_Dlist *p)
+{
+  if (p == NULL) {
+    return NULL;
+  }
+
+  while (p->next != NULL) {
+    p = p->next;
+  }
+
+  return (Locrect_Node_Dlist *) p;
+}
+
+Locrect_Node_Dlist* Locrect_Node_Dlist_Next(const Locrect_Node_Dlist *p, Dlist_Direction_e d)
+{
+  if (p != NULL) {
+    if (d == DL_FORWARD) {
+      return p->next;
+    } else if (d == DL_BACKWARD) {
+      return p->prev;
+    } else {
+      TZ_WARN(ERROR_DATA_VALUE);
+      return NULL;
+    }
+  }
+
+  return NULL;
+}
+
+int Locrect_Node_Dlist_Length(const Locrect_Node_Dlist *p, Dlist_Direction_e d)
+{
+  if (p == NULL) {
+    return 0;
+  }
+
+  int length = 0;
+
+  switch (d) {
+  case DL_FORWARD:
+    for(; p != NULL; p = p->next) {
+      length++;
+    }
+    break;
+  case DL_BACKWARD:
+    for(; p != NULL; p = p->prev) {
+      length++;
+    }
+    break;
+  case DL_BOTHDIR:
+    length = Locrect_Node_Dlist_Length(p, DL_BACKWARD) + 
+      Locrect_Node_Dlist_Length(p->next, DL_FORWARD);
+    break;
+  default:
+    TZ_WARN(ERROR_DATA_VALUE);
+    length = -1;
+  }
+
+  return length;  
+}
+
+Locrect_Node_Dlist* Locate_Locrect_Node_Dlist(const Locrect_Node_Dlist *p, int n)
+{
+  if (p == NULL) {
+    return NULL;
+  }
+
+  int i;
+  
+  if (n > 0) {
+    for (i = 0; i < n; i++) {
+      p = p->next;
+      if (p == NULL) {
+	return NULL;
+      }
+    }
+  } else if (n < 0){ /* going back */
+    for (i = 0; i < -n;  i++) {
+      p = p->prev;
+      if (p == NULL) {
+	return NULL;
+      }
+    }
+  }
+
+  return (Locrect_Node_Dlist *)  p;
+}
+
+Locrect_Node_Dlist* Append_Locrect_Node_Dlist(Locrect_Node_Dlist *p1, Locrect_Node_Dlist *p2)
+{
+  if (p1 == NULL) {
+    return p2;
+  }
+
+  if (p2 == NULL) {
+    return p1;
+  }
+
+  Locrect_Node_Dlist *head = Locrect_Node_Dlist_Head(p1);
+
+  p1 = Locrect_Node_Dlist_Tail(p1);
+  p2 = Locrect_Node_Dlist_Head(p2);
+
+  p1->next = p2;
+  p2->prev = p1;
+
+  return head;
+}
+
+
+Locrect_Node_Dlist* Locrect_Node_Dlist_Remove_End(Locrect_Node_Dlist *p, Dlist_End_e e)
+{
+  ASSERT(p != NULL, "null pointer");
+
+  Locrect_Node_Dlist *end;
+
+  switch (e) {
+  case DL_HEAD:
+    end = Locrect_Node_Dlist_Head(p);
+    p = end->next;
+    if (p != NULL) {
+      p->prev = NULL;
+    }
+    end->next = NULL;
+    Locrect_Node_Dlist_Remove_All(end);
+    break;
+  case DL_TAIL:
+    end = Locrect_Node_Dlist_Tail(p);
+    p = end->prev;
+    if (p != NULL) {
+      p->next = NULL;
+    }
+    end->prev = NULL;
+    Locrect_Node_Dlist_Remove_All(end);
+    break;
+  default:
+    TZ_WARN(ERROR_DATA_TYPE);
+    return NULL;
+  }
+
+  return p;
+}
+
+
+Locrect_Node_Dlist* Locrect_Node_Dlist_Remove_Node(Locrect_Node_Dlist *p)
+{
+  if (p == NULL) {
+    return NULL;
+  }
+
+  Locrect_Node_Dlist *head = Locrect_Node_Dlist_Head(p);
+  Locrect_Node_Dlist *prev = p->prev;
+
+  if (prev == NULL) {
+    head = p->next;
+  } else {
+    prev->next = p->next;
+    p->prev = NULL;
+  }
+
+  if (p->next != NULL) {
+    p->next->prev = prev;
+    p->next = NULL;
+  }
+
+  Locrect_Node_Dlist_Remove_All(p);
+
+  return head;
+}
+
+/* Locrect_Node_Dlist_Add(): Add a node to the beginning of the list.
+ * 
+ * Args: p - pointer to the list;
+ *       data - data node.
+ *
+ * Return: the old head.
+ * 
+ * Note: <data> (not its copy) will be added to the list, so be careful about
+ *       freeing the object.
+ */
+Locrect_Node_Dlist* Locrect_Node_Dlist_Add(Locrect_Node_Dlist *p, Locrect_Node_P data, Dlist_End_e e)
+{
+  Locrect_Node_Dlist *new_node = Locrect_Node_Dlist_New();
+  Locrect_Node_Dlist_Set_Data(new_node, data);
+
+  if (p == NULL) {
+#ifdef _DEBUG_2
+    printf("%p->%p added\n", new_node, data);
+#endif    
+    return new_node;
+  }
+  
+  switch (e) {
+  case DL_HEAD:
+    p = Locrect_Node_Dlist_Head(p);
+    new_node->next = p;
+    p->prev = new_node;
+    p = new_node;
+    break;
+  case DL_TAIL:
+    p = Locrect_Node_Dlist_Tail(p);
+    new_node->prev = p;
+    p->next = new_node;
+#ifdef _DEBUG_2
+    printf("%p->%p added\n", new_node, data);
+#endif
+    p = new_node;
+    break;
+  default:
+    TZ_WARN(ERROR_DATA_VALUE);
+    Locrect_Node_Dlist_Remove_All(new_node);
+  }
+      
+  return p;
+}
+
+void Locrect_Node_Dlist_Insert(Locrect_Node_Dlist *p, Locrect_Node_P data)
+{
+  if (p == NULL) {
+    return;
+  }
+
+  Locrect_Node_Dlist *new_node = Locrect_Node_Dlist_New();
+  Locrect_Node_Dlist_Set_Data(new_node, data);
+  
+  Locrect_Node_Dlist *prev = p->prev;
+  p->prev = new_node;
+  new_node->next = p;
+  new_node->prev = prev;
+  if (prev != NULL) {
+    prev->next = new_node;
+  }
+}
+
+/* Locrect_Node_Dlist_Unlink(): Unlink the head of a list.
+ *
+ * Args: p - input list, which will be changed.
+ *
+ * Return: the unlinked data.
+ */
+Locrect_Node_P Locrect_Node_Dlist_Unlink(Locrect_Node_Dlist **p)
+{
+  if (*p != NULL) {
+    Locrect_Node_Dlist *tmp_head = *p;
+    *p = tmp_head->next;
+
+    Locrect_Node_P data = tmp_head->data;
+    free(tmp_head);
+    
+    return data;
+  }
+
+  
+  return NULL;
+  
+  
+}
+
+BOOL Locrect_Node_Dlist_Is_Empty(const Locrect_Node_Dlist *p)
+{
+  if (p == NULL) {
+    return TRUE;
+  } else {
+    return FALSE;
+  }
+}
+
+/* Locrect_Node_Dlist_To_Array(): Turn a list to an array.
+ *
+ * Args: p - input list;
+ *       array - returned array. If it is NULL, a new array will be created,
+ *               otherwise it must be large enough to hold the result.
+ *       step - The offset between an element and its right neighbor. If it is
+ *              negative, the array has a reversed order.
+ * Return: the resulted array.
+ *
+ * Note: The caller is responsible for freeing the returned array.
+ */
+Locrect_Node_P* Locrect_Node_Dlist_To_Array(const Locrect_Node_Dlist *p, int step, Locrect_Node_P *array, int *length)
+{
+  if (step == 0) {
+    THROW(ERROR_DATA_VALUE);
+  }
+
+  int n = Locrect_Node_Dlist_Length(p, DL_FORWARD);
+  int array_length = (n - 1) * abs(step) + 1;
+
+  if (array == NULL) {
+    array = (Locrect_Node_P *) Guarded_Malloc(sizeof(Locrect_Node_P) * array_length, 
+				    "Locrect_Node_Dlist_To_Array");
+  }
+
+  int begin;
+  int end;
+  
+  if (step > 0) {
+    begin = 0;
+    end = array_length - 1;
+  } else {
+    begin = array_length - 1;
+    end = 0;
+  }
+  
+  int i;
+  for (i = begin; p != NULL; i += step, p = p->next) {
+    array[i] = p->data;
+  }
+
+  if (length != NULL) {
+    *length = array_length;
+  }
+
+  return array;
+}
+
+/* Print_Locrect_Node_Dlist(): Print Locrect_Node list.
+ *
+ * Args: p - list to print.
+ *
+ * Return: void.
+ *
+ * Note: This function works only when Print_Locrect_Node is available.
+ */
+void Print_Locrect_Node_Dlist(const Locrect_Node_Dlist *p)
+{
+  if (p == NULL) {
+    printf("Null list.\n");
+    return;
+  }
+
+  printf("Total length: %d\n", Locrect_Node_Dlist_Length(p, DL_BOTHDIR));
+
+  
+  while (p != NULL) {
+    Print_Locrect_Node(p->data);
+    p = p->next;
+  }
+  
+
+}
+
+/* Print_Locrect_Node_Dlist_Compact(): Print Locrect_Node list briefly.
+ *
+ * Args: p - list to print.
+ *
+ * Return: void.
+ *
+ * Note: This function works only when Print_Locrect_Node_Info is available.
+ */
+void Print_Locrect_Node_Dlist_Compact(const Locrect_Node_Dlist *p)
+{
+  if (p == NULL) {
+    printf("Null list.\n");
+    return;
+  }
+
+  
+  int i = 1;
+  while (p != NULL) {
+    printf("Item %d: ", i);
+    Print_Locrect_Node_Info(p->data);
+    i++;
+    p = p->next;
+  }
+  
+}
+
+void Print_Locrect_Node_Dlist_F(const Locrect_Node_Dlist *p, const char *format)
+{
+  if (p == NULL) {
+    printf("Null list.\n");
+    return;
+  }
+
+  printf("Total length: %d\n", Locrect_Node_Dlist_Length(p, DL_FORWARD));
+  while (p != NULL) {
+    printf(format, p->data);
+    printf(" ");
+    p = p->next;
+  }
+  printf("\n");
+}
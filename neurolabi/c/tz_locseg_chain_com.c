@@ -0,0 +1,639 @@
+/* tz_locseg_chain.c
+ *
+ * 06-May-2008 Initial write: Ting Zhao
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+#if defined(_WIN32) || defined(_WIN64)
+  #define PCRE_STATIC
+  #include <pcre2posix.h>
+#else
+  #include <regex.h>
+#endif
+#include <string.h>
+#ifndef _MSC_VER
+#include <dirent.h>
+#else
+#include "tz_dirent.h"
+#endif
+#include "tz_utilities.h"
+#include "tz_constant.h"
+#include "tz_error.h"
+#include "tz_interface.h"
+#include "tz_stack_sampling.h"
+#include "tz_trace_utils.h"
+#include "tz_darray.h"
+#include "tz_cont_fun.h"
+#include "tz_locseg_chain_com.h"
+#include "tz_vrml_material.h"
+#include "tz_vrml_io.h"
+#include "tz_geo3d_utils.h"
+#include "tz_string.h"
+#include "tz_geo3d_point_array.h"
+#include "tz_stack_graph.h"
+#include "tz_image_array.h"
+#include "tz_swc_cell.h"
+#include "tz_u8array.h"
+
+
+Locseg_Chain* New_Locseg_Chain(void)
+{
+  Locseg_Chain *chain = 
+    (Locseg_Chain *) Guarded_Malloc(sizeof(Locseg_Chain), "New_Locseg_Chain");
+
+  chain->list = NULL;
+  chain->iterator = NULL;
+
+  return chain;
+}
+
+void Delete_Locseg_Chain(Locseg_Chain *chain)
+{
+  if (chain != NULL) {
+    free(chain);
+  }
+}
+
+void Construct_Locseg_Chain(Locseg_Chain *chain, Locseg_Node *p)
+{
+  chain->list = Locseg_Node_Dlist_New();
+  Locseg_Node_Dlist_Set_Data(chain->list, p);
+}
+
+void Clean_Locseg_Chain(Locseg_Chain *chain)
+{
+  if (chain != NULL) {
+    Locseg_Node_Dlist_Remove_All(chain->list);
+    chain->list = NULL;
+    chain->iterator = NULL;
+  }
+}
+
+Locseg_Chain* Make_Locseg_Chain(Locseg_Node *p)
+{
+  Locseg_Chain *chain = New_Locseg_Chain();
+  Construct_Locseg_Chain(chain, p);
+
+  return chain;
+}
+
+void Kill_Locseg_Chain(Locseg_Chain *chain)
+{
+  Clean_Locseg_Chain(chain);
+  Delete_Locseg_Chain(chain);
+}
+
+int Locseg_Chain_Length(Locseg_Chain *chain)
+{
+  if (chain == NULL) {
+    return 0;
+  }
+
+  return Locseg_Node_Dlist_Length(chain->list, DL_BOTHDIR);
+}
+
+BOOL Locseg_Chain_Is_Empty(Locseg_Chain *chain)
+{
+  if (chain == NULL) {
+    return TRUE;
+  }
+
+  if (chain->list == NULL) {
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
+Locseg_Node_Dlist* Locseg_Chain_Iterator_Start(Locseg_Chain *chain, 
+					       Dlist_End_e d)
+{
+  Locseg_Node_Dlist *old_iter = chain->iterator;
+
+  switch (d) {
+  case DL_HEAD:
+    chain->iterator = Locseg_Node_Dlist_Head(chain->list);
+    break;
+  case DL_TAIL:
+    chain->iterator = Locseg_Node_Dlist_Tail(chain->list);
+    break;
+  default:
+    TZ_ERROR(ERROR_DATA_VALUE);
+    break;
+  }
+
+  return old_iter;
+}
+
+Locseg_Node_Dlist* Locseg_Chain_Iterator_Locate(Locseg_Chain *chain, int index)
+{
+  Locseg_Node_Dlist *old_iter = NULL;
+  
+  if (index >= 0) {
+    old_iter = Locseg_Chain_Iterator_Start(chain, DL_HEAD);
+  } else {
+    old_iter = Locseg_Chain_Iterator_Start(chain, DL_TAIL);
+  }
+
+  chain->iterator = Locate_Locseg_Node_Dlist(chain->iterator, index);
+  
+  return old_iter;
+}
+
+Locseg_Node* Locseg_Chain_Next(Locseg_Chain *chain)
+{
+  if (chain == NULL) {
+    return NULL;
+  }
+
+  if ((chain->list == NULL) || (chain->iterator == NULL)) {
+    return NULL;
+  }
+
+  Locseg_Node *p = chain->iterator->data;
+
+  chain->iterator = chain->iterator->next;
+
+  return p;
+}
+
+Locseg_Node* Locseg_Chain_Prev(Locseg_Chain *chain)
+{
+  if (chain == NULL) {
+    return NULL;
+  }
+
+  if ((chain->list == NULL) || (chain->iterator == NULL)) {
+    return NULL;
+  }
+
+  Locseg_Node *p = chain->iterator->data;
+
+  chain->iterator = chain->iterator->prev;
+
+  return p;
+}
+
+Locseg_Node* Locseg_Chain_Next_D(Locseg_Chain *chain, Dlist_End_e d)
+{
+  if (d == DL_HEAD) {
+    return Locseg_Chain_Next(chain);
+  }
+
+  if (d == DL_TAIL) {
+    return Locseg_Chain_Prev(chain);
+  }
+
+  return NULL;
+}
+
+Locseg_Node* Locseg_Chain_Peek(const Locseg_Chain *chain)
+{
+  if (chain == NULL) {
+    return NULL;
+  }
+
+  if ((chain->list == NULL) || (chain->iterator == NULL)) {
+    return NULL;
+  }
+
+  return chain->iterator->data;
+}
+
+Local_Neuroseg* Locseg_Chain_Peek_Seg(const Locseg_Chain *chain)
+{
+  Locseg_Node *p = Locseg_Chain_Peek(chain);
+  if (p == NULL) {
+    return NULL;
+  }
+
+  return p->locseg;
+}
+
+Locseg_Node* Locseg_Chain_Peek_Next(const Locseg_Chain *chain)
+{
+  if (chain == NULL) {
+    return NULL;
+  }
+
+  if (chain->iterator == NULL) {
+    return NULL;
+  }
+
+  if (chain->iterator->next == NULL) {
+    return NULL;
+  }
+
+  return chain->iterator->next->data;
+}
+
+Locseg_Node* Locseg_Chain_Peek_Prev(const Locseg_Chain *chain)
+{
+  if (chain == NULL) {
+    return NULL;
+  }
+
+  if (chain->iterator == NULL) {
+    return NULL;
+  }
+
+  if (chain->iterator->prev == NULL) {
+    return NULL;
+  }
+
+  return chain->iterator->prev->data;  
+}
+
+Local_Neuroseg* Locseg_Chain_Next_Seg(Locseg_Chain *chain)
+{
+  Locseg_Node *p = Locseg_Chain_Next(chain);
+  if (p == NULL) {
+    return NULL;
+  } else {
+    return p->locseg;
+  }
+}
+
+Local_Neuroseg* Locseg_Chain_Prev_Seg(Locseg_Chain *chain)
+{
+  Locseg_Node *p = Locseg_Chain_Prev(chain);
+  if (p == NULL) {
+    return NULL;
+  } else {
+    return p->locseg;
+  }
+}
+
+Local_Neuroseg* Locseg_Chain_Next_Seg_D(Locseg_Chain *chain, Dlist_End_e d)
+{
+  if (d == DL_HEAD) {
+    return Locseg_Chain_Next_Seg(chain);
+  }
+
+  if (d == DL_TAIL) {
+    return Locseg_Chain_Prev_Seg(chain);
+  }
+
+  return NULL;
+}
+
+void Print_Locseg_Chain(Locseg_Chain *chain)
+{
+  Locseg_Node_Dlist* old_iter = Locseg_Chain_Iterator_Start(chain, DL_HEAD);
+  Locseg_Node *p = NULL;
+  int n = 0;
+  while ((p = Locseg_Chain_Next(chain)) != NULL) {
+    Print_Locseg_Node(p);
+    n++;
+  }
+
+  printf("Total length: %d\n", n);
+
+  chain->iterator = old_iter;
+}
+
+void Write_Locseg_Chain(const char *file_path, Locseg_Chain *chain)
+{
+  FILE *fp = Guarded_Fopen((char*) file_path, "wb", "Write_Locseg_Chain");
+  
+  Locseg_Node_Dlist *old_iter = Locseg_Chain_Iterator_Start(chain, DL_HEAD);
+  Locseg_Node *p = NULL;
+  
+  double version = CHAIN_VERSION;
+  if (version > 0.0) {
+    double start = -version;
+    fwrite(&start, sizeof(double), 1, fp);
+  }
+
+  while ((p = Locseg_Chain_Next(chain)) != NULL) {
+    Locseg_Node_Fwrite_V(p, fp, version);
+  }
+  
+  fclose(fp);
+
+  chain->iterator = old_iter;
+}
+
+Locseg_Chain* Read_Locseg_Chain(const char *file_path)
+{
+  //FILE *fp = Guarded_Fopen((char*) file_path, "r", "Read_Locseg_Chain");
+  FILE *fp = NULL;
+  if ((fp = fopen(file_path, "rb")) == NULL) {
+    return NULL;
+  }
+  
+  Locseg_Chain *chain = New_Locseg_Chain();
+  Locseg_Node *node = NULL;
+
+  double start;
+  double version = 0;
+  fread(&start, sizeof(double), 1, fp);
+  if (start >= 0) {
+    fseek(fp, 0, SEEK_SET);
+  } else {
+    version = -start;
+  }
+
+  while ((node = Locseg_Node_Fread_V(NULL, fp, version)) != NULL) {
+    Locseg_Chain_Add_Node(chain, node, DL_TAIL);
+  }
+
+  fclose(fp);
+
+  return chain;
+}
+
+Locseg_Node* Locseg_Chain_Head(Locseg_Chain *chain)
+{
+  if (chain == NULL) {
+    return NULL;
+  }
+
+  if (chain->list == NULL) {
+    return NULL;
+  }
+
+  Locseg_Node_Dlist *tail = Locseg_Node_Dlist_Head(chain->list);
+
+  return tail->data;
+}
+
+Locseg_Node* Locseg_Chain_Tail(Locseg_Chain *chain)
+{
+  if (chain == NULL) {
+    return NULL;
+  }
+
+  if (chain->list == NULL) {
+    return NULL;
+  }
+
+  Locseg_Node_Dlist *tail = Locseg_Node_Dlist_Tail(chain->list);
+
+  return tail->data;
+}
+
+Local_Neuroseg* Locseg_Chain_Head_Seg(Locseg_Chain *chain)
+{
+  Locseg_Node *p = Locseg_Chain_Head(chain);
+  if (p == NULL) {
+    return NULL;
+  } else {
+    return p->locseg;
+  }
+}
+
+Local_Neuroseg* Locseg_Chain_Tail_Seg(Locseg_Chain *chain)
+{
+  Locseg_Node *p = Locseg_Chain_Tail(chain);
+  if (p == NULL) {
+    return NULL;
+  } else {
+    return p->locseg;
+  }
+}
+
+Locseg_Node* Locseg_Chain_Peek_At(Locseg_Chain *chain, int index)
+{
+  Locseg_Node_Dlist *old_iter = Locseg_Chain_Iterator_Locate(chain, index);
+  Locseg_Node *node = Locseg_Chain_Peek(chain);
+
+  chain->iterator = old_iter;
+  
+  return node;
+}
+
+Local_Neuroseg* Locseg_Chain_Peek_Seg_At(Locseg_Chain *chain, int index)
+{
+  Locseg_Node_Dlist *old_iter = Locseg_Chain_Iterator_Locate(chain, index);
+  Local_Neuroseg *locseg = Locseg_Chain_Peek_Seg(chain);
+  chain->iterator = old_iter;
+  
+  return locseg;
+}
+
+void Locseg_Chain_Add(Locseg_Chain *chain, Local_Neuroseg *locseg, 
+		      Trace_Record *tr, Dlist_End_e end)
+{
+  TZ_ASSERT(chain != NULL, "Cannot add node to NULL chain.");
+
+  Locseg_Node *p = Make_Locseg_Node(locseg, tr);
+
+  if (chain->list == NULL) {
+    chain->list = Locseg_Node_Dlist_New();
+    Locseg_Node_Dlist_Set_Data(chain->list, p);
+  } else {
+    chain->list = Locseg_Node_Dlist_Add(chain->list, p, end);
+  }
+}
+
+void Locseg_Chain_Add_Node(Locseg_Chain *chain, Locseg_Node *p, Dlist_End_e end)
+{
+  TZ_ASSERT(chain != NULL, "Cannot add node to NULL chain.");
+  if (chain->list == NULL) {
+    chain->list = Locseg_Node_Dlist_New();
+    Locseg_Node_Dlist_Set_Data(chain->list, p);
+  } else {
+    if (end == DL_HEAD) {
+      chain->list = Locseg_Node_Dlist_Add(chain->list, p, end);
+    } else {
+      Locseg_Node_Dlist_Add(chain->list, p, end);
+    }
+  }
+}
+
+void Locseg_Chain_Cat(Locseg_Chain *chain1, const Locseg_Chain *chain2)
+{
+  if (chain2 == NULL) {
+    return;
+  }
+
+  Locseg_Node_Dlist *head = Locseg_Node_Dlist_Head(chain2->list);
+  if (head == NULL) {
+    return;
+  }
+
+  if (chain1->list == NULL) {
+    chain1->list = head;
+  } else {
+    Locseg_Node_Dlist *tail = Locseg_Node_Dlist_Tail(chain1->list);
+    tail->next = head;
+    head->prev = tail;
+  }
+}
+
+void Locseg_Chain_Insert(Locseg_Chain *chain, Local_Neuroseg *locseg, 
+		       Trace_Record *tr, int index)
+{
+  ASSERT(chain != NULL, "Cannot add node to NULL chain.");
+
+  if (index < 0) {
+    Locseg_Chain_Add(chain, locseg, tr, DL_HEAD);
+  } else {
+    Locseg_Chain_Iterator_Locate(chain, index);
+  
+    if (chain->iterator == NULL) {
+      Locseg_Chain_Add(chain, locseg, tr, DL_TAIL);
+    } else {
+      Locseg_Node *p = Make_Locseg_Node(locseg, tr);
+      Locseg_Node_Dlist_Insert(chain->iterator, p);
+    }
+  }
+}
+
+void Locseg_Chain_Remove_End(Locseg_Chain *chain, Dlist_End_e end)
+{
+  if (Locseg_Chain_Is_Empty(chain) == FALSE) {
+    chain->list = Locseg_Node_Dlist_Remove_End(chain->list, end);
+  }
+}
+
+void Locseg_Chain_Remove_Current(Locseg_Chain *chain)
+{
+  if (Locseg_Chain_Is_Empty(chain) == FALSE) {
+    if (chain->iterator != NULL) {
+      Locseg_Node_Dlist *next = chain->iterator->next;
+      chain->list = Locseg_Node_Dlist_Remove_Node(chain->iterator);
+      chain->iterator = next;
+    }
+  }
+}
+
+Locseg_Node* Locseg_Chain_Take_Current(Locseg_Chain *chain)
+{
+  if (Locseg_Chain_Is_Empty(chain)) {
+    return NULL;
+  }
+    
+  if (chain->iterator == NULL) {
+    return NULL;
+  }  
+
+  Locseg_Node *node = chain->iterator->data;
+  chain->iterator->data = NULL;
+  Locseg_Chain_Remove_Current(chain);
+
+  return node;
+}
+
+Locseg_Chain* Dir_Locseg_Chain_N(const char *dir_name, const char *pattern,
+				 int *n, int *file_num)
+{
+  *n = dir_fnum_p(dir_name, pattern);
+  if (*n == 0) {
+    return NULL;
+  }
+
+  Locseg_Chain *chain_array =
+    (Locseg_Chain*) Guarded_Malloc(sizeof(Locseg_Chain) * (*n), 
+				   "Dir_Neurochain");
+  
+  DIR *dir = opendir(dir_name);
+  struct dirent *ent = readdir(dir);
+  int index = 0;
+
+  /* allocate a string for storing full path. 100 is just an initial guess */
+  char *full_path = (char *) Guarded_Malloc(strlen(dir_name) + 100, 
+					    "Dir_Neurochain");
+  strcpy(full_path, dir_name);  
+  strcat(full_path, "/");
+	
+  regex_t preg;
+  regcomp(&preg, pattern, REG_BASIC);
+
+  while (ent != NULL) {
+    if (regexec(&preg, ent->d_name, 0, NULL, REG_BASIC) ==0) {
+      int path_length = strlen(dir_name) + strlen(ent->d_name) + 1;
+      if (path_length > strlen(full_path)) {
+	full_path = (char *) Guarded_Realloc(full_path, path_length + 1, 
+					     "Dir_Neurochain");
+      }
+      strcpy(full_path + strlen(dir_name) + 1, ent->d_name);
+#ifdef _DEBUG_2
+      printf("%d: %s\n", index, full_path);
+#endif
+      if (file_num != NULL) {
+	file_num[index] = String_Last_Integer(ent->d_name);
+      }
+
+      Locseg_Chain *chain = Read_Locseg_Chain(full_path);
+      chain_array[index++].list = chain->list;
+      Delete_Locseg_Chain(chain);
+    }
+    ent = readdir(dir);
+  }
+  free(full_path);
+  closedir(dir);
+
+  regfree(&preg);
+
+  return chain_array;
+}
+
+Locseg_Chain** Dir_Locseg_Chain_Nd(const char *dir_name, const char *pattern,
+			       int *n, int *file_num)
+{
+  *n = dir_fnum_p(dir_name, pattern);
+  if (*n == 0) {
+    return NULL;
+  }
+
+  Locseg_Chain **chain_array =
+    (Locseg_Chain**) Guarded_Malloc(sizeof(Locseg_Chain*) * (*n), 
+				   "Dir_Neurochain");
+  
+  DIR *dir = opendir(dir_name);
+  struct dirent *ent = readdir(dir);
+  int index = 0;
+
+  /* allocate a string for storing full path. 100 is just an initial guess */
+  char *full_path = (char *) Guarded_Malloc(strlen(dir_name) + 100, 
+					    "Dir_Neurochain");
+  strcpy(full_path, dir_name);  
+  strcat(full_path, "/");
+	
+  regex_t preg;
+  regcomp(&preg, pattern, REG_BASIC);
+
+  while (ent != NULL) {
+    if (regexec(&preg, ent->d_name, 0, NULL, REG_BASIC) ==0) {
+      int path_length = strlen(dir_name) + strlen(ent->d_name) + 1;
+      if (path_length > strlen(full_path)) {
+	full_path = (char *) Guarded_Realloc(full_path, path_length + 1, 
+					     "Dir_Neurochain");
+      }
+      strcpy(full_path + strlen(dir_name) + 1, ent->d_name);
+#ifdef _DEBUG_2
+      printf("%d: %s\n", index, full_path);
+#endif
+      if (file_num != NULL) {
+	file_num[index] = String_Last_Integer(ent->d_name);
+      }
+
+      chain_array[index++] = Read_Locseg_Chain(full_path);
+    }
+    ent = readdir(dir);
+  }
+  free(full_path);
+  closedir(dir);
+
+  regfree(&preg);
+
+  return chain_array;
+}
+
+/*
+void Neuron_Structure_Set_Locseg_Chain_Array(Neuron_Structure *ns,
+					   Locseg_Chain *chain_array)
+{
+  int ncomp = Neuron_Structure_Component_Number(ns);
+  int i;
+  int type = Locseg_Chain_Component_Type();
+  for (i = 0; i < ncomp; i++) {
+    Neuron_Component *nc = Neuron_Structure_Get_Component(ns, i);
+    Set_Neuron_Component(nc, type, chain_array + i);
+  }
+}
+*/
@@ -0,0 +1,296 @@
+/* tz_locseg_node.c
+ *
+ * 11-Aug-2008 Initial write: Ting Zhao
+ */
+
+#include <stdlib.h>
+#include "tz_utilities.h"
+#include "tz_error.h"
+#include "tz_trace_utils.h"
+#include "tz_locseg_node.h"
+#include "string.h"
+
+Locseg_Node* New_Locseg_Node()
+{
+  Locseg_Node *p = (Locseg_Node*) 
+    Guarded_Malloc(sizeof(Locseg_Node), "New_Locseg_Node");
+  
+  p->locseg = NULL;
+  p->tr = NULL;
+
+  return p;
+}
+
+void Delete_Locseg_Node(Locseg_Node *p)
+{
+  if (p != NULL) {
+    free(p);
+  }
+}
+
+void Clean_Locseg_Node(Locseg_Node *p)
+{
+  if (p != NULL) {
+    Delete_Local_Neuroseg(p->locseg);
+    p->locseg = NULL;
+    free(p->tr);
+    p->tr = NULL;
+  }
+}
+
+Locseg_Node* Make_Locseg_Node(const Local_Neuroseg *locseg,
+			      const Trace_Record *tr)
+{
+  Locseg_Node *p = New_Locseg_Node();
+  p->locseg = (Local_Neuroseg *) locseg;
+  p->tr = (Trace_Record *) tr;
+
+  return p;
+}
+
+void Kill_Locseg_Node(Locseg_Node *p)
+{
+  Clean_Locseg_Node(p);
+  Delete_Locseg_Node(p);
+}
+
+Locseg_Node* Copy_Locseg_Node(const Locseg_Node *p)
+{
+  return Make_Locseg_Node(Copy_Local_Neuroseg(p->locseg),
+			Copy_Trace_Record(p->tr));
+}
+
+BOOL Locseg_Node_Is_Identical(const Locseg_Node *p1, const Locseg_Node *p2)
+{
+  if (p1 == p2) {
+    return TRUE;
+  }
+
+  if ((p1 == NULL) || (p2 == NULL)) {
+    return FALSE;
+  }
+
+  if (p1->tr != p2->tr) {
+    if ((p1->tr == NULL) || (p2->tr == NULL)) {
+      return FALSE;
+    }
+    
+    if (memcmp(p1->tr, p2->tr, sizeof(Trace_Record)) != 0) {
+      return FALSE;
+    }
+  }
+
+  if (p1->locseg != p2->locseg) {
+    if ((p1->locseg == NULL) || (p2->locseg == NULL)) {
+      return FALSE;
+    }
+
+    if (memcmp(p1->locseg, p2->locseg, sizeof(Local_Neuroseg)) != 0) {
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+void Print_Locseg_Node(const Locseg_Node *p)
+{
+  Print_Local_Neuroseg(p->locseg);
+  Print_Trace_Record(p->tr);
+}
+
+void Print_Locseg_Node_Info(const Locseg_Node *p)
+{
+  Print_Local_Neuroseg(p->locseg);
+}
+
+void Locseg_Node_Fwrite(const Locseg_Node *p, FILE *stream)
+{
+  ASSERT(p != NULL, "Null Locseg_Node");
+  ASSERT(stream != NULL, "Invalid file pointer");
+  
+  Local_Neuroseg_Fwrite(p->locseg, stream);
+  Trace_Record_Fwrite(p->tr, stream);
+}
+
+void Locseg_Node_Fwrite_V(const Locseg_Node *p, FILE *stream, double version)
+{
+  ASSERT(p != NULL, "Null Locseg_Node");
+  ASSERT(stream != NULL, "Invalid file pointer");
+  
+  Local_Neuroseg_Fwrite(p->locseg, stream);
+  Trace_Record_Fwrite_V(p->tr, stream, version);
+}
+
+Locseg_Node* Locseg_Node_Fread(Locseg_Node *p, FILE *stream)
+{
+  ASSERT(stream != NULL, "Invalid file pointer");
+  
+  if (feof(stream)) {
+    return NULL;
+  }
+  
+  BOOL is_local_alloc = FALSE;
+
+  if (p == NULL) {
+    p = New_Locseg_Node();
+    is_local_alloc = TRUE;
+  }
+  
+  if ((p->locseg = Local_Neuroseg_Fread(p->locseg, stream)) == NULL) {
+    if (is_local_alloc == TRUE) {
+      Delete_Locseg_Node(p);
+    }
+    p = NULL;
+  } else {
+    if ((p->tr = Trace_Record_Fread(p->tr, stream)) == NULL) {
+      if (feof(stream)) {
+	if (is_local_alloc == TRUE) {
+	  Delete_Locseg_Node(p);
+	}
+	p = NULL;
+      }
+    }
+  }
+
+  return p;
+}
+
+Locseg_Node* Locseg_Node_Fread_V(Locseg_Node *p, FILE *stream, double version)
+{
+  ASSERT(stream != NULL, "Invalid file pointer");
+  
+  if (feof(stream)) {
+    return NULL;
+  }
+  
+  BOOL is_local_alloc = FALSE;
+
+  if (p == NULL) {
+    p = New_Locseg_Node();
+    is_local_alloc = TRUE;
+  }
+  
+  if ((p->locseg = Local_Neuroseg_Fread(p->locseg, stream)) == NULL) {
+    if (is_local_alloc == TRUE) {
+      Delete_Locseg_Node(p);
+    }
+    p = NULL;
+  } else {
+    if ((p->tr = Trace_Record_Fread_V(p->tr, stream, version)) == NULL) {
+      if (feof(stream)) {
+	if (is_local_alloc == TRUE) {
+	  Delete_Locseg_Node(p);
+	}
+	p = NULL;
+      }
+    }
+  }
+
+  return p;
+}
+
+void Locseg_Node_Copy_Trace_Record(Locseg_Node *p, const Trace_Record *tr)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Copy(p->tr, tr);
+}
+
+void Locseg_Node_Set_Score(Locseg_Node *p, const Stack_Fit_Score *fs)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Set_Score(p->tr, fs);
+}
+
+void Locseg_Node_Set_Hit_Region(Locseg_Node *p, int hit_region)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Set_Hit_Region(p->tr, hit_region);
+}
+
+void Locseg_Node_Set_Index(Locseg_Node *p, int index)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Set_Index(p->tr, index);
+}
+
+void Locseg_Node_Set_Refit(Locseg_Node *p, BOOL is_refit)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Set_Refit(p->tr, is_refit);
+}
+
+void Locseg_Node_Set_Direction(Locseg_Node *p, Dlist_Direction_e direction)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Set_Direction(p->tr, direction);
+}
+
+void Locseg_Node_Set_Fit_Height(Locseg_Node *p, int index, int value)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Set_Fit_Height(p->tr, index, value);
+}
+
+void Locseg_Node_Set_Fix_Point(Locseg_Node *p, double value)
+{
+  if (p->tr == NULL) {
+    p->tr = New_Trace_Record();
+  }
+
+  Trace_Record_Set_Fix_Point(p->tr, value);
+}
+
+double Locseg_Node_Fix_Point(Locseg_Node *p)
+{
+  double t = Trace_Record_Fix_Point(p->tr);
+  if ((t < 0.0) || (t > 1.0)){
+    switch (Trace_Record_Direction(p->tr)) {
+    case DL_FORWARD:
+      t = 0.0;
+      break;
+    case DL_BACKWARD:
+      t = 1.0;
+      break;
+    case DL_BOTHDIR:
+      t = -1.0;
+      break;
+    default:
+      t = 0.0;
+    }
+  }
+
+  return t;
+}
+
+BOOL Locseg_Node_Fix_Pos(Locseg_Node *p, double *pos)
+{
+  double t = Locseg_Node_Fix_Point(p);
+  if (t >= 0.0) {
+    Local_Neuroseg_Axis_Coord_N(p->locseg, t, pos);
+    return TRUE;
+  }
+
+   return FALSE;
+}
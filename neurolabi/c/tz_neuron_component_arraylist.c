@@ -0,0 +1,265 @@
+/* tz_arraylist.c.t
+ *
+ * 15-Feb-2008 Initial write: Ting Zhao
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "tz_error.h"
+#include "tz_utilities.h"
+#include "tz_neuron_component_arraylist.h"
+
+INIT_EXCEPTION
+
+const static int Growth_Coeff = 2; /* growth factor */
+
+/* neuron_component_arraylist_grow(): Grow an arraylist.
+ *
+ * Args: a - the arraylist to grow.
+ *
+ * Return: void.
+ */
+static void neuron_component_arraylist_grow(Neuron_Component_Arraylist *a)
+{
+  if (a->capacity == 0) {
+    a->capacity = Growth_Coeff;
+    a->array = (Neuron_Component *) Guarded_Malloc(sizeof(Neuron_Component) * a->capacity, 
+				       "neuron_component_arraylist_grow");
+  } else {
+    int new_capacity = Growth_Coeff * a->capacity;
+  
+    Neuron_Component *new_array = (Neuron_Component *) Guarded_Calloc(new_capacity, sizeof(Neuron_Component),
+					      "neuron_component_arraylist_grow");
+    memcpy(new_array, a->array, sizeof(Neuron_Component) * a->capacity);
+    free(a->array);
+    a->array = new_array;
+    a->capacity = new_capacity;
+  }
+}
+
+/* Print_Neuron_Component_Arraylist(): Prints an array list.
+ * 
+ * Args: a - the arraylist to print.
+ *       format - printing format. This is mainly for priliminary data elements.
+ *
+ * Return: void.
+ */
+void Print_Neuron_Component_Arraylist(const Neuron_Component_Arraylist *a)
+{
+  int i;
+  printf("%d elements: ", a->length);
+  for  (i = 0; i < a->length; i++) {
+    Print_Neuron_Component(a->array + i);
+  }
+  
+  printf("\n");
+}
+
+Neuron_Component_Arraylist* New_Neuron_Component_Arraylist()
+{
+  return Neuron_Component_Arraylist_New(0, 1);
+}
+
+/* Neuron_Component_Arraylist_New(): New an arraylist.
+ * 
+ * Args: length - length of the arraylist;
+ *       margin - margin of the arraylist. This means the capacity of the
+ *                arraylist will be <length> + <margin>.
+ * 
+ * Return: a new arraylist.
+ */
+Neuron_Component_Arraylist* Neuron_Component_Arraylist_New(int length, int margin)
+{
+  if ((length < 0) || margin < 0) {
+    TZ_WARN(ERROR_DATA_VALUE);
+    return NULL;
+  }
+
+  Neuron_Component_Arraylist *a = (Neuron_Component_Arraylist *) Guarded_Malloc(sizeof(Neuron_Component_Arraylist), 
+							"Neuron_Component_Arraylist_New");
+  a->length = length;
+  a->capacity = length + margin;
+  if (a->capacity > 0) {
+    a->array = (Neuron_Component *) Guarded_Malloc(sizeof(Neuron_Component) * a->capacity, 
+				       "Neuron_Component_Arraylist_New");
+  } else {
+    a->array = NULL;
+  }
+
+  return a;
+}
+
+/* Neuron_Component_Arraylist_Free(): Free an array list.
+ *
+ * Args: a - the array list to free.
+ *
+ * Return: void.
+ */
+void Neuron_Component_Arraylist_Free(Neuron_Component_Arraylist *a)
+{
+  free(a->array);
+  free(a);
+}
+
+Neuron_Component_Arraylist* Make_Neuron_Component_Arraylist(int length, int margin)
+{
+  if ((length < 0) || margin < 0) {
+    TZ_WARN(ERROR_DATA_VALUE);
+    return NULL;
+  }
+
+  Neuron_Component_Arraylist *a = (Neuron_Component_Arraylist *) Guarded_Malloc(sizeof(Neuron_Component_Arraylist), 
+							"Neuron_Component_Arraylist_New");
+  a->length = length;
+  a->capacity = length + margin;
+  if (a->capacity > 0) {
+    a->array = (Neuron_Component *) Guarded_Malloc(sizeof(Neuron_Component) * a->capacity, 
+				       "Neuron_Component_Arraylist_New");
+  } else {
+    a->array = NULL;
+  }
+
+  return a;
+}
+
+void Kill_Neuron_Component_Arraylist(Neuron_Component_Arraylist *a)
+{
+  
+  int i;
+  for (i = 0; i < a->length; i++) {
+    Clean_Neuron_Component(a->array + i);
+  }
+  
+  
+  free(a->array);
+  free(a);
+}
+
+Neuron_Component_Arraylist* Neuron_Component_Arraylist_Wrap(Neuron_Component *array, int n)
+{
+  if (array == NULL) {
+    return NULL;
+  }
+
+  Neuron_Component_Arraylist *a = (Neuron_Component_Arraylist *) Guarded_Malloc(sizeof(Neuron_Component_Arraylist), 
+							"Neuron_Component_Arraylist_New");
+  a->length = n;
+  a->capacity = n;
+  a->array = array;
+
+  return a;
+}
+
+Neuron_Component Neuron_Component_Arraylist_At(const Neuron_Component_Arraylist *a, int index)
+{
+  return a->array[index];
+}
+
+Neuron_Component Neuron_Component_Arraylist_Last(const Neuron_Component_Arraylist *a)
+{
+  return a->array[a->length - 1];
+}
+
+Neuron_Component* Neuron_Component_Arraylist_At_R(const Neuron_Component_Arraylist *a, int index)
+{
+  return a->array + index;
+}
+
+/* Neuron_Component_Arraylist_Add(): Add an element to an array list.
+ *
+ * Args: <a> - the arraylist to manipulate;
+ *       <item> - the element to add.
+ *
+ * Return: void.
+ */
+void Neuron_Component_Arraylist_Add(Neuron_Component_Arraylist *a, Neuron_Component item)
+{
+  a->length++;
+
+  if (a->length >= a->capacity) {
+    neuron_component_arraylist_grow(a);
+  }
+
+  a->array[a->length - 1] = item;
+}
+
+void Neuron_Component_Arraylist_Insert(Neuron_Component_Arraylist *a, int index, Neuron_Component item)
+{
+  if (index < a->length) {
+    a->length++;
+    if (a->length >= a->capacity) {
+      neuron_component_arraylist_grow(a);
+    }
+
+    memmove(a->array + index + 1, a->array + index, 
+	    sizeof(Neuron_Component) * (a->length - index - 1));
+  }
+
+  Neuron_Component_Arraylist_Set(a, index, item);
+}
+
+Neuron_Component Neuron_Component_Arraylist_Take(Neuron_Component_Arraylist *a, int index)
+{
+  Neuron_Component data = a->array[index];
+  a->length--;
+  memmove(a->array + index, a->array + index + 1, 
+	  sizeof(Neuron_Component) * (a->length - index));
+
+  return data;
+}
+
+Neuron_Component Neuron_Component_Arraylist_Take_Last(Neuron_Component_Arraylist *a)
+{
+  Neuron_Component data = a->array[a->length - 1];
+  a->length--;
+
+  return data;
+}
+
+void Neuron_Component_Arraylist_Set_Length(Neuron_Component_Arraylist *a, int length)
+{
+  TZ_ASSERT(length >= 0, "Negative length");
+
+  a->length = length;
+
+  while (a->length > a->capacity) {
+    neuron_component_arraylist_grow(a);
+  }
+}
+
+void Neuron_Component_Arraylist_Set(Neuron_Component_Arraylist *a, int index, Neuron_Component item)
+{
+  if (index >= a->length) {
+    a->length = index + 1;
+  }
+
+  while (a->length > a->capacity) {
+    neuron_component_arraylist_grow(a);
+  }
+  
+
+  a->array[index] = item;
+}
+
+/* Neuron_Component_Arraylist_Swap(): Swap two elements
+ * 
+ * Args: a - the arraylist to manipulate;
+ *       idx1 - index of the first element;
+ *       idx2 - index of the second element.
+ *
+ * Return: void.
+ */
+void Neuron_Component_Arraylist_Swap(Neuron_Component_Arraylist *a, int idx1, int idx2)
+{
+  if ((idx1 < 0) || (idx1 >= a->length) || (idx2 < 0) || (idx2 >= a->length)) {
+    TZ_WARN(ERROR_DATA_VALUE);
+    return;
+  }
+  
+  Neuron_Component tmp;
+  tmp = a->array[idx1];
+  a->array[idx1] = a->array[idx2];
+  a->array[idx2] = tmp;
+}
+
@@ -0,0 +1,380 @@
+/* tz_linked_list_c.t
+ *
+ * 27-Nov-2007 Initial write: Ting Zhao
+ */
+
+#include <stdlib.h>
+#include "tz_error.h"
+#include "utilities.h"
+#include "tz_object_3d_linked_list.h"
+
+INIT_EXCEPTION
+
+/* Object_3d_List_New(): New a Object_3d list.
+ *
+ * Return: A Object_3d list with length 1.
+ */
+Object_3d_List* Object_3d_List_New()
+{
+  Object_3d_List *new_list = (Object_3d_List *) Guarded_Malloc(sizeof(Object_3d_List), 
+						     "Object_3d_List_New");
+  new_list->next = NULL;
+
+  return new_list;
+}
+
+void Object_3d_List_Set_Data(Object_3d_List *p, Object_3d_P data)
+{
+  p->data = data;
+}
+
+/* Object_3d_List_Removeall(): Remove all nodes in a list.
+ *
+ * Args: p - a pointer to the list. It becomes NULL after calling this function.
+ *
+ * Return: void.
+ */
+void Object_3d_List_Removeall(Object_3d_List **p)
+{
+  if (p != NULL) {
+    while (*p != NULL) {
+      Object_3d_List_Remove(p);
+    }
+  }
+}
+
+/* Object_3d_List_Unlinkall(): Unlink all nodes in a list.
+ *
+ * Args: p - a pointer to the list. It becomes NULL after calling this function.
+ *
+ * Return: void.
+ */
+void Object_3d_List_Unlinkall(Object_3d_List **p)
+{
+  if (p != NULL) {
+    while (*p != NULL) {
+      Object_3d_List_Unlink(p);
+    }
+  }
+}
+
+void Kill_Object_3d_List(Object_3d_List *p)
+{
+  Object_3d_List_Removeall(&p);
+}
+
+/* Object_3d_List_Add(): Add a node to the beginning of the list.
+ * 
+ * Args: p - pointer to the list;
+ *       data - data node.
+ *
+ * Return: the old head.
+ * 
+ * Note: <data> (not its copy) will be added to the list, so be careful about
+ *       freeing the object.
+ */
+Object_3d_List* Object_3d_List_Add(Object_3d_List **p, Object_3d_P data)
+{
+  Object_3d_List *new_node = Object_3d_List_New();
+  new_node->next = *p;
+  Object_3d_List_Set_Data(new_node, data);
+  *p = new_node;
+  
+  return (*p)->next;
+}
+
+/* Object_3d_List_Add_Last(): Add a new node to the end of the list.
+ *
+ * Return: the last node of the new list.
+ */
+Object_3d_List* Object_3d_List_Add_Last(Object_3d_List *p, Object_3d_P data)
+{
+  p = Object_3d_List_Last(p);
+  Object_3d_List *new_node = Object_3d_List_New();
+  Object_3d_List_Set_Data(new_node, data);
+  p->next = new_node;
+
+  return new_node;
+}
+
+/* Object_3d_List_Remove(): Remove the first node.
+ *
+ * Args: p - a pointer to the list. It becomes the new list after calling this
+ *           function.
+ *
+ * Return: void.
+ */
+void Object_3d_List_Remove(Object_3d_List **p)
+{
+  if (*p != NULL) {
+    Object_3d_List *tmp_head = *p;
+    *p = tmp_head->next;
+    
+    Kill_Object_3d(tmp_head->data);
+    
+    
+    free(tmp_head);
+  }
+}
+
+void Object_3d_List_Remove_Last(Object_3d_List *p)
+{
+  if (p == NULL) {
+    return;
+  }
+
+  while (p->next != NULL) {
+    p = Object_3d_List_Next(p);
+  }
+
+  Object_3d_List_Remove(&p);
+}
+
+/* Object_3d_List_Unlink(): Unlink the head of a list.
+ *
+ * Args: p - input list, which will be changed.
+ *
+ * Return: the unlinked data.
+ */
+Object_3d_P Object_3d_List_Unlink(Object_3d_List **p)
+{
+  if (*p != NULL) {
+    Object_3d_List *tmp_head = *p;
+    *p = tmp_head->next;
+
+    Object_3d_P data = tmp_head->data;
+    free(tmp_head);
+    
+    return data;
+  }
+
+  
+  return NULL;
+  
+  
+}
+
+/* Object_3d_List_Next(): Get next node.
+ *
+ * Return: the next node of p.
+ */
+Object_3d_List* Object_3d_List_Next(Object_3d_List *p)
+{
+  return p->next;
+}
+
+/* Object_3d_List_Last(): Get the last node.
+ *
+ * Return: the last node of <p>.
+ */
+Object_3d_List* Object_3d_List_Last(Object_3d_List *p)
+{
+  Object_3d_List* prev = NULL;
+
+  while (p != NULL) {
+    prev = p;
+    p = Object_3d_List_Next(p);
+  }
+
+  return prev;
+}
+
+BOOL Object_3d_List_Is_Empty(const Object_3d_List *p)
+{
+  if (p == NULL) {
+    return TRUE;
+  } else {
+    return FALSE;
+  }
+}
+
+/* Object_3d_List_Length(): Length of the list.
+ * 
+ * Args: p - input list.
+ *
+ * Return: the length of the list.
+ */
+int Object_3d_List_Length(const Object_3d_List *p)
+{
+  int n = 0;
+  while (p != NULL) {
+    n++;
+    p = p->next;
+  }
+
+  return n;
+}
+
+/* Object_3d_List_To_Array(): Turn a list to an array.
+ *
+ * Args: p - input list;
+ *       array - returned array. If it is NULL, a new array will be created,
+ *               otherwise it must be large enough to hold the result.
+ *       step - The offset between an element and its right neighbor. If it is
+ *              negative, the array has a reversed order.
+ * Return: the resulted array.
+ *
+ * Note: The caller is responsible for freeing the returned array.
+ */
+Object_3d_P* Object_3d_List_To_Array(const Object_3d_List *p, int step, Object_3d_P *array, int *length)
+{
+  if (step == 0) {
+    THROW(ERROR_DATA_VALUE);
+  }
+
+  int n = Object_3d_List_Length(p);
+  int array_length = (n - 1) * abs(step) + 1;
+
+  if (array == NULL) {
+    array = (Object_3d_P *) Guarded_Malloc(sizeof(Object_3d_P) * array_length, 
+				    "Object_3d_List_To_Array");
+  }
+
+  int begin;
+  int end;
+  
+  if (step > 0) {
+    begin = 0;
+    end = array_length - 1;
+  } else {
+    begin = array_length - 1;
+    end = 0;
+  }
+  
+  int i;
+  for (i = begin; p != NULL; i += step, p = p->next) {
+    array[i] = p->data;
+  }
+
+  if (length != NULL) {
+    *length = array_length;
+  }
+
+  return array;
+}
+
+/* Print_Object_3d_List(): Print Object_3d list.
+ *
+ * Args: p - list to print.
+ *
+ * Return: void.
+ *
+ * Note: This function works only when Print_Object_3d is available.
+ */
+void Print_Object_3d_List(const Object_3d_List *p)
+{
+  if (p == NULL) {
+    printf("Null list.\n");
+    return;
+  }
+
+  printf("Total length: %d\n", Object_3d_List_Length(p));
+
+  
+  while (p != NULL) {
+    Print_Object_3d(p->data);
+    p = p->next;
+  }
+  
+
+}
+
+/* Print_Object_3d_List_Compact(): Print Object_3d list briefly.
+ *
+ * Args: p - list to print.
+ *
+ * Return: void.
+ *
+ * Note: This function works only when Print_Object_3d_Info is available.
+ */
+void Print_Object_3d_List_Compact(const Object_3d_List *p)
+{
+  if (p == NULL) {
+    printf("Null list.\n");
+    return;
+  }
+
+  
+  int i = 1;
+  while (p != NULL) {
+    printf("Item %d: ", i);
+    Print_Object_3d_Info(p->data);
+    i++;
+    p = p->next;
+  }
+  
+}
+
+void Print_Object_3d_List_F(const Object_3d_List *p, const char *format)
+{
+  if (p == NULL) {
+    printf("Null list.\n");
+    return;
+  }
+
+  printf("Total length: %d\n", Object_3d_List_Length(p));
+  while (p != NULL) {
+    printf(format, p->data);
+    printf(" ");
+    p = p->next;
+  }
+  printf("\n");
+}
+
+/*
+ * The following routines implement a queue based on a list.
+ */
+
+/* Object_3d_Queue_En(): Add an item to the end of the queue.
+ */
+Object_3d_List* Object_3d_Queue_En(Object_3d_List **p, Object_3d_P data)
+{
+  if (*p == NULL) {
+    *p = Object_3d_List_New();
+    Object_3d_List_Set_Data(*p, data);
+    return *p;
+  }
+
+  return Object_3d_List_Add_Last(*p, data);
+}
+
+/* Object_3d_Queue_De(): Removes the item from the front of the queue.
+ */
+Object_3d_P Object_3d_Queue_De(Object_3d_List **p)
+{
+  return Object_3d_List_Unlink(p);
+}
+
+/* Object_3d_Queue_Peek(): Get the iterm from the front of the queue without removing
+ *                    it.
+ */
+Object_3d_P Object_3d_Queue_Peek(const Object_3d_List *p)
+{
+  return p->data;
+}
+
+
+/*
+ * The following routines implement a stack based on a list.
+ */
+void Object_3d_Stack_Push(Object_3d_List **p, Object_3d_P data)
+{
+  if (*p == NULL) {
+    *p = Object_3d_List_New();
+    Object_3d_List_Set_Data(*p, data);
+  } else {
+    Object_3d_List_Add(p, data);  
+  }
+}
+
+Object_3d_P Object_3d_Stack_Pop(Object_3d_List **p)
+{
+  return Object_3d_List_Unlink(p);
+}
+
+Object_3d_P Object_3d_Stack_Peek(const Object_3d_List *p)
+{
+  return p->data;
+}
+
+
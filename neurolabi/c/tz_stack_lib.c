@@ -1167,6 +1167,16 @@ void Stretch_Stack_Value(Stack *stack)
 }
 
 void Stretch_Stack_Value_Q(Stack *stack, double q)
+{
+  int min, max;
+  Stack_Stretch_Range_Q(stack, q, &min, &max);
+
+  printf("%d, %d\n", min, max);
+
+  Stretch_Stack_Value_R(stack, min, max);
+}
+
+void Stack_Stretch_Range_Q(const Stack *stack, double q, int *min, int *max)
 {
   if (Stack_Channel_Number(stack) > 1) {
     PRINT_EXCEPTION("Unsupported kind", "Multichannel stack not supported.");
@@ -1175,23 +1185,28 @@ void Stretch_Stack_Value_Q(Stack *stack, double q)
   int *hist = Stack_Hist(stack); /* hist created */
   int *raw_hist = hist + 2;
 
-  int min = hist[1];
+  *min = hist[1];
 
   iarray_cumsum(raw_hist, hist[0]);
 
-  int max;
   int length = Stack_Voxel_Number(stack);
   double threshold = q * length;
 
-  for (max = hist[0] - 2; max >= 0; max--) {
-    if (raw_hist[max] < threshold) {
+  for (*max = hist[0] - 2; *max >= 0; (*max)--) {
+    if (raw_hist[*max] < threshold) {
       break;
     }
   }
-  max++;
+  (*max)++;
+
+  free(hist);
+}
 
+void Stretch_Stack_Value_R(Stack *stack, int min, int max)
+{
   double maxg = 0.0;
   int i;
+  int length = Stack_Voxel_Number(stack);
 
   switch (stack->kind) {
   case GREY:
@@ -1216,14 +1231,10 @@ void Stretch_Stack_Value_Q(Stack *stack, double q)
   default:
     PRINT_EXCEPTION("Unsupported kind", "GREY, GREY16 only.");
   }
-  
-  printf("%d, %d\n", min, max);
 
   double factor = maxg / max;
   double offset = -min;
   Scale_Stack(stack, 0, factor, offset);  
-
-  free(hist);
 }
 
 Stack* Reflect_Stack(Stack* stack,int in_place)
@@ -1401,110 +1412,254 @@ Stack* Resize_Stack(const Stack* stack,int width,int height,int depth)
   return stack2;
 }
 
-Stack* Downsample_Stack(const Stack* stack,int wintv,int hintv,int dintv)
-{
-  int width,height,depth;
-  int i,j,k;
-  width = (stack->width+wintv)/(wintv+1);
-  height = (stack->height+hintv)/(hintv+1);
-  depth = (stack->depth+dintv)/(dintv+1);
+/* The downsampling kernels below fold a block row into an accumulator row one
+ * input row at a time, so that the innermost loops run over contiguous
+ * voxels. The voxels of each block are still visited slice by slice, row by
+ * row, which keeps floating point sums the same as adding them block by
+ * block. COLOR stacks are handled as interleaved GREY channels (<nc> = 3).
+ */
+#define DOWNSAMPLE_REDUCE_SUM(a, v) a += v;
+#define DOWNSAMPLE_REDUCE_MAX(a, v) a = ((v) > a) ? (v) : a;
+
+#define DOWNSAMPLE_ASSIGN_MEAN(dst, a, n, validate_value)	\
+  s = (double) (a) / (n);					\
+  validate_value(s);						\
+  dst = s;
+
+#define DOWNSAMPLE_ASSIGN_MAX(dst, a, n, validate_value) dst = a;
+
+#define DOWNSAMPLE_STACK_SLAB(stack_array, out_array, acc_t, nc, reduce, assign, validate_value) \
+  for (k = k0; k <= k1; k++) {						\
+    int bd = imin2(subdepth, depth - k * subdepth);			\
+    for (j = 0; j < out_height; j++) {					\
+      int bh = imin2(subheight, height - j * subheight);		\
+      acc_t *acc = (acc_t*) buffer;					\
+      for (i = 0; i < out_width * nc; i++) {				\
+	acc[i] = 0;							\
+      }									\
+      for (rk = 0; rk < bd; rk++) {					\
+	for (rj = 0; rj < bh; rj++) {					\
+	  offset = ((size_t) (k * subdepth + rk) * height +		\
+		    j * subheight + rj) * width * nc;			\
+	  if (subwidth == 1) {						\
+	    for (i = 0; i < width * nc; i++) {				\
+	      reduce(acc[i], stack_array[offset + i]);			\
+	    }								\
+	  } else {							\
+	    for (ri = 0; ri < subwidth; ri++) {				\
+	      for (i = 0; i < kw; i++) {				\
+		for (c = 0; c < nc; c++) {				\
+		  reduce(acc[i * nc + c],				\
+			 stack_array[offset + ((size_t) i * subwidth + ri) * nc + c]); \
+		}							\
+	      }								\
+	    }								\
+	    for (ri = 0; ri < rw; ri++) {				\
+	      for (c = 0; c < nc; c++) {				\
+		reduce(acc[kw * nc + c],				\
+		       stack_array[offset + ((size_t) kw * subwidth + ri) * nc + c]); \
+	      }								\
+	    }								\
+	  }								\
+	}								\
+      }									\
+      offset2 = ((size_t) k * out_height + j) * out_width * nc;	\
+      for (i = 0; i < out_width; i++) {					\
+	for (c = 0; c < nc; c++) {					\
+	  assign(out_array[offset2], acc[i * nc + c],			\
+		 imin2(subwidth, width - i * subwidth) * bh * bd,	\
+		 validate_value);					\
+	  offset2++;							\
+	}								\
+      }									\
+    }									\
+  }
 
-  Stack* stack2 = Make_Stack(stack->kind,width,height,depth);
-  uint16* stack2_array16 = (uint16*) stack2->array;
-  color_t* stack2_arrayc = (color_t*) stack2->array;
+#define DOWNSAMPLE_STACK_NEAREST_SLAB(stack_array, out_array, nc)	\
+  for (k = k0; k <= k1; k++) {						\
+    for (j = 0; j < out_height; j++) {					\
+      offset = ((size_t) k * subdepth * height + j * subheight) * width * nc; \
+      offset2 = ((size_t) k * out_height + j) * out_width * nc;	\
+      if (subwidth == 1) {						\
+	for (i = 0; i < width * nc; i++) {				\
+	  out_array[offset2 + i] = stack_array[offset + i];		\
+	}								\
+      } else {								\
+	for (i = 0; i < out_width; i++) {				\
+	  for (c = 0; c < nc; c++) {					\
+	    out_array[offset2++] = stack_array[offset + c];		\
+	  }								\
+	  offset += subwidth * nc;					\
+	}								\
+      }									\
+    }									\
+  }
 
-  int* col_idx = (int*) malloc(sizeof(int)*width);
-  int* row_idx = (int*) malloc(sizeof(int)*height);
-  int* dep_idx = (int*) malloc(sizeof(int)*depth);
+void Downsample_Stack_Slab(const Stack *stack, int wintv, int hintv, int dintv,
+			   Stack_Downsample_Method_e method, int k0, int k1,
+			   Stack *out)
+{
+  int width = stack->width;
+  int height = stack->height;
+  int depth = stack->depth;
+  int subwidth = wintv + 1;
+  int subheight = hintv + 1;
+  int subdepth = dintv + 1;
+  int out_width, out_height, out_depth;
+  Downsample_Stack_Max_Size(width, height, depth, wintv, hintv, dintv,
+			    &out_width, &out_height, &out_depth);
+  int kw = width / subwidth;
+  int rw = width % subwidth;
 
-  size_t offset = 0;
-  for(i=0;i<width;i++) {
-    col_idx[i] = offset;
-    offset += wintv+1;
+  if (k0 < 0) {
+    k0 = 0;
   }
-
-  offset = 0;
-  for(i=0;i<height;i++) {
-    row_idx[i] = offset;
-    offset += hintv+1;
+  if (k1 >= out_depth) {
+    k1 = out_depth - 1;
   }
 
-  offset = 0;
-  for(i=0;i<depth;i++) {
-    dep_idx[i] = offset;
-    offset += dintv+1;
+  int i, j, k, c, ri, rj, rk;
+  size_t offset, offset2;
+  double s;
+  void *buffer = NULL;
+  if (method != STACK_DOWNSAMPLE_NEAREST) {
+    buffer = malloc(sizeof(double) * out_width * 3);
   }
 
-  offset=0;
-  switch(stack->kind) {
-  case GREY:
-    for(k=0;k<depth;k++)
-      for(i=0;i<height;i++)
-	for(j=0;j<width;j++) {
-	  stack2->array[offset] = 
-	    (*STACK_PIXEL_8(stack,col_idx[j],row_idx[i],dep_idx[k],0));
-	  offset++;
-	}
+  Image_Array ima;
+  ima.array = stack->array;
+  Image_Array out_ima;
+  out_ima.array = out->array;
+
+  switch (method) {
+  case STACK_DOWNSAMPLE_NEAREST:
+    switch (stack->kind) {
+    case GREY:
+      DOWNSAMPLE_STACK_NEAREST_SLAB(ima.array8, out_ima.array8, 1);
+      break;
+    case GREY16:
+      DOWNSAMPLE_STACK_NEAREST_SLAB(ima.array16, out_ima.array16, 1);
+      break;
+    case FLOAT32:
+      DOWNSAMPLE_STACK_NEAREST_SLAB(ima.array32, out_ima.array32, 1);
+      break;
+    case FLOAT64:
+      DOWNSAMPLE_STACK_NEAREST_SLAB(ima.array64, out_ima.array64, 1);
+      break;
+    case COLOR:
+      DOWNSAMPLE_STACK_NEAREST_SLAB(ima.array8, out_ima.array8, 3);
+      break;
+    default:
+      TZ_ERROR(ERROR_DATA_TYPE);
+      break;
+    }
     break;
-  case GREY16:
-    for (k = 0; k < depth; k++) {
-      for(i=0;i<height;i++) {
-	for(j=0;j<width;j++) {
-	  stack2_array16[offset] = 
-	    (*STACK_PIXEL_16(stack,col_idx[j],row_idx[i],dep_idx[k],0));
-	  offset++;
-	}
-      }
+  case STACK_DOWNSAMPLE_MEAN:
+    switch (stack->kind) {
+    case GREY:
+      DOWNSAMPLE_STACK_SLAB(ima.array8, out_ima.array8, tz_uint64, 1,
+			    DOWNSAMPLE_REDUCE_SUM, DOWNSAMPLE_ASSIGN_MEAN,
+			    VALIDATE_INTENSITY_GREY);
+      break;
+    case GREY16:
+      DOWNSAMPLE_STACK_SLAB(ima.array16, out_ima.array16, tz_uint64, 1,
+			    DOWNSAMPLE_REDUCE_SUM, DOWNSAMPLE_ASSIGN_MEAN,
+			    VALIDATE_INTENSITY_GREY16);
+      break;
+    case FLOAT32:
+      DOWNSAMPLE_STACK_SLAB(ima.array32, out_ima.array32, double, 1,
+			    DOWNSAMPLE_REDUCE_SUM, DOWNSAMPLE_ASSIGN_MEAN,
+			    VALIDATE_INTENSITY_FLOAT32);
+      break;
+    case FLOAT64:
+      DOWNSAMPLE_STACK_SLAB(ima.array64, out_ima.array64, double, 1,
+			    DOWNSAMPLE_REDUCE_SUM, DOWNSAMPLE_ASSIGN_MEAN,
+			    VALIDATE_INTENSITY_FLOAT64);
+      break;
+    case COLOR:
+      DOWNSAMPLE_STACK_SLAB(ima.array8, out_ima.array8, tz_uint64, 3,
+			    DOWNSAMPLE_REDUCE_SUM, DOWNSAMPLE_ASSIGN_MEAN,
+			    VALIDATE_INTENSITY_COLOR);
+      break;
+    default:
+      TZ_ERROR(ERROR_DATA_TYPE);
+      break;
     }
     break;
-  case COLOR:
-    for (k = 0; k < depth; k++) {
-      for(i=0;i<height;i++) {
-	for(j=0;j<width;j++) {
-	  stack2_arrayc[offset][0] = 
-	    (*STACK_PIXEL_8(stack,col_idx[j],row_idx[i],dep_idx[k],0));
-	  stack2_arrayc[offset][1] = 
-	    (*STACK_PIXEL_8(stack,col_idx[j],row_idx[i],dep_idx[k],1));
-	  stack2_arrayc[offset][2] = 
-	    (*STACK_PIXEL_8(stack,col_idx[j],row_idx[i],dep_idx[k],2));
-	  offset++;
-	}
-      }
+  case STACK_DOWNSAMPLE_MAX:
+    /* The maximum starts from 0 as in the original implementation. */
+    switch (stack->kind) {
+    case GREY:
+      DOWNSAMPLE_STACK_SLAB(ima.array8, out_ima.array8, uint8, 1,
+			    DOWNSAMPLE_REDUCE_MAX, DOWNSAMPLE_ASSIGN_MAX,
+			    VALIDATE_INTENSITY_GREY);
+      break;
+    case GREY16:
+      DOWNSAMPLE_STACK_SLAB(ima.array16, out_ima.array16, uint16, 1,
+			    DOWNSAMPLE_REDUCE_MAX, DOWNSAMPLE_ASSIGN_MAX,
+			    VALIDATE_INTENSITY_GREY16);
+      break;
+    case FLOAT32:
+      DOWNSAMPLE_STACK_SLAB(ima.array32, out_ima.array32, float, 1,
+			    DOWNSAMPLE_REDUCE_MAX, DOWNSAMPLE_ASSIGN_MAX,
+			    VALIDATE_INTENSITY_FLOAT32);
+      break;
+    case FLOAT64:
+      DOWNSAMPLE_STACK_SLAB(ima.array64, out_ima.array64, double, 1,
+			    DOWNSAMPLE_REDUCE_MAX, DOWNSAMPLE_ASSIGN_MAX,
+			    VALIDATE_INTENSITY_FLOAT64);
+      break;
+    case COLOR:
+      DOWNSAMPLE_STACK_SLAB(ima.array8, out_ima.array8, uint8, 3,
+			    DOWNSAMPLE_REDUCE_MAX, DOWNSAMPLE_ASSIGN_MAX,
+			    VALIDATE_INTENSITY_COLOR);
+      break;
+    default:
+      TZ_ERROR(ERROR_DATA_TYPE);
+      break;
     }
     break;
   default:
-    fprintf(stderr,"Downsample_Image: Unsupported image kind.\n");
+    TZ_ERROR(ERROR_DATA_VALUE);
+    break;
   }
 
-  free(col_idx);
-  free(row_idx);
-  free(dep_idx);
-
-  return stack2;
+  if (buffer != NULL) {
+    free(buffer);
+  }
 }
 
-#define DOWNSAMPLE_STACK_BLOCK_MEAN(stack_array, out_array, subwdith_t, subheight_t, subdepth_t, subarea_t, wndsize_t, validate_value) \
-  s = 0;								\
-  old_offset = offset;							\
-  for(rk=0;rk<subdepth_t;rk++) {					\
-    for(rj=0;rj<subheight_t;rj++) {					\
-      for(ri=0;ri<subwdith_t;ri++) {					\
-	/*printf("%d ", offset);*/					\
-	s += stack_array[offset];					\
-	offset++;							\
-      }									\
-      offset += width - subwdith_t;					\
-    }									\
-    offset += area - subheight_t * width;				\
-  }									\
-  s /= wndsize_t;							\
-  validate_value(s);							\
-  out_array[offset2] = s;						\
-  offset2++;								\
-  /*printf("\n");*/							\
-  /*printf("\n%d %d %d\n", old_offset, offset, wndsize_t);*/		\
-  offset = old_offset + subwdith_t;
+/* downsample_stack(): downsample the whole stack. <out> can be the same as
+ * <stack> because each output slice never reaches the input slices that are
+ * not used yet.
+ */
+static Stack* downsample_stack(const Stack *stack, int wintv, int hintv,
+			       int dintv, Stack_Downsample_Method_e method,
+			       Stack *out)
+{
+  int width, height, depth;
+  Downsample_Stack_Max_Size(stack->width, stack->height, stack->depth,
+			    wintv, hintv, dintv, &width, &height, &depth);
+  if (out == NULL) {
+    out = Make_Stack(stack->kind, width, height, depth);
+  }
+
+  Downsample_Stack_Slab(stack, wintv, hintv, dintv, method, 0, depth - 1,
+			out);
+
+  out->kind = stack->kind;
+  out->width = width;
+  out->height = height;
+  out->depth = depth;
 
+  return out;
+}
+
+Stack* Downsample_Stack(const Stack* stack,int wintv,int hintv,int dintv)
+{
+  return downsample_stack(stack, wintv, hintv, dintv,
+			  STACK_DOWNSAMPLE_NEAREST, NULL);
+}
 
 //foreground blockmean
 #define DOWNSAMPLE_STACK_BLOCK_MEAN_F(stack_array, out_array, subwdith_t, subheight_t, subdepth_t, subarea_t, wndsize_t, validate_value) \
@@ -1537,35 +1692,6 @@ Stack* Downsample_Stack(const Stack* stack,int wintv,int hintv,int dintv)
   offset = old_offset + subwdith_t;\
 }
 
-#define DOWNSAMPLE_STACK_BLOCK_MEAN_C(stack_array, out_array, subwdith_t, subheight_t, subdepth_t, subarea_t, wndsize_t, validate_value) \
-  sc[0] = 0;								\
-  sc[1] = 0;								\
-  sc[2] = 0;								\
-  old_offset = offset;							\
-  for(rk=0;rk<subdepth_t;rk++) {					\
-    for(rj=0;rj<subheight_t;rj++) {					\
-      for(ri=0;ri<subwdith_t;ri++) {					\
-	/*printf("%d ", offset);*/					\
-	sc[0] += stack_array[offset][0];				\
-	sc[1] += stack_array[offset][1];				\
-	sc[2] += stack_array[offset][2];				\
-	offset++;							\
-      }									\
-      offset += width - subwdith_t;					\
-    }									\
-    offset += area - subheight_t * width;				\
-  }									\
-  for (c = 0; c < 3; c++) {						\
-    sc[c] /= wndsize_t;							\
-    validate_value(s);							\
-    out_array[offset2][c] = sc[c];					\
-  }									\
-  offset2++;								\
-  /*printf("\n");*/							\
-  /*printf("\n%d %d %d\n", old_offset, offset, wndsize_t);*/		\
-  offset = old_offset + subwdith_t;
-
-
 #define DOWNSAMPLE_STACK(stack_array, out_array, validate_value, downsample_stack_block_mean)	\
   for (k=0; k<kd; k++) {						\
     for (j=0; j<kh; j++) {						\
@@ -1632,79 +1758,19 @@ Stack* Downsample_Stack_Mean(Stack* stack,int wintv,int hintv,int dintv,
     if (stack2 == NULL) {
       return Copy_Stack(stack);
     } else {
-      stack2->kind = stack->kind;
-      stack2->width = stack->width;
-      stack2->height = stack->height;
-      stack2->depth = stack->depth;
-      Copy_Stack_Array(stack2, stack);
+      if (stack2 != stack) {
+	stack2->kind = stack->kind;
+	stack2->width = stack->width;
+	stack2->height = stack->height;
+	stack2->depth = stack->depth;
+	Copy_Stack_Array(stack2, stack);
+      }
+      return stack2;
     }
   }
 
-  int width = stack->width;
-  int height = stack->height;
-  size_t area = width * height;
-
-  size_t old_offset = 0;
-  size_t offset = 0;
-  size_t offset2 = 0;
-
-  int kw,kh,kd,rw,rh,rd;
-  int i,j,k,ri,rj,rk;
-  double s;
-  double sc[3];
-  int c;
-
-  kw = stack->width / (wintv+1);
-  kh = stack->height / (hintv+1);
-  kd = stack->depth / (dintv+1);
-
-  rw = stack->width % (wintv+1);
-  rh = stack->height % (hintv+1);
-  rd = stack->depth % (dintv+1);
-
-  int subwidth = wintv + 1;
-  int subheight = hintv + 1;
-  int subdepth = dintv + 1;
-
-  //int subarea = subwidth * subheight;
-  int wndsize = subwidth * subheight * subdepth;
-  
-  if (stack2 == NULL) {
-    stack2 = Make_Stack(stack->kind, kw + (rw>0), kh + (rh>0), 
-			kd + (rd>0));
-  }
-  
-  Image_Array ima;
-  ima.array = stack->array;
-  Image_Array out_ima;
-  out_ima.array = stack2->array;
-  
-  switch (stack->kind) {
-  case GREY:
-    DOWNSAMPLE_STACK(ima.array8, out_ima.array8, VALIDATE_INTENSITY_GREY, DOWNSAMPLE_STACK_BLOCK_MEAN);
-    break;
-  case GREY16:
-    DOWNSAMPLE_STACK(ima.array16, out_ima.array16, VALIDATE_INTENSITY_GREY16, DOWNSAMPLE_STACK_BLOCK_MEAN);
-    break;
-  case FLOAT32:
-    DOWNSAMPLE_STACK(ima.array32, out_ima.array32, VALIDATE_INTENSITY_FLOAT32, DOWNSAMPLE_STACK_BLOCK_MEAN);
-    break;
-  case FLOAT64:
-    DOWNSAMPLE_STACK(ima.array64, out_ima.array64, VALIDATE_INTENSITY_FLOAT64, DOWNSAMPLE_STACK_BLOCK_MEAN);
-    break;
-  case COLOR:
-    DOWNSAMPLE_STACK(ima.arrayc, out_ima.arrayc, VALIDATE_INTENSITY_COLOR, DOWNSAMPLE_STACK_BLOCK_MEAN_C);
-    break;
-  default:
-    TZ_ERROR(ERROR_DATA_TYPE);
-    break;
-  }
-
-  stack2->width = kw + (rw>0);
-  stack2->height = kh + (rh>0);
-  stack2->depth = kd + (rd>0);
-
-  return stack2;
+  return downsample_stack(stack, wintv, hintv, dintv, STACK_DOWNSAMPLE_MEAN,
+			  stack2);
 }
 
 Stack* Downsample_Stack_Mean_F(Stack* stack,int wintv,int hintv,int dintv, 
@@ -1936,257 +2002,190 @@ Stack* Downsample_Stack_Max(const Stack* stack,int wintv,int hintv,int dintv,
     return out;
   }
 
-  double s;
-  int kw,kh,kd,rw,rh,rd;
-  int i,j,k,ri,rj,rk;
-
-
-  if (wintv >= stack->width) {
-    wintv = stack->width - 1;
-  }
-  if (hintv >= stack->height) {
-    hintv = stack->height - 1;
-  }
-  if (dintv >= stack->depth) {
-    dintv = stack->depth - 1;
-  }
-
-  kw = stack->width / (wintv+1);
-  kh = stack->height / (hintv+1);
-  kd = stack->depth / (dintv+1);
-  rw = stack->width % (wintv+1);
-  rh = stack->height % (hintv+1);
-  rd = stack->depth % (dintv+1);
-
-  //Stack* stack2 = Make_Stack(stack->kind,kw+(rw>0),kh+(rh>0),kd+(rd>0));
-  if (out == NULL) {
-    out = Make_Stack(stack->kind,kw+(rw>0),kh+(rh>0),kd+(rd>0));
-  }
-  
-  for(k=0;k<kd;k++) {
-    for(j=0;j<kh;j++) {
-      for(i=0;i<kw;i++) {
-	s = 0;
-	for(rk=0;rk<=dintv;rk++)
-	  for(rj=0;rj<=hintv;rj++)
-	    for(ri=0;ri<=wintv;ri++)
-	      s = dmax2(s, Get_Stack_Pixel((Stack*) stack,i*(wintv+1)+ri,j*(hintv+1)+rj,k*(dintv+1)+rk,0));
-	Set_Stack_Pixel(out,i,j,k,0,s);
-      }
-      if(rw>0) {
-	s = 0;
-	for(rk=0;rk<=dintv;rk++)
-	  for(rj=0;rj<=hintv;rj++)
-	    for(ri=0;ri<rw;ri++)
-	      s = dmax2(s, Get_Stack_Pixel((Stack*) stack,kw*(wintv+1)+ri,j*(hintv+1)+rj,k*(dintv+1)+rk,0));
-	Set_Stack_Pixel(out,kw,j,k,0,s);
-      }
-    }
-    if(rh>0) {
-      for(i=0;i<kw;i++) {
-	s = 0;
-	for(rk=0;rk<=dintv;rk++)
-	  for(rj=0;rj<rh;rj++)
-	    for(ri=0;ri<=wintv;ri++)
-	      s = dmax2(s, Get_Stack_Pixel((Stack*) stack,i*(wintv+1)+ri,kh*(hintv+1)+rj,k*(dintv+1)+rk,0));
-	Set_Stack_Pixel(out,i,kh,k,0,s);
-      }
-      if(rw>0) {
-	s = 0;
-	for(rk=0;rk<=dintv;rk++)
-	  for(rj=0;rj<rh;rj++)
-	    for(ri=0;ri<rw;ri++)
-	      s = dmax2(s, Get_Stack_Pixel((Stack*) stack,kw*(wintv+1)+ri,kh*(hintv+1)+rj,k*(dintv+1)+rk,0));
-	Set_Stack_Pixel(out,kw,kh,k,0,s);
-      }
-    }
-    if(rd>0) {
-      for(j=0;j<kh;j++) {
-	for(i=0;i<kw;i++) {
-	  s = 0;
-	  for(rk=0;rk<rd;rk++)
-	    for(rj=0;rj<=hintv;rj++)
-	      for(ri=0;ri<=wintv;ri++)
-		s = dmax2(s, Get_Stack_Pixel((Stack*) stack,i*(wintv+1)+ri,j*(hintv+1)+rj,kd*(dintv+1)+rk,0));
-	  Set_Stack_Pixel(out,i,j,kd,0,s);
-	}
-	if(rw>0) {
-	  s = 0;
-	  for(rk=0;rk<rd;rk++)
-	    for(rj=0;rj<=hintv;rj++)
-	      for(ri=0;ri<rw;ri++)
-		s = dmax2(s, Get_Stack_Pixel((Stack*) stack,kw*(wintv+1)+ri,j*(hintv+1)+rj,rd*(dintv+1)+rk,0));
-	  Set_Stack_Pixel(out,kw,j,kd,0,s);
-	}
-      }
-      if(rh>0) {
-	for(i=0;i<kw;i++) {
-	  s = 0;
-	  for(rk=0;rk<rd;rk++)
-	    for(rj=0;rj<rh;rj++)
-	      for(ri=0;ri<=wintv;ri++)
-		s = dmax2(s, Get_Stack_Pixel((Stack*) stack,i*(wintv+1)+ri,kh*(hintv+1)+rj,kd*(dintv+1)+rk,0));
-	  Set_Stack_Pixel(out,i,kh,kd,0,s);
-	}
-	if(rw>0) {
-	  s = 0;
-	  for(rk=0;rk<rd;rk++)
-	    for(rj=0;rj<rh;rj++)
-	      for(ri=0;ri<rw;ri++)
-		s = dmax2(s, Get_Stack_Pixel((Stack*) stack,kw*(wintv+1)+ri,kh*(hintv+1)+rj,kd*(dintv+1)+rk,0));
-	  Set_Stack_Pixel(out,kw,kh,kd,0,s);
-	}
-      }
-    }
-  }
-
-  return out;
+  return downsample_stack(stack, wintv, hintv, dintv, STACK_DOWNSAMPLE_MAX,
+			  out);
 }
 
-#define UPSAMPLE_STACK(stack_array, out_array)				\
-  /* interpolate rows */						\
-  for (k = 0; k < stack->depth; k++) {					\
-    for (j = 0; j < stack->height; j++) {				\
-      for (i = 0; i < cwidth; i++) {					\
-	out_array[offset2++] = stack_array[offset];			\
-	step = stack_array[offset + 1];					\
-	step -= stack_array[offset];					\
-	step /= wintv + 1;						\
-	step2 = step;							\
-	for (u = 1; u <= wintv; u++) {					\
-	  out_array[offset2++] = stack_array[offset] + step;		\
-	  step += step2;						\
-	}								\
-	offset++;							\
-      }									\
-      									\
-      for (u = 0; u <= wintv; u++) {					\
-	out_array[offset2++] = stack_array[offset];			\
-      }									\
-      offset++;								\
-      offset2 += out->width * hintv;					\
+/* UPSAMPLE_STACK_LINES interpolates the <n> - 1 lines between the line at
+ * <start> and the one <n> * <stride> after it. Each line has <length> values.
+ */
+#define UPSAMPLE_STACK_LINES(out_array, start, length, stride, n)	\
+  for (i = 0; i < length; i++) {					\
+    offset2 = start + i;						\
+    offset3 = offset2 + stride;						\
+    step = out_array[offset2 + stride * n];				\
+    step -= out_array[offset2];						\
+    step /= n;								\
+    step2 = step;							\
+    for (u = 1; u < n; u++) {						\
+      out_array[offset3] = out_array[offset2] + step;			\
+      offset3 += stride;						\
+      step += step2;							\
     }									\
-    offset2 += out_area * dintv;					\
-  }									\
-  									\
-  offset = 0;								\
-  offset2 = 0;								\
-									\
-  /* interpolate columns */						\
-  if (hintv >= 1) {							\
-    for (k = 0; k < stack->depth; k++) {				\
-      for (j = 0; j < cheight; j++) {					\
-	for (i = 0; i < out->width; i++) {				\
-	  offset3 = offset2 + out->width;				\
-	  step = out_array[offset3 + out->width * hintv];		\
-	  step -= out_array[offset2];					\
-	  step /= hintv + 1;						\
-	  step2 = step;							\
-	  for (u = 1; u <= hintv; u++) {				\
-	    out_array[offset3] = out_array[offset2] + step;		\
-	    offset3 += out->width;					\
-	    step += step2;						\
+  }
+
+#define UPSAMPLE_STACK_PLANE(stack_array, out_array, nc)		\
+  for (k = k0; k <= k1; k++) {						\
+    /* interpolate rows */						\
+    for (j = 0; j < height; j++) {					\
+      for (c = 0; c < nc; c++) {					\
+	offset = ((size_t) k * height + j) * width * nc + c;		\
+	offset2 = ((size_t) k * subdepth * out_height + j * subheight) * \
+	  out_row + c;							\
+	for (i = 0; i + 1 < (size_t) width; i++) {			\
+	  out_array[offset2] = stack_array[offset];			\
+	  offset2 += nc;						\
+	  step = stack_array[offset + nc];				\
+	  step -= stack_array[offset];				\
+	  step /= subwidth;						\
+	  step2 = step;						\
+	  for (u = 1; u < subwidth; u++) {				\
+	    out_array[offset2] = stack_array[offset] + step;		\
+	    offset2 += nc;						\
+	    step += step2;					\
 	  }								\
-	  offset2++;							\
+	  offset += nc;							\
 	}								\
-	offset2 += out->width * hintv;					\
-      }									\
-    									\
-      offset3++;							\
-      for (u = 1; u <= hintv; u++) {					\
-	for (i = 0; i < out->width; i++) {				\
-	  out_array[offset3] = out_array[offset3 - out->width];		\
-	  offset3++;							\
+	for (u = 0; u < subwidth; u++) {				\
+	  out_array[offset2] = stack_array[offset];			\
+	  offset2 += nc;						\
 	}								\
       }									\
-      offset2 += out->width * (hintv + 1);				\
-      offset2 += out_area * dintv;					\
     }									\
-  }									\
-  									\
-  offset = 0;								\
-  offset2 =0;								\
-  offset3 = 0;								\
-  									\
-  /* interpolate slices */						\
-  if (dintv >= 1) {							\
-    for (k = 0; k < cdepth; k++) {					\
-      for (j = 0; j < out->height; j++) {				\
-	for (i = 0; i < out->width; i++) {				\
-	  offset3 = offset2 + out_area;					\
-	  step = out_array[offset3 + out_area * dintv];			\
-	  step -= out_array[offset2];					\
-	  step /= dintv + 1;						\
-	  step2 = step;							\
-	  for (u = 1; u <= dintv; u++) {				\
-	    out_array[offset3] = out_array[offset2] + step;		\
-	    offset3 += out_area;					\
-	    step += step2;						\
-	  }								\
-	  offset2++;							\
-	}								\
+									\
+    /* interpolate columns and repeat the last row */			\
+    if (subheight > 1) {						\
+      size_t plane_start = (size_t) k * subdepth * out_area;		\
+      for (j = 0; j < height - 1; j++) {				\
+	UPSAMPLE_STACK_LINES(out_array,					\
+			     plane_start + (size_t) j * subheight * out_row, \
+			     out_row, out_row, subheight);		\
+      }									\
+      offset = plane_start + (size_t) (height - 1) * subheight * out_row; \
+      for (u = 1; u < subheight; u++) {					\
+	memcpy(out_array + offset + out_row * u, out_array + offset,	\
+	       sizeof(out_array[0]) * out_row);				\
       }									\
-      offset2 += out_area * dintv;					\
     }									\
-  }									\
-  									\
-  offset3++;								\
-  for (u = 1; u <= dintv; u++) {					\
-    for (j = 0; j < out->height; j++) {					\
-      for (i = 0; i < out->width; i++) {				\
-	out_array[offset3] = out_array[offset3 - out_area];		\
-	offset3++;							\
+  }
+
+#define UPSAMPLE_STACK_DEPTH(out_array)					\
+  for (k = k0; k <= k1; k++) {						\
+    offset = (size_t) k * subdepth * out_area;				\
+    if (k < depth - 1) {						\
+      UPSAMPLE_STACK_LINES(out_array, offset, out_area, out_area, subdepth); \
+    } else {								\
+      for (u = 1; u < subdepth; u++) {					\
+	memcpy(out_array + offset + out_area * u, out_array + offset,	\
+	       sizeof(out_array[0]) * out_area);			\
       }									\
     }									\
   }
 
-Stack* Upsample_Stack(const Stack *stack, int wintv, int hintv, int dintv,
-		      Stack *out)
+/* upsample_stack_slab(): run the plane pass (<depth_pass> is 0) or the depth
+ * pass (<depth_pass> is 1) of upsampling on the slices from <k0> to <k1>.
+ */
+static void upsample_stack_slab(const Stack *stack, int wintv, int hintv,
+				int dintv, int k0, int k1, Stack *out,
+				int depth_pass)
 {
-  if (out == NULL) {
-    out = Make_Stack(stack->kind, stack->width * (wintv + 1),
-		     stack->height * (hintv + 1), stack->depth * (dintv + 1));
+  int width = stack->width;
+  int height = stack->height;
+  int depth = stack->depth;
+  int subwidth = wintv + 1;
+  int subheight = hintv + 1;
+  int subdepth = dintv + 1;
+  int out_width = width * subwidth;
+  int out_height = height * subheight;
+  int nc = (stack->kind == COLOR) ? 3 : 1;
+  size_t out_row = (size_t) out_width * nc;
+  size_t out_area = out_row * out_height;
+
+  if (k0 < 0) {
+    k0 = 0;
+  }
+  if (k1 >= depth) {
+    k1 = depth - 1;
   }
 
-  int i, j, k;
-  int offset = 0;
-  int offset2 = 0;
-  int u;
+  int j, k, c, u;
+  size_t i;
+  size_t offset, offset2, offset3;
+  double step, step2;
 
   Image_Array ima;
   ima.array = stack->array;
-
   Image_Array out_ima;
   out_ima.array = out->array;
 
-  int cwidth = stack->width - 1;
-  int cheight = stack->height - 1;
-  int cdepth = stack->depth - 1;
+  if (depth_pass) {
+    if (subdepth > 1) {
+      switch (stack->kind) {
+      case GREY:
+      case COLOR:
+	UPSAMPLE_STACK_DEPTH(out_ima.array8);
+	break;
+      case GREY16:
+	UPSAMPLE_STACK_DEPTH(out_ima.array16);
+	break;
+      case FLOAT32:
+	UPSAMPLE_STACK_DEPTH(out_ima.array32);
+	break;
+      case FLOAT64:
+	UPSAMPLE_STACK_DEPTH(out_ima.array64);
+	break;
+      default:
+	TZ_ERROR(ERROR_DATA_TYPE);
+	break;
+      }
+    }
+  } else {
+    switch (stack->kind) {
+    case GREY:
+      UPSAMPLE_STACK_PLANE(ima.array8, out_ima.array8, 1);
+      break;
+    case GREY16:
+      UPSAMPLE_STACK_PLANE(ima.array16, out_ima.array16, 1);
+      break;
+    case FLOAT32:
+      UPSAMPLE_STACK_PLANE(ima.array32, out_ima.array32, 1);
+      break;
+    case FLOAT64:
+      UPSAMPLE_STACK_PLANE(ima.array64, out_ima.array64, 1);
+      break;
+    case COLOR:
+      UPSAMPLE_STACK_PLANE(ima.array8, out_ima.array8, 3);
+      break;
+    default:
+      TZ_ERROR(ERROR_DATA_TYPE);
+      break;
+    }
+  }
+}
 
-  int out_area = out->width * out->height;
+void Upsample_Stack_Plane(const Stack *stack, int wintv, int hintv, int dintv,
+			  int k0, int k1, Stack *out)
+{
+  upsample_stack_slab(stack, wintv, hintv, dintv, k0, k1, out, 0);
+}
 
-  double step;
-  double step2;
-  int offset3 = 0;
+void Upsample_Stack_Depth(const Stack *stack, int wintv, int hintv, int dintv,
+			  int k0, int k1, Stack *out)
+{
+  upsample_stack_slab(stack, wintv, hintv, dintv, k0, k1, out, 1);
+}
 
-  switch (stack->kind) {
-  case GREY:
-    UPSAMPLE_STACK(ima.array8, out_ima.array8);
-    break;
-  case GREY16:
-    UPSAMPLE_STACK(ima.array16, out_ima.array16);
-    break;
-  case FLOAT32:
-    UPSAMPLE_STACK(ima.array32, out_ima.array32);
-    break;
-  case FLOAT64:
-    UPSAMPLE_STACK(ima.array64, out_ima.array64);
-    break;
-  default:
-    TZ_ERROR(ERROR_DATA_TYPE);
-    break;
+Stack* Upsample_Stack(const Stack *stack, int wintv, int hintv, int dintv,
+		      Stack *out)
+{
+  if (out == NULL) {
+    out = Make_Stack(stack->kind, stack->width * (wintv + 1),
+		     stack->height * (hintv + 1), stack->depth * (dintv + 1));
   }
-  
+
+  Upsample_Stack_Plane(stack, wintv, hintv, dintv, 0, stack->depth - 1, out);
+  Upsample_Stack_Depth(stack, wintv, hintv, dintv, 0, stack->depth - 1, out);
+
   return out;
 }
 
@@ -122,6 +122,17 @@ void Stack_Scale(Stack *stack, int c, double factor, double offset);
 
 void Stretch_Stack_Value(Stack *stack);
 void Stretch_Stack_Value_Q(Stack *stack, double q);
+
+/**@brief Stretching range of a stack.
+ *
+ * Stack_Stretch_Range_Q() computes the intensity range used by
+ * Stretch_Stack_Value_Q(). The result is stored in <min> and <max>.
+ * Stretch_Stack_Value_R() clips <stack> at <max> and stretches it with the
+ * range. Applying Stretch_Stack_Value_R() to each part of a stack with the
+ * range of the whole stack gives the same result as Stretch_Stack_Value_Q().
+ */
+void Stack_Stretch_Range_Q(const Stack *stack, double q, int *min, int *max);
+void Stretch_Stack_Value_R(Stack *stack, int min, int max);
 void Stack_Brighten_Bw(Stack *stack);
 void Stack_Brighten_Level(Stack *stack, int level);
 
@@ -149,6 +160,34 @@ Stack* Downsample_Stack_Max(const Stack* stack,int wintv,int hintv,int dintv,
 Stack* Upsample_Stack(const Stack *stack, int wintv, int hintv, int dintv,
 		      Stack *out);
 
+/**@brief Downsample a slab of a stack.
+ *
+ * Downsample_Stack_Slab() computes the slices from <k0> to <k1> (inclusive)
+ * of the result of Downsample_Stack(), Downsample_Stack_Mean() or
+ * Downsample_Stack_Max(), depending on <method>, and stores them in <out>,
+ * which must have the size given by Downsample_Stack_Max_Size() and the same
+ * kind as <stack>. Slabs that do not overlap can be computed in parallel. 
+ * <out> can be <stack> only when the slabs are computed in order from the
+ * first slice. GREY, GREY16, FLOAT32, FLOAT64 and COLOR are supported.
+ */
+void Downsample_Stack_Slab(const Stack *stack, int wintv, int hintv, int dintv,
+			   Stack_Downsample_Method_e method, int k0, int k1,
+			   Stack *out);
+
+/**@brief Upsample a slab of a stack.
+ *
+ * Upsampling is done in two passes. Upsample_Stack_Plane() interpolates the 
+ * slices from <k0> to <k1> of <stack> in the XY plane and stores them in their
+ * slices of <out>. After all slices are done, Upsample_Stack_Depth() 
+ * interpolates the slices of <out> between the slice <k> and <k>+1 of <stack>
+ * for each <k> from <k0> to <k1>. Slabs in the same pass can be computed in
+ * parallel. <out> must have the size of the result of Upsample_Stack().
+ */
+void Upsample_Stack_Plane(const Stack *stack, int wintv, int hintv, int dintv,
+			  int k0, int k1, Stack *out);
+void Upsample_Stack_Depth(const Stack *stack, int wintv, int hintv, int dintv,
+			  int k0, int k1, Stack *out);
+
 /*
  * Resample_Stack_Depth() resamples a stack along Z-axis with the interval
  * <dintv>. The result is stored in <dst> if it is not NULL and the return
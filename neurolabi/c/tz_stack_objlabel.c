@@ -563,61 +563,349 @@ int Stack_Label_Object_Dist_N(Stack *stack, IMatrix *chord, int seed,
   return obj_size;  
 }
 
-int Stack_Label_Objects_N(Stack *stack, IMatrix *chord, 
-			  int flag, int label, int n_nbr)
+#define STACK_LABEL_COMPONENTS_IS_FLAG(stack, i, flag)		\
+  ((stack)->kind == GREY ? (stack)->array[i] == (flag) :	\
+   ((uint16_t*) (stack)->array)[i] == (flag))
+
+static int stack_label_components_root(int *label, int index)
 {
-  TZ_ASSERT(label > flag, "Invalid label");
+  while (label[index] != index) {
+    label[index] = label[label[index]];
+    index = label[index];
+  }
 
-  int start_label = label;
+  return index;
+}
 
-  BOOL is_owner = FALSE;
+static void stack_label_components_union(int *label, int i, int j)
+{
+  i = stack_label_components_root(label, i);
+  j = stack_label_components_root(label, j);
+  /* The smaller index is always the root to keep the result independent of
+   * the order of merging. */
+  if (i < j) {
+    label[j] = i;
+  } else if (j < i) {
+    label[i] = j;
+  }
+}
 
-  STACK_OBJLABEL_CHECK_CHORD(stack, chord, is_owner);
+void Stack_Label_Components(const Stack *stack, int flag, int n_nbr,
+			    int z0, int z1, int *label)
+{
+  TZ_ASSERT(stack->kind == GREY || stack->kind == GREY16, 
+	    "Unsupported kind.");
 
-  int nvoxel = Stack_Voxel_Number(stack);
+  int width = stack->width;
+  int height = stack->height;
+
+  if (z0 < 0) {
+    z0 = 0;
+  }
+  if (z1 >= stack->depth) {
+    z1 = stack->depth - 1;
+  }
+
+  int neighbors[26];
+  Stack_Neighbor_Offset(n_nbr, width, height, neighbors);
+  const int *x_offset = Stack_Neighbor_X_Offset(n_nbr);
+  const int *y_offset = Stack_Neighbor_Y_Offset(n_nbr);
+  const int *z_offset = Stack_Neighbor_Z_Offset(n_nbr);
+
+  /* Only the neighbors scanned before need to be checked. When the previous
+   * voxel in the row is labeled, the neighbors that are also its neighbors
+   * are in its component already and can be skipped. */
+  int backward[13];
+  int nbackward = 0;
+  int reduced[13];
+  int nreduced = 0;
+  int j, k;
+  for (j = 0; j < n_nbr; j++) {
+    if (neighbors[j] < 0) {
+      backward[nbackward++] = j;
+      BOOL is_shared = FALSE;
+      for (k = 0; k < n_nbr; k++) {
+	if (x_offset[k] == x_offset[j] + 1 && y_offset[k] == y_offset[j] &&
+	    z_offset[k] == z_offset[j]) {
+	  is_shared = TRUE;
+	  break;
+	}
+      }
+      if (is_shared == FALSE && 
+	  !(x_offset[j] == -1 && y_offset[j] == 0 && z_offset[j] == 0)) {
+	reduced[nreduced++] = j;
+      }
+    }
+  }
+
+  int x, y, z;
+  int i = z0 * width * height;
+  for (z = z0; z <= z1; z++) {
+    for (y = 0; y < height; y++) {
+      for (x = 0; x < width; x++) {
+	if (STACK_LABEL_COMPONENTS_IS_FLAG(stack, i, flag)) {
+	  /* The root of the current voxel is tracked locally, so each 
+	   * neighbor costs only one search. */
+	  int root = -1;
+	  const int *nbr_list = backward;
+	  int nnbr = nbackward;
+	  if (x > 0 && label[i - 1] >= 0) {
+	    root = stack_label_components_root(label, i - 1);
+	    nbr_list = reduced;
+	    nnbr = nreduced;
+	  }
+	  BOOL is_inner = (x > 0 && x < width - 1 && y > 0 && y < height - 1 &&
+			   z > z0);
+	  for (k = 0; k < nnbr; k++) {
+	    j = nbr_list[k];
+	    if (is_inner == FALSE) {
+	      int nx = x + x_offset[j];
+	      int ny = y + y_offset[j];
+	      if (nx < 0 || nx >= width || ny < 0 || ny >= height || 
+		  z + z_offset[j] < z0) {
+		continue;
+	      }
+	    }
+	    int nbr = i + neighbors[j];
+	    if (label[nbr] >= 0) {
+	      int r = stack_label_components_root(label, nbr);
+	      if (root < 0) {
+		root = r;
+	      } else if (r < root) {
+		label[root] = r;
+		root = r;
+	      } else if (r > root) {
+		label[r] = root;
+	      }
+	    }
+	  }
+	  label[i] = (root < 0) ? i : root;
+	} else {
+	  label[i] = -1;
+	}
+	i++;
+      }
+    }
+  }
+}
+
+void Stack_Label_Components_Merge(const Stack *stack, int n_nbr, int z, 
+				  int *label)
+{
+  int width = stack->width;
+  int height = stack->height;
+
+  if (z <= 0 || z >= stack->depth) {
+    return;
+  }
+
+  int neighbors[26];
+  Stack_Neighbor_Offset(n_nbr, width, height, neighbors);
+  const int *x_offset = Stack_Neighbor_X_Offset(n_nbr);
+  const int *y_offset = Stack_Neighbor_Y_Offset(n_nbr);
+  const int *z_offset = Stack_Neighbor_Z_Offset(n_nbr);
+
+  int x, y, j;
+  int i = z * width * height;
+  for (y = 0; y < height; y++) {
+    for (x = 0; x < width; x++) {
+      if (label[i] >= 0) {
+	for (j = 0; j < n_nbr; j++) {
+	  if (z_offset[j] < 0) {
+	    int nx = x + x_offset[j];
+	    int ny = y + y_offset[j];
+	    if (nx >= 0 && nx < width && ny >= 0 && ny < height) {
+	      int nbr = i + neighbors[j];
+	      if (label[nbr] >= 0) {
+		stack_label_components_union(label, i, nbr);
+	      }
+	    }
+	  }
+	}
+      }
+      i++;
+    }
+  }
+}
+
+int Stack_Label_Components_Resolve(const Stack *stack, int *label, 
+				   Objlabel_Stat **stat)
+{
   int nobj = 0;
-  int i;
+  int capacity = 0;
+  Objlabel_Stat *stat_array = NULL;
 
-  Objlabel_Workspace ow;
-  Default_Objlabel_Workspace(&ow);
-  ow.conn = n_nbr;
-  ow.chord = chord;
-  ow.init_chord = FALSE;
-  
-  for (i = 0; i < nvoxel; i++) {
-    ow.chord->array[i] = -1;
+  /* A parent always has a smaller index than its child, so it has been 
+   * replaced by its label when the child is visited, while the element of the
+   * child itself is still the index of its parent. */
+  int x, y, z;
+  int i = 0;
+  for (z = 0; z < stack->depth; z++) {
+    for (y = 0; y < stack->height; y++) {
+      for (x = 0; x < stack->width; x++) {
+	int parent = label[i];
+	if (parent < 0) {
+	  label[i] = 0;
+	} else if (parent == i) {
+	  label[i] = ++nobj;
+	  if (stat != NULL) {
+	    if (nobj > capacity) {
+	      capacity = capacity * 2 + 256;
+	      stat_array = (Objlabel_Stat*) 
+		Guarded_Realloc(stat_array, sizeof(Objlabel_Stat) * capacity,
+				"Stack_Label_Components_Resolve");
+	    }
+	    Objlabel_Stat *s = stat_array + nobj - 1;
+	    s->size = 1;
+	    s->first_corner[0] = s->last_corner[0] = x;
+	    s->first_corner[1] = s->last_corner[1] = y;
+	    s->first_corner[2] = s->last_corner[2] = z;
+	  }
+	} else {
+	  label[i] = label[parent];
+	  if (stat != NULL) {
+	    Objlabel_Stat *s = stat_array + label[i] - 1;
+	    s->size++;
+	    if (x < s->first_corner[0]) {
+	      s->first_corner[0] = x;
+	    } else if (x > s->last_corner[0]) {
+	      s->last_corner[0] = x;
+	    }
+	    if (y < s->first_corner[1]) {
+	      s->first_corner[1] = y;
+	    } else if (y > s->last_corner[1]) {
+	      s->last_corner[1] = y;
+	    }
+	    s->last_corner[2] = z;
+	  }
+	}
+	i++;
+      }
+    }
   }
 
-  PROGRESS_BEGIN("Labeling object");
-  uint16_t *array16 = (uint16_t*) stack->array;
-  uint8_t *array8 = (uint8_t*) stack->array;
-  for (i = 0; i < nvoxel; i++) {
-    BOOL is_flag = FALSE;
-    if (stack->kind == GREY) {
-      is_flag = (array8[i] == flag);
+  if (stat != NULL) {
+    *stat = stat_array;
+  }
+
+  return nobj;
+}
+
+void Stack_Label_Objects_L(Stack *stack, const int *component, int nobj,
+			   int label)
+{
+  if (nobj == 0) {
+    return;
+  }
+
+  /* Same labels as the sequential flooding, which restarts from the first 
+   * label after 65535. */
+  int *label_map = iarray_malloc(nobj + 1);
+  int start_label = label;
+  BOOL is_16bit = FALSE;
+  int k;
+  for (k = 1; k <= nobj; k++) {
+    if (label > 255) {
+      is_16bit = TRUE;
+    }
+    label_map[k] = label;
+    label++;
+    if (label > 65535) {
+      label = start_label;
+    }
+  }
+
+  if (is_16bit && stack->kind == GREY) {
+    Translate_Stack(stack, GREY16, 1);
+  }
+
+  size_t nvoxel = Stack_Voxel_Number(stack);
+  size_t i;
+  if (stack->kind == GREY) {
+    for (i = 0; i < nvoxel; i++) {
+      if (component[i] > 0) {
+	stack->array[i] = label_map[component[i]];
+      }
+    }
+  } else {
+    uint16_t *array16 = (uint16_t*) stack->array;
+    for (i = 0; i < nvoxel; i++) {
+      if (component[i] > 0) {
+	array16[i] = label_map[component[i]];
+      }
+    }
+  }
+
+  free(label_map);
+}
+
+int Stack_Label_Large_Objects_L(Stack *stack, const int *component, 
+				const Objlabel_Stat *stat, int nobj,
+				int label, int minsize, int max_label)
+{
+  int small_label = label;
+  int large_label = small_label + 1;
+  int large_object_number = 0;
+
+  int *label_map = iarray_malloc(nobj + 1);
+  BOOL is_16bit = FALSE;
+  int k;
+  for (k = 1; k <= nobj; k++) {
+    if (large_label > 255) {
+      is_16bit = TRUE;
+    }
+    if (stat[k - 1].size < minsize) {
+      label_map[k] = small_label;
     } else {
-      is_flag = (array16[i] == flag);
+      label_map[k] = large_label;
+      large_object_number++;
+      large_label++;
+      if (large_label > max_label) {
+	large_label = small_label + 1;
+      }
     }
+  }
 
-    if (is_flag == TRUE) {
-      if (label > 255) {
-        if (stack->kind == GREY) {
-          Translate_Stack(stack, GREY16, 1);
-          array16 = (uint16_t*) stack->array;
-        }
+  if (is_16bit && stack->kind == GREY) {
+    Translate_Stack(stack, GREY16, 1);
+  }
+
+  size_t nvoxel = Stack_Voxel_Number(stack);
+  size_t i;
+  if (stack->kind == GREY) {
+    for (i = 0; i < nvoxel; i++) {
+      if (component[i] > 0) {
+	stack->array[i] = label_map[component[i]];
       }
-      PROGRESS_STATUS(i / (nvoxel / 100 + 1));
-      Stack_Label_Object_W(stack, i, flag, label, &ow);
-      label++;
-      if (label > 65535) {
-        TZ_WARN(ERROR_DATA_VALUE);
-        label = start_label;
+    }
+  } else {
+    uint16_t *array16 = (uint16_t*) stack->array;
+    for (i = 0; i < nvoxel; i++) {
+      if (component[i] > 0) {
+	array16[i] = label_map[component[i]];
       }
-      nobj++;
-      PROGRESS_REFRESH;
     }
   }
-  PROGRESS_END("done");
+
+  free(label_map);
+
+  return large_object_number;
+}
+
+int Stack_Label_Objects_N(Stack *stack, IMatrix *chord, 
+			  int flag, int label, int n_nbr)
+{
+  TZ_ASSERT(label > flag, "Invalid label");
+
+  BOOL is_owner = FALSE;
+
+  STACK_OBJLABEL_CHECK_CHORD(stack, chord, is_owner);
+
+  /* <chord> holds the component forest and then the label field */
+  Stack_Label_Components(stack, flag, n_nbr, 0, stack->depth - 1, 
+			 chord->array);
+  int nobj = Stack_Label_Components_Resolve(stack, chord->array, NULL);
+  Stack_Label_Objects_L(stack, chord->array, nobj, label);
 
   if (is_owner == TRUE) {
     Kill_IMatrix(chord);
@@ -636,31 +924,26 @@ int Stack_Label_Objects_Ns(Stack *stack, IMatrix *chord,
 
   STACK_OBJLABEL_CHECK_CHORD(stack, chord, is_owner);
 
-  int nvoxel = Stack_Voxel_Number(stack);
-  int nobj = 0;
-  int i;
-
-  Objlabel_Workspace ow;
-  Default_Objlabel_Workspace(&ow);
-  ow.conn = n_nbr;
-  ow.chord = chord;
-  ow.init_chord = FALSE;
-  
-  for (i = 0; i < nvoxel; i++) {
-    ow.chord->array[i] = -1;
-  }
+  Stack_Label_Components(stack, flag, n_nbr, 0, stack->depth - 1, 
+			 chord->array);
+  int nobj = Stack_Label_Components_Resolve(stack, chord->array, NULL);
 
-  PROGRESS_BEGIN("Labeling object");
+  /* Components are numbered in the order of their first voxels, which are 
+   * labeled as <slabel>. */
+  int next = 1;
+  size_t nvoxel = Stack_Voxel_Number(stack);
+  size_t i;
   for (i = 0; i < nvoxel; i++) {
-    if (stack->array[i] == flag) {
-      PROGRESS_STATUS(i / (nvoxel / 100 + 1));
-      Stack_Label_Object_W(stack, i, flag, label, &ow);
-      nobj++;
-      stack->array[i] = slabel;
-      PROGRESS_REFRESH;
+    int component = chord->array[i];
+    if (component > 0) {
+      if (component == next) {
+	stack->array[i] = slabel;
+	next++;
+      } else {
+	stack->array[i] = label;
+      }
     }
   }
-  PROGRESS_END("done");
 
   if (is_owner == TRUE) {
     Kill_IMatrix(chord);
@@ -669,19 +952,39 @@ int Stack_Label_Objects_Ns(Stack *stack, IMatrix *chord,
   return nobj;
 }
 
+static int stack_label_large_objects_c(Stack *stack, IMatrix *chord, 
+				       int flag, int label, int minsize,
+				       int n_nbr, int max_label)
+{
+  TZ_ASSERT(label > flag, "label too small");
+
+  BOOL is_owner = FALSE;
+
+  STACK_OBJLABEL_CHECK_CHORD(stack, chord, is_owner);
+
+  Objlabel_Stat *stat = NULL;
+  Stack_Label_Components(stack, flag, n_nbr, 0, stack->depth - 1, 
+			 chord->array);
+  int nobj = Stack_Label_Components_Resolve(stack, chord->array, &stat);
+  int nlarge = Stack_Label_Large_Objects_L(stack, chord->array, stat, nobj,
+					   label, minsize, max_label);
+  free(stat);
+
+  if (is_owner == TRUE) {
+    Kill_IMatrix(chord);
+  }
+
+  return nlarge;
+}
+
 int Stack_Label_Large_Objects_N(Stack *stack, IMatrix *chord, 
 				int flag, int label, int minsize,
 				int n_nbr)
 {
   TZ_ASSERT(stack->kind == GREY, "GREY stack required.");
 
-  Objlabel_Workspace ow;
-  Default_Objlabel_Workspace(&ow);
-  ow.conn = n_nbr;
-  ow.chord = chord;
-  ow.init_chord = TRUE;
-
-  return Stack_Label_Large_Objects_W(stack, flag, label, minsize, &ow);  
+  return stack_label_large_objects_c(stack, chord, flag, label, minsize, 
+				     n_nbr, 65535);
 }
 
 int Stack_Label_Large_Objects_G(Stack *stack, IMatrix *chord,
@@ -690,14 +993,8 @@ int Stack_Label_Large_Objects_G(Stack *stack, IMatrix *chord,
 {
   TZ_ASSERT(stack->kind == GREY, "GREY stack required.");
 
-  Objlabel_Workspace ow;
-  Default_Objlabel_Workspace(&ow);
-  ow.conn = n_nbr;
-  ow.max_label = 255;
-  ow.chord = chord;
-  ow.init_chord = TRUE;
-
-  return Stack_Label_Large_Objects_W(stack, flag, label, minsize, &ow);
+  return stack_label_large_objects_c(stack, chord, flag, label, minsize, 
+				     n_nbr, 255);
 }
 
 int Stack_Label_Largest_Object_N(Stack *stack, IMatrix *chord, 
@@ -57,6 +57,14 @@ typedef struct _Objlabel_Workspace {
     }								\
   }
 
+/**@brief Statistics of a labeled object.
+ */
+typedef struct _Objlabel_Stat {
+  int size;             /**< number of voxels */
+  int first_corner[3];  /**< first corner of the bounding box */
+  int last_corner[3];   /**< last corner of the bounding box */
+} Objlabel_Stat;
+
 Objlabel_Workspace *New_Objlabel_Workspace();
 void Default_Objlabel_Workspace(Objlabel_Workspace *ow);
 void Delete_Objlabel_Workspace(Objlabel_Workspace *ow);
@@ -172,6 +180,65 @@ int Stack_Label_Largest_Object_N(Stack *stack, IMatrix *chord,
 
 void Stack_Grow_Object_S(Stack *seed, Stack *mask, Objlabel_Workspace *ow);
 
+/**@brief Label connected components in a slab.
+ *
+ * Stack_Label_Components() finds the connected components of the voxels with
+ * the value <flag> between the slices <z0> and <z1> (inclusive) under the
+ * <n_nbr> neighborhood system. The components are stored as a union-find
+ * forest in <label>, which has the same number of elements as <stack>:
+ * <label[i]> is -1 if the voxel i is not <flag>, or the index of its parent
+ * otherwise. The root of a component is always its voxel of the smallest
+ * index. Slabs that do not overlap can be labeled in parallel, and
+ * Stack_Label_Components_Merge() should then be called for the first slice of
+ * each slab to join them. <stack> must be GREY or GREY16.
+ */
+void Stack_Label_Components(const Stack *stack, int flag, int n_nbr,
+			    int z0, int z1, int *label);
+
+/**@brief Join the components across a slab seam.
+ *
+ * Stack_Label_Components_Merge() joins the components on slice <z> with the
+ * adjacent components on slice <z>-1. The result does not depend on how the
+ * stack is split into slabs.
+ */
+void Stack_Label_Components_Merge(const Stack *stack, int n_nbr, int z, 
+				  int *label);
+
+/**@brief Turn a component forest into a label field.
+ *
+ * Stack_Label_Components_Resolve() replaces each element of the forest 
+ * <label> built for <stack> with the label of its component, which is 0 for
+ * background and 1, 2, ... for the components in the order of their first 
+ * voxels. It returns the number of components. If <stat> is not NULL, 
+ * <*stat> is set to a newly allocated array of the size and bounding box of 
+ * each component, with the statistics of label k at <(*stat)[k-1]>. The array
+ * should be freed by free().
+ */
+int Stack_Label_Components_Resolve(const Stack *stack, int *label, 
+				   Objlabel_Stat **stat);
+
+/**@brief Label objects by a label field.
+ *
+ * Stack_Label_Objects_L() labels the voxels of the <nobj> components in
+ * <component>, which is the result of Stack_Label_Components_Resolve(), in
+ * the same way as Stack_Label_Objects_N() does. The stack is turned into
+ * GREY16 if a label is greater than 255.
+ */
+void Stack_Label_Objects_L(Stack *stack, const int *component, int nobj,
+			   int label);
+
+/**@brief Label large objects by a label field.
+ *
+ * Stack_Label_Large_Objects_L() labels the voxels of the <nobj> components
+ * in <component> in the same way as Stack_Label_Large_Objects_N() does, 
+ * except that large labels restart from <label> + 1 after <max_label>. 
+ * <stat> is the component statistics from Stack_Label_Components_Resolve().
+ * It returns the number of large objects.
+ */
+int Stack_Label_Large_Objects_L(Stack *stack, const int *component, 
+				const Objlabel_Stat *stat, int nobj,
+				int label, int minsize, int max_label);
+
 /**@brief Extract region borders of a stack
  *
  * A pixel is a region pixel iff it has a neighbor with a different intensity 
@@ -837,92 +837,76 @@ void Stack_Watershed_Zgap_Barrier(const Stack *stack, Stack *mask)
 
 #define STACK_WATERSHED_UNLABELED(i) (out->array[i] == 0)
 
-#define STACK_WATERSHED_ENQUEUE(level, i)	\
-  if (queue_head[level] == -1) {		\
-    queue_head[level] = i;			\
-    queue_tail[level] = i;			\
-  } else {					\
-    level_queue[queue_tail[level]] = i;		\
-    queue_tail[level] = i;			\
+/* The queue of level l is stored at index l - min_level of queue_head and
+ * queue_tail. The link of a voxel is reset when it is enqueued so that
+ * different floodings can share the same link array without initializing it.
+ */
+#define STACK_WATERSHED_ENQUEUE(level, i)		\
+  level_queue[i] = -1;					\
+  if (queue_head[(level) - min_level] == -1) {		\
+    queue_head[(level) - min_level] = i;		\
+    queue_tail[(level) - min_level] = i;		\
+  } else {						\
+    level_queue[queue_tail[(level) - min_level]] = i;	\
+    queue_tail[(level) - min_level] = i;		\
   }
 
-#define STACK_WATERSHED_DEQUEUE(level, v)	\
-  v = queue_head[level];			\
-  if (v >= 0) {					\
-    queue_head[level] = level_queue[v];		\
-    if (queue_head[level] == -1) {		\
-      queue_tail[level] = -1;			\
-    }						\
+#define STACK_WATERSHED_DEQUEUE(level, v)			\
+  v = queue_head[(level) - min_level];				\
+  if (v >= 0) {							\
+    queue_head[(level) - min_level] = level_queue[v];		\
+    if (queue_head[(level) - min_level] == -1) {		\
+      queue_tail[(level) - min_level] = -1;			\
+    }								\
   }
 
-Stack* Stack_Watershed(const Stack *stack, Stack_Watershed_Workspace *ws)
+/* Flood <out> from the <nseed> seeds indexed by <seed>, which must be in
+ * ascending order. <out> must have been zeroed in the voxels that can be
+ * reached from the seeds. <ws->array> is used as the queue and only the
+ * entries of the flooded voxels are modified. */
+static void stack_watershed_flood(const Stack *stack,
+				  Stack_Watershed_Workspace *ws,
+				  const int *seed, int nseed, Stack *out)
 {
-  if (ws->mask == NULL) {
-    return NULL;
-  }
-
-  int width = stack->width;
-  int height = stack->height;
-  int depth = stack->depth;
+  int min_level = ws->min_level;
+  int water_level = ws->start_level;
+  int *level_queue = ws->array;
+  int i, j;
 
-  if (width == 1 && height == 1 && depth == 1) {
-    return NULL;
+  for (i = 0; i < nseed; i++) {
+    out->array[seed[i]] = ws->mask->array[seed[i]];
   }
 
-  Stack *out = Make_Stack(GREY, width, height, depth);
-  Zero_Stack(out);
-  
-  size_t nvoxel = Stack_Voxel_Number(stack);
-
-  int is_in_bound[26];
-  int neighbors[26];
-  Stack_Neighbor_Offset(ws->conn, Stack_Width(stack), Stack_Height(stack), 
-			neighbors);			
-
-  int i;
-  
-  int max_level = 65535;
-  //int queue_head[65536];
-  //int queue_tail[65536];
+  if (water_level < min_level) {
+    return;
+  }
 
-  int *queue_head = iarray_malloc(max_level + 1);
-  int *queue_tail = iarray_malloc(max_level + 1);
+  int nlevel = water_level - min_level + 1;
+  int *queue_head = iarray_malloc(nlevel);
+  int *queue_tail = iarray_malloc(nlevel);
 
-  for (i = 0; i <= max_level; i++) {
+  for (i = 0; i < nlevel; i++) {
     queue_head[i] = -1;
     queue_tail[i] = -1;
   }
 
-  int j;
-
-  for (i = 0; i < nvoxel; i++) {
-    ws->array[i] = -1;
-  }
-
-  int water_level = ws->start_level;
-  int nseed = 0;
-  int *level_queue = ws->array;
+  int is_in_bound[26];
+  int neighbors[26];
+  Stack_Neighbor_Offset(ws->conn, Stack_Width(stack), Stack_Height(stack), 
+			neighbors);			
 
-  for (i = 0; i < nvoxel; i++) {
-    /* If the voxel is an aviable seed */
-    if (STACK_WATERSHED_IS_SEED(ws->mask, i)) {
-      int basin = ws->mask->array[i];
-      if (nseed < basin) {
-	nseed = basin;
-      }
-      out->array[i] = basin;
-      int level = (int) Stack_Array_Value(stack, i);
-      if (level >= water_level) {
-	STACK_WATERSHED_ENQUEUE(water_level, i);
-      } else {
-	STACK_WATERSHED_ENQUEUE(level, i);
-      }
+  for (i = 0; i < nseed; i++) {
+    int level = (int) Stack_Array_Value(stack, seed[i]);
+    if (level >= water_level) {
+      STACK_WATERSHED_ENQUEUE(water_level, seed[i]);
+    } else if (level >= min_level) {
+      /* a seed below the minimal level is labeled but never flooded */
+      STACK_WATERSHED_ENQUEUE(level, seed[i]);
     }
   }
 
-
   /* Now start watershed. */
-  while (water_level >= ws->min_level) {
+  while (water_level >= min_level) {
 #ifdef _DEBUG_2
     printf("water level: %d\n", water_level);
 #endif
@@ -947,7 +931,7 @@ Stack* Stack_Watershed(const Stack *stack, Stack_Watershed_Workspace *ws)
 	} else {							\
 	  level = iround(Stack_Array_Value(stack, nbr) * ws->weights[j]); \
 	}								\
-	if (level >= ws->min_level) {					\
+	if (level >= min_level) {					\
 	  if (level >= water_level) {					\
 	    STACK_WATERSHED_ENQUEUE(water_level, nbr);			\
 	    out->array[nbr] = basin;					\
@@ -979,6 +963,46 @@ Stack* Stack_Watershed(const Stack *stack, Stack_Watershed_Workspace *ws)
 
   free(queue_head);
   free(queue_tail);
+}
+
+Stack* Stack_Watershed(const Stack *stack, Stack_Watershed_Workspace *ws)
+{
+  if (ws->mask == NULL) {
+    return NULL;
+  }
+
+  int width = stack->width;
+  int height = stack->height;
+  int depth = stack->depth;
+
+  if (width == 1 && height == 1 && depth == 1) {
+    return NULL;
+  }
+
+  Stack *out = Make_Stack(GREY, width, height, depth);
+  Zero_Stack(out);
+  
+  size_t nvoxel = Stack_Voxel_Number(stack);
+
+  size_t i;
+  int nseed = 0;
+  for (i = 0; i < nvoxel; i++) {
+    if (STACK_WATERSHED_IS_SEED(ws->mask, i)) {
+      nseed++;
+    }
+  }
+
+  int *seed = iarray_malloc(nseed);
+  nseed = 0;
+  for (i = 0; i < nvoxel; i++) {
+    if (STACK_WATERSHED_IS_SEED(ws->mask, i)) {
+      seed[nseed++] = (int) i;
+    }
+  }
+
+  stack_watershed_flood(stack, ws, seed, nseed, out);
+
+  free(seed);
 
   return out;
 }
@@ -84,7 +84,10 @@ void Stack_Watershed_Zgap_Barrier(const Stack *stack, Stack *mask);
 
 /**@brief 3D seeded watershed.
  *
- * Current version only supports 8 bit or 16 bit stack. 
+ * Stack_Watershed() supports 8-bit, 16-bit and 32-bit stacks. The levels of
+ * flooding range from <ws->min_level> to <ws->start_level>, and a voxel with
+ * a higher value is flooded at the start level. A 32-bit value is truncated
+ * to an integer level.
 */
 Stack* Stack_Watershed(const Stack *stack, Stack_Watershed_Workspace *ws);
 
@@ -0,0 +1,260 @@
+/* tz_arraylist.c.t
+ *
+ * 15-Feb-2008 Initial write: Ting Zhao
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "tz_error.h"
+#include "tz_utilities.h"
+#include "tz_swc_arraylist.h"
+
+INIT_EXCEPTION
+
+const static int Growth_Coeff = 2; /* growth factor */
+
+/* swc_arraylist_grow(): Grow an arraylist.
+ *
+ * Args: a - the arraylist to grow.
+ *
+ * Return: void.
+ */
+static void swc_arraylist_grow(Swc_Arraylist *a)
+{
+  if (a->capacity == 0) {
+    a->capacity = Growth_Coeff;
+    a->array = (Swc_Node *) Guarded_Malloc(sizeof(Swc_Node) * a->capacity, 
+				       "swc_arraylist_grow");
+  } else {
+    int new_capacity = Growth_Coeff * a->capacity;
+  
+    Swc_Node *new_array = (Swc_Node *) Guarded_Calloc(new_capacity, sizeof(Swc_Node),
+					      "swc_arraylist_grow");
+    memcpy(new_array, a->array, sizeof(Swc_Node) * a->capacity);
+    free(a->array);
+    a->array = new_array;
+    a->capacity = new_capacity;
+  }
+}
+
+/* Print_Swc_Arraylist(): Prints an array list.
+ * 
+ * Args: a - the arraylist to print.
+ *       format - printing format. This is mainly for priliminary data elements.
+ *
+ * Return: void.
+ */
+void Print_Swc_Arraylist(const Swc_Arraylist *a)
+{
+  int i;
+  printf("%d elements: ", a->length);
+  for  (i = 0; i < a->length; i++) {
+    Print_Swc_Node(a->array + i);
+  }
+  
+  printf("\n");
+}
+
+Swc_Arraylist* New_Swc_Arraylist()
+{
+  return Swc_Arraylist_New(0, 1);
+}
+
+/* Swc_Arraylist_New(): New an arraylist.
+ * 
+ * Args: length - length of the arraylist;
+ *       margin - margin of the arraylist. This means the capacity of the
+ *                arraylist will be <length> + <margin>.
+ * 
+ * Return: a new arraylist.
+ */
+Swc_Arraylist* Swc_Arraylist_New(int length, int margin)
+{
+  if ((length < 0) || margin < 0) {
+    TZ_WARN(ERROR_DATA_VALUE);
+    return NULL;
+  }
+
+  Swc_Arraylist *a = (Swc_Arraylist *) Guarded_Malloc(sizeof(Swc_Arraylist), 
+							"Swc_Arraylist_New");
+  a->length = length;
+  a->capacity = length + margin;
+  if (a->capacity > 0) {
+    a->array = (Swc_Node *) Guarded_Malloc(sizeof(Swc_Node) * a->capacity, 
+				       "Swc_Arraylist_New");
+  } else {
+    a->array = NULL;
+  }
+
+  return a;
+}
+
+/* Swc_Arraylist_Free(): Free an array list.
+ *
+ * Args: a - the array list to free.
+ *
+ * Return: void.
+ */
+void Swc_Arraylist_Free(Swc_Arraylist *a)
+{
+  free(a->array);
+  free(a);
+}
+
+Swc_Arraylist* Make_Swc_Arraylist(int length, int margin)
+{
+  if ((length < 0) || margin < 0) {
+    TZ_WARN(ERROR_DATA_VALUE);
+    return NULL;
+  }
+
+  Swc_Arraylist *a = (Swc_Arraylist *) Guarded_Malloc(sizeof(Swc_Arraylist), 
+							"Swc_Arraylist_New");
+  a->length = length;
+  a->capacity = length + margin;
+  if (a->capacity > 0) {
+    a->array = (Swc_Node *) Guarded_Malloc(sizeof(Swc_Node) * a->capacity, 
+				       "Swc_Arraylist_New");
+  } else {
+    a->array = NULL;
+  }
+
+  return a;
+}
+
+void Kill_Swc_Arraylist(Swc_Arraylist *a)
+{
+  
+  
+  free(a->array);
+  free(a);
+}
+
+Swc_Arraylist* Swc_Arraylist_Wrap(Swc_Node *array, int n)
+{
+  if (array == NULL) {
+    return NULL;
+  }
+
+  Swc_Arraylist *a = (Swc_Arraylist *) Guarded_Malloc(sizeof(Swc_Arraylist), 
+							"Swc_Arraylist_New");
+  a->length = n;
+  a->capacity = n;
+  a->array = array;
+
+  return a;
+}
+
+Swc_Node Swc_Arraylist_At(const Swc_Arraylist *a, int index)
+{
+  return a->array[index];
+}
+
+Swc_Node Swc_Arraylist_Last(const Swc_Arraylist *a)
+{
+  return a->array[a->length - 1];
+}
+
+Swc_Node* Swc_Arraylist_At_R(const Swc_Arraylist *a, int index)
+{
+  return a->array + index;
+}
+
+/* Swc_Arraylist_Add(): Add an element to an array list.
+ *
+ * Args: <a> - the arraylist to manipulate;
+ *       <item> - the element to add.
+ *
+ * Return: void.
+ */
+void Swc_Arraylist_Add(Swc_Arraylist *a, Swc_Node item)
+{
+  a->length++;
+
+  if (a->length >= a->capacity) {
+    swc_arraylist_grow(a);
+  }
+
+  a->array[a->length - 1] = item;
+}
+
+void Swc_Arraylist_Insert(Swc_Arraylist *a, int index, Swc_Node item)
+{
+  if (index < a->length) {
+    a->length++;
+    if (a->length >= a->capacity) {
+      swc_arraylist_grow(a);
+    }
+
+    memmove(a->array + index + 1, a->array + index, 
+	    sizeof(Swc_Node) * (a->length - index - 1));
+  }
+
+  Swc_Arraylist_Set(a, index, item);
+}
+
+Swc_Node Swc_Arraylist_Take(Swc_Arraylist *a, int index)
+{
+  Swc_Node data = a->array[index];
+  a->length--;
+  memmove(a->array + index, a->array + index + 1, 
+	  sizeof(Swc_Node) * (a->length - index));
+
+  return data;
+}
+
+Swc_Node Swc_Arraylist_Take_Last(Swc_Arraylist *a)
+{
+  Swc_Node data = a->array[a->length - 1];
+  a->length--;
+
+  return data;
+}
+
+void Swc_Arraylist_Set_Length(Swc_Arraylist *a, int length)
+{
+  TZ_ASSERT(length >= 0, "Negative length");
+
+  a->length = length;
+
+  while (a->length > a->capacity) {
+    swc_arraylist_grow(a);
+  }
+}
+
+void Swc_Arraylist_Set(Swc_Arraylist *a, int index, Swc_Node item)
+{
+  if (index >= a->length) {
+    a->length = index + 1;
+  }
+
+  while (a->length > a->capacity) {
+    swc_arraylist_grow(a);
+  }
+  
+
+  a->array[index] = item;
+}
+
+/* Swc_Arraylist_Swap(): Swap two elements
+ * 
+ * Args: a - the arraylist to manipulate;
+ *       idx1 - index of the first element;
+ *       idx2 - index of the second element.
+ *
+ * Return: void.
+ */
+void Swc_Arraylist_Swap(Swc_Arraylist *a, int idx1, int idx2)
+{
+  if ((idx1 < 0) || (idx1 >= a->length) || (idx2 < 0) || (idx2 >= a->length)) {
+    TZ_WARN(ERROR_DATA_VALUE);
+    return;
+  }
+  
+  Swc_Node tmp;
+  tmp = a->array[idx1];
+  a->array[idx1] = a->array[idx2];
+  a->array[idx2] = tmp;
+}
+
@@ -0,0 +1,269 @@
+/* tz_arraylist.c.t
+ *
+ * 15-Feb-2008 Initial write: Ting Zhao
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "tz_error.h"
+#include "tz_utilities.h"
+#include "tz_unipointer_arraylist.h"
+
+INIT_EXCEPTION
+
+const static int Growth_Coeff = 2; /* growth factor */
+
+/* unipointer_arraylist_grow(): Grow an arraylist.
+ *
+ * Args: a - the arraylist to grow.
+ *
+ * Return: void.
+ */
+static void unipointer_arraylist_grow(Unipointer_Arraylist *a)
+{
+  if (a->capacity == 0) {
+    a->capacity = Growth_Coeff;
+    a->array = (unipointer_t *) Guarded_Malloc(sizeof(unipointer_t) * a->capacity, 
+				       "unipointer_arraylist_grow");
+  } else {
+    int new_capacity = Growth_Coeff * a->capacity;
+  
+    unipointer_t *new_array = (unipointer_t *) Guarded_Calloc(new_capacity, sizeof(unipointer_t),
+					      "unipointer_arraylist_grow");
+    memcpy(new_array, a->array, sizeof(unipointer_t) * a->capacity);
+    free(a->array);
+    a->array = new_array;
+    a->capacity = new_capacity;
+  }
+}
+
+/* Print_Unipointer_Arraylist(): Prints an array list.
+ * 
+ * Args: a - the arraylist to print.
+ *       format - printing format. This is mainly for priliminary data elements.
+ *
+ * Return: void.
+ */
+void Print_Unipointer_Arraylist(const Unipointer_Arraylist *a)
+{
+  int i;
+  printf("%d elements: ", a->length);
+  for  (i = 0; i < a->length; i++) {
+  }
+  
+  printf("\n");
+}
+
+Unipointer_Arraylist* New_Unipointer_Arraylist()
+{
+  return Unipointer_Arraylist_New(0, 1);
+}
+
+/* Unipointer_Arraylist_New(): New an arraylist.
+ * 
+ * Args: length - length of the arraylist;
+ *       margin - margin of the arraylist. This means the capacity of the
+ *                arraylist will be <length> + <margin>.
+ * 
+ * Return: a new arraylist.
+ */
+Unipointer_Arraylist* Unipointer_Arraylist_New(int length, int margin)
+{
+  if ((length < 0) || margin < 0) {
+    TZ_WARN(ERROR_DATA_VALUE);
+    return NULL;
+  }
+
+  Unipointer_Arraylist *a = (Unipointer_Arraylist *) Guarded_Malloc(sizeof(Unipointer_Arraylist), 
+							"Unipointer_Arraylist_New");
+  a->length = length;
+  a->capacity = length + margin;
+  if (a->capacity > 0) {
+    a->array = (unipointer_t *) Guarded_Malloc(sizeof(unipointer_t) * a->capacity, 
+				       "Unipointer_Arraylist_New");
+  } else {
+    a->array = NULL;
+  }
+
+  return a;
+}
+
+/* Unipointer_Arraylist_Free(): Free an array list.
+ *
+ * Args: a - the array list to free.
+ *
+ * Return: void.
+ */
+void Unipointer_Arraylist_Free(Unipointer_Arraylist *a)
+{
+  free(a->array);
+  free(a);
+}
+
+Unipointer_Arraylist* Make_Unipointer_Arraylist(int length, int margin)
+{
+  if ((length < 0) || margin < 0) {
+    TZ_WARN(ERROR_DATA_VALUE);
+    return NULL;
+  }
+
+  Unipointer_Arraylist *a = (Unipointer_Arraylist *) Guarded_Malloc(sizeof(Unipointer_Arraylist), 
+							"Unipointer_Arraylist_New");
+  a->length = length;
+  a->capacity = length + margin;
+  if (a->capacity > 0) {
+    a->array = (unipointer_t *) Guarded_Malloc(sizeof(unipointer_t) * a->capacity, 
+				       "Unipointer_Arraylist_New");
+  } else {
+    a->array = NULL;
+  }
+
+  return a;
+}
+
+void Kill_Unipointer_Arraylist(Unipointer_Arraylist *a)
+{
+  
+  
+  int i;
+  for (i = 0; i < a->length; i++) {
+    free(a->array[i]);
+  }
+  
+  free(a->array);
+  free(a);
+}
+
+Unipointer_Arraylist* Unipointer_Arraylist_Wrap(unipointer_t *array, int n)
+{
+  if (array == NULL) {
+    return NULL;
+  }
+
+  Unipointer_Arraylist *a = (Unipointer_Arraylist *) Guarded_Malloc(sizeof(Unipointer_Arraylist), 
+							"Unipointer_Arraylist_New");
+  a->length = n;
+  a->capacity = n;
+  a->array = array;
+
+  return a;
+}
+
+unipointer_t Unipointer_Arraylist_At(const Unipointer_Arraylist *a, int index)
+{
+  return a->array[index];
+}
+
+unipointer_t Unipointer_Arraylist_Last(const Unipointer_Arraylist *a)
+{
+  return a->array[a->length - 1];
+}
+
+unipointer_t* Unipointer_Arraylist_At_R(const Unipointer_Arraylist *a, int index)
+{
+  return a->array + index;
+}
+
+/* Unipointer_Arraylist_Add(): Add an element to an array list.
+ *
+ * Args: <a> - the arraylist to manipulate;
+ *       <item> - the element to add.
+ *
+ * Return: void.
+ */
+void Unipointer_Arraylist_Add(Unipointer_Arraylist *a, unipointer_t item)
+{
+  a->length++;
+
+  if (a->length >= a->capacity) {
+    unipointer_arraylist_grow(a);
+  }
+
+  a->array[a->length - 1] = item;
+}
+
+void Unipointer_Arraylist_Insert(Unipointer_Arraylist *a, int index, unipointer_t item)
+{
+  if (index < a->length) {
+    a->length++;
+    if (a->length >= a->capacity) {
+      unipointer_arraylist_grow(a);
+    }
+
+    memmove(a->array + index + 1, a->array + index, 
+	    sizeof(unipointer_t) * (a->length - index - 1));
+  }
+
+  Unipointer_Arraylist_Set(a, index, item);
+}
+
+unipointer_t Unipointer_Arraylist_Take(Unipointer_Arraylist *a, int index)
+{
+  unipointer_t data = a->array[index];
+  a->length--;
+  memmove(a->array + index, a->array + index + 1, 
+	  sizeof(unipointer_t) * (a->length - index));
+
+  return data;
+}
+
+unipointer_t Unipointer_Arraylist_Take_Last(Unipointer_Arraylist *a)
+{
+  unipointer_t data = a->array[a->length - 1];
+  a->length--;
+
+  return data;
+}
+
+void Unipointer_Arraylist_Set_Length(Unipointer_Arraylist *a, int length)
+{
+  TZ_ASSERT(length >= 0, "Negative length");
+
+  a->length = length;
+
+  while (a->length > a->capacity) {
+    unipointer_arraylist_grow(a);
+  }
+}
+
+void Unipointer_Arraylist_Set(Unipointer_Arraylist *a, int index, unipointer_t item)
+{
+  if (index >= a->length) {
+    a->length = index + 1;
+  }
+
+  while (a->length > a->capacity) {
+    unipointer_arraylist_grow(a);
+  }
+  
+  int i;
+  for (i = a->length; i < a->capacity; ++i) {
+    a->array[i] = 0;
+  }
+  
+
+  a->array[index] = item;
+}
+
+/* Unipointer_Arraylist_Swap(): Swap two elements
+ * 
+ * Args: a - the arraylist to manipulate;
+ *       idx1 - index of the first element;
+ *       idx2 - index of the second element.
+ *
+ * Return: void.
+ */
+void Unipointer_Arraylist_Swap(Unipointer_Arraylist *a, int idx1, int idx2)
+{
+  if ((idx1 < 0) || (idx1 >= a->length) || (idx2 < 0) || (idx2 >= a->length)) {
+    TZ_WARN(ERROR_DATA_VALUE);
+    return;
+  }
+  
+  unipointer_t tmp;
+  tmp = a->array[idx1];
+  a->array[idx1] = a->array[idx2];
+  a->array[idx2] = tmp;
+}
+
@@ -0,0 +1,372 @@
+/* tz_linked_list_c.t
+ *
+ * 27-Nov-2007 Initial write: Ting Zhao
+ */
+
+#include <stdlib.h>
+#include "tz_error.h"
+#include "utilities.h"
+#include "tz_unipointer_linked_list.h"
+
+INIT_EXCEPTION
+
+/* Unipointer_List_New(): New a Unipointer list.
+ *
+ * Return: A Unipointer list with length 1.
+ */
+Unipointer_List* Unipointer_List_New()
+{
+  Unipointer_List *new_list = (Unipointer_List *) Guarded_Malloc(sizeof(Unipointer_List), 
+						     "Unipointer_List_New");
+  new_list->next = NULL;
+
+  return new_list;
+}
+
+void Unipointer_List_Set_Data(Unipointer_List *p, unipointer_t data)
+{
+  p->data = data;
+}
+
+/* Unipointer_List_Removeall(): Remove all nodes in a list.
+ *
+ * Args: p - a pointer to the list. It becomes NULL after calling this function.
+ *
+ * Return: void.
+ */
+void Unipointer_List_Removeall(Unipointer_List **p)
+{
+  if (p != NULL) {
+    while (*p != NULL) {
+      Unipointer_List_Remove(p);
+    }
+  }
+}
+
+/* Unipointer_List_Unlinkall(): Unlink all nodes in a list.
+ *
+ * Args: p - a pointer to the list. It becomes NULL after calling this function.
+ *
+ * Return: void.
+ */
+void Unipointer_List_Unlinkall(Unipointer_List **p)
+{
+  if (p != NULL) {
+    while (*p != NULL) {
+      Unipointer_List_Unlink(p);
+    }
+  }
+}
+
+void Kill_Unipointer_List(Unipointer_List *p)
+{
+  Unipointer_List_Removeall(&p);
+}
+
+/* Unipointer_List_Add(): Add a node to the beginning of the list.
+ * 
+ * Args: p - pointer to the list;
+ *       data - data node.
+ *
+ * Return: the old head.
+ * 
+ * Note: <data> (not its copy) will be added to the list, so be careful about
+ *       freeing the object.
+ */
+Unipointer_List* Unipointer_List_Add(Unipointer_List **p, unipointer_t data)
+{
+  Unipointer_List *new_node = Unipointer_List_New();
+  new_node->next = *p;
+  Unipointer_List_Set_Data(new_node, data);
+  *p = new_node;
+  
+  return (*p)->next;
+}
+
+/* Unipointer_List_Add_Last(): Add a new node to the end of the list.
+ *
+ * Return: the last node of the new list.
+ */
+Unipointer_List* Unipointer_List_Add_Last(Unipointer_List *p, unipointer_t data)
+{
+  p = Unipointer_List_Last(p);
+  Unipointer_List *new_node = Unipointer_List_New();
+  Unipointer_List_Set_Data(new_node, data);
+  p->next = new_node;
+
+  return new_node;
+}
+
+/* Unipointer_List_Remove(): Remove the first node.
+ *
+ * Args: p - a pointer to the list. It becomes the new list after calling this
+ *           function.
+ *
+ * Return: void.
+ */
+void Unipointer_List_Remove(Unipointer_List **p)
+{
+  if (*p != NULL) {
+    Unipointer_List *tmp_head = *p;
+    *p = tmp_head->next;
+    
+    
+    free(tmp_head->data);
+    
+    free(tmp_head);
+  }
+}
+
+void Unipointer_List_Remove_Last(Unipointer_List *p)
+{
+  if (p == NULL) {
+    return;
+  }
+
+  while (p->next != NULL) {
+    p = Unipointer_List_Next(p);
+  }
+
+  Unipointer_List_Remove(&p);
+}
+
+/* Unipointer_List_Unlink(): Unlink the head of a list.
+ *
+ * Args: p - input list, which will be changed.
+ *
+ * Return: the unlinked data.
+ */
+unipointer_t Unipointer_List_Unlink(Unipointer_List **p)
+{
+  if (*p != NULL) {
+    Unipointer_List *tmp_head = *p;
+    *p = tmp_head->next;
+
+    unipointer_t data = tmp_head->data;
+    free(tmp_head);
+    
+    return data;
+  }
+
+  
+  return NULL;
+  
+  
+}
+
+/* Unipointer_List_Next(): Get next node.
+ *
+ * Return: the next node of p.
+ */
+Unipointer_List* Unipointer_List_Next(Unipointer_List *p)
+{
+  return p->next;
+}
+
+/* Unipointer_List_Last(): Get the last node.
+ *
+ * Return: the last node of <p>.
+ */
+Unipointer_List* Unipointer_List_Last(Unipointer_List *p)
+{
+  Unipointer_List* prev = NULL;
+
+  while (p != NULL) {
+    prev = p;
+    p = Unipointer_List_Next(p);
+  }
+
+  return prev;
+}
+
+BOOL Unipointer_List_Is_Empty(const Unipointer_List *p)
+{
+  if (p == NULL) {
+    return TRUE;
+  } else {
+    return FALSE;
+  }
+}
+
+/* Unipointer_List_Length(): Length of the list.
+ * 
+ * Args: p - input list.
+ *
+ * Return: the length of the list.
+ */
+int Unipointer_List_Length(const Unipointer_List *p)
+{
+  int n = 0;
+  while (p != NULL) {
+    n++;
+    p = p->next;
+  }
+
+  return n;
+}
+
+/* Unipointer_List_To_Array(): Turn a list to an array.
+ *
+ * Args: p - input list;
+ *       array - returned array. If it is NULL, a new array will be created,
+ *               otherwise it must be large enough to hold the result.
+ *       step - The offset between an element and its right neighbor. If it is
+ *              negative, the array has a reversed order.
+ * Return: the resulted array.
+ *
+ * Note: The caller is responsible for freeing the returned array.
+ */
+unipointer_t* Unipointer_List_To_Array(const Unipointer_List *p, int step, unipointer_t *array, int *length)
+{
+  if (step == 0) {
+    THROW(ERROR_DATA_VALUE);
+  }
+
+  int n = Unipointer_List_Length(p);
+  int array_length = (n - 1) * abs(step) + 1;
+
+  if (array == NULL) {
+    array = (unipointer_t *) Guarded_Malloc(sizeof(unipointer_t) * array_length, 
+				    "Unipointer_List_To_Array");
+  }
+
+  int begin;
+  int end;
+  
+  if (step > 0) {
+    begin = 0;
+    end = array_length - 1;
+  } else {
+    begin = array_length - 1;
+    end = 0;
+  }
+  
+  int i;
+  for (i = begin; p != NULL; i += step, p = p->next) {
+    array[i] = p->data;
+  }
+
+  if (length != NULL) {
+    *length = array_length;
+  }
+
+  return array;
+}
+
+/* Print_Unipointer_List(): Print Unipointer list.
+ *
+ * Args: p - list to print.
+ *
+ * Return: void.
+ *
+ * Note: This function works only when Print_Unipointer is available.
+ */
+void Print_Unipointer_List(const Unipointer_List *p)
+{
+  if (p == NULL) {
+    printf("Null list.\n");
+    return;
+  }
+
+  printf("Total length: %d\n", Unipointer_List_Length(p));
+
+  
+  while (p != NULL) {
+    Print_Unipointer(p->data);
+    p = p->next;
+  }
+  
+
+}
+
+/* Print_Unipointer_List_Compact(): Print Unipointer list briefly.
+ *
+ * Args: p - list to print.
+ *
+ * Return: void.
+ *
+ * Note: This function works only when Print_Unipointer_Info is available.
+ */
+void Print_Unipointer_List_Compact(const Unipointer_List *p)
+{
+  if (p == NULL) {
+    printf("Null list.\n");
+    return;
+  }
+
+  
+}
+
+void Print_Unipointer_List_F(const Unipointer_List *p, const char *format)
+{
+  if (p == NULL) {
+    printf("Null list.\n");
+    return;
+  }
+
+  printf("Total length: %d\n", Unipointer_List_Length(p));
+  while (p != NULL) {
+    printf(format, p->data);
+    printf(" ");
+    p = p->next;
+  }
+  printf("\n");
+}
+
+/*
+ * The following routines implement a queue based on a list.
+ */
+
+/* Unipointer_Queue_En(): Add an item to the end of the queue.
+ */
+Unipointer_List* Unipointer_Queue_En(Unipointer_List **p, unipointer_t data)
+{
+  if (*p == NULL) {
+    *p = Unipointer_List_New();
+    Unipointer_List_Set_Data(*p, data);
+    return *p;
+  }
+
+  return Unipointer_List_Add_Last(*p, data);
+}
+
+/* Unipointer_Queue_De(): Removes the item from the front of the queue.
+ */
+unipointer_t Unipointer_Queue_De(Unipointer_List **p)
+{
+  return Unipointer_List_Unlink(p);
+}
+
+/* Unipointer_Queue_Peek(): Get the iterm from the front of the queue without removing
+ *                    it.
+ */
+unipointer_t Unipointer_Queue_Peek(const Unipointer_List *p)
+{
+  return p->data;
+}
+
+
+/*
+ * The following routines implement a stack based on a list.
+ */
+void Unipointer_Stack_Push(Unipointer_List **p, unipointer_t data)
+{
+  if (*p == NULL) {
+    *p = Unipointer_List_New();
+    Unipointer_List_Set_Data(*p, data);
+  } else {
+    Unipointer_List_Add(p, data);  
+  }
+}
+
+unipointer_t Unipointer_Stack_Pop(Unipointer_List **p)
+{
+  return Unipointer_List_Unlink(p);
+}
+
+unipointer_t Unipointer_Stack_Peek(const Unipointer_List *p)
+{
+  return p->data;
+}
+
+
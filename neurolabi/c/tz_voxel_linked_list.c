@@ -0,0 +1,372 @@
+/* tz_linked_list_c.t
+ *
+ * 27-Nov-2007 Initial write: Ting Zhao
+ */
+
+#include <stdlib.h>
+#include "tz_error.h"
+#include "utilities.h"
+#include "tz_voxel_linked_list.h"
+
+INIT_EXCEPTION
+
+/* Voxel_List_New(): New a Voxel list.
+ *
+ * Return: A Voxel list with length 1.
+ */
+Voxel_List* Voxel_List_New()
+{
+  Voxel_List *new_list = (Voxel_List *) Guarded_Malloc(sizeof(Voxel_List), 
+						     "Voxel_List_New");
+  new_list->next = NULL;
+
+  return new_list;
+}
+
+void Voxel_List_Set_Data(Voxel_List *p, Voxel_P data)
+{
+  p->data = data;
+}
+
+/* Voxel_List_Removeall(): Remove all nodes in a list.
+ *
+ * Args: p - a pointer to the list. It becomes NULL after calling this function.
+ *
+ * Return: void.
+ */
+void Voxel_List_Removeall(Voxel_List **p)
+{
+  if (p != NULL) {
+    while (*p != NULL) {
+      Voxel_List_Remove(p);
+    }
+  }
+}
+
+/* Voxel_List_Unlinkall(): Unlink all nodes in a list.
+ *
+ * Args: p - a pointer to the list. It becomes NULL after calling this function.
+ *
+ * Return: void.
+ */
+void Voxel_List_Unlinkall(Voxel_List **p)
+{
+  if (p != NULL) {
+    while (*p != NULL) {
+      Voxel_List_Unlink(p);
+    }
+  }
+}
+
+void Kill_Voxel_List(Voxel_List *p)
+{
+  Voxel_List_Removeall(&p);
+}
+
+/* Voxel_List_Add(): Add a node to the beginning of the list.
+ * 
+ * Args: p - pointer to the list;
+ *       data - data node.
+ *
+ * Return: the old head.
+ * 
+ * Note: <data> (not its copy) will be added to the list, so be careful about
+ *       freeing the object.
+ */
+Voxel_List* Voxel_List_Add(Voxel_List **p, Voxel_P data)
+{
+  Voxel_List *new_node = Voxel_List_New();
+  new_node->next = *p;
+  Voxel_List_Set_Data(new_node, data);
+  *p = new_node;
+  
+  return (*p)->next;
+}
+
+/* Voxel_List_Add_Last(): Add a new node to the end of the list.
+ *
+ * Return: the last node of the new list.
+ */
+Voxel_List* Voxel_List_Add_Last(Voxel_List *p, Voxel_P data)
+{
+  p = Voxel_List_Last(p);
+  Voxel_List *new_node = Voxel_List_New();
+  Voxel_List_Set_Data(new_node, data);
+  p->next = new_node;
+
+  return new_node;
+}
+
+/* Voxel_List_Remove(): Remove the first node.
+ *
+ * Args: p - a pointer to the list. It becomes the new list after calling this
+ *           function.
+ *
+ * Return: void.
+ */
+void Voxel_List_Remove(Voxel_List **p)
+{
+  if (*p != NULL) {
+    Voxel_List *tmp_head = *p;
+    *p = tmp_head->next;
+    
+    
+    free(tmp_head->data);
+    
+    free(tmp_head);
+  }
+}
+
+void Voxel_List_Remove_Last(Voxel_List *p)
+{
+  if (p == NULL) {
+    return;
+  }
+
+  while (p->next != NULL) {
+    p = Voxel_List_Next(p);
+  }
+
+  Voxel_List_Remove(&p);
+}
+
+/* Voxel_List_Unlink(): Unlink the head of a list.
+ *
+ * Args: p - input list, which will be changed.
+ *
+ * Return: the unlinked data.
+ */
+Voxel_P Voxel_List_Unlink(Voxel_List **p)
+{
+  if (*p != NULL) {
+    Voxel_List *tmp_head = *p;
+    *p = tmp_head->next;
+
+    Voxel_P data = tmp_head->data;
+    free(tmp_head);
+    
+    return data;
+  }
+
+  
+  return NULL;
+  
+  
+}
+
+/* Voxel_List_Next(): Get next node.
+ *
+ * Return: the next node of p.
+ */
+Voxel_List* Voxel_List_Next(Voxel_List *p)
+{
+  return p->next;
+}
+
+/* Voxel_List_Last(): Get the last node.
+ *
+ * Return: the last node of <p>.
+ */
+Voxel_List* Voxel_List_Last(Voxel_List *p)
+{
+  Voxel_List* prev = NULL;
+
+  while (p != NULL) {
+    prev = p;
+    p = Voxel_List_Next(p);
+  }
+
+  return prev;
+}
+
+BOOL Voxel_List_Is_Empty(const Voxel_List *p)
+{
+  if (p == NULL) {
+    return TRUE;
+  } else {
+    return FALSE;
+  }
+}
+
+/* Voxel_List_Length(): Length of the list.
+ * 
+ * Args: p - input list.
+ *
+ * Return: the length of the list.
+ */
+int Voxel_List_Length(const Voxel_List *p)
+{
+  int n = 0;
+  while (p != NULL) {
+    n++;
+    p = p->next;
+  }
+
+  return n;
+}
+
+/* Voxel_List_To_Array(): Turn a list to an array.
+ *
+ * Args: p - input list;
+ *       array - returned array. If it is NULL, a new array will be created,
+ *               otherwise it must be large enough to hold the result.
+ *       step - The offset between an element and its right neighbor. If it is
+ *              negative, the array has a reversed order.
+ * Return: the resulted array.
+ *
+ * Note: The caller is responsible for freeing the returned array.
+ */
+Voxel_P* Voxel_List_To_Array(const Voxel_List *p, int step, Voxel_P *array, int *length)
+{
+  if (step == 0) {
+    THROW(ERROR_DATA_VALUE);
+  }
+
+  int n = Voxel_List_Length(p);
+  int array_length = (n - 1) * abs(step) + 1;
+
+  if (array == NULL) {
+    array = (Voxel_P *) Guarded_Malloc(sizeof(Voxel_P) * array_length, 
+				    "Voxel_List_To_Array");
+  }
+
+  int begin;
+  int end;
+  
+  if (step > 0) {
+    begin = 0;
+    end = array_length - 1;
+  } else {
+    begin = array_length - 1;
+    end = 0;
+  }
+  
+  int i;
+  for (i = begin; p != NULL; i += step, p = p->next) {
+    array[i] = p->data;
+  }
+
+  if (length != NULL) {
+    *length = array_length;
+  }
+
+  return array;
+}
+
+/* Print_Voxel_List(): Print Voxel list.
+ *
+ * Args: p - list to print.
+ *
+ * Return: void.
+ *
+ * Note: This function works only when Print_Voxel is available.
+ */
+void Print_Voxel_List(const Voxel_List *p)
+{
+  if (p == NULL) {
+    printf("Null list.\n");
+    return;
+  }
+
+  printf("Total length: %d\n", Voxel_List_Length(p));
+
+  
+  while (p != NULL) {
+    Print_Voxel(p->data);
+    p = p->next;
+  }
+  
+
+}
+
+/* Print_Voxel_List_Compact(): Print Voxel list briefly.
+ *
+ * Args: p - list to print.
+ *
+ * Return: void.
+ *
+ * Note: This function works only when Print_Voxel_Info is available.
+ */
+void Print_Voxel_List_Compact(const Voxel_List *p)
+{
+  if (p == NULL) {
+    printf("Null list.\n");
+    return;
+  }
+
+  
+}
+
+void Print_Voxel_List_F(const Voxel_List *p, const char *format)
+{
+  if (p == NULL) {
+    printf("Null list.\n");
+    return;
+  }
+
+  printf("Total length: %d\n", Voxel_List_Length(p));
+  while (p != NULL) {
+    printf(format, p->data);
+    printf(" ");
+    p = p->next;
+  }
+  printf("\n");
+}
+
+/*
+ * The following routines implement a queue based on a list.
+ */
+
+/* Voxel_Queue_En(): Add an item to the end of the queue.
+ */
+Voxel_List* Voxel_Queue_En(Voxel_List **p, Voxel_P data)
+{
+  if (*p == NULL) {
+    *p = Voxel_List_New();
+    Voxel_List_Set_Data(*p, data);
+    return *p;
+  }
+
+  return Voxel_List_Add_Last(*p, data);
+}
+
+/* Voxel_Queue_De(): Removes the item from the front of the queue.
+ */
+Voxel_P Voxel_Queue_De(Voxel_List **p)
+{
+  return Voxel_List_Unlink(p);
+}
+
+/* Voxel_Queue_Peek(): Get the iterm from the front of the queue without removing
+ *                    it.
+ */
+Voxel_P Voxel_Queue_Peek(const Voxel_List *p)
+{
+  return p->data;
+}
+
+
+/*
+ * The following routines implement a stack based on a list.
+ */
+void Voxel_Stack_Push(Voxel_List **p, Voxel_P data)
+{
+  if (*p == NULL) {
+    *p = Voxel_List_New();
+    Voxel_List_Set_Data(*p, data);
+  } else {
+    Voxel_List_Add(p, data);  
+  }
+}
+
+Voxel_P Voxel_Stack_Pop(Voxel_List **p)
+{
+  return Voxel_List_Unlink(p);
+}
+
+Voxel_P Voxel_Stack_Peek(const Voxel_List *p)
+{
+  return p->data;
+}
+
+
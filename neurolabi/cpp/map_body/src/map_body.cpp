@@ -7,6 +7,8 @@
 #include <stdlib.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <pthread.h>
+#include <unistd.h>
 
 #include "tz_utilities.h"
 #include "zsegmentmaparray.h"
@@ -24,7 +26,6 @@
 #include "tz_sp_grow.h"
 #include "zspgrowparser.h"
 #include "tz_stack_stat.h"
-#include "tz_intpair_map.h"
 #include "tz_stack_utils.h"
 #include "zfilelist.h"
 #include "zstring.h"
@@ -32,54 +33,88 @@
 #include "zobject3dscan.h"
 #include "zgraph.h"
 #include "zhdf5writer.h"
+#include "zhdf5reader.h"
+#include "zhdf5blockiterator.h"
+#include "zarray.h"
+#include "zlabelmap.h"
 #include "zfiletype.h"
 #include "misc/miscutility.h"
 
 using namespace std;
 
-static void map_plane_body(Stack *stack, Intpair_Map *superpixelBodyMap,
-    Stack *out, Stack *out2)
+/* Remapping of a voxel range of a plane, which is run by a thread */
+struct PlaneMapTask {
+  const Stack *stack;
+  const ZLabelMap *bodyMap;
+  const int *lut16; /* body ids of all GREY16 values */
+  Stack *out;
+  Stack *out2;
+  IMatrix *iout;
+  size_t start;
+  size_t end;
+};
+
+static void* map_plane_body_range(void *arg)
 {
-  size_t nvoxel = Stack_Voxel_Number(stack);
+  const PlaneMapTask *task = (const PlaneMapTask*) arg;
+  const Stack *stack = task->stack;
+  const ZLabelMap *bodyMap = task->bodyMap;
 
   switch (stack->kind) {
     case GREY16:
       {
-        uint16_t *array16 = (uint16_t*) stack->array;
-        uint16_t *out_array16 = (uint16_t*) out->array;
-        for (size_t k = 0; k < nvoxel; k++) {
-          out_array16[k] = (uint16_t) Intpair_Map_Value(superpixelBodyMap,
-              0, array16[k]);
+        const uint16_t *array16 = (const uint16_t*) stack->array;
+        const int *lut16 = task->lut16;
+        if (task->iout != NULL) {
+          int *out_array = task->iout->array;
+          for (size_t k = task->start; k < task->end; k++) {
+            out_array[k] = lut16[array16[k]];
+          }
+        } else {
+          uint16_t *out_array16 = (uint16_t*) task->out->array;
+          for (size_t k = task->start; k < task->end; k++) {
+            out_array16[k] = (uint16_t) lut16[array16[k]];
+          }
         }
       }
       break;
     case COLOR:
-      if (out->kind == COLOR) {
-        color_t *arrayc = (color_t*) stack->array;
-        color_t *out_arrayc = (color_t*) out->array;
-        for (size_t k = 0; k < nvoxel; k++) {
-          int value = Intpair_Map_Value(superpixelBodyMap, 0, 
-              Color_To_Value(arrayc[k]));
-          if (value < 0) {
-            out_arrayc[k][0] = 0;
-            out_arrayc[k][1] = 0;
-            out_arrayc[k][2] = 0;
-            out2->array[k] = 0;
-          } else {
-            out2->array[k] = 
-              Value_To_Color(value, out_arrayc[k]);
+      {
+        const color_t *arrayc = (const color_t*) stack->array;
+        if (task->iout != NULL) {
+          int *out_array = task->iout->array;
+          for (size_t k = task->start; k < task->end; k++) {
+            uint32_t key = arrayc[k][0] | (arrayc[k][1] << 8) |
+                (arrayc[k][2] << 16);
+            out_array[k] = (int) bodyMap->value(key);
           }
-        }
-      } else if (out->kind == GREY16) {
-        color_t *arrayc = (color_t*) stack->array;
-        uint16_t *out_array16 = (uint16_t*) out->array;
-        for (size_t k = 0; k < nvoxel; k++) {
-          int value = Intpair_Map_Value(superpixelBodyMap, 0, 
-              Color_To_Value(arrayc[k]));
-          if (value >= 0) {
-            out_array16[k] = value;
-          } else {
-            out_array16[k] = 0;
+        } else if (task->out->kind == COLOR) {
+          color_t *out_arrayc = (color_t*) task->out->array;
+          uint8_t *out_array2 = task->out2->array;
+          for (size_t k = task->start; k < task->end; k++) {
+            uint32_t key = arrayc[k][0] | (arrayc[k][1] << 8) |
+                (arrayc[k][2] << 16);
+            int value = (int) bodyMap->value(key);
+            if (value < 0) {
+              out_arrayc[k][0] = 0;
+              out_arrayc[k][1] = 0;
+              out_arrayc[k][2] = 0;
+              out_array2[k] = 0;
+            } else {
+              /* same as Value_To_Color */
+              out_arrayc[k][0] = value & 0xFF;
+              out_arrayc[k][1] = (value >> 8) & 0xFF;
+              out_arrayc[k][2] = (value >> 16) & 0xFF;
+              out_array2[k] = ((uint32_t) value) >> 24;
+            }
+          }
+        } else if (task->out->kind == GREY16) {
+          uint16_t *out_array16 = (uint16_t*) task->out->array;
+          for (size_t k = task->start; k < task->end; k++) {
+            uint32_t key = arrayc[k][0] | (arrayc[k][1] << 8) |
+                (arrayc[k][2] << 16);
+            int value = (int) bodyMap->value(key);
+            out_array16[k] = (value >= 0) ? value : 0;
           }
         }
       }
@@ -87,42 +122,332 @@ static void map_plane_body(Stack *stack, Intpair_Map *superpixelBodyMap,
     default:
       break;
   }
+
+  return NULL;
 }
 
-static void map_plane_body_i(Stack *stack, Intpair_Map *superpixelBodyMap,
-    IMatrix *out)
+static int get_default_thread_number()
 {
-  size_t nvoxel = Stack_Voxel_Number(stack);
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+  if (n < 1) {
+    n = 1;
+  }
+
+  return (int) std::min(n, 16L);
+}
+
+/* Split a plane into contiguous voxel ranges and remap them in parallel */
+static void run_plane_map_task(PlaneMapTask task, int threadNumber)
+{
+  size_t nvoxel = Stack_Voxel_Number(task.stack);
+
+  std::vector<int> lut16;
+  if (task.stack->kind == GREY16) {
+    /* A GREY16 plane has at most 65536 labels, so a dense table of all of
+       them is cheaper than looking up each voxel */
+    lut16.resize(65536);
+    for (size_t i = 0; i < lut16.size(); ++i) {
+      lut16[i] = (int) task.bodyMap->value(i);
+    }
+    task.lut16 = &(lut16[0]);
+  }
+
+  /* small planes are not worth the threads */
+  if (nvoxel < 262144) {
+    threadNumber = 1;
+  }
+  threadNumber = imax2(1, threadNumber);
+
+  std::vector<PlaneMapTask> taskArray(threadNumber, task);
+  size_t step = (nvoxel + threadNumber - 1) / threadNumber;
+  for (int i = 0; i < threadNumber; ++i) {
+    taskArray[i].start = std::min(step * i, nvoxel);
+    taskArray[i].end = std::min(taskArray[i].start + step, nvoxel);
+  }
+
+  std::vector<pthread_t> threadArray(threadNumber);
+  std::vector<bool> started(threadNumber, false);
+  for (int i = 1; i < threadNumber; ++i) {
+    if (pthread_create(&(threadArray[i]), NULL, map_plane_body_range,
+                       &(taskArray[i])) == 0) {
+      started[i] = true;
+    } else {
+      map_plane_body_range(&(taskArray[i]));
+    }
+  }
+
+  map_plane_body_range(&(taskArray[0]));
+
+  for (int i = 1; i < threadNumber; ++i) {
+    if (started[i]) {
+      pthread_join(threadArray[i], NULL);
+    }
+  }
+}
 
+static void map_plane_body(Stack *stack, const ZLabelMap &superpixelBodyMap,
+    Stack *out, Stack *out2, int threadNumber)
+{
+  PlaneMapTask task;
+  task.stack = stack;
+  task.bodyMap = &superpixelBodyMap;
+  task.lut16 = NULL;
+  task.out = out;
+  task.out2 = out2;
+  task.iout = NULL;
+  task.start = 0;
+  task.end = 0;
+
+  run_plane_map_task(task, threadNumber);
+}
+
+static void map_plane_body_i(Stack *stack, const ZLabelMap &superpixelBodyMap,
+    IMatrix *out, int threadNumber)
+{
+  if (stack->kind != GREY16 && stack->kind != COLOR) {
+    return;
+  }
+
+  PlaneMapTask task;
+  task.stack = stack;
+  task.bodyMap = &superpixelBodyMap;
+  task.lut16 = NULL;
+  task.out = NULL;
+  task.out2 = NULL;
+  task.iout = out;
+  task.start = 0;
+  task.end = 0;
+
+  run_plane_map_task(task, threadNumber);
+
+  /* Report unmapped voxels in voxel order */
+  size_t nvoxel = Stack_Voxel_Number(stack);
   Image_Array ima;
   ima.array = stack->array;
-  switch (stack->kind) {
-    case GREY16:
-      for (size_t k = 0; k < nvoxel; ++k) {
-        out->array[k] = Intpair_Map_Value(superpixelBodyMap, 0, ima.array16[k]);
+  for (size_t k = 0; k < nvoxel; ++k) {
+    if (out->array[k] < 0) {
+      std::cerr << "WARNING: Negative body id" << std::endl;
+      if (stack->kind == COLOR) {
+        std::cout << "Superpixel may not be mapped: "
+                  << Color_To_Value(ima.arrayc[k]) << std::endl;
+      }
+    }
+  }
+}
 
-        if (out->array[k] < 0) {
-          std::cerr << "WARNING: Negative body id" << std::endl;
-        }
+static bool load_body_compress_map(const std::string &bodyMapDir,
+                                   map<int, int> *bodyIdDict)
+{
+  std::string filePath = bodyMapDir + "/body_compress_map.txt";
+  if (!fexist(filePath.c_str())) {
+    return false;
+  }
+
+  FILE *fp = fopen(filePath.c_str(), "r");
+  ZString str;
+  while (str.readLine(fp)) {
+    vector<int> value = str.toIntegerArray();
+    if (value.size() == 2) {
+      (*bodyIdDict)[value[0]] = value[1];
+    }
+  }
+  fclose(fp);
+
+  return true;
+}
+
+static void load_plane_body_map(
+    const std::string &bodyMapDir, int planeId, bool compressed,
+    map<int, int> &bodyIdDict, ZLabelMap *superpixelBodyMap)
+{
+  char filePath[500];
+  ZSuperpixelMapArray superpixelMapArray;
+  sprintf(filePath, "%s/superpixel_to_body_map%05d.txt", bodyMapDir.c_str(),
+          planeId);
+  superpixelMapArray.load(filePath, planeId);
+
+  superpixelBodyMap->clear();
+  superpixelBodyMap->reserve(superpixelMapArray.size());
+  for (size_t j = 0; j < superpixelMapArray.size(); j++) {
+    int superpixelId = superpixelMapArray[j].superpixelId();
+    /* negative superpixel ids are not mappable */
+    if (superpixelId >= 0) {
+      if (compressed) {
+        superpixelBodyMap->add(superpixelId,
+                               bodyIdDict[superpixelMapArray[j].bodyId()]);
+      } else {
+        superpixelBodyMap->add(superpixelId, superpixelMapArray[j].bodyId());
       }
+    }
+  }
+  superpixelBodyMap->optimizeLookup();
+}
+
+/*!
+ * Map a (z, y, x) block of superpixel labels. \a mapArray has the map of each
+ * slice of the block. Unmapped superpixels are mapped to 0.
+ */
+template<typename T>
+static void map_block_body(const ZArray *block,
+                           const vector<ZLabelMap*> &mapArray, ZArray *out)
+{
+  const T *array = block->getDataPointer<T>();
+  uint32_t *outArray = out->getDataPointer<uint32_t>();
+  size_t planeVoxelNumber = (size_t) block->dim(1) * block->dim(2);
+  size_t offset = 0;
+  for (int z = 0; z < block->dim(0); ++z) {
+    const ZLabelMap *superpixelBodyMap = mapArray[z];
+    for (size_t k = 0; k < planeVoxelNumber; ++k, ++offset) {
+      int value = (int) superpixelBodyMap->value((uint64_t) array[offset]);
+      outArray[offset] = (value < 0) ? 0 : value;
+    }
+  }
+}
+
+static bool is_label_type(mylib::Value_Type type)
+{
+  switch (type) {
+  case mylib::UINT8_TYPE:
+  case mylib::UINT16_TYPE:
+  case mylib::UINT32_TYPE:
+  case mylib::UINT64_TYPE:
+  case mylib::INT32_TYPE:
+  case mylib::INT64_TYPE:
+    return true;
+  default:
     break;
-    case COLOR:
-    {
-      //color_t *arrayc = (color_t*) stack->array;
-      for (size_t k = 0; k < nvoxel; k++) {
-        out->array[k] = Intpair_Map_Value(superpixelBodyMap, 0, 
-            Color_To_Value(ima.arrayc[k]));
-        if (out->array[k] < 0) {
-          std::cerr << "WARNING: Negative body id" << std::endl;
-          std::cout << "Superpixel may not be mapped: "
-                    << Color_To_Value(ima.arrayc[k]) << std::endl;
-        }
+  }
+
+  return false;
+}
+
+/*!
+ * Map a superpixel label volume stored in an HDF5 dataset. The volume is
+ * processed block by block and the body labels are written into a chunked and
+ * compressed dataset of the same path in \a outputPath, so that neither
+ * volume has to fit into the memory. Slice z of the volume is plane
+ * \a zOffset + z of the body maps.
+ */
+static bool map_hdf5_body(
+    const std::string &inputPath, const std::string &dataPath,
+    const std::string &outputPath, const std::string &bodyMapDir,
+    int zOffset, int compression)
+{
+  ZHdf5Reader reader;
+  if (!reader.open(inputPath)) {
+    cout << "Cannot open " << inputPath << endl;
+    return false;
+  }
+
+  ZHdf5BlockIterator iter(&reader, dataPath);
+  if (iter.getDatasetDims().size() != 3) {
+    cout << "A 3D (z, y, x) label dataset is expected." << endl;
+    return false;
+  }
+
+  mylib::Value_Type type = reader.getValueType(dataPath);
+  if (!is_label_type(type)) {
+    cout << "Unsupported label type." << endl;
+    return false;
+  }
+
+  ZHdf5Writer writer;
+  if (!writer.open(outputPath)) {
+    cout << "Cannot open " << outputPath << endl;
+    return false;
+  }
+
+  if (!writer.createDataset(dataPath, mylib::UINT32_TYPE,
+                            iter.getDatasetDims(), iter.getBlockDims(),
+                            compression)) {
+    cout << "Cannot create " << dataPath << " in " << outputPath << endl;
+    return false;
+  }
+
+  map<int, int> bodyIdDict;
+  bool compressed = load_body_compress_map(bodyMapDir, &bodyIdDict);
+
+  //Blocks are visited slab by slab, so only the maps of the current slab are
+  //kept
+  map<int, ZLabelMap*> planeMap;
+  bool succ = true;
+  size_t blockIndex = 0;
+  while (iter.hasNext() && succ) {
+    ZArray *block = iter.next();
+    if (block == NULL) {
+      cout << "Failed to read block " << blockIndex << endl;
+      succ = false;
+      break;
+    }
+
+    int startPlane = zOffset + block->getStartCoordinate(0);
+    while (!planeMap.empty() && planeMap.begin()->first < startPlane) {
+      delete planeMap.begin()->second;
+      planeMap.erase(planeMap.begin());
+    }
+
+    vector<ZLabelMap*> mapArray(block->dim(0));
+    for (int z = 0; z < block->dim(0); ++z) {
+      int planeId = startPlane + z;
+      if (planeMap.count(planeId) == 0) {
+        cout << "Loading body map of plane " << planeId << endl;
+        ZLabelMap *superpixelBodyMap = new ZLabelMap;
+        load_plane_body_map(bodyMapDir, planeId, compressed, bodyIdDict,
+                            superpixelBodyMap);
+        planeMap[planeId] = superpixelBodyMap;
       }
+      mapArray[z] = planeMap[planeId];
+    }
+
+    mylib::Dimn_Type dims[3];
+    for (int i = 0; i < 3; ++i) {
+      dims[i] = block->dim(i);
     }
+    ZArray out(mylib::UINT32_TYPE, 3, dims);
+    for (int i = 0; i < 3; ++i) {
+      out.setStartCoordinate(i, block->getStartCoordinate(i));
+    }
+
+    switch (type) {
+    case mylib::UINT8_TYPE:
+      map_block_body<uint8_t>(block, mapArray, &out);
+      break;
+    case mylib::UINT16_TYPE:
+      map_block_body<uint16_t>(block, mapArray, &out);
+      break;
+    case mylib::UINT32_TYPE:
+      map_block_body<uint32_t>(block, mapArray, &out);
+      break;
+    case mylib::UINT64_TYPE:
+      map_block_body<uint64_t>(block, mapArray, &out);
+      break;
+    case mylib::INT32_TYPE:
+      map_block_body<int32_t>(block, mapArray, &out);
+      break;
+    case mylib::INT64_TYPE:
+      map_block_body<int64_t>(block, mapArray, &out);
       break;
     default:
+      cout << "Unsupported label type." << endl;
+      succ = false;
       break;
+    }
+
+    if (succ && !writer.writeBlock(dataPath, out)) {
+      cout << "Failed to write block " << blockIndex << endl;
+      succ = false;
+    }
+
+    delete block;
+    ++blockIndex;
+  }
+
+  for (map<int, ZLabelMap*>::iterator mapIter = planeMap.begin();
+       mapIter != planeMap.end(); ++mapIter) {
+    delete mapIter->second;
   }
+
+  return succ;
 }
 
 static ZString get_sobj_path(const std::string &bodyDir, int bodyId)
@@ -193,7 +518,9 @@ int main(int argc, char *argv[])
     "[--range <int> <int>]", "[--output_format <string>]",
     "[--stacked_dir <string>]", "[--bodysize_file <string>]",
     "[--minsize <int(10000000)>] [--z_offset <int(0)>]",
-    "[--maxsize <int>] [--overwrite_level <int(0)>] [--append]", NULL};
+    "[--maxsize <int>] [--overwrite_level <int(0)>] [--append]",
+    "[--dataset <string>] [--compression <int(4)>]", "[--thread <int>]",
+    NULL};
 
   Process_Arguments(argc, argv, const_cast<char**>(Spec), 1);
 
@@ -201,6 +528,25 @@ int main(int argc, char *argv[])
 
   //int overwriteLevel = Get_Int_Arg(const_cast<char*>("--overwrite_level"));
 
+  //Map an HDF5 label volume
+  if (Is_Arg_Matched(CC("--dataset"))) {
+    if (!Is_Arg_Matched(CC("--body_map"))) {
+      cout << "--body_map is required for mapping a dataset." << endl;
+      return 1;
+    }
+
+    if (!map_hdf5_body(dataDir, Get_String_Arg(CC("--dataset")),
+                       Get_String_Arg(CC("-o")), Get_String_Arg(CC("--body_map")),
+                       Get_Int_Arg(CC("--z_offset")),
+                       Get_Int_Arg(CC("--compression")))) {
+      return 1;
+    }
+
+    printf("map_body succeeded\n");
+
+    return 0;
+  }
+
   //int zOffset = Get_Int_Arg(const_cast<char*>("--z_offset"));
 
   int zStart = 0;
@@ -522,21 +868,9 @@ int main(int argc, char *argv[])
 
   char filePath[500];
   //Load compress map
-  sprintf(filePath, "%s/body_compress_map.txt", 
-      Get_String_Arg(const_cast<char*>("--body_map")));
-  bool compressed = fexist(filePath);
   map<int, int> bodyIdDict;
-  if (compressed) {
-    FILE *fp = fopen(filePath, "r");
-    ZString str;
-    while (str.readLine(fp)) {
-      vector<int> value = str.toIntegerArray();
-      if (value.size() == 2) {
-        bodyIdDict[value[0]] = value[1];
-      }
-    }
-    fclose(fp);
-  }
+  bool compressed = load_body_compress_map(
+        Get_String_Arg(const_cast<char*>("--body_map")), &bodyIdDict);
 
   if (Is_Arg_Matched(const_cast<char*>("--cluster"))) {
     FILE *fp = fopen(Get_String_Arg(const_cast<char*>("--script")), "w");
@@ -577,6 +911,11 @@ int main(int argc, char *argv[])
   int startPlaneIndex = 0;
   int endPlaneIndex = planeNumber - 1;
 
+  int threadNumber = get_default_thread_number();
+  if (Is_Arg_Matched(CC("--thread"))) {
+    threadNumber = Get_Int_Arg(CC("--thread"));
+  }
+
   if (Is_Arg_Matched(const_cast<char*>("--range"))) {
     startPlaneIndex = imax2(0, Get_Int_Arg(const_cast<char*>("--range"), 1));
     endPlaneIndex = imin2(endPlaneIndex, 
@@ -587,24 +926,10 @@ int main(int argc, char *argv[])
     int planeId = startPlane + i;
     cout << planeId << endl;
 
-    ZSuperpixelMapArray superpixelMapArray;
-    sprintf(filePath, "%s/superpixel_to_body_map%05d.txt", 
-        Get_String_Arg(const_cast<char*>("--body_map")), planeId);
-    superpixelMapArray.load(filePath, planeId);
+    ZLabelMap superpixelBodyMap;
+    load_plane_body_map(Get_String_Arg(const_cast<char*>("--body_map")),
+                        planeId, compressed, bodyIdDict, &superpixelBodyMap);
 
-    Intpair_Map *superpixelBodyMap = Make_Intpair_Map(100000);
-    for (size_t j = 0; j < superpixelMapArray.size(); j++) {
-      if (compressed) {
-        Intpair_Map_Add(superpixelBodyMap, 0, 
-            superpixelMapArray[j].superpixelId(), 
-            bodyIdDict[superpixelMapArray[j].bodyId()]);
-      } else {
-        Intpair_Map_Add(superpixelBodyMap, 0, 
-            superpixelMapArray[j].superpixelId(), 
-            superpixelMapArray[j].bodyId());
-      }
-    }
-    
     cout << "Read image plane..." << endl;
     Stack *stack = Read_Stack_U(fileList.getFilePath(i));
 
@@ -643,7 +968,7 @@ int main(int argc, char *argv[])
       }
 
       cout << "Mapping ..." << endl;
-      map_plane_body(ds_stack, superpixelBodyMap, out, out2);
+      map_plane_body(ds_stack, superpixelBodyMap, out, out2, threadNumber);
       sprintf(filePath, "%s/body_map%05d.tif", 
           Get_String_Arg(const_cast<char*>("-o")), planeId);
       Write_Stack(filePath, out);
@@ -658,7 +983,7 @@ int main(int argc, char *argv[])
     } else if (outputFormat == "imat") {
       IMatrix *out = Make_3d_IMatrix(ds_stack->width, ds_stack->height, 1);
       cout << "Mapping ..." << endl;
-      map_plane_body_i(ds_stack, superpixelBodyMap, out);
+      map_plane_body_i(ds_stack, superpixelBodyMap, out, threadNumber);
       sprintf(filePath, "%s/body_map%05d.imat", 
           Get_String_Arg(const_cast<char*>("-o")), planeId);
       IMatrix_Write(filePath, out);
@@ -670,7 +995,6 @@ int main(int argc, char *argv[])
     if (ds_stack != stack) {
       Free_Stack(ds_stack);
     }
-    Kill_Intpair_Map(superpixelBodyMap);
   }
 
   printf("map_body succeeded\n");
@@ -20,21 +20,116 @@
 #include "tz_stack_utils.h"
 #include "zstring.h"
 #include "zargumentprocessor.h"
+#include "zhdf5reader.h"
+#include "zhdf5blockiterator.h"
+#include "zarray.h"
 
 using namespace std;
 
+template<typename T>
+static void collect_body_id(const ZArray *block, std::set<uint64_t> *bodyIdSet)
+{
+  const T *array = block->getDataPointer<T>();
+  size_t voxelNumber = block->getElementNumber();
+  for (size_t offset = 0; offset < voxelNumber; ++offset) {
+    //Labels come in runs, so only the first voxel of a run is inserted
+    if (offset == 0 || array[offset] != array[offset - 1]) {
+      bodyIdSet->insert((uint64_t) array[offset]);
+    }
+  }
+}
+
+/*!
+ * Collect the ids of a label dataset block by block so that the volume does
+ * not have to fit into the memory.
+ */
+static bool collect_body_id(const std::string &filePath,
+                            const std::string &dataPath,
+                            std::set<uint64_t> *bodyIdSet)
+{
+  ZHdf5Reader reader;
+  if (!reader.open(filePath)) {
+    cout << "Cannot open " << filePath << endl;
+    return false;
+  }
+
+  mylib::Value_Type type = reader.getValueType(dataPath);
+  ZHdf5BlockIterator iter(&reader, dataPath);
+  size_t blockIndex = 0;
+  while (iter.hasNext()) {
+    ZArray *block = iter.next();
+    if (block == NULL) {
+      cout << "Failed to read block " << blockIndex << endl;
+      return false;
+    }
+
+    switch (type) {
+    case mylib::UINT8_TYPE:
+      collect_body_id<uint8_t>(block, bodyIdSet);
+      break;
+    case mylib::UINT16_TYPE:
+      collect_body_id<uint16_t>(block, bodyIdSet);
+      break;
+    case mylib::UINT32_TYPE:
+      collect_body_id<uint32_t>(block, bodyIdSet);
+      break;
+    case mylib::UINT64_TYPE:
+      collect_body_id<uint64_t>(block, bodyIdSet);
+      break;
+    case mylib::INT32_TYPE:
+      collect_body_id<int32_t>(block, bodyIdSet);
+      break;
+    case mylib::INT64_TYPE:
+      collect_body_id<int64_t>(block, bodyIdSet);
+      break;
+    default:
+      cout << "Unsupported label type." << endl;
+      delete block;
+      return false;
+    }
+
+    delete block;
+    ++blockIndex;
+  }
+
+  return true;
+}
+
 int main(int argc, char *argv[])
 {
   if (Show_Version(argc, argv, "0.1") == 1) {
     return 0;
   }
 
-  static char const *Spec[] = {"<input:string> -o <string>", NULL};
+  static char const *Spec[] = {"<input:string> -o <string>",
+                               "[--dataset <string>]", NULL};
 
   ZArgumentProcessor::processArguments(argc, argv, Spec);
 
   ZString filePath = ZArgumentProcessor::getStringArg("input");
 
+  if (ZArgumentProcessor::isArgMatched("--dataset")) {
+    std::set<uint64_t> bodyIdSet;
+    if (!collect_body_id(filePath, ZArgumentProcessor::getStringArg("--dataset"),
+                         &bodyIdSet)) {
+      return 1;
+    }
+
+    cout << bodyIdSet.size() << " ids" << endl;
+
+    ofstream stream(ZArgumentProcessor::getStringArg("-o"));
+    for (std::set<uint64_t>::const_iterator iter = bodyIdSet.begin();
+         iter != bodyIdSet.end(); ++iter) {
+      stream << *iter << endl;
+    }
+    stream.close();
+
+    cout << "Results saved into " << ZArgumentProcessor::getStringArg("-o")
+         << endl;
+
+    return 0;
+  }
+
   Stack *stack = Read_Stack_U(filePath.c_str());
   Stack *additionalStack = NULL;
   ZString additionalFilePath =
@@ -0,0 +1,688 @@
+#include "zchunkedstack.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#if defined(_WIN32) || defined(_WIN64)
+#include <stdio.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "c_stack.h"
+#include "tz_image_io.h"
+#include "zstack.hxx"
+
+#define CHUNKED_STACK_HEADER_SIZE 64
+#define CHUNKED_STACK_MAGIC "ZCHUNKED"
+#define CHUNKED_STACK_VERSION 1
+
+namespace {
+
+ZBlockGrid MakeChunkGrid(int width, int height, int depth,
+                         int chunkWidth, int chunkHeight, int chunkDepth,
+                         const ZIntPoint &offset)
+{
+  ZBlockGrid grid;
+  grid.setBlockSize(chunkWidth, chunkHeight, chunkDepth);
+  grid.setGridSize((width + chunkWidth - 1) / chunkWidth,
+                   (height + chunkHeight - 1) / chunkHeight,
+                   (depth + chunkDepth - 1) / chunkDepth);
+  grid.setMinPoint(offset);
+
+  return grid;
+}
+
+template<typename T>
+void UpdateProjection(const T *chunk, const ZIntCuboid &chunkBox,
+                      const ZIntCuboid &box, bool isMax, bool isFirst,
+                      T *proj, int projWidth, const ZIntPoint &minPoint)
+{
+  size_t chunkWidth = chunkBox.getWidth();
+  size_t chunkArea = chunkWidth * chunkBox.getHeight();
+  for (int z = box.getFirstCorner().getZ(); z <= box.getLastCorner().getZ();
+       ++z) {
+    for (int y = box.getFirstCorner().getY(); y <= box.getLastCorner().getY();
+         ++y) {
+      const T *src = chunk +
+          chunkArea * (z - chunkBox.getFirstCorner().getZ()) +
+          chunkWidth * (y - chunkBox.getFirstCorner().getY()) +
+          box.getFirstCorner().getX() - chunkBox.getFirstCorner().getX();
+      T *dst = proj + (size_t) projWidth * (y - minPoint.getY()) +
+          box.getFirstCorner().getX() - minPoint.getX();
+      int length = box.getWidth();
+      if (isFirst && z == box.getFirstCorner().getZ()) {
+        memcpy(dst, src, sizeof(T) * length);
+      } else if (isMax) {
+        for (int i = 0; i < length; ++i) {
+          if (dst[i] < src[i]) {
+            dst[i] = src[i];
+          }
+        }
+      } else {
+        for (int i = 0; i < length; ++i) {
+          if (dst[i] > src[i]) {
+            dst[i] = src[i];
+          }
+        }
+      }
+    }
+  }
+}
+
+}
+
+ZChunkedStack::ZChunkedStack()
+{
+  m_cacheLimit = 256 * 1024 * 1024;
+  m_fp = NULL;
+  init();
+}
+
+ZChunkedStack::~ZChunkedStack()
+{
+  close();
+}
+
+void ZChunkedStack::init()
+{
+  m_kind = 0;
+  m_width = 0;
+  m_height = 0;
+  m_depth = 0;
+  m_channelNumber = 0;
+  m_chunkByteNumber = 0;
+  m_cacheUsage = 0;
+  setBlockSize(0, 0, 0);
+  setGridSize(0, 0, 0);
+  setMinPoint(0, 0, 0);
+}
+
+bool ZChunkedStack::open(const std::string &filePath)
+{
+  close();
+
+  FILE *fp = fopen(filePath.c_str(), "rb");
+  if (fp == NULL) {
+    return false;
+  }
+
+  char header[CHUNKED_STACK_HEADER_SIZE];
+  int32_t attribute[12];
+  if (fread(header, 1, CHUNKED_STACK_HEADER_SIZE, fp) !=
+      CHUNKED_STACK_HEADER_SIZE ||
+      memcmp(header, CHUNKED_STACK_MAGIC, 8) != 0) {
+    fclose(fp);
+    return false;
+  }
+  memcpy(attribute, header + 8, sizeof(attribute));
+
+  int kind = attribute[1];
+  if (attribute[0] != CHUNKED_STACK_VERSION ||
+      (kind != GREY && kind != GREY16 && kind != COLOR && kind != FLOAT32 &&
+       kind != FLOAT64)) {
+    fclose(fp);
+    return false;
+  }
+
+  for (int i = 2; i <= 8; ++i) {
+    if (attribute[i] <= 0) {
+      fclose(fp);
+      return false;
+    }
+  }
+
+  m_fp = fp;
+  m_source = filePath;
+  m_kind = kind;
+  m_width = attribute[2];
+  m_height = attribute[3];
+  m_depth = attribute[4];
+  m_channelNumber = attribute[5];
+
+  ZBlockGrid grid = MakeChunkGrid(
+        m_width, m_height, m_depth, attribute[6], attribute[7], attribute[8],
+        ZIntPoint(attribute[9], attribute[10], attribute[11]));
+  setBlockSize(grid.getBlockSize());
+  setGridSize(grid.getGridSize());
+  setMinPoint(grid.getMinPoint());
+  m_chunkByteNumber = (size_t) attribute[6] * attribute[7] * attribute[8] *
+      m_kind;
+
+  //Accessing a mapped chunk beyond the end of the file would crash
+  int64_t fileSize = CHUNKED_STACK_HEADER_SIZE +
+      (int64_t) m_channelNumber * getBlockNumber() * m_chunkByteNumber;
+#if defined(_WIN32) || defined(_WIN64)
+  bool isComplete = (_fseeki64(m_fp, 0, SEEK_END) == 0 &&
+                     _ftelli64(m_fp) >= fileSize);
+#else
+  bool isComplete = (fseeko(m_fp, 0, SEEK_END) == 0 &&
+                     ftello(m_fp) >= fileSize);
+#endif
+  if (!isComplete) {
+    close();
+    return false;
+  }
+
+  return true;
+}
+
+void ZChunkedStack::close()
+{
+  clearCache();
+
+  for (std::map<std::pair<int, int>, Stack*>::iterator
+       iter = m_projection.begin(); iter != m_projection.end(); ++iter) {
+    C_Stack::kill(iter->second);
+  }
+  m_projection.clear();
+
+  if (m_fp != NULL) {
+    fclose(m_fp);
+    m_fp = NULL;
+  }
+  m_source.clear();
+  init();
+}
+
+ZIntCuboid ZChunkedStack::getBoundBox() const
+{
+  ZIntCuboid box;
+  box.setFirstCorner(getMinPoint());
+  box.setSize(m_width, m_height, m_depth);
+
+  return box;
+}
+
+void ZChunkedStack::setCacheLimit(size_t limit)
+{
+  m_cacheLimit = limit;
+  evict();
+}
+
+size_t ZChunkedStack::getCacheLimit() const
+{
+  return m_cacheLimit;
+}
+
+size_t ZChunkedStack::getCacheUsage() const
+{
+  return m_cacheUsage;
+}
+
+void ZChunkedStack::releaseChunk(Chunk &chunk)
+{
+#if defined(_WIN32) || defined(_WIN64)
+  free(chunk.data);
+#else
+  munmap(chunk.mappedAddress, chunk.mappedSize);
+#endif
+  m_cacheUsage -= m_chunkByteNumber;
+}
+
+void ZChunkedStack::clearCache()
+{
+  for (std::map<int64_t, Chunk>::iterator iter = m_chunkMap.begin();
+       iter != m_chunkMap.end(); ++iter) {
+    releaseChunk(iter->second);
+  }
+  m_chunkMap.clear();
+  m_lru.clear();
+  m_cacheUsage = 0;
+}
+
+void ZChunkedStack::evict()
+{
+  while (m_cacheUsage > m_cacheLimit && m_lru.size() > 1) {
+    std::map<int64_t, Chunk>::iterator iter = m_chunkMap.find(m_lru.back());
+    releaseChunk(iter->second);
+    m_chunkMap.erase(iter);
+    m_lru.pop_back();
+  }
+}
+
+const uint8_t* ZChunkedStack::getChunk(const ZIntPoint &blockIndex, int c)
+{
+  int index = getHashIndex(blockIndex);
+  if (index < 0 || c < 0 || c >= m_channelNumber || m_fp == NULL) {
+    return NULL;
+  }
+
+  int64_t key = (int64_t) c * getBlockNumber() + index;
+  std::map<int64_t, Chunk>::iterator iter = m_chunkMap.find(key);
+  if (iter != m_chunkMap.end()) {
+    m_lru.splice(m_lru.begin(), m_lru, iter->second.lruIter);
+    return iter->second.data;
+  }
+
+  int64_t offset = CHUNKED_STACK_HEADER_SIZE + key * m_chunkByteNumber;
+  Chunk chunk;
+#if defined(_WIN32) || defined(_WIN64)
+  chunk.data = (uint8_t*) malloc(m_chunkByteNumber);
+  chunk.mappedAddress = NULL;
+  chunk.mappedSize = 0;
+  if (_fseeki64(m_fp, offset, SEEK_SET) != 0 ||
+      fread(chunk.data, 1, m_chunkByteNumber, m_fp) != m_chunkByteNumber) {
+    free(chunk.data);
+    return NULL;
+  }
+#else
+  //Mapping has to start at a page boundary
+  int64_t pageSize = sysconf(_SC_PAGESIZE);
+  int64_t mappedOffset = offset - offset % pageSize;
+  chunk.mappedSize = m_chunkByteNumber + (offset - mappedOffset);
+  chunk.mappedAddress = mmap(NULL, chunk.mappedSize, PROT_READ, MAP_PRIVATE,
+                             fileno(m_fp), (off_t) mappedOffset);
+  if (chunk.mappedAddress == MAP_FAILED) {
+    return NULL;
+  }
+  chunk.data = (uint8_t*) chunk.mappedAddress + (offset - mappedOffset);
+#endif
+
+  m_lru.push_front(key);
+  chunk.lruIter = m_lru.begin();
+  m_chunkMap[key] = chunk;
+  m_cacheUsage += m_chunkByteNumber;
+
+  //The requested chunk is at the front and is never dropped here
+  evict();
+
+  return chunk.data;
+}
+
+const uint8_t* ZChunkedStack::getVoxel(int x, int y, int z, int c)
+{
+  if (!getBoundBox().contains(x, y, z)) {
+    return NULL;
+  }
+
+  ZBlockGrid::Location location = getLocation(x, y, z);
+  const uint8_t *chunk = getChunk(location.getBlockIndex(), c);
+  if (chunk == NULL) {
+    return NULL;
+  }
+
+  const ZIntPoint &pos = location.getLocalPosition();
+  const ZIntPoint &blockSize = getBlockSize();
+  size_t offset = ((size_t) blockSize.getY() * pos.getZ() + pos.getY()) *
+      blockSize.getX() + pos.getX();
+
+  return chunk + offset * m_kind;
+}
+
+double ZChunkedStack::value(int x, int y, int z, int c)
+{
+  const uint8_t *voxel = getVoxel(x, y, z, c);
+  if (voxel == NULL) {
+    return 0.0;
+  }
+
+  Stack voxelView;
+  C_Stack::setAttribute(&voxelView, m_kind, 1, 1, 1);
+  voxelView.array = const_cast<uint8_t*>(voxel);
+  voxelView.text = NULL;
+
+  return C_Stack::value(&voxelView, 0);
+}
+
+int ZChunkedStack::getIntValue(int x, int y, int z, int c)
+{
+  const uint8_t *voxel = getVoxel(x, y, z, c);
+  if (voxel == NULL) {
+    return 0;
+  }
+
+  Image_Array ima;
+  ima.array = const_cast<uint8_t*>(voxel);
+  switch (m_kind) {
+  case GREY:
+    return ima.array8[0];
+  case COLOR: {
+    int v = ima.arrayc[0][2];
+    v = (v << 8) + ima.arrayc[0][1];
+    v = (v << 8) + ima.arrayc[0][0];
+    return v;
+  }
+  case GREY16:
+    return ima.array16[0];
+  case FLOAT32:
+    return ima.array32[0];
+  case FLOAT64:
+    return ima.array64[0];
+  }
+
+  return 0;
+}
+
+int ZChunkedStack::maxIntensityDepth(int x, int y, int c)
+{
+  int slice = 0;
+  double maxValue = 0.0;
+  for (int z = 0; z < m_depth; ++z) {
+    double v = value(x, y, z + getMinPoint().getZ(), c);
+    if (z == 0 || v > maxValue) {
+      maxValue = v;
+      slice = z;
+    }
+  }
+
+  return slice;
+}
+
+Stack* ZChunkedStack::readBlock(const ZIntCuboid &box, int c, Stack *out)
+{
+  if (box.isEmpty()) {
+    return out;
+  }
+
+  if (out == NULL) {
+    out = C_Stack::make(
+          m_kind, box.getWidth(), box.getHeight(), box.getDepth());
+  }
+  C_Stack::setZero(out);
+
+  ZIntCuboid range = box;
+  range.intersect(getBoundBox());
+  if (range.isEmpty()) {
+    return out;
+  }
+
+  size_t outRowByteNumber = (size_t) box.getWidth() * m_kind;
+  size_t outPlaneByteNumber = outRowByteNumber * box.getHeight();
+  size_t chunkRowByteNumber = (size_t) getBlockSize().getX() * m_kind;
+  size_t chunkPlaneByteNumber = chunkRowByteNumber * getBlockSize().getY();
+
+  ZIntPoint firstIndex = getBlockIndex(range.getFirstCorner().getX(),
+                                       range.getFirstCorner().getY(),
+                                       range.getFirstCorner().getZ());
+  ZIntPoint lastIndex = getBlockIndex(range.getLastCorner().getX(),
+                                      range.getLastCorner().getY(),
+                                      range.getLastCorner().getZ());
+
+  for (int bz = firstIndex.getZ(); bz <= lastIndex.getZ(); ++bz) {
+    for (int by = firstIndex.getY(); by <= lastIndex.getY(); ++by) {
+      for (int bx = firstIndex.getX(); bx <= lastIndex.getX(); ++bx) {
+        ZIntPoint blockIndex(bx, by, bz);
+        const uint8_t *chunk = getChunk(blockIndex, c);
+        if (chunk == NULL) {
+          continue;
+        }
+
+        ZIntCuboid chunkBox = getBlockBox(blockIndex);
+        ZIntCuboid copyBox = chunkBox;
+        copyBox.intersect(range);
+
+        const ZIntPoint &first = copyBox.getFirstCorner();
+        size_t length = copyBox.getWidth() * m_kind;
+        for (int z = first.getZ(); z <= copyBox.getLastCorner().getZ(); ++z) {
+          for (int y = first.getY(); y <= copyBox.getLastCorner().getY(); ++y) {
+            const uint8_t *src = chunk +
+                chunkPlaneByteNumber * (z - chunkBox.getFirstCorner().getZ()) +
+                chunkRowByteNumber * (y - chunkBox.getFirstCorner().getY()) +
+                (size_t) m_kind * (first.getX() -
+                                   chunkBox.getFirstCorner().getX());
+            uint8_t *dst = out->array +
+                outPlaneByteNumber * (z - box.getFirstCorner().getZ()) +
+                outRowByteNumber * (y - box.getFirstCorner().getY()) +
+                (size_t) m_kind * (first.getX() - box.getFirstCorner().getX());
+            memcpy(dst, src, length);
+          }
+        }
+      }
+    }
+  }
+
+  return out;
+}
+
+Stack* ZChunkedStack::readSlice(int z, int c, Stack *out)
+{
+  ZIntCuboid box = getBoundBox();
+  box.setFirstZ(z);
+  box.setLastZ(z);
+
+  return readBlock(box, c, out);
+}
+
+ZStack* ZChunkedStack::makeCrop(const ZIntCuboid &box)
+{
+  if (box.isEmpty() || !isOpen()) {
+    return NULL;
+  }
+
+  ZStack *stack = new ZStack(m_kind, box, m_channelNumber);
+  for (int c = 0; c < m_channelNumber; ++c) {
+    readBlock(box, c, stack->c_stack(c));
+  }
+
+  return stack;
+}
+
+const Stack* ZChunkedStack::projection(
+    ZSingleChannelStack::Proj_Mode mode, int c)
+{
+  if (!isOpen() || c < 0 || c >= m_channelNumber || m_kind == COLOR) {
+    return NULL;
+  }
+
+  std::pair<int, int> key(mode, c);
+  if (m_projection.count(key) > 0) {
+    return m_projection[key];
+  }
+
+  Stack *proj = C_Stack::make(m_kind, m_width, m_height, 1);
+  Image_Array ima;
+  ima.array = proj->array;
+  bool isMax = (mode == ZSingleChannelStack::MAX_PROJ);
+  ZIntCuboid boundBox = getBoundBox();
+  const ZIntPoint &minPoint = getMinPoint();
+
+  for (int bz = 0; bz < getGridSize().getZ(); ++bz) {
+    for (int by = 0; by < getGridSize().getY(); ++by) {
+      for (int bx = 0; bx < getGridSize().getX(); ++bx) {
+        ZIntPoint blockIndex(bx, by, bz);
+        Image_Array chunk;
+        chunk.array = const_cast<uint8_t*>(getChunk(blockIndex, c));
+        if (chunk.array == NULL) {
+          C_Stack::kill(proj);
+          return NULL;
+        }
+
+        ZIntCuboid chunkBox = getBlockBox(blockIndex);
+        ZIntCuboid box = chunkBox;
+        box.intersect(boundBox);
+        bool isFirst = (bz == 0);
+        switch (m_kind) {
+        case GREY:
+          UpdateProjection(chunk.array8, chunkBox, box, isMax, isFirst,
+                           ima.array8, m_width, minPoint);
+          break;
+        case GREY16:
+          UpdateProjection(chunk.array16, chunkBox, box, isMax, isFirst,
+                           ima.array16, m_width, minPoint);
+          break;
+        case FLOAT32:
+          UpdateProjection(chunk.array32, chunkBox, box, isMax, isFirst,
+                           ima.array32, m_width, minPoint);
+          break;
+        case FLOAT64:
+          UpdateProjection(chunk.array64, chunkBox, box, isMax, isFirst,
+                           ima.array64, m_width, minPoint);
+          break;
+        default:
+          break;
+        }
+      }
+    }
+  }
+
+  m_projection[key] = proj;
+
+  return proj;
+}
+
+bool ZChunkedStack::WriteHeader(
+    FILE *fp, int kind, int width, int height, int depth, int nchannel,
+    const ZBlockGrid &grid)
+{
+  char header[CHUNKED_STACK_HEADER_SIZE];
+  memset(header, 0, CHUNKED_STACK_HEADER_SIZE);
+  memcpy(header, CHUNKED_STACK_MAGIC, 8);
+
+  int32_t attribute[12] = {
+    CHUNKED_STACK_VERSION, kind, width, height, depth, nchannel,
+    grid.getBlockSize().getX(), grid.getBlockSize().getY(),
+    grid.getBlockSize().getZ(), grid.getMinPoint().getX(),
+    grid.getMinPoint().getY(), grid.getMinPoint().getZ()
+  };
+  memcpy(header + 8, attribute, sizeof(attribute));
+
+  return fwrite(header, 1, CHUNKED_STACK_HEADER_SIZE, fp) ==
+      CHUNKED_STACK_HEADER_SIZE;
+}
+
+bool ZChunkedStack::WriteChunkLayer(
+    FILE *fp, const Stack *layer, const ZBlockGrid &grid)
+{
+  int kind = C_Stack::kind(layer);
+  int width = C_Stack::width(layer);
+  int height = C_Stack::height(layer);
+  int depth = C_Stack::depth(layer);
+  const ZIntPoint &blockSize = grid.getBlockSize();
+  size_t chunkRowByteNumber = (size_t) blockSize.getX() * kind;
+  size_t chunkPlaneByteNumber = chunkRowByteNumber * blockSize.getY();
+  size_t chunkByteNumber = chunkPlaneByteNumber * blockSize.getZ();
+  size_t rowByteNumber = (size_t) width * kind;
+  size_t planeByteNumber = rowByteNumber * height;
+
+  std::vector<uint8_t> chunk(chunkByteNumber);
+  for (int by = 0; by < grid.getGridSize().getY(); ++by) {
+    for (int bx = 0; bx < grid.getGridSize().getX(); ++bx) {
+      int x0 = bx * blockSize.getX();
+      int y0 = by * blockSize.getY();
+      int chunkWidth = std::min(blockSize.getX(), width - x0);
+      int chunkHeight = std::min(blockSize.getY(), height - y0);
+      if (chunkWidth < blockSize.getX() || chunkHeight < blockSize.getY() ||
+          depth < blockSize.getZ()) {
+        std::fill(chunk.begin(), chunk.end(), 0);
+      }
+      for (int z = 0; z < depth; ++z) {
+        for (int y = 0; y < chunkHeight; ++y) {
+          memcpy(&(chunk[0]) + chunkPlaneByteNumber * z + chunkRowByteNumber * y,
+              layer->array + planeByteNumber * z + rowByteNumber * (y0 + y) +
+              (size_t) x0 * kind, (size_t) chunkWidth * kind);
+        }
+      }
+      if (fwrite(&(chunk[0]), 1, chunkByteNumber, fp) != chunkByteNumber) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+bool ZChunkedStack::Write(const std::string &filePath, const ZStack &stack,
+                          int chunkWidth, int chunkHeight, int chunkDepth)
+{
+  if (!stack.hasData() || chunkWidth <= 0 || chunkHeight <= 0 ||
+      chunkDepth <= 0) {
+    return false;
+  }
+
+  FILE *fp = fopen(filePath.c_str(), "wb");
+  if (fp == NULL) {
+    return false;
+  }
+
+  ZBlockGrid grid = MakeChunkGrid(
+        stack.width(), stack.height(), stack.depth(),
+        chunkWidth, chunkHeight, chunkDepth, stack.getOffset());
+  bool succ = WriteHeader(fp, stack.kind(), stack.width(), stack.height(),
+                          stack.depth(), stack.channelNumber(), grid);
+  for (int c = 0; c < stack.channelNumber() && succ; ++c) {
+    for (int z0 = 0; z0 < stack.depth() && succ; z0 += chunkDepth) {
+      Stack layer;
+      C_Stack::setAttribute(&layer, stack.kind(), stack.width(),
+                            stack.height(),
+                            std::min(chunkDepth, stack.depth() - z0));
+      layer.array = (uint8_t*) stack.getDataPointer(c, z0);
+      layer.text = NULL;
+      succ = WriteChunkLayer(fp, &layer, grid);
+    }
+  }
+  fclose(fp);
+
+  if (!succ) {
+    remove(filePath.c_str());
+  }
+
+  return succ;
+}
+
+bool ZChunkedStack::ConvertImageSeries(
+    const std::vector<std::string> &fileList, const std::string &filePath,
+    int chunkWidth, int chunkHeight, int chunkDepth)
+{
+  if (fileList.empty() || chunkWidth <= 0 || chunkHeight <= 0 ||
+      chunkDepth <= 0) {
+    return false;
+  }
+
+  Stack *slice = Read_Sc_Stack(fileList[0].c_str(), 0);
+  if (slice == NULL) {
+    return false;
+  }
+  int kind = C_Stack::kind(slice);
+  int width = C_Stack::width(slice);
+  int height = C_Stack::height(slice);
+  int depth = fileList.size();
+  int nchannel = ZStack::getChannelNumber(fileList[0]);
+  C_Stack::kill(slice);
+
+  FILE *fp = fopen(filePath.c_str(), "wb");
+  if (fp == NULL) {
+    return false;
+  }
+
+  ZBlockGrid grid = MakeChunkGrid(width, height, depth,
+                                  chunkWidth, chunkHeight, chunkDepth,
+                                  ZIntPoint(0, 0, 0));
+  bool succ = WriteHeader(fp, kind, width, height, depth, nchannel, grid);
+
+  Stack *layerBuffer = C_Stack::make(kind, width, height, chunkDepth);
+  size_t planeByteNumber = (size_t) width * height * kind;
+  for (int c = 0; c < nchannel && succ; ++c) {
+    for (int z0 = 0; z0 < depth && succ; z0 += chunkDepth) {
+      Stack layer = C_Stack::sliceView(
+            layerBuffer, 0, std::min(chunkDepth, depth - z0) - 1);
+      for (int z = 0; z < C_Stack::depth(&layer) && succ; ++z) {
+        slice = Read_Sc_Stack(fileList[z0 + z].c_str(), c);
+        if (slice == NULL || C_Stack::kind(slice) != kind ||
+            C_Stack::width(slice) != width ||
+            C_Stack::height(slice) != height ||
+            C_Stack::depth(slice) != 1) {
+          succ = false;
+        } else {
+          memcpy(layer.array + planeByteNumber * z, slice->array,
+                 planeByteNumber);
+        }
+        if (slice != NULL) {
+          C_Stack::kill(slice);
+        }
+      }
+      if (succ) {
+        succ = WriteChunkLayer(fp, &layer, grid);
+      }
+    }
+  }
+  C_Stack::kill(layerBuffer);
+  fclose(fp);
+
+  if (!succ) {
+    remove(filePath.c_str());
+  }
+
+  return succ;
+}
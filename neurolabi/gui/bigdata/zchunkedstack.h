@@ -0,0 +1,152 @@
+#ifndef ZCHUNKEDSTACK_H
+#define ZCHUNKEDSTACK_H
+
+#include <cstdio>
+#include <map>
+#include <list>
+#include <string>
+#include <vector>
+#include <utility>
+
+#include "tz_stdint.h"
+#include "tz_image_lib_defs.h"
+#include "zblockgrid.h"
+#include "zsinglechannelstack.h"
+
+class ZStack;
+
+/*!
+ * \brief The class of a stack stored in chunks on disk
+ *
+ * A chunked stack file has a 64-byte header followed by the chunks of each
+ * channel. The chunks of a channel are ordered in the same way as the hash
+ * indices of the block grid and the voxels in a chunk are ordered in the same
+ * way as the voxels of a stack. Chunks on the borders are padded with 0 so
+ * that all chunks have the same size and can be located without an index.
+ *
+ * Chunks are mapped into memory on request and kept in a cache. The least
+ * recently used chunks are released when the cache exceeds its size limit, so
+ * a stack much larger than the memory can be browsed and processed in place.
+ * All coordinates are global, i.e. the minimal point of the grid is the offset
+ * of the stack.
+ */
+class ZChunkedStack : public ZBlockGrid
+{
+public:
+  ZChunkedStack();
+  ~ZChunkedStack();
+
+  bool open(const std::string &filePath);
+  void close();
+
+  inline bool isOpen() const { return m_fp != NULL; }
+  inline const std::string& getSource() const { return m_source; }
+
+  inline int kind() const { return m_kind; }
+  inline int width() const { return m_width; }
+  inline int height() const { return m_height; }
+  inline int depth() const { return m_depth; }
+  inline int channelNumber() const { return m_channelNumber; }
+
+  ZIntCuboid getBoundBox() const;
+
+  /*!
+   * \brief Voxel value at a global position.
+   *
+   * It returns 0 if the position is out of range.
+   */
+  double value(int x, int y, int z, int c);
+  int getIntValue(int x, int y, int z, int c);
+
+  /*!
+   * \brief The slice with the maximal value at (\a x, \a y) in channel \a c.
+   */
+  int maxIntensityDepth(int x, int y, int c);
+
+  /*!
+   * \brief Read a block of a channel.
+   *
+   * Voxels out of the stack are set to 0. A new stack is returned if \a out
+   * is NULL. Otherwise \a out must have the size of \a box.
+   */
+  Stack* readBlock(const ZIntCuboid &box, int c, Stack *out = NULL);
+  Stack* readSlice(int z, int c, Stack *out = NULL);
+
+  /*!
+   * \brief Read a block of all channels into a stack with the offset of the
+   * first corner of \a box.
+   */
+  ZStack* makeCrop(const ZIntCuboid &box);
+
+  /*!
+   * \brief Projection of a channel along Z.
+   *
+   * The projection is computed chunk by chunk and kept until the stack is
+   * closed. It returns NULL for COLOR stacks.
+   */
+  const Stack* projection(ZSingleChannelStack::Proj_Mode mode, int c);
+
+  /*!
+   * \brief Set the size limit (bytes) of the chunk cache.
+   */
+  void setCacheLimit(size_t limit);
+  size_t getCacheLimit() const;
+  size_t getCacheUsage() const;
+  void clearCache();
+
+  inline size_t getChunkByteNumber() const { return m_chunkByteNumber; }
+
+  /*!
+   * \brief Write a stack into a chunked stack file.
+   */
+  static bool Write(const std::string &filePath, const ZStack &stack,
+                    int chunkWidth, int chunkHeight, int chunkDepth);
+
+  /*!
+   * \brief Convert an image series into a chunked stack file.
+   *
+   * Each file in \a fileList is a slice. Only one layer of chunks of a channel
+   * is kept in memory during the conversion.
+   */
+  static bool ConvertImageSeries(
+      const std::vector<std::string> &fileList, const std::string &filePath,
+      int chunkWidth, int chunkHeight, int chunkDepth);
+
+private:
+  struct Chunk {
+    uint8_t *data;
+    void *mappedAddress;
+    size_t mappedSize;
+    std::list<int64_t>::iterator lruIter;
+  };
+
+  const uint8_t* getChunk(const ZIntPoint &blockIndex, int c);
+  const uint8_t* getVoxel(int x, int y, int z, int c);
+  void releaseChunk(Chunk &chunk);
+  void evict();
+  void init();
+
+  static bool WriteHeader(FILE *fp, int kind, int width, int height, int depth,
+                          int nchannel, const ZBlockGrid &grid);
+  static bool WriteChunkLayer(FILE *fp, const Stack *layer,
+                              const ZBlockGrid &grid);
+
+private:
+  FILE *m_fp;
+  std::string m_source;
+  int m_kind;
+  int m_width;
+  int m_height;
+  int m_depth;
+  int m_channelNumber;
+  size_t m_chunkByteNumber;
+
+  std::map<int64_t, Chunk> m_chunkMap;
+  std::list<int64_t> m_lru; //most recent first
+  size_t m_cacheLimit;
+  size_t m_cacheUsage;
+
+  std::map<std::pair<int, int>, Stack*> m_projection; //(mode, channel)
+};
+
+#endif // ZCHUNKEDSTACK_H
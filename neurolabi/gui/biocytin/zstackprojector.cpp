@@ -1,4 +1,10 @@
 #include "zstackprojector.h"
+#include <algorithm>
+#if defined(_QT_GUI_USED_)
+#include <QFuture>
+#include <QThread>
+#include <QtConcurrentRun>
+#endif
 #include "biocytin.h"
 #include "zstack.hxx"
 #include "tz_stack_lib.h"
@@ -77,6 +83,208 @@ double Biocytin::ZStackProjector::colorToValueH(
   return dmin2(sr, sg) * h * h;
 }
 
+void Biocytin::ZStackProjector::colorToValueH(
+    const float *red, const float *green, const float *blue, size_t n,
+    double *value)
+{
+  for (size_t i = 0; i < n; ++i) {
+    double sr = red[i];
+    double sg = green[i];
+    double sb = (blue == NULL) ? 0.0 : blue[i];
+
+    int ir = iround(sr);
+    int ig = iround(sg);
+    int ib = iround(sb);
+    ir = (ir < 0) ? 0 : ((ir > 255) ? 255 : ir);
+    ig = (ig < 0) ? 0 : ((ig > 255) ? 255 : ig);
+    ib = (ib < 0) ? 0 : ((ib > 255) ? 255 : ib);
+
+    double r = ir / 255.0;
+    double g = ig / 255.0;
+    double b = ib / 255.0;
+
+    double delta = MAX2(r, g) - b;
+    double h = (delta > 0.0) ? 1.0 - (r - g) / delta : 0.0;
+    h = dmin2(h, 6.0 - h);
+    h = (h < 0.0) ? 0.0 : h;
+
+    value[i] = dmin2(sr, sg) * h * h;
+  }
+}
+
+int Biocytin::ZStackProjector::getSliceBatchSize() const
+{
+  int batchSize = 1;
+#if defined(_QT_GUI_USED_)
+  //Gaussian smoothing goes through FFTW planning, which is not thread safe
+  if (m_speedLevel != 0) {
+    batchSize = std::max(1, QThread::idealThreadCount());
+  }
+#endif
+
+  return batchSize;
+}
+
+Biocytin::ZStackProjector::SliceBuffer::SliceBuffer()
+{
+  for (int ch = 0; ch < 3; ++ch) {
+    slice[ch] = NULL;
+    matrix[ch] = NULL;
+    blockMean[ch] = NULL;
+    smoothed[ch] = NULL;
+  }
+}
+
+void Biocytin::ZStackProjector::makeSliceBuffer(
+    const ZStack *stack, SliceBuffer *buffer)
+{
+  int channelNumber = std::min(3, stack->channelNumber());
+  dim_type dim[3];
+  dim[0] = stack->width();
+  dim[1] = stack->height();
+  dim[2] = 1;
+  for (int ch = 0; ch < channelNumber; ++ch) {
+    buffer->slice[ch] = C_Stack::make(
+          C_Stack::kind(stack->c_stack(ch)), stack->width(), stack->height(), 1);
+    buffer->matrix[ch] = Make_FMatrix(dim, 3);
+    if (m_speedLevel == 1) {
+      //Sizes of the two block means of Smooth_Stack_Fast_F
+      dim_type smoothDim[3] = { dim[0] + 4, dim[1] + 4, 1 };
+      buffer->blockMean[ch] = Make_FMatrix(smoothDim, 3);
+      smoothDim[0] += 4;
+      smoothDim[1] += 4;
+      buffer->smoothed[ch] = Make_FMatrix(smoothDim, 3);
+    }
+  }
+}
+
+void Biocytin::ZStackProjector::killSliceBuffer(SliceBuffer *buffer)
+{
+  for (int ch = 0; ch < 3; ++ch) {
+    if (buffer->slice[ch] != NULL) {
+      C_Stack::kill(buffer->slice[ch]);
+      buffer->slice[ch] = NULL;
+    }
+    if (buffer->matrix[ch] != NULL) {
+      Kill_FMatrix(buffer->matrix[ch]);
+      buffer->matrix[ch] = NULL;
+    }
+    if (buffer->blockMean[ch] != NULL) {
+      Kill_FMatrix(buffer->blockMean[ch]);
+      buffer->blockMean[ch] = NULL;
+    }
+    if (buffer->smoothed[ch] != NULL) {
+      Kill_FMatrix(buffer->smoothed[ch]);
+      buffer->smoothed[ch] = NULL;
+    }
+  }
+}
+
+//Same as Get_Float_Matrix3() without allocating the matrix
+static void load_float_matrix(const Stack *stack, FMatrix *dm)
+{
+  size_t length = C_Stack::voxelNumber(stack);
+  const uint16 *array16 = (const uint16*) (stack->array);
+  const float32 *array32 = (const float32*) (stack->array);
+  const float64 *array64 = (const float64*) (stack->array);
+  const color_t *arrayColor = (const color_t*) (stack->array);
+
+  switch (stack->kind) {
+  case GREY:
+    for (size_t i = 0; i < length; ++i) {
+      dm->array[i] = (float) (stack->array[i]);
+    }
+    break;
+  case GREY16:
+    for (size_t i = 0; i < length; ++i) {
+      dm->array[i] = (float) (array16[i]);
+    }
+    break;
+  case FLOAT32:
+    for (size_t i = 0; i < length; ++i) {
+      dm->array[i] = (float) (array32[i]);
+    }
+    break;
+  case FLOAT64:
+    for (size_t i = 0; i < length; ++i) {
+      dm->array[i] = (float) (array64[i]);
+    }
+    break;
+  case COLOR:
+    for (size_t i = 0; i < length; ++i) {
+      dm->array[i] = (float) (arrayColor[i][0]) + (float) (arrayColor[i][1]) +
+          (float) (arrayColor[i][2]);
+    }
+    break;
+  default:
+    break;
+  }
+}
+
+const FMatrix* Biocytin::ZStackProjector::smoothSlice(
+    SliceBuffer *buffer, int channel, const FMatrix *filter)
+{
+  Stack *slice = buffer->slice[channel];
+  const FMatrix *smoothed = NULL;
+  switch (m_speedLevel) {
+  case 0:
+    //FFTW planning is not thread safe either, so this level always runs on
+    //the calling thread (see getSliceBatchSize()).
+    if (m_adjustingConstrast) {
+      Stretch_Stack_Value_R(slice, m_stretchRange[channel].first,
+                            m_stretchRange[channel].second);
+    }
+    Filter_Stack_Slice_F(slice, filter, buffer->matrix[channel]);
+    Correct_Filter_Stack_F(filter, buffer->matrix[channel]);
+    smoothed = buffer->matrix[channel];
+    break;
+  case 1:
+  {
+    if (m_adjustingConstrast) {
+      Stretch_Stack_Value_R(slice, m_stretchRange[channel].first,
+                            m_stretchRange[channel].second);
+    }
+    //Smooth_Stack_Fast_F(slice, 5, 5, 1, NULL) on preallocated matrices
+    load_float_matrix(slice, buffer->matrix[channel]);
+    dim_type bdim[3] = { 5, 5, 1 };
+    FMatrix_Blocksum(buffer->matrix[channel], bdim, buffer->blockMean[channel]);
+    FMatrix_Blockmean(buffer->blockMean[channel], bdim, 1);
+    FMatrix_Blocksum(buffer->blockMean[channel], bdim,
+                     buffer->smoothed[channel]);
+    FMatrix_Blockmean(buffer->smoothed[channel], bdim, 1);
+    smoothed = buffer->smoothed[channel];
+  }
+    break;
+  default:
+    load_float_matrix(slice, buffer->matrix[channel]);
+    smoothed = buffer->matrix[channel];
+    break;
+  }
+
+  return smoothed;
+}
+
+void Biocytin::ZStackProjector::computeSliceValue(
+    const ZStack *stack, int z, const FMatrix *filter, SliceBuffer *buffer,
+    SliceValue *result)
+{
+  const FMatrix *smoothed[3] = { NULL, NULL, NULL };
+  int channelNumber = std::min(3, stack->channelNumber());
+  for (int ch = 0; ch < channelNumber; ++ch) {
+    Stack slice = C_Stack::sliceView(stack->c_stack(ch), z);
+    C_Stack::copyValue(&slice, buffer->slice[ch]);
+    smoothed[ch] = smoothSlice(buffer, ch, filter);
+  }
+
+  result->width = smoothed[0]->dim[0];
+  result->height = smoothed[0]->dim[1];
+  size_t area = (size_t) result->width * result->height;
+  result->value.resize(area);
+  colorToValueH(smoothed[0]->array, smoothed[1]->array,
+      (smoothed[2] == NULL) ? NULL : smoothed[2]->array, area,
+      &(result->value[0]));
+}
+
 ZStack* Biocytin::ZStackProjector::project(
     const ZStack *stack, NeuTube::EImageBackground bg,
     bool includingDepth, int slabIndex)
@@ -101,11 +309,11 @@ ZStack* Biocytin::ZStackProjector::project(
   } else {
     //int width = stack->width();
     //int height = stack->height();
-    int depth = stack->depth();
 
     startProgress();
 
-    if (stack != NULL) {
+    //An empty z range would leave nothing to project
+    if (stack != NULL && range.first <= range.second) {
       if (m_speedLevel == 3) {
         proj = new ZStack(stack->kind(), stack->width(), stack->height(), 1,
                           stack->channelNumber());
@@ -127,103 +335,105 @@ ZStack* Biocytin::ZStackProjector::project(
         if (stack->channelNumber() >= 2) {
           advanceProgress(0.05);
 
-          //filter->ndim = 2;
-
-          FMatrix *smoothedRed = NULL;
-          FMatrix *smoothedGreen = NULL;
-          FMatrix *smoothedBlue = NULL;
-
-          FMatrix *smoothed[3] = { NULL, NULL, NULL };
-
-          for (int ch = 0; ch  < stack->channelNumber(); ++ch) {
-            Stack *tmpStack = C_Stack::clone(stack->c_stack(ch));
-            switch (m_speedLevel) {
-            case 0:
-              smoothed[ch] = smoothStackGaussian(tmpStack);
-              break;
-            case 1:
-              smoothed[ch] = smoothStack(tmpStack);
-              break;
-            default:
-              smoothed[ch] = smoothStackNull(tmpStack);
+          //Contrast is stretched with the range of the whole channel
+          int channelNumber = std::min(3, stack->channelNumber());
+          m_stretchRange.resize(channelNumber);
+          if (m_adjustingConstrast && m_speedLevel <= 1) {
+            for (int ch = 0; ch < channelNumber; ++ch) {
+              Stack_Stretch_Range_Q(stack->c_stack(ch), 1.0,
+                                    &(m_stretchRange[ch].first),
+                                    &(m_stretchRange[ch].second));
             }
-
-            C_Stack::kill(tmpStack);
           }
 
-          smoothedRed = smoothed[0];
-          smoothedGreen = smoothed[1];
-          smoothedBlue = smoothed[2];
-
-          dim_type dim[2];
-          dim[0] = smoothedRed->dim[0];
-          dim[1] = smoothedRed->dim[1];
-          FMatrix *projMat = Make_FMatrix(dim, 2);
-
-          int pwidth = dim[0];
-          int pheight = dim[1];
-
-          const double regularizer = 0.1;
-
-          m_depthArray.resize(pwidth * pheight);
+          FMatrix *filter = NULL;
+          if (m_speedLevel == 0) {
+            double sigma[3] = {3, 3, 0};
+            filter = Gaussian_3D_Filter_2x_F(sigma, NULL);
+          }
 
-          //Construct first slice
-          size_t index = 0;
-          for (int y = 0; y < pheight; ++y) {
-            for (int x = 0; x < pwidth; ++x) {
-              double red = smoothedRed->array[index];
-              double green = smoothedGreen->array[index];
-              double blue = 0.0;
-              if (smoothedBlue != NULL) {
-                blue = smoothedBlue->array[index];
+          //Slices are smoothed in batches and merged in z order, which keeps
+          //only a few planes in memory.
+          int batchSize = getSliceBatchSize();
+          std::vector<SliceValue> sliceValue(batchSize);
+          std::vector<SliceBuffer> sliceBuffer(batchSize);
+          for (int i = 0; i < batchSize; ++i) {
+            makeSliceBuffer(stack, &(sliceBuffer[i]));
+          }
+          FMatrix *projMat = NULL;
+          int pwidth = 0;
+          int pheight = 0;
+          double sliceProgress = 0.4 / (range.second - range.first + 1);
+
+          for (int z0 = range.first; z0 <= range.second; z0 += batchSize) {
+            int currentBatchSize = std::min(batchSize, range.second - z0 + 1);
+#if defined(_QT_GUI_USED_)
+            if (currentBatchSize > 1) {
+              std::vector<QFuture<void> > res(currentBatchSize);
+              for (int i = 0; i < currentBatchSize; ++i) {
+                res[i] = QtConcurrent::run(
+                      this, &Biocytin::ZStackProjector::computeSliceValue,
+                      stack, z0 + i, (const FMatrix*) filter,
+                      &(sliceBuffer[i]), &(sliceValue[i]));
+              }
+              for (int i = 0; i < currentBatchSize; ++i) {
+                res[i].waitForFinished();
               }
-              projMat->array[index] = colorToValueH(
-                    red, green, blue, regularizer);
-              m_depthArray[index] = 0;
-              ++index;
+            } else {
+              computeSliceValue(stack, z0, filter, &(sliceBuffer[0]),
+                                &(sliceValue[0]));
             }
-          }
-
-          advanceProgress(0.1);
+#else
+            for (int i = 0; i < currentBatchSize; ++i) {
+              computeSliceValue(stack, z0 + i, filter, &(sliceBuffer[i]),
+                                &(sliceValue[i]));
+            }
+#endif
 
-          for (int z = 1; z < depth; ++z) {
-            size_t projIndex = 0;
-            for (int y = 0; y < pheight; ++y) {
-              for (int x = 0; x < pwidth; ++x) {
-                double red = smoothedRed->array[index];
-                double green = smoothedGreen->array[index];
-                double blue = 0.0;
-                if (smoothedBlue != NULL) {
-                  blue = smoothedBlue->array[index];
+            for (int i = 0; i < currentBatchSize; ++i) {
+              int z = z0 + i;
+              const std::vector<double> &value = sliceValue[i].value;
+              if (projMat == NULL) { //Construct first slice
+                pwidth = sliceValue[i].width;
+                pheight = sliceValue[i].height;
+                dim_type dim[2];
+                dim[0] = pwidth;
+                dim[1] = pheight;
+                projMat = Make_FMatrix(dim, 2);
+                m_depthArray.resize(pwidth * pheight);
+                for (size_t index = 0; index < value.size(); ++index) {
+                  projMat->array[index] = value[index];
+                  m_depthArray[index] = z;
                 }
-
-                double v = colorToValueH(
-                      red, green, blue, regularizer);
-                if (bg == NeuTube::IMAGE_BACKGROUND_BRIGHT) {
-                  if (projMat->array[projIndex] > v) {
-                    projMat->array[projIndex] = v;
-                    m_depthArray[projIndex] = z;
-                  }
-                } else {
-                  if (projMat->array[projIndex] < v) {
-                    projMat->array[projIndex] = v;
-                    m_depthArray[projIndex] = z;
+              } else {
+                for (size_t index = 0; index < value.size(); ++index) {
+                  double v = value[index];
+                  if (bg == NeuTube::IMAGE_BACKGROUND_BRIGHT) {
+                    if (projMat->array[index] > v) {
+                      projMat->array[index] = v;
+                      m_depthArray[index] = z;
+                    }
+                  } else {
+                    if (projMat->array[index] < v) {
+                      projMat->array[index] = v;
+                      m_depthArray[index] = z;
+                    }
                   }
                 }
-                ++index;
-                ++projIndex;
               }
             }
+            advanceProgress(sliceProgress * currentBatchSize);
           }
 
-          advanceProgress(0.1);
+          for (int i = 0; i < batchSize; ++i) {
+            killSliceBuffer(&(sliceBuffer[i]));
+          }
 
-#ifdef _DEBUG_2
-          Stack *tmp = Scale_Float_Stack(smoothedGreen->array, width, height, depth,
-                                         GREY);
-          C_Stack::write(NeutubeConfig::getInstance().getPath(NeutubeConfig::DATA)
-                         + "/test.tif", tmp);
-#endif
+          if (filter != NULL) {
+            Kill_FMatrix(filter);
+          }
+
+          advanceProgress(0.1);
 
           //Turn projMat into 8-bit proj
           Stack *projData = Scale_Float_Stack(
@@ -243,8 +453,8 @@ ZStack* Biocytin::ZStackProjector::project(
             depthImage = C_Stack::make(GREY16, projMat->dim[0], projMat->dim[1], 1);
             uint16_t *array = (uint16_t*) depthImage->array;
             size_t index = 0;
-            for (int y = 0; y < pwidth; ++y) {
-              for (int x = 0; x < pheight; ++x) {
+            for (int y = 0; y < pheight; ++y) {
+              for (int x = 0; x < pwidth; ++x) {
                 array[index] = m_depthArray[index];
                 ++index;
               }
@@ -259,15 +469,17 @@ ZStack* Biocytin::ZStackProjector::project(
                 stack->width(), stack->height(), 1, NULL);
             C_Stack::kill(projData);
             projData = proj2;
-            Stack *depth2 = Crop_Stack(
-                  depthImage, (projMat->dim[0] - stack->width()) / 2,
-                (projMat->dim[1] - stack->height()) / 2, 0,
-                stack->width(), stack->height(), 1, NULL);
-            C_Stack::kill(depthImage);
-            depthImage = depth2;
+            if (depthImage != NULL) {
+              Stack *depth2 = Crop_Stack(
+                    depthImage, (projMat->dim[0] - stack->width()) / 2,
+                  (projMat->dim[1] - stack->height()) / 2, 0,
+                  stack->width(), stack->height(), 1, NULL);
+              C_Stack::kill(depthImage);
+              depthImage = depth2;
+            }
           }
 
-          if (m_smoothingDepth) {
+          if (m_smoothingDepth && depthImage != NULL) {
             Stack *tmpImage = C_Stack::make(depthImage->kind, depthImage->width,
                                             depthImage->height, depthImage->depth);
             Stack_Running_Median(depthImage, 0, tmpImage);
@@ -279,11 +491,10 @@ ZStack* Biocytin::ZStackProjector::project(
           proj->load(projData, depthImage, NULL);
 
           C_Stack::kill(projData);
-          C_Stack::kill(depthImage);
-
-          for (int ch = 0; ch  < stack->channelNumber(); ++ch) {
-            Kill_FMatrix(smoothed[ch]);
+          if (depthImage != NULL) {
+            C_Stack::kill(depthImage);
           }
+          Kill_FMatrix(projMat);
         }
       }
     }
@@ -303,14 +514,6 @@ ZStack* Biocytin::ZStackProjector::project(
   return proj;
 }
 
-FMatrix* Biocytin::ZStackProjector::smoothStackNull(Stack *stack)
-{
-  FMatrix *dm = Get_Float_Matrix3(stack);
-  advanceProgress(0.2);
-
-  return dm;
-}
-
 FMatrix* Biocytin::ZStackProjector::smoothStack(Stack *stack)
 {
   if (m_adjustingConstrast) {
@@ -324,33 +527,6 @@ FMatrix* Biocytin::ZStackProjector::smoothStack(Stack *stack)
   return smoothed;
 }
 
-FMatrix* Biocytin::ZStackProjector::smoothStackGaussian(Stack *stack)
-{
-  if (m_adjustingConstrast) {
-    Stretch_Stack_Value_Q(stack, 1.0);
-  }
-  advanceProgress(0.05);
-
-  FMatrix *smoothed;
-
-  double sigma[3] = {3, 3, 0};
-  FMatrix *filter = Gaussian_3D_Filter_2x_F(sigma, NULL);
-
-  if (filter->dim[2] == 1) {
-    smoothed = Filter_Stack_Slice_F(stack, filter, NULL);
-  } else {
-    smoothed = Filter_Stack_Fast_F(stack, filter, NULL, 0);
-  }
-  advanceProgress(0.15);
-
-  Correct_Filter_Stack_F(filter, smoothed);
-  advanceProgress(0.05);
-
-  Kill_FMatrix(filter);
-
-  return smoothed;
-}
-
 std::string Biocytin::ZStackProjector::GetDefaultResultFilePath(
     const std::string &basePath, int minZ, int maxZ)
 {
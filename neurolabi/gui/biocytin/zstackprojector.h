@@ -68,6 +68,15 @@ private:
 
   double colorToValueH(double sr, double sg, double sb, double reg);
 
+  /*!
+   * \brief Convert a plane of smoothed colors into projection values.
+   *
+   * It computes the same values as colorToValueH() for \a n pixels in one
+   * branch-free loop. \a blue can be NULL, which means no blue channel.
+   */
+  static void colorToValueH(const float *red, const float *green,
+                            const float *blue, size_t n, double *value);
+
   /*!
    * \brief Get the Z range of a slab
    * \param slabIndex Starting from 0.
@@ -75,10 +84,50 @@ private:
    */
   std::pair<int, int> getSlabRange(int depth, int slabIndex);
 
+  struct SliceValue {
+    SliceValue() : width(0), height(0) {}
+    std::vector<double> value;
+    int width;
+    int height;
+  };
+
+  /*!
+   * \brief Number of slices processed together in the streaming projection.
+   */
+  int getSliceBatchSize() const;
+
+  /*!
+   * \brief Scratch buffers for computing the values of one slice.
+   *
+   * The neurolabi allocators are not thread safe, so the buffers are created
+   * and freed on the calling thread and reused by the slice workers.
+   */
+  struct SliceBuffer {
+    SliceBuffer();
+    Stack *slice[3];
+    FMatrix *matrix[3];
+    FMatrix *blockMean[3];
+    FMatrix *smoothed[3];
+  };
+
+  void makeSliceBuffer(const ZStack *stack, SliceBuffer *buffer);
+  void killSliceBuffer(SliceBuffer *buffer);
+
+  /*!
+   * \brief Compute the projection values of slice \a z.
+   *
+   * Each channel of the slice is smoothed independently with the settings of
+   * the projector. Only one slice is kept in memory. It can run in parallel
+   * for different slices as long as each call has its own \a buffer and the
+   * speed level is not 0.
+   */
+  void computeSliceValue(const ZStack *stack, int z, const FMatrix *filter,
+                         SliceBuffer *buffer, SliceValue *result);
+
 private:
-  FMatrix* smoothStackNull(Stack *stack);
   FMatrix* smoothStack(Stack *stack);
-  FMatrix* smoothStackGaussian(Stack *stack);
+  const FMatrix* smoothSlice(SliceBuffer *buffer, int channel,
+                             const FMatrix *filter);
 
 private:
   bool m_adjustingConstrast;
@@ -87,6 +136,8 @@ private:
   bool m_usingExisted;
   int m_slabCount;
   std::vector<int> m_depthArray;
+  //Contrast stretching range of each channel
+  std::vector<std::pair<int, int> > m_stretchRange;
 };
 }
 
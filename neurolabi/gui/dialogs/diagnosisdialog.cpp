@@ -109,6 +109,12 @@ void DiagnosisDialog::setVideoCardInfo(const QStringList &info)
   setVideoCardInfo(info.join("\n"));
 }
 
+void DiagnosisDialog::setDvidMetrics(const QString &str)
+{
+  if (ui->dvidMetricsTextEdit)
+    ui->dvidMetricsTextEdit->setPlainText(str);
+}
+
 void DiagnosisDialog::reloadAll()
 {
   loadErrorFile();
@@ -22,6 +22,7 @@ public:
   void scrollToBottom();
   void setVideoCardInfo(const QString &str);
   void setVideoCardInfo(const QStringList &info);
+  void setDvidMetrics(const QString &str);
 
 public slots:
   void scrollToBottom(int index);
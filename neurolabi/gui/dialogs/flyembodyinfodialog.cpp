@@ -21,6 +21,7 @@
 #include "dvid/zdvidtarget.h"
 #include "dvid/zdvidreader.h"
 #include "dvid/zdvidsynapse.h"
+#include "zflyembodyannotation.h"
 
 #include "flyembodyinfodialog.h"
 #include "ui_flyembodyinfodialog.h"
@@ -410,6 +411,33 @@ void FlyEmBodyInfoDialog::importBookmarksDvid(ZDvidTarget target) {
           }
         }
 
+        // read the annotations of all bookmarked bodies in batches
+        //  rather than one request per bookmark
+        std::vector<uint64_t> annotatedBodyArray;
+        QSet<uint64_t> requestedSet;
+        for (size_t i = 0; i < bookmarks.size(); ++i) {
+            ZJsonObject bkmk(bookmarks.at(i), false);
+            uint64_t bodyId = bkmk.value("body ID").toInteger();
+            if (bodySet.contains(bodyId) && !requestedSet.contains(bodyId)) {
+                requestedSet.insert(bodyId);
+                annotatedBodyArray.push_back(bodyId);
+            }
+        }
+
+        // if application is quitting, return = exit thread
+        if (m_quitting) {
+            return;
+        }
+
+        std::vector<ZFlyEmBodyAnnotation> annotationArray =
+            reader.readBodyAnnotations(annotatedBodyArray);
+        QMap<uint64_t, ZFlyEmBodyAnnotation> annotationMap;
+        for (std::vector<ZFlyEmBodyAnnotation>::const_iterator
+             iter = annotationArray.begin(); iter != annotationArray.end();
+             ++iter) {
+            annotationMap[iter->getBodyId()] = *iter;
+        }
+
         m_bodyNames.clear();
         for (size_t i = 0; i < bookmarks.size(); ++i) {
             // if application is quitting, return = exit thread
@@ -426,32 +454,23 @@ void FlyEmBodyInfoDialog::importBookmarksDvid(ZDvidTarget target) {
             ZJsonObject bkmk(bookmarks.at(i), false);
 
             uint64_t bodyId = bkmk.value("body ID").toInteger();
-            if (bodySet.contains(bodyId)) {
-                const QByteArray &temp = reader.readKeyValue(bodyAnnotationName,
-                      QString::number(bkmk.value("body ID").toInteger()));
-                ZJsonObject tempJson;
-                tempJson.decodeString(temp.data());
-
-                // this is way too wordy to leave on all the time, even in debug
-                // #ifdef _DEBUG_
-                //     std::cout << "parsing info for body ID = " << bkmk.value("body ID").toInteger() << std::endl;
-                //     std::cout << "name = " << ZJsonParser::stringValue(tempJson["name"]) << std::endl;
-                //     std::cout << "status = " << ZJsonParser::stringValue(tempJson["status"]) << std::endl;
-                // #endif
+            if (annotationMap.contains(bodyId)) {
+                const ZFlyEmBodyAnnotation &annotation = annotationMap[bodyId];
 
                 // now push the value back in; don't put empty strings in (messes with sorting)
                 // updateModel expects "body status", not "status" (matches original file version)
-                if (tempJson.hasKey("status") && strlen(ZJsonParser::stringValue(tempJson["status"])) > 0) {
-                    bkmk.setEntry("body status", tempJson["status"]);
+                if (!annotation.getStatus().empty()) {
+                    bkmk.setEntry("body status", annotation.getStatus());
                 }
-                if (tempJson.hasKey("name") && strlen(ZJsonParser::stringValue(tempJson["name"])) > 0) {
-                    bkmk.setEntry("name", tempJson["name"]);
+                if (!annotation.getName().empty()) {
+                    bkmk.setEntry("name", annotation.getName());
 
                     // store name for later use
-                    m_bodyNames[bodyId] = QString(ZJsonParser::stringValue(tempJson["name"]));
-                    }
+                    m_bodyNames[bodyId] =
+                        QString::fromStdString(annotation.getName());
                 }
             }
+        }
 
         // no "loadCompleted()" here; it's emitted in updateModel(), when it's done
         emit dataChanged(jsonDataObject.value("data"));
@@ -514,44 +533,24 @@ void FlyEmBodyInfoDialog::importBodiesDvid(ZDvidTarget target) {
         //  match what we'd get out of the bookmarks annotation file;
         //  probably this should be refactored 
 
-        // get all the bodies that have annotations in this UUID        
-        // note that this list contains body IDs in strings, *plus*
-        //  some other nonnumeric strings (!!)
+        // get all the bodies that have annotations in this UUID;
+        //  the reader skips the nonnumeric keys mixed in there
 
-        QString bodyAnnotationName = ZDvidData::GetName(
-              ZDvidData::ROLE_BODY_ANNOTATION,
-              ZDvidData::ROLE_BODY_LABEL,
-              target.getBodyLabelName()).c_str();
-        QStringList keyList = reader.readKeys(bodyAnnotationName);
+        std::vector<ZFlyEmBodyAnnotation> annotationArray =
+            reader.readAllBodyAnnotations();
 
         ZJsonArray bodies;
-        bool ok;
-        qlonglong bodyID;
-        foreach (const QString &bodyIDstr, keyList) {
-            // skip the few non-numeric keys mixed in there
-            bodyID = bodyIDstr.toLongLong(&ok);
-            if (ok) {
-                // get body annotations and transform to what we need
-                const QByteArray &temp = reader.readKeyValue(bodyAnnotationName, bodyIDstr);
-                ZJsonObject bodyData;
-                bodyData.decodeString(temp.data());
-
-                // remove name if empty
-                if (bodyData.hasKey("name") && strlen(ZJsonParser::stringValue(bodyData["name"])) == 0) {
-                    bodyData.removeKey("name");
-                }
-
-                // remove status if empty; change status > body status
-                if (bodyData.hasKey("status")) {
-                    if (strlen(ZJsonParser::stringValue(bodyData["status"])) > 0) {
-                        bodyData.setEntry("body status", bodyData["status"]);
-                    } 
-                    // don't really need to remove this, but why not
-                    bodyData.removeKey("status");
-                }
+        for (std::vector<ZFlyEmBodyAnnotation>::const_iterator
+             iter = annotationArray.begin(); iter != annotationArray.end();
+             ++iter) {
+            // empty fields are left out; change status > body status
+            ZJsonObject bodyData = iter->toJsonObject();
+            if (bodyData.hasKey("status")) {
+                bodyData.setEntry("body status", bodyData["status"]);
+                bodyData.removeKey("status");
+            }
 
-                bodies.append(bodyData);
-            } 
+            bodies.append(bodyData);
         }
 
         // no "loadCompleted()" here; it's emitted in updateModel(), when it's done
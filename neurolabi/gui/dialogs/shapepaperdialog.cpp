@@ -15,6 +15,7 @@
 #include "tz_math.h"
 #include "zstring.h"
 #include "flyem/zflyemdataframe.h"
+#include "flyem/zflyemneuronpager.h"
 #include "zframefactory.h"
 #include "mainwindow.h"
 #include "zsvggenerator.h"
@@ -378,11 +379,12 @@ void ShapePaperDialog::computeFeatureMatrix()
     ZMatrix featmat(neuronArray.size(), ZSwcGlobalFeatureAnalyzer::getFeatureNumber(setName));
     int row = 0;
     std::vector<std::string> neuronName;
-    for (ZFlyEmNeuronArray::iterator iter = neuronArray.begin(); iter != neuronArray.end(); ++iter, ++row) {
-      ZFlyEmNeuron &neuron = *iter;
+    ZFlyEmNeuronPager pager(bundle);
+    while (pager.hasNext()) {
+      ZFlyEmNeuron &neuron = *(pager.next());
       std::vector<double> featureSet = ZSwcGlobalFeatureAnalyzer::computeFeatureSet(*(neuron.getModel()), setName);
       neuronName.push_back(neuron.getName());
-      featmat.setRowValue(row, featureSet);
+      featmat.setRowValue(row++, featureSet);
     }
     featmat.exportCsv(getFeaturePath().toStdString() + ".txt");
     featmat.exportCsv(getFeaturePath().toStdString(), neuronName, ZSwcGlobalFeatureAnalyzer::getFeatureNameArray(setName));
@@ -0,0 +1,464 @@
+#include "zdvidblockcache.h"
+
+#include <sstream>
+#include <vector>
+#include <algorithm>
+
+#include <QMutexLocker>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDirIterator>
+#include <QCryptographicHash>
+
+#include "zintcuboid.h"
+#include "neutubeconfig.h"
+
+namespace {
+
+std::string SanitizeName(const std::string &name)
+{
+  std::string result = name;
+  std::replace(result.begin(), result.end(), '/', '_');
+
+  return result;
+}
+
+bool IsNewer(const QFileInfo &info1, const QFileInfo &info2)
+{
+  return info1.lastModified() > info2.lastModified();
+}
+
+}
+
+ZDvidBlockCache::ZDvidBlockCache() :
+  m_enabled(true), m_memoryLimit(256 * 1024 * 1024),
+  m_diskLimit((size_t) 2 * 1024 * 1024 * 1024), m_memoryUsage(0),
+  m_diskUsage(0), m_memoryHitCount(0), m_diskHitCount(0), m_missCount(0),
+  m_evictionCount(0)
+{
+  std::string tmpDir =
+      NeutubeConfig::getInstance().getPath(NeutubeConfig::TMP_DATA);
+  if (!tmpDir.empty()) {
+    setDiskDir(QDir(tmpDir.c_str()).filePath("dvid_block_cache"));
+  }
+}
+
+ZDvidBlockCache& ZDvidBlockCache::getInstance()
+{
+  static ZDvidBlockCache cache;
+
+  return cache;
+}
+
+std::string ZDvidBlockCache::GetKeyPrefix(
+    const std::string &uuid, const std::string &dataName)
+{
+  return uuid + "/" + SanitizeName(dataName) + "/";
+}
+
+std::string ZDvidBlockCache::GetKey(
+    const std::string &uuid, const std::string &dataName,
+    const ZIntCuboid &box, int scale)
+{
+  std::ostringstream stream;
+  stream << GetKeyPrefix(uuid, dataName) << scale << "/"
+         << box.getFirstCorner().getX() << "_"
+         << box.getFirstCorner().getY() << "_"
+         << box.getFirstCorner().getZ() << "_"
+         << box.getWidth() << "_" << box.getHeight() << "_" << box.getDepth();
+
+  return stream.str();
+}
+
+QString ZDvidBlockCache::getDiskPath(const std::string &key) const
+{
+  //The first two components (uuid and data name) are kept as directories
+  //so that the blocks of a data instance stay together.
+  std::string::size_type pos = key.find('/');
+  pos = key.find('/', pos + 1);
+
+  QByteArray hash = QCryptographicHash::hash(
+        QByteArray(key.c_str(), key.size()), QCryptographicHash::Sha1).toHex();
+
+  return QString::fromStdString(key.substr(0, pos + 1)) + hash;
+}
+
+void ZDvidBlockCache::setEnabled(bool enabled)
+{
+  QMutexLocker locker(&m_mutex);
+  m_enabled = enabled;
+}
+
+bool ZDvidBlockCache::isEnabled() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_enabled;
+}
+
+void ZDvidBlockCache::setMemoryLimit(size_t limit)
+{
+  QMutexLocker locker(&m_mutex);
+  m_memoryLimit = limit;
+  evictMemory();
+}
+
+void ZDvidBlockCache::setDiskLimit(size_t limit)
+{
+  std::vector<QString> removedPath;
+  {
+    QMutexLocker locker(&m_mutex);
+    m_diskLimit = limit;
+    evictDisk(&removedPath);
+  }
+  RemoveFile(removedPath);
+}
+
+void ZDvidBlockCache::setDiskDir(const QString &dirPath)
+{
+  std::vector<QString> removedPath;
+  {
+    QMutexLocker locker(&m_mutex);
+    m_diskDir = dirPath;
+    loadDiskIndex(&removedPath);
+  }
+  RemoveFile(removedPath);
+}
+
+QString ZDvidBlockCache::getDiskDir() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_diskDir;
+}
+
+void ZDvidBlockCache::loadDiskIndex(std::vector<QString> *removedPath)
+{
+  m_diskMap.clear();
+  m_diskLru.clear();
+  m_diskUsage = 0;
+
+  if (m_diskDir.isEmpty()) {
+    return;
+  }
+
+  QDir dir(m_diskDir);
+  if (!dir.exists()) {
+    if (!dir.mkpath(".")) {
+      m_diskDir.clear();
+    }
+    return;
+  }
+
+  std::vector<QFileInfo> fileList;
+  QDirIterator iter(m_diskDir, QDir::Files, QDirIterator::Subdirectories);
+  while (iter.hasNext()) {
+    iter.next();
+    fileList.push_back(iter.fileInfo());
+  }
+  std::sort(fileList.begin(), fileList.end(), IsNewer);
+
+  for (std::vector<QFileInfo>::const_iterator iter = fileList.begin();
+       iter != fileList.end(); ++iter) {
+    std::string path = dir.relativeFilePath(iter->filePath()).toStdString();
+    m_diskLru.push_back(path);
+    DiskEntry &entry = m_diskMap[path];
+    entry.size = iter->size();
+    entry.lruIter = --m_diskLru.end();
+    m_diskUsage += entry.size;
+  }
+
+  evictDisk(removedPath);
+}
+
+bool ZDvidBlockCache::ReadFile(const QString &path, QByteArray *data)
+{
+  QFile file(path);
+  if (!file.open(QIODevice::ReadOnly)) {
+    return false;
+  }
+
+  *data = file.readAll();
+
+  return true;
+}
+
+bool ZDvidBlockCache::WriteFile(const QString &path, const QByteArray &data)
+{
+  if (!QDir().mkpath(QFileInfo(path).path())) {
+    return false;
+  }
+
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly)) {
+    return false;
+  }
+
+  return (file.write(data) == data.size()) && file.commit();
+}
+
+void ZDvidBlockCache::RemoveFile(const std::vector<QString> &pathArray)
+{
+  for (std::vector<QString>::const_iterator iter = pathArray.begin();
+       iter != pathArray.end(); ++iter) {
+    QFile::remove(*iter);
+  }
+}
+
+bool ZDvidBlockCache::get(const std::string &key, QByteArray *data)
+{
+  QString diskDir;
+  std::string diskKey;
+  {
+    QMutexLocker locker(&m_mutex);
+
+    if (!m_enabled) {
+      return false;
+    }
+
+    std::map<std::string, MemoryEntry>::iterator iter = m_memoryMap.find(key);
+    if (iter != m_memoryMap.end()) {
+      m_memoryLru.splice(
+            m_memoryLru.begin(), m_memoryLru, iter->second.lruIter);
+      if (data != NULL) {
+        *data = iter->second.data;
+      }
+      ++m_memoryHitCount;
+      return true;
+    }
+
+    if (!m_diskDir.isEmpty()) {
+      diskKey = getDiskPath(key).toStdString();
+      if (m_diskMap.count(diskKey) > 0) {
+        diskDir = m_diskDir;
+      }
+    }
+
+    if (diskDir.isEmpty()) {
+      ++m_missCount;
+      return false;
+    }
+  }
+
+  QByteArray diskData;
+  bool isRead = ReadFile(QDir(diskDir).filePath(diskKey.c_str()), &diskData);
+
+  QMutexLocker locker(&m_mutex);
+
+  //The index might be changed while the file is read
+  std::map<std::string, DiskEntry>::iterator iter = m_diskMap.end();
+  if (diskDir == m_diskDir) {
+    iter = m_diskMap.find(diskKey);
+  }
+
+  if (!isRead) {
+    if (iter != m_diskMap.end()) {
+      m_diskUsage -= iter->second.size;
+      m_diskLru.erase(iter->second.lruIter);
+      m_diskMap.erase(iter);
+    }
+    ++m_missCount;
+    return false;
+  }
+
+  if (iter != m_diskMap.end()) {
+    m_diskLru.splice(m_diskLru.begin(), m_diskLru, iter->second.lruIter);
+  }
+  if (m_enabled) {
+    putMemory(key, diskData);
+  }
+  if (data != NULL) {
+    *data = diskData;
+  }
+  ++m_diskHitCount;
+
+  return true;
+}
+
+void ZDvidBlockCache::put(const std::string &key, const QByteArray &data)
+{
+  QString diskDir;
+  std::string diskKey;
+  {
+    QMutexLocker locker(&m_mutex);
+
+    if (!m_enabled || data.isEmpty()) {
+      return;
+    }
+
+    putMemory(key, data);
+
+    if (m_diskDir.isEmpty() || (size_t) data.size() > m_diskLimit) {
+      return;
+    }
+
+    diskDir = m_diskDir;
+    diskKey = getDiskPath(key).toStdString();
+  }
+
+  if (!WriteFile(QDir(diskDir).filePath(diskKey.c_str()), data)) {
+    return;
+  }
+
+  std::vector<QString> removedPath;
+  {
+    QMutexLocker locker(&m_mutex);
+    if (diskDir == m_diskDir) {
+      addDiskEntry(diskKey, data.size());
+      evictDisk(&removedPath);
+    }
+  }
+  RemoveFile(removedPath);
+}
+
+void ZDvidBlockCache::putMemory(const std::string &key, const QByteArray &data)
+{
+  std::map<std::string, MemoryEntry>::iterator iter = m_memoryMap.find(key);
+  if (iter != m_memoryMap.end()) {
+    m_memoryUsage -= iter->second.data.size();
+    iter->second.data = data;
+    m_memoryLru.splice(m_memoryLru.begin(), m_memoryLru, iter->second.lruIter);
+  } else {
+    m_memoryLru.push_front(key);
+    MemoryEntry &entry = m_memoryMap[key];
+    entry.data = data;
+    entry.lruIter = m_memoryLru.begin();
+  }
+  m_memoryUsage += data.size();
+
+  evictMemory();
+}
+
+void ZDvidBlockCache::evictMemory()
+{
+  while (m_memoryUsage > m_memoryLimit && !m_memoryLru.empty()) {
+    std::map<std::string, MemoryEntry>::iterator iter =
+        m_memoryMap.find(m_memoryLru.back());
+    m_memoryUsage -= iter->second.data.size();
+    m_memoryMap.erase(iter);
+    m_memoryLru.pop_back();
+    ++m_evictionCount;
+  }
+}
+
+void ZDvidBlockCache::addDiskEntry(const std::string &diskKey, size_t size)
+{
+  std::map<std::string, DiskEntry>::iterator iter = m_diskMap.find(diskKey);
+  if (iter != m_diskMap.end()) {
+    m_diskUsage -= iter->second.size;
+    iter->second.size = size;
+    m_diskLru.splice(m_diskLru.begin(), m_diskLru, iter->second.lruIter);
+  } else {
+    m_diskLru.push_front(diskKey);
+    DiskEntry &entry = m_diskMap[diskKey];
+    entry.size = size;
+    entry.lruIter = m_diskLru.begin();
+  }
+  m_diskUsage += size;
+}
+
+/*
+ * Evicted blocks are removed from the index only. The caller removes the
+ * files in \a removedPath after releasing the mutex.
+ */
+void ZDvidBlockCache::evictDisk(std::vector<QString> *removedPath)
+{
+  QDir dir(m_diskDir);
+  while (m_diskUsage > m_diskLimit && !m_diskLru.empty()) {
+    std::map<std::string, DiskEntry>::iterator iter =
+        m_diskMap.find(m_diskLru.back());
+    removedPath->push_back(dir.filePath(iter->first.c_str()));
+    m_diskUsage -= iter->second.size;
+    m_diskMap.erase(iter);
+    m_diskLru.pop_back();
+    ++m_evictionCount;
+  }
+}
+
+void ZDvidBlockCache::clear()
+{
+  QMutexLocker locker(&m_mutex);
+
+  m_memoryMap.clear();
+  m_memoryLru.clear();
+  m_memoryUsage = 0;
+
+  if (!m_diskDir.isEmpty()) {
+    QDir(m_diskDir).removeRecursively();
+    QDir(m_diskDir).mkpath(".");
+  }
+  m_diskMap.clear();
+  m_diskLru.clear();
+  m_diskUsage = 0;
+}
+
+size_t ZDvidBlockCache::getMemoryUsage() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_memoryUsage;
+}
+
+size_t ZDvidBlockCache::getDiskUsage() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_diskUsage;
+}
+
+int ZDvidBlockCache::getMemoryHitCount() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_memoryHitCount;
+}
+
+int ZDvidBlockCache::getDiskHitCount() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_diskHitCount;
+}
+
+int ZDvidBlockCache::getMissCount() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_missCount;
+}
+
+int ZDvidBlockCache::getEvictionCount() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_evictionCount;
+}
+
+void ZDvidBlockCache::resetStat()
+{
+  QMutexLocker locker(&m_mutex);
+  m_memoryHitCount = 0;
+  m_diskHitCount = 0;
+  m_missCount = 0;
+  m_evictionCount = 0;
+}
+
+std::string ZDvidBlockCache::getStatReport() const
+{
+  QMutexLocker locker(&m_mutex);
+
+  int total = m_memoryHitCount + m_diskHitCount + m_missCount;
+  double hitRate = 0.0;
+  if (total > 0) {
+    hitRate = (double) (m_memoryHitCount + m_diskHitCount) / total;
+  }
+
+  std::ostringstream stream;
+  stream << "Block cache: " << (m_enabled ? "on" : "off") << std::endl;
+  stream << "  Memory hits: " << m_memoryHitCount << std::endl;
+  stream << "  Disk hits: " << m_diskHitCount << std::endl;
+  stream << "  Misses: " << m_missCount << std::endl;
+  stream << "  Hit rate: " << hitRate * 100.0 << "%" << std::endl;
+  stream << "  Evictions: " << m_evictionCount << std::endl;
+  stream << "  Memory: " << m_memoryUsage << " / " << m_memoryLimit
+         << " bytes in " << m_memoryMap.size() << " blocks" << std::endl;
+  stream << "  Disk: " << m_diskUsage << " / " << m_diskLimit
+         << " bytes in " << m_diskMap.size() << " blocks ("
+         << m_diskDir.toStdString() << ")" << std::endl;
+
+  return stream.str();
+}
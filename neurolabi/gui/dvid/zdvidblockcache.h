@@ -0,0 +1,153 @@
+#ifndef ZDVIDBLOCKCACHE_H
+#define ZDVIDBLOCKCACHE_H
+
+#include <string>
+#include <map>
+#include <list>
+#include <vector>
+
+#include <QByteArray>
+#include <QString>
+#include <QMutex>
+
+class ZIntCuboid;
+
+/*!
+ * \brief The class of caching DVID blocks locally
+ *
+ * The cache has two tiers: a memory tier and an optional disk tier. A block is
+ * addressed by the uuid of the node, the data name, the box of the block and
+ * the scale, so the same block read by different readers is stored only once.
+ * Each tier has a size limit and drops the least recently used blocks when
+ * the limit is exceeded. Blocks evicted from the memory tier can still be
+ * found on the disk tier.
+ *
+ * The cached value is the raw voxel array returned by DVID. Only grayscale
+ * data should be cached: labels of an unlocked node change with every split
+ * or merge, from this process or any other client, and the key does not
+ * tell versions of the same node apart.
+ *
+ * The mutex only guards the indices of the tiers. Files are read, written and
+ * removed without holding it, so a disk access does not block other readers.
+ * A file missing on read, e.g. removed by a concurrent eviction, is treated as
+ * a miss and dropped from the index.
+ */
+class ZDvidBlockCache
+{
+public:
+  static ZDvidBlockCache& getInstance();
+
+  /*!
+   * \brief Get the key of a block.
+   */
+  static std::string GetKey(const std::string &uuid,
+                            const std::string &dataName,
+                            const ZIntCuboid &box, int scale = 0);
+
+  /*!
+   * \brief Get a block from the cache.
+   *
+   * \param key Key of the block.
+   * \param data Output data.
+   * \return true iff the block is found.
+   */
+  bool get(const std::string &key, QByteArray *data);
+
+  /*!
+   * \brief Add a block to the cache.
+   *
+   * Nothing is done if the cache is disabled or \a data is empty.
+   */
+  void put(const std::string &key, const QByteArray &data);
+
+  /*!
+   * \brief Remove all blocks in both tiers.
+   */
+  void clear();
+
+  void setEnabled(bool enabled);
+  bool isEnabled() const;
+
+  /*!
+   * \brief Set the size limit (bytes) of the memory tier.
+   */
+  void setMemoryLimit(size_t limit);
+
+  /*!
+   * \brief Set the size limit (bytes) of the disk tier.
+   */
+  void setDiskLimit(size_t limit);
+
+  /*!
+   * \brief Set the directory of the disk tier.
+   *
+   * Blocks already in the directory are reused. The disk tier is disabled if
+   * \a dirPath is empty.
+   */
+  void setDiskDir(const QString &dirPath);
+  QString getDiskDir() const;
+
+  size_t getMemoryUsage() const;
+  size_t getDiskUsage() const;
+
+  int getMemoryHitCount() const;
+  int getDiskHitCount() const;
+  int getMissCount() const;
+  int getEvictionCount() const;
+  void resetStat();
+
+  /*!
+   * \brief Report of the hit/miss statistics.
+   */
+  std::string getStatReport() const;
+
+private:
+  ZDvidBlockCache();
+
+  struct MemoryEntry {
+    QByteArray data;
+    std::list<std::string>::iterator lruIter;
+  };
+
+  struct DiskEntry {
+    size_t size;
+    std::list<std::string>::iterator lruIter;
+  };
+
+  static std::string GetKeyPrefix(const std::string &uuid,
+                                  const std::string &dataName);
+  QString getDiskPath(const std::string &key) const;
+
+  static bool ReadFile(const QString &path, QByteArray *data);
+  static bool WriteFile(const QString &path, const QByteArray &data);
+  static void RemoveFile(const std::vector<QString> &pathArray);
+
+  void putMemory(const std::string &key, const QByteArray &data);
+  void addDiskEntry(const std::string &diskKey, size_t size);
+  void evictMemory();
+  void evictDisk(std::vector<QString> *removedPath);
+  void loadDiskIndex(std::vector<QString> *removedPath);
+
+private:
+  mutable QMutex m_mutex;
+
+  bool m_enabled;
+  size_t m_memoryLimit;
+  size_t m_diskLimit;
+  QString m_diskDir;
+
+  std::map<std::string, MemoryEntry> m_memoryMap;
+  std::list<std::string> m_memoryLru; //most recent first
+  size_t m_memoryUsage;
+
+  std::map<std::string, DiskEntry> m_diskMap;
+  std::list<std::string> m_diskLru; //most recent first
+  size_t m_diskUsage;
+
+  int m_memoryHitCount;
+  int m_diskHitCount;
+  int m_missCount;
+  int m_evictionCount;
+};
+
+#endif // ZDVIDBLOCKCACHE_H
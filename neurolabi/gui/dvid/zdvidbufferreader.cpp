@@ -1,12 +1,16 @@
 #include "zdvidbufferreader.h"
 
 #include <exception>
+#include <stdexcept>
 #include <iostream>
+#include <vector>
 
 #include <QTimer>
 #include <QNetworkRequest>
 #include <QDebug>
 #include <QNetworkReply>
+#include <QtConcurrentRun>
+#include <QFuture>
 
 #include "libdvidheader.h"
 
@@ -14,12 +18,33 @@
 #include "zsleeper.h"
 #include "dvid/zdvidurl.h"
 #include "dvid/libdvidheader.h"
+#include "dvid/zdvidtransport.h"
+
+namespace {
+
+#if defined(_ENABLE_LIBDVIDCPP_)
+QByteArray ReadUrl(const QString &url, bool compress)
+{
+  ZDvidBufferReader reader;
+  reader.tryCompress(compress);
+  reader.read(url, false);
+
+  if (reader.getStatus() == ZDvidBufferReader::READ_OK) {
+    return reader.getBuffer();
+  }
+
+  return QByteArray();
+}
+#endif
+
+}
 
 ZDvidBufferReader::ZDvidBufferReader(QObject *parent) :
   QObject(parent), m_networkReply(NULL), m_isReadingDone(false),
-  m_status(ZDvidBufferReader::READ_NULL), m_tryingCompress(false)
+  m_status(ZDvidBufferReader::READ_NULL), m_tryingCompress(false),
+  m_nextBatchIndex(0), m_pendingBatchCount(0)
 {
-  m_networkManager = new QNetworkAccessManager(this);
+  m_networkManager = ZDvidTransport::getInstance().getNetworkManager();
 
 //#if !defined(_ENABLE_LIBDVIDCPP_)
   m_eventLoop = new QEventLoop(this);
@@ -73,21 +98,33 @@ void ZDvidBufferReader::read(
       } else if (method == "PUT") {
         connMeth = libdvid::PUT;
       }
+      m_url = url;
+      m_timer.start();
       if (m_service.get() != NULL) {
         data = m_service->custom_request(
               endPoint, libdvidPayload, connMeth, m_tryingCompress);
       } else {
-        libdvid::DVIDNodeService service(
-              target.getAddressWithPort(), target.getUuid());
-        data = service.custom_request(
+        ZDvidTransport &transport = ZDvidTransport::getInstance();
+        ZSharedPointer<libdvid::DVIDNodeService> service =
+            transport.takeService(target.getAddressWithPort(),
+                                  target.getUuid());
+        if (service.get() == NULL) {
+          throw std::runtime_error(
+              "Failed to connect to " + target.getAddressWithPort());
+        }
+        data = service->custom_request(
             endPoint, libdvidPayload, connMeth, m_tryingCompress);
+        transport.returnService(
+              target.getAddressWithPort(), target.getUuid(), service);
       }
 
       m_buffer.append(data->get_data().c_str(), data->length());
       m_status = READ_OK;
+      recordRequest(true);
     } catch (std::exception &e) {
       std::cout << e.what() << std::endl;
       m_status = READ_FAILED;
+      recordRequest(false);
     }
   }
 #endif
@@ -111,24 +148,37 @@ void ZDvidBufferReader::read(const QString &url, bool outputingUrl)
     try {
       libdvid::BinaryDataPtr data;
       std::string endPoint = ZDvidUrl::GetEndPoint(url.toStdString());
+      m_url = url;
+      m_timer.start();
       if (m_service.get() != NULL) {
         data = m_service->custom_request(
               endPoint, libdvid::BinaryDataPtr(), libdvid::GET, m_tryingCompress);
       } else {
-        libdvid::DVIDNodeService service(
-              target.getAddressWithPort(), target.getUuid());
-        data = service.custom_request(
+        ZDvidTransport &transport = ZDvidTransport::getInstance();
+        ZSharedPointer<libdvid::DVIDNodeService> service =
+            transport.takeService(target.getAddressWithPort(),
+                                  target.getUuid());
+        if (service.get() == NULL) {
+          throw std::runtime_error(
+              "Failed to connect to " + target.getAddressWithPort());
+        }
+        data = service->custom_request(
               endPoint, libdvid::BinaryDataPtr(), libdvid::GET, m_tryingCompress);
+        transport.returnService(
+              target.getAddressWithPort(), target.getUuid(), service);
       }
 
       m_buffer.append(data->get_data().c_str(), data->length());
       m_status = READ_OK;
+      recordRequest(true);
     } catch (std::exception &e) {
       std::cout << e.what() << std::endl;
       m_status = READ_FAILED;
+      recordRequest(false);
     }
   } else {
     startReading();
+    m_url = url;
 
     m_networkReply = m_networkManager->get(QNetworkRequest(url));
     connect(m_networkReply, SIGNAL(finished()), this, SLOT(finishReading()));
@@ -141,6 +191,7 @@ void ZDvidBufferReader::read(const QString &url, bool outputingUrl)
 
 #else
   startReading();
+  m_url = url;
 
   m_networkReply = m_networkManager->get(QNetworkRequest(url));
   connect(m_networkReply, SIGNAL(finished()), this, SLOT(finishReading()));
@@ -161,6 +212,7 @@ void ZDvidBufferReader::readQt(const QString &url, bool outputUrl)
   m_buffer.clear();
 
   startReading();
+  m_url = url;
 
   m_networkReply = m_networkManager->get(QNetworkRequest(url));
   connect(m_networkReply, SIGNAL(finished()), this, SLOT(finishReading()));
@@ -171,11 +223,119 @@ void ZDvidBufferReader::readQt(const QString &url, bool outputUrl)
   waitForReading();
 }
 
+QList<QByteArray> ZDvidBufferReader::readBatch(
+    const QStringList &urlList, bool outputingUrl)
+{
+  if (outputingUrl) {
+    foreach (const QString &url, urlList) {
+      qDebug() << url;
+    }
+  }
+
+  m_status = READ_OK;
+
+#if defined(_ENABLE_LIBDVIDCPP_)
+  //Node services are not thread safe, so each request takes its own one
+  //from the pool of the transport.
+  std::vector<QFuture<QByteArray> > futureList;
+  foreach (const QString &url, urlList) {
+    futureList.push_back(QtConcurrent::run(&ReadUrl, url, m_tryingCompress));
+  }
+
+  QList<QByteArray> result;
+  for (std::vector<QFuture<QByteArray> >::iterator iter = futureList.begin();
+       iter != futureList.end(); ++iter) {
+    QByteArray data = iter->result();
+    if (data.isEmpty()) {
+      m_status = READ_FAILED;
+    }
+    result.append(data);
+  }
+
+  return result;
+#else
+  m_batchUrlList = urlList;
+  m_batchBuffer.clear();
+  m_batchReplyMap.clear();
+  m_batchStartTime.clear();
+  m_nextBatchIndex = 0;
+  m_pendingBatchCount = urlList.size();
+  m_timer.start();
+
+  for (int i = 0; i < urlList.size(); ++i) {
+    m_batchBuffer.append(QByteArray());
+  }
+
+  //Requests beyond the connection limit would wait in the queue of the
+  //network manager, which should not be counted as their latency.
+  while (m_nextBatchIndex < urlList.size() &&
+         m_nextBatchIndex < MAX_BATCH_REQUEST_NUMBER) {
+    startBatchRequest();
+  }
+
+  if (m_pendingBatchCount > 0) {
+    m_eventLoop->exec();
+  }
+
+  QList<QByteArray> result = m_batchBuffer;
+  m_batchBuffer.clear();
+  m_batchUrlList.clear();
+
+  return result;
+#endif
+}
+
+void ZDvidBufferReader::startBatchRequest()
+{
+  int index = m_nextBatchIndex++;
+  QNetworkReply *reply =
+      m_networkManager->get(QNetworkRequest(m_batchUrlList[index]));
+  m_batchReplyMap[reply] = index;
+  m_batchStartTime[reply] = m_timer.nsecsElapsed();
+  connect(reply, SIGNAL(finished()), this, SLOT(finishBatchReading()));
+}
+
+void ZDvidBufferReader::finishBatchReading()
+{
+  QNetworkReply *reply = qobject_cast<QNetworkReply*>(sender());
+  if (reply == NULL || !m_batchReplyMap.contains(reply)) {
+    return;
+  }
+
+  int index = m_batchReplyMap.take(reply);
+  QByteArray data = reply->readAll();
+  bool succeeded = (reply->error() == QNetworkReply::NoError) &&
+      (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 200);
+  if (succeeded) {
+    m_batchBuffer[index] = data;
+  } else {
+    qDebug() << reply->errorString();
+    m_status = READ_FAILED;
+  }
+
+  qint64 latency = m_timer.nsecsElapsed() - m_batchStartTime.take(reply);
+  ZDvidTransport::getInstance().recordRequest(
+        reply->url().toString().toStdString(), data.size(),
+        latency / 1e6, succeeded);
+
+  reply->deleteLater();
+
+  if (m_nextBatchIndex < m_batchUrlList.size()) {
+    startBatchRequest();
+  }
+
+  --m_pendingBatchCount;
+  if (m_pendingBatchCount == 0) {
+    m_eventLoop->quit();
+  }
+}
+
 bool ZDvidBufferReader::isReadable(const QString &url)
 {
   QTimer::singleShot(5000, this, SLOT(handleTimeout()));
 
   startReading();
+  m_url = url;
 
   qDebug() << url;
 
@@ -194,6 +354,7 @@ bool ZDvidBufferReader::isReadable(const QString &url)
 bool ZDvidBufferReader::hasHead(const QString &url)
 {
   startReading();
+  m_url = url;
 
   qDebug() << url;
 
@@ -211,6 +372,7 @@ bool ZDvidBufferReader::hasHead(const QString &url)
 void ZDvidBufferReader::readHead(const QString &url)
 {
   startReading();
+  m_url = url;
 
   qDebug() << url;
 
@@ -228,6 +390,14 @@ void ZDvidBufferReader::startReading()
   m_isReadingDone = false;
   m_buffer.clear();
   m_status = READ_OK;
+  m_timer.start();
+}
+
+void ZDvidBufferReader::recordRequest(bool succeeded)
+{
+  ZDvidTransport::getInstance().recordRequest(
+        m_url.toStdString(), m_buffer.size(), m_timer.nsecsElapsed() / 1e6,
+        succeeded);
 }
 
 bool ZDvidBufferReader::isReadingDone() const
@@ -284,6 +454,10 @@ void ZDvidBufferReader::cancelReading()
 
 void ZDvidBufferReader::endReading(EStatus status)
 {
+  if (m_isReadingDone) {
+    return;
+  }
+
   m_status = status;
   m_isReadingDone = true;
 
@@ -300,6 +474,8 @@ void ZDvidBufferReader::endReading(EStatus status)
     m_networkReply = NULL;
   }
 
+  recordRequest(m_status == READ_OK);
+
   emit readingDone();
 }
 
@@ -8,7 +8,10 @@
 #include <QEventLoop>
 #include <QString>
 #include <QNetworkReply>
-
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QList>
+#include <QHash>
 
 #include "zsharedpointer.h"
 namespace libdvid{
@@ -31,6 +34,9 @@ public:
     READ_BAD_RESPONSE
   };
 
+  //Same as the number of connections Qt opens to a host
+  enum { MAX_BATCH_REQUEST_NUMBER = 6 };
+
   void read(const QString &url, bool outputingUrl = true);
   void read(const QString &url, const QByteArray &payload,
             const std::string &method,
@@ -47,6 +53,18 @@ public:
 
   void readQt(const QString &url, bool outputUrl = true);
 
+  /*!
+   * \brief Read a list of urls in parallel.
+   *
+   * Up to MAX_BATCH_REQUEST_NUMBER requests are in flight at the same time,
+   * and a new one is issued whenever one is done, so the latency of each
+   * request is timed from its own start. The function returns after all of
+   * them are done. The ith element of the result is the data read from the
+   * ith url, which is empty if the reading fails.
+   */
+  QList<QByteArray> readBatch(const QStringList &urlList,
+                              bool outputingUrl = false);
+
   void tryCompress(bool compress) {
     m_tryingCompress = compress;
   }
@@ -69,10 +87,13 @@ private slots:
   void cancelReading();
   void readBuffer();
   void waitForReading();
+  void finishBatchReading();
 
 private:
   void startReading();
   void endReading(EStatus status);
+  void recordRequest(bool succeeded);
+  void startBatchRequest();
 
 
   bool isReadingDone() const;
@@ -85,6 +106,15 @@ private:
   bool m_isReadingDone;
   EStatus m_status;
   bool m_tryingCompress;
+  QString m_url;
+  QElapsedTimer m_timer;
+
+  QStringList m_batchUrlList;
+  QHash<QNetworkReply*, int> m_batchReplyMap;
+  QHash<QNetworkReply*, qint64> m_batchStartTime;
+  QList<QByteArray> m_batchBuffer;
+  int m_nextBatchIndex;
+  int m_pendingBatchCount;
 #if defined(_ENABLE_LIBDVIDCPP_)
   ZSharedPointer<libdvid::DVIDNodeService> m_service;
 #endif
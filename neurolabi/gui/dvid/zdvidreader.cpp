@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <ctime>
+#include <algorithm>
 
 #include <QThread>
 #include <QElapsedTimer>
@@ -13,6 +14,7 @@
 #include "dvid/zdvidtarget.h"
 #include "dvid/zdvidfilter.h"
 #include "dvid/zdvidbufferreader.h"
+#include "dvid/zdvidblockcache.h"
 #include "dvid/zdvidurl.h"
 #include "zarray.h"
 #include "zstring.h"
@@ -359,6 +361,36 @@ std::vector<ZStack*> ZDvidReader::readGrayScaleBlock(
     const ZIntPoint &blockIndex, const ZDvidInfo &dvidInfo,
     int blockNumber)
 {
+  std::vector<ZStack*> stackArray(blockNumber, NULL);
+
+  //Use the cache only when all blocks are available
+  ZDvidBlockCache &cache = ZDvidBlockCache::getInstance();
+  std::vector<std::string> cacheKeyArray(blockNumber);
+  std::vector<QByteArray> cachedDataArray(blockNumber);
+  bool allCached = true;
+  ZIntCuboid currentBox = dvidInfo.getBlockBox(blockIndex);
+  for (int i = 0; i < blockNumber; ++i) {
+    cacheKeyArray[i] = ZDvidBlockCache::GetKey(
+          getDvidTarget().getUuid(), getDvidTarget().getGrayScaleName(),
+          currentBox);
+    if (allCached) {
+      allCached = cache.get(cacheKeyArray[i], &cachedDataArray[i]);
+    }
+    currentBox.translateX(currentBox.getWidth());
+  }
+
+  if (allCached) {
+    currentBox = dvidInfo.getBlockBox(blockIndex);
+    for (int i = 0; i < blockNumber; ++i) {
+      stackArray[i] = new ZStack(GREY, currentBox, 1);
+      stackArray[i]->loadValue(cachedDataArray[i].constData(),
+                               cachedDataArray[i].size(),
+                               stackArray[i]->array8());
+      currentBox.translateX(currentBox.getWidth());
+    }
+    return stackArray;
+  }
+
   ZDvidBufferReader bufferReader;
   ZDvidUrl dvidUrl(getDvidTarget());
 #ifdef _DEBUG_2
@@ -379,14 +411,14 @@ std::vector<ZStack*> ZDvidReader::readGrayScaleBlock(
   tic();
 #endif
 
-  std::vector<ZStack*> stackArray(blockNumber, NULL);
-
   if (bufferReader.getStatus() == ZDvidBufferReader::READ_OK) {
     const QByteArray &data = bufferReader.getBuffer();
     if (data.length() > 0) {
 //      int realBlockNumber = *((int*) data.constData());
 
-      ZIntCuboid currentBox = dvidInfo.getBlockBox(blockIndex);
+      currentBox = dvidInfo.getBlockBox(blockIndex);
+      bool complete =
+          ((size_t) data.length() >= blockNumber * currentBox.getVolume());
       for (int i = 0; i < blockNumber; ++i) {
         //stackArray[i] = ZStackFactory::makeZeroStack(GREY, currentBox);
         stackArray[i] = new ZStack(GREY, currentBox, 1);
@@ -395,6 +427,11 @@ std::vector<ZStack*> ZDvidReader::readGrayScaleBlock(
 #endif
         stackArray[i]->loadValue(data.constData() + i * currentBox.getVolume(),
                          currentBox.getVolume(), stackArray[i]->array8());
+        if (complete) {
+          cache.put(cacheKeyArray[i],
+                    data.mid(i * currentBox.getVolume(),
+                             currentBox.getVolume()));
+        }
         currentBox.translateX(currentBox.getWidth());
       }
     }
@@ -411,6 +448,17 @@ std::vector<ZStack*> ZDvidReader::readGrayScaleBlock(
 ZStack* ZDvidReader::readGrayScaleBlock(
     const ZIntPoint &blockIndex, const ZDvidInfo &dvidInfo)
 {
+  ZIntCuboid box = dvidInfo.getBlockBox(blockIndex);
+  std::string cacheKey = ZDvidBlockCache::GetKey(
+        getDvidTarget().getUuid(), getDvidTarget().getGrayScaleName(), box);
+  QByteArray cachedData;
+  if (ZDvidBlockCache::getInstance().get(cacheKey, &cachedData)) {
+    ZStack *stack = ZStackFactory::makeZeroStack(GREY, box);
+    stack->loadValue(cachedData.constData(), cachedData.length(),
+                     stack->array8());
+    return stack;
+  }
+
   ZDvidBufferReader bufferReader;
   ZDvidUrl dvidUrl(getDvidTarget());
   bufferReader.read(dvidUrl.getGrayScaleBlockUrl(blockIndex.getX(),
@@ -420,15 +468,16 @@ ZStack* ZDvidReader::readGrayScaleBlock(
   ZStack *stack = NULL;
   if (bufferReader.getStatus() == ZDvidBufferReader::READ_OK) {
     const QByteArray &data = bufferReader.getBuffer();
-    int realBlockNumber = *((int*) data.constData());
 
-    if (!data.isEmpty() && realBlockNumber == 1) {
-      ZIntCuboid box = dvidInfo.getBlockBox(blockIndex);
+    if (data.length() >= 4 && *((int*) data.constData()) == 1) {
       stack = ZStackFactory::makeZeroStack(GREY, box);
 #ifdef _DEBUG_
       std::cout << data.length() << " " << stack->getVoxelNumber() << std::endl;
 #endif
       stack->loadValue(data.constData() + 4, data.length() - 4, stack->array8());
+      if ((size_t) data.length() - 4 == box.getVolume()) {
+        ZDvidBlockCache::getInstance().put(cacheKey, data.mid(4));
+      }
     }
   }
 
@@ -454,6 +503,62 @@ ZDvidSparseStack* ZDvidReader::readDvidSparseStackAsync(uint64_t bodyId)
   return spStack;
 }
 
+void ZDvidReader::readGrayScaleBlockBatch(
+    const std::vector<ZIntPoint> &blockIndexArray, ZStackBlockGrid *grid)
+{
+  if (blockIndexArray.empty()) {
+    return;
+  }
+
+  ZDvidBlockCache &cache = ZDvidBlockCache::getInstance();
+  ZDvidUrl dvidUrl(getDvidTarget());
+  std::vector<ZIntCuboid> boxArray;
+  std::vector<std::string> cacheKeyArray;
+  QList<QByteArray> bufferList;
+  QStringList urlList;
+  std::vector<int> missingIndexArray;
+  for (std::vector<ZIntPoint>::const_iterator iter = blockIndexArray.begin();
+       iter != blockIndexArray.end(); ++iter) {
+    ZIntCuboid box = grid->getBlockBox(*iter);
+    boxArray.push_back(box);
+    cacheKeyArray.push_back(ZDvidBlockCache::GetKey(
+          getDvidTarget().getUuid(), getDvidTarget().getGrayScaleName(), box));
+    QByteArray buffer;
+    if (!cache.get(cacheKeyArray.back(), &buffer)) {
+      missingIndexArray.push_back(bufferList.size());
+      urlList.append(dvidUrl.getGrayscaleUrl(
+                       box.getWidth(), box.getHeight(), box.getDepth(),
+                       box.getFirstCorner().getX(), box.getFirstCorner().getY(),
+                       box.getFirstCorner().getZ()).c_str());
+    }
+    bufferList.append(buffer);
+  }
+
+  if (!urlList.isEmpty()) {
+    ZDvidBufferReader bufferReader;
+    QList<QByteArray> missingBufferList =
+        bufferReader.readBatch(urlList, isVerbose());
+    for (size_t i = 0; i < missingIndexArray.size(); ++i) {
+      int index = missingIndexArray[i];
+      bufferList[index] = missingBufferList[i];
+      if ((size_t) bufferList[index].size() == boxArray[index].getVolume()) {
+        cache.put(cacheKeyArray[index], bufferList[index]);
+      }
+    }
+  }
+
+  for (size_t i = 0; i < blockIndexArray.size(); ++i) {
+    const QByteArray &buffer = bufferList[i];
+    ZStack *stack = NULL;
+    if (!buffer.isEmpty()) {
+      stack = new ZStack(GREY, boxArray[i], 1);
+      memcpy(stack->array8(), buffer.constData(),
+             std::min((size_t) buffer.size(), stack->getVoxelNumber()));
+    }
+    grid->consumeStack(blockIndexArray[i], stack);
+  }
+}
+
 ZSparseStack* ZDvidReader::readSparseStack(uint64_t bodyId)
 {
   ZSparseStack *spStack = NULL;
@@ -485,6 +590,9 @@ ZSparseStack* ZDvidReader::readSparseStack(uint64_t bodyId)
     for (ZIntPointArray::const_iterator iter = blockArray.begin();
          iter != blockArray.end(); ++iter) {
          */
+    //Independent blocks are read in parallel batches
+    const size_t batchSize = 64;
+    std::vector<ZIntPoint> blockIndexArray;
     size_t stripeNumber = blockObj.getStripeNumber();
     for (size_t s = 0; s < stripeNumber; ++s) {
       const ZObject3dStripe &stripe = blockObj.getStripe(s);
@@ -508,14 +616,17 @@ ZSparseStack* ZDvidReader::readSparseStack(uint64_t bodyId)
               ZIntPoint(x, y, z) - dvidInfo.getStartBlockIndex();
           //ZStack *stack = readGrayScaleBlock(blockIndex, dvidInfo);
           //const ZIntPoint blockIndex = *iter - dvidInfo.getStartBlockIndex();
-          ZIntCuboid box = grid->getBlockBox(blockIndex);
-          ZStack *stack = readGrayScale(box);
-          grid->consumeStack(blockIndex, stack);
+          blockIndexArray.push_back(blockIndex);
+          if (blockIndexArray.size() >= batchSize) {
+            readGrayScaleBlockBatch(blockIndexArray, grid);
+            blockIndexArray.clear();
+          }
         }
 #endif
         //ptoc();
       }
     }
+    readGrayScaleBlockBatch(blockIndexArray, grid);
     //}
   } else {
     delete body;
@@ -534,24 +645,34 @@ ZStack* ZDvidReader::readGrayScale(
 #if 1
   ZStack *stack = NULL;
 
-  ZDvidBufferReader bufferReader;
-  ZDvidUrl url(getDvidTarget());
-  /*
+  ZIntCuboid box(x0, y0, z0, x0 + width - 1, y0 + height - 1, z0 + depth - 1);
+  std::string cacheKey = ZDvidBlockCache::GetKey(
+        getDvidTarget().getUuid(), getDvidTarget().getGrayScaleName(), box);
+  QByteArray buffer;
+  if (!ZDvidBlockCache::getInstance().get(cacheKey, &buffer)) {
+    ZDvidBufferReader bufferReader;
+    ZDvidUrl url(getDvidTarget());
+    /*
   if (depth == 1) {
     bufferReader.read(url.getGrayscaleUrl(width, height, x0, y0, z0).c_str());
   } else {
   */
     bufferReader.read(url.getGrayscaleUrl(
                         width, height, depth, x0, y0, z0).c_str(), isVerbose());
-  //}
+    //}
 
-  const QByteArray &buffer = bufferReader.getBuffer();
+    buffer = bufferReader.getBuffer();
+    if (bufferReader.getStatus() == ZDvidBufferReader::READ_OK &&
+        (size_t) buffer.size() == box.getVolume()) {
+      ZDvidBlockCache::getInstance().put(cacheKey, buffer);
+    }
+  }
 
   if (!buffer.isEmpty()) {
-    ZIntCuboid box(x0, y0, z0, x0 + width - 1, y0 + height - 1, z0 + depth - 1);
     stack = new ZStack(GREY, box, 1);
 
-    memcpy(stack->array8(), buffer.constData(), buffer.size());
+    memcpy(stack->array8(), buffer.constData(),
+           std::min((size_t) buffer.size(), stack->getVoxelNumber()));
   }
 
   return stack;
@@ -878,6 +999,37 @@ QByteArray ZDvidReader::readKeyValue(const QString &dataName, const QString &key
 #endif
 }
 
+QList<QByteArray> ZDvidReader::readKeyValues(
+    const QString &dataName, const QStringList &keyList) const
+{
+  ZDvidUrl url(getDvidTarget());
+
+  QList<QByteArray> valueList;
+  //Keep the number of requests in flight bounded for long key lists
+  const int batchSize = 256;
+  for (int i = 0; i < keyList.size(); i += batchSize) {
+    QStringList urlList;
+    foreach (const QString &key, keyList.mid(i, batchSize)) {
+      urlList.append(
+            url.getKeyUrl(dataName.toStdString(), key.toStdString()).c_str());
+    }
+    ZDvidBufferReader bufferReader;
+    valueList.append(bufferReader.readBatch(urlList, isVerbose()));
+  }
+
+  return valueList;
+}
+
+ZJsonObject ZDvidReader::readKeyRangeValues(
+    const QString &dataName, const QString &minKey, const QString &maxKey) const
+{
+  ZDvidUrl url(getDvidTarget());
+
+  return readJsonObject(url.getKeyRangeValueUrl(
+                          dataName.toStdString(), minKey.toStdString(),
+                          maxKey.toStdString()));
+}
+
 QStringList ZDvidReader::readKeys(const QString &dataName)
 {
   ZDvidBufferReader reader;
@@ -1722,6 +1874,79 @@ ZFlyEmBodyAnnotation ZDvidReader::readBodyAnnotation(uint64_t bodyId) const
   return annotation;
 }
 
+std::vector<ZFlyEmBodyAnnotation> ZDvidReader::readBodyAnnotations(
+    const std::vector<uint64_t> &bodyIdArray) const
+{
+  QStringList keyList;
+  for (std::vector<uint64_t>::const_iterator iter = bodyIdArray.begin();
+       iter != bodyIdArray.end(); ++iter) {
+    keyList.append(QString::number(*iter));
+  }
+
+  ZDvidUrl url(getDvidTarget());
+  QList<QByteArray> bufferList = readKeyValues(
+        url.getBodyAnnotationName().c_str(), keyList);
+
+  std::vector<ZFlyEmBodyAnnotation> annotationArray;
+  for (int i = 0; i < bufferList.size(); ++i) {
+    if (!bufferList[i].isEmpty()) {
+      ZFlyEmBodyAnnotation annotation;
+      annotation.loadJsonString(bufferList[i].constData());
+      annotation.setBodyId(bodyIdArray[i]);
+      annotationArray.push_back(annotation);
+    }
+  }
+
+  return annotationArray;
+}
+
+std::vector<ZFlyEmBodyAnnotation> ZDvidReader::readAllBodyAnnotations()
+{
+  QString dataName = ZDvidData::GetName(
+        ZDvidData::ROLE_BODY_ANNOTATION,
+        ZDvidData::ROLE_BODY_LABEL,
+        getDvidTarget().getBodyLabelName()).c_str();
+
+  std::vector<ZFlyEmBodyAnnotation> annotationArray;
+
+  //Body IDs are decimal strings of at most 20 digits, so this range covers
+  //all of them. Non-numeric keys in the range are skipped.
+  ZJsonObject allJson =
+      readKeyRangeValues(dataName, "0", "99999999999999999999");
+  if (!allJson.isEmpty()) {
+    const char *key;
+    json_t *value;
+    ZJsonObject_foreach(allJson, key, value) {
+      bool ok = false;
+      uint64_t bodyId = QString(key).toULongLong(&ok);
+      if (ok && bodyId > 0) {
+        ZFlyEmBodyAnnotation annotation;
+        if (ZJsonParser::isObject(value)) {
+          annotation.loadJsonObject(
+                ZJsonObject(value, ZJsonValue::SET_INCREASE_REF_COUNT));
+        } else {
+          annotation.loadJsonString(ZJsonParser::stringValue(value));
+        }
+        annotation.setBodyId(bodyId);
+        annotationArray.push_back(annotation);
+      }
+    }
+  } else {
+    QStringList keyList = readKeys(dataName);
+    std::vector<uint64_t> bodyIdArray;
+    foreach (const QString &key, keyList) {
+      bool ok = false;
+      uint64_t bodyId = key.toULongLong(&ok);
+      if (ok && bodyId > 0) {
+        bodyIdArray.push_back(bodyId);
+      }
+    }
+    annotationArray = readBodyAnnotations(bodyIdArray);
+  }
+
+  return annotationArray;
+}
+
 ZJsonObject ZDvidReader::readJsonObject(const std::string &url) const
 {
   ZJsonObject obj;
@@ -28,6 +28,7 @@ class ZDvidTileInfo;
 class ZSwcTree;
 class ZObject3dScan;
 class ZSparseStack;
+class ZStackBlockGrid;
 class ZDvidVersionDag;
 class ZDvidSparseStack;
 class ZFlyEmBodyAnnotation;
@@ -84,6 +85,15 @@ public:
       const ZIntPoint &blockIndex, const ZDvidInfo &dvidInfo,
       int blockNumber);
 
+  /*!
+   * \brief Read grayscale blocks into a grid in parallel.
+   *
+   * Each block in \a blockIndexArray is read as a separate request. All the
+   * requests are issued at the same time.
+   */
+  void readGrayScaleBlockBatch(const std::vector<ZIntPoint> &blockIndexArray,
+                               ZStackBlockGrid *grid);
+
   QString readInfo(const QString &dataName) const;
 
   std::set<uint64_t> readBodyId(
@@ -104,6 +114,25 @@ public:
   QStringList readKeys(const QString &dataName,
                        const QString &minKey, const QString &maxKey);
 
+  /*!
+   * \brief Read the values of multiple keys.
+   *
+   * The keys are requested in parallel batches. The returned list is aligned
+   * with \a keyList and has an empty entry for each key that cannot be read.
+   */
+  QList<QByteArray> readKeyValues(const QString &dataName,
+                                  const QStringList &keyList) const;
+
+  /*!
+   * \brief Read all key-value pairs in [\a minKey, \a maxKey] in one request.
+   *
+   * It returns an empty object if the range is empty or the server does not
+   * support range value reads.
+   */
+  ZJsonObject readKeyRangeValues(const QString &dataName,
+                                 const QString &minKey,
+                                 const QString &maxKey) const;
+
   ZClosedCurve* readRoiCurve(const std::string &key, ZClosedCurve *result);
   ZIntCuboid readBoundBox(int z);
 
@@ -159,6 +188,23 @@ public:
 
   ZFlyEmBodyAnnotation readBodyAnnotation(uint64_t bodyId) const;
 
+  /*!
+   * \brief Read the annotations of a list of bodies.
+   *
+   * Bodies without annotation are skipped, so the result is not necessarily
+   * aligned with \a bodyIdArray.
+   */
+  std::vector<ZFlyEmBodyAnnotation> readBodyAnnotations(
+      const std::vector<uint64_t> &bodyIdArray) const;
+
+  /*!
+   * \brief Read the annotations of all annotated bodies.
+   *
+   * It tries a single key range read first and falls back to batched reads of
+   * individual keys.
+   */
+  std::vector<ZFlyEmBodyAnnotation> readAllBodyAnnotations();
+
   ZJsonObject readJsonObject(const std::string &url) const;
   ZJsonArray readJsonArray(const std::string &url) const;
 
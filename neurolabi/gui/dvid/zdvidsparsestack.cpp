@@ -306,21 +306,32 @@ bool ZDvidSparseStack::fillValue()
 //  return changed;
 }
 
-ZStack* ZDvidSparseStack::getStack()
+ZStack* ZDvidSparseStack::getStack(bool *isUpdated)
 {
-  if (fillValue()) {
+  bool updated = fillValue();
+  if (updated) {
     m_sparseStack.deprecate(ZSparseStack::STACK);
   }
 
+  if (isUpdated != NULL) {
+    *isUpdated = updated;
+  }
+
   return m_sparseStack.getStack();
 }
 
-ZStack* ZDvidSparseStack::getStack(const ZIntCuboid &updateBox)
+ZStack* ZDvidSparseStack::getStack(
+    const ZIntCuboid &updateBox, bool *isUpdated)
 {
-  if (fillValue(updateBox)) {
+  bool updated = fillValue(updateBox);
+  if (updated) {
     m_sparseStack.deprecate(ZSparseStack::STACK);
   }
 
+  if (isUpdated != NULL) {
+    *isUpdated = updated;
+  }
+
   return m_sparseStack.getStack();
 }
 
@@ -25,8 +25,14 @@ public:
   const std::string& className() const;
 
   ZStack *getSlice(int z) const;
-  ZStack* getStack();
-  ZStack* getStack(const ZIntCuboid &updateBox);
+  /*!
+   * \brief Get the stack of the sparse stack.
+   *
+   * \a isUpdated is set to true if new values are filled, which means the
+   * returned stack is a new one, when it is not NULL.
+   */
+  ZStack* getStack(bool *isUpdated = NULL);
+  ZStack* getStack(const ZIntCuboid &updateBox, bool *isUpdated = NULL);
 
   const ZDvidTarget& getDvidTarget() const {
     return m_dvidTarget;
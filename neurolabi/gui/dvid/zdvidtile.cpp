@@ -18,6 +18,7 @@
 #include "zstackview.h"
 #include "zrect2d.h"
 #include "libdvidheader.h"
+#include "zdvidtilecache.h"
 
 ZDvidTile::ZDvidTile() : m_ix(0), m_iy(0), m_z(0),
   m_view(NULL)
@@ -44,45 +45,45 @@ void ZDvidTile::clear()
   m_dvidTarget.clear();
   delete m_image;
   m_image = NULL;
+  m_rawImage = QImage();
 
 //  delete m_pixmap;
 //  m_pixmap = NULL;
 }
 
-void ZDvidTile::loadDvidSlice(
-    const uchar *buf, int length, int z, bool highContrast)
+std::string ZDvidTile::getCacheKey(int z) const
 {
-  bool loading = true;
-  if (m_view != NULL) {
-    if (m_view->getZ(NeuTube::COORD_STACK) != z) {
-      loading = false;
-    }
-  }
-
-  bool modified = false;
-  if (loading) {
-    if (m_image == NULL) {
-      m_image = new ZImage;
-    }
+  return ZDvidTileCache::GetKey(
+        m_dvidTarget.getUuid(), m_dvidTarget.getMultiscale2dName(),
+        m_res.getLevel(), m_ix, m_iy, z);
+}
 
-#ifdef _DEBUG_2
-    std::cout << "Decoding tile ..." << std::endl;
-#endif
-    m_image->loadFromData(buf, length);
-    m_image->setScale(1.0 / m_res.getScale(), 1.0 / m_res.getScale());
-    m_image->setOffset(-getX(), -getY());
+ZImage* ZDvidTile::makeDisplayImage(
+    const QImage &rawImage, bool highContrast) const
+{
+  ZImage *image = new ZImage;
+  image->QImage::operator=(rawImage);
+  image->setScale(1.0 / m_res.getScale(), 1.0 / m_res.getScale());
+  image->setOffset(-getX(), -getY());
+
+  //Enhancing a non-indexed image changes its pixels, which detaches it from
+  //the cached copy.
+  if (highContrast || image->format() == QImage::Format_Indexed8) {
+    image->enhanceContrast(highContrast);
+  }
 
-    modified = true;
+  return image;
+}
 
-//    m_image->enhanceContrast(
-//          hasVisualEffect(NeuTube::Display::Image::VE_HIGH_CONTRAST));
+void ZDvidTile::setImage(
+    ZImage *image, const QImage &rawImage, int z, bool highContrast)
+{
+  QMutexLocker locker(&m_pixmapMutex);
 
-#ifdef _DEBUG_2
-    std::cout << "Format: " << m_image->format() << std::endl;
-    setVisualEffect(NeuTube::Display::Image::VE_HIGH_CONTRAST);
-#endif
-    m_z = z;
-  }
+  delete m_image;
+  m_image = image;
+  m_rawImage = rawImage;
+  m_z = z;
 
   if (hasVisualEffect(NeuTube::Display::Image::VE_HIGH_CONTRAST) != highContrast) {
     if (highContrast) {
@@ -90,19 +91,65 @@ void ZDvidTile::loadDvidSlice(
     } else {
       removeVisualEffect(NeuTube::Display::Image::VE_HIGH_CONTRAST);
     }
-    modified = true;
   }
 
+  updatePixmap();
+}
+
+void ZDvidTile::cacheDvidSlice(const uchar *buf, int length, int z) const
+{
+  std::string key = getCacheKey(z);
+  if (!ZDvidTileCache::getInstance().contains(key)) {
+    QImage rawImage;
+    if (rawImage.loadFromData(buf, length)) {
+      ZDvidTileCache::getInstance().put(key, rawImage);
+    }
+  }
+}
+
+bool ZDvidTile::loadFromCache(int z, bool highContrast)
+{
+  QImage rawImage;
+  if (ZDvidTileCache::getInstance().get(getCacheKey(z), &rawImage)) {
+    setImage(makeDisplayImage(rawImage, highContrast), rawImage, z,
+             highContrast);
+    return true;
+  }
+
+  return false;
+}
+
+void ZDvidTile::loadDvidSlice(
+    const uchar *buf, int length, int z, bool highContrast)
+{
+  bool loading = true;
+  if (m_view != NULL) {
+    if (m_view->getZ(NeuTube::COORD_STACK) != z) {
+      loading = false;
+    }
+  }
+
+  //Decode outside of the lock so that painting is not blocked
+  QImage rawImage;
+  if (rawImage.loadFromData(buf, length)) {
 #ifdef _DEBUG_2
-  modified = false;
+    std::cout << "Tile decoded: " << rawImage.format() << std::endl;
 #endif
-
-  if (modified) {
-    m_image->enhanceContrast(highContrast);
-    updatePixmap();
+    ZDvidTileCache::getInstance().put(getCacheKey(z), rawImage);
+    if (loading) {
+      setImage(makeDisplayImage(rawImage, highContrast), rawImage, z,
+               highContrast);
+    }
   }
 }
 
+bool ZDvidTile::isReady(int z) const
+{
+  QMutexLocker locker(&m_pixmapMutex);
+
+  return (m_image != NULL) && (m_z == z);
+}
+
 void ZDvidTile::updatePixmap()
 {
 //  QMutexLocker locker(&m_pixmapMutex);
@@ -141,6 +188,8 @@ void ZDvidTile::updatePixmap()
 
 void ZDvidTile::enhanceContrast(bool high, bool updatingPixmap)
 {
+  QMutexLocker locker(&m_pixmapMutex);
+
   if (high != hasVisualEffect(NeuTube::Display::Image::VE_HIGH_CONTRAST)) {
     if (high) {
       addVisualEffect(NeuTube::Display::Image::VE_HIGH_CONTRAST);
@@ -148,9 +197,10 @@ void ZDvidTile::enhanceContrast(bool high, bool updatingPixmap)
       removeVisualEffect(NeuTube::Display::Image::VE_HIGH_CONTRAST);
     }
 
-    if (m_image != NULL) {
-      m_image->enhanceContrast(
-            hasVisualEffect(NeuTube::Display::Image::VE_HIGH_CONTRAST));
+    //Derive the new variant from the decoded image instead of reloading
+    if (!m_rawImage.isNull()) {
+      delete m_image;
+      m_image = makeDisplayImage(m_rawImage, high);
       if (updatingPixmap) {
         updatePixmap();
       }
@@ -231,6 +281,8 @@ void ZDvidTile::display(
   const_cast<ZDvidTile&>(*this).update(z);
       //  std::cout << "tile update time: " << toc() << std::endl;
 
+  QMutexLocker locker(&m_pixmapMutex);
+
   if ((z == m_z)  && (m_image != NULL)) {
 #ifdef _DEBUG_2
     std::cout << "Display tile: " << z << std::endl;
@@ -253,7 +305,6 @@ void ZDvidTile::display(
 //    QElapsedTimer timer;
 //    timer.start();
 //    tic();
-//    QMutexLocker locker(const_cast<QMutex*>(&m_pixmapMutex));
 
     painter.drawPixmap(getX(), getY(), m_pixmap);
 //    painter.drawImage(getX(), getY(), *m_image);
@@ -287,6 +338,11 @@ void ZDvidTile::setTileIndex(int ix, int iy)
 void ZDvidTile::update(int z)
 {
   if (m_z != z || m_image == NULL) {
+    if (loadFromCache(
+          z, hasVisualEffect(NeuTube::Display::Image::VE_HIGH_CONTRAST))) {
+      return;
+    }
+
 #if defined(_ENABLE_LIBDVIDCPP_2)
     std::vector<int> offset(3);
     offset[0] = m_ix;
@@ -35,6 +35,11 @@ public:
   void clear();
 
   void update(int z);
+
+  /*!
+   * \brief Check if the tile has been loaded for slice \a z.
+   */
+  bool isReady(int z) const;
 //  void update(int x, int y, int z, int width, int height);
 
   void setTileIndex(int ix, int iy);
@@ -43,6 +48,23 @@ public:
   void loadDvidSlice(const QByteArray &buffer, int z, bool highConstrast);
   void loadDvidSlice(const uchar *buf, int length, int z, bool highContrast);
 
+  /*!
+   * \brief Load the tile of slice \a z from the shared tile cache.
+   *
+   * \return true iff the tile is found in the cache.
+   */
+  bool loadFromCache(int z, bool highContrast);
+
+  /*!
+   * \brief Decode the tile data of slice \a z into the tile cache only.
+   */
+  void cacheDvidSlice(const uchar *buf, int length, int z) const;
+
+  /*!
+   * \brief Key of the tile of slice \a z in the shared tile cache.
+   */
+  std::string getCacheKey(int z) const;
+
 //  void setTileOffset(int x, int y, int z);
 
   virtual const std::string& className() const;
@@ -80,8 +102,14 @@ public:
 
   void updatePixmap();
 
+private:
+  ZImage* makeDisplayImage(const QImage &rawImage, bool highContrast) const;
+  void setImage(ZImage *image, const QImage &rawImage, int z,
+                bool highContrast);
+
 private:
   ZImage *m_image;
+  QImage m_rawImage; //decoded image without contrast enhancement
   ZPixmap m_pixmap;
   int m_ix;
   int m_iy;
@@ -91,7 +119,7 @@ private:
   ZDvidTileInfo m_tilingInfo;
   ZDvidTarget m_dvidTarget;
 
-  QMutex m_pixmapMutex;
+  mutable QMutex m_pixmapMutex;
 
   ZStackView *m_view;
 };
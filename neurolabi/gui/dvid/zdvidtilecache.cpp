@@ -0,0 +1,187 @@
+#include "zdvidtilecache.h"
+
+#include <sstream>
+
+#include <QMutexLocker>
+
+ZDvidTileCache::ZDvidTileCache() :
+  m_enabled(true), m_memoryLimit(256 * 1024 * 1024), m_memoryUsage(0),
+  m_hitCount(0), m_missCount(0), m_evictionCount(0)
+{
+}
+
+ZDvidTileCache& ZDvidTileCache::getInstance()
+{
+  static ZDvidTileCache cache;
+
+  return cache;
+}
+
+std::string ZDvidTileCache::GetKey(
+    const std::string &uuid, const std::string &dataName,
+    int resLevel, int ix, int iy, int z)
+{
+  std::ostringstream stream;
+  stream << uuid << "/" << dataName << "/" << resLevel << "/"
+         << ix << "_" << iy << "_" << z;
+
+  return stream.str();
+}
+
+size_t ZDvidTileCache::GetByteCount(const QImage &image)
+{
+  return (size_t) image.bytesPerLine() * image.height();
+}
+
+void ZDvidTileCache::setEnabled(bool enabled)
+{
+  QMutexLocker locker(&m_mutex);
+  m_enabled = enabled;
+}
+
+bool ZDvidTileCache::isEnabled() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_enabled;
+}
+
+void ZDvidTileCache::setMemoryLimit(size_t limit)
+{
+  QMutexLocker locker(&m_mutex);
+  m_memoryLimit = limit;
+  evict();
+}
+
+size_t ZDvidTileCache::getMemoryLimit() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_memoryLimit;
+}
+
+bool ZDvidTileCache::get(const std::string &key, QImage *image)
+{
+  QMutexLocker locker(&m_mutex);
+
+  if (!m_enabled) {
+    return false;
+  }
+
+  std::map<std::string, Entry>::iterator iter = m_entryMap.find(key);
+  if (iter != m_entryMap.end()) {
+    m_lru.splice(m_lru.begin(), m_lru, iter->second.lruIter);
+    if (image != NULL) {
+      *image = iter->second.image;
+    }
+    ++m_hitCount;
+    return true;
+  }
+
+  ++m_missCount;
+
+  return false;
+}
+
+bool ZDvidTileCache::contains(const std::string &key) const
+{
+  QMutexLocker locker(&m_mutex);
+
+  return m_enabled && m_entryMap.count(key) > 0;
+}
+
+void ZDvidTileCache::put(const std::string &key, const QImage &image)
+{
+  QMutexLocker locker(&m_mutex);
+
+  if (!m_enabled || image.isNull()) {
+    return;
+  }
+
+  std::map<std::string, Entry>::iterator iter = m_entryMap.find(key);
+  if (iter != m_entryMap.end()) {
+    m_memoryUsage -= GetByteCount(iter->second.image);
+    iter->second.image = image;
+    m_lru.splice(m_lru.begin(), m_lru, iter->second.lruIter);
+  } else {
+    m_lru.push_front(key);
+    Entry &entry = m_entryMap[key];
+    entry.image = image;
+    entry.lruIter = m_lru.begin();
+  }
+  m_memoryUsage += GetByteCount(image);
+
+  evict();
+}
+
+void ZDvidTileCache::evict()
+{
+  while (m_memoryUsage > m_memoryLimit && !m_lru.empty()) {
+    std::map<std::string, Entry>::iterator iter = m_entryMap.find(m_lru.back());
+    m_memoryUsage -= GetByteCount(iter->second.image);
+    m_entryMap.erase(iter);
+    m_lru.pop_back();
+    ++m_evictionCount;
+  }
+}
+
+void ZDvidTileCache::clear()
+{
+  QMutexLocker locker(&m_mutex);
+
+  m_entryMap.clear();
+  m_lru.clear();
+  m_memoryUsage = 0;
+}
+
+size_t ZDvidTileCache::getMemoryUsage() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_memoryUsage;
+}
+
+int ZDvidTileCache::getHitCount() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_hitCount;
+}
+
+int ZDvidTileCache::getMissCount() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_missCount;
+}
+
+int ZDvidTileCache::getEvictionCount() const
+{
+  QMutexLocker locker(&m_mutex);
+  return m_evictionCount;
+}
+
+void ZDvidTileCache::resetStat()
+{
+  QMutexLocker locker(&m_mutex);
+  m_hitCount = 0;
+  m_missCount = 0;
+  m_evictionCount = 0;
+}
+
+std::string ZDvidTileCache::getStatReport() const
+{
+  QMutexLocker locker(&m_mutex);
+
+  int total = m_hitCount + m_missCount;
+  double hitRate = 0.0;
+  if (total > 0) {
+    hitRate = (double) m_hitCount / total;
+  }
+
+  std::ostringstream stream;
+  stream << "Tile cache: " << (m_enabled ? "on" : "off") << std::endl;
+  stream << "  Hits: " << m_hitCount << std::endl;
+  stream << "  Misses: " << m_missCount << std::endl;
+  stream << "  Hit rate: " << hitRate * 100.0 << "%" << std::endl;
+  stream << "  Evictions: " << m_evictionCount << std::endl;
+  stream << "  Memory: " << m_memoryUsage << " / " << m_memoryLimit
+         << " bytes in " << m_entryMap.size() << " tiles" << std::endl;
+
+  return stream.str();
+}
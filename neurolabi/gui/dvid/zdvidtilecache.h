@@ -0,0 +1,102 @@
+#ifndef ZDVIDTILECACHE_H
+#define ZDVIDTILECACHE_H
+
+#include <string>
+#include <map>
+#include <list>
+
+#include <QImage>
+#include <QMutex>
+
+/*!
+ * \brief The class of caching decoded DVID grayscale tiles
+ *
+ * A tile is addressed by the uuid of the node, the data name, the resolution
+ * level, the tile index and the slice, so tiles decoded for one view are
+ * reused by all the others. The cached image is the tile as decoded, before
+ * any contrast enhancement, which lets the displayed variants be derived from
+ * it. The cache drops the least recently used tiles when its size exceeds the
+ * byte limit.
+ */
+class ZDvidTileCache
+{
+public:
+  static ZDvidTileCache& getInstance();
+
+  /*!
+   * \brief Get the key of a tile.
+   */
+  static std::string GetKey(const std::string &uuid,
+                            const std::string &dataName,
+                            int resLevel, int ix, int iy, int z);
+
+  /*!
+   * \brief Get a tile from the cache.
+   *
+   * \param key Key of the tile.
+   * \param image Output image, which shares its data with the cache.
+   * \return true iff the tile is found.
+   */
+  bool get(const std::string &key, QImage *image);
+
+  /*!
+   * \brief Check if a tile is in the cache without affecting the LRU order.
+   */
+  bool contains(const std::string &key) const;
+
+  /*!
+   * \brief Add a tile to the cache.
+   *
+   * Nothing is done if the cache is disabled or \a image is null.
+   */
+  void put(const std::string &key, const QImage &image);
+
+  void clear();
+
+  void setEnabled(bool enabled);
+  bool isEnabled() const;
+
+  /*!
+   * \brief Set the size limit (bytes) of the cache.
+   */
+  void setMemoryLimit(size_t limit);
+  size_t getMemoryLimit() const;
+  size_t getMemoryUsage() const;
+
+  int getHitCount() const;
+  int getMissCount() const;
+  int getEvictionCount() const;
+  void resetStat();
+
+  /*!
+   * \brief Report of the hit/miss statistics.
+   */
+  std::string getStatReport() const;
+
+private:
+  ZDvidTileCache();
+
+  struct Entry {
+    QImage image;
+    std::list<std::string>::iterator lruIter;
+  };
+
+  static size_t GetByteCount(const QImage &image);
+  void evict();
+
+private:
+  mutable QMutex m_mutex;
+
+  bool m_enabled;
+  size_t m_memoryLimit;
+
+  std::map<std::string, Entry> m_entryMap;
+  std::list<std::string> m_lru; //most recent first
+  size_t m_memoryUsage;
+
+  int m_hitCount;
+  int m_missCount;
+  int m_evictionCount;
+};
+
+#endif // ZDVIDTILECACHE_H
@@ -1,12 +1,20 @@
 #include "zdvidtileensemble.h"
+#include <algorithm>
+#include <set>
 #include <QRect>
 #include <QElapsedTimer>
 #include <QtCore>
+#include <QtConcurrentRun>
+#include <QtConcurrentMap>
 
 #include "zstackview.h"
 #include "dvid/zdvidreader.h"
 #include "widgets/zimagewidget.h"
 #include "flyem/zdvidtileupdatetaskmanager.h"
+#include "zdvidtilecache.h"
+
+const size_t ZDvidTileEnsemble::m_fetchBatchSize = 8;
+const int ZDvidTileEnsemble::m_prefetchDepth = 2;
 
 ZDvidTileEnsemble::ZDvidTileEnsemble()
 {
@@ -14,6 +22,10 @@ ZDvidTileEnsemble::ZDvidTileEnsemble()
   m_type = GetType();
   m_highContrast = false;
   m_view = NULL;
+  m_requestedLevel = -1;
+  m_requestedZ = 0;
+  m_firstPaintLatency = -1;
+  m_frameLatency = -1;
 }
 
 ZDvidTileEnsemble::~ZDvidTileEnsemble()
@@ -23,6 +35,8 @@ ZDvidTileEnsemble::~ZDvidTileEnsemble()
 
 void ZDvidTileEnsemble::clear()
 {
+  cancelFetching();
+
   for (std::vector<std::map<ZDvidTileInfo::TIndex, ZDvidTile*> >::iterator
        iter = m_tileGroup.begin(); iter != m_tileGroup.end(); ++iter) {
     for (std::map<ZDvidTileInfo::TIndex, ZDvidTile*>::iterator tileIter =
@@ -30,6 +44,9 @@ void ZDvidTileEnsemble::clear()
       delete tileIter->second;
     }
   }
+  m_tileGroup.clear();
+  m_requestedIndices.clear();
+  m_requestedLevel = -1;
 
 #if defined(_ENABLE_LIBDVIDCPP_)
     for (std::vector<libdvid::DVIDNodeService*>::iterator
@@ -37,9 +54,21 @@ void ZDvidTileEnsemble::clear()
          iter != m_serviceArray.end(); ++iter) {
       delete *iter;
     }
+    m_serviceArray.clear();
+    m_freeServiceArray.clear();
 #endif
 }
 
+void ZDvidTileEnsemble::cancelFetching()
+{
+  m_generation.fetchAndAddOrdered(1);
+  for (QList<QFuture<void> >::iterator iter = m_futureList.begin();
+       iter != m_futureList.end(); ++iter) {
+    iter->waitForFinished();
+  }
+  m_futureList.clear();
+}
+
 void ZDvidTileEnsemble::enhanceContrast(bool high)
 {
   m_highContrast = high;
@@ -55,11 +84,7 @@ void ZDvidTileEnsemble::updateContrast()
          tileMap.begin(); tileIter != tileMap.end(); ++tileIter) {
       ZDvidTile *tile = tileIter->second;
       if (tile != NULL) {
-        if (m_highContrast) {
-          tile->addVisualEffect(NeuTube::Display::Image::VE_HIGH_CONTRAST);
-        } else {
-          tile->removeVisualEffect(NeuTube::Display::Image::VE_HIGH_CONTRAST);
-        }
+        tile->enhanceContrast(m_highContrast, true);
       }
     }
   }
@@ -86,24 +111,74 @@ ZDvidTile* ZDvidTileEnsemble::getTile(
 
   return tileMap[index];
 }
-#if defined(_ENABLE_LIBDVIDCPP_)
-struct UpdateTileParam {
-  ZDvidTileEnsemble *te;
-//  libdvid::DVIDNodeService *service;
-  libdvid::Slice2D slice;
-  int resLevel;
-  std::vector<int> loc;
-  int z;
-  ZDvidTile *tile;
-  libdvid::DVIDNodeService *service;
-};
-
-void UpdateTileFunc(UpdateTileParam &param)
+
+ZDvidTile* ZDvidTileEnsemble::findTile(
+    int resLevel, const ZDvidTileInfo::TIndex &index) const
+{
+  if (resLevel >= 0 && resLevel < (int) m_tileGroup.size()) {
+    const std::map<ZDvidTileInfo::TIndex, ZDvidTile*> &tileMap =
+        m_tileGroup[resLevel];
+    std::map<ZDvidTileInfo::TIndex, ZDvidTile*>::const_iterator iter =
+        tileMap.find(index);
+    if (iter != tileMap.end()) {
+      return iter->second;
+    }
+  }
+
+  return NULL;
+}
+
+bool ZDvidTileEnsemble::isReady(
+    const std::vector<ZDvidTileInfo::TIndex>& tileIndices,
+    int resLevel, int z) const
+{
+  for (std::vector<ZDvidTileInfo::TIndex>::const_iterator
+       iter = tileIndices.begin(); iter != tileIndices.end(); ++iter) {
+    ZDvidTile *tile = findTile(resLevel, *iter);
+    if (tile == NULL) {
+      return false;
+    }
+    if (!tile->isReady(z)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+std::vector<ZDvidTileInfo::TIndex> ZDvidTileEnsemble::GetCoarseIndices(
+    const std::vector<ZDvidTileInfo::TIndex>& tileIndices, int levelDiff)
+{
+  int scale = 1;
+  for (int i = 0; i < levelDiff; ++i) {
+    scale *= ZDvidTileInfo::getLevelScale();
+  }
+
+  std::set<ZDvidTileInfo::TIndex> indexSet;
+  for (std::vector<ZDvidTileInfo::TIndex>::const_iterator
+       iter = tileIndices.begin(); iter != tileIndices.end(); ++iter) {
+    indexSet.insert(ZDvidTileInfo::TIndex(iter->first / scale,
+                                          iter->second / scale));
+  }
+
+  return std::vector<ZDvidTileInfo::TIndex>(indexSet.begin(), indexSet.end());
+}
+
+int ZDvidTileEnsemble::getFirstPaintLatency() const
 {
-  param.te->updateTile(param.slice, param.resLevel, param.loc, param.z,
-        param.tile, param.service);
+  QMutexLocker locker(&m_latencyMutex);
+
+  return m_firstPaintLatency;
 }
 
+int ZDvidTileEnsemble::getFrameLatency() const
+{
+  QMutexLocker locker(&m_latencyMutex);
+
+  return m_frameLatency;
+}
+
+#if defined(_ENABLE_LIBDVIDCPP_)
 void ZDvidTileEnsemble::updateTile(libdvid::Slice2D slice,
     int resLevel, const std::vector<int> &loc, int z, ZDvidTile *tile,
                                    libdvid::DVIDNodeService *service)
@@ -124,198 +199,330 @@ void ZDvidTileEnsemble::updateTile(libdvid::Slice2D slice,
 }
 #endif
 
-bool ZDvidTileEnsemble::update(
-    const std::vector<ZDvidTileInfo::TIndex>& tileIndices, int resLevel, int z)
+#if defined(_ENABLE_LIBDVIDCPP_)
+bool ZDvidTileEnsemble::isStale(int generation) const
 {
-  if (!m_reader.good()) {
-    return false;
+  return m_generation.loadAcquire() != generation;
+}
+
+void ZDvidTileEnsemble::requestRepaint()
+{
+  if (m_view != NULL) {
+    QMetaObject::invokeMethod(m_view, "paintActiveTile", Qt::QueuedConnection);
   }
+}
 
-  bool updated = false;
-#if defined(_ENABLE_LIBDVIDCPP_)
-  std::vector<std::vector<int> > tile_locs_array;
-  for (std::vector<ZDvidTileInfo::TIndex>::const_iterator iter = tileIndices.begin();
-       iter != tileIndices.end(); ++iter) {
-    const ZDvidTileInfo::TIndex &index = *iter;
-    ZDvidTile *tile = const_cast<ZDvidTileEnsemble*>(this)->getTile(resLevel, index);
-    if (tile != NULL) {
-      std::vector<int> loc(3);
-      loc[0] = tile->getIx();
-      loc[1] = tile->getIy();
-      loc[2] = z;
-      tile_locs_array.push_back(loc);
-    }
+libdvid::DVIDNodeService* ZDvidTileEnsemble::acquireService()
+{
+  QMutexLocker locker(&m_serviceMutex);
+
+  if (m_freeServiceArray.empty()) {
+    libdvid::DVIDNodeService *service = new libdvid::DVIDNodeService(
+          m_dvidTarget.getAddressWithPort(), m_dvidTarget.getUuid());
+    m_serviceArray.push_back(service);
+
+    return service;
   }
 
-  try  {
-#if 0
-    if (!tile_locs_array.empty()) {
+  libdvid::DVIDNodeService *service = m_freeServiceArray.back();
+  m_freeServiceArray.pop_back();
 
-      QVector<UpdateTileParam> paramList(tile_locs_array.size());
-      size_t dataIndex = 0;
-      std::vector<ZDvidTile*> updatedTileArray;
-      for (std::vector<ZDvidTileInfo::TIndex>::const_iterator iter = tileIndices.begin();
-           iter != tileIndices.end(); ++iter) {
-        const ZDvidTileInfo::TIndex &index = *iter;
-        ZDvidTile *tile = const_cast<ZDvidTileEnsemble*>(this)->getTile(
-              resLevel, index);
-        if (tile != NULL) {
-          UpdateTileParam &param = paramList[dataIndex];
-          param.te = this;
-//          param.service = &service;
-          param.resLevel = resLevel;
-          param.z = z;
-          param.tile = tile;
-          param.slice = libdvid::XY;
-          param.loc = tile_locs_array[dataIndex];
-          param.service = m_serviceArray[dataIndex];
-          dataIndex++;
-          updatedTileArray.push_back(tile);
+  return service;
+}
+
+void ZDvidTileEnsemble::releaseService(libdvid::DVIDNodeService *service)
+{
+  if (service != NULL) {
+    QMutexLocker locker(&m_serviceMutex);
+    m_freeServiceArray.push_back(service);
+  }
+}
+
+void ZDvidTileEnsemble::fetchTiles(
+    QList<TileRequest> requestList, int generation, QElapsedTimer timer,
+    bool highContrast)
+{
+  libdvid::DVIDNodeService *service = NULL;
+  bool painted = false;
+  bool frameDone = requestList.isEmpty() || !requestList.first().visible;
+
+  try {
+    service = acquireService();
+
+    for (QList<TileRequest>::const_iterator iter = requestList.begin();
+         iter != requestList.end(); ++iter) {
+      const TileRequest &request = *iter;
+      if (!request.visible && !frameDone) {
+        frameDone = true;
+        QMutexLocker locker(&m_latencyMutex);
+        m_frameLatency = (int) timer.elapsed();
+        std::cout << "Frame latency: " << m_frameLatency << "ms" << std::endl;
+        if (m_frameLatency > 3000) {
+          LWARN() << "Tile reading hickup.";
         }
       }
 
-      std::cout << "Reading tiles ..." << std::endl;
-      QElapsedTimer timer;
-      timer.start();
-      QtConcurrent::blockingMap(paramList, &UpdateTileFunc);
-      qint64 tileReadingTime = timer.restart();
+      for (size_t start = 0; start < request.tileArray.size();
+           start += m_fetchBatchSize) {
+        if (isStale(generation)) {
+          releaseService(service);
+          return;
+        }
 
-      std::cout << tile_locs_array.size() << "x tile reading time: "
-                << tileReadingTime << std::endl;
+        size_t end = std::min(start + m_fetchBatchSize,
+                              request.tileArray.size());
+
+        //Tiles decoded before are taken from the cache
+        std::vector<ZDvidTile*> tileArray;
+        std::vector<std::vector<int> > locArray;
+        for (size_t i = start; i < end; ++i) {
+          ZDvidTile *tile = request.tileArray[i];
+          bool cached = false;
+          if (request.decoding) {
+            cached = tile->loadFromCache(request.z, highContrast);
+          } else {
+            cached = ZDvidTileCache::getInstance().contains(
+                  tile->getCacheKey(request.z));
+          }
+          if (!cached) {
+            std::vector<int> loc(3);
+            loc[0] = tile->getIx();
+            loc[1] = tile->getIy();
+            loc[2] = request.z;
+            locArray.push_back(loc);
+            tileArray.push_back(tile);
+          }
+        }
 
-      for (std::vector<ZDvidTile*>::iterator iter = updatedTileArray.begin();
-           iter != updatedTileArray.end(); ++iter) {
-        ZDvidTile *tile =*iter;
-        tile->updatePixmap();
-      }
+        if (!locArray.empty()) {
+          std::vector<libdvid::BinaryDataPtr> data = get_tile_array_binary(
+                *service, m_dvidTarget.getMultiscale2dName(),
+                libdvid::XY, request.resLevel, locArray);
+
+          if (isStale(generation)) {
+            releaseService(service);
+            return;
+          }
+
+          QList<ZDvidTileDecodeTask*> taskList;
+          for (size_t i = 0; i < data.size() && i < tileArray.size(); ++i) {
+            libdvid::BinaryDataPtr dataPtr = data[i];
+            if (dataPtr && dataPtr->length() > 0) {
+              ZDvidTileDecodeTask *task =
+                  new ZDvidTileDecodeTask(NULL, tileArray[i]);
+              task->setZ(request.z);
+              task->setData(dataPtr->get_raw(), dataPtr->length());
+              task->setHighContrast(highContrast);
+              task->setCachingOnly(!request.decoding);
+              taskList.append(task);
+            }
+          }
+
+          QtConcurrent::blockingMap(taskList, &ZDvidTileDecodeTask::ExecuteTask);
+
+          for (QList<ZDvidTileDecodeTask*>::iterator taskIter = taskList.begin();
+               taskIter != taskList.end(); ++taskIter) {
+            delete *taskIter;
+          }
+        }
 
-      std::cout << "Pixmap preparing time: " << timer.elapsed() << std::endl;
-    }
-#else
-//    ZMultiTaskManager taskManager;
-    if (!tile_locs_array.empty()) {
-      std::cout << "Reading tiles ..." << std::endl;
-      QElapsedTimer timer;
-      timer.start();
-//      libdvid::DVIDNodeService service(getDvidTarget().getAddressWithPort(),
-//                                       getDvidTarget().getUuid());
-      std::cout << "Connecting time: " << timer.elapsed() << std::endl;
-
-#define DVID_TILE_THREAD_FETCH 1
-
-#if DVID_TILE_THREAD_FETCH
-      std::vector<libdvid::BinaryDataPtr> data = get_tile_array_binary(
-            *(m_reader.getService()), m_dvidTarget.getMultiscale2dName(),
-            libdvid::XY, resLevel, tile_locs_array);
-#else
-      std::vector<libdvid::BinaryDataPtr> data(tile_locs_array.size());
-      for (size_t i = 0; i < tile_locs_array.size(); ++i) {
-        data[i] = m_reader.getService()->get_tile_slice_binary(
-              m_dvidTarget.getMultiscale2dName(),
-              libdvid::XY, resLevel, tile_locs_array[i]);
+        if (request.visible && !isStale(generation)) {
+          if (!painted) {
+            painted = true;
+            QMutexLocker locker(&m_latencyMutex);
+            m_firstPaintLatency = (int) timer.elapsed();
+          }
+          requestRepaint();
+        }
       }
+    }
+  } catch (std::exception &e) {
+    std::cout << e.what() << std::endl;
+  }
+
+  if (!frameDone && !isStale(generation)) {
+    QMutexLocker locker(&m_latencyMutex);
+    m_frameLatency = (int) timer.elapsed();
+    std::cout << "Frame latency: " << m_frameLatency << "ms" << std::endl;
+  }
+
+  releaseService(service);
+}
 #endif
 
-      qint64 tileReadingTime = timer.elapsed();
+bool ZDvidTileEnsemble::update(
+    const std::vector<ZDvidTileInfo::TIndex>& tileIndices, int resLevel, int z)
+{
+  if (!m_reader.good()) {
+    return false;
+  }
+
+  bool updated = false;
+#if defined(_ENABLE_LIBDVIDCPP_)
+  updated = isReady(tileIndices, resLevel, z);
 
-      std::cout << data.size() << "x tile reading time: " << tileReadingTime << std::endl;
-      if (tileReadingTime > 3000) {
-        LWARN() << "Tile reading hickup.";
-      }
+  if (resLevel == m_requestedLevel && z == m_requestedZ &&
+      tileIndices == m_requestedIndices) { //still being served
+    return updated;
+  }
 
-      size_t dataIndex = 0;
+  //Cancel the stale request, which stops at its next batch
+  int generation = m_generation.fetchAndAddOrdered(1) + 1;
+  for (QList<QFuture<void> >::iterator iter = m_futureList.begin();
+       iter != m_futureList.end();) {
+    if (iter->isFinished()) {
+      iter = m_futureList.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
 
-      QList<ZDvidTile*> tileList;
-      QList<ZDvidTileDecodeTask*> taskList;
-      for (std::vector<ZDvidTileInfo::TIndex>::const_iterator iter = tileIndices.begin();
-           iter != tileIndices.end(); ++iter) {
-        const ZDvidTileInfo::TIndex &index = *iter;
-        ZDvidTile *tile = const_cast<ZDvidTileEnsemble*>(this)->getTile(
-              resLevel, index);
-        if (tile != NULL) {
-          libdvid::BinaryDataPtr dataPtr= data[dataIndex++];
-
-          ZDvidTileDecodeTask *task = new ZDvidTileDecodeTask(NULL, tile);
-          task->setZ(z);
-          task->setData(dataPtr->get_raw(), dataPtr->length());
-          task->setHighContrast(m_highContrast);
-          taskList.append(task);
-          tileList.append(tile);
-        }
+  //Slices visited before are served by the tile cache right away
+  if (!updated) {
+    for (std::vector<ZDvidTileInfo::TIndex>::const_iterator
+         iter = tileIndices.begin(); iter != tileIndices.end(); ++iter) {
+      ZDvidTile *tile = getTile(resLevel, *iter);
+      if (!tile->isReady(z)) {
+        tile->loadFromCache(z, m_highContrast);
       }
+    }
+    updated = isReady(tileIndices, resLevel, z);
+  }
 
-      timer.start();
-      QtConcurrent::blockingMap(taskList, &ZDvidTileDecodeTask::ExecuteTask);
-      qint64 tileDecodingTime = timer.elapsed();
-      std::cout <<"decoding time: " << tileDecodingTime << std::endl;
-      if (tileDecodingTime > 3000) {
-        LWARN() << "Tile decoding hickup.";
-      }
+  std::vector<ZDvidTileInfo::TIndex> lastIndices;
+  if (resLevel == m_requestedLevel) {
+    lastIndices.swap(m_requestedIndices);
+  }
+  int dz = z - m_requestedZ;
+  m_requestedIndices = tileIndices;
+  m_requestedLevel = resLevel;
+  m_requestedZ = z;
+
+  QElapsedTimer timer;
+  timer.start();
+  {
+    QMutexLocker locker(&m_latencyMutex);
+    m_firstPaintLatency = -1;
+    m_frameLatency = -1;
+    if (updated) {
+      m_firstPaintLatency = 0;
+      m_frameLatency = 0;
+    }
+  }
 
+  QList<TileRequest> requestList;
+  if (!updated) {
+    //A few coarse tiles to show something right away
+    int coarseLevel = resLevel;
+    std::vector<ZDvidTileInfo::TIndex> coarseIndices = tileIndices;
+    while (coarseLevel < m_tilingInfo.getMaxLevel() && coarseIndices.size() > 4) {
+      ++coarseLevel;
+      coarseIndices = GetCoarseIndices(tileIndices, coarseLevel - resLevel);
+    }
 
-#if 0
-      for (QList<ZDvidTile*>::iterator iter = tileList.begin();
-           iter != tileList.end(); ++iter) {
-        ZDvidTile *tile = *iter;
-        tile->updatePixmap();
+    if (coarseLevel > resLevel) {
+      TileRequest request;
+      request.resLevel = coarseLevel;
+      request.z = z;
+      for (std::vector<ZDvidTileInfo::TIndex>::const_iterator
+           iter = coarseIndices.begin(); iter != coarseIndices.end(); ++iter) {
+        ZDvidTile *tile = getTile(coarseLevel, *iter);
+        if (!tile->isReady(z)) {
+          request.tileArray.push_back(tile);
+        }
       }
-#endif
-
-      for (QList<ZDvidTileDecodeTask*>::iterator iter = taskList.begin();
-           iter != taskList.end(); ++iter) {
-        delete *iter;
+      if (request.tileArray.empty()) {
+        QMutexLocker locker(&m_latencyMutex);
+        m_firstPaintLatency = 0;
+      } else {
+        requestList.append(request);
       }
+    }
 
-      updated = true;
-
-#if 0
-//      QThreadFutureMap futureMap;
-      QList<QFuture<void> > futureList;
+    TileRequest request;
+    request.resLevel = resLevel;
+    request.z = z;
+    for (std::vector<ZDvidTileInfo::TIndex>::const_iterator
+         iter = tileIndices.begin(); iter != tileIndices.end(); ++iter) {
+      ZDvidTile *tile = getTile(resLevel, *iter);
+      if (!tile->isReady(z)) {
+        request.tileArray.push_back(tile);
+      }
+    }
+    requestList.append(request);
+  }
 
-      for (std::vector<ZDvidTileInfo::TIndex>::const_iterator iter = tileIndices.begin();
-           iter != tileIndices.end(); ++iter) {
-        const ZDvidTileInfo::TIndex &index = *iter;
-        ZDvidTile *tile = const_cast<ZDvidTileEnsemble*>(this)->getTile(
-              resLevel, index);
-        if (tile != NULL) {
-          libdvid::BinaryDataPtr dataPtr= data[dataIndex++];
-
-          ZDvidTileDecodeTask *task = new ZDvidTileDecodeTask(NULL, tile);
-          task->setZ(z);
-          task->setData(dataPtr->get_raw(), dataPtr->length());
-          task->setHighContrast(m_highContrast);
-          taskManager.addTask(task);
-
-          QFuture<void> future = QtConcurrent::run(task, &ZDvidTileDecodeTask::execute);
-          futureList.append(future);
-            //      tile->display(painter, slice, option);
-
-//          tile->loadDvidSlice(dataPtr->get_raw(), dataPtr->length(), z);
-          /*
-          tile->setImageData(
-                data[dataIndex++]->get_raw(), m_tilingInfo.getWidth(),
-              m_tilingInfo.getHeight());
-          tile->setZ(z);
-          */
+  //Prefetch one ring of tiles in the pan direction
+  if (dz == 0 && !lastIndices.empty() && !tileIndices.empty()) {
+    double dx = 0.0;
+    double dy = 0.0;
+    for (size_t i = 0; i < tileIndices.size(); ++i) {
+      dx += tileIndices[i].first;
+      dy += tileIndices[i].second;
+    }
+    dx /= tileIndices.size();
+    dy /= tileIndices.size();
+    for (size_t i = 0; i < lastIndices.size(); ++i) {
+      dx -= (double) lastIndices[i].first / lastIndices.size();
+      dy -= (double) lastIndices[i].second / lastIndices.size();
+    }
+    int sx = (dx > 0.0) - (dx < 0.0);
+    int sy = (dy > 0.0) - (dy < 0.0);
+
+    if (sx != 0 || sy != 0) {
+      std::set<ZDvidTileInfo::TIndex> indexSet(
+            tileIndices.begin(), tileIndices.end());
+      TileRequest request;
+      request.resLevel = resLevel;
+      request.z = z;
+      request.visible = false;
+      for (std::vector<ZDvidTileInfo::TIndex>::const_iterator
+           iter = tileIndices.begin(); iter != tileIndices.end(); ++iter) {
+        ZDvidTileInfo::TIndex index(iter->first + sx, iter->second + sy);
+        if (index.first >= 0 && index.second >= 0 &&
+            indexSet.count(index) == 0) {
+          indexSet.insert(index);
+          ZDvidTile *tile = getTile(resLevel, index);
+          if (!tile->isReady(z)) {
+            request.tileArray.push_back(tile);
+          }
         }
       }
-
-      for (QList<QFuture<void> >::iterator iter = futureList.begin();
-           iter != futureList.end(); ++iter) {
-        iter->waitForFinished();
+      if (!request.tileArray.empty()) {
+        requestList.append(request);
       }
+    }
+  }
 
-#endif
-//      taskManager.start();
-//      taskManager.waitForDone();
+  //Prefetch the next slices in the browsing direction, or both sides
+  for (int d = 1; d <= m_prefetchDepth; ++d) {
+    for (int sign = -1; sign <= 1; sign += 2) {
+      if (dz * sign < 0) {
+        continue;
+      }
+      TileRequest request;
+      request.resLevel = resLevel;
+      request.z = z + sign * d;
+      request.decoding = false;
+      request.visible = false;
+      for (std::vector<ZDvidTileInfo::TIndex>::const_iterator
+           iter = tileIndices.begin(); iter != tileIndices.end(); ++iter) {
+        ZDvidTile *tile = getTile(resLevel, *iter);
+        if (!ZDvidTileCache::getInstance().contains(
+              tile->getCacheKey(request.z))) {
+          request.tileArray.push_back(tile);
+        }
+      }
+      if (!request.tileArray.empty()) {
+        requestList.append(request);
+      }
     }
-#endif
+  }
 
-#ifdef _DEBUG_2
-      std::cout << "Tiles ready." << std::endl;
-#endif
-  } catch (std::exception &e) {
-    std::cout << e.what() << std::endl;
+  if (!requestList.isEmpty()) {
+    m_futureList.append(
+          QtConcurrent::run(this, &ZDvidTileEnsemble::fetchTiles,
+                            requestList, generation, timer, m_highContrast));
   }
 #else
 
@@ -336,6 +543,7 @@ bool ZDvidTileEnsemble::update(
   taskManager.start();
   taskManager.waitForDone();
   taskManager.clear();
+  updated = true;
 #endif
 
   return updated;
@@ -385,16 +593,39 @@ void ZDvidTileEnsemble::display(
     }
   }
 
-  const_cast<ZDvidTileEnsemble&>(*this).update(
-        tileIndices, resLevel, painter.getZ(slice));
+  int z = painter.getZ(slice);
+  bool ready = const_cast<ZDvidTileEnsemble&>(*this).update(
+        tileIndices, resLevel, z);
 
 //  const_cast<ZDvidTileEnsemble&>(*this).updateContrast();
 
+  //Coarser tiles stand in for the ones still being loaded
+  if (!ready) {
+    for (int level = m_tilingInfo.getMaxLevel(); level > resLevel; --level) {
+      std::vector<ZDvidTileInfo::TIndex> coarseIndices =
+          GetCoarseIndices(tileIndices, level - resLevel);
+      for (std::vector<ZDvidTileInfo::TIndex>::const_iterator
+           iter = coarseIndices.begin(); iter != coarseIndices.end(); ++iter) {
+        ZDvidTile *tile = findTile(level, *iter);
+        if (tile != NULL) {
+          if (tile->isReady(z)) {
+            tile->display(painter, slice, option, sliceAxis);
+          }
+        }
+      }
+    }
+  }
+
   for (std::vector<ZDvidTileInfo::TIndex>::const_iterator iter = tileIndices.begin();
        iter != tileIndices.end(); ++iter) {
     const ZDvidTileInfo::TIndex &index = *iter;
     ZDvidTile *tile = const_cast<ZDvidTileEnsemble*>(this)->getTile(resLevel, index);
     if (tile != NULL) {
+#if defined(_ENABLE_LIBDVIDCPP_)
+      if (!tile->isReady(z)) { //being fetched in the background
+        continue;
+      }
+#endif
 //      tile->enhanceContrast(m_highContrast, true);
       tile->display(painter, slice, option, sliceAxis);
     }
@@ -404,19 +635,11 @@ void ZDvidTileEnsemble::display(
 
 void ZDvidTileEnsemble::setDvidTarget(const ZDvidTarget &dvidTarget)
 {
+  clear();
+
   m_dvidTarget = dvidTarget;
   if (m_reader.open(dvidTarget)) {
     m_tilingInfo = m_reader.readTileInfo(dvidTarget.getMultiscale2dName());
-
-#if defined(_ENABLE_LIBDVIDCPP_)
-    m_serviceArray.resize(36);
-    for (std::vector<libdvid::DVIDNodeService*>::iterator
-         iter = m_serviceArray.begin();
-         iter != m_serviceArray.end(); ++iter) {
-      *iter = new libdvid::DVIDNodeService(
-            dvidTarget.getAddressWithPort(), dvidTarget.getUuid());
-    }
-#endif
   }
 }
 
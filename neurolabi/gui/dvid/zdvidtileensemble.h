@@ -2,6 +2,12 @@
 #define ZDVIDTILEENSEMBLE_H
 
 #include <vector>
+#include <map>
+#include <QList>
+#include <QMutex>
+#include <QFuture>
+#include <QAtomicInt>
+#include <QElapsedTimer>
 
 #include "libdvidheader.h"
 #include "zstackobject.h"
@@ -12,6 +18,17 @@
 
 class ZStackView;
 
+/*!
+ * \brief The class of grayscale tiles streamed from DVID
+ *
+ * With libdvidcpp enabled, tiles are requested in the background: the coarse
+ * tiles covering the viewport are fetched first so that the view can be
+ * painted right away, followed by the tiles of the requested resolution and
+ * a prefetch of the neighboring slices and of the tiles in the pan direction.
+ * The view is repainted whenever a batch of tiles is decoded. A request is
+ * canceled as soon as the viewport changes. Decoded tiles are kept in
+ * ZDvidTileCache, so revisiting a slice needs neither reading nor decoding.
+ */
 class ZDvidTileEnsemble : public ZStackObject
 {
 public:
@@ -45,7 +62,26 @@ public:
 
   void enhanceContrast(bool high);
 
+  /*!
+   * \brief Time from the latest viewport request to the first painted batch.
+   *
+   * Both latencies are in milliseconds and -1 if not available yet.
+   */
+  int getFirstPaintLatency() const;
+
+  /*!
+   * \brief Time from the latest viewport request to its last visible tile.
+   */
+  int getFrameLatency() const;
+
 public:
+  /*!
+   * \brief Request the tiles of a viewport.
+   *
+   * It returns immediately with libdvidcpp enabled, in which case the tiles
+   * are loaded in the background. It returns true iff all the tiles are ready
+   * to display.
+   */
   bool update(
       const std::vector<ZDvidTileInfo::TIndex>& tileIndices, int resLevel, int z);
   void updateContrast();
@@ -55,6 +91,42 @@ public:
                   int z, ZDvidTile *tile, libdvid::DVIDNodeService *service);
 #endif
 
+private:
+  ZDvidTile* findTile(int resLevel, const ZDvidTileInfo::TIndex &index) const;
+  bool isReady(const std::vector<ZDvidTileInfo::TIndex>& tileIndices,
+               int resLevel, int z) const;
+
+  /*!
+   * \brief Indices of the tiles \a levelDiff levels coarser than \a tileIndices
+   */
+  static std::vector<ZDvidTileInfo::TIndex> GetCoarseIndices(
+      const std::vector<ZDvidTileInfo::TIndex>& tileIndices, int levelDiff);
+
+  /*!
+   * \brief Cancel all background requests and wait for them to stop.
+   */
+  void cancelFetching();
+
+#if defined(_ENABLE_LIBDVIDCPP_)
+  //Tiles of the same level and the same slice to be fetched in one go
+  struct TileRequest {
+    TileRequest() : resLevel(0), z(0), decoding(true), visible(true) {}
+    int resLevel;
+    int z;
+    std::vector<ZDvidTile*> tileArray;
+    bool decoding; //false to decode the data into the tile cache only
+    bool visible; //true if the tiles belong to the current frame
+  };
+
+  void fetchTiles(QList<TileRequest> requestList, int generation,
+                  QElapsedTimer timer, bool highContrast);
+  bool isStale(int generation) const;
+  void requestRepaint();
+
+  libdvid::DVIDNodeService* acquireService();
+  void releaseService(libdvid::DVIDNodeService *service);
+#endif
+
 private:
   std::vector<std::map<ZDvidTileInfo::TIndex, ZDvidTile*> > m_tileGroup;
   ZDvidTileInfo m_tilingInfo;
@@ -62,9 +134,26 @@ private:
   ZDvidReader m_reader;
   ZStackView *m_view;
   bool m_highContrast;
+
+  //Latest request
+  std::vector<ZDvidTileInfo::TIndex> m_requestedIndices;
+  int m_requestedLevel;
+  int m_requestedZ;
+  QAtomicInt m_generation;
+  QList<QFuture<void> > m_futureList;
+
+  mutable QMutex m_latencyMutex;
+  int m_firstPaintLatency;
+  int m_frameLatency;
+
 #if defined(_ENABLE_LIBDVIDCPP_)
   std::vector<libdvid::DVIDNodeService*> m_serviceArray;
+  std::vector<libdvid::DVIDNodeService*> m_freeServiceArray;
+  QMutex m_serviceMutex;
 #endif
+
+  const static size_t m_fetchBatchSize;
+  const static int m_prefetchDepth;
 };
 
 #endif // ZDVIDTILEENSEMBLE_H
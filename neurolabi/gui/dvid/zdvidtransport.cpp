@@ -0,0 +1,302 @@
+#include "zdvidtransport.h"
+
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+
+#include <QNetworkAccessManager>
+#include <QMutexLocker>
+#include <QCoreApplication>
+#include <QThread>
+
+#include "zjsonarray.h"
+#include "dvid/libdvidheader.h"
+
+namespace {
+
+//Maximum number of idle services kept for each node
+const size_t MAX_IDLE_SERVICE_NUMBER = 8;
+
+}
+
+ZDvidRequestStat::ZDvidRequestStat() :
+  m_count(0), m_errorCount(0), m_byteCount(0), m_totalLatency(0.0),
+  m_maxLatency(0.0), m_latencyHistogram(LATENCY_BIN_NUMBER, 0)
+{
+}
+
+int ZDvidRequestStat::GetLatencyBin(double latency)
+{
+  int bin = 0;
+  double upperBound = 1.0;
+  while (latency > upperBound && bin < LATENCY_BIN_NUMBER - 1) {
+    upperBound *= 2.0;
+    ++bin;
+  }
+
+  return bin;
+}
+
+void ZDvidRequestStat::addRequest(
+    size_t byteCount, double latency, bool succeeded)
+{
+  ++m_count;
+  if (!succeeded) {
+    ++m_errorCount;
+  }
+  m_byteCount += byteCount;
+  m_totalLatency += latency;
+  if (latency > m_maxLatency) {
+    m_maxLatency = latency;
+  }
+  ++m_latencyHistogram[GetLatencyBin(latency)];
+}
+
+double ZDvidRequestStat::getMeanLatency() const
+{
+  if (m_count == 0) {
+    return 0.0;
+  }
+
+  return m_totalLatency / m_count;
+}
+
+double ZDvidRequestStat::getLatencyPercentile(double p) const
+{
+  if (m_count == 0) {
+    return 0.0;
+  }
+
+  int target = std::max(1, (int) std::ceil(p * m_count));
+  int accumulated = 0;
+  for (int i = 0; i < LATENCY_BIN_NUMBER - 1; ++i) {
+    accumulated += m_latencyHistogram[i];
+    if (accumulated >= target) {
+      return std::min(std::pow(2.0, i), m_maxLatency);
+    }
+  }
+
+  return m_maxLatency;
+}
+
+ZJsonObject ZDvidRequestStat::toJsonObject() const
+{
+  ZJsonObject obj;
+  obj.setEntry("count", m_count);
+  obj.setEntry("errors", m_errorCount);
+  obj.setEntry("bytes", (uint64_t) m_byteCount);
+  obj.setEntry("mean_latency", getMeanLatency());
+  obj.setEntry("max_latency", m_maxLatency);
+
+  ZJsonArray histogram;
+  for (std::vector<int>::const_iterator iter = m_latencyHistogram.begin();
+       iter != m_latencyHistogram.end(); ++iter) {
+    histogram.append(*iter);
+  }
+  obj.setEntry("latency_histogram", histogram);
+
+  return obj;
+}
+
+/////////////////////////////////////////
+
+ZDvidTransport::ZDvidTransport()
+{
+}
+
+ZDvidTransport& ZDvidTransport::getInstance()
+{
+  static ZDvidTransport transport;
+
+  return transport;
+}
+
+QNetworkAccessManager* ZDvidTransport::getNetworkManager()
+{
+  QPointer<QNetworkAccessManager> &manager = m_networkManager.localData();
+  if (manager.isNull()) {
+    QNetworkAccessManager *newManager = new QNetworkAccessManager;
+    QThread *thread = QThread::currentThread();
+    QCoreApplication *app = QCoreApplication::instance();
+    if (app != NULL && thread == app->thread()) {
+      newManager->setParent(app);
+    } else {
+      QObject::connect(thread, SIGNAL(finished()),
+                       newManager, SLOT(deleteLater()));
+    }
+    manager = newManager;
+  }
+
+  return manager.data();
+}
+
+#if defined(_ENABLE_LIBDVIDCPP_)
+ZSharedPointer<libdvid::DVIDNodeService> ZDvidTransport::takeService(
+    const std::string &address, const std::string &uuid)
+{
+  std::string key = address + "/" + uuid;
+
+  {
+    QMutexLocker locker(&m_serviceMutex);
+    std::vector<ZSharedPointer<libdvid::DVIDNodeService> > &pool =
+        m_servicePool[key];
+    if (!pool.empty()) {
+      ZSharedPointer<libdvid::DVIDNodeService> service = pool.back();
+      pool.pop_back();
+      return service;
+    }
+  }
+
+  ZSharedPointer<libdvid::DVIDNodeService> service;
+  try {
+    service = ZSharedPointer<libdvid::DVIDNodeService>(
+          new libdvid::DVIDNodeService(address, uuid));
+  } catch (std::exception &e) {
+    std::cout << e.what() << std::endl;
+    service.reset();
+  }
+
+  return service;
+}
+
+void ZDvidTransport::returnService(
+    const std::string &address, const std::string &uuid,
+    const ZSharedPointer<libdvid::DVIDNodeService> &service)
+{
+  if (service.get() != NULL) {
+    QMutexLocker locker(&m_serviceMutex);
+    std::vector<ZSharedPointer<libdvid::DVIDNodeService> > &pool =
+        m_servicePool[address + "/" + uuid];
+    if (pool.size() < MAX_IDLE_SERVICE_NUMBER) {
+      pool.push_back(service);
+    }
+  }
+}
+#endif
+
+std::string ZDvidTransport::GetEndpoint(const std::string &url)
+{
+  std::string path = url;
+
+  std::string::size_type pos = path.find("://");
+  if (pos != std::string::npos) {
+    pos = path.find('/', pos + 3);
+    path = (pos == std::string::npos) ? "" : path.substr(pos + 1);
+  }
+
+  pos = path.find('?');
+  if (pos != std::string::npos) {
+    path = path.substr(0, pos);
+  }
+
+  std::string nodeMarker = "api/node/";
+  pos = path.find(nodeMarker);
+  if (pos != std::string::npos) {
+    //Skip the uuid
+    pos = path.find('/', pos + nodeMarker.size());
+    path = (pos == std::string::npos) ? "" : path.substr(pos + 1);
+  } else {
+    std::string apiMarker = "api/";
+    pos = path.find(apiMarker);
+    if (pos != std::string::npos) {
+      path = path.substr(pos + apiMarker.size());
+    }
+  }
+
+  //Keep the first two components
+  pos = path.find('/');
+  if (pos != std::string::npos) {
+    pos = path.find('/', pos + 1);
+    if (pos != std::string::npos) {
+      path = path.substr(0, pos);
+    }
+  }
+
+  return path;
+}
+
+void ZDvidTransport::recordRequest(
+    const std::string &url, size_t byteCount, double latency, bool succeeded)
+{
+  std::string endpoint = GetEndpoint(url);
+
+  QMutexLocker locker(&m_statMutex);
+  m_statMap[endpoint].addRequest(byteCount, latency, succeeded);
+}
+
+void ZDvidTransport::resetMetrics()
+{
+  QMutexLocker locker(&m_statMutex);
+  m_statMap.clear();
+}
+
+ZDvidRequestStat ZDvidTransport::getRequestStat(
+    const std::string &endpoint) const
+{
+  QMutexLocker locker(&m_statMutex);
+  std::map<std::string, ZDvidRequestStat>::const_iterator iter =
+      m_statMap.find(endpoint);
+  if (iter != m_statMap.end()) {
+    return iter->second;
+  }
+
+  return ZDvidRequestStat();
+}
+
+std::vector<std::string> ZDvidTransport::getEndpointList() const
+{
+  QMutexLocker locker(&m_statMutex);
+  std::vector<std::string> endpointList;
+  for (std::map<std::string, ZDvidRequestStat>::const_iterator
+       iter = m_statMap.begin(); iter != m_statMap.end(); ++iter) {
+    endpointList.push_back(iter->first);
+  }
+
+  return endpointList;
+}
+
+ZJsonObject ZDvidTransport::getMetricsJson() const
+{
+  QMutexLocker locker(&m_statMutex);
+  ZJsonObject obj;
+  for (std::map<std::string, ZDvidRequestStat>::const_iterator
+       iter = m_statMap.begin(); iter != m_statMap.end(); ++iter) {
+    ZJsonObject statObj = iter->second.toJsonObject();
+    obj.setEntry(iter->first.c_str(), statObj);
+  }
+
+  return obj;
+}
+
+std::string ZDvidTransport::getMetricsReport() const
+{
+  QMutexLocker locker(&m_statMutex);
+
+  std::ostringstream stream;
+  stream << std::left << std::setw(32) << "Endpoint" << std::right
+         << std::setw(8) << "Count" << std::setw(8) << "Errors"
+         << std::setw(14) << "Bytes" << std::setw(10) << "Mean(ms)"
+         << std::setw(10) << "P50(ms)" << std::setw(10) << "P95(ms)"
+         << std::setw(10) << "Max(ms)" << std::endl;
+  stream << std::fixed << std::setprecision(1);
+  for (std::map<std::string, ZDvidRequestStat>::const_iterator
+       iter = m_statMap.begin(); iter != m_statMap.end(); ++iter) {
+    const ZDvidRequestStat &stat = iter->second;
+    stream << std::left << std::setw(32) << iter->first << std::right
+           << std::setw(8) << stat.getCount()
+           << std::setw(8) << stat.getErrorCount()
+           << std::setw(14) << stat.getByteCount()
+           << std::setw(10) << stat.getMeanLatency()
+           << std::setw(10) << stat.getLatencyPercentile(0.5)
+           << std::setw(10) << stat.getLatencyPercentile(0.95)
+           << std::setw(10) << stat.getMaxLatency() << std::endl;
+  }
+
+  return stream.str();
+}
+
+bool ZDvidTransport::dumpMetrics(const std::string &filePath) const
+{
+  return getMetricsJson().dump(filePath);
+}
@@ -0,0 +1,159 @@
+#ifndef ZDVIDTRANSPORT_H
+#define ZDVIDTRANSPORT_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include <QMutex>
+#include <QThreadStorage>
+#include <QPointer>
+#include <QNetworkAccessManager>
+
+#include "zsharedpointer.h"
+#include "zjsonobject.h"
+
+namespace libdvid{
+class DVIDNodeService;
+}
+
+/*!
+ * \brief The class of accumulating statistics of DVID requests
+ */
+class ZDvidRequestStat
+{
+public:
+  ZDvidRequestStat();
+
+  enum { LATENCY_BIN_NUMBER = 16 };
+
+  /*!
+   * \brief Add a request.
+   *
+   * \param byteCount Number of bytes received.
+   * \param latency Latency in milliseconds.
+   * \param succeeded Whether the request succeeded.
+   */
+  void addRequest(size_t byteCount, double latency, bool succeeded);
+
+  inline int getCount() const { return m_count; }
+  inline int getErrorCount() const { return m_errorCount; }
+  inline size_t getByteCount() const { return m_byteCount; }
+  inline double getMaxLatency() const { return m_maxLatency; }
+  double getMeanLatency() const;
+
+  /*!
+   * \brief Latency histogram.
+   *
+   * The upper bound of the ith bin is 2^i ms. The last bin counts everything
+   * above.
+   */
+  inline const std::vector<int>& getLatencyHistogram() const {
+    return m_latencyHistogram;
+  }
+
+  /*!
+   * \brief Estimate a latency percentile from the histogram.
+   *
+   * \param p Percentile in [0, 1].
+   * \return Upper bound (ms) of the bin containing the percentile.
+   */
+  double getLatencyPercentile(double p) const;
+
+  ZJsonObject toJsonObject() const;
+
+  static int GetLatencyBin(double latency);
+
+private:
+  int m_count;
+  int m_errorCount;
+  size_t m_byteCount;
+  double m_totalLatency;
+  double m_maxLatency;
+  std::vector<int> m_latencyHistogram;
+};
+
+/*!
+ * \brief The class of sharing DVID connections among readers
+ *
+ * There is only one transport in a process, which is obtained by
+ * getInstance(). It keeps one network manager per thread so that HTTP
+ * connections stay alive across readers, pools libdvid node services, and
+ * records the count, size, latency and errors of requests for each endpoint.
+ * An endpoint is identified by the data name and the command of the request
+ * url, such as "grayscale/raw".
+ */
+class ZDvidTransport
+{
+public:
+  static ZDvidTransport& getInstance();
+
+  /*!
+   * \brief Network manager of the current thread.
+   *
+   * The manager is created on the first call in a thread. The manager of the
+   * main thread is owned by the application, and the manager of another
+   * thread is deleted when the thread finishes, so none of them outlives the
+   * application.
+   */
+  QNetworkAccessManager* getNetworkManager();
+
+#if defined(_ENABLE_LIBDVIDCPP_)
+  /*!
+   * \brief Take a node service from the pool.
+   *
+   * A new service is created if no idle one is available. The service is
+   * not shared with others until it is returned by returnService().
+   *
+   * \return A null pointer if the service cannot be created.
+   */
+  ZSharedPointer<libdvid::DVIDNodeService> takeService(
+      const std::string &address, const std::string &uuid);
+
+  void returnService(
+      const std::string &address, const std::string &uuid,
+      const ZSharedPointer<libdvid::DVIDNodeService> &service);
+#endif
+
+  void recordRequest(const std::string &url, size_t byteCount,
+                     double latency, bool succeeded);
+  void resetMetrics();
+
+  ZDvidRequestStat getRequestStat(const std::string &endpoint) const;
+  std::vector<std::string> getEndpointList() const;
+
+  ZJsonObject getMetricsJson() const;
+
+  /*!
+   * \brief A table of the metrics for reading.
+   */
+  std::string getMetricsReport() const;
+  bool dumpMetrics(const std::string &filePath) const;
+
+  /*!
+   * \brief Get the endpoint of a url.
+   *
+   * The endpoint of http://host:port/api/node/uuid/grayscale/raw/0_1/...
+   * is "grayscale/raw". For other urls, the first two components after api/
+   * are used.
+   */
+  static std::string GetEndpoint(const std::string &url);
+
+private:
+  ZDvidTransport();
+
+private:
+  //Not owned by the storage, which lives until the process exits
+  QThreadStorage<QPointer<QNetworkAccessManager> > m_networkManager;
+
+  mutable QMutex m_statMutex;
+  std::map<std::string, ZDvidRequestStat> m_statMap;
+
+#if defined(_ENABLE_LIBDVIDCPP_)
+  QMutex m_serviceMutex;
+  std::map<std::string, std::vector<ZSharedPointer<libdvid::DVIDNodeService> > >
+  m_servicePool;
+#endif
+};
+
+#endif // ZDVIDTRANSPORT_H
@@ -8,6 +8,7 @@
 const std::string ZDvidUrl::m_keyCommand = "key";
 const std::string ZDvidUrl::m_keysCommand = "keys";
 const std::string ZDvidUrl::m_keyRangeCommand = "keyrange";
+const std::string ZDvidUrl::m_keyRangeValueCommand = "keyrangevalues";
 const std::string ZDvidUrl::m_sparsevolCommand = "sparsevol";
 const std::string ZDvidUrl::m_coarseSparsevolCommand = "sparsevol-coarse";
 const std::string ZDvidUrl::m_infoCommand = "info";
@@ -345,6 +346,14 @@ std::string ZDvidUrl::getKeyRangeUrl(
   */
 }
 
+std::string ZDvidUrl::getKeyRangeValueUrl(
+    const std::string &name,
+    const std::string &key1, const std::string &key2) const
+{
+  return getDataUrl(name) + "/" + m_keyRangeValueCommand + "/" + key1 + "/" +
+      key2 + "?json=true";
+}
+
 std::string ZDvidUrl::getBodyAnnotationName() const
 {
   return ZDvidData::GetName(ZDvidData::ROLE_BODY_ANNOTATION,
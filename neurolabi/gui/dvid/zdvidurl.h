@@ -89,6 +89,14 @@ public:
   std::string getKeyRangeUrl(
       const std::string &name,
       const std::string &key1, const std::string &key2) const;
+  /*!
+   * \brief Url of reading the values of all keys in [\a key1, \a key2].
+   *
+   * The server returns a json object mapping each key to its value.
+   */
+  std::string getKeyRangeValueUrl(
+      const std::string &name,
+      const std::string &key1, const std::string &key2) const;
   std::string getAllKeyUrl(const std::string &name) const;
 
   std::string getBodyAnnotationUrl(const std::string &bodyLabelName) const;
@@ -213,6 +221,7 @@ private:
   static const std::string m_keyCommand;
   static const std::string m_keysCommand;
   static const std::string m_keyRangeCommand;
+  static const std::string m_keyRangeValueCommand;
   static const std::string m_infoCommand;
   static const std::string m_sparsevolCommand;
   static const std::string m_coarseSparsevolCommand;
@@ -20,11 +20,18 @@ ZDvidTileDecodeTask::ZDvidTileDecodeTask(QObject *parent, ZDvidTile *tile) :
   m_data = NULL;
   m_length = 0;
   m_highContrast = false;
+  m_cachingOnly = false;
 }
 
 void ZDvidTileDecodeTask::execute()
 {
-  ProcessDataForDisplay(m_data, m_length, m_z, m_highContrast, m_tile);
+  if (m_cachingOnly) {
+    if (m_tile != NULL && m_data != NULL) {
+      m_tile->cacheDvidSlice(m_data, m_length, m_z);
+    }
+  } else {
+    ProcessDataForDisplay(m_data, m_length, m_z, m_highContrast, m_tile);
+  }
 }
 
 void ZDvidTileDecodeTask::ProcessDataForDisplay(
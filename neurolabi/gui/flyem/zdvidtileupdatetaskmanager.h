@@ -35,6 +35,13 @@ public:
     m_highContrast = state;
   }
 
+  /*!
+   * \brief Decode the data into the tile cache without updating the tile.
+   */
+  void setCachingOnly(bool state) {
+    m_cachingOnly = state;
+  }
+
   static void ProcessDataForDisplay(
       const uint8_t *data, int length, int z, bool highContrast, ZDvidTile *tile);
   static void ExecuteTask(ZDvidTileDecodeTask *task);
@@ -45,6 +52,7 @@ private:
   int m_length;
   int m_z;
   bool m_highContrast;
+  bool m_cachingOnly;
 };
 
 
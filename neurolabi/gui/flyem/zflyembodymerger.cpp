@@ -1,5 +1,6 @@
 #include "zflyembodymerger.h"
 #include <iostream>
+#include <algorithm>
 #include <QList>
 #include <QDebug>
 
@@ -14,7 +15,115 @@ ZFlyEmBodyMerger::ZFlyEmBodyMerger()
 
 uint64_t ZFlyEmBodyMerger::getFinalLabel(uint64_t label) const
 {
-  return mapLabel(m_mapList, label);
+  if (!m_parent.contains(label)) {
+    return label;
+  }
+
+  return m_rootLabel.value(findRoot(label));
+}
+
+uint64_t ZFlyEmBodyMerger::findRoot(uint64_t label) const
+{
+  uint64_t root = label;
+  for (uint64_t parent = m_parent.value(root); parent != root;
+       parent = m_parent.value(root)) {
+    root = parent;
+  }
+
+  //Path compression
+  while (label != root) {
+    uint64_t parent = m_parent.value(label);
+    m_parent[label] = root;
+    label = parent;
+  }
+
+  return root;
+}
+
+uint64_t ZFlyEmBodyMerger::addLabel(uint64_t label)
+{
+  m_parent[label] = label;
+  m_member[label].append(label);
+  setRootLabel(label, label);
+
+  return label;
+}
+
+void ZFlyEmBodyMerger::setRootLabel(uint64_t root, uint64_t label)
+{
+  m_rootLabel[root] = label;
+  m_labelRoot[label] = root;
+}
+
+uint64_t ZFlyEmBodyMerger::unionRoot(uint64_t root1, uint64_t root2)
+{
+  if (root1 == root2) {
+    return root1;
+  }
+
+  //The larger set absorbs the smaller one
+  if (m_member[root1].size() < m_member[root2].size()) {
+    std::swap(root1, root2);
+  }
+  m_parent[root2] = root1;
+  m_member[root1].append(m_member.take(root2));
+  m_rootLabel.remove(root2);
+
+  return root1;
+}
+
+void ZFlyEmBodyMerger::applyMap(const TLabelMap &labelMap)
+{
+  //All entries of a map are applied at the same time, so the sets are
+  //taken out of their current labels before any of them is relabeled.
+  QList<uint64_t> sourceRootList;
+  QList<uint64_t> targetLabelList;
+  for (TLabelMap::const_iterator iter = labelMap.begin();
+       iter != labelMap.end(); ++iter) {
+    uint64_t label = iter.key();
+    if (label == iter.value()) {
+      continue;
+    }
+
+    if (m_labelRoot.contains(label)) {
+      sourceRootList.append(m_labelRoot[label]);
+    } else if (!m_parent.contains(label)) {
+      sourceRootList.append(addLabel(label));
+    } else {
+      //No set has the label any more
+      continue;
+    }
+    targetLabelList.append(iter.value());
+  }
+
+  for (QList<uint64_t>::const_iterator iter = sourceRootList.begin();
+       iter != sourceRootList.end(); ++iter) {
+    m_labelRoot.remove(m_rootLabel.take(*iter));
+  }
+
+  for (int i = 0; i < sourceRootList.size(); ++i) {
+    uint64_t root = sourceRootList[i];
+    uint64_t label = targetLabelList[i];
+    if (m_labelRoot.contains(label)) {
+      root = unionRoot(root, m_labelRoot[label]);
+    } else if (!m_parent.contains(label)) {
+      root = unionRoot(root, addLabel(label));
+    }
+    setRootLabel(root, label);
+  }
+}
+
+void ZFlyEmBodyMerger::rebuildLabelSet()
+{
+  m_parent.clear();
+  m_rootLabel.clear();
+  m_labelRoot.clear();
+  m_member.clear();
+
+  for (TLabelMapList::const_iterator iter = m_mapList.begin();
+       iter != m_mapList.end(); ++iter) {
+    applyMap(*iter);
+  }
 }
 
 std::set<uint64_t> ZFlyEmBodyMerger::getFinalLabel(
@@ -60,28 +169,6 @@ ZFlyEmBodyMerger::TLabelMap ZFlyEmBodyMerger::getFinalMap() const
   return labelMap;
 }
 
-uint64_t ZFlyEmBodyMerger::mapLabel(const TLabelMap &labelMap, uint64_t label)
-{
-  if (labelMap.contains(label)) {
-    return labelMap[label];
-  }
-
-  return label;
-}
-
-uint64_t ZFlyEmBodyMerger::mapLabel(
-    const TLabelMapList &labelMap, uint64_t label)
-{
-  uint64_t finalLabel = label;
-  for (TLabelMapList::const_iterator iter = labelMap.begin();
-       iter != labelMap.end(); ++iter) {
-    const TLabelMap &currentLabelMap = *iter;
-    finalLabel = mapLabel(currentLabelMap, finalLabel);
-  }
-
-  return finalLabel;
-}
-
 void ZFlyEmBodyMerger::pushMap(uint64_t label1, uint64_t label2)
 {
   TLabelMap labelMap;
@@ -93,6 +180,7 @@ void ZFlyEmBodyMerger::pushMap(const TLabelMap &map)
 {
   if (!map.isEmpty()) {
     m_mapList.append(map);
+    applyMap(map);
   }
 }
 
@@ -126,6 +214,7 @@ ZFlyEmBodyMerger::TLabelMap ZFlyEmBodyMerger::undo()
   if (!m_mapList.isEmpty()) {
     labelMap = m_mapList.takeLast();
     m_undoneMapStack.push(labelMap);
+    rebuildLabelSet();
   }
 
   return labelMap;
@@ -158,24 +247,12 @@ void ZFlyEmBodyMerger::clear()
 {
   m_mapList.clear();
   m_undoneMapStack.clear();
+  rebuildLabelSet();
 }
 
 bool ZFlyEmBodyMerger::isMerged(uint64_t label) const
 {
-  QSet<uint64_t> labelSet;
-  for (TLabelMapList::const_iterator iter = m_mapList.begin();
-       iter != m_mapList.end(); ++iter) {
-    const TLabelMap &currentLabelMap = *iter;
-//    std::cout << "--" << index << "--" << std::endl;
-    for (TLabelMap::const_iterator mapIter = currentLabelMap.begin();
-         mapIter != currentLabelMap.end(); ++mapIter) {
-      labelSet.insert(mapIter.key());
-      labelSet.insert(mapIter.value());
-//      std::cout << mapIter.key() << " -> " << mapIter.value() << std::endl;
-    }
-  }
-
-  return labelSet.contains(label);
+  return m_parent.contains(label);
 }
 
 //ZJsonObject ZFlyEmBodyMerger::toJsonObject() const
@@ -226,7 +303,12 @@ void ZFlyEmBodyMerger::decodeJsonString(const std::string &str)
 
 QList<uint64_t> ZFlyEmBodyMerger::getOriginalLabelList(uint64_t finalLabel) const
 {
-  QList<uint64_t> list = getFinalMap().keys(finalLabel);
+  QList<uint64_t> list;
+  if (m_labelRoot.contains(finalLabel)) {
+    list = m_member.value(m_labelRoot.value(finalLabel));
+    list.removeAll(finalLabel);
+    std::sort(list.begin(), list.end());
+  }
   list.append(finalLabel);
 
 #ifdef _DEBUG_
@@ -7,6 +7,7 @@
 #include <QList>
 #include <QStack>
 #include <QSet>
+#include <QHash>
 #include <set>
 
 #include "tz_stdint.h"
@@ -18,6 +19,13 @@ class ZJsonArray;
  * \brief The ZFlyEmBodyMerger class
  *
  * label 0 is treated as null.
+ *
+ * The merge history is a list of label maps applied in order. The result of
+ * the history is kept in a union-find structure over the labels that appear
+ * in any map, in which each set carries its current label. Final labels are
+ * looked up with path compression and original labels are read from the
+ * member list of each set, so neither depends on the length of the history.
+ * undo() rebuilds the structure from the remaining history.
  */
 class ZFlyEmBodyMerger
 {
@@ -64,12 +72,24 @@ public:
   bool isEmpty() const;
 
 private:
-  static uint64_t mapLabel(const TLabelMap &labelMap, uint64_t label);
-  static uint64_t mapLabel(const TLabelMapList &labelMap, uint64_t label);
+  void applyMap(const TLabelMap &labelMap);
+  void rebuildLabelSet();
+  uint64_t addLabel(uint64_t label);
+  uint64_t findRoot(uint64_t label) const;
+  uint64_t unionRoot(uint64_t root1, uint64_t root2);
+  void setRootLabel(uint64_t root, uint64_t label);
 
 private:
   TLabelMapList m_mapList;
   TLabelMapStack m_undoneMapStack;
+
+  //Union-find forest of the labels in the history
+  mutable QHash<uint64_t, uint64_t> m_parent;
+  //Current label of each set and the set of each current label
+  QHash<uint64_t, uint64_t> m_rootLabel;
+  QHash<uint64_t, uint64_t> m_labelRoot;
+  //Original labels in each set
+  QHash<uint64_t, QList<uint64_t> > m_member;
 };
 
 template <typename InputIterator>
@@ -3,6 +3,7 @@
 #include "zjsonobject.h"
 #include "zjsonarray.h"
 #include "zjsonparser.h"
+#include "zjsonstreamreader.h"
 #include "zstring.h"
 #include "flyem/zflyemcoordinateconverter.h"
 #include "flyem/zflyemdatainfo.h"
@@ -18,53 +19,82 @@ void ZFlyEmBookmarkArray::importJsonFile(
 {
   clear();
 
-  ZJsonObject obj;
-  obj.load(filePath);
+  ZJsonStreamReader reader;
+  if (!reader.open(filePath)) {
+    std::cout << reader.getErrorMessage() << std::endl;
+    return;
+  }
 
   /*
   ZFlyEmCoordinateConverter converter;
   ZFlyEmDataInfo dataInfo(FlyEm::DATA_FIB25_7C);
   converter.configure(dataInfo);
 */
-  ZJsonArray bookmarkArrayObj(obj["data"], false);
-  for (size_t i = 0; i < bookmarkArrayObj.size(); ++i) {
-    ZJsonObject bookmarkObj(bookmarkArrayObj.at(i), false);
-    ZString text = ZJsonParser::stringValue(bookmarkObj["text"]);
-    text.toLower();
-    if (bookmarkObj["location"] != NULL) {
-      ZJsonValue idJson = bookmarkObj.value("body ID");
-      int64_t bodyId = 0;
-      if (idJson.isInteger()) {
-        bodyId = ZJsonParser::integerValue(idJson.getData());
-      } else if (idJson.isString()) {
-        bodyId = ZString::firstInteger(ZJsonParser::stringValue(idJson.getData()));
+  if (reader.next() != ZJsonStreamReader::TOKEN_START_OBJECT) {
+    return;
+  }
+
+  //Bookmarks are read one by one from the "data" array
+  while (reader.next() == ZJsonStreamReader::TOKEN_KEY) {
+    if (reader.getString() != "data" ||
+        reader.peek() != ZJsonStreamReader::TOKEN_START_ARRAY) {
+      reader.skipValue();
+      continue;
+    }
+
+    reader.next();
+    while (reader.hasNextElement()) {
+      ZJsonValue bookmarkValue = reader.readValue();
+      if (bookmarkValue.isObject()) {
+        importJsonObject(ZJsonObject(bookmarkValue.getData(), false),
+                         converter);
       }
+    }
+  }
 
-      if (bodyId > 0) {
-        std::vector<int> coordinates =
-            ZJsonParser::integerArray(bookmarkObj["location"]);
-
-        if (coordinates.size() == 3) {
-          ZFlyEmBookmark bookmark;
-          double x = coordinates[0];
-          double y = coordinates[1];
-          double z = coordinates[2];
-          if (converter != NULL) {
-            converter->convert(
-                  &x, &y, &z, ZFlyEmCoordinateConverter::RAVELER_SPACE,
-                  ZFlyEmCoordinateConverter::IMAGE_SPACE);
-          }
-          bookmark.setLocation(iround(x), iround(y), iround(z));
-          bookmark.setBodyId(bodyId);
-          if (text.startsWith("split") || text.startsWith("small split")) {
-            bookmark.setBookmarkType(ZFlyEmBookmark::TYPE_FALSE_MERGE);
-          } else if (text.startsWith("merge")) {
-            bookmark.setBookmarkType(ZFlyEmBookmark::TYPE_FALSE_SPLIT);
-          } else {
-            bookmark.setBookmarkType(ZFlyEmBookmark::TYPE_LOCATION);
-          }
-          append(bookmark);
+  if (reader.hasError()) {
+    std::cout << filePath << ": " << reader.getErrorMessage() << std::endl;
+  }
+}
+
+void ZFlyEmBookmarkArray::importJsonObject(
+    const ZJsonObject &bookmarkObj, const ZFlyEmCoordinateConverter *converter)
+{
+  ZString text = ZJsonParser::stringValue(bookmarkObj["text"]);
+  text.toLower();
+  if (bookmarkObj["location"] != NULL) {
+    ZJsonValue idJson = bookmarkObj.value("body ID");
+    int64_t bodyId = 0;
+    if (idJson.isInteger()) {
+      bodyId = ZJsonParser::integerValue(idJson.getData());
+    } else if (idJson.isString()) {
+      bodyId = ZString::firstInteger(ZJsonParser::stringValue(idJson.getData()));
+    }
+
+    if (bodyId > 0) {
+      std::vector<int> coordinates =
+          ZJsonParser::integerArray(bookmarkObj["location"]);
+
+      if (coordinates.size() == 3) {
+        ZFlyEmBookmark bookmark;
+        double x = coordinates[0];
+        double y = coordinates[1];
+        double z = coordinates[2];
+        if (converter != NULL) {
+          converter->convert(
+                &x, &y, &z, ZFlyEmCoordinateConverter::RAVELER_SPACE,
+                ZFlyEmCoordinateConverter::IMAGE_SPACE);
+        }
+        bookmark.setLocation(iround(x), iround(y), iround(z));
+        bookmark.setBodyId(bodyId);
+        if (text.startsWith("split") || text.startsWith("small split")) {
+          bookmark.setBookmarkType(ZFlyEmBookmark::TYPE_FALSE_MERGE);
+        } else if (text.startsWith("merge")) {
+          bookmark.setBookmarkType(ZFlyEmBookmark::TYPE_FALSE_SPLIT);
+        } else {
+          bookmark.setBookmarkType(ZFlyEmBookmark::TYPE_LOCATION);
         }
+        append(bookmark);
       }
     }
   }
@@ -7,6 +7,7 @@
 
 class ZFlyEmCoordinateConverter;
 class ZPunctum;
+class ZJsonObject;
 
 class ZFlyEmBookmarkArray : public QVector<ZFlyEmBookmark>
 {
@@ -28,6 +29,10 @@ public:
   template <class InputIterator>
   static ZFlyEmBookmark* findFirstBookmark(
       InputIterator first, InputIterator last, const QString &key);
+
+private:
+  void importJsonObject(const ZJsonObject &bookmarkObj,
+                        const ZFlyEmCoordinateConverter *converter);
 };
 
 template <class InputIterator>
@@ -0,0 +1,350 @@
+#include "zflyemconnectivitymatrix.h"
+
+#include <algorithm>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_QT_GUI_USED_)
+#include <QFuture>
+#include <QThread>
+#include <QtConcurrentRun>
+#endif
+
+#include "zflyembodymerger.h"
+#include "zsynapseannotationarray.h"
+#include "zsynapsestore.h"
+
+namespace {
+
+const char ConnectivityMatrixMagic[4] = { 'Z', 'C', 'M', 'X' };
+const uint32_t ConnectivityMatrixVersion = 1;
+
+/* Below this number of synapses the matrix is built in the calling thread */
+const size_t ConnectivityMatrixMultiThreadThreshold = 10000;
+
+struct ConnectionTask {
+  const FlyEm::ZSynapseStore *store;
+  //Matrix index of each body in the body index of the store; -1 if ignored
+  const std::vector<int> *bodyIndexMap;
+  size_t bodyNumber;
+  size_t synapseStart;
+  size_t synapseEnd;
+  bool excludingSelfConnection;
+  //Sorted (row * bodyNumber + column, count) pairs
+  std::vector<std::pair<uint64_t, uint32_t> > result;
+};
+
+int GetMatrixIndex(const FlyEm::ZSynapseStore &store,
+                   const std::vector<int> &bodyIndexMap, int bodyId)
+{
+  const std::vector<int> &bodyIdArray = store.getBodyIdArray();
+  std::vector<int>::const_iterator iter =
+      std::lower_bound(bodyIdArray.begin(), bodyIdArray.end(), bodyId);
+
+  return bodyIndexMap[iter - bodyIdArray.begin()];
+}
+
+void CountConnection(ConnectionTask *task)
+{
+  const FlyEm::ZSynapseStore &store = *(task->store);
+
+  std::vector<uint64_t> keyArray;
+  keyArray.reserve(store.getSynapseStart(task->synapseEnd) -
+                   store.getSynapseStart(task->synapseStart));
+  for (size_t i = task->synapseStart; i < task->synapseEnd; ++i) {
+    size_t tbar = store.getSynapseStart(i);
+    int row = GetMatrixIndex(store, *(task->bodyIndexMap),
+                             store.getBodyId(tbar));
+    if (row < 0) {
+      continue;
+    }
+    size_t synapseEnd = store.getSynapseEnd(i);
+    for (size_t psd = tbar + 1; psd < synapseEnd; ++psd) {
+      int column = GetMatrixIndex(store, *(task->bodyIndexMap),
+                                  store.getBodyId(psd));
+      if (column >= 0 && !(task->excludingSelfConnection && row == column)) {
+        keyArray.push_back((uint64_t) row * task->bodyNumber + column);
+      }
+    }
+  }
+
+  std::sort(keyArray.begin(), keyArray.end());
+  for (size_t i = 0; i < keyArray.size(); ++i) {
+    if (i == 0 || keyArray[i] != keyArray[i - 1]) {
+      task->result.push_back(std::pair<uint64_t, uint32_t>(keyArray[i], 0));
+    }
+    ++task->result.back().second;
+  }
+}
+
+}
+
+ZFlyEmConnectivityMatrix::ZFlyEmConnectivityMatrix() :
+  m_threadNumber(0), m_excludingSelfConnection(true)
+{
+}
+
+void ZFlyEmConnectivityMatrix::clear()
+{
+  m_bodyIdArray.clear();
+  m_rowOffset.clear();
+  m_columnArray.clear();
+  m_weightArray.clear();
+}
+
+void ZFlyEmConnectivityMatrix::setThreadNumber(int n)
+{
+  m_threadNumber = std::max(0, n);
+}
+
+void ZFlyEmConnectivityMatrix::setExcludingSelfConnection(bool excluding)
+{
+  m_excludingSelfConnection = excluding;
+}
+
+void ZFlyEmConnectivityMatrix::build(
+    const FlyEm::ZSynapseAnnotationArray &synapseArray,
+    const ZFlyEmBodyMerger *merger)
+{
+  build(synapseArray.getSynapseStore(), merger);
+}
+
+void ZFlyEmConnectivityMatrix::build(
+    const FlyEm::ZSynapseStore &store, const ZFlyEmBodyMerger *merger)
+{
+  clear();
+
+  //Map each body of the store to its final body only once
+  const std::vector<int> &storeBodyIdArray = store.getBodyIdArray();
+  std::vector<uint64_t> finalBodyIdArray(storeBodyIdArray.size(), 0);
+  for (size_t i = 0; i < storeBodyIdArray.size(); ++i) {
+    if (storeBodyIdArray[i] > 0) {
+      finalBodyIdArray[i] = storeBodyIdArray[i];
+      if (merger != NULL) {
+        finalBodyIdArray[i] = merger->getFinalLabel(finalBodyIdArray[i]);
+      }
+    }
+  }
+
+  for (size_t i = 0; i < finalBodyIdArray.size(); ++i) {
+    if (finalBodyIdArray[i] > 0) {
+      m_bodyIdArray.push_back(finalBodyIdArray[i]);
+    }
+  }
+  std::sort(m_bodyIdArray.begin(), m_bodyIdArray.end());
+  m_bodyIdArray.erase(std::unique(m_bodyIdArray.begin(), m_bodyIdArray.end()),
+                      m_bodyIdArray.end());
+
+  std::vector<int> bodyIndexMap(finalBodyIdArray.size(), -1);
+  for (size_t i = 0; i < finalBodyIdArray.size(); ++i) {
+    if (finalBodyIdArray[i] > 0) {
+      bodyIndexMap[i] = getBodyIndex(finalBodyIdArray[i]);
+    }
+  }
+
+  size_t synapseNumber = store.getSynapseNumber();
+  int taskNumber = 1;
+#if defined(_QT_GUI_USED_)
+  if (synapseNumber >= ConnectivityMatrixMultiThreadThreshold) {
+    taskNumber = m_threadNumber;
+    if (taskNumber == 0) {
+      taskNumber = std::max(1, QThread::idealThreadCount());
+    }
+  }
+#endif
+
+  std::vector<ConnectionTask> taskArray(taskNumber);
+  for (int i = 0; i < taskNumber; ++i) {
+    ConnectionTask &task = taskArray[i];
+    task.store = &store;
+    task.bodyIndexMap = &bodyIndexMap;
+    task.bodyNumber = m_bodyIdArray.size();
+    task.synapseStart = synapseNumber * i / taskNumber;
+    task.synapseEnd = synapseNumber * (i + 1) / taskNumber;
+    task.excludingSelfConnection = m_excludingSelfConnection;
+  }
+
+#if defined(_QT_GUI_USED_)
+  if (taskNumber > 1) {
+    std::vector<QFuture<void> > res(taskNumber);
+    for (int i = 0; i < taskNumber; ++i) {
+      res[i] = QtConcurrent::run(&CountConnection, &(taskArray[i]));
+    }
+    for (int i = 0; i < taskNumber; ++i) {
+      res[i].waitForFinished();
+    }
+  } else {
+    CountConnection(&(taskArray[0]));
+  }
+#else
+  CountConnection(&(taskArray[0]));
+#endif
+
+  //Merge the sorted partial counts
+  std::vector<std::pair<uint64_t, uint32_t> > &entryArray = taskArray[0].result;
+  for (int i = 1; i < taskNumber; ++i) {
+    size_t middle = entryArray.size();
+    entryArray.insert(entryArray.end(), taskArray[i].result.begin(),
+                      taskArray[i].result.end());
+    std::vector<std::pair<uint64_t, uint32_t> >().swap(taskArray[i].result);
+    std::inplace_merge(entryArray.begin(), entryArray.begin() + middle,
+                       entryArray.end());
+  }
+
+  size_t bodyNumber = m_bodyIdArray.size();
+  m_rowOffset.assign(bodyNumber + 1, 0);
+  m_columnArray.reserve(entryArray.size());
+  m_weightArray.reserve(entryArray.size());
+  for (size_t i = 0; i < entryArray.size(); ++i) {
+    uint32_t column = entryArray[i].first % bodyNumber;
+    if (!m_columnArray.empty() &&
+        entryArray[i].first == entryArray[i - 1].first) {
+      m_weightArray.back() += entryArray[i].second;
+    } else {
+      m_columnArray.push_back(column);
+      m_weightArray.push_back(entryArray[i].second);
+      ++m_rowOffset[entryArray[i].first / bodyNumber + 1];
+    }
+  }
+  for (size_t i = 0; i < bodyNumber; ++i) {
+    m_rowOffset[i + 1] += m_rowOffset[i];
+  }
+}
+
+int ZFlyEmConnectivityMatrix::getBodyIndex(uint64_t bodyId) const
+{
+  std::vector<uint64_t>::const_iterator iter =
+      std::lower_bound(m_bodyIdArray.begin(), m_bodyIdArray.end(), bodyId);
+  if (iter == m_bodyIdArray.end() || *iter != bodyId) {
+    return -1;
+  }
+
+  return iter - m_bodyIdArray.begin();
+}
+
+int ZFlyEmConnectivityMatrix::getConnection(
+    uint64_t preBodyId, uint64_t postBodyId) const
+{
+  int row = getBodyIndex(preBodyId);
+  int column = getBodyIndex(postBodyId);
+  if (row < 0 || column < 0) {
+    return 0;
+  }
+
+  std::vector<uint32_t>::const_iterator begin =
+      m_columnArray.begin() + getRowStart(row);
+  std::vector<uint32_t>::const_iterator end =
+      m_columnArray.begin() + getRowEnd(row);
+  std::vector<uint32_t>::const_iterator iter =
+      std::lower_bound(begin, end, (uint32_t) column);
+  if (iter == end || *iter != (uint32_t) column) {
+    return 0;
+  }
+
+  return m_weightArray[iter - m_columnArray.begin()];
+}
+
+size_t ZFlyEmConnectivityMatrix::getConnectionNumber() const
+{
+  size_t count = 0;
+  for (size_t i = 0; i < m_weightArray.size(); ++i) {
+    count += m_weightArray[i];
+  }
+
+  return count;
+}
+
+bool ZFlyEmConnectivityMatrix::exportCsv(const std::string &filePath) const
+{
+  FILE *fp = fopen(filePath.c_str(), "w");
+  if (fp == NULL) {
+    return false;
+  }
+
+  for (size_t row = 0; row < getBodyNumber(); ++row) {
+    for (size_t k = getRowStart(row); k < getRowEnd(row); ++k) {
+      fprintf(fp, "%llu,%llu,%u\n", (unsigned long long) getBodyId(row),
+              (unsigned long long) getBodyId(getColumn(k)), getWeight(k));
+    }
+  }
+
+  return fclose(fp) == 0;
+}
+
+bool ZFlyEmConnectivityMatrix::exportBinary(const std::string &filePath) const
+{
+  std::ofstream stream(filePath.c_str(), std::ios::binary);
+  if (!stream.good()) {
+    return false;
+  }
+
+  uint64_t bodyNumber = getBodyNumber();
+  uint64_t nonzeroNumber = getNonzeroNumber();
+  stream.write(ConnectivityMatrixMagic, sizeof(ConnectivityMatrixMagic));
+  stream.write((const char*) &ConnectivityMatrixVersion,
+               sizeof(ConnectivityMatrixVersion));
+  stream.write((const char*) &bodyNumber, sizeof(bodyNumber));
+  stream.write((const char*) &nonzeroNumber, sizeof(nonzeroNumber));
+  if (bodyNumber > 0) {
+    stream.write((const char*) &(m_bodyIdArray[0]),
+                 sizeof(uint64_t) * bodyNumber);
+    stream.write((const char*) &(m_rowOffset[0]),
+                 sizeof(uint64_t) * (bodyNumber + 1));
+  }
+  if (nonzeroNumber > 0) {
+    stream.write((const char*) &(m_columnArray[0]),
+                 sizeof(uint32_t) * nonzeroNumber);
+    stream.write((const char*) &(m_weightArray[0]),
+                 sizeof(uint32_t) * nonzeroNumber);
+  }
+
+  return stream.good();
+}
+
+bool ZFlyEmConnectivityMatrix::importBinary(const std::string &filePath)
+{
+  clear();
+
+  std::ifstream stream(filePath.c_str(), std::ios::binary);
+  if (!stream.good()) {
+    return false;
+  }
+
+  char magic[4];
+  uint32_t version = 0;
+  uint64_t bodyNumber = 0;
+  uint64_t nonzeroNumber = 0;
+  stream.read(magic, sizeof(magic));
+  stream.read((char*) &version, sizeof(version));
+  stream.read((char*) &bodyNumber, sizeof(bodyNumber));
+  stream.read((char*) &nonzeroNumber, sizeof(nonzeroNumber));
+  if (!stream.good() ||
+      memcmp(magic, ConnectivityMatrixMagic, sizeof(magic)) != 0 ||
+      version != ConnectivityMatrixVersion) {
+    return false;
+  }
+
+  if (bodyNumber > 0) {
+    m_bodyIdArray.resize(bodyNumber);
+    m_rowOffset.resize(bodyNumber + 1);
+    stream.read((char*) &(m_bodyIdArray[0]), sizeof(uint64_t) * bodyNumber);
+    stream.read((char*) &(m_rowOffset[0]),
+                sizeof(uint64_t) * (bodyNumber + 1));
+  }
+  if (nonzeroNumber > 0) {
+    m_columnArray.resize(nonzeroNumber);
+    m_weightArray.resize(nonzeroNumber);
+    stream.read((char*) &(m_columnArray[0]), sizeof(uint32_t) * nonzeroNumber);
+    stream.read((char*) &(m_weightArray[0]), sizeof(uint32_t) * nonzeroNumber);
+  }
+
+  if (stream.fail() ||
+      (bodyNumber > 0 && m_rowOffset.back() != nonzeroNumber) ||
+      (bodyNumber == 0 && nonzeroNumber > 0)) {
+    clear();
+    return false;
+  }
+
+  return true;
+}
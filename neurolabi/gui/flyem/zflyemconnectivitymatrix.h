@@ -0,0 +1,123 @@
+#ifndef ZFLYEMCONNECTIVITYMATRIX_H
+#define ZFLYEMCONNECTIVITYMATRIX_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+#include "tz_stdint.h"
+
+class ZFlyEmBodyMerger;
+
+namespace FlyEm {
+class ZSynapseAnnotationArray;
+class ZSynapseStore;
+}
+
+/*!
+ * \brief The class of body-to-body connection counts
+ *
+ * The matrix is sparse and stored in the compressed row format. Row i is
+ * the presynaptic body getBodyId(i), and each nonzero element of the row is
+ * the number of PSDs on a postsynaptic body that are connected to T-bars
+ * on the row body. Bodies with a nonpositive ID are ignored.
+ *
+ * The synapses are counted by multiple threads. When a body merger is
+ * given, both ends of each connection are mapped to their final bodies, so
+ * the matrix can be regenerated after each round of proofreading without
+ * touching the synapse annotations.
+ */
+class ZFlyEmConnectivityMatrix
+{
+public:
+  ZFlyEmConnectivityMatrix();
+
+  void build(const FlyEm::ZSynapseAnnotationArray &synapseArray,
+             const ZFlyEmBodyMerger *merger = NULL);
+  void build(const FlyEm::ZSynapseStore &store,
+             const ZFlyEmBodyMerger *merger = NULL);
+
+  void clear();
+
+  /*!
+   * \brief Set the number of threads for building.
+   *
+   * The default value 0 means the ideal thread count of the machine.
+   */
+  void setThreadNumber(int n);
+
+  /*!
+   * \brief Set whether connections within the same body are ignored.
+   *
+   * It is true by default, which is consistent with
+   * ZSynapseAnnotationArray::getConnectionGraph().
+   */
+  void setExcludingSelfConnection(bool excluding);
+
+  inline size_t getBodyNumber() const { return m_bodyIdArray.size(); }
+  inline size_t getNonzeroNumber() const { return m_columnArray.size(); }
+
+  /*!
+   * \brief Sorted IDs of the bodies with any synapse location.
+   *
+   * The IDs are after mapping by the body merger.
+   */
+  inline const std::vector<uint64_t>& getBodyIdArray() const {
+    return m_bodyIdArray;
+  }
+  inline uint64_t getBodyId(size_t index) const {
+    return m_bodyIdArray[index];
+  }
+
+  /*!
+   * \brief Get the index of a body.
+   *
+   * \return -1 if the body is not in the matrix.
+   */
+  int getBodyIndex(uint64_t bodyId) const;
+
+  inline size_t getRowStart(size_t row) const { return m_rowOffset[row]; }
+  inline size_t getRowEnd(size_t row) const { return m_rowOffset[row + 1]; }
+  inline uint32_t getColumn(size_t k) const { return m_columnArray[k]; }
+  inline uint32_t getWeight(size_t k) const { return m_weightArray[k]; }
+
+  /*!
+   * \brief Number of connections from \a preBodyId to \a postBodyId.
+   */
+  int getConnection(uint64_t preBodyId, uint64_t postBodyId) const;
+
+  /*!
+   * \brief Total number of connections.
+   */
+  size_t getConnectionNumber() const;
+
+  /*!
+   * \brief Export the matrix as CSV.
+   *
+   * Each line is a nonzero element in the format of
+   * <presynaptic body>,<postsynaptic body>,<count>
+   */
+  bool exportCsv(const std::string &filePath) const;
+
+  /*!
+   * \brief Export the matrix in the binary CSR format.
+   *
+   * Layout (native byte order):
+   *   char[4] "ZCMX", uint32 version, uint64 body number N,
+   *   uint64 nonzero number M, uint64 body IDs[N], uint64 row offsets[N + 1],
+   *   uint32 columns[M], uint32 weights[M]
+   */
+  bool exportBinary(const std::string &filePath) const;
+  bool importBinary(const std::string &filePath);
+
+private:
+  std::vector<uint64_t> m_bodyIdArray;
+  std::vector<uint64_t> m_rowOffset;
+  std::vector<uint32_t> m_columnArray;
+  std::vector<uint32_t> m_weightArray;
+
+  int m_threadNumber;
+  bool m_excludingSelfConnection;
+};
+
+#endif // ZFLYEMCONNECTIVITYMATRIX_H
@@ -21,6 +21,7 @@
 #include "zintcuboidarray.h"
 #include "zfiletype.h"
 #include "flyem/zflyemneuroninfo.h"
+#include "flyem/zflyemconnectivitymatrix.h"
 #include "dvid/zdviddata.h"
 
 using namespace std;
@@ -46,7 +47,8 @@ const double ZFlyEmDataBundle::m_layerRatio[11] = {
   0.0, 0.1, 0.2, 0.3, 0.35, 0.43, 0.54, 0.66, 0.73, 0.91, 1.0};
 */
 ZFlyEmDataBundle::ZFlyEmDataBundle() : m_synapseScale(10.0),
-  m_boundBox(NULL), m_synaseAnnotation(NULL), m_colorMap(NULL)
+  m_boundBox(NULL), m_synaseAnnotation(NULL), m_colorMap(NULL),
+  m_isNeuronIndexDeprecated(true)
 {
   for (int k = 0; k < 3; ++k) {
     m_swcResolution[k] = 1.0;
@@ -69,6 +71,8 @@ bool ZFlyEmDataBundle::isDeprecated(EComponent comp) const
     return (m_synaseAnnotation == NULL);
   case COLOR_MAP:
     return (m_colorMap == NULL);
+  case NEURON_INDEX:
+    return m_isNeuronIndexDeprecated;
   default:
     break;
   }
@@ -89,9 +93,18 @@ void ZFlyEmDataBundle::deprecate(EComponent comp)
     delete m_colorMap;
     m_colorMap = NULL;
     break;
+  case NEURON_INDEX:
+  {
+    QMutexLocker locker(&m_neuronIndexMutex);
+    m_idIndex.clear();
+    m_nameIndex.clear();
+    m_isNeuronIndexDeprecated = true;
+  }
+    break;
   case ALL_COMPONENT:
     deprecate(SYNAPSE_ANNOTATION);
     deprecate(COLOR_MAP);
+    deprecate(NEURON_INDEX);
     break;
   default:
     break;
@@ -243,6 +256,8 @@ bool ZFlyEmDataBundle::loadDvid(const ZDvidFilter &dvidFilter)
     }
   }
   m_neuronArray.resize(realSize);
+  deprecate(NEURON_INDEX);
+  attachModelCache();
   updateNeuronConnection();
 
   return true;
@@ -377,6 +392,8 @@ bool ZFlyEmDataBundle::loadJsonFile(const std::string &filePath)
       }
     }
 
+    deprecate(NEURON_INDEX);
+    attachModelCache();
     updateNeuronConnection();
 
     return true;
@@ -487,15 +504,42 @@ void ZFlyEmDataBundle::print() const
   //cout << "Config: " << m_configFile << endl;
 }
 
+bool ZFlyEmDataBundle::updateNeuronIndex() const
+{
+  if (m_isNeuronIndexDeprecated) {
+    m_idIndex.clear();
+    m_nameIndex.clear();
+    m_idIndex.reserve(m_neuronArray.size());
+    m_nameIndex.reserve(m_neuronArray.size());
+    //Keep the first neuron for duplicated keys as the linear search did
+    for (size_t i = m_neuronArray.size(); i > 0; --i) {
+      const ZFlyEmNeuron &neuron = m_neuronArray[i - 1];
+      m_idIndex[neuron.getId()] = i - 1;
+      m_nameIndex[QString::fromStdString(neuron.getName())] = i - 1;
+    }
+    m_isNeuronIndexDeprecated = false;
+
+    return true;
+  }
+
+  return false;
+}
+
+void ZFlyEmDataBundle::attachModelCache()
+{
+  for (ZFlyEmNeuronArray::iterator iter = m_neuronArray.begin();
+       iter != m_neuronArray.end(); ++iter) {
+    iter->setModelCache(&m_modelCache);
+  }
+}
+
 string ZFlyEmDataBundle::getModelPath(int bodyId) const
 {
   string modelPath;
 
-  for (vector<ZFlyEmNeuron>::const_iterator iter = m_neuronArray.begin();
-       iter != m_neuronArray.end(); ++iter) {
-    if (iter->getId() == bodyId) {
-      modelPath = iter->getModelPath();
-    }
+  const ZFlyEmNeuron *neuron = getNeuron(bodyId);
+  if (neuron != NULL) {
+    modelPath = neuron->getModelPath();
   }
 
   return modelPath;
@@ -505,11 +549,9 @@ string ZFlyEmDataBundle::getName(int bodyId) const
 {
   string name;
 
-  for (vector<ZFlyEmNeuron>::const_iterator iter = m_neuronArray.begin();
-       iter != m_neuronArray.end(); ++iter) {
-    if (iter->getId() == bodyId) {
-      name = iter->getName();
-    }
+  const ZFlyEmNeuron *neuron = getNeuron(bodyId);
+  if (neuron != NULL) {
+    name = neuron->getName();
   }
 
   return name;
@@ -517,11 +559,9 @@ string ZFlyEmDataBundle::getName(int bodyId) const
 
 int ZFlyEmDataBundle::getIdFromName(const string &name) const
 {
-  for (vector<ZFlyEmNeuron>::const_iterator iter = m_neuronArray.begin();
-       iter != m_neuronArray.end(); ++iter) {
-    if (iter->getName() == name) {
-      return iter->getId();
-    }
+  const ZFlyEmNeuron *neuron = getNeuronFromName(name);
+  if (neuron != NULL) {
+    return neuron->getId();
   }
 
   return -1;
@@ -529,22 +569,31 @@ int ZFlyEmDataBundle::getIdFromName(const string &name) const
 
 bool ZFlyEmDataBundle::hasNeuronName(const string &name) const
 {
-  for (vector<ZFlyEmNeuron>::const_iterator iter = m_neuronArray.begin();
-       iter != m_neuronArray.end(); ++iter) {
-    if (iter->getName() == name) {
-      return true;
-    }
-  }
-
-  return false;
+  return getNeuronFromName(name) != NULL;
 }
+
 const ZFlyEmNeuron* ZFlyEmDataBundle::getNeuron(int bodyId) const
 {
-  for (vector<ZFlyEmNeuron>::const_iterator iter = m_neuronArray.begin();
-       iter != m_neuronArray.end(); ++iter) {
-    if (iter->getId() == bodyId) {
-      return &(*iter);
+  QMutexLocker locker(&m_neuronIndexMutex);
+
+  //The array may have been changed since the index was built, so the index
+  //is rebuilt once before reporting a miss
+  for (int trial = 0; trial < 2; ++trial) {
+    bool rebuilt = updateNeuronIndex();
+
+    QHash<int, size_t>::const_iterator iter = m_idIndex.find(bodyId);
+    if (iter != m_idIndex.end()) {
+      size_t index = iter.value();
+      if (index < m_neuronArray.size() &&
+          m_neuronArray[index].getId() == bodyId) {
+        return &(m_neuronArray[index]);
+      }
+    }
+
+    if (rebuilt) {
+      break;
     }
+    m_isNeuronIndexDeprecated = true;
   }
 
   return NULL;
@@ -558,11 +607,26 @@ ZFlyEmNeuron* ZFlyEmDataBundle::getNeuron(int bodyId)
 
 const ZFlyEmNeuron* ZFlyEmDataBundle::getNeuronFromName(const string &name) const
 {
-  for (vector<ZFlyEmNeuron>::const_iterator iter = m_neuronArray.begin();
-       iter != m_neuronArray.end(); ++iter) {
-    if (iter->getName() == name) {
-      return &(*iter);
+  QString key = QString::fromStdString(name);
+
+  QMutexLocker locker(&m_neuronIndexMutex);
+
+  for (int trial = 0; trial < 2; ++trial) {
+    bool rebuilt = updateNeuronIndex();
+
+    QHash<QString, size_t>::const_iterator iter = m_nameIndex.find(key);
+    if (iter != m_nameIndex.end()) {
+      size_t index = iter.value();
+      if (index < m_neuronArray.size() &&
+          m_neuronArray[index].getName() == name) {
+        return &(m_neuronArray[index]);
+      }
     }
+
+    if (rebuilt) {
+      break;
+    }
+    m_isNeuronIndexDeprecated = true;
   }
 
   return NULL;
@@ -642,17 +706,20 @@ void ZFlyEmDataBundle::updateNeuronConnection()
   }
 
   if (getSynapseAnnotation() != NULL) {
-    ZGraph *graph = getSynapseAnnotation()->getConnectionGraph();
-    for (int i = 0; i < graph->getEdgeNumber(); ++i) {
-      int inputId = graph->getEdgeBegin(i);
-      int outputId = graph->getEdgeEnd(i);
-      double weight = graph->getEdgeWeight(i);
-      ZFlyEmNeuron *inputNeuron = getNeuron(inputId);
+    ZFlyEmConnectivityMatrix matrix;
+    matrix.build(*getSynapseAnnotation());
+    for (size_t row = 0; row < matrix.getBodyNumber(); ++row) {
+      ZFlyEmNeuron *inputNeuron = getNeuron((int) matrix.getBodyId(row));
       if (inputNeuron != NULL) {
-        ZFlyEmNeuron *outputNeuron = getNeuron(outputId);
-        if (outputNeuron != NULL) {
-          inputNeuron->appendOutputNeuron(outputNeuron, weight);
-          outputNeuron->appendInputNeuron(inputNeuron, weight);
+        for (size_t k = matrix.getRowStart(row); k < matrix.getRowEnd(row);
+             ++k) {
+          ZFlyEmNeuron *outputNeuron =
+              getNeuron((int) matrix.getBodyId(matrix.getColumn(k)));
+          if (outputNeuron != NULL) {
+            double weight = matrix.getWeight(k);
+            inputNeuron->appendOutputNeuron(outputNeuron, weight);
+            outputNeuron->appendInputNeuron(inputNeuron, weight);
+          }
         }
       }
     }
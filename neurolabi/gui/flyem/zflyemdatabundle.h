@@ -2,6 +2,9 @@
 #define ZFLYEMDATABUNDLE_H
 
 #include <QColor>
+#include <QHash>
+#include <QMutex>
+#include <QString>
 #include <vector>
 #include <string>
 #include <map>
@@ -11,6 +14,7 @@
 #include "neutube.h"
 #include "zflyemneuronarray.h"
 #include "flyem/zflyemcoordinateconverter.h"
+#include "flyem/zflyemneuronmodelcache.h"
 
 class ZDvidFilter;
 class ZSwcTree;
@@ -22,7 +26,7 @@ public:
   ~ZFlyEmDataBundle();
 
   enum EComponent {
-    SYNAPSE_ANNOTATION, COLOR_MAP, ALL_COMPONENT
+    SYNAPSE_ANNOTATION, COLOR_MAP, NEURON_INDEX, ALL_COMPONENT
   };
 
   bool isDeprecated(EComponent comp) const;
@@ -47,14 +51,33 @@ public:
     return m_neuronArray;
   }
 
+  /*!
+   * \brief Get the neuron array for modification
+   *
+   * The ID and name indexes are rebuilt at the next lookup. Call
+   * deprecate(NEURON_INDEX) if the array is modified through a reference
+   * kept from an earlier call. Use the const version for reading, which is
+   * safe to call from several threads.
+   */
   ZFlyEmNeuronArray& getNeuronArray() {
+    deprecate(NEURON_INDEX);
     return m_neuronArray;
   }
 
+  /*!
+   * \brief Get the cache that bounds the memory of the loaded neuron data
+   *
+   * All neurons loaded by the bundle are associated with the cache. Use
+   * ZFlyEmNeuronPager to iterate through the neurons in bounded memory.
+   */
+  ZFlyEmNeuronModelCache& getModelCache() {
+    return m_modelCache;
+  }
+
   inline const std::string& getSource() const { return m_source; }
 
   //Return the pointer to the neuron with id <bodyId>. It returns NULL if no
-  //such id is found.
+  //such id is found. The first neuron is returned if there are duplicated ids.
   const ZFlyEmNeuron* getNeuron(int bodyId) const;
   ZFlyEmNeuron* getNeuron(int bodyId);
   const ZFlyEmNeuron* getNeuronFromName(const std::string &name) const;
@@ -181,8 +204,12 @@ public:
 
 private:
   void updateSynapseAnnotation();
+  bool updateNeuronIndex() const;
+  void attachModelCache();
 
 private:
+  //Declared before the neurons so that it is destroyed after them
+  ZFlyEmNeuronModelCache m_modelCache;
   ZFlyEmNeuronArray m_neuronArray;
   std::string m_synapseAnnotationFile;
   std::string m_grayScalePath;
@@ -202,6 +229,12 @@ private:
   mutable FlyEm::ZSynapseAnnotationArray *m_synaseAnnotation;
   mutable std::map<int, QColor> *m_colorMap;
 
+  //Position of each neuron in m_neuronArray
+  mutable QHash<int, size_t> m_idIndex;
+  mutable QHash<QString, size_t> m_nameIndex;
+  mutable bool m_isNeuronIndexDeprecated;
+  mutable QMutex m_neuronIndexMutex;
+
   static const char *m_synapseKey;
   static const char *m_grayScaleKey;
   static const char *m_configKey;
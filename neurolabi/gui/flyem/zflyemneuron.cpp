@@ -17,6 +17,7 @@
 #include "neutubeconfig.h"
 #include "tz_geo3d_utils.h"
 #include "zstackskeletonizer.h"
+#include "flyem/zflyemneuronmodelcache.h"
 
 #if defined(_QT_GUI_USED_)
 #include "dvid/zdvidwriter.h"
@@ -30,7 +31,7 @@ const int ZFlyEmNeuron::TopMatchCapacity = 10;
 
 #define CONSTRUCTOR_INIT m_sourceId(0), m_id(0), m_synapseScale(10.0), \
     m_model(NULL), m_unscaledModel(NULL), m_buddyModel(NULL), m_body(NULL), \
-    m_synapseAnnotation(NULL), m_bodyVolume(0)
+    m_synapseAnnotation(NULL), m_modelCache(NULL), m_bodyVolume(0)
 
 const char *ZFlyEmNeuron::m_idKey = "id";
 const char *ZFlyEmNeuron::m_nameKey = "name";
@@ -70,6 +71,7 @@ ZFlyEmNeuron::ZFlyEmNeuron(const ZFlyEmNeuron &neuron) : CONSTRUCTOR_INIT
   m_thumbnailPath = neuron.m_thumbnailPath;
   m_synapseScale = neuron.m_synapseScale;
   m_synapseAnnotation = neuron.m_synapseAnnotation;
+  m_modelCache = neuron.m_modelCache;
   for (int i = 0; i < 3; ++i) {
     m_resolution[i] = neuron.m_resolution[i];
   }
@@ -77,6 +79,9 @@ ZFlyEmNeuron::ZFlyEmNeuron(const ZFlyEmNeuron &neuron) : CONSTRUCTOR_INIT
 
 ZFlyEmNeuron::~ZFlyEmNeuron()
 {
+  if (m_modelCache != NULL) {
+    m_modelCache->remove(this);
+  }
   deprecate(ALL_COMPONENT);
 }
 
@@ -154,14 +159,17 @@ void ZFlyEmNeuron::setPath(const ZDvidTarget &target)
 
 ZSwcTree* ZFlyEmNeuron::getResampleBuddyModel(double rs) const
 {
+  bool loaded = false;
   if (isDeprecated(BUDDY_MODEL)) {
     ZSwcTree *model = getModel();
     if (model != NULL) {
       m_buddyModel = model->clone();
       m_buddyModel->resample(rs);
       m_buddyModel->setLabel(0);
+      loaded = true;
     }
   }
+  updateModelCache(loaded);
 
   return m_buddyModel;
 }
@@ -177,7 +185,8 @@ ZSwcTree* ZFlyEmNeuron::getResampleBuddyModel() const
 
 ZSwcTree* ZFlyEmNeuron::getUnscaledModel(const string &bundleSource) const
 {
-  if (isDeprecated(UNSCALED_MODEL)) {
+  bool loading = isDeprecated(UNSCALED_MODEL);
+  if (loading) {
     if (!m_modelPath.empty()) {
       ZString path(m_modelPath);
       if (path.startsWith("http:")) {
@@ -195,6 +204,7 @@ ZSwcTree* ZFlyEmNeuron::getUnscaledModel(const string &bundleSource) const
       }
     }
   }
+  updateModelCache(loading && m_unscaledModel != NULL);
 
   return m_unscaledModel;
 }
@@ -259,13 +269,16 @@ void ZFlyEmNeuron::updateDvidModel(bool forceUpdate) const
 
 ZSwcTree* ZFlyEmNeuron::getModel(const string &bundleSource) const
 {
+  bool loaded = false;
   if (isDeprecated(MODEL)) {
     ZSwcTree *unscaledModel = getUnscaledModel(bundleSource);
     if (unscaledModel != NULL) {
       m_model = unscaledModel->clone();
       m_model->rescale(m_resolution[0], m_resolution[1], m_resolution[2]);
+      loaded = true;
     }
   }
+  updateModelCache(loaded);
 #if 0
   if (isDeprecated(MODEL)) {
     if (!m_modelPath.empty()) {
@@ -308,7 +321,8 @@ ZSwcTree* ZFlyEmNeuron::getModel(const string &bundleSource) const
 
 ZObject3dScan* ZFlyEmNeuron::getBody() const
 {
-  if (isDeprecated(BODY)) {
+  bool loading = isDeprecated(BODY);
+  if (loading) {
     ZString path(m_volumePath);
     if (path.startsWith("http:")) {
 #if defined(_QT_GUI_USED_)
@@ -329,10 +343,61 @@ ZObject3dScan* ZFlyEmNeuron::getBody() const
       }
     }
   }
+  updateModelCache(loading && m_body != NULL);
 
   return m_body;
 }
 
+void ZFlyEmNeuron::setModelCache(ZFlyEmNeuronModelCache *cache)
+{
+  if (m_modelCache != cache) {
+    if (m_modelCache != NULL) {
+      m_modelCache->remove(this);
+    }
+    m_modelCache = cache;
+    updateModelCache(true);
+  }
+}
+
+size_t ZFlyEmNeuron::getLoadedByteNumber() const
+{
+  size_t byteNumber = 0;
+
+  ZSwcTree *treeArray[] = { m_model, m_unscaledModel, m_buddyModel };
+  for (size_t i = 0; i < sizeof(treeArray) / sizeof(ZSwcTree*); ++i) {
+    if (treeArray[i] != NULL) {
+      byteNumber += sizeof(ZSwcTree) +
+          treeArray[i]->size() * sizeof(Swc_Tree_Node);
+    }
+  }
+
+  if (m_body != NULL) {
+    byteNumber += sizeof(ZObject3dScan) +
+        m_body->getStripeNumber() * sizeof(ZObject3dStripe);
+    for (size_t i = 0; i < m_body->getStripeNumber(); ++i) {
+      byteNumber += m_body->getStripe(i).getSegmentNumber() * 2 * sizeof(int);
+    }
+  }
+
+  return byteNumber;
+}
+
+void ZFlyEmNeuron::updateModelCache(bool loaded) const
+{
+  if (m_modelCache != NULL) {
+    if (loaded) {
+      size_t byteNumber = getLoadedByteNumber();
+      if (byteNumber > 0) {
+        m_modelCache->add(this, byteNumber);
+      } else {
+        m_modelCache->remove(this);
+      }
+    } else {
+      m_modelCache->touch(this);
+    }
+  }
+}
+
 
 void ZFlyEmNeuron::setResolution(const double *res)
 {
@@ -727,6 +792,7 @@ double ZFlyEmNeuron::getBodyVolume(bool cacheBody) const
 
   if (!cacheBody) {
     deprecate(ZFlyEmNeuron::BODY);
+    updateModelCache(true);
   }
 
   return m_bodyVolume;
@@ -14,6 +14,7 @@ class ZSwcTree;
 class ZPunctum;
 class ZObject3dScan;
 class ZDvidTarget;
+class ZFlyEmNeuronModelCache;
 
 /*!
  * \brief The class of Fly EM neuron
@@ -175,6 +176,23 @@ public:
     m_synapseAnnotation = annotation;
   }
 
+  /*!
+   * \brief Set the cache that accounts for the loaded models and body
+   *
+   * The cache is not owned by the neuron. It may release the models and body
+   * of the neuron in ZFlyEmNeuronModelCache::trim().
+   */
+  void setModelCache(ZFlyEmNeuronModelCache *cache);
+
+  inline ZFlyEmNeuronModelCache* getModelCache() const {
+    return m_modelCache;
+  }
+
+  /*!
+   * \brief Estimated memory size (bytes) of the loaded models and body
+   */
+  size_t getLoadedByteNumber() const;
+
   /*!
    * \brief Get the number of TBars on the neuron
    *
@@ -263,6 +281,7 @@ public:
 
 private:
   std::string getAbsolutePath(const ZString &path, const std::string &source);
+  void updateModelCache(bool loaded) const;
 
 private:
   int m_sourceId;
@@ -289,6 +308,7 @@ private:
   mutable ZObject3dScan *m_body;
   mutable std::vector<const ZFlyEmNeuron*> m_matched;
   const FlyEm::ZSynapseAnnotationArray *m_synapseAnnotation;
+  ZFlyEmNeuronModelCache *m_modelCache;
   mutable size_t m_bodyVolume;
 
   static const char *m_idKey;
@@ -0,0 +1,168 @@
+#include "zflyemneuronmodelcache.h"
+
+#include <QMutexLocker>
+
+#include "zflyemneuron.h"
+
+ZFlyEmNeuronModelCache::ZFlyEmNeuronModelCache() :
+  m_byteLimit(1024 * 1024 * 1024), m_byteUsage(0), m_evictionCount(0)
+{
+}
+
+ZFlyEmNeuronModelCache::Entry& ZFlyEmNeuronModelCache::getEntry(
+    const ZFlyEmNeuron *neuron)
+{
+  TEntryMap::iterator iter = m_entryMap.find(neuron);
+  if (iter == m_entryMap.end()) {
+    m_lru.push_front(neuron);
+    Entry &entry = m_entryMap[neuron];
+    entry.lruIter = m_lru.begin();
+
+    return entry;
+  }
+
+  Entry &entry = iter->second;
+  m_lru.splice(m_lru.begin(), m_lru, entry.lruIter);
+
+  return entry;
+}
+
+void ZFlyEmNeuronModelCache::add(const ZFlyEmNeuron *neuron, size_t byteNumber)
+{
+  QMutexLocker locker(&m_mutex);
+
+  Entry &entry = getEntry(neuron);
+  m_byteUsage -= entry.byteNumber;
+  entry.byteNumber = byteNumber;
+  m_byteUsage += byteNumber;
+}
+
+void ZFlyEmNeuronModelCache::touch(const ZFlyEmNeuron *neuron)
+{
+  QMutexLocker locker(&m_mutex);
+
+  TEntryMap::iterator iter = m_entryMap.find(neuron);
+  if (iter != m_entryMap.end()) {
+    m_lru.splice(m_lru.begin(), m_lru, iter->second.lruIter);
+  }
+}
+
+void ZFlyEmNeuronModelCache::remove(const ZFlyEmNeuron *neuron)
+{
+  QMutexLocker locker(&m_mutex);
+
+  TEntryMap::iterator iter = m_entryMap.find(neuron);
+  if (iter != m_entryMap.end()) {
+    m_byteUsage -= iter->second.byteNumber;
+    m_lru.erase(iter->second.lruIter);
+    m_entryMap.erase(iter);
+  }
+}
+
+void ZFlyEmNeuronModelCache::pin(const ZFlyEmNeuron *neuron)
+{
+  QMutexLocker locker(&m_mutex);
+
+  ++getEntry(neuron).pinCount;
+}
+
+void ZFlyEmNeuronModelCache::unpin(const ZFlyEmNeuron *neuron)
+{
+  QMutexLocker locker(&m_mutex);
+
+  TEntryMap::iterator iter = m_entryMap.find(neuron);
+  if (iter != m_entryMap.end()) {
+    Entry &entry = iter->second;
+    if (entry.pinCount > 0) {
+      --entry.pinCount;
+    }
+    //A neuron pinned before loading anything does not need to stay
+    if (entry.pinCount == 0 && entry.byteNumber == 0) {
+      m_lru.erase(entry.lruIter);
+      m_entryMap.erase(iter);
+    }
+  }
+}
+
+void ZFlyEmNeuronModelCache::evict(TEntryMap::iterator iter)
+{
+  const ZFlyEmNeuron *neuron = iter->first;
+  //The model depends on the unscaled model and the buddy model depends on
+  //the model, so they are all released with the unscaled model.
+  neuron->deprecate(ZFlyEmNeuron::UNSCALED_MODEL);
+  neuron->deprecate(ZFlyEmNeuron::BODY);
+
+  m_byteUsage -= iter->second.byteNumber;
+  m_lru.erase(iter->second.lruIter);
+  m_entryMap.erase(iter);
+  ++m_evictionCount;
+}
+
+void ZFlyEmNeuronModelCache::release(size_t limit)
+{
+  std::list<const ZFlyEmNeuron*>::iterator lruIter = m_lru.end();
+  while (m_byteUsage > limit && lruIter != m_lru.begin()) {
+    --lruIter;
+    TEntryMap::iterator iter = m_entryMap.find(*lruIter);
+    if (iter->second.pinCount == 0) {
+      //Keep the position at the less recent neighbor, which stays valid
+      ++lruIter;
+      evict(iter);
+    }
+  }
+}
+
+void ZFlyEmNeuronModelCache::trim()
+{
+  QMutexLocker locker(&m_mutex);
+
+  release(m_byteLimit);
+}
+
+void ZFlyEmNeuronModelCache::clear()
+{
+  QMutexLocker locker(&m_mutex);
+
+  TEntryMap::iterator iter = m_entryMap.begin();
+  while (iter != m_entryMap.end()) {
+    TEntryMap::iterator current = iter++;
+    if (current->second.pinCount == 0) {
+      evict(current);
+    }
+  }
+}
+
+void ZFlyEmNeuronModelCache::setByteLimit(size_t limit)
+{
+  QMutexLocker locker(&m_mutex);
+
+  m_byteLimit = limit;
+}
+
+size_t ZFlyEmNeuronModelCache::getByteLimit() const
+{
+  QMutexLocker locker(&m_mutex);
+
+  return m_byteLimit;
+}
+
+size_t ZFlyEmNeuronModelCache::getByteUsage() const
+{
+  QMutexLocker locker(&m_mutex);
+
+  return m_byteUsage;
+}
+
+size_t ZFlyEmNeuronModelCache::getNeuronNumber() const
+{
+  QMutexLocker locker(&m_mutex);
+
+  return m_entryMap.size();
+}
+
+int ZFlyEmNeuronModelCache::getEvictionCount() const
+{
+  QMutexLocker locker(&m_mutex);
+
+  return m_evictionCount;
+}
@@ -0,0 +1,96 @@
+#ifndef ZFLYEMNEURONMODELCACHE_H
+#define ZFLYEMNEURONMODELCACHE_H
+
+#include <map>
+#include <list>
+#include <QMutex>
+
+class ZFlyEmNeuron;
+
+/*!
+ * \brief The class of bounding the memory of loaded neuron models
+ *
+ * A neuron associated with the cache reports its loaded models and body after
+ * each load and refreshes its position in the least-recently-used order on
+ * each access. The cache does not free anything by itself, because a model
+ * returned by a neuron is a raw pointer that the caller may still be using.
+ * Instead, trim() releases the least recently used neurons until the total
+ * size is within the limit, and it is supposed to be called at a point where
+ * no model of an unpinned neuron is in use, such as between two steps of
+ * ZFlyEmNeuronPager.
+ */
+class ZFlyEmNeuronModelCache
+{
+public:
+  ZFlyEmNeuronModelCache();
+
+  /*!
+   * \brief Update the size of the data loaded by a neuron.
+   *
+   * The neuron becomes the most recently used one.
+   */
+  void add(const ZFlyEmNeuron *neuron, size_t byteNumber);
+
+  /*!
+   * \brief Mark a neuron as the most recently used one.
+   *
+   * Nothing is done if the neuron is not in the cache.
+   */
+  void touch(const ZFlyEmNeuron *neuron);
+
+  /*!
+   * \brief Remove a neuron from the cache without releasing its data.
+   */
+  void remove(const ZFlyEmNeuron *neuron);
+
+  /*!
+   * \brief Protect a neuron from trim().
+   *
+   * Pinning is counted, so each pin() needs a matching unpin().
+   */
+  void pin(const ZFlyEmNeuron *neuron);
+  void unpin(const ZFlyEmNeuron *neuron);
+
+  /*!
+   * \brief Release the least recently used unpinned neurons until the total
+   *        size is within the limit.
+   */
+  void trim();
+
+  /*!
+   * \brief Release all unpinned neurons.
+   */
+  void clear();
+
+  void setByteLimit(size_t limit);
+  size_t getByteLimit() const;
+
+  size_t getByteUsage() const;
+  size_t getNeuronNumber() const;
+  int getEvictionCount() const;
+
+private:
+  struct Entry {
+    Entry() : byteNumber(0), pinCount(0) {}
+    size_t byteNumber;
+    int pinCount;
+    std::list<const ZFlyEmNeuron*>::iterator lruIter;
+  };
+
+  typedef std::map<const ZFlyEmNeuron*, Entry> TEntryMap;
+
+  Entry& getEntry(const ZFlyEmNeuron *neuron);
+  void evict(TEntryMap::iterator iter);
+  void release(size_t limit);
+
+private:
+  mutable QMutex m_mutex;
+
+  size_t m_byteLimit;
+  size_t m_byteUsage;
+  TEntryMap m_entryMap;
+  std::list<const ZFlyEmNeuron*> m_lru; //most recent first
+  int m_evictionCount;
+};
+
+#endif // ZFLYEMNEURONMODELCACHE_H
@@ -0,0 +1,114 @@
+#include "zflyemneuronpager.h"
+
+#include <algorithm>
+
+#if defined(_QT_GUI_USED_)
+#include <QtConcurrentRun>
+#endif
+
+#include "zflyemdatabundle.h"
+#include "zflyemneuronarray.h"
+#include "zflyemneuronmodelcache.h"
+
+ZFlyEmNeuronPager::ZFlyEmNeuronPager(ZFlyEmDataBundle *bundle) :
+  m_component(MODEL), m_prefetchNumber(4), m_nextIndex(0), m_current(NULL),
+  m_prefetchEnd(0)
+{
+  m_neuronArray = &(bundle->getNeuronArray());
+  m_cache = &(bundle->getModelCache());
+}
+
+ZFlyEmNeuronPager::~ZFlyEmNeuronPager()
+{
+  for (size_t index = m_nextIndex; index < m_prefetchEnd; ++index) {
+    wait(index);
+    m_cache->unpin(&(*m_neuronArray)[index]);
+  }
+  unpinCurrent();
+}
+
+void ZFlyEmNeuronPager::setComponent(int component)
+{
+  m_component = component;
+}
+
+void ZFlyEmNeuronPager::setPrefetchNumber(int n)
+{
+  m_prefetchNumber = n;
+}
+
+bool ZFlyEmNeuronPager::hasNext() const
+{
+  return m_nextIndex < m_neuronArray->size();
+}
+
+void ZFlyEmNeuronPager::LoadNeuron(const ZFlyEmNeuron *neuron, int component)
+{
+  if (component & MODEL) {
+    neuron->getModel();
+  }
+
+  if (component & BODY) {
+    neuron->getBody();
+  }
+}
+
+void ZFlyEmNeuronPager::prefetch(size_t index)
+{
+  ZFlyEmNeuron &neuron = (*m_neuronArray)[index];
+  neuron.setModelCache(m_cache);
+  m_cache->pin(&neuron);
+
+#if defined(_QT_GUI_USED_)
+  m_futureMap[index] = QtConcurrent::run(
+        &ZFlyEmNeuronPager::LoadNeuron, (const ZFlyEmNeuron*) &neuron,
+        m_component);
+#endif
+}
+
+void ZFlyEmNeuronPager::wait(size_t index)
+{
+#if defined(_QT_GUI_USED_)
+  std::map<size_t, QFuture<void> >::iterator iter = m_futureMap.find(index);
+  if (iter != m_futureMap.end()) {
+    iter->second.waitForFinished();
+    m_futureMap.erase(iter);
+  }
+#else
+  UNUSED_PARAMETER(index);
+#endif
+}
+
+void ZFlyEmNeuronPager::unpinCurrent()
+{
+  if (m_current != NULL) {
+    m_cache->unpin(m_current);
+    m_current = NULL;
+  }
+}
+
+ZFlyEmNeuron* ZFlyEmNeuronPager::next()
+{
+  if (!hasNext()) {
+    return NULL;
+  }
+
+  unpinCurrent();
+
+  size_t index = m_nextIndex++;
+  size_t prefetchEnd = std::min(
+        m_neuronArray->size(), index + 1 + std::max(0, m_prefetchNumber));
+  for (; m_prefetchEnd < prefetchEnd; ++m_prefetchEnd) {
+    prefetch(m_prefetchEnd);
+  }
+
+  wait(index);
+
+  //Nothing is loaded again if the prefetching has done it
+  ZFlyEmNeuron *neuron = &(*m_neuronArray)[index];
+  LoadNeuron(neuron, m_component);
+  m_current = neuron;
+  m_cache->trim();
+
+  return neuron;
+}
@@ -0,0 +1,81 @@
+#ifndef ZFLYEMNEURONPAGER_H
+#define ZFLYEMNEURONPAGER_H
+
+#include <map>
+#include <cstddef>
+
+#if defined(_QT_GUI_USED_)
+#include <QFuture>
+#endif
+
+class ZFlyEmDataBundle;
+class ZFlyEmNeuron;
+class ZFlyEmNeuronArray;
+class ZFlyEmNeuronModelCache;
+
+/*!
+ * \brief The class of iterating through the neurons of a data bundle with
+ *        bounded memory
+ *
+ * Usage:
+ *   ZFlyEmNeuronPager pager(bundle);
+ *   while (pager.hasNext()) {
+ *     ZFlyEmNeuron *neuron = pager.next();
+ *     ...
+ *   }
+ *
+ * The data of the next few neurons are loaded in the background while the
+ * current one is being processed. Each call of next() trims the model cache
+ * of the bundle, so the data of a neuron returned earlier may be released
+ * after next() is called again.
+ */
+class ZFlyEmNeuronPager
+{
+public:
+  ZFlyEmNeuronPager(ZFlyEmDataBundle *bundle);
+  ~ZFlyEmNeuronPager();
+
+  enum EComponent {
+    MODEL = 1, BODY = 2
+  };
+
+  /*!
+   * \brief Set the data to load for each neuron.
+   *
+   * \param component Combination of EComponent flags. It is MODEL by default.
+   */
+  void setComponent(int component);
+
+  /*!
+   * \brief Set the number of neurons to load ahead.
+   */
+  void setPrefetchNumber(int n);
+
+  bool hasNext() const;
+
+  /*!
+   * \brief Get the next neuron with its data loaded.
+   */
+  ZFlyEmNeuron* next();
+
+private:
+  void prefetch(size_t index);
+  void wait(size_t index);
+  void unpinCurrent();
+  static void LoadNeuron(const ZFlyEmNeuron *neuron, int component);
+
+private:
+  ZFlyEmNeuronArray *m_neuronArray;
+  ZFlyEmNeuronModelCache *m_cache;
+  int m_component;
+  int m_prefetchNumber;
+  size_t m_nextIndex;
+  const ZFlyEmNeuron *m_current;
+  size_t m_prefetchEnd;
+
+#if defined(_QT_GUI_USED_)
+  std::map<size_t, QFuture<void> > m_futureMap;
+#endif
+};
+
+#endif // ZFLYEMNEURONPAGER_H
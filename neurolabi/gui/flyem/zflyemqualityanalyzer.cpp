@@ -517,14 +517,14 @@ ZFlyEmQualityAnalyzer::computeHotSpot(const ZFlyEmNeuron &neuron)
 }
 
 FlyEm::ZHotSpotArray &ZFlyEmQualityAnalyzer::computeHotSpot(const ZFlyEmNeuron *neuron,
-                                      std::vector<ZFlyEmNeuron> &neuronArray)
+                                      const std::vector<ZFlyEmNeuron> &neuronArray)
 {
   return computeHotSpot(*neuron, neuronArray);
 }
 
 FlyEm::ZHotSpotArray&
 ZFlyEmQualityAnalyzer::computeHotSpot(const ZFlyEmNeuron &neuron,
-                                      std::vector<ZFlyEmNeuron> &neuronArray)
+                                      const std::vector<ZFlyEmNeuron> &neuronArray)
 {
   m_hotSpotArray.clear();
 
@@ -65,10 +65,10 @@ public:
   FlyEm::ZHotSpotArray& computeHotSpot(const ZFlyEmNeuron &neuron);
   FlyEm::ZHotSpotArray& computeHotSpot(const ZFlyEmNeuron *neuron);
 
-  FlyEm::ZHotSpotArray& computeHotSpot(const ZFlyEmNeuron &neuron,
-                                       std::vector<ZFlyEmNeuron>& neuronArray);
-  FlyEm::ZHotSpotArray& computeHotSpot(const ZFlyEmNeuron *neuron,
-                                       std::vector<ZFlyEmNeuron>& neuronArray);
+  FlyEm::ZHotSpotArray& computeHotSpot(
+      const ZFlyEmNeuron &neuron, const std::vector<ZFlyEmNeuron>& neuronArray);
+  FlyEm::ZHotSpotArray& computeHotSpot(
+      const ZFlyEmNeuron *neuron, const std::vector<ZFlyEmNeuron>& neuronArray);
 
   FlyEm::ZHotSpotArray& computeHotSpotForSplit(const ZFlyEmNeuron &neuron);
 
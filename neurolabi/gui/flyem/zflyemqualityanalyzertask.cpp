@@ -22,7 +22,8 @@ void ZFlyEmQualityAnalyzerTask::prepare()
   }
 
   if (m_dataBundle != NULL) {
-    std::vector<ZFlyEmNeuron>& neuronArray = m_dataBundle->getNeuronArray();
+    const std::vector<ZFlyEmNeuron>& neuronArray =
+        m_dataBundle->getNeuronArray();
     for (size_t i = 0; i < neuronArray.size(); ++i) {
       ZSwcTree *tree = neuronArray[i].getModel();
       if (tree != NULL) {
@@ -26,7 +26,7 @@ public:
   inline void setSource(ZFlyEmNeuron *source) {
     m_source = source;
   }
-  inline void setDataBundle(ZFlyEmDataBundle *bundle) {
+  inline void setDataBundle(const ZFlyEmDataBundle *bundle) {
     m_dataBundle = bundle;
   }
 
@@ -34,7 +34,7 @@ public:
 
 private:
   ZFlyEmNeuron *m_source;
-  ZFlyEmDataBundle *m_dataBundle;
+  const ZFlyEmDataBundle *m_dataBundle;
   FlyEm::ZHotSpotArray m_hotSpotArray;
 };
 
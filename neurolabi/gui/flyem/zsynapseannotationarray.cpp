@@ -8,6 +8,7 @@
 #include <algorithm>
 
 #include "zjsonparser.h"
+#include "zjsonstreamreader.h"
 #include "zswctree.h"
 #include "swctreenode.h"
 #include "zsynapselocationmatcher.h"
@@ -27,6 +28,7 @@ using namespace std;
 ZSynapseAnnotationArray::ZSynapseAnnotationArray()
 {
   m_connectionGraph = NULL;
+  m_isSynapseStoreDeprecated = true;
   m_currentIndex = 0;
   m_currentLocationIndex = 0;
 }
@@ -39,6 +41,8 @@ ZSynapseAnnotationArray::~ZSynapseAnnotationArray()
 bool ZSynapseAnnotationArray::loadJson(const ZJsonObject &jsonObject,
                                        ELoadDataMode mode)
 {
+  deprecate(ALL_COMPONENT);
+
   //Two keys at the first level: "data" and "metadata"
   const char *key;
   json_t *value;
@@ -90,9 +94,10 @@ bool ZSynapseAnnotationArray::loadJson(const ZJsonObject &jsonObject,
 bool ZSynapseAnnotationArray::loadJson(const std::string &filePath,
                                        ELoadDataMode mode)
 {
-  ZJsonObject jsonObject;
+  bool hasTBar = false;
 
   if (ZString(filePath).startsWith("http:")) {
+    ZJsonObject jsonObject;
 #ifdef _QT_GUI_USED_
     ZFlyEmDvidReader reader;
     if (reader.open(filePath.c_str())) {
@@ -104,17 +109,74 @@ bool ZSynapseAnnotationArray::loadJson(const std::string &filePath,
       }
     }
 #endif
+    hasTBar = loadJson(jsonObject, mode);
   } else {
-    jsonObject.load(filePath);
+    hasTBar = loadJsonStream(filePath, mode);
   }
 
-  bool hasTBar = loadJson(jsonObject, mode);
-
   m_source = filePath;
 
   return hasTBar;
 }
 
+bool ZSynapseAnnotationArray::loadJsonStream(const std::string &filePath,
+                                             ELoadDataMode mode)
+{
+  deprecate(ALL_COMPONENT);
+
+  switch (mode) {
+  case OVERWRITE:
+    clear();
+    break;
+  case APPEND:
+    break;
+  default:
+    TZ_ERROR(ERROR_DATA_VALUE);
+    break;
+  }
+
+  ZJsonStreamReader reader;
+  if (!reader.open(filePath)) {
+    cout << reader.getErrorMessage() << endl;
+    return false;
+  }
+
+  int tbarNumber = 0;
+
+  //Two keys at the first level: "data" and "metadata". Only one synapse is
+  //decoded at a time.
+  if (reader.next() == ZJsonStreamReader::TOKEN_START_OBJECT) {
+    while (reader.next() == ZJsonStreamReader::TOKEN_KEY) {
+      if (reader.getString() == "metadata") {
+        ZJsonValue metadata = reader.readValue();
+        if (metadata.isObject()) {
+          m_metadata.loadJsonObject(metadata.getData());
+        }
+      } else if (reader.getString() == "data" &&
+                 reader.peek() == ZJsonStreamReader::TOKEN_START_ARRAY) {
+        reader.next();
+        while (reader.hasNextElement()) {
+          ZJsonValue synapse = reader.readValue();
+          if (synapse.isObject()) {
+            push_back(ZSynapseAnnotation());
+            if (back().loadJsonObject(synapse.getData())) {
+              tbarNumber++;
+            }
+          }
+        }
+      } else {
+        reader.skipValue();
+      }
+    }
+  }
+
+  if (reader.hasError()) {
+    cout << filePath << ": " << reader.getErrorMessage() << endl;
+  }
+
+  return (tbarNumber > 0);
+}
+
 string ZSynapseAnnotationArray::metadataString()
 {
   return m_metadata.toString();
@@ -506,117 +568,131 @@ ZSynapseAnnotationArray::toMarkerArray(
   vector<ZVaa3dMarker> markerArray;
   int currentTBarId = 0;
 
-  for (const SynapseLocation *synapse = beginSynapseLocation();
-       synapse != NULL; synapse = nextSynapseLocation()) {
-    if (synapse->isTBar()) {
-      currentTBarId = synapse->bodyId();
-    }
-
-    bool display = false;
-    static const int kOnBody = 4;
-    static const int kPartnerOnBody = 2;
-    int locationMode; //0: N; 2: P; 4: O
+  //Only synapses touching the body can be displayed
+  std::vector<int> synapseIndexArray;
+  if (displayConfig.bodyId >= 0) {
+    synapseIndexArray = getSynapseIndexOnBody(displayConfig.bodyId);
+  }
+  size_t synapseNumber =
+      displayConfig.bodyId >= 0 ? synapseIndexArray.size() : size();
+
+  for (size_t synapseIndex = 0; synapseIndex < synapseNumber; ++synapseIndex) {
+    m_currentIndex = displayConfig.bodyId >= 0 ?
+          synapseIndexArray[synapseIndex] : synapseIndex;
+    for (m_currentLocationIndex = 0;
+         m_currentLocationIndex <= (*this)[m_currentIndex].partnerNumber();
+         ++m_currentLocationIndex) {
+      const SynapseLocation *synapse = currentSynapseLocation();
+      if (synapse->isTBar()) {
+        currentTBarId = synapse->bodyId();
+      }
 
-    if (displayConfig.bodyId < 0) { //For all bodies
-      locationMode = kOnBody | kPartnerOnBody;
-    } else if (synapse->bodyId() == displayConfig.bodyId) {
-      locationMode = kOnBody;
-    } else if (isPartnerOnBody(displayConfig.bodyId)) {
-      locationMode = kPartnerOnBody;
-    } else {
-      locationMode = 0;
-    }
+      bool display = false;
+      static const int kOnBody = 4;
+      static const int kPartnerOnBody = 2;
+      int locationMode; //0: N; 2: P; 4: O
+
+      if (displayConfig.bodyId < 0) { //For all bodies
+        locationMode = kOnBody | kPartnerOnBody;
+      } else if (synapse->bodyId() == displayConfig.bodyId) {
+        locationMode = kOnBody;
+      } else if (isPartnerOnBody(displayConfig.bodyId)) {
+        locationMode = kPartnerOnBody;
+      } else {
+        locationMode = 0;
+      }
 
-    if (locationMode == 0) { //Neither tbar nor psd hits body
-      display = false;
-    } else {
-      if (locationMode & kOnBody) { //location hits body
-        if ((displayConfig.mode == SynapseDisplayConfig::SYNAPSE_PAIR) ||
-            (displayConfig.mode == SynapseDisplayConfig::HALF_SYNAPSE)) {
-          display = true;
-        } else {
-          if ((displayConfig.mode == SynapseDisplayConfig::TBAR_ONLY) ||
-              (displayConfig.mode == SynapseDisplayConfig::TBAR_PAIR)) {
-            if (synapse->isTBar()) { //t-bar hits body
-              display = true;
-            }
-          } else if ((displayConfig.mode == SynapseDisplayConfig::PSD_ONLY) ||
-                     (displayConfig.mode == SynapseDisplayConfig::PSD_PAIR)) { //Show PSD only
-            if (synapse->isPartner()) { //PSD-hits body
-              display = true;
+      if (locationMode == 0) { //Neither tbar nor psd hits body
+        display = false;
+      } else {
+        if (locationMode & kOnBody) { //location hits body
+          if ((displayConfig.mode == SynapseDisplayConfig::SYNAPSE_PAIR) ||
+              (displayConfig.mode == SynapseDisplayConfig::HALF_SYNAPSE)) {
+            display = true;
+          } else {
+            if ((displayConfig.mode == SynapseDisplayConfig::TBAR_ONLY) ||
+                (displayConfig.mode == SynapseDisplayConfig::TBAR_PAIR)) {
+              if (synapse->isTBar()) { //t-bar hits body
+                display = true;
+              }
+            } else if ((displayConfig.mode == SynapseDisplayConfig::PSD_ONLY) ||
+                       (displayConfig.mode == SynapseDisplayConfig::PSD_PAIR)) { //Show PSD only
+              if (synapse->isPartner()) { //PSD-hits body
+                display = true;
+              }
             }
           }
         }
-      }
 
-      if (locationMode & kPartnerOnBody) { //Partner hits body
-        switch(displayConfig.mode) {
-        case SynapseDisplayConfig::TBAR_PAIR:
-          display |= synapse->isPartner(); //the partner is T-bar
-          break;
-        case SynapseDisplayConfig::PSD_PAIR:
-          display |= synapse->isTBar(); //The partner is PSD
-          break;
-        case SynapseDisplayConfig::SYNAPSE_PAIR:
-          display = true;
-          break;
-        default:
-          display |= false;
+        if (locationMode & kPartnerOnBody) { //Partner hits body
+          switch(displayConfig.mode) {
+          case SynapseDisplayConfig::TBAR_PAIR:
+            display |= synapse->isPartner(); //the partner is T-bar
+            break;
+          case SynapseDisplayConfig::PSD_PAIR:
+            display |= synapse->isTBar(); //The partner is PSD
+            break;
+          case SynapseDisplayConfig::SYNAPSE_PAIR:
+            display = true;
+            break;
+          default:
+            display |= false;
+          }
         }
       }
-    }
 
-    if (display && displayConfig.buddyBodyId >= 0) {
-      if (synapse->isTBar()) {
-        display = currentSynapseAnnotation()->hasPartner(
-              displayConfig.buddyBodyId);
-      } else {
-        display = (currentTBarId == displayConfig.buddyBodyId);
+      if (display && displayConfig.buddyBodyId >= 0) {
+        if (synapse->isTBar()) {
+          display = currentSynapseAnnotation()->hasPartner(
+                displayConfig.buddyBodyId);
+        } else {
+          display = (currentTBarId == displayConfig.buddyBodyId);
+        }
       }
-    }
 
-    if (display) {
+      if (display) {
 #ifdef _DEBUG_2
-      cout << synapse->toString() << endl;
+        cout << synapse->toString() << endl;
 #endif
-      ZPoint pt = synapse->mapPosition(config, spaceOption);
-      ZVaa3dMarker marker;
-      marker.setCenter(pt.x(), pt.y(), pt.z());
-      marker.setRadius(config.sizeScale);
-      if (synapse->isTBar()) {
-        marker.setColor(displayConfig.tBarColor.red,
-                        displayConfig.tBarColor.green,
-                        displayConfig.tBarColor.blue);
-        marker.setType(1);
-      } else {
-        marker.setColor(displayConfig.psdColor.red,
-                        displayConfig.psdColor.green,
-                        displayConfig.psdColor.blue);
-        marker.setType(2);
-      }
-      marker.setSource(synapse->getPunctumSource());
-      ostringstream nameStream;
+        ZPoint pt = synapse->mapPosition(config, spaceOption);
+        ZVaa3dMarker marker;
+        marker.setCenter(pt.x(), pt.y(), pt.z());
+        marker.setRadius(config.sizeScale);
+        if (synapse->isTBar()) {
+          marker.setColor(displayConfig.tBarColor.red,
+                          displayConfig.tBarColor.green,
+                          displayConfig.tBarColor.blue);
+          marker.setType(1);
+        } else {
+          marker.setColor(displayConfig.psdColor.red,
+                          displayConfig.psdColor.green,
+                          displayConfig.psdColor.blue);
+          marker.setType(2);
+        }
+        marker.setSource(synapse->getPunctumSource());
+        ostringstream nameStream;
 
-      nameStream << currentTBarId;
+        nameStream << currentTBarId;
 
-      //marker.setName(nameStream.str());
+        //marker.setName(nameStream.str());
 
-      ostringstream commentStream;
-      if (synapse->isPartner()) {
-        commentStream << currentTBarId << "_";
+        ostringstream commentStream;
+        if (synapse->isPartner()) {
+          commentStream << currentTBarId << "_";
 #ifdef _DEBUG_2
-        marker.setSource(commentStream.str());
+          marker.setSource(commentStream.str());
 #endif
-      }
-      commentStream << synapse->bodyId();
+        }
+        commentStream << synapse->bodyId();
 
-      commentStream << "; Raveler coordinates: (" << synapse->x() << ", "
-                    << synapse->y() << ", " << synapse->z() << ")";
+        commentStream << "; Raveler coordinates: (" << synapse->x() << ", "
+                      << synapse->y() << ", " << synapse->z() << ")";
 
-      marker.setName(commentStream.str());
+        marker.setName(commentStream.str());
 
-      marker.setComment(commentStream.str());
-      markerArray.push_back(marker);
+        marker.setComment(commentStream.str());
+        markerArray.push_back(marker);
+      }
     }
   }
 
@@ -1147,31 +1223,12 @@ vector<int> FlyEm::ZSynapseAnnotationArray::countPsd()
 
 int FlyEm::ZSynapseAnnotationArray::countPsd(int bodyId) const
 {
-  int count = 0;
-  for (size_t i = 0; i < size(); i++) {
-    for (size_t j = 0; j < (*this)[i].getPartnerArrayRef()->size(); ++j) {
-      int psdBodyId = (*this)[i].getPartnerRef(j)->bodyId();
-      if (psdBodyId == bodyId) {
-        ++count;
-      }
-    }
-  }
-
-  return count;
+  return getSynapseStore().countPsd(bodyId);
 }
 
 bool FlyEm::ZSynapseAnnotationArray::hasPsd(int bodyId) const
 {
-  for (size_t i = 0; i < size(); i++) {
-    for (size_t j = 0; j < (*this)[i].getPartnerArrayRef()->size(); ++j) {
-      int psdBodyId = (*this)[i].getPartnerRef(j)->bodyId();
-      if (psdBodyId == bodyId) {
-        return true;
-      }
-    }
-  }
-
-  return false;
+  return getSynapseStore().countPsd(bodyId) > 0;
 }
 
 vector<int> FlyEm::ZSynapseAnnotationArray::countTBar()
@@ -1190,59 +1247,22 @@ vector<int> FlyEm::ZSynapseAnnotationArray::countTBar()
 
 int FlyEm::ZSynapseAnnotationArray::countTBar(int bodyId) const
 {
-  int count = 0;
-  for (size_t i = 0; i < size(); i++) {
-    int tbarBodyId = getTBarRef(i)->bodyId();
-    if (tbarBodyId == bodyId) {
-      ++count;
-    }
-  }
-
-  return count;
+  return getSynapseStore().countTBar(bodyId);
 }
 
 bool FlyEm::ZSynapseAnnotationArray::hasTBar(int bodyId) const
 {
-  for (size_t i = 0; i < size(); i++) {
-    int tbarBodyId = getTBarRef(i)->bodyId();
-    if (tbarBodyId == bodyId) {
-      return true;
-    }
-  }
-
-  return false;
+  return getSynapseStore().countTBar(bodyId) > 0;
 }
 
 int FlyEm::ZSynapseAnnotationArray::countInputNeuron(int bodyId) const
 {
-  std::set<int> idSet;
-  for (size_t i = 0; i < size(); i++) {
-    if ((*this)[i].getTBarRef()->bodyId() == bodyId) {
-      for (size_t j = 0; j < (*this)[i].getPartnerArrayRef()->size(); ++j) {
-        int psdBodyId = (*this)[i].getPartnerRef(j)->bodyId();
-        idSet.insert(psdBodyId);
-      }
-    }
-  }
-
-  return idSet.size();
+  return getSynapseStore().getDownstreamCount(bodyId).size();
 }
 
 int FlyEm::ZSynapseAnnotationArray::countOutputNeuron(int bodyId) const
 {
-  std::set<int> idSet;
-
-  for (size_t i = 0; i < size(); i++) {
-    for (size_t j = 0; j < (*this)[i].getPartnerArrayRef()->size(); ++j) {
-      int psdBodyId = (*this)[i].getPartnerRef(j)->bodyId();
-      if (psdBodyId == bodyId) {
-        idSet.insert((*this)[i].getTBarRef()->bodyId());
-        break;
-      }
-    }
-  }
-
-  return idSet.size();
+  return getSynapseStore().getUpstreamCount(bodyId).size();
 }
 
 vector<int> FlyEm::ZSynapseAnnotationArray::countSynapse()
@@ -1278,12 +1298,14 @@ vector<int> FlyEm::ZSynapseAnnotationArray::countSynapse()
 std::vector<SynapseLocation*>
 FlyEm::ZSynapseAnnotationArray::getTBarArray(int bodyId) const
 {
+  const ZSynapseStore &store = getSynapseStore();
+  std::vector<size_t> locationArray = store.getTBarLocation(bodyId);
+
   std::vector<SynapseLocation*> synapseArray;
-  for (size_t i = 0; i < size(); i++) {
-    const SynapseLocation *tbar = getTBarRef(i);
-    if (bodyId == tbar->getBodyId()) {
-      synapseArray.push_back(const_cast<SynapseLocation*>(tbar));
-    }
+  for (size_t i = 0; i < locationArray.size(); ++i) {
+    const SynapseLocation *tbar =
+        getTBarRef(store.getSynapseIndex(locationArray[i]));
+    synapseArray.push_back(const_cast<SynapseLocation*>(tbar));
   }
 
   return synapseArray;
@@ -1292,14 +1314,15 @@ FlyEm::ZSynapseAnnotationArray::getTBarArray(int bodyId) const
 std::vector<SynapseLocation*>
 FlyEm::ZSynapseAnnotationArray::getPsdArray(int bodyId) const
 {
+  const ZSynapseStore &store = getSynapseStore();
+  std::vector<size_t> locationArray = store.getPsdLocation(bodyId);
+
   std::vector<SynapseLocation*> synapseArray;
-  for (size_t i = 0; i < size(); i++) {
-    for (size_t j = 0; j < (*this)[i].getPartnerArrayRef()->size(); ++j) {
-      const SynapseLocation *psd = (*this)[i].getPartnerRef(j);
-      if (bodyId == psd->getBodyId()) {
-        synapseArray.push_back(const_cast<SynapseLocation*>(psd));
-      }
-    }
+  for (size_t i = 0; i < locationArray.size(); ++i) {
+    size_t index = locationArray[i];
+    const SynapseLocation *psd = (*this)[store.getSynapseIndex(index)].
+        getSynapseLocationRef(store.getLocationRank(index));
+    synapseArray.push_back(const_cast<SynapseLocation*>(psd));
   }
 
   return synapseArray;
@@ -1313,6 +1336,8 @@ void FlyEm::ZSynapseAnnotationArray::convertRavelerToImageSpace(
        synapse != NULL; synapse = nextSynapseLocation()) {
     synapse->convertRavelerToImageSpace(startZ, height);
   }
+
+  deprecate(SYNAPSE_STORE);
 }
 
 void FlyEm::ZSynapseAnnotationArray::convertRavelerToDvidSpace()
@@ -1474,23 +1499,23 @@ ZWeightedPointArray ZSynapseAnnotationArray::toTBarConfidencePointArray() const
 
 int FlyEm::ZSynapseAnnotationArray::getStrongestInput(int bodyId) const
 {
+  //Same order of visiting as scanning the whole array, so that ties are
+  //broken in the same way
+  const ZSynapseStore &store = getSynapseStore();
+  std::vector<size_t> tbarArray = store.getTBarLocation(bodyId);
+
   std::map<int, int> idMap;
   int id = -1;
   int maxCount = 0;
-  for (size_t i = 0; i < size(); i++) {
-    if ((*this)[i].getTBarRef()->bodyId() == bodyId) {
-      for (size_t j = 0; j < (*this)[i].getPartnerArrayRef()->size(); ++j) {
-        int psdBodyId = (*this)[i].getPartnerRef(j)->bodyId();
-        int count = 1;
-        if (idMap.count(psdBodyId) == 0) {
-          idMap[psdBodyId] = 1;
-        } else {
-          count = ++(idMap[psdBodyId]);
-        }
-        if (count > maxCount) {
-          maxCount = count;
-          id = psdBodyId;
-        }
+  for (size_t i = 0; i < tbarArray.size(); i++) {
+    size_t synapseEnd =
+        store.getSynapseEnd(store.getSynapseIndex(tbarArray[i]));
+    for (size_t psd = tbarArray[i] + 1; psd < synapseEnd; ++psd) {
+      int psdBodyId = store.getBodyId(psd);
+      int count = ++(idMap[psdBodyId]);
+      if (count > maxCount) {
+        maxCount = count;
+        id = psdBodyId;
       }
     }
   }
@@ -1500,26 +1525,20 @@ int FlyEm::ZSynapseAnnotationArray::getStrongestInput(int bodyId) const
 
 int FlyEm::ZSynapseAnnotationArray::getStrongestOutput(int bodyId) const
 {
+  const ZSynapseStore &store = getSynapseStore();
+  std::vector<size_t> psdArray = store.getPsdLocation(bodyId);
+
   std::map<int, int> idMap;
   int id = -1;
   int maxCount = 0;
 
-  for (size_t i = 0; i < size(); i++) {
-    int tbarBodyId = (*this)[i].getTBarRef()->bodyId();
-    for (size_t j = 0; j < (*this)[i].getPartnerArrayRef()->size(); ++j) {
-      int psdBodyId = (*this)[i].getPartnerRef(j)->bodyId();
-      if (psdBodyId == bodyId) {
-        int count = 1;
-        if (idMap.count(tbarBodyId) == 0) {
-          idMap[tbarBodyId] = 1;
-        } else {
-          count = ++(idMap[tbarBodyId]);
-        }
-        if (count > maxCount) {
-          maxCount = count;
-          id = tbarBodyId;
-        }
-      }
+  for (size_t i = 0; i < psdArray.size(); i++) {
+    int tbarBodyId = store.getBodyId(
+          store.getSynapseStart(store.getSynapseIndex(psdArray[i])));
+    int count = ++(idMap[tbarBodyId]);
+    if (count > maxCount) {
+      maxCount = count;
+      id = tbarBodyId;
     }
   }
 
@@ -1539,8 +1558,13 @@ void ZSynapseAnnotationArray::deprecate(EComponent component)
     delete m_connectionGraph;
     m_connectionGraph = NULL;
     break;
+  case SYNAPSE_STORE:
+    m_synapseStore.clear();
+    m_isSynapseStoreDeprecated = true;
+    break;
   case ALL_COMPONENT:
     deprecate(CONNECTION_GRAPH);
+    deprecate(SYNAPSE_STORE);
     break;
   }
 }
@@ -1550,6 +1574,8 @@ bool ZSynapseAnnotationArray::isDeprecated(EComponent component) const
   switch (component) {
   case CONNECTION_GRAPH:
     return m_connectionGraph == NULL;
+  case SYNAPSE_STORE:
+    return m_isSynapseStoreDeprecated;
   case ALL_COMPONENT:
     return TRUE;
     break;
@@ -1602,6 +1628,36 @@ ZGraph* ZSynapseAnnotationArray::getConnectionGraph(bool excludingSelfConnection
   return m_connectionGraph;
 }
 
+const ZSynapseStore& ZSynapseAnnotationArray::getSynapseStore() const
+{
+  if (isDeprecated(SYNAPSE_STORE)) {
+    m_synapseStore.build(*this);
+    m_isSynapseStoreDeprecated = false;
+  }
+
+  return m_synapseStore;
+}
+
+std::vector<int> ZSynapseAnnotationArray::getSynapseIndexOnBody(
+    int bodyId) const
+{
+  const ZSynapseStore &store = getSynapseStore();
+  std::vector<size_t> locationArray = store.getTBarLocation(bodyId);
+  std::vector<size_t> psdArray = store.getPsdLocation(bodyId);
+  locationArray.insert(locationArray.end(), psdArray.begin(), psdArray.end());
+
+  std::vector<int> synapseIndexArray(locationArray.size());
+  for (size_t i = 0; i < locationArray.size(); ++i) {
+    synapseIndexArray[i] = store.getSynapseIndex(locationArray[i]);
+  }
+  std::sort(synapseIndexArray.begin(), synapseIndexArray.end());
+  synapseIndexArray.erase(
+        std::unique(synapseIndexArray.begin(), synapseIndexArray.end()),
+        synapseIndexArray.end());
+
+  return synapseIndexArray;
+}
+
 bool FlyEm::ZSynapseAnnotationArray::exportCsvFile(const string &filePath)
 {
   ofstream stream(filePath.c_str());
@@ -10,6 +10,7 @@
 #include "zvaa3dmarker.h"
 #include "zvaa3dapo.h"
 #include "zinttree.h"
+#include "zsynapsestore.h"
 
 class ZSwcTree;
 class ZGraph;
@@ -83,7 +84,7 @@ public:
   ~ZSynapseAnnotationArray();
 
   enum ELoadDataMode { APPEND, OVERWRITE };
-  enum EComponent { ALL_COMPONENT, CONNECTION_GRAPH };
+  enum EComponent { ALL_COMPONENT, CONNECTION_GRAPH, SYNAPSE_STORE };
 
   void deprecateDependent(EComponent component);
   void deprecate(EComponent component);
@@ -93,6 +94,16 @@ public:
   bool loadJson(const std::string &filePath, ELoadDataMode mode = OVERWRITE);
   bool loadJson(const ZJsonObject &jsonObject, ELoadDataMode mode = OVERWRITE);
 
+  /*!
+   * \brief Load synapses from a local JSON file.
+   *
+   * Unlike loading through a ZJsonObject, the file is read incrementally and
+   * each synapse is converted as soon as it is read, so the JSON document is
+   * never held in memory as a whole.
+   */
+  bool loadJsonStream(const std::string &filePath,
+                      ELoadDataMode mode = OVERWRITE);
+
   std::string metadataString();
   std::string toString(int indent = 0,
                        const std::vector<std::vector<int> > *selected = NULL);
@@ -306,10 +317,26 @@ public:
 
   ZGraph* getConnectionGraph(bool excludingSelfConnection = true);
 
+  /*!
+   * \brief Get the columnar copy of the synapses.
+   *
+   * The store is built on the first call. It is rebuilt after loading or
+   * converting coordinates, but deprecate(SYNAPSE_STORE) needs to be called
+   * after modifying synapses directly. The per-body queries of this class
+   * are answered by the store.
+   */
+  const ZSynapseStore& getSynapseStore() const;
+
   void ravelerFlip(int height);
 
 private:
   bool isPartnerOnBody(int bodyId) const;
+
+  /*!
+   * \brief Get the sorted indices of the synapses that have a T-bar or a
+   *        partner on a body.
+   */
+  std::vector<int> getSynapseIndexOnBody(int bodyId) const;
   static void assembleTBarSequence(ZIntTree *tbarSequence,
                                    ZIntTree *tbarSequenceReverse,
                                    int endIndex, int freeIndex);
@@ -318,6 +345,8 @@ private:
   ZSynapseAnnotationMetadata m_metadata;
 
   ZGraph *m_connectionGraph;
+  mutable ZSynapseStore m_synapseStore;
+  mutable bool m_isSynapseStoreDeprecated;
   mutable size_t m_currentIndex;
   mutable size_t m_currentLocationIndex; //0 for T-Bar, >=1 for PSD partners
   std::string m_source;
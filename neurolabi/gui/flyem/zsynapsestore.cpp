@@ -0,0 +1,219 @@
+#include "zsynapsestore.h"
+
+#include <algorithm>
+
+#include "zsynapseannotationarray.h"
+
+using namespace FlyEm;
+
+namespace {
+
+struct BodyLocationKey {
+  int bodyId;
+  int rank; //0 for T-bar and 1 for PSD
+  size_t index;
+
+  bool operator< (const BodyLocationKey &key) const {
+    if (bodyId != key.bodyId) {
+      return bodyId < key.bodyId;
+    }
+    if (rank != key.rank) {
+      return rank < key.rank;
+    }
+    return index < key.index;
+  }
+};
+
+}
+
+ZSynapseStore::ZSynapseStore()
+{
+}
+
+void ZSynapseStore::clear()
+{
+  m_x.clear();
+  m_y.clear();
+  m_z.clear();
+  m_bodyId.clear();
+  m_confidence.clear();
+  m_synapseIndex.clear();
+  m_synapseOffset.clear();
+
+  m_bodyIdArray.clear();
+  m_bodyOffset.clear();
+  m_bodyTBarEnd.clear();
+  m_bodyLocation.clear();
+}
+
+void ZSynapseStore::build(const ZSynapseAnnotationArray &synapseArray)
+{
+  clear();
+
+  size_t locationNumber = 0;
+  for (size_t i = 0; i < synapseArray.size(); ++i) {
+    locationNumber += synapseArray[i].partnerNumber() + 1;
+  }
+
+  m_x.reserve(locationNumber);
+  m_y.reserve(locationNumber);
+  m_z.reserve(locationNumber);
+  m_bodyId.reserve(locationNumber);
+  m_confidence.reserve(locationNumber);
+  m_synapseIndex.reserve(locationNumber);
+  m_synapseOffset.reserve(synapseArray.size() + 1);
+
+  for (size_t i = 0; i < synapseArray.size(); ++i) {
+    const ZSynapseAnnotation &synapse = synapseArray[i];
+    m_synapseOffset.push_back(m_x.size());
+    for (size_t j = 0; j <= synapse.partnerNumber(); ++j) {
+      const SynapseLocation *location = synapse.getSynapseLocationRef(j);
+      m_x.push_back(location->x());
+      m_y.push_back(location->y());
+      m_z.push_back(location->z());
+      m_bodyId.push_back(location->bodyId());
+      m_confidence.push_back(location->confidence());
+      m_synapseIndex.push_back(i);
+    }
+  }
+  m_synapseOffset.push_back(m_x.size());
+
+  buildBodyIndex();
+}
+
+void ZSynapseStore::buildBodyIndex()
+{
+  std::vector<BodyLocationKey> keyArray(m_x.size());
+  for (size_t i = 0; i < keyArray.size(); ++i) {
+    keyArray[i].bodyId = m_bodyId[i];
+    keyArray[i].rank = isTBar(i) ? 0 : 1;
+    keyArray[i].index = i;
+  }
+  std::sort(keyArray.begin(), keyArray.end());
+
+  m_bodyLocation.resize(keyArray.size());
+  for (size_t i = 0; i < keyArray.size(); ++i) {
+    const BodyLocationKey &key = keyArray[i];
+    m_bodyLocation[i] = key.index;
+    if (i == 0 || key.bodyId != keyArray[i - 1].bodyId) {
+      m_bodyIdArray.push_back(key.bodyId);
+      m_bodyOffset.push_back(i);
+      m_bodyTBarEnd.push_back(i);
+    }
+    if (key.rank == 0) {
+      m_bodyTBarEnd.back() = i + 1;
+    }
+  }
+  m_bodyOffset.push_back(keyArray.size());
+}
+
+bool ZSynapseStore::getBodyRange(
+    int bodyId, size_t *start, size_t *tbarEnd, size_t *end) const
+{
+  std::vector<int>::const_iterator iter =
+      std::lower_bound(m_bodyIdArray.begin(), m_bodyIdArray.end(), bodyId);
+  if (iter == m_bodyIdArray.end() || *iter != bodyId) {
+    return false;
+  }
+
+  size_t bodyIndex = iter - m_bodyIdArray.begin();
+  *start = m_bodyOffset[bodyIndex];
+  *tbarEnd = m_bodyTBarEnd[bodyIndex];
+  *end = m_bodyOffset[bodyIndex + 1];
+
+  return true;
+}
+
+size_t ZSynapseStore::countTBar(int bodyId) const
+{
+  size_t start, tbarEnd, end;
+  if (getBodyRange(bodyId, &start, &tbarEnd, &end)) {
+    return tbarEnd - start;
+  }
+
+  return 0;
+}
+
+size_t ZSynapseStore::countPsd(int bodyId) const
+{
+  size_t start, tbarEnd, end;
+  if (getBodyRange(bodyId, &start, &tbarEnd, &end)) {
+    return end - tbarEnd;
+  }
+
+  return 0;
+}
+
+std::vector<size_t> ZSynapseStore::getTBarLocation(int bodyId) const
+{
+  std::vector<size_t> locationArray;
+  size_t start, tbarEnd, end;
+  if (getBodyRange(bodyId, &start, &tbarEnd, &end)) {
+    locationArray.assign(m_bodyLocation.begin() + start,
+                         m_bodyLocation.begin() + tbarEnd);
+  }
+
+  return locationArray;
+}
+
+std::vector<size_t> ZSynapseStore::getPsdLocation(int bodyId) const
+{
+  std::vector<size_t> locationArray;
+  size_t start, tbarEnd, end;
+  if (getBodyRange(bodyId, &start, &tbarEnd, &end)) {
+    locationArray.assign(m_bodyLocation.begin() + tbarEnd,
+                         m_bodyLocation.begin() + end);
+  }
+
+  return locationArray;
+}
+
+int ZSynapseStore::countConnection(int preBodyId, int postBodyId) const
+{
+  int count = 0;
+  size_t start, tbarEnd, end;
+  if (getBodyRange(preBodyId, &start, &tbarEnd, &end)) {
+    for (size_t i = start; i < tbarEnd; ++i) {
+      size_t tbar = m_bodyLocation[i];
+      size_t synapseEnd = getSynapseEnd(m_synapseIndex[tbar]);
+      for (size_t psd = tbar + 1; psd < synapseEnd; ++psd) {
+        if (m_bodyId[psd] == postBodyId) {
+          ++count;
+        }
+      }
+    }
+  }
+
+  return count;
+}
+
+std::map<int, int> ZSynapseStore::getDownstreamCount(int bodyId) const
+{
+  std::map<int, int> countMap;
+  size_t start, tbarEnd, end;
+  if (getBodyRange(bodyId, &start, &tbarEnd, &end)) {
+    for (size_t i = start; i < tbarEnd; ++i) {
+      size_t tbar = m_bodyLocation[i];
+      size_t synapseEnd = getSynapseEnd(m_synapseIndex[tbar]);
+      for (size_t psd = tbar + 1; psd < synapseEnd; ++psd) {
+        ++countMap[m_bodyId[psd]];
+      }
+    }
+  }
+
+  return countMap;
+}
+
+std::map<int, int> ZSynapseStore::getUpstreamCount(int bodyId) const
+{
+  std::map<int, int> countMap;
+  size_t start, tbarEnd, end;
+  if (getBodyRange(bodyId, &start, &tbarEnd, &end)) {
+    for (size_t i = tbarEnd; i < end; ++i) {
+      size_t tbar = getSynapseStart(m_synapseIndex[m_bodyLocation[i]]);
+      ++countMap[m_bodyId[tbar]];
+    }
+  }
+
+  return countMap;
+}
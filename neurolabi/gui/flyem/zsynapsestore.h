@@ -0,0 +1,141 @@
+#ifndef ZSYNAPSESTORE_H
+#define ZSYNAPSESTORE_H
+
+#include <vector>
+#include <map>
+#include <cstddef>
+
+namespace FlyEm {
+
+class ZSynapseAnnotationArray;
+
+/*!
+ * \brief The class of a columnar copy of synapse annotations with indexes
+ *
+ * Each T-bar and each partner is a location. Locations are stored in the
+ * order of the annotation array, with a T-bar followed by its partners, and
+ * each property is kept in its own contiguous column. Location i belongs to
+ * the synapse getSynapseIndex(i) and it is the T-bar of the synapse iff
+ * getLocationRank(i) is 0, which is consistent with
+ * ZSynapseAnnotation::getSynapseLocationRef().
+ *
+ * A body index is built along with the columns. It groups locations by body
+ * ID, T-bars first in each group, so that all synapses of a body are found by
+ * a binary search.
+ *
+ * The store is a snapshot and it does not follow later changes of the
+ * annotation array.
+ */
+class ZSynapseStore
+{
+public:
+  ZSynapseStore();
+
+  void build(const ZSynapseAnnotationArray &synapseArray);
+  void clear();
+
+  inline size_t getSynapseNumber() const {
+    return m_synapseOffset.empty() ? 0 : m_synapseOffset.size() - 1;
+  }
+  inline size_t getLocationNumber() const { return m_x.size(); }
+
+  inline int getX(size_t index) const { return m_x[index]; }
+  inline int getY(size_t index) const { return m_y[index]; }
+  inline int getZ(size_t index) const { return m_z[index]; }
+  inline int getBodyId(size_t index) const { return m_bodyId[index]; }
+  inline float getConfidence(size_t index) const {
+    return m_confidence[index];
+  }
+  inline int getSynapseIndex(size_t index) const {
+    return m_synapseIndex[index];
+  }
+
+  /*!
+   * \brief Rank of a location in its synapse.
+   *
+   * \return 0 for a T-bar or (i + 1) for the ith partner.
+   */
+  inline size_t getLocationRank(size_t index) const {
+    return index - m_synapseOffset[m_synapseIndex[index]];
+  }
+  inline bool isTBar(size_t index) const {
+    return getLocationRank(index) == 0;
+  }
+
+  /*!
+   * \brief Get the location range of a synapse.
+   *
+   * The T-bar is at the start and the partners are in (start, end).
+   */
+  inline size_t getSynapseStart(size_t synapseIndex) const {
+    return m_synapseOffset[synapseIndex];
+  }
+  inline size_t getSynapseEnd(size_t synapseIndex) const {
+    return m_synapseOffset[synapseIndex + 1];
+  }
+
+  /*!
+   * \brief Sorted IDs of all bodies that have any synapse location.
+   */
+  inline const std::vector<int>& getBodyIdArray() const {
+    return m_bodyIdArray;
+  }
+
+  size_t countTBar(int bodyId) const;
+  size_t countPsd(int bodyId) const;
+
+  /*!
+   * \brief Get the T-bar locations of a body in increasing order.
+   */
+  std::vector<size_t> getTBarLocation(int bodyId) const;
+
+  /*!
+   * \brief Get the partner locations of a body in increasing order.
+   */
+  std::vector<size_t> getPsdLocation(int bodyId) const;
+
+  /*!
+   * \brief Count PSDs of \a postBodyId connected to T-bars of \a preBodyId.
+   */
+  int countConnection(int preBodyId, int postBodyId) const;
+
+  /*!
+   * \brief Count the PSDs downstream of a body
+   *
+   * \return A map from each partner body to the number of its PSDs connected
+   *         to the T-bars of \a bodyId.
+   */
+  std::map<int, int> getDownstreamCount(int bodyId) const;
+
+  /*!
+   * \brief Count the T-bars upstream of a body
+   *
+   * \return A map from each T-bar body to the number of PSDs of \a bodyId
+   *         connected to it.
+   */
+  std::map<int, int> getUpstreamCount(int bodyId) const;
+
+private:
+  void buildBodyIndex();
+  bool getBodyRange(int bodyId, size_t *start, size_t *tbarEnd,
+                    size_t *end) const;
+
+private:
+  std::vector<int> m_x;
+  std::vector<int> m_y;
+  std::vector<int> m_z;
+  std::vector<int> m_bodyId;
+  std::vector<float> m_confidence;
+  std::vector<int> m_synapseIndex;
+  std::vector<size_t> m_synapseOffset;
+
+  //Body index
+  std::vector<int> m_bodyIdArray;
+  std::vector<size_t> m_bodyOffset;
+  std::vector<size_t> m_bodyTBarEnd;
+  std::vector<size_t> m_bodyLocation;
+};
+
+}
+
+#endif // ZSYNAPSESTORE_H
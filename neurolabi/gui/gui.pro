@@ -312,6 +312,7 @@ HEADERS += mainwindow.h \
     zmoviecamera.h \
     z3dimage2drenderer.h \
     flyem/zflyemdatabundle.h \
+    flyem/zflyemneuronpager.h \
     flyem/zflyemdataframe.h \
     flyemdataform.h \
     zswcobjsmodel.h \
@@ -464,6 +465,9 @@ HEADERS += mainwindow.h \
     zframefactory.h \
     zactionbutton.h \
     dvid/zdvidbufferreader.h \
+    dvid/zdvidtransport.h \
+    dvid/zdvidblockcache.h \
+    dvid/zdvidtilecache.h \
     zmouseevent.h \
     zmouseeventrecorder.h \
     zmouseeventprocessor.h \
@@ -485,6 +489,7 @@ HEADERS += mainwindow.h \
     zrect2d.h \
     zobjectcolorscheme.h \
     flyem/zflyembodymerger.h \
+    flyem/zflyemconnectivitymatrix.h \
     dialogs/synapseimportdialog.h \
     flyem/zflyembodymergeproject.h \
     dialogs/flyembodymergeprojectdialog.h \
@@ -804,6 +809,7 @@ SOURCES += main.cpp \
     zmoviecamera.cpp \
     z3dimage2drenderer.cpp \
     flyem/zflyemdatabundle.cpp \
+    flyem/zflyemneuronpager.cpp \
     flyem/zflyemdataframe.cpp \
     flyemdataform.cpp \
     zswcobjsmodel.cpp \
@@ -930,6 +936,9 @@ SOURCES += main.cpp \
     zframefactory.cpp \
     zactionbutton.cpp \
     dvid/zdvidbufferreader.cpp \
+    dvid/zdvidtransport.cpp \
+    dvid/zdvidblockcache.cpp \
+    dvid/zdvidtilecache.cpp \
     zmouseevent.cpp \
     zmouseeventrecorder.cpp \
     zmouseeventprocessor.cpp \
@@ -950,6 +959,7 @@ SOURCES += main.cpp \
     zrect2d.cpp \
     zobjectcolorscheme.cpp \
     flyem/zflyembodymerger.cpp \
+    flyem/zflyemconnectivitymatrix.cpp \
     dialogs/synapseimportdialog.cpp \
     flyem/zflyembodymergeproject.cpp \
     dialogs/flyembodymergeprojectdialog.cpp \
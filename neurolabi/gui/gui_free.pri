@@ -34,6 +34,7 @@ HEADERS +=$${PWD}/zstackprocessor.h \
    $${PWD}/zargumentprocessor.h \
    $${PWD}/flyem/zsynapseannotation.h \
    $${PWD}/flyem/zsynapseannotationarray.h \
+   $${PWD}/flyem/zsynapsestore.h \
    $${PWD}/flyem/zsynapseannotationmetadata.h \
    $${PWD}/flyem/zsynapseannotationanalyzer.h \
    $${PWD}/flyem/zfileparser.h \
@@ -92,16 +93,20 @@ HEADERS +=$${PWD}/zstackprocessor.h \
    $${PWD}/zopencv_header.h \
    $${PWD}/neutubeconfig.h \
    $${PWD}/zhdf5writer.h \
+   $${PWD}/zhdf5blockiterator.h \
+   $${PWD}/zlabelmap.h \
    $${PWD}/flyem/zbcfset.h \
    $${PWD}/zstackskeletonizer.h \
    $${PWD}/zswclayerfeatureanalyzer.h \
    $${PWD}/flyem/zflyemneuron.h \
+   $${PWD}/flyem/zflyemneuronmodelcache.h \
    $${PWD}/zswctypetrunkanalyzer.h \
    $${PWD}/zobject3dscan.h \
    $${PWD}/zswclayershollfeatureanalyzer.h \
    $${PWD}/zswclayertrunkanalyzer.h \
    $${PWD}/zlogmessagereporter.h \
    $${PWD}/zstackgraph.h\
+   $${PWD}/zstackpathfinder.h \
    $${PWD}/zgraphcompressor.h \
    $${PWD}/zprogressreporter.h \
    $${PWD}/zstackdoccommand.h \
@@ -187,6 +192,10 @@ HEADERS +=$${PWD}/zstackprocessor.h \
    $${PWD}/zintset.h \
    $${PWD}/flyem/zflyemsubstackroi.h \
    $${PWD}/zstackwatershed.h \
+   $${PWD}/zstackobjectlabeler.h \
+   $${PWD}/zstackresampler.h \
+   $${PWD}/zstackslicepyramid.h \
+   $${PWD}/zincrementalwatershed.h \
    $${PWD}/zstackarray.h \
    $${PWD}/flyem/zflyemconfig.h \
    $${PWD}/tr1_header.h \
@@ -200,6 +209,7 @@ HEADERS +=$${PWD}/zstackprocessor.h \
    $${PWD}/bigdata/zstackblockgrid.h \
    $${PWD}/bigdata/zblockgrid.h \
    $${PWD}/bigdata/zblockgridfactory.h \
+   $${PWD}/bigdata/zchunkedstack.h \
    $${PWD}/zsparsestack.h \
    $${PWD}/zstackobject.h \
    $${PWD}/zobject3dfactory.h \
@@ -262,6 +272,7 @@ SOURCES +=$${PWD}/zstackprocessor.cpp \
    $${PWD}/zargumentprocessor.cpp \
    $${PWD}/flyem/zsynapseannotation.cpp \
    $${PWD}/flyem/zsynapseannotationarray.cpp \
+   $${PWD}/flyem/zsynapsestore.cpp \
    $${PWD}/flyem/zsynapseannotationmetadata.cpp \
    $${PWD}/flyem/zsynapseannotationanalyzer.cpp \
    $${PWD}/flyem/zfileparser.cpp \
@@ -317,15 +328,19 @@ SOURCES +=$${PWD}/zstackprocessor.cpp \
    $${PWD}/zhdf5reader.cpp \
    $${PWD}/neutubeconfig.cpp \
    $${PWD}/zhdf5writer.cpp \
+   $${PWD}/zhdf5blockiterator.cpp \
+   $${PWD}/zlabelmap.cpp \
    $${PWD}/flyem/zbcfset.cpp \
    $${PWD}/zstackskeletonizer.cpp \
    $${PWD}/zswclayerfeatureanalyzer.cpp \
    $${PWD}/flyem/zflyemneuron.cpp \
+   $${PWD}/flyem/zflyemneuronmodelcache.cpp \
    $${PWD}/zswctypetrunkanalyzer.cpp \
    $${PWD}/zobject3dscan.cpp \
    $${PWD}/zswclayershollfeatureanalyzer.cpp \
    $${PWD}/zswclayertrunkanalyzer.cpp \
    $${PWD}/zstackgraph.cpp \
+   $${PWD}/zstackpathfinder.cpp \
    $${PWD}/zgraphcompressor.cpp \
    $${PWD}/zprogressreporter.cpp \
    $${PWD}/zmessagereporter.cpp \
@@ -404,6 +419,10 @@ SOURCES +=$${PWD}/zstackprocessor.cpp \
    $${PWD}/zintset.cpp \
    $${PWD}/flyem/zflyemsubstackroi.cpp \
    $${PWD}/zstackwatershed.cpp \
+   $${PWD}/zstackobjectlabeler.cpp \
+   $${PWD}/zstackresampler.cpp \
+   $${PWD}/zstackslicepyramid.cpp \
+   $${PWD}/zincrementalwatershed.cpp \
    $${PWD}/zstackarray.cpp \
    $${PWD}/flyem/zflyemconfig.cpp \
    $${PWD}/geometry/zgeo3dtransform.cpp \
@@ -415,6 +434,7 @@ SOURCES +=$${PWD}/zstackprocessor.cpp \
    $${PWD}/bigdata/zstackblockgrid.cpp \
    $${PWD}/bigdata/zblockgrid.cpp \
    $${PWD}/bigdata/zblockgridfactory.cpp \
+   $${PWD}/bigdata/zchunkedstack.cpp \
    $${PWD}/zsparsestack.cpp \
    $${PWD}/zstackobject.cpp \
    $${PWD}/zobject3dfactory.cpp \
@@ -3,7 +3,8 @@ HEADERS += $${PWD}/zjsonparser.h \
    $${PWD}/zjsonvalue.h \
    $${PWD}/c_json.h \
    $${PWD}/zjsonarray.h \
-   $${PWD}/zjsonfactory.h
+   $${PWD}/zjsonfactory.h \
+   $${PWD}/zjsonstreamreader.h
 
 
 SOURCES += $${PWD}/zjsonparser.cpp \
@@ -11,4 +12,5 @@ SOURCES += $${PWD}/zjsonparser.cpp \
     $${PWD}/zjsonvalue.cpp \
     $${PWD}/c_json.cpp \
     $${PWD}/zjsonarray.cpp \
-    $${PWD}/zjsonfactory.cpp
+    $${PWD}/zjsonfactory.cpp \
+    $${PWD}/zjsonstreamreader.cpp
@@ -70,6 +70,7 @@
 #include "dialogs/ztestdialog.h"
 #include "dialogs/ztestdialog2.h"
 #include "dvid/libdvidheader.h"
+#include "dvid/zdvidblockcache.h"
 #include "dvid/zdvidbuffer.h"
 #include "dvid/zdvidclient.h"
 #include "dvid/zdvidfilter.h"
@@ -77,6 +78,8 @@
 #include "dvid/zdvidreader.h"
 #include "dvid/zdvidsparsestack.h"
 #include "dvid/zdvidtarget.h"
+#include "dvid/zdvidtilecache.h"
+#include "dvid/zdvidtransport.h"
 #include "dvid/zdvidtile.h"
 #include "dvid/zdvidwriter.h"
 #include "flyem/zflyembodyannotationdialog.h"
@@ -3307,6 +3310,10 @@ void MainWindow::on_actionAutosaved_Files_triggered() {
 void MainWindow::on_actionDiagnosis_triggered() {
   m_DiagnosisDlg->show();
   m_DiagnosisDlg->setVideoCardInfo(Z3DGpuInfoInstance.getGpuInfo());
+  m_DiagnosisDlg->setDvidMetrics(QString::fromStdString(
+        ZDvidTransport::getInstance().getMetricsReport() + "\n" +
+        ZDvidBlockCache::getInstance().getStatReport() + "\n" +
+        ZDvidTileCache::getInstance().getStatReport()));
   m_DiagnosisDlg->scrollToBottom();
   m_DiagnosisDlg->raise();
 }
@@ -27,6 +27,11 @@ int ZStackYZView::getDepth() const
   return 0;
 }
 
+bool ZStackYZView::isViewportCanvasEnabled() const
+{
+  return false;
+}
+
 void ZStackYZView::paintSingleChannelStackSlice(ZStack *stack, int slice)
 {
   switch (stack->kind()) {
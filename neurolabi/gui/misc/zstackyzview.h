@@ -19,6 +19,7 @@ public:
   template<typename T>
   void resetCanvasWithStack(T &canvas, ZPainter *painter);
   void updateImageCanvas();
+  bool isViewportCanvasEnabled() const;
 
 signals:
 
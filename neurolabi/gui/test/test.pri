@@ -5,6 +5,7 @@ HEADERS += \
     test/zswcpathtest.h \
     test/zgraphtest.h \
     test/zstackgraphtest.h \
+    test/zstackpathfindertest.h \
     test/zstringtest.h \
     test/zobject3dtest.h \
     test/zswcanalyzertest.h \
@@ -13,6 +14,7 @@ HEADERS += \
     test/zcuboidtest.h \
     test/zflyemqualitycontroltest.h \
     test/zflyemsynaseannotationtest.h \
+    test/zsynapsestoretest.h \
     test/zstackdoctest.h \
     test/ztreetest.h \
     test/zswctreematchertest.h \
@@ -21,10 +23,16 @@ HEADERS += \
     test/zhistogramtest.h \
     test/zflyemneuronrangetest.h \
     test/zflyemneuronfiltertest.h \
+    test/zflyemneuronmodelcachetest.h \
     test/zjsontest.h \
+    test/zjsonstreamreadertest.h \
     test/zswcmetrictest.h \
     test/zmatrixtest.h \
     test/zstacktest.h \
+    test/zstackwatershedtest.h \
+    test/zstackobjectlabelertest.h \
+    test/zstackresamplertest.h \
+    test/zstackslicepyramidtest.h \
     test/zswcgeneratortest.h \
     test/zflyemneuronimagefactorytest.h \
     test/zspgrowtest.h \
@@ -34,9 +42,15 @@ HEADERS += \
     test/zdocplayertest.h \
     test/zopenvdbtest.h \
     test/zdvidtest.h \
+    test/zdvidmockserver.h \
+    test/zteststack.h \
     test/zblockgridtest.h \
+    test/zchunkedstacktest.h \
+    test/zhdf5test.h \
+    test/zlabelmaptest.h \
     test/zsparsestacktest.h \
     test/zimagetest.h \
+    test/zincrementalwatershedtest.h \
     test/z3dgraphtest.h \
     test/zobject3dfactorytest.h \
     test/zdvidiotest.h \
@@ -44,6 +58,7 @@ HEADERS += \
     test/zclosedcurvetest.h \
     test/zarraytest.h \
     test/zflyembodymergertest.h \
+    test/zflyemconnectivitymatrixtest.h \
     test/zstackobjectgrouptest.h \
     test/ztestheader.h \
     test/zvoxelarraytest.h
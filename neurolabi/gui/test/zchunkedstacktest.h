@@ -0,0 +1,240 @@
+#ifndef ZCHUNKEDSTACKTEST_H
+#define ZCHUNKEDSTACKTEST_H
+
+#include <cstring>
+#include <cstdio>
+
+#include "ztestheader.h"
+#include "zteststack.h"
+#include "../zfspath.h"
+#include "neutubeconfig.h"
+#include "bigdata/zchunkedstack.h"
+#include "zstack.hxx"
+#include "c_stack.h"
+#include "zstring.h"
+
+#ifdef _USE_GTEST_
+
+static ZStack* MakeChunkedStackTestStack(int kind, int nchannel)
+{
+  ZStack *stack = new ZStack(kind, 37, 29, 11, nchannel);
+  stack->setOffset(5, -3, 2);
+  FillRandomTestArray(stack->array8(), kind,
+                      stack->getVoxelNumber() * nchannel);
+
+  return stack;
+}
+
+TEST(ZChunkedStack, io)
+{
+  ZStack *stack = MakeChunkedStackTestStack(GREY16, 2);
+  std::string filePath = (fs::path(GET_TEST_DATA_DIR) / "test.zck").string();
+  ASSERT_TRUE(ZChunkedStack::Write(filePath, *stack, 8, 8, 4));
+
+  ZChunkedStack chunkedStack;
+  ASSERT_FALSE(chunkedStack.open(filePath + ".none"));
+  ASSERT_TRUE(chunkedStack.open(filePath));
+  ASSERT_EQ(GREY16, chunkedStack.kind());
+  ASSERT_EQ(37, chunkedStack.width());
+  ASSERT_EQ(29, chunkedStack.height());
+  ASSERT_EQ(11, chunkedStack.depth());
+  ASSERT_EQ(2, chunkedStack.channelNumber());
+  ASSERT_TRUE(chunkedStack.getBoundBox().equals(stack->getBoundBox()));
+  ASSERT_EQ((size_t) 8 * 8 * 4 * 2, chunkedStack.getChunkByteNumber());
+
+  for (int c = 0; c < 2; ++c) {
+    for (int z = 0; z < stack->depth(); ++z) {
+      for (int y = 0; y < stack->height(); ++y) {
+        for (int x = 0; x < stack->width(); ++x) {
+          ASSERT_EQ(stack->value(x, y, z, c),
+                    chunkedStack.value(x + 5, y - 3, z + 2, c));
+        }
+      }
+    }
+  }
+  ASSERT_EQ(0.0, chunkedStack.value(4, 0, 2, 0));
+  ASSERT_EQ(0, chunkedStack.getIntValue(5, -3, 13, 0));
+  ASSERT_EQ(stack->getIntValue(10, 0, 5, 1),
+            chunkedStack.getIntValue(10, 0, 5, 1));
+
+  //Blocks partially out of the stack
+  ZIntCuboid box(0, 10, 4, 20, 40, 12);
+  ZStack *crop = chunkedStack.makeCrop(box);
+  ZStack *expectedCrop = stack->makeCrop(box);
+  ASSERT_TRUE(crop->getBoundBox().equals(expectedCrop->getBoundBox()));
+  for (int c = 0; c < 2; ++c) {
+    ASSERT_TRUE(Stack_Identical(expectedCrop->c_stack(c), crop->c_stack(c)));
+  }
+  delete crop;
+  delete expectedCrop;
+
+  Stack *slice = chunkedStack.readSlice(7, 1);
+  Stack expectedSlice = C_Stack::sliceView(stack->data(), 5, 1);
+  ASSERT_TRUE(Stack_Identical(&expectedSlice, slice));
+  C_Stack::kill(slice);
+
+  for (int c = 0; c < 2; ++c) {
+    const Stack *proj =
+        chunkedStack.projection(ZSingleChannelStack::MAX_PROJ, c);
+    ASSERT_EQ(0, memcmp(stack->projection(ZSingleChannelStack::MAX_PROJ,
+                                          ZSingleChannelStack::Z_AXIS, c),
+                        proj->array, stack->getByteNumber(ZStack::SINGLE_PLANE)));
+    proj = chunkedStack.projection(ZSingleChannelStack::MIN_PROJ, c);
+    ASSERT_EQ(0, memcmp(stack->projection(ZSingleChannelStack::MIN_PROJ,
+                                          ZSingleChannelStack::Z_AXIS, c),
+                        proj->array, stack->getByteNumber(ZStack::SINGLE_PLANE)));
+  }
+  ASSERT_EQ(stack->maxIntensityDepth(3, 4, 1),
+            chunkedStack.maxIntensityDepth(8, 1, 1));
+
+  chunkedStack.close();
+  ASSERT_FALSE(chunkedStack.isOpen());
+  ASSERT_EQ(0, (int) chunkedStack.getCacheUsage());
+
+  delete stack;
+  remove(filePath.c_str());
+}
+
+TEST(ZChunkedStack, cache)
+{
+  ZStack *stack = MakeChunkedStackTestStack(GREY, 1);
+  std::string filePath = (fs::path(GET_TEST_DATA_DIR) / "test.zck").string();
+  ASSERT_TRUE(ZChunkedStack::Write(filePath, *stack, 16, 16, 4));
+
+  ZChunkedStack chunkedStack;
+  ASSERT_TRUE(chunkedStack.open(filePath));
+  size_t chunkByteNumber = chunkedStack.getChunkByteNumber();
+
+  Stack *slice = chunkedStack.readSlice(2, 0);
+  C_Stack::kill(slice);
+  //A slice covers 3x2 chunks
+  ASSERT_EQ(chunkByteNumber * 6, chunkedStack.getCacheUsage());
+
+  chunkedStack.setCacheLimit(chunkByteNumber * 2);
+  ASSERT_EQ(chunkByteNumber * 2, chunkedStack.getCacheUsage());
+
+  //Voxel values are still correct after chunks are dropped
+  for (int z = 0; z < stack->depth(); ++z) {
+    for (int y = 0; y < stack->height(); ++y) {
+      for (int x = 0; x < stack->width(); ++x) {
+        ASSERT_EQ(stack->value(x, y, z),
+                  chunkedStack.value(x + 5, y - 3, z + 2, 0));
+      }
+    }
+  }
+  ASSERT_EQ(chunkByteNumber * 2, chunkedStack.getCacheUsage());
+
+  //The most recent chunk is kept even if it exceeds the limit
+  chunkedStack.setCacheLimit(1);
+  ASSERT_EQ(chunkByteNumber, chunkedStack.getCacheUsage());
+
+  chunkedStack.clearCache();
+  ASSERT_EQ(0, (int) chunkedStack.getCacheUsage());
+
+  delete stack;
+  remove(filePath.c_str());
+}
+
+TEST(ZChunkedStack, ZStack)
+{
+  ZStack *stack = MakeChunkedStackTestStack(GREY, 2);
+  std::string filePath = (fs::path(GET_TEST_DATA_DIR) / "test.zck").string();
+  ASSERT_TRUE(ZChunkedStack::Write(filePath, *stack, 10, 10, 3));
+
+  ZSharedPointer<ZChunkedStack> chunkedStack(new ZChunkedStack);
+  ASSERT_TRUE(chunkedStack->open(filePath));
+
+  ZStack chunkedData;
+  chunkedData.setChunkedData(chunkedStack);
+  ASSERT_TRUE(chunkedData.hasChunkedData());
+  ASSERT_TRUE(chunkedData.isVirtual());
+  ASSERT_EQ(chunkedStack.get(), chunkedData.getChunkedData());
+  ASSERT_TRUE(chunkedData.getBoundBox().equals(stack->getBoundBox()));
+
+  ASSERT_EQ(stack->value(3, 4, 5, 1), chunkedData.value(3, 4, 5, 1));
+  ASSERT_EQ(stack->value(3, 4, -1, 1), chunkedData.value(3, 4, -1, 1));
+  ASSERT_EQ(stack->getIntValue(8, 1, 7, 0), chunkedData.getIntValue(8, 1, 7, 0));
+  ASSERT_EQ(0, memcmp(stack->projection(ZSingleChannelStack::MAX_PROJ,
+                                        ZSingleChannelStack::Z_AXIS, 1),
+                      chunkedData.projection(ZSingleChannelStack::MAX_PROJ,
+                                             ZSingleChannelStack::Z_AXIS, 1),
+                      stack->getByteNumber(ZStack::SINGLE_PLANE)));
+  //Only the Z projection is available from chunked data
+  ASSERT_TRUE(chunkedData.projection(ZSingleChannelStack::MAX_PROJ,
+                                     ZSingleChannelStack::X_AXIS, 1) == NULL);
+
+  ZIntCuboid box(10, 0, 3, 30, 20, 9);
+  ZStack *crop = chunkedData.makeCrop(box);
+  ZStack *expectedCrop = stack->makeCrop(box);
+  ASSERT_TRUE(crop->hasData());
+  for (int c = 0; c < 2; ++c) {
+    ASSERT_TRUE(Stack_Identical(expectedCrop->c_stack(c), crop->c_stack(c)));
+  }
+  delete crop;
+
+  //Cropping in place loads the data into memory
+  chunkedData.crop(box);
+  ASSERT_FALSE(chunkedData.hasChunkedData());
+  ASSERT_TRUE(chunkedData.hasData());
+  ASSERT_TRUE(chunkedData.getBoundBox().equals(box));
+  for (int c = 0; c < 2; ++c) {
+    ASSERT_TRUE(
+          Stack_Identical(expectedCrop->c_stack(c), chunkedData.c_stack(c)));
+  }
+  delete expectedCrop;
+
+  ZStack loadedStack;
+  ASSERT_TRUE(loadedStack.load(filePath));
+  ASSERT_TRUE(loadedStack.hasChunkedData());
+  ASSERT_TRUE(loadedStack.getBoundBox().equals(stack->getBoundBox()));
+
+  delete stack;
+  remove(filePath.c_str());
+}
+
+TEST(ZChunkedStack, ConvertImageSeries)
+{
+  ZStack *stack = MakeChunkedStackTestStack(GREY, 1);
+  stack->setOffset(0, 0, 0);
+
+  std::vector<std::string> fileList;
+  for (int z = 0; z < stack->depth(); ++z) {
+    ZString fileName = "test_chunked_";
+    fileName.appendNumber(z, 3);
+    fileName += ".tif";
+    std::string slicePath =
+        (fs::path(GET_TEST_DATA_DIR) / fileName).string();
+    Stack slice = C_Stack::sliceView(stack->c_stack(0), z);
+    C_Stack::write(slicePath, &slice);
+    fileList.push_back(slicePath);
+  }
+
+  std::string filePath = (fs::path(GET_TEST_DATA_DIR) / "test.zck").string();
+  ASSERT_TRUE(ZChunkedStack::ConvertImageSeries(fileList, filePath, 16, 8, 4));
+
+  ZChunkedStack chunkedStack;
+  ASSERT_TRUE(chunkedStack.open(filePath));
+  ZStack *crop = chunkedStack.makeCrop(stack->getBoundBox());
+  ASSERT_TRUE(Stack_Identical(stack->c_stack(0), crop->c_stack(0)));
+  delete crop;
+
+  //Slices of different sizes cannot be converted
+  Stack *slice = C_Stack::make(GREY, 10, 10, 1);
+  C_Stack::setZero(slice);
+  C_Stack::write(fileList.back(), slice);
+  C_Stack::kill(slice);
+  ASSERT_FALSE(ZChunkedStack::ConvertImageSeries(
+                 fileList, filePath + "2", 16, 8, 4));
+
+  for (size_t i = 0; i < fileList.size(); ++i) {
+    remove(fileList[i].c_str());
+  }
+  remove(filePath.c_str());
+  remove((filePath + "2").c_str());
+
+  delete stack;
+}
+
+#endif
+
+#endif // ZCHUNKEDSTACKTEST_H
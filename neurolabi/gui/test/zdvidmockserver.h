@@ -0,0 +1,165 @@
+#ifndef ZDVIDMOCKSERVER_H
+#define ZDVIDMOCKSERVER_H
+
+#include <QThread>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QSemaphore>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QList>
+#include <QByteArray>
+
+/*!
+ * \brief A keep-alive HTTP server mocking the key-value API of DVID
+ *
+ * It runs in its own thread with blocking sockets and answers GET requests:
+ *   .../keys: a JSON array of the keys "1" to "<key number>"
+ *   .../keyrangevalues/...: a JSON object of all keys and their values
+ *   .../key/<key>: a JSON object as the value of the key
+ *   ...fail: 404
+ *   anything else: the path of the request
+ *
+ * Each response is sent after the latency set by setLatency() without
+ * blocking the other connections.
+ */
+class ZDvidMockServer : public QThread
+{
+public:
+  ZDvidMockServer() : m_port(0), m_latency(0), m_keyNumber(0) {
+  }
+
+  ~ZDvidMockServer() {
+    stop();
+  }
+
+  //Must be called before startListening()
+  void setLatency(int latency) { m_latency = latency; }
+  void setKeyNumber(int n) { m_keyNumber = n; }
+
+  bool startListening() {
+    start();
+    m_ready.acquire();
+
+    return m_port > 0;
+  }
+
+  void stop() {
+    m_stopping.storeRelease(1);
+    wait();
+  }
+
+  int getPort() const { return m_port; }
+  int getConnectionCount() const { return m_connectionCount.loadAcquire(); }
+  int getRequestCount() const { return m_requestCount.loadAcquire(); }
+
+protected:
+  void run() {
+    QTcpServer server;
+    if (server.listen(QHostAddress::LocalHost, 0)) {
+      m_port = server.serverPort();
+    }
+    m_ready.release();
+
+    QElapsedTimer clock;
+    clock.start();
+
+    QList<QTcpSocket*> socketList;
+    QList<QByteArray> bufferList;
+    QList<PendingResponse> pendingList;
+    while (m_port > 0 && m_stopping.loadAcquire() == 0) {
+      if (server.waitForNewConnection(1)) {
+        while (server.hasPendingConnections()) {
+          socketList.append(server.nextPendingConnection());
+          bufferList.append(QByteArray());
+          m_connectionCount.fetchAndAddOrdered(1);
+        }
+      }
+
+      for (int i = 0; i < socketList.size(); ++i) {
+        QTcpSocket *socket = socketList[i];
+        socket->waitForReadyRead(0);
+        bufferList[i].append(socket->readAll());
+        int headerEnd = bufferList[i].indexOf("\r\n\r\n");
+        while (headerEnd >= 0) {
+          QByteArray header = bufferList[i].left(headerEnd);
+          bufferList[i].remove(0, headerEnd + 4);
+          QList<QByteArray> requestLine =
+              header.left(header.indexOf("\r\n")).split(' ');
+          m_requestCount.fetchAndAddOrdered(1);
+
+          PendingResponse response;
+          response.socket = socket;
+          response.time = clock.elapsed() + m_latency;
+          response.data = makeResponse(
+                requestLine.size() > 1 ? requestLine[1] : QByteArray());
+          pendingList.append(response);
+          headerEnd = bufferList[i].indexOf("\r\n\r\n");
+        }
+      }
+
+      //Responses of a connection are sent in the order of the requests
+      while (!pendingList.isEmpty() &&
+             pendingList.front().time <= clock.elapsed()) {
+        PendingResponse response = pendingList.takeFirst();
+        response.socket->write(response.data);
+        response.socket->waitForBytesWritten(1000);
+      }
+    }
+
+    qDeleteAll(socketList);
+  }
+
+private:
+  struct PendingResponse {
+    QTcpSocket *socket;
+    qint64 time;
+    QByteArray data;
+  };
+
+  QByteArray makeResponse(const QByteArray &path) const {
+    QByteArray body = path;
+    int queryStart = path.indexOf('?');
+    QByteArray command = (queryStart < 0) ? path : path.left(queryStart);
+    if (command.endsWith("/keys")) {
+      body = "[";
+      for (int i = 1; i <= m_keyNumber; ++i) {
+        body += (i > 1 ? ", \"" : "\"") + QByteArray::number(i) + "\"";
+      }
+      body += "]";
+    } else if (command.contains("/keyrangevalues/")) {
+      body = "{";
+      for (int i = 1; i <= m_keyNumber; ++i) {
+        body += (i > 1 ? ", \"" : "\"") + QByteArray::number(i) + "\": " +
+            makeValue(QByteArray::number(i));
+      }
+      body += "}";
+    } else if (command.contains("/key/")) {
+      body = makeValue(command.mid(command.lastIndexOf('/') + 1));
+    }
+
+    QByteArray response = command.endsWith("fail") ?
+          "HTTP/1.1 404 Not Found\r\n" : "HTTP/1.1 200 OK\r\n";
+    response += "Content-Type: application/octet-stream\r\n";
+    response += "Connection: keep-alive\r\n";
+    response += "Content-Length: " + QByteArray::number(body.size()) +
+        "\r\n\r\n" + body;
+
+    return response;
+  }
+
+  static QByteArray makeValue(const QByteArray &key) {
+    return "{\"body ID\": " + key + ", \"status\": \"Traced\"}";
+  }
+
+private:
+  int m_port;
+  int m_latency;
+  int m_keyNumber;
+  QSemaphore m_ready;
+  QAtomicInt m_stopping;
+  QAtomicInt m_connectionCount;
+  QAtomicInt m_requestCount;
+};
+
+#endif // ZDVIDMOCKSERVER_H
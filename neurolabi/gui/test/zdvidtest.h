@@ -11,6 +11,11 @@
 #include "dvid/zdvidreader.h"
 #include "dvid/zdvidurl.h"
 #include "dvid/zdviddata.h"
+#include "dvid/zdvidtransport.h"
+#include "dvid/zdvidblockcache.h"
+#include "dvid/zdvidtilecache.h"
+#include "dvid/zdvidbufferreader.h"
+#include "zdvidmockserver.h"
 
 #ifdef _USE_GTEST_
 
@@ -182,6 +187,8 @@ TEST(ZDvidTest, ZDvidUrl)
             dvidUrl.getAllKeyUrl("test"));
   ASSERT_EQ("http://emdata.janelia.org/api/node/bf1/test/keyrange/1/3",
             dvidUrl.getKeyRangeUrl("test", "1", "3"));
+  ASSERT_EQ("http://emdata.janelia.org/api/node/bf1/test/keyrangevalues/1/3?json=true",
+            dvidUrl.getKeyRangeValueUrl("test", "1", "3"));
 
   ASSERT_EQ("http://emdata.janelia.org/api/node/bf1/annotations",
             dvidUrl.getBodyAnnotationUrl("bodies"));
@@ -256,6 +263,242 @@ TEST(ZDvidTest, ZDvidUrl)
 //  static std::string GetEndPoint(const std::string &url);
 }
 
+TEST(ZDvidTest, ZDvidTransport)
+{
+  ASSERT_EQ("grayscale/raw", ZDvidTransport::GetEndpoint(
+              "http://emdata.janelia.org:8000/api/node/3456/grayscale/raw/"
+              "0_1/512_256/0_0_100"));
+  ASSERT_EQ("bodies/sparsevol", ZDvidTransport::GetEndpoint(
+              "http://127.0.0.1:8000/api/node/3456/bodies/sparsevol/1?minz=1"));
+  ASSERT_EQ("keyvalue/key", ZDvidTransport::GetEndpoint(
+              "127.0.0.1/api/node/3456/keyvalue/key"));
+  ASSERT_EQ("repos/info", ZDvidTransport::GetEndpoint(
+              "http://127.0.0.1:8000/api/repos/info"));
+
+  ASSERT_EQ(0, ZDvidRequestStat::GetLatencyBin(0.5));
+  ASSERT_EQ(0, ZDvidRequestStat::GetLatencyBin(1.0));
+  ASSERT_EQ(1, ZDvidRequestStat::GetLatencyBin(1.5));
+  ASSERT_EQ(4, ZDvidRequestStat::GetLatencyBin(10.0));
+  ASSERT_EQ(ZDvidRequestStat::LATENCY_BIN_NUMBER - 1,
+            ZDvidRequestStat::GetLatencyBin(1e9));
+
+  ZDvidRequestStat stat;
+  ASSERT_EQ(0.0, stat.getMeanLatency());
+  stat.addRequest(100, 1.0, true);
+  stat.addRequest(200, 3.0, true);
+  stat.addRequest(0, 100.0, false);
+  ASSERT_EQ(3, stat.getCount());
+  ASSERT_EQ(1, stat.getErrorCount());
+  ASSERT_EQ(300, (int) stat.getByteCount());
+  ASSERT_DOUBLE_EQ(104.0 / 3.0, stat.getMeanLatency());
+  ASSERT_DOUBLE_EQ(100.0, stat.getMaxLatency());
+  ASSERT_DOUBLE_EQ(4.0, stat.getLatencyPercentile(0.5));
+  ASSERT_DOUBLE_EQ(100.0, stat.getLatencyPercentile(1.0));
+
+  ZDvidTransport &transport = ZDvidTransport::getInstance();
+  transport.resetMetrics();
+  transport.recordRequest(
+        "http://127.0.0.1:8000/api/node/3456/grayscale/raw/0_1/2_2/0_0_0",
+        4, 2.0, true);
+  transport.recordRequest(
+        "http://127.0.0.1:8000/api/node/3456/grayscale/raw/0_1/2_2/0_0_1",
+        4, 6.0, true);
+  ASSERT_EQ(1, (int) transport.getEndpointList().size());
+  ZDvidRequestStat rawStat = transport.getRequestStat("grayscale/raw");
+  ASSERT_EQ(2, rawStat.getCount());
+  ASSERT_EQ(8, (int) rawStat.getByteCount());
+  ASSERT_DOUBLE_EQ(4.0, rawStat.getMeanLatency());
+  ASSERT_EQ(0, transport.getRequestStat("labels/raw").getCount());
+  transport.resetMetrics();
+  ASSERT_TRUE(transport.getEndpointList().empty());
+}
+
+#if !defined(_ENABLE_LIBDVIDCPP_)
+TEST(ZDvidTest, readBatch)
+{
+  ZDvidMockServer server;
+  ASSERT_TRUE(server.startListening());
+
+  QString prefix = QString("http://127.0.0.1:%1/api/node/3456/grayscale/raw/").
+      arg(server.getPort());
+  QStringList urlList;
+  for (int i = 0; i < 20; ++i) {
+    urlList.append(prefix + QString::number(i));
+  }
+
+  ZDvidTransport &transport = ZDvidTransport::getInstance();
+  transport.resetMetrics();
+
+  ZDvidBufferReader reader;
+  QList<QByteArray> result = reader.readBatch(urlList);
+  ASSERT_EQ(ZDvidBufferReader::READ_OK, reader.getStatus());
+  ASSERT_EQ(20, result.size());
+  for (int i = 0; i < result.size(); ++i) {
+    ASSERT_EQ(QUrl(urlList[i]).path().toLatin1(), result[i]);
+  }
+  ASSERT_EQ(20, server.getRequestCount());
+  ASSERT_EQ(20, transport.getRequestStat("grayscale/raw").getCount());
+
+  int connectionCount = server.getConnectionCount();
+  ASSERT_LE(1, connectionCount);
+  ASSERT_GE((int) ZDvidBufferReader::MAX_BATCH_REQUEST_NUMBER,
+            connectionCount);
+
+  //Another reader in the same thread reuses the connections
+  ZDvidBufferReader reader2;
+  result = reader2.readBatch(urlList);
+  ASSERT_EQ(ZDvidBufferReader::READ_OK, reader2.getStatus());
+  ASSERT_EQ(40, server.getRequestCount());
+  ASSERT_EQ(connectionCount, server.getConnectionCount());
+
+  QStringList failedList;
+  failedList.append(prefix + "1");
+  failedList.append(prefix + "fail");
+  result = reader.readBatch(failedList);
+  ASSERT_EQ(ZDvidBufferReader::READ_FAILED, reader.getStatus());
+  ASSERT_EQ(2, result.size());
+  ASSERT_FALSE(result[0].isEmpty());
+  ASSERT_TRUE(result[1].isEmpty());
+  ASSERT_EQ(1, transport.getRequestStat("grayscale/fail").getErrorCount());
+
+  transport.resetMetrics();
+  server.stop();
+}
+#endif
+
+TEST(ZDvidTest, ZDvidBlockCache)
+{
+  ZIntCuboid box1(0, 0, 0, 1, 1, 1);
+  ZIntCuboid box2(2, 0, 0, 3, 1, 1);
+  ZIntCuboid box3(4, 0, 0, 5, 1, 1);
+  ASSERT_EQ("1234/grayscale/0/0_0_0_2_2_2",
+            ZDvidBlockCache::GetKey("1234", "grayscale", box1));
+  ASSERT_EQ("1234/grayscale/1/2_0_0_2_2_2",
+            ZDvidBlockCache::GetKey("1234", "grayscale", box2, 1));
+
+  ZDvidBlockCache &cache = ZDvidBlockCache::getInstance();
+  QString oldDir = cache.getDiskDir();
+  cache.setDiskDir("");
+  cache.setMemoryLimit(16);
+  cache.clear();
+  cache.resetStat();
+
+  std::string key1 = ZDvidBlockCache::GetKey("1234", "grayscale", box1);
+  std::string key2 = ZDvidBlockCache::GetKey("1234", "grayscale", box2);
+  std::string key3 = ZDvidBlockCache::GetKey("1234", "labels", box3);
+
+  QByteArray data;
+  ASSERT_FALSE(cache.get(key1, &data));
+  cache.put(key1, QByteArray("12345678"));
+  cache.put(key2, QByteArray("abcdefgh"));
+  ASSERT_TRUE(cache.get(key1, &data));
+  ASSERT_EQ(QByteArray("12345678"), data);
+  ASSERT_EQ(16, (int) cache.getMemoryUsage());
+
+  //key2 is the least recently used
+  cache.put(key3, QByteArray("ABCDEFGH"));
+  ASSERT_FALSE(cache.get(key2, &data));
+  ASSERT_TRUE(cache.get(key1, &data));
+  ASSERT_TRUE(cache.get(key3, &data));
+  ASSERT_EQ(1, cache.getEvictionCount());
+  ASSERT_EQ(3, cache.getMemoryHitCount());
+  ASSERT_EQ(2, cache.getMissCount());
+
+  cache.clear();
+  ASSERT_FALSE(cache.get(key1, &data));
+  ASSERT_EQ(0, (int) cache.getMemoryUsage());
+
+  //Disk tier
+  std::string diskDir =
+      (fs::path(GET_TEST_DATA_DIR) / "_test_dvid_block_cache").string();
+  cache.setDiskDir(diskDir.c_str());
+  cache.clear();
+  cache.resetStat();
+  cache.put(key1, QByteArray("12345678"));
+  cache.put(key2, QByteArray("abcdefgh"));
+  cache.put(key3, QByteArray("ABCDEFGH"));
+  ASSERT_EQ(24, (int) cache.getDiskUsage());
+  ASSERT_TRUE(cache.get(key1, &data));
+  ASSERT_EQ(QByteArray("12345678"), data);
+  ASSERT_EQ(1, cache.getDiskHitCount());
+
+  //Reload the index from the disk
+  cache.setDiskDir(diskDir.c_str());
+  ASSERT_EQ(24, (int) cache.getDiskUsage());
+  ASSERT_TRUE(cache.get(key2, &data));
+  ASSERT_EQ(QByteArray("abcdefgh"), data);
+
+  //Evicted files are removed from the disk
+  cache.setDiskLimit(8);
+  ASSERT_EQ(8, (int) cache.getDiskUsage());
+  cache.setDiskDir(diskDir.c_str());
+  ASSERT_EQ(8, (int) cache.getDiskUsage());
+  cache.setDiskLimit((size_t) 2 * 1024 * 1024 * 1024);
+
+  cache.clear();
+  cache.setMemoryLimit(256 * 1024 * 1024);
+  cache.setDiskDir(oldDir);
+  cache.resetStat();
+}
+
+TEST(ZDvidTest, ZDvidTileCache)
+{
+  ASSERT_EQ("1234/tiles/1/2_3_4",
+            ZDvidTileCache::GetKey("1234", "tiles", 1, 2, 3, 4));
+
+  ZDvidTileCache &cache = ZDvidTileCache::getInstance();
+  size_t oldLimit = cache.getMemoryLimit();
+  cache.clear();
+  cache.resetStat();
+
+  //Each tile takes 256 bytes
+  QImage image1(8, 8, QImage::Format_RGB32);
+  image1.fill(qRgb(1, 1, 1));
+  QImage image2(8, 8, QImage::Format_RGB32);
+  image2.fill(qRgb(2, 2, 2));
+  QImage image3(8, 8, QImage::Format_RGB32);
+  image3.fill(qRgb(3, 3, 3));
+  cache.setMemoryLimit(512);
+
+  std::string key1 = ZDvidTileCache::GetKey("1234", "tiles", 0, 0, 0, 1);
+  std::string key2 = ZDvidTileCache::GetKey("1234", "tiles", 0, 0, 0, 2);
+  std::string key3 = ZDvidTileCache::GetKey("1234", "tiles", 0, 0, 0, 3);
+
+  QImage image;
+  ASSERT_FALSE(cache.get(key1, &image));
+  cache.put(key1, image1);
+  cache.put(key2, image2);
+  ASSERT_TRUE(cache.get(key1, &image));
+  ASSERT_EQ(1, qRed(image.pixel(3, 4)));
+  ASSERT_EQ(512, (int) cache.getMemoryUsage());
+
+  //key2 is the least recently used; contains() does not change the order
+  ASSERT_TRUE(cache.contains(key2));
+  cache.put(key3, image3);
+  ASSERT_FALSE(cache.contains(key2));
+  ASSERT_TRUE(cache.get(key3, &image));
+  ASSERT_EQ(3, qRed(image.pixel(0, 0)));
+  ASSERT_EQ(1, cache.getEvictionCount());
+  ASSERT_EQ(2, cache.getHitCount());
+  ASSERT_EQ(1, cache.getMissCount());
+
+  //Cached images are not affected by changes of their copies
+  image.setPixel(0, 0, qRgb(5, 5, 5));
+  ASSERT_TRUE(cache.get(key3, &image));
+  ASSERT_EQ(3, qRed(image.pixel(0, 0)));
+
+  //Null images are not cached
+  cache.put(key2, QImage());
+  ASSERT_FALSE(cache.contains(key2));
+
+  cache.clear();
+  ASSERT_FALSE(cache.contains(key1));
+  ASSERT_EQ(0, (int) cache.getMemoryUsage());
+
+  cache.setMemoryLimit(oldLimit);
+  cache.resetStat();
+}
+
 #endif
 
 #endif // ZDVIDTEST_H
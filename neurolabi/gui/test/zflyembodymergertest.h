@@ -70,6 +70,81 @@ TEST(ZFlyEmBodyMerger, Json)
 
 }
 
+static uint64_t MapLabelInOrder(
+    const QList<ZFlyEmBodyMerger::TLabelMap> &mapList, uint64_t label)
+{
+  for (QList<ZFlyEmBodyMerger::TLabelMap>::const_iterator iter =
+       mapList.begin(); iter != mapList.end(); ++iter) {
+    if (iter->contains(label)) {
+      label = (*iter)[label];
+    }
+  }
+
+  return label;
+}
+
+TEST(ZFlyEmBodyMerger, History)
+{
+  ZFlyEmBodyMerger merger;
+  ZFlyEmBodyMerger::TLabelMap labelMap;
+
+  //Swapping labels in one map
+  labelMap[1] = 2;
+  labelMap[2] = 1;
+  merger.pushMap(labelMap);
+  ASSERT_EQ(2, (int) merger.getFinalLabel(1));
+  ASSERT_EQ(1, (int) merger.getFinalLabel(2));
+
+  //Mapping a label that no body has any more
+  merger.pushMap(3, 4);
+  merger.pushMap(3, 5);
+  ASSERT_EQ(4, (int) merger.getFinalLabel(3));
+  ASSERT_EQ(2, (int) merger.getOriginalLabelSet(4).size());
+  ASSERT_EQ(1, (int) merger.getOriginalLabelSet(5).size());
+  ASSERT_TRUE(merger.isMerged(3));
+  ASSERT_FALSE(merger.isMerged(6));
+
+  merger.clear();
+  ASSERT_EQ(3, (int) merger.getFinalLabel(3));
+
+  srand(1);
+  QList<ZFlyEmBodyMerger::TLabelMap> mapList;
+  for (int i = 0; i < 2000; ++i) {
+    labelMap.clear();
+    int n = rand() % 3 + 1;
+    for (int j = 0; j < n; ++j) {
+      labelMap[rand() % 500 + 1] = rand() % 500 + 1;
+    }
+    merger.pushMap(labelMap);
+    mapList.append(labelMap);
+
+    if (i % 100 == 99) {
+      merger.undo();
+      mapList.removeLast();
+      if (i % 200 == 199) {
+        merger.redo();
+        mapList.append(labelMap);
+      }
+    }
+  }
+
+  ZFlyEmBodyMerger::TLabelMap finalMap = merger.getFinalMap();
+  for (uint64_t label = 0; label <= 501; ++label) {
+    uint64_t finalLabel = MapLabelInOrder(mapList, label);
+    ASSERT_EQ(finalLabel, merger.getFinalLabel(label));
+
+    QSet<uint64_t> expectedSet;
+    expectedSet.insert(label);
+    for (ZFlyEmBodyMerger::TLabelMap::const_iterator iter = finalMap.begin();
+         iter != finalMap.end(); ++iter) {
+      if (iter.value() == label) {
+        expectedSet.insert(iter.key());
+      }
+    }
+    ASSERT_EQ(expectedSet, merger.getOriginalLabelSet(label));
+  }
+}
+
 #endif
 
 #endif // ZFLYEMBODYMERGERTEST_H
@@ -0,0 +1,115 @@
+#ifndef ZFLYEMCONNECTIVITYMATRIXTEST_H
+#define ZFLYEMCONNECTIVITYMATRIXTEST_H
+
+#include <cstdlib>
+#include <map>
+#include <fstream>
+
+#include "ztestheader.h"
+#include "neutubeconfig.h"
+#include "flyem/zflyemconnectivitymatrix.h"
+#include "flyem/zflyembodymerger.h"
+#include "flyem/zsynapseannotationarray.h"
+
+#ifdef _USE_GTEST_
+
+TEST(ZFlyEmConnectivityMatrix, basic)
+{
+  FlyEm::ZSynapseAnnotationArray synapseArray;
+  synapseArray.resize(3);
+  synapseArray[0].setTBar(1, 2, 3, 10, 0.9, "");
+  synapseArray[0].addPartner(4, 5, 6, 20, 0.5, "");
+  synapseArray[0].addPartner(7, 8, 9, 20, 0.5, "");
+  synapseArray[0].addPartner(7, 8, 9, 10, 0.5, "");
+  synapseArray[0].addPartner(7, 8, 9, 0, 0.5, "");
+  synapseArray[1].setTBar(10, 11, 12, 20, 0.8, "");
+  synapseArray[1].addPartner(13, 14, 15, 30, 0.5, "");
+  synapseArray[2].setTBar(10, 11, 12, 30, 0.8, "");
+  synapseArray[2].addPartner(13, 14, 15, 10, 0.5, "");
+
+  ZFlyEmConnectivityMatrix matrix;
+  matrix.build(synapseArray);
+  ASSERT_EQ(3, (int) matrix.getBodyNumber());
+  ASSERT_EQ(3, (int) matrix.getNonzeroNumber());
+  ASSERT_EQ(4, (int) matrix.getConnectionNumber());
+  ASSERT_EQ(2, matrix.getConnection(10, 20));
+  ASSERT_EQ(0, matrix.getConnection(10, 10));
+  ASSERT_EQ(1, matrix.getConnection(20, 30));
+  ASSERT_EQ(1, matrix.getConnection(30, 10));
+  ASSERT_EQ(0, matrix.getConnection(20, 10));
+  ASSERT_EQ(0, matrix.getConnection(10, 0));
+  ASSERT_EQ(-1, matrix.getBodyIndex(0));
+
+  matrix.setExcludingSelfConnection(false);
+  matrix.build(synapseArray);
+  ASSERT_EQ(1, matrix.getConnection(10, 10));
+
+  //20 and 30 merged into 20
+  ZFlyEmBodyMerger merger;
+  merger.pushMap(30, 20);
+  matrix.setExcludingSelfConnection(true);
+  matrix.build(synapseArray, &merger);
+  ASSERT_EQ(2, (int) matrix.getBodyNumber());
+  ASSERT_EQ(2, matrix.getConnection(10, 20));
+  ASSERT_EQ(1, matrix.getConnection(20, 10));
+  ASSERT_EQ(0, matrix.getConnection(20, 20));
+  ASSERT_EQ(-1, matrix.getBodyIndex(30));
+
+  std::string filePath = GET_TEST_DATA_DIR + "/test.csv";
+  ASSERT_TRUE(matrix.exportCsv(filePath));
+  std::ifstream stream(filePath.c_str());
+  std::string line;
+  std::getline(stream, line);
+  ASSERT_EQ("10,20,2", line);
+  std::getline(stream, line);
+  ASSERT_EQ("20,10,1", line);
+  ASSERT_FALSE(std::getline(stream, line));
+}
+
+TEST(ZFlyEmConnectivityMatrix, random)
+{
+  srand(1);
+  FlyEm::ZSynapseAnnotationArray synapseArray;
+  synapseArray.resize(30000);
+  std::map<std::pair<int, int>, int> expected;
+  for (size_t i = 0; i < synapseArray.size(); ++i) {
+    int tbarId = rand() % 200;
+    synapseArray[i].setTBar(0, 0, 0, tbarId, 1.0, "");
+    int partnerNumber = rand() % 5;
+    for (int j = 0; j < partnerNumber; ++j) {
+      int psdId = rand() % 200;
+      synapseArray[i].addPartner(0, 0, 0, psdId, 1.0, "");
+      if (tbarId > 0 && psdId > 0 && tbarId != psdId) {
+        ++expected[std::pair<int, int>(tbarId, psdId)];
+      }
+    }
+  }
+
+  ZFlyEmConnectivityMatrix matrix;
+  matrix.setThreadNumber(3);
+  matrix.build(synapseArray);
+  ASSERT_EQ(expected.size(), matrix.getNonzeroNumber());
+  for (std::map<std::pair<int, int>, int>::const_iterator
+       iter = expected.begin(); iter != expected.end(); ++iter) {
+    ASSERT_EQ(iter->second,
+              matrix.getConnection(iter->first.first, iter->first.second));
+  }
+
+  std::string filePath = GET_TEST_DATA_DIR + "/test.bin";
+  ASSERT_TRUE(matrix.exportBinary(filePath));
+  ZFlyEmConnectivityMatrix matrix2;
+  ASSERT_TRUE(matrix2.importBinary(filePath));
+  ASSERT_EQ(matrix.getBodyIdArray(), matrix2.getBodyIdArray());
+  ASSERT_EQ(matrix.getNonzeroNumber(), matrix2.getNonzeroNumber());
+  for (size_t k = 0; k < matrix.getNonzeroNumber(); ++k) {
+    ASSERT_EQ(matrix.getColumn(k), matrix2.getColumn(k));
+    ASSERT_EQ(matrix.getWeight(k), matrix2.getWeight(k));
+  }
+
+  ASSERT_FALSE(matrix2.importBinary(GET_TEST_DATA_DIR + "/test.csv"));
+  ASSERT_EQ(0, (int) matrix2.getBodyNumber());
+}
+
+#endif
+
+#endif // ZFLYEMCONNECTIVITYMATRIXTEST_H
@@ -0,0 +1,130 @@
+#ifndef ZFLYEMNEURONMODELCACHETEST_H
+#define ZFLYEMNEURONMODELCACHETEST_H
+
+#include "ztestheader.h"
+#include "zswctree.h"
+#include "zcuboid.h"
+#include "zstring.h"
+#include "flyem/zflyemdatabundle.h"
+#include "flyem/zflyemneuronmodelcache.h"
+#include "flyem/zflyemneuronpager.h"
+
+#ifdef _USE_GTEST_
+
+TEST(ZFlyEmNeuronModelCache, trim)
+{
+  ZFlyEmNeuronModelCache cache;
+
+  ZFlyEmNeuron neuronArray[4];
+  for (int i = 0; i < 4; ++i) {
+    neuronArray[i].setId((int) i + 1);
+    neuronArray[i].setUnscaledModel(
+          ZSwcTree::CreateCuboidSwc(ZCuboid(0, 0, 0, 10, 10, 10)));
+    neuronArray[i].setModelCache(&cache);
+  }
+
+  ASSERT_EQ(4, (int) cache.getNeuronNumber());
+  size_t neuronSize = neuronArray[0].getLoadedByteNumber();
+  ASSERT_LT(0, (int) neuronSize);
+  ASSERT_EQ(neuronSize * 4, cache.getByteUsage());
+
+  //Loading the scaled model updates the size
+  ASSERT_TRUE(neuronArray[0].getModel() != NULL);
+  ASSERT_EQ(neuronSize * 5, cache.getByteUsage());
+
+  //Least recently used first: neuron 3, neuron 4, neuron 1
+  cache.pin(&neuronArray[1]);
+  cache.setByteLimit(neuronSize * 3);
+  cache.trim();
+
+  ASSERT_EQ(2, (int) cache.getNeuronNumber());
+  ASSERT_EQ(2, cache.getEvictionCount());
+  ASSERT_FALSE(neuronArray[0].isDeprecated(ZFlyEmNeuron::MODEL));
+  ASSERT_FALSE(neuronArray[1].isDeprecated(ZFlyEmNeuron::UNSCALED_MODEL));
+  ASSERT_TRUE(neuronArray[2].isDeprecated(ZFlyEmNeuron::UNSCALED_MODEL));
+  ASSERT_TRUE(neuronArray[3].isDeprecated(ZFlyEmNeuron::UNSCALED_MODEL));
+
+  //Neuron 2 is pinned even though it is the least recently used one
+  cache.touch(&neuronArray[0]);
+  cache.setByteLimit(0);
+  cache.trim();
+  ASSERT_EQ(1, (int) cache.getNeuronNumber());
+  ASSERT_TRUE(neuronArray[0].isDeprecated(ZFlyEmNeuron::MODEL));
+  ASSERT_TRUE(neuronArray[0].isDeprecated(ZFlyEmNeuron::UNSCALED_MODEL));
+  ASSERT_FALSE(neuronArray[1].isDeprecated(ZFlyEmNeuron::UNSCALED_MODEL));
+
+  cache.unpin(&neuronArray[1]);
+  cache.trim();
+  ASSERT_EQ(0, (int) cache.getNeuronNumber());
+  ASSERT_TRUE(neuronArray[1].isDeprecated(ZFlyEmNeuron::UNSCALED_MODEL));
+
+  cache.clear();
+  ASSERT_EQ(0, (int) cache.getNeuronNumber());
+  ASSERT_EQ(0, (int) cache.getByteUsage());
+}
+
+TEST(ZFlyEmDataBundle, neuronIndex)
+{
+  ZFlyEmDataBundle bundle;
+  ZFlyEmNeuronArray &neuronArray = bundle.getNeuronArray();
+  neuronArray.resize(100);
+  for (size_t i = 0; i < neuronArray.size(); ++i) {
+    neuronArray[i].setId((int) i + 1);
+    neuronArray[i].setName("neuron" + ZString::num2str((int) i + 1));
+  }
+
+  ASSERT_EQ(50, bundle.getNeuron(50)->getId());
+  ASSERT_TRUE(bundle.getNeuron(101) == NULL);
+  ASSERT_EQ(7, bundle.getIdFromName("neuron7"));
+  ASSERT_TRUE(bundle.hasNeuronName("neuron100"));
+  ASSERT_FALSE(bundle.hasNeuronName("neuron101"));
+  ASSERT_EQ("neuron20", bundle.getName(20));
+
+  //Stale index is detected and rebuilt before reporting a miss
+  neuronArray[49].setId(1000);
+  neuronArray[49].setName("neuron1000");
+  ASSERT_TRUE(bundle.getNeuron(50) == NULL);
+  ASSERT_EQ(&(neuronArray[49]), bundle.getNeuron(1000));
+  neuronArray[50].setName("neuron2000");
+  ASSERT_EQ(51, bundle.getIdFromName("neuron2000"));
+  ASSERT_FALSE(bundle.hasNeuronName("neuron51"));
+
+  bundle.deprecate(ZFlyEmDataBundle::NEURON_INDEX);
+  ASSERT_EQ(1000, bundle.getNeuron(1000)->getId());
+
+  //The first one is taken for duplicated ids
+  bundle.getNeuronArray()[60].setId(1);
+  ASSERT_EQ(bundle.getNeuron(1), &(neuronArray[0]));
+}
+
+TEST(ZFlyEmNeuronPager, next)
+{
+  ZFlyEmDataBundle bundle;
+  ZFlyEmNeuronArray &neuronArray = bundle.getNeuronArray();
+  neuronArray.resize(20);
+  for (size_t i = 0; i < neuronArray.size(); ++i) {
+    neuronArray[i].setId((int) i + 1);
+    neuronArray[i].setUnscaledModel(
+          ZSwcTree::CreateCuboidSwc(ZCuboid(0, 0, 0, 10, 10, 10)));
+  }
+
+  bundle.getModelCache().setByteLimit(0);
+
+  ZFlyEmNeuronPager pager(&bundle);
+  pager.setPrefetchNumber(3);
+  int count = 0;
+  while (pager.hasNext()) {
+    ZFlyEmNeuron *neuron = pager.next();
+    ASSERT_EQ(++count, neuron->getId());
+    ASSERT_TRUE(neuron->getModel() != NULL);
+    //Only the current neuron and the prefetched ones are kept
+    ASSERT_GE(4, (int) bundle.getModelCache().getNeuronNumber());
+  }
+  ASSERT_EQ(20, count);
+  ASSERT_TRUE(pager.next() == NULL);
+  ASSERT_TRUE(neuronArray[0].isDeprecated(ZFlyEmNeuron::UNSCALED_MODEL));
+}
+
+#endif
+
+#endif // ZFLYEMNEURONMODELCACHETEST_H
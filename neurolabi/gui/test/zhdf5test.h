@@ -0,0 +1,193 @@
+#ifndef ZHDF5TEST_H
+#define ZHDF5TEST_H
+
+#include "ztestheader.h"
+#include "../zfspath.h"
+#include "neutubeconfig.h"
+#include "zhdf5reader.h"
+#include "zhdf5writer.h"
+#include "zhdf5blockiterator.h"
+#include "zarray.h"
+#include "zstack.hxx"
+
+#if defined(_USE_GTEST_) && defined(_ENABLE_HDF5_)
+
+static ZArray* MakeHdf5TestArray(int depth, int height, int width)
+{
+  mylib::Dimn_Type dims[3];
+  dims[0] = depth;
+  dims[1] = height;
+  dims[2] = width;
+  ZArray *array = new ZArray(mylib::UINT32_TYPE, 3, dims);
+  uint32_t *data = array->getDataPointer<uint32_t>();
+  for (size_t i = 0; i < array->getElementNumber(); ++i) {
+    data[i] = i;
+  }
+
+  return array;
+}
+
+TEST(ZHdf5, Block)
+{
+  std::string filePath =
+      (fs::path(GET_TEST_DATA_DIR) / "test_block.h5").string();
+  remove(filePath.c_str());
+
+  ZArray *array = MakeHdf5TestArray(9, 13, 17);
+  std::vector<int> chunkDims(3, 4);
+
+  ZHdf5Writer writer;
+  ASSERT_TRUE(writer.open(filePath));
+  ASSERT_TRUE(writer.writeArray("/group/label", *array, chunkDims, 4));
+  writer.close();
+
+  ZHdf5Reader reader;
+  ASSERT_TRUE(reader.open(filePath));
+  std::vector<int> dims = reader.getDatasetDims("/group/label");
+  ASSERT_EQ(3, (int) dims.size());
+  ASSERT_EQ(9, dims[0]);
+  ASSERT_EQ(13, dims[1]);
+  ASSERT_EQ(17, dims[2]);
+  ASSERT_EQ(chunkDims, reader.getChunkDims("/group/label"));
+  ASSERT_EQ(mylib::UINT32_TYPE, reader.getValueType("/group/label"));
+
+  std::vector<int> start(3);
+  start[0] = 2;
+  start[1] = 10;
+  start[2] = -1;
+  std::vector<int> count(3, 5);
+  ZArray *block = reader.readArrayBlock("/group/label", start, count);
+  ASSERT_TRUE(block != NULL);
+  //Clipped by the dataset
+  ASSERT_EQ(5, block->dim(0));
+  ASSERT_EQ(3, block->dim(1));
+  ASSERT_EQ(4, block->dim(2));
+  ASSERT_EQ(2, block->getStartCoordinate(0));
+  ASSERT_EQ(10, block->getStartCoordinate(1));
+  ASSERT_EQ(0, block->getStartCoordinate(2));
+  uint32_t *blockData = block->getDataPointer<uint32_t>();
+  ASSERT_EQ((uint32_t) (2 * 13 * 17 + 10 * 17), blockData[0]);
+  ASSERT_EQ((uint32_t) (6 * 13 * 17 + 12 * 17 + 3),
+            blockData[block->getElementNumber() - 1]);
+  delete block;
+
+  start[2] = 17;
+  ASSERT_TRUE(reader.readArrayBlock("/group/label", start, count) == NULL);
+
+  //Copy the dataset block by block. The iterator keeps the dataset open
+  //until it is destroyed.
+  {
+    ZHdf5BlockIterator iter(&reader, "/group/label");
+    ASSERT_EQ(chunkDims, iter.getBlockDims());
+    ASSERT_EQ((size_t) 3 * 4 * 5, iter.getBlockNumber());
+
+    std::vector<int> blockDims(3);
+    blockDims[0] = 5;
+    blockDims[1] = 1;
+    blockDims[2] = 100;
+    iter.setBlockDims(blockDims);
+    ASSERT_EQ(8, iter.getBlockDims()[0]);
+    ASSERT_EQ(4, iter.getBlockDims()[1]);
+    ASSERT_EQ(17, iter.getBlockDims()[2]);
+    ASSERT_EQ((size_t) 2 * 4, iter.getBlockNumber());
+
+    std::string copyPath =
+        (fs::path(GET_TEST_DATA_DIR) / "test_block_copy.h5").string();
+    remove(copyPath.c_str());
+    ASSERT_TRUE(writer.open(copyPath));
+    ASSERT_TRUE(writer.createDataset(
+                  "/copy", mylib::UINT32_TYPE, dims, iter.getBlockDims(), 1));
+    size_t blockNumber = 0;
+    int lastZ = 0;
+    while (iter.hasNext()) {
+      ZArray *block = iter.next();
+      ASSERT_TRUE(block != NULL);
+      ASSERT_LE(lastZ, block->getStartCoordinate(0));
+      lastZ = block->getStartCoordinate(0);
+      ASSERT_TRUE(writer.writeBlock("/copy", *block));
+      delete block;
+      ++blockNumber;
+    }
+    ASSERT_EQ(iter.getBlockNumber(), blockNumber);
+    ASSERT_TRUE(iter.next() == NULL);
+    writer.close();
+
+    ZHdf5Reader copyReader;
+    ASSERT_TRUE(copyReader.open(copyPath));
+    ASSERT_EQ(iter.getBlockDims(), copyReader.getChunkDims("/copy"));
+    mylib::Array *copy = copyReader.readArray("/copy");
+    ASSERT_TRUE(copy != NULL);
+    ASSERT_EQ(0, memcmp(array->getDataPointer<void>(), copy->data,
+                        array->getByteNumber()));
+    mylib::Kill_Array(copy);
+    remove(copyPath.c_str());
+  }
+
+  //Contiguous datasets are iterated slice by slice
+  mylib::Dimn_Type dims2[2] = {3, 7};
+  ZArray array2(mylib::UINT8_TYPE, 2, dims2);
+  reader.close();
+  ASSERT_TRUE(writer.open(filePath));
+  ASSERT_TRUE(writer.writeArray("/plain", array2, std::vector<int>(), 0));
+  writer.close();
+  ASSERT_TRUE(reader.open(filePath));
+  ZHdf5BlockIterator iter2(&reader, "/plain");
+  ASSERT_TRUE(reader.getChunkDims("/plain").empty());
+  ASSERT_EQ((size_t) 3, iter2.getBlockNumber());
+  ASSERT_EQ(7, iter2.getBlockDims()[1]);
+
+  delete array;
+  remove(filePath.c_str());
+}
+
+TEST(ZHdf5, Stack)
+{
+  std::string filePath =
+      (fs::path(GET_TEST_DATA_DIR) / "test_stack.h5").string();
+  remove(filePath.c_str());
+
+  ZStack stack(GREY16, 11, 7, 5, 2);
+  for (size_t i = 0; i < stack.getVoxelNumber() * 2; ++i) {
+    ((uint16_t*) stack.array8())[i] = i * 3;
+  }
+
+  ZHdf5Writer writer;
+  ASSERT_TRUE(writer.open(filePath));
+  ASSERT_TRUE(writer.writeStack("/stack", stack, 4, 4, 2, 4));
+  writer.close();
+
+  ZHdf5Reader reader;
+  ASSERT_TRUE(reader.open(filePath));
+  std::vector<int> dims = reader.getDatasetDims("/stack");
+  ASSERT_EQ(4, (int) dims.size());
+  ASSERT_EQ(2, dims[0]);
+  ASSERT_EQ(5, dims[1]);
+  ASSERT_EQ(7, dims[2]);
+  ASSERT_EQ(11, dims[3]);
+  ASSERT_EQ(mylib::UINT16_TYPE, reader.getValueType("/stack"));
+
+  std::vector<int> start(4, 0);
+  start[0] = 1;
+  start[1] = 2;
+  std::vector<int> count = dims;
+  count[0] = 1;
+  count[1] = 1;
+  ZArray *slice = reader.readArrayBlock("/stack", start, count);
+  ASSERT_TRUE(slice != NULL);
+  for (int y = 0; y < 7; ++y) {
+    for (int x = 0; x < 11; ++x) {
+      ASSERT_EQ(stack.getIntValue(x, y, 2, 1),
+                slice->getDataPointer<uint16_t>()[y * 11 + x]);
+    }
+  }
+  delete slice;
+
+  ZStack colorStack(COLOR, 3, 3, 3, 1);
+  reader.close();
+  ASSERT_TRUE(writer.open(filePath));
+  ASSERT_FALSE(writer.writeStack("/color", colorStack, 4, 4, 2, 4));
+}
+
+#endif
+
+#endif // ZHDF5TEST_H
@@ -0,0 +1,205 @@
+#ifndef ZINCREMENTALWATERSHEDTEST_H
+#define ZINCREMENTALWATERSHEDTEST_H
+
+#include "ztestheader.h"
+#include "zincrementalwatershed.h"
+#include "zstackwatershed.h"
+#include "zstack.hxx"
+#include "zstackarray.h"
+#include "tz_stack_relation.h"
+
+#ifdef _USE_GTEST_
+
+static ZStack* MakeIncrementalWatershedSeed(
+    int label, int x, int y, int z)
+{
+  ZStack *seed = new ZStack(GREY, 3, 3, 1, 1);
+  seed->setOffset(x - 1, y - 1, z);
+  for (size_t i = 0; i < seed->getVoxelNumber(); ++i) {
+    seed->array8()[i] = label;
+  }
+
+  return seed;
+}
+
+static bool IsSameAsStackWatershed(
+    const ZStack *result, const ZStack *stack, const ZStackArray &seedMask,
+    const Cuboid_I &range)
+{
+  ZStackWatershed engine;
+  engine.setRange(range);
+  ZStack *expected = engine.run(stack, seedMask);
+  bool isSame = Stack_Identical(result->c_stack(), expected->c_stack());
+  delete expected;
+
+  return isSame;
+}
+
+TEST(ZIncrementalWatershed, run)
+{
+  ZStack stack(GREY, 40, 30, 10, 1);
+  stack.setOffset(10, 20, 30);
+  uint8_t *array = stack.array8();
+  size_t offset = 0;
+  for (int z = 0; z < stack.depth(); ++z) {
+    for (int y = 0; y < stack.height(); ++y) {
+      for (int x = 0; x < stack.width(); ++x) {
+        //Wide plateaus to test the order of flooding
+        array[offset] = 50 + ((x / 2 + y / 3 + z) % 5) * 30;
+        if ((x * 31 + y * 17 + z * 3) % 23 == 0) {
+          array[offset] = 0;
+        }
+        ++offset;
+      }
+    }
+  }
+
+  ZStackArray seedMask;
+  int label = 1;
+  for (int y = 25; y < 50; y += 10) {
+    for (int x = 15; x < 50; x += 10) {
+      seedMask.push_back(
+            MakeIncrementalWatershedSeed(label, x, y, 32 + label % 6));
+      ++label;
+    }
+  }
+
+  Cuboid_I range;
+  Cuboid_I_Set_S(&range, 0, 0, 0, 0, 0, 0);
+
+  ZIncrementalWatershed engine;
+  ZStack *result = engine.run(&stack, seedMask);
+  ASSERT_TRUE(result != NULL);
+  ASSERT_FALSE(engine.isLastRunIncremental());
+  ASSERT_EQ(10, result->getOffset().getX());
+  ASSERT_EQ(20, result->getOffset().getY());
+  ASSERT_EQ(30, result->getOffset().getZ());
+  ASSERT_TRUE(IsSameAsStackWatershed(result, &stack, seedMask, range));
+  delete result;
+
+  //Add a seed
+  seedMask.push_back(MakeIncrementalWatershedSeed(label, 42, 37, 34));
+  result = engine.run(&stack, seedMask);
+  ASSERT_TRUE(engine.isLastRunIncremental());
+  ASSERT_TRUE(IsSameAsStackWatershed(result, &stack, seedMask, range));
+  delete result;
+
+  //Remove a seed
+  delete seedMask[1];
+  seedMask.erase(seedMask.begin() + 1);
+  result = engine.run(&stack, seedMask);
+  ASSERT_TRUE(engine.isLastRunIncremental());
+  ASSERT_TRUE(IsSameAsStackWatershed(result, &stack, seedMask, range));
+  delete result;
+
+  //Move a seed
+  seedMask[3]->setOffset(20, 33, 35);
+  result = engine.run(&stack, seedMask);
+  ASSERT_TRUE(IsSameAsStackWatershed(result, &stack, seedMask, range));
+  delete result;
+
+  //Nothing changed
+  result = engine.run(&stack, seedMask);
+  ASSERT_TRUE(engine.isLastRunIncremental());
+  ASSERT_EQ(0, engine.getLastResetBasinNumber());
+  delete result;
+
+  //A new signal needs a full run
+  ZStack *signal = stack.clone();
+  signal->array8()[100] = 255;
+  result = engine.run(signal, seedMask);
+  ASSERT_FALSE(engine.isLastRunIncremental());
+  ASSERT_TRUE(IsSameAsStackWatershed(result, signal, seedMask, range));
+  delete result;
+  delete signal;
+
+  //A signal changed in place needs clear()
+  stack.array8()[100] = 255;
+  engine.clear();
+  ASSERT_TRUE(engine.isEmpty());
+  result = engine.run(&stack, seedMask);
+  ASSERT_FALSE(engine.isLastRunIncremental());
+  ASSERT_TRUE(IsSameAsStackWatershed(result, &stack, seedMask, range));
+  delete result;
+
+  //Only the basins of the changed seed are flooded again
+  seedMask[0]->setOffset(16, 25, 33);
+  result = engine.run(&stack, seedMask);
+  ASSERT_TRUE(engine.isLastRunIncremental());
+  ASSERT_GT(stack.getVoxelNumber() / 2, engine.getLastFloodedVoxelNumber());
+  ASSERT_TRUE(IsSameAsStackWatershed(result, &stack, seedMask, range));
+  delete result;
+
+  Cuboid_I box;
+  Cuboid_I_Set_S(&box, 20, 25, 32, 10, 10, 5);
+  engine.setRange(box);
+  result = engine.run(&stack, seedMask);
+  ASSERT_FALSE(engine.isLastRunIncremental());
+  ASSERT_EQ(10, result->width());
+  ASSERT_EQ(20, result->getOffset().getX());
+  ASSERT_TRUE(IsSameAsStackWatershed(result, &stack, seedMask, box));
+  delete result;
+
+  //The state is not kept if it is too large
+  ASSERT_FALSE(engine.isEmpty());
+  ASSERT_LT(0, (int) engine.getStateSize());
+  engine.setMaxStateSize(engine.getStateSize() - 1);
+  result = engine.run(&stack, seedMask);
+  ASSERT_TRUE(engine.isEmpty());
+  delete result;
+}
+
+TEST(ZIncrementalWatershed, update)
+{
+  for (int kind = GREY; kind <= GREY16; ++kind) {
+    ZStack stack(kind, 60, 50, 8, 1);
+    srand(1);
+    for (size_t i = 0; i < stack.getVoxelNumber(); ++i) {
+      int value = (rand() % 6) * 40;
+      if (kind == GREY) {
+        stack.array8()[i] = value;
+      } else {
+        stack.array16()[i] = value * 100;
+      }
+    }
+
+    ZStackArray seedMask;
+    for (int label = 1; label <= 20; ++label) {
+      seedMask.push_back(MakeIncrementalWatershedSeed(
+                           label, rand() % 60, rand() % 50, rand() % 8));
+    }
+
+    Cuboid_I range;
+    Cuboid_I_Set_S(&range, 0, 0, 0, 0, 0, 0);
+
+    ZIncrementalWatershed engine;
+    for (int i = 0; i < 30; ++i) {
+      ZStack *result = engine.run(&stack, seedMask);
+      ASSERT_TRUE(IsSameAsStackWatershed(result, &stack, seedMask, range));
+      delete result;
+
+      //Move, add or remove a seed
+      int index = rand() % seedMask.size();
+      switch (rand() % 3) {
+      case 0:
+        seedMask[index]->setOffset(rand() % 60, rand() % 50, rand() % 8);
+        break;
+      case 1:
+        seedMask.push_back(MakeIncrementalWatershedSeed(
+                             rand() % 20 + 1, rand() % 60, rand() % 50,
+                             rand() % 8));
+        break;
+      default:
+        if (seedMask.size() > 1) {
+          delete seedMask[index];
+          seedMask.erase(seedMask.begin() + index);
+        }
+        break;
+      }
+    }
+  }
+}
+
+#endif
+
+#endif // ZINCREMENTALWATERSHEDTEST_H
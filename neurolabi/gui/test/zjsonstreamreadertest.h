@@ -0,0 +1,227 @@
+#ifndef ZJSONSTREAMREADERTEST_H
+#define ZJSONSTREAMREADERTEST_H
+
+#include <fstream>
+
+#include "ztestheader.h"
+#include "neutubeconfig.h"
+#include "zjsonstreamreader.h"
+#include "zjsonobject.h"
+#include "zjsonparser.h"
+#include "zgraph.h"
+#include "flyem/zsynapseannotationarray.h"
+
+#ifdef _USE_GTEST_
+
+TEST(ZJsonStreamReader, token)
+{
+  ZJsonStreamReader reader;
+  reader.openString(
+        "{\"a\": [1, -2.5e1, \"s\\\"\\u00e9\\ud83d\\ude00\", true, false, null],"
+        "\"b\": {}}");
+
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_START_OBJECT, reader.next());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_KEY, reader.peek());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_KEY, reader.next());
+  ASSERT_EQ("a", reader.getString());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_START_ARRAY, reader.next());
+  ASSERT_EQ(2, (int) reader.getDepth());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_NUMBER, reader.next());
+  ASSERT_TRUE(reader.isInteger());
+  ASSERT_EQ(1, reader.getInteger());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_NUMBER, reader.next());
+  ASSERT_FALSE(reader.isInteger());
+  ASSERT_DOUBLE_EQ(-25.0, reader.getNumber());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_STRING, reader.next());
+  ASSERT_EQ("s\"\xc3\xa9\xf0\x9f\x98\x80", reader.getString());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_TRUE, reader.next());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_FALSE, reader.next());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_NULL, reader.next());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_END_ARRAY, reader.next());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_KEY, reader.next());
+  ASSERT_EQ("b", reader.getString());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_START_OBJECT, reader.next());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_END_OBJECT, reader.next());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_END_OBJECT, reader.next());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_END, reader.next());
+  ASSERT_FALSE(reader.hasError());
+}
+
+TEST(ZJsonStreamReader, value)
+{
+  ZJsonStreamReader reader;
+  reader.openString("{\"skip\": {\"x\": [1, {\"y\": \"]\"}]},\n"
+                    "\"data\": [{\"id\": 1}, {\"id\": 2}, 3, [4]], \"n\": 5}");
+
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_START_OBJECT, reader.next());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_KEY, reader.next());
+  ASSERT_TRUE(reader.skipValue());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_KEY, reader.next());
+  ASSERT_EQ("data", reader.getString());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_START_ARRAY, reader.next());
+
+  int count = 0;
+  while (reader.hasNextElement()) {
+    ZJsonValue value = reader.readValue();
+    ++count;
+    if (count <= 2) {
+      ASSERT_TRUE(value.isObject());
+      ZJsonObject obj(value);
+      ASSERT_EQ(count, ZJsonParser::integerValue(obj["id"]));
+    } else if (count == 3) {
+      ASSERT_EQ(3, value.toInteger());
+    } else {
+      ASSERT_TRUE(value.isArray());
+    }
+  }
+  ASSERT_EQ(4, count);
+  ASSERT_EQ(1, (int) reader.getDepth());
+
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_KEY, reader.next());
+  ASSERT_EQ("n", reader.getString());
+  ASSERT_EQ(5, reader.readValue().toInteger());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_END_OBJECT, reader.next());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_END, reader.next());
+  ASSERT_FALSE(reader.hasError());
+
+  //Same as the value decoded from the whole text
+  std::string str = "{\"a\": [1, -2.5e1, \"s\\u00e9\", true, false, null, {}, []],"
+      "\"b\": {\"c\": {\"d\": [[1], [2, 3], {\"e\": \"f\"}]}}, \"g\": -0}";
+  reader.openString(str);
+  ZJsonValue value = reader.readValue();
+  ZJsonValue expected;
+  expected.decodeString(str.c_str());
+  ASSERT_TRUE(value.isObject());
+  ASSERT_EQ(expected.dumpString(0), value.dumpString(0));
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_END, reader.next());
+  ASSERT_FALSE(reader.hasError());
+}
+
+TEST(ZJsonStreamReader, error)
+{
+  ZJsonStreamReader reader;
+  reader.openString("[1, 2}");
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_START_ARRAY, reader.next());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_NUMBER, reader.next());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_NUMBER, reader.next());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_ERROR, reader.next());
+  ASSERT_TRUE(reader.hasError());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_ERROR, reader.next());
+
+  reader.openString("{\"a\": [1, 2");
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_START_OBJECT, reader.next());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_KEY, reader.next());
+  ASSERT_TRUE(reader.readValue().isEmpty());
+  ASSERT_TRUE(reader.hasError());
+
+  reader.openString("[\"abc");
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_START_ARRAY, reader.next());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_ERROR, reader.next());
+
+  reader.openString("[tru]");
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_START_ARRAY, reader.next());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_ERROR, reader.next());
+
+  reader.openString("[1.2.3]");
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_START_ARRAY, reader.next());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_ERROR, reader.next());
+
+  reader.openString("[\n\n?]");
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_START_ARRAY, reader.next());
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_ERROR, reader.next());
+  ASSERT_EQ(3, reader.getLineNumber());
+
+  reader.openString("[1, 99999999999999999999]");
+  ASSERT_EQ(ZJsonStreamReader::TOKEN_START_ARRAY, reader.next());
+  ASSERT_EQ(1, reader.readValue().toInteger());
+  ASSERT_TRUE(reader.readValue().isEmpty());
+  ASSERT_TRUE(reader.hasError());
+
+  //Missing or extra separators
+  const char *invalidArray[] = {
+    "[1 2]", "{\"a\" 1}", "[,,1]", "{\"a\"::1}", "[1,]", "{\"a\": 1,}",
+    "{\"a\": 1 \"b\": 2}", "{\"a\": 1,, \"b\": 2}", "{1: 2}", "[1: 2]",
+    "{\"a\", 1}", "{\"a\": }", "[1, [2] [3]]"
+  };
+  for (size_t i = 0; i < sizeof(invalidArray) / sizeof(invalidArray[0]); ++i) {
+    reader.openString(invalidArray[i]);
+    ASSERT_FALSE(reader.skipValue()) << invalidArray[i];
+    ASSERT_TRUE(reader.hasError()) << invalidArray[i];
+  }
+
+  const char *validArray[] = {
+    "[1, 2]", "{\"a\" : 1 , \"b\":[]}", "[]", "{}", " [ [ ] , { } ] ",
+    "[\",:\", {\"[,\": \"}:\"}]"
+  };
+  for (size_t i = 0; i < sizeof(validArray) / sizeof(validArray[0]); ++i) {
+    reader.openString(validArray[i]);
+    ASSERT_TRUE(reader.skipValue()) << validArray[i];
+    ASSERT_EQ(ZJsonStreamReader::TOKEN_END, reader.next()) << validArray[i];
+  }
+
+  ASSERT_FALSE(reader.open(GET_TEST_DATA_DIR + "/_not_exist_.json"));
+  ASSERT_TRUE(reader.hasError());
+}
+
+TEST(ZJsonStreamReader, synapse)
+{
+  std::string filePath = GET_TEST_DATA_DIR + "/test.json";
+  std::ofstream stream(filePath.c_str());
+  stream << "{\"metadata\": {\"description\": \"synapse annotations\", "
+            "\"file version\": 1}, \"data\": [";
+  for (int i = 0; i < 1000; ++i) {
+    if (i > 0) {
+      stream << ",\n";
+    }
+    stream << "{\"T-bar\": {\"status\": \"working\", \"confidence\": 1.0, "
+              "\"body ID\": " << i + 1 << ", \"location\": ["
+           << i << ", " << i * 2 << ", " << i * 3 << "]}, \"partners\": [";
+    for (int j = 0; j < i % 4; ++j) {
+      if (j > 0) {
+        stream << ", ";
+      }
+      stream << "{\"confidence\": 0.5, \"body ID\": " << i + j + 2
+             << ", \"location\": [" << j << ", 0, " << i << "]}";
+    }
+    stream << "]}";
+  }
+  stream << "]}";
+  stream.close();
+
+  FlyEm::ZSynapseAnnotationArray synapseArray;
+  ASSERT_TRUE(synapseArray.loadJsonStream(filePath));
+
+  ZJsonObject obj;
+  obj.load(filePath);
+  FlyEm::ZSynapseAnnotationArray domSynapseArray;
+  ASSERT_TRUE(domSynapseArray.loadJson(obj));
+
+  ASSERT_EQ(1000, (int) synapseArray.size());
+  ASSERT_EQ(domSynapseArray.size(), synapseArray.size());
+  ASSERT_EQ(domSynapseArray.metadataString(), synapseArray.metadataString());
+  for (size_t i = 0; i < synapseArray.size(); ++i) {
+    ASSERT_EQ(domSynapseArray[i].toString(), synapseArray[i].toString());
+  }
+
+  //Append mode
+  ASSERT_TRUE(synapseArray.loadJsonStream(
+                filePath, FlyEm::ZSynapseAnnotationArray::APPEND));
+  ASSERT_EQ(2000, (int) synapseArray.size());
+  ASSERT_EQ(2, (int) synapseArray.getTBarArray(1).size());
+  ASSERT_LT(1, synapseArray.getConnectionGraph()->getEdgeNumber());
+
+  //Reloading rebuilds the components made from the old synapses
+  stream.open(filePath.c_str());
+  stream << "{\"data\": [{\"T-bar\": {\"body ID\": 1, \"location\": [1, 2, 3]}, "
+            "\"partners\": [{\"body ID\": 2, \"location\": [4, 5, 6]}]}]}";
+  stream.close();
+  ASSERT_TRUE(synapseArray.loadJsonStream(filePath));
+  ASSERT_EQ(1, (int) synapseArray.size());
+  ASSERT_EQ(1, (int) synapseArray.getTBarArray(1).size());
+  ASSERT_TRUE(synapseArray.getTBarArray(3).empty());
+  ASSERT_EQ(1, synapseArray.getConnectionGraph()->getEdgeNumber());
+}
+
+#endif
+
+#endif // ZJSONSTREAMREADERTEST_H
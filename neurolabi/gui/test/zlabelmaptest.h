@@ -0,0 +1,83 @@
+#ifndef ZLABELMAPTEST_H
+#define ZLABELMAPTEST_H
+
+#include <cstdlib>
+
+#include "ztestheader.h"
+#include "zlabelmap.h"
+#include "tz_intpair_map.h"
+
+#ifdef _USE_GTEST_
+
+TEST(ZLabelMap, Basic)
+{
+  ZLabelMap labelMap;
+  ASSERT_TRUE(labelMap.isEmpty());
+  ASSERT_EQ(-1, labelMap.value(0));
+  ASSERT_FALSE(labelMap.contains(0));
+
+  ASSERT_TRUE(labelMap.add(0, 5));
+  ASSERT_TRUE(labelMap.add(100, -1));
+  ASSERT_TRUE(labelMap.add(1ULL << 40, 7));
+  ASSERT_TRUE(labelMap.add(~0ULL, 9));
+  ASSERT_EQ(4, (int) labelMap.size());
+
+  //The first value is kept
+  ASSERT_FALSE(labelMap.add(0, 6));
+  ASSERT_FALSE(labelMap.add(~0ULL, 10));
+  ASSERT_EQ(4, (int) labelMap.size());
+
+  ASSERT_EQ(5, labelMap.value(0));
+  ASSERT_EQ(-1, labelMap.value(100));
+  ASSERT_TRUE(labelMap.contains(100));
+  ASSERT_EQ(7, labelMap.value(1ULL << 40));
+  ASSERT_EQ(9, labelMap.value(~0ULL));
+  ASSERT_EQ(-1, labelMap.value(1));
+  ASSERT_FALSE(labelMap.contains(1));
+
+  //The key range is too large for a lookup table
+  ASSERT_FALSE(labelMap.optimizeLookup());
+
+  labelMap.clear();
+  ASSERT_TRUE(labelMap.isEmpty());
+  ASSERT_EQ(-1, labelMap.value(0));
+}
+
+TEST(ZLabelMap, Lookup)
+{
+  //Same results as Intpair_Map, with or without a lookup table
+  Intpair_Map *intpairMap = Make_Intpair_Map(1000);
+  ZLabelMap labelMap;
+  srand(1);
+  for (int i = 0; i < 5000; ++i) {
+    int key = rand() % 20000;
+    int value = rand() % 100000;
+    Intpair_Map_Add(intpairMap, 0, key, value);
+    labelMap.add(key, value);
+  }
+
+  for (int key = 0; key < 30000; ++key) {
+    ASSERT_EQ(Intpair_Map_Value(intpairMap, 0, key), labelMap.value(key));
+  }
+
+  ASSERT_TRUE(labelMap.optimizeLookup());
+  ASSERT_TRUE(labelMap.hasLookupTable());
+  ASSERT_TRUE(labelMap.add(25000, 3));
+  labelMap.add(19999, 4);
+  Intpair_Map_Add(intpairMap, 0, 25000, 3);
+  Intpair_Map_Add(intpairMap, 0, 19999, 4);
+
+  for (int key = 0; key < 30000; ++key) {
+    ASSERT_EQ(Intpair_Map_Value(intpairMap, 0, key), labelMap.value(key));
+  }
+
+  ASSERT_FALSE(labelMap.optimizeLookup(1000));
+  ASSERT_FALSE(labelMap.hasLookupTable());
+  ASSERT_EQ(3, labelMap.value(25000));
+
+  Kill_Intpair_Map(intpairMap);
+}
+
+#endif
+
+#endif // ZLABELMAPTEST_H
@@ -470,6 +470,114 @@ TEST(ZObject3dScan, downsample) {
   EXPECT_EQ(8, (int) obj.getVoxelNumber());
 }
 
+TEST(ZObject3dScan, pyramid)
+{
+  ZObject3dScan obj;
+  srand(1);
+  for (int z = 0; z < 40; ++z) {
+    for (int y = 0; y < 50; ++y) {
+      for (int x = 0; x < 100; x += 2 + rand() % 9) {
+        obj.addSegment(z, y, x, x + rand() % 3, false);
+      }
+    }
+  }
+  obj.canonize();
+
+  EXPECT_TRUE(obj.isDeprecated(ZObject3dScan::COMPONENT_PYRAMID));
+  EXPECT_EQ(&obj, obj.getPyramidLevel(0));
+  EXPECT_TRUE(obj.getPyramidLevel(-1) == NULL);
+  EXPECT_TRUE(obj.getPyramidLevel(ZObject3dScan::MAX_PYRAMID_LEVEL + 1) ==
+              NULL);
+
+  for (int level = 1; level <= 4; ++level) {
+    int intv = (1 << level) - 1;
+    ZObject3dScan expected = obj;
+    expected.downsampleMax(intv, intv, intv);
+    EXPECT_TRUE(expected.equalsLiterally(*obj.getPyramidLevel(level)));
+  }
+  EXPECT_FALSE(obj.isDeprecated(ZObject3dScan::COMPONENT_PYRAMID));
+
+  int intvArray[][3] = { {3, 3, 1}, {7, 7, 1}, {3, 3, 0}, {2, 2, 2},
+                         {5, 5, 5} };
+  for (size_t i = 0; i < sizeof(intvArray) / sizeof(intvArray[0]); ++i) {
+    ZObject3dScan expected = obj;
+    expected.downsampleMax(intvArray[i][0], intvArray[i][1], intvArray[i][2]);
+    EXPECT_TRUE(expected.equalsLiterally(
+                  obj.getDownsampledMax(
+                    intvArray[i][0], intvArray[i][1], intvArray[i][2])));
+  }
+
+  int level = obj.getPyramidLevelForVoxelNumber(
+        obj.getPyramidLevel(2)->getVoxelNumber());
+  EXPECT_GE(2, level);
+  EXPECT_LE(obj.getPyramidLevel(level)->getVoxelNumber(),
+            obj.getPyramidLevel(2)->getVoxelNumber());
+  EXPECT_EQ(0, obj.getPyramidLevelForVoxelNumber(obj.getVoxelNumber()));
+
+  //A change of the object invalidates the pyramid
+  obj.translate(100, 0, 0);
+  EXPECT_TRUE(obj.isDeprecated(ZObject3dScan::COMPONENT_PYRAMID));
+  EXPECT_EQ(50, obj.getPyramidLevel(1)->getBoundBox().getFirstCorner().getX());
+
+  ZObject3dScan obj2 = obj;
+  EXPECT_TRUE(obj2.isDeprecated(ZObject3dScan::COMPONENT_PYRAMID));
+
+  //So does downsampling
+  ZObject3dScan expected = obj;
+  expected.downsampleMax(3, 3, 3);
+  ZObject3dScan level1 = *obj.getPyramidLevel(1);
+  obj.downsampleMax(1, 1, 1);
+  EXPECT_TRUE(obj.isDeprecated(ZObject3dScan::COMPONENT_PYRAMID));
+  EXPECT_TRUE(level1.equalsLiterally(obj));
+  EXPECT_TRUE(expected.equalsLiterally(*obj.getPyramidLevel(1)));
+}
+
+TEST(ZObject3dScan, sliceRange)
+{
+  ZObject3dScan obj;
+  size_t start = 0;
+  size_t end = 0;
+  EXPECT_FALSE(obj.getSliceRange(0, &start, &end));
+
+  obj.addSegment(3, 1, 0, 2, false);
+  obj.addSegment(1, 2, 0, 2, false);
+  obj.addSegment(1, 0, 4, 5, false);
+  obj.addSegment(5, 0, 0, 2, false);
+  obj.addSegment(3, 0, 0, 2, false);
+  EXPECT_FALSE(obj.isCanonized());
+
+  ASSERT_TRUE(obj.getSliceRange(3, &start, &end));
+  EXPECT_TRUE(obj.isCanonized());
+  EXPECT_EQ(2, (int) start);
+  EXPECT_EQ(4, (int) end);
+  EXPECT_FALSE(obj.isDeprecated(ZObject3dScan::COMPONENT_SLICE_INDEX));
+  EXPECT_FALSE(obj.getSliceRange(2, &start, &end));
+  EXPECT_FALSE(obj.getSliceRange(6, &start, &end));
+  ASSERT_TRUE(obj.getSliceRange(5, &start, &end));
+  EXPECT_EQ(4, (int) start);
+  EXPECT_EQ(5, (int) end);
+
+  EXPECT_EQ(2, (int) obj.getSlice(1).getStripeNumber());
+  EXPECT_EQ(6, (int) obj.getSlice(3).getVoxelNumber());
+  EXPECT_TRUE(obj.getSlice(4).isEmpty());
+
+  obj.addSegment(0, 0, 0, 0, false);
+  EXPECT_TRUE(obj.isDeprecated(ZObject3dScan::COMPONENT_SLICE_INDEX));
+  ASSERT_TRUE(obj.getSliceRange(3, &start, &end));
+  EXPECT_EQ(3, (int) start);
+
+  //Stripes added without events
+  obj.addStripeFast(7, 0);
+  obj.addSegmentFast(1, 1);
+  ASSERT_TRUE(obj.getSliceRange(7, &start, &end));
+  EXPECT_EQ(6, (int) start);
+  EXPECT_EQ(7, (int) end);
+
+  ZObject3dScan::ResetPaintCounter();
+  EXPECT_EQ(0, (int) ZObject3dScan::GetVisitedStripeCount());
+  EXPECT_EQ(0, (int) ZObject3dScan::GetPaintedSegmentCount());
+}
+
 TEST(ZObject3dScan, TestObjectSize){
   ZObject3dScan obj;
 
@@ -696,6 +804,52 @@ TEST(ZObject3dScan, TestGetConnectedComponent) {
   EXPECT_EQ(3, (int) objArray[3].getVoxelNumber());
 }
 
+TEST(ZObject3dScan, labelConnectedSegment)
+{
+  ZObject3dScan obj;
+  createObject(&obj);
+
+  std::vector<size_t> labelArray;
+  ASSERT_EQ(2, (int) obj.labelConnectedSegment(&labelArray));
+  ASSERT_EQ(6, (int) labelArray.size());
+  EXPECT_EQ(0, (int) labelArray[0]);
+  EXPECT_EQ(1, (int) labelArray[1]);
+  EXPECT_EQ(1, (int) labelArray[2]);
+  EXPECT_EQ(0, (int) labelArray[3]);
+  EXPECT_EQ(1, (int) labelArray[4]);
+  EXPECT_EQ(1, (int) labelArray[5]);
+
+  obj.addSegment(1, 2, 8, 8);
+  obj.addSegment(1, 3, 0, 0);
+  ASSERT_EQ(3, (int) obj.labelConnectedSegment(&labelArray));
+  EXPECT_EQ(1, (int) labelArray[6]);
+  EXPECT_EQ(2, (int) labelArray[7]);
+
+  std::vector<ZObject3dScan> objArray =
+      obj.getConnectedComponent(ZObject3dScan::ACTION_NONE);
+  ASSERT_EQ(3, (int) objArray.size());
+  EXPECT_EQ(4, (int) objArray[0].getVoxelNumber());
+  EXPECT_EQ(9, (int) objArray[1].getVoxelNumber());
+  EXPECT_EQ(1, (int) objArray[2].getVoxelNumber());
+  EXPECT_TRUE(objArray[1].isCanonizedActually());
+
+  //Slab labeling must agree with single-thread labeling
+  obj.clear();
+  srand(1);
+  for (int z = 0; z < 64; ++z) {
+    for (int y = 0; y < 200; ++y) {
+      for (int x = 0; x < 100; x += 2 + rand() % 5) {
+        obj.addSegment(z, y, x, x + rand() % 3, false);
+      }
+    }
+  }
+  std::vector<size_t> labelArray2;
+  size_t n1 = obj.labelConnectedSegment(&labelArray, false);
+  size_t n2 = obj.labelConnectedSegment(&labelArray2, true);
+  ASSERT_EQ(n1, n2);
+  ASSERT_TRUE(labelArray == labelArray2);
+}
+
 TEST(ZObject3dScan, duplicateAcrossZ)
 {
   ZObject3dScan obj;
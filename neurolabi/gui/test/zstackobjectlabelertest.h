@@ -0,0 +1,249 @@
+#ifndef ZSTACKOBJECTLABELERTEST_H
+#define ZSTACKOBJECTLABELERTEST_H
+
+#include <algorithm>
+#include <vector>
+
+#include "ztestheader.h"
+#include "zteststack.h"
+#include "zstackobjectlabeler.h"
+#include "c_stack.h"
+#include "tz_stack_objlabel.h"
+#include "tz_stack_lib.h"
+#include "tz_stack_relation.h"
+#include "tz_imatrix.h"
+
+#ifdef _USE_GTEST_
+
+static Stack* MakeObjectLabelerTestStack(int kind, int density)
+{
+  Stack *stack = MakeRandomTestStack(kind, 23, 17, 13);
+  size_t voxelNumber = C_Stack::voxelNumber(stack);
+  for (size_t i = 0; i < voxelNumber; ++i) {
+    if (kind == GREY) {
+      stack->array[i] = (stack->array[i] % 100 < density) ? 1 : 0;
+    } else {
+      uint16_t *array = (uint16_t*) stack->array;
+      array[i] = (array[i] % 100 < density) ? 1 : 0;
+    }
+  }
+
+  return stack;
+}
+
+/* Label objects by flooding them one by one from their first voxels, which is
+ * independent of the union-find labeling */
+static int LabelObjectsByFlooding(Stack *stack, int flag, int label, int conn)
+{
+  IMatrix *chord = Make_3d_IMatrix(C_Stack::width(stack),
+                                   C_Stack::height(stack),
+                                   C_Stack::depth(stack));
+  Objlabel_Workspace ow;
+  Default_Objlabel_Workspace(&ow);
+  ow.conn = conn;
+  ow.chord = chord;
+  ow.init_chord = FALSE;
+
+  size_t voxelNumber = C_Stack::voxelNumber(stack);
+  for (size_t i = 0; i < voxelNumber; ++i) {
+    chord->array[i] = -1;
+  }
+
+  int startLabel = label;
+  int nobj = 0;
+  for (size_t i = 0; i < voxelNumber; ++i) {
+    int value = (C_Stack::kind(stack) == GREY) ?
+          stack->array[i] : ((uint16_t*) stack->array)[i];
+    if (value == flag) {
+      if (label > 255 && C_Stack::kind(stack) == GREY) {
+        Translate_Stack(stack, GREY16, 1);
+      }
+      Stack_Label_Object_W(stack, i, flag, label, &ow);
+      ++label;
+      if (label > 65535) {
+        label = startLabel;
+      }
+      ++nobj;
+    }
+  }
+
+  Kill_IMatrix(chord);
+
+  return nobj;
+}
+
+/* Label field (0 for background and 1, 2, ... for objects) by flooding */
+static std::vector<int> MakeFloodingLabelArray(const Stack *stack, int conn)
+{
+  Stack *labelStack = C_Stack::clone(stack);
+  if (C_Stack::kind(labelStack) == GREY) {
+    Translate_Stack(labelStack, GREY16, 1);
+  }
+  LabelObjectsByFlooding(labelStack, 1, 2, conn);
+
+  std::vector<int> labelArray(C_Stack::voxelNumber(stack), 0);
+  const uint16_t *array16 = (const uint16_t*) labelStack->array;
+  for (size_t i = 0; i < labelArray.size(); ++i) {
+    if (array16[i] > 1) {
+      labelArray[i] = array16[i] - 1;
+    }
+  }
+  C_Stack::kill(labelStack);
+
+  return labelArray;
+}
+
+TEST(ZStackObjectLabeler, label)
+{
+  int connArray[] = { 4, 6, 8, 18, 26 };
+  for (int c = 0; c < 5; ++c) {
+    for (int density = 10; density <= 70; density += 30) {
+      Stack *stack = MakeObjectLabelerTestStack(GREY, density);
+      ZStackObjectLabeler labeler;
+      labeler.setConnectivity(connArray[c]);
+      int nobj = labeler.label(stack, 1);
+      ASSERT_EQ(nobj, labeler.getObjectNumber());
+      ASSERT_EQ(nobj, (int) labeler.getStatArray().size());
+
+      //Check the statistics against the label field
+      const std::vector<int> &labelArray = labeler.getLabelArray();
+      std::vector<int> sizeArray(nobj + 1, 0);
+      size_t offset = 0;
+      int nextLabel = 1;
+      for (int z = 0; z < C_Stack::depth(stack); ++z) {
+        for (int y = 0; y < C_Stack::height(stack); ++y) {
+          for (int x = 0; x < C_Stack::width(stack); ++x) {
+            int label = labelArray[offset];
+            ASSERT_EQ(stack->array[offset] == 1, label > 0);
+            if (label > 0) {
+              //Labels are in the order of first voxels
+              ASSERT_LE(label, nextLabel);
+              if (label == nextLabel) {
+                ++nextLabel;
+              }
+              const Objlabel_Stat &stat = labeler.getStatArray()[label - 1];
+              ASSERT_LE(stat.first_corner[0], x);
+              ASSERT_LE(stat.first_corner[1], y);
+              ASSERT_LE(stat.first_corner[2], z);
+              ASSERT_GE(stat.last_corner[0], x);
+              ASSERT_GE(stat.last_corner[1], y);
+              ASSERT_GE(stat.last_corner[2], z);
+              ++sizeArray[label];
+            }
+            ++offset;
+          }
+        }
+      }
+      for (int i = 1; i <= nobj; ++i) {
+        ASSERT_EQ(sizeArray[i], labeler.getStatArray()[i - 1].size);
+      }
+
+      //Same result as flooding each object
+      ASSERT_TRUE(MakeFloodingLabelArray(stack, connArray[c]) == labelArray);
+
+      Stack *expected = C_Stack::clone(stack);
+      ASSERT_EQ(LabelObjectsByFlooding(expected, 1, 2, connArray[c]),
+                labeler.labelObjects(stack, 1, 2));
+      ASSERT_TRUE(Stack_Identical(expected, stack));
+
+      Stack *result = MakeObjectLabelerTestStack(GREY, density);
+      ASSERT_EQ(nobj, Stack_Label_Objects_N(result, NULL, 1, 2, connArray[c]));
+      ASSERT_TRUE(Stack_Identical(expected, result));
+
+      C_Stack::kill(result);
+      C_Stack::kill(expected);
+      C_Stack::kill(stack);
+    }
+  }
+}
+
+TEST(ZStackObjectLabeler, labelLargeObjects)
+{
+  for (int minSize = 1; minSize <= 9; minSize += 4) {
+    Stack *stack = MakeObjectLabelerTestStack(GREY, 30);
+    Stack *expected = C_Stack::clone(stack);
+    Objlabel_Workspace ow;
+    Default_Objlabel_Workspace(&ow);
+    ow.conn = 18;
+    ow.chord = NULL;
+    ow.init_chord = TRUE;
+    int nobj = Stack_Label_Large_Objects_W(expected, 1, 2, minSize, &ow);
+
+    ZStackObjectLabeler labeler;
+    labeler.setConnectivity(18);
+    ASSERT_EQ(nobj, labeler.labelLargeObjects(stack, 1, 2, minSize));
+    ASSERT_TRUE(Stack_Identical(expected, stack));
+
+    C_Stack::kill(expected);
+    C_Stack::kill(stack);
+  }
+
+  //Large labels turn the stack into GREY16
+  Stack *stack = MakeObjectLabelerTestStack(GREY, 10);
+  Stack *expected = C_Stack::clone(stack);
+  Objlabel_Workspace ow;
+  Default_Objlabel_Workspace(&ow);
+  ow.conn = 6;
+  ow.chord = Make_3d_IMatrix(C_Stack::width(stack), C_Stack::height(stack),
+                             C_Stack::depth(stack));
+  ow.init_chord = TRUE;
+  int nobj = Stack_Label_Large_Objects_W(expected, 1, 250, 1, &ow);
+  Kill_IMatrix(ow.chord);
+  ASSERT_LT(5, nobj);
+
+  ZStackObjectLabeler labeler;
+  labeler.setConnectivity(6);
+  ASSERT_EQ(nobj, labeler.labelLargeObjects(stack, 1, 250, 1));
+  ASSERT_EQ(GREY16, C_Stack::kind(stack));
+  ASSERT_TRUE(Stack_Identical(expected, stack));
+
+  Stack *result = MakeObjectLabelerTestStack(GREY, 10);
+  ASSERT_EQ(nobj, Stack_Label_Large_Objects_N(result, NULL, 1, 250, 1, 6));
+  ASSERT_TRUE(Stack_Identical(expected, result));
+
+  C_Stack::kill(result);
+  C_Stack::kill(expected);
+  C_Stack::kill(stack);
+}
+
+TEST(ZStackObjectLabeler, slab)
+{
+  //Every split of the stack into slabs, whatever the number of cores
+  int connArray[] = { 4, 6, 8, 18, 26 };
+  int kindArray[] = { GREY, GREY16 };
+  for (int k = 0; k < 2; ++k) {
+    for (int c = 0; c < 5; ++c) {
+      for (int density = 10; density <= 70; density += 30) {
+        Stack *stack = MakeObjectLabelerTestStack(kindArray[k], density);
+        std::vector<int> expected = MakeFloodingLabelArray(stack, connArray[c]);
+        int nobj = 0;
+        for (size_t i = 0; i < expected.size(); ++i) {
+          nobj = std::max(nobj, expected[i]);
+        }
+
+        int depth = C_Stack::depth(stack);
+        for (int slabNumber = 1; slabNumber <= depth; ++slabNumber) {
+          std::vector<int> labelArray(expected.size());
+          for (int i = 0; i < slabNumber; ++i) {
+            Stack_Label_Components(
+                  stack, 1, connArray[c], depth * i / slabNumber,
+                  depth * (i + 1) / slabNumber - 1, &(labelArray[0]));
+          }
+          for (int i = 1; i < slabNumber; ++i) {
+            Stack_Label_Components_Merge(
+                  stack, connArray[c], depth * i / slabNumber,
+                  &(labelArray[0]));
+          }
+          ASSERT_EQ(nobj, Stack_Label_Components_Resolve(
+                      stack, &(labelArray[0]), NULL));
+          ASSERT_TRUE(expected == labelArray) << slabNumber << " slabs";
+        }
+        C_Stack::kill(stack);
+      }
+    }
+  }
+}
+
+#endif
+
+#endif // ZSTACKOBJECTLABELERTEST_H
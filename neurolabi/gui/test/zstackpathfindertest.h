@@ -0,0 +1,224 @@
+#ifndef ZSTACKPATHFINDERTEST_H
+#define ZSTACKPATHFINDERTEST_H
+
+#include <cmath>
+
+#include "ztestheader.h"
+#include "zstackpathfinder.h"
+#include "zgraph.h"
+#include "c_stack.h"
+#include "tz_stack_graph.h"
+#include "tz_stack_utils.h"
+
+#ifdef _USE_GTEST_
+
+static Stack* MakePathFinderTestStack(int kind)
+{
+  Stack *stack = C_Stack::make(kind, 20, 16, 10);
+  size_t offset = 0;
+  for (int z = 0; z < C_Stack::depth(stack); ++z) {
+    for (int y = 0; y < C_Stack::height(stack); ++y) {
+      for (int x = 0; x < C_Stack::width(stack); ++x) {
+        int v = 5 + (x * 37 + y * 11 + z * 23) % 240;
+        if (kind == GREY) {
+          C_Stack::array8(stack)[offset] = v;
+        } else {
+          C_Stack::guardedArray16(stack)[offset] = v * 250;
+        }
+        ++offset;
+      }
+    }
+  }
+
+  return stack;
+}
+
+/* Length of the shortest path on the graph built by Stack_Graph_W() */
+static double ComputeGraphPathLength(
+    const Stack *stack, int startIndex, int endIndex,
+    Stack_Graph_Workspace *sgw)
+{
+  ZGraph graph(Stack_Graph_W(stack, sgw));
+
+  int width = C_Stack::width(stack);
+  int area = C_Stack::area(stack);
+  int swidth = sgw->range[1] - sgw->range[0] + 1;
+  int sarea = swidth * (sgw->range[3] - sgw->range[2] + 1);
+  int start = Stack_Subindex(startIndex, -sgw->range[0], -sgw->range[2],
+      -sgw->range[4], width, area, swidth, sarea);
+  int end = Stack_Subindex(endIndex, -sgw->range[0], -sgw->range[2],
+      -sgw->range[4], width, area, swidth, sarea);
+
+  std::vector<int> path = graph.computeShortestPath(start, end);
+  if (path.empty()) {
+    return -1.0;
+  }
+
+  double length = 0.0;
+  for (size_t i = 1; i < path.size(); ++i) {
+    int edgeIndex = graph.getEdgeIndex(path[i - 1], path[i]);
+    if (edgeIndex < 0) {
+      edgeIndex = graph.getEdgeIndex(path[i], path[i - 1]);
+    }
+    length += graph.getEdgeWeight(edgeIndex);
+  }
+
+  return length;
+}
+
+static bool IsLatticePath(const std::vector<int> &path, const Stack *stack)
+{
+  for (size_t i = 1; i < path.size(); ++i) {
+    int x1, y1, z1, x2, y2, z2;
+    C_Stack::indexToCoord(path[i - 1], C_Stack::width(stack),
+                          C_Stack::height(stack), &x1, &y1, &z1);
+    C_Stack::indexToCoord(path[i], C_Stack::width(stack),
+                          C_Stack::height(stack), &x2, &y2, &z2);
+    if (abs(x1 - x2) > 1 || abs(y1 - y2) > 1 || abs(z1 - z2) > 1 ||
+        path[i - 1] == path[i]) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static void TestPathFinderAgainstGraph(
+    const Stack *stack, Stack_Graph_Workspace *sgw, bool checkingLattice)
+{
+  int pointArray[][6] = {
+    {0, 0, 0, 19, 15, 9}, {3, 12, 2, 17, 1, 8}, {5, 5, 5, 6, 5, 5},
+    {19, 0, 9, 0, 15, 0}
+  };
+
+  ZStackPathFinder finder;
+  for (int i = 0; i < 4; ++i) {
+    int *pt = pointArray[i];
+    int startIndex = C_Stack::indexFromCoord(
+          pt[0], pt[1], pt[2], C_Stack::width(stack), C_Stack::height(stack),
+          C_Stack::depth(stack));
+    int endIndex = C_Stack::indexFromCoord(
+          pt[3], pt[4], pt[5], C_Stack::width(stack), C_Stack::height(stack),
+          C_Stack::depth(stack));
+
+    double expected = ComputeGraphPathLength(stack, startIndex, endIndex, sgw);
+
+    for (int bidirectional = 0; bidirectional < 2; ++bidirectional) {
+      finder.setBidirectional(bidirectional == 1);
+      finder.setSignalMask(sgw->signal_mask);
+      std::vector<int> path =
+          finder.findPath(stack, startIndex, endIndex, sgw);
+      if (expected < 0.0) {
+        ASSERT_TRUE(path.empty());
+      } else {
+        ASSERT_FALSE(path.empty());
+        ASSERT_EQ(startIndex, path.front());
+        ASSERT_EQ(endIndex, path.back());
+        ASSERT_NEAR(expected, finder.getLastPathLength(),
+                    1e-9 * (1.0 + expected));
+        if (checkingLattice) {
+          ASSERT_TRUE(IsLatticePath(path, stack));
+        }
+      }
+    }
+  }
+}
+
+TEST(ZStackPathFinder, findPath)
+{
+  int kindArray[] = { GREY, GREY16 };
+  for (int k = 0; k < 2; ++k) {
+    Stack *stack = MakePathFinderTestStack(kindArray[k]);
+
+    Stack_Graph_Workspace sgw;
+    Default_Stack_Graph_Workspace(&sgw);
+    Stack_Graph_Workspace_Set_Range(&sgw, 0, C_Stack::width(stack) - 1, 0,
+                                    C_Stack::height(stack) - 1, 0,
+                                    C_Stack::depth(stack) - 1);
+    sgw.wf = Stack_Voxel_Weight_S;
+    sgw.argv[3] = (kindArray[k] == GREY) ? 100.0 : 25000.0;
+    sgw.argv[4] = (kindArray[k] == GREY) ? 5.0 : 1250.0;
+
+    TestPathFinderAgainstGraph(stack, &sgw, true);
+
+    sgw.wf = NULL;
+    TestPathFinderAgainstGraph(stack, &sgw, true);
+
+    sgw.wf = Stack_Voxel_Weight_Sr;
+    sgw.resolution[2] = 2.5;
+    TestPathFinderAgainstGraph(stack, &sgw, true);
+
+    sgw.conn = 6;
+    TestPathFinderAgainstGraph(stack, &sgw, true);
+    sgw.conn = 26;
+
+    //Signal mask with a wall that has a single hole
+    sgw.signal_mask = C_Stack::make(GREY, C_Stack::width(stack),
+                                    C_Stack::height(stack),
+                                    C_Stack::depth(stack));
+    C_Stack::setOne(sgw.signal_mask);
+    for (int z = 0; z < C_Stack::depth(stack); ++z) {
+      for (int y = 0; y < C_Stack::height(stack); ++y) {
+        if (y != 14 || z != 3) {
+          C_Stack::array8(sgw.signal_mask)[C_Stack::indexFromCoord(
+                10, y, z, C_Stack::width(stack), C_Stack::height(stack),
+                C_Stack::depth(stack))] = 0;
+        }
+      }
+    }
+    TestPathFinderAgainstGraph(stack, &sgw, true);
+
+    sgw.including_signal_border = TRUE;
+    TestPathFinderAgainstGraph(stack, &sgw, true);
+    sgw.including_signal_border = FALSE;
+
+    //No hole
+    C_Stack::array8(sgw.signal_mask)[C_Stack::indexFromCoord(
+          10, 14, 3, C_Stack::width(stack), C_Stack::height(stack),
+          C_Stack::depth(stack))] = 0;
+    TestPathFinderAgainstGraph(stack, &sgw, true);
+    C_Stack::kill(sgw.signal_mask);
+    sgw.signal_mask = NULL;
+
+    //Group mask
+    sgw.group_mask = C_Stack::make(GREY, C_Stack::width(stack),
+                                   C_Stack::height(stack),
+                                   C_Stack::depth(stack));
+    C_Stack::setZero(sgw.group_mask);
+    for (int z = 0; z < C_Stack::depth(stack); ++z) {
+      C_Stack::array8(sgw.group_mask)[C_Stack::indexFromCoord(
+            2, 2, z, C_Stack::width(stack), C_Stack::height(stack),
+            C_Stack::depth(stack))] = 1;
+    }
+    C_Stack::array8(sgw.group_mask)[C_Stack::indexFromCoord(
+          18, 14, 8, C_Stack::width(stack), C_Stack::height(stack),
+          C_Stack::depth(stack))] = 1;
+    TestPathFinderAgainstGraph(stack, &sgw, false);
+
+    //Subrange
+    Stack_Graph_Workspace_Set_Range(&sgw, 2, 17, 1, 14, 1, 8);
+    C_Stack::kill(sgw.group_mask);
+    sgw.group_mask = NULL;
+    ZStackPathFinder finder;
+    int startIndex = C_Stack::indexFromCoord(
+          3, 2, 2, C_Stack::width(stack), C_Stack::height(stack),
+          C_Stack::depth(stack));
+    int endIndex = C_Stack::indexFromCoord(
+          16, 13, 7, C_Stack::width(stack), C_Stack::height(stack),
+          C_Stack::depth(stack));
+    std::vector<int> path = finder.findPath(stack, startIndex, endIndex, &sgw);
+    ASSERT_NEAR(ComputeGraphPathLength(stack, startIndex, endIndex, &sgw),
+                finder.getLastPathLength(), 1e-6);
+    ASSERT_TRUE(IsLatticePath(path, stack));
+
+    //Out of range
+    ASSERT_TRUE(finder.findPath(stack, 0, endIndex, &sgw).empty());
+
+    Clean_Stack_Graph_Workspace(&sgw);
+    C_Stack::kill(stack);
+  }
+}
+
+#endif
+
+#endif // ZSTACKPATHFINDERTEST_H
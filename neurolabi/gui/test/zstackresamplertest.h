@@ -0,0 +1,182 @@
+#ifndef ZSTACKRESAMPLERTEST_H
+#define ZSTACKRESAMPLERTEST_H
+
+#include <algorithm>
+
+#include "ztestheader.h"
+#include "zteststack.h"
+#include "../zfspath.h"
+#include "neutubeconfig.h"
+#include "zstackresampler.h"
+#include "zstackfile.h"
+#include "zstack.hxx"
+#include "zintpoint.h"
+#include "zstring.h"
+#include "c_stack.h"
+#include "tz_stack_lib.h"
+
+#ifdef _USE_GTEST_
+
+TEST(ZStackResampler, downsample)
+{
+  int kindArray[] = { GREY, GREY16, FLOAT32, COLOR };
+  for (int k = 0; k < 4; ++k) {
+    Stack *stack = MakeRandomTestStack(kindArray[k], 23, 17, 13);
+    ZStackResampler resampler;
+
+    //Blocks on the boundary are partial
+    Stack *result = resampler.downsample(stack, 2, 3, 4, STACK_DOWNSAMPLE_MAX);
+    ASSERT_EQ(8, C_Stack::width(result));
+    ASSERT_EQ(5, C_Stack::height(result));
+    ASSERT_EQ(3, C_Stack::depth(result));
+    int x = 7;
+    int y = 4;
+    int z = 2;
+    int channelNumber = (kindArray[k] == COLOR) ? 3 : 1;
+    for (int c = 0; c < channelNumber; ++c) {
+      double v = 0.0;
+      for (int rz = 0; rz < 3; ++rz) {
+        for (int ry = 0; ry < 1; ++ry) {
+          for (int rx = 0; rx < 2; ++rx) {
+            v = std::max(v, C_Stack::value(stack, x * 3 + rx, y * 4 + ry,
+                                           z * 5 + rz, c));
+          }
+        }
+      }
+      ASSERT_EQ(v, C_Stack::value(result, x, y, z, c));
+    }
+    C_Stack::kill(result);
+
+    if (kindArray[k] != FLOAT32) {
+      Stack *expected = Downsample_Stack(stack, 2, 3, 4);
+      result = resampler.downsample(stack, 2, 3, 4, STACK_DOWNSAMPLE_NEAREST);
+      ASSERT_TRUE(Stack_Identical(expected, result));
+      C_Stack::kill(expected);
+      C_Stack::kill(result);
+    }
+
+    Stack *expected = Downsample_Stack_Mean(stack, 1, 1, 1, NULL);
+    result = resampler.downsample(stack, 1, 1, 1, STACK_DOWNSAMPLE_MEAN);
+    ASSERT_TRUE(Stack_Identical(expected, result));
+
+    //In place
+    Stack *stack2 = C_Stack::clone(stack);
+    resampler.downsample(stack2, 1, 1, 1, STACK_DOWNSAMPLE_MEAN, stack2);
+    ASSERT_TRUE(Stack_Identical(expected, stack2));
+
+    C_Stack::kill(stack2);
+    C_Stack::kill(expected);
+    C_Stack::kill(result);
+    C_Stack::kill(stack);
+  }
+}
+
+TEST(ZStackResampler, upsample)
+{
+  int kindArray[] = { GREY, GREY16, FLOAT32, COLOR };
+  for (int k = 0; k < 4; ++k) {
+    Stack *stack = MakeRandomTestStack(kindArray[k], 11, 7, 5);
+    ZStackResampler resampler;
+    Stack *result = resampler.upsample(stack, 1, 2, 3);
+    ASSERT_EQ(22, C_Stack::width(result));
+    ASSERT_EQ(21, C_Stack::height(result));
+    ASSERT_EQ(20, C_Stack::depth(result));
+
+    //Source voxels are kept
+    for (int z = 0; z < 5; ++z) {
+      for (int y = 0; y < 7; ++y) {
+        for (int x = 0; x < 11; ++x) {
+          ASSERT_EQ(C_Stack::value(stack, x, y, z, 0),
+                    C_Stack::value(result, x * 2, y * 3, z * 4, 0));
+        }
+      }
+    }
+
+    Stack *expected = Upsample_Stack(stack, 1, 2, 3, NULL);
+    ASSERT_TRUE(Stack_Identical(expected, result));
+    C_Stack::kill(expected);
+
+    C_Stack::kill(result);
+    C_Stack::kill(stack);
+  }
+}
+
+TEST(ZStackFile, readDownsampled)
+{
+  Stack *stack = MakeRandomTestStack(GREY16, 23, 17, 13);
+  std::string tifPath =
+      (fs::path(GET_TEST_DATA_DIR) / "test_downsample.tif").string();
+  std::string rawPath =
+      (fs::path(GET_TEST_DATA_DIR) / "test_downsample.raw").string();
+  C_Stack::write(tifPath, stack);
+  C_Stack::write(rawPath, stack);
+
+  //A file list is downsampled after being read entirely
+  ZStackFile fileList;
+  fileList.setType("list");
+  std::vector<std::string> slicePathArray;
+  for (int z = 0; z < C_Stack::depth(stack); ++z) {
+    ZString fileName = "test_downsample_";
+    fileName.appendNumber(z, 3);
+    fileName += ".tif";
+    std::string slicePath =
+        (fs::path(GET_TEST_DATA_DIR) / fileName).string();
+    Stack slice = C_Stack::sliceView(stack, z);
+    C_Stack::write(slicePath, &slice);
+    fileList.appendUrl(slicePath);
+    slicePathArray.push_back(slicePath);
+  }
+
+  ZStackFile tifFile;
+  tifFile.import(tifPath);
+  ZStackFile rawFile;
+  rawFile.import(rawPath);
+  ZStackFile *fileArray[] = { &tifFile, &rawFile, &fileList };
+
+  Stack_Downsample_Method_e methodArray[] = {
+    STACK_DOWNSAMPLE_NEAREST, STACK_DOWNSAMPLE_MEAN, STACK_DOWNSAMPLE_MAX };
+
+  for (int m = 0; m < 3; ++m) {
+    int width, height, depth;
+    Downsample_Stack_Max_Size(C_Stack::width(stack), C_Stack::height(stack),
+                              C_Stack::depth(stack), 2, 3, 4,
+                              &width, &height, &depth);
+    Stack *expected = C_Stack::make(GREY16, width, height, depth);
+    Downsample_Stack_Slab(stack, 2, 3, 4, methodArray[m], 0, depth - 1,
+                          expected);
+
+    for (int i = 0; i < 3; ++i) {
+      ZStack *result =
+          fileArray[i]->readStack(ZIntPoint(2, 3, 4), methodArray[m]);
+      ASSERT_TRUE(result != NULL);
+      ASSERT_EQ(1, result->channelNumber());
+      ASSERT_TRUE(Stack_Identical(expected, result->c_stack()));
+      delete result;
+    }
+
+    C_Stack::kill(expected);
+  }
+
+  //No downsampling
+  ZStack *result = tifFile.readStack(ZIntPoint(0, 0, 0), STACK_DOWNSAMPLE_MAX);
+  ASSERT_TRUE(Stack_Identical(stack, result->c_stack()));
+  delete result;
+
+  ZStackFile missingFile;
+  missingFile.import(
+        (fs::path(GET_TEST_DATA_DIR) / "test_downsample_none.tif").string());
+  ASSERT_TRUE(missingFile.readStack(ZIntPoint(1, 1, 1),
+                                    STACK_DOWNSAMPLE_MAX) == NULL);
+
+  remove(tifPath.c_str());
+  remove(rawPath.c_str());
+  for (size_t i = 0; i < slicePathArray.size(); ++i) {
+    remove(slicePathArray[i].c_str());
+  }
+
+  C_Stack::kill(stack);
+}
+
+#endif
+
+#endif // ZSTACKRESAMPLERTEST_H
@@ -0,0 +1,97 @@
+#ifndef ZSTACKSLICEPYRAMIDTEST_H
+#define ZSTACKSLICEPYRAMIDTEST_H
+
+#include "ztestheader.h"
+#include "zteststack.h"
+#include "zstackslicepyramid.h"
+#include "c_stack.h"
+#include "tz_stack_lib.h"
+
+#ifdef _USE_GTEST_
+
+static Mc_Stack* MakeSlicePyramidTestStack(int kind)
+{
+  Mc_Stack *stack = Make_Mc_Stack(kind, 45, 23, 3, 2);
+  FillRandomTestArray(stack->array, kind, (size_t) 45 * 23 * 3 * 2);
+
+  return stack;
+}
+
+TEST(ZStackSlicePyramid, getSlice)
+{
+  int kindArray[] = { GREY, GREY16 };
+  for (int k = 0; k < 2; ++k) {
+    Mc_Stack *stack = MakeSlicePyramidTestStack(kindArray[k]);
+    ZStackSlicePyramid pyramid;
+
+    Stack slice = pyramid.getSlice(stack, 1, 2, 0);
+    Stack expectedSlice = C_Stack::sliceView(stack, 2, 1);
+    ASSERT_EQ(expectedSlice.array, slice.array);
+    ASSERT_EQ(0, (int) pyramid.getMemoryUsage());
+
+    for (int level = 1; level <= 5; ++level) {
+      for (int c = 0; c < 2; ++c) {
+        Stack levelSlice = pyramid.getSlice(stack, c, 2, level);
+        ASSERT_EQ(ZStackSlicePyramid::GetLevelSize(45, level),
+                  C_Stack::width(&levelSlice));
+        ASSERT_EQ(ZStackSlicePyramid::GetLevelSize(23, level),
+                  C_Stack::height(&levelSlice));
+        ASSERT_EQ(1, C_Stack::depth(&levelSlice));
+
+        //Same as downsampling the slice directly
+        Stack source = C_Stack::sliceView(stack, 2, c);
+        int intv = (1 << level) - 1;
+        Stack *expected = Downsample_Stack_Max(&source, intv, intv, 0, NULL);
+        ASSERT_TRUE(Stack_Identical(expected, &levelSlice));
+        C_Stack::kill(expected);
+      }
+    }
+    ASSERT_LT(0, (int) pyramid.getMemoryUsage());
+
+    pyramid.clear();
+    ASSERT_EQ(0, (int) pyramid.getMemoryUsage());
+
+    Kill_Mc_Stack(stack);
+  }
+}
+
+TEST(ZStackSlicePyramid, memoryLimit)
+{
+  Mc_Stack *stack = MakeSlicePyramidTestStack(GREY);
+  ZStackSlicePyramid pyramid;
+
+  pyramid.getSlice(stack, 0, 0, 1);
+  size_t sliceUsage = pyramid.getMemoryUsage();
+  ASSERT_EQ((size_t) 23 * 12, sliceUsage);
+
+  pyramid.setMemoryLimit(sliceUsage * 2);
+  pyramid.getSlice(stack, 0, 1, 1);
+  pyramid.getSlice(stack, 0, 0, 1);
+  ASSERT_EQ(sliceUsage * 2, pyramid.getMemoryUsage());
+
+  //The least recently used slice is dropped
+  pyramid.getSlice(stack, 0, 2, 1);
+  ASSERT_EQ(sliceUsage * 2, pyramid.getMemoryUsage());
+  pyramid.getSlice(stack, 0, 0, 1);
+  ASSERT_EQ(sliceUsage * 2, pyramid.getMemoryUsage());
+
+  //The requested slice is kept even if it alone exceeds the limit
+  pyramid.setMemoryLimit(1);
+  ASSERT_EQ(sliceUsage, pyramid.getMemoryUsage());
+  Stack slice = pyramid.getSlice(stack, 1, 0, 2);
+  ASSERT_EQ(12, C_Stack::width(&slice));
+  ASSERT_LT((size_t) 1, pyramid.getMemoryUsage());
+
+  //Another stack resets the cache
+  Mc_Stack *stack2 = MakeSlicePyramidTestStack(GREY);
+  pyramid.setMemoryLimit(1024 * 1024);
+  pyramid.getSlice(stack2, 0, 0, 1);
+  ASSERT_EQ(sliceUsage, pyramid.getMemoryUsage());
+
+  Kill_Mc_Stack(stack2);
+  Kill_Mc_Stack(stack);
+}
+
+#endif
+
+#endif // ZSTACKSLICEPYRAMIDTEST_H
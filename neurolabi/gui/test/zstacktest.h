@@ -308,6 +308,49 @@ TEST(ZStack, ColorToGrey) {
   }
 }
 
+TEST(ZStack, Projection) {
+  ZStack stack(GREY, 5, 4, 3, 1);
+  stack.setZero();
+  stack.setValue(1, 2, 0, 0, 3);
+  stack.setValue(1, 2, 2, 0, 5);
+  stack.setValue(4, 3, 1, 0, 7);
+
+  uint8_t *proj = (uint8_t*) stack.projection(
+        ZSingleChannelStack::MAX_PROJ, ZSingleChannelStack::Z_AXIS);
+  ASSERT_EQ(5, (int) proj[2 * 5 + 1]);
+  ASSERT_EQ(7, (int) proj[3 * 5 + 4]);
+  ASSERT_EQ(0, (int) proj[0]);
+
+  ASSERT_EQ(2, stack.maxIntensityDepth(1, 2));
+  ASSERT_EQ(1, stack.maxIntensityDepth(4, 3));
+  ASSERT_EQ(0, stack.maxIntensityDepth(0, 0));
+  ASSERT_EQ(5, stack.value(1, 2, -1));
+
+  const int *depth = stack.singleChannelStack()->projectionDepth(
+        ZSingleChannelStack::MAX_PROJ, ZSingleChannelStack::X_AXIS);
+  //(y, z) layout
+  ASSERT_EQ(1, depth[2 * 4 + 2]);
+  ASSERT_EQ(4, depth[1 * 4 + 3]);
+
+  proj = (uint8_t*) stack.projection(
+        ZSingleChannelStack::MAX_PROJ, ZSingleChannelStack::Y_AXIS);
+  //(x, z) layout
+  ASSERT_EQ(3, (int) proj[1]);
+  ASSERT_EQ(7, (int) proj[5 + 4]);
+
+  //Cache is updated after changing data
+  stack.setValue(1, 2, 1, 0, 9);
+  ASSERT_EQ(1, stack.maxIntensityDepth(1, 2));
+
+  proj = (uint8_t*) stack.projection(
+        ZSingleChannelStack::MIN_PROJ, ZSingleChannelStack::Z_AXIS);
+  ASSERT_EQ(0, (int) proj[2 * 5 + 1]);
+  depth = stack.singleChannelStack()->projectionDepth(
+        ZSingleChannelStack::MIN_PROJ, ZSingleChannelStack::Z_AXIS);
+  ASSERT_EQ(0, depth[2 * 5 + 4]);
+  ASSERT_EQ(0, depth[3 * 5 + 4]);
+}
+
 #endif
 
 #endif // ZSTACKTEST_H
@@ -0,0 +1,206 @@
+#ifndef ZSTACKWATERSHEDTEST_H
+#define ZSTACKWATERSHEDTEST_H
+
+#include "ztestheader.h"
+#include "zstackwatershed.h"
+#include "zstack.hxx"
+#include "zstackarray.h"
+#include "c_stack.h"
+#include "tz_stack_relation.h"
+
+#ifdef _USE_GTEST_
+
+static ZStack* MakeWatershedTestStack(int kind)
+{
+  ZStack *stack = new ZStack(kind, 30, 20, 12, 1);
+  size_t offset = 0;
+  for (int z = 0; z < stack->depth(); ++z) {
+    for (int y = 0; y < stack->height(); ++y) {
+      for (int x = 0; x < stack->width(); ++x) {
+        int v = 10 + (x * 7 + y * 13 + z * 5) % 200;
+        //Zero walls split the stack into separated components
+        if (x == 10 || z == 6 || (x * 31 + y * 17 + z * 3) % 19 == 0) {
+          v = 0;
+        }
+        switch (kind) {
+        case GREY:
+          stack->array8()[offset] = v;
+          break;
+        case GREY16:
+          stack->array16()[offset] = v * 300;
+          break;
+        case GREY32:
+          stack->array32()[offset] = v * 1000;
+          break;
+        }
+        ++offset;
+      }
+    }
+  }
+
+  return stack;
+}
+
+static ZStack* MakeWatershedTestSeed(int label, int x, int y, int z)
+{
+  ZStack *seed = new ZStack(GREY, 2, 2, 1, 1);
+  seed->setOffset(x, y, z);
+  for (size_t i = 0; i < seed->getVoxelNumber(); ++i) {
+    seed->array8()[i] = label;
+  }
+
+  return seed;
+}
+
+static Stack* MakeStackWatershedResult(
+    const ZStack *stack, const ZStackArray &seedMask)
+{
+  Stack_Watershed_Workspace *ws =
+      Make_Stack_Watershed_Workspace(stack->c_stack());
+  ws->conn = 26;
+  ws->mask = C_Stack::make(GREY, stack->width(), stack->height(),
+                           stack->depth());
+  C_Stack::setZero(ws->mask);
+  for (size_t i = 0; i < stack->getVoxelNumber(); ++i) {
+    if (C_Stack::value(stack->c_stack(), i) == 0.0) {
+      ws->mask->array[i] = STACK_WATERSHED_BARRIER;
+    }
+  }
+  for (ZStackArray::const_iterator iter = seedMask.begin();
+       iter != seedMask.end(); ++iter) {
+    ZStack *seed = *iter;
+    C_Stack::setBlockValue(
+          ws->mask, seed->c_stack(), seed->getOffset().getX(),
+          seed->getOffset().getY(), seed->getOffset().getZ(), 0,
+          STACK_WATERSHED_BARRIER);
+  }
+  if (stack->kind() == GREY) {
+    ws->start_level = 255;
+  } else if (stack->kind() == GREY16) {
+    ws->start_level = 65535;
+  } else {
+    ws->start_level = std::max(0, (int) C_Stack::max(stack->c_stack()));
+  }
+
+  Stack *out = Stack_Watershed(stack->c_stack(), ws);
+  Kill_Stack_Watershed_Workspace(ws);
+
+  return out;
+}
+
+TEST(ZStackWatershed, run)
+{
+  int kindArray[] = { GREY, GREY16, GREY32 };
+  for (int k = 0; k < 3; ++k) {
+    ZStack *stack = MakeWatershedTestStack(kindArray[k]);
+
+    ZStackArray seedMask;
+    int label = 1;
+    for (int z = 2; z < 12; z += 6) {
+      for (int x = 3; x < 30; x += 8) {
+        seedMask.push_back(MakeWatershedTestSeed(label, x, 4 + label % 11, z));
+        ++label;
+      }
+    }
+
+    ZStackWatershed engine;
+    ZStack *result = engine.run(stack, seedMask);
+    ASSERT_TRUE(result != NULL);
+
+    //Same as the single-threaded watershed
+    Stack *expected = MakeStackWatershedResult(stack, seedMask);
+    ASSERT_TRUE(Stack_Identical(expected, result->c_stack()));
+    size_t labeledNumber = 0;
+    for (size_t i = 0; i < result->getVoxelNumber(); ++i) {
+      if (expected->array[i] > 0) {
+        ++labeledNumber;
+      }
+    }
+    ASSERT_LT(stack->getVoxelNumber() / 2, labeledNumber);
+
+    C_Stack::kill(expected);
+    delete result;
+    delete stack;
+  }
+}
+
+TEST(ZStackWatershed, plateau)
+{
+  //Large plateaus are flooded in parallel layers
+  ZStack stack(GREY, 128, 128, 16, 1);
+  size_t offset = 0;
+  for (int z = 0; z < stack.depth(); ++z) {
+    for (int y = 0; y < stack.height(); ++y) {
+      for (int x = 0; x < stack.width(); ++x) {
+        stack.array8()[offset] = (x < 64) ? 100 : 50;
+        if (y == 80 && x > 5) {
+          stack.array8()[offset] = 0;
+        }
+        ++offset;
+      }
+    }
+  }
+
+  ZStackArray seedMask;
+  ZStack *seed = new ZStack(GREY, 128, 128, 1, 1);
+  seed->setOffset(0, 0, 0);
+  for (size_t i = 0; i < seed->getVoxelNumber(); ++i) {
+    seed->array8()[i] = (i % 7 == 0) ? 1 : 0;
+  }
+  seedMask.push_back(seed);
+  seedMask.push_back(MakeWatershedTestSeed(2, 120, 5, 10));
+  seedMask.push_back(MakeWatershedTestSeed(3, 20, 100, 8));
+  seedMask.push_back(MakeWatershedTestSeed(4, 40, 40, 8));
+
+  ZStackWatershed engine;
+  ZStack *result = engine.run(&stack, seedMask);
+  Stack *expected = MakeStackWatershedResult(&stack, seedMask);
+  ASSERT_TRUE(Stack_Identical(expected, result->c_stack()));
+
+  C_Stack::kill(expected);
+  delete result;
+}
+
+TEST(ZStackWatershed, level)
+{
+  //More levels than a 16-bit stack can hold
+  ZStack stack(FLOAT32, 48, 48, 32, 1);
+  float *array = (float*) stack.array8();
+  size_t voxelNumber = stack.getVoxelNumber();
+  for (size_t i = 0; i < voxelNumber; ++i) {
+    array[i] = (i * 7919 % voxelNumber) * 0.5 + 1.0;
+    if (i % 97 == 0) {
+      array[i] = 0;
+    } else if (i % 89 == 0) {
+      array[i] = -10.0;
+    }
+  }
+
+  ZStackArray seedMask;
+  int label = 1;
+  for (int z = 2; z < 32; z += 10) {
+    for (int x = 3; x < 48; x += 12) {
+      seedMask.push_back(MakeWatershedTestSeed(label, x, 4 + label * 3, z));
+      ++label;
+    }
+  }
+
+  ZStackWatershed engine;
+  ZStack *result = engine.run(&stack, seedMask);
+  Stack *expected = MakeStackWatershedResult(&stack, seedMask);
+  ASSERT_TRUE(Stack_Identical(expected, result->c_stack()));
+  size_t labeledNumber = 0;
+  for (size_t i = 0; i < voxelNumber; ++i) {
+    if (expected->array[i] > 0) {
+      ++labeledNumber;
+    }
+  }
+  ASSERT_LT(voxelNumber / 2, labeledNumber);
+
+  C_Stack::kill(expected);
+  delete result;
+}
+
+#endif
+
+#endif // ZSTACKWATERSHEDTEST_H
@@ -0,0 +1,163 @@
+#ifndef ZSYNAPSESTORETEST_H
+#define ZSYNAPSESTORETEST_H
+
+#include <cstdlib>
+#include <set>
+
+#include "ztestheader.h"
+#include "flyem/zsynapseannotationarray.h"
+#include "flyem/zsynapsestore.h"
+
+#ifdef _USE_GTEST_
+
+static void CreateRandomSynapse(FlyEm::ZSynapseAnnotationArray *synapseArray,
+                                int synapseNumber, int bodyNumber)
+{
+  srand(1);
+  synapseArray->resize(synapseNumber);
+  for (int i = 0; i < synapseNumber; ++i) {
+    FlyEm::ZSynapseAnnotation &synapse = (*synapseArray)[i];
+    synapse.setTBar(rand() % 500, rand() % 500, rand() % 100,
+                    rand() % bodyNumber + 1, 1.0, "");
+    int partnerNumber = rand() % 5;
+    for (int j = 0; j < partnerNumber; ++j) {
+      synapse.addPartner(rand() % 500, rand() % 500, rand() % 100,
+                         rand() % bodyNumber + 1, 0.5, "");
+    }
+  }
+}
+
+TEST(ZSynapseStore, column)
+{
+  FlyEm::ZSynapseAnnotationArray synapseArray;
+  synapseArray.resize(2);
+  synapseArray[0].setTBar(1, 2, 3, 10, 0.9, "");
+  synapseArray[0].addPartner(4, 5, 6, 20, 0.5, "");
+  synapseArray[0].addPartner(7, 8, 9, 30, 0.5, "");
+  synapseArray[1].setTBar(10, 11, 12, 20, 0.8, "");
+  synapseArray[1].addPartner(13, 14, 15, 10, 0.5, "");
+
+  FlyEm::ZSynapseStore store;
+  store.build(synapseArray);
+
+  ASSERT_EQ(2, (int) store.getSynapseNumber());
+  ASSERT_EQ(5, (int) store.getLocationNumber());
+  ASSERT_TRUE(store.isTBar(0));
+  ASSERT_FALSE(store.isTBar(2));
+  ASSERT_TRUE(store.isTBar(3));
+  ASSERT_EQ(2, (int) store.getLocationRank(2));
+  ASSERT_EQ(1, store.getSynapseIndex(4));
+  ASSERT_EQ(3, (int) store.getSynapseStart(1));
+  ASSERT_EQ(5, (int) store.getSynapseEnd(1));
+  ASSERT_EQ(13, store.getX(4));
+  ASSERT_EQ(30, store.getBodyId(2));
+  ASSERT_FLOAT_EQ(0.8f, store.getConfidence(3));
+
+  ASSERT_EQ(3, (int) store.getBodyIdArray().size());
+  ASSERT_EQ(1, (int) store.countTBar(10));
+  ASSERT_EQ(1, (int) store.countPsd(10));
+  ASSERT_EQ(0, (int) store.countTBar(30));
+  ASSERT_EQ(0, (int) store.countTBar(40));
+  ASSERT_EQ(1, store.countConnection(10, 20));
+  ASSERT_EQ(1, store.countConnection(20, 10));
+  ASSERT_EQ(0, store.countConnection(30, 10));
+  ASSERT_EQ(2, (int) store.getDownstreamCount(10).size());
+  ASSERT_EQ(1, store.getUpstreamCount(20)[10]);
+
+  store.clear();
+  ASSERT_EQ(0, (int) store.getSynapseNumber());
+  ASSERT_TRUE(store.getBodyIdArray().empty());
+}
+
+TEST(ZSynapseStore, query)
+{
+  FlyEm::ZSynapseAnnotationArray synapseArray;
+  CreateRandomSynapse(&synapseArray, 2000, 50);
+
+  FlyEm::ZSynapseStore store;
+  store.build(synapseArray);
+
+  for (int bodyId = 0; bodyId <= 51; ++bodyId) {
+    int tbarCount = 0;
+    int psdCount = 0;
+    std::map<int, int> downstream;
+    for (size_t i = 0; i < synapseArray.size(); ++i) {
+      if (synapseArray[i].getTBarRef()->bodyId() == bodyId) {
+        ++tbarCount;
+        for (size_t j = 0; j < synapseArray[i].partnerNumber(); ++j) {
+          ++downstream[synapseArray[i].getPartnerRef(j)->bodyId()];
+        }
+      }
+      for (size_t j = 0; j < synapseArray[i].partnerNumber(); ++j) {
+        if (synapseArray[i].getPartnerRef(j)->bodyId() == bodyId) {
+          ++psdCount;
+        }
+      }
+    }
+    ASSERT_EQ(tbarCount, (int) store.countTBar(bodyId));
+    ASSERT_EQ(psdCount, (int) store.countPsd(bodyId));
+    ASSERT_EQ(downstream, store.getDownstreamCount(bodyId));
+    ASSERT_EQ(downstream[7], store.countConnection(bodyId, 7));
+  }
+}
+
+TEST(ZSynapseAnnotationArray, synapseStore)
+{
+  FlyEm::ZSynapseAnnotationArray synapseArray;
+  CreateRandomSynapse(&synapseArray, 500, 20);
+
+  std::vector<int> tbarCount = synapseArray.countTBar();
+  std::vector<int> psdCount = synapseArray.countPsd();
+  for (int bodyId = 1; bodyId <= 20; ++bodyId) {
+    ASSERT_EQ(tbarCount[bodyId], synapseArray.countTBar(bodyId));
+    ASSERT_EQ(psdCount[bodyId], synapseArray.countPsd(bodyId));
+    ASSERT_EQ(tbarCount[bodyId],
+              (int) synapseArray.getTBarArray(bodyId).size());
+    std::vector<FlyEm::SynapseLocation*> psdArray =
+        synapseArray.getPsdArray(bodyId);
+    ASSERT_EQ(psdCount[bodyId], (int) psdArray.size());
+    for (size_t i = 0; i < psdArray.size(); ++i) {
+      ASSERT_TRUE(psdArray[i]->isPartner());
+      ASSERT_EQ(bodyId, psdArray[i]->bodyId());
+    }
+  }
+
+  FlyEm::SynapseAnnotationConfig config;
+  FlyEm::SynapseDisplayConfig displayConfig;
+  displayConfig.bodyId = 5;
+  ASSERT_EQ(tbarCount[5] + psdCount[5],
+            (int) synapseArray.toMarkerArray(
+              config, FlyEm::SynapseLocation::CURRENT_SPACE,
+              displayConfig).size());
+
+  displayConfig.mode = FlyEm::SynapseDisplayConfig::SYNAPSE_PAIR;
+  int locationNumber = 0;
+  for (size_t i = 0; i < synapseArray.size(); ++i) {
+    //A T-bar is paired with all partners and a partner with its T-bar
+    bool tbarOnBody = (synapseArray[i].getTBarRef()->bodyId() == 5);
+    bool partnerOnBody = false;
+    for (size_t j = 0; j < synapseArray[i].partnerNumber(); ++j) {
+      if (tbarOnBody || synapseArray[i].getPartnerRef(j)->bodyId() == 5) {
+        partnerOnBody = true;
+        ++locationNumber;
+      }
+    }
+    if (tbarOnBody || partnerOnBody) {
+      ++locationNumber;
+    }
+  }
+  ASSERT_EQ(locationNumber,
+            (int) synapseArray.toMarkerArray(
+              config, FlyEm::SynapseLocation::CURRENT_SPACE,
+              displayConfig).size());
+
+  ASSERT_FALSE(synapseArray.isDeprecated(
+                 FlyEm::ZSynapseAnnotationArray::SYNAPSE_STORE));
+  synapseArray[0].getTBarRef()->setLocation(1000, 1000, 1000);
+  synapseArray.deprecate(FlyEm::ZSynapseAnnotationArray::SYNAPSE_STORE);
+  ASSERT_EQ(1000, synapseArray.getSynapseStore().getX(0));
+}
+
+#endif
+
+#endif // ZSYNAPSESTORETEST_H
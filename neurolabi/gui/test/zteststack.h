@@ -0,0 +1,45 @@
+#ifndef ZTESTSTACK_H
+#define ZTESTSTACK_H
+
+#include <cstdlib>
+
+#include "c_stack.h"
+#include "tz_stack_relation.h"
+
+#ifdef _USE_GTEST_
+
+/* Fill <array> of <voxelNumber> voxels of <kind> with random values. The
+ * generator is reset first, so the values only depend on the arguments.
+ * Floating point voxels get finite values. */
+static void FillRandomTestArray(uint8_t *array, int kind, size_t voxelNumber)
+{
+  srand(1);
+  size_t byteNumber = voxelNumber * kind;
+  for (size_t i = 0; i < byteNumber; ++i) {
+    array[i] = rand() % 256;
+  }
+
+  if (kind == FLOAT32) {
+    float *floatArray = (float*) array;
+    for (size_t i = 0; i < voxelNumber; ++i) {
+      floatArray[i] = (rand() % 10000) / 7.0;
+    }
+  } else if (kind == FLOAT64) {
+    double *doubleArray = (double*) array;
+    for (size_t i = 0; i < voxelNumber; ++i) {
+      doubleArray[i] = (rand() % 10000) / 7.0;
+    }
+  }
+}
+
+static Stack* MakeRandomTestStack(int kind, int width, int height, int depth)
+{
+  Stack *stack = C_Stack::make(kind, width, height, depth);
+  FillRandomTestArray(stack->array, kind, C_Stack::voxelNumber(stack));
+
+  return stack;
+}
+
+#endif
+
+#endif // ZTESTSTACK_H
@@ -8,6 +8,7 @@
 #include "zsparsestack.h"
 #include "zstack.hxx"
 #include "zstackdoc.h"
+#include "zstackresampler.h"
 const size_t Z3DVolumeSource::m_nChannelSupport = 10;
 constexpr int kHardMaxTextureClamp = 1024;
 // Use when you know if the texture will be 3D (volume) or 2D
@@ -260,7 +261,8 @@ void Z3DVolumeSource::readSparseStack() {
         int xIntv = C_Stack::width(stack) / width;
         int yIntv = C_Stack::height(stack) / height;
         int zIntv = C_Stack::depth(stack) / depth;
-        stack2 = Downsample_Stack_Max(stack, xIntv, yIntv, zIntv, NULL);
+        stack2 = ZStackResampler().downsample(
+              stack, xIntv, yIntv, zIntv, STACK_DOWNSAMPLE_MAX);
         widthScale = 1.0 / ((xIntv + 1) * (dsIntv.getX() + 1));
         heightScale = 1.0 / ((yIntv + 1) * (dsIntv.getY() + 1));
         depthScale = 1.0 / ((zIntv + 1) * (dsIntv.getZ() + 1));
@@ -448,8 +450,8 @@ void Z3DVolumeSource::readSparseVolume() {
     return;
   }
   clearVolume();
-  ZSparseObject obj = *(m_doc->getSparseObjectList().front());
-  QColor color = obj.getColor();
+  const ZSparseObject* sparseObj = m_doc->getSparseObjectList().front();
+  QColor color = sparseObj->getColor();
   int nchannel = 1;
   if(color.green() > 0) {
     nchannel = 2;
@@ -474,7 +476,7 @@ void Z3DVolumeSource::readSparseVolume() {
   if(depth > maxTextureSize) {
     zIntv += depth / maxTextureSize;
   }
-  obj.downsampleMax(xIntv, yIntv, zIntv);
+  ZObject3dScan obj = sparseObj->getDownsampledMax(xIntv, yIntv, zIntv);
   int offset[3];
   int rgb[3];
   rgb[0] = color.red();
@@ -503,8 +505,8 @@ void Z3DVolumeSource::readSparseVolumeWithObject() {
   if(m_doc == NULL) { return; }
   if(!m_doc->hasStack() || m_doc->getSparseObjectList().isEmpty()) { return; }
   clearVolume();
-  ZSparseObject obj = *(m_doc->getSparseObjectList().front());
-  QColor color = obj.getColor();
+  const ZSparseObject* sparseObj = m_doc->getSparseObjectList().front();
+  QColor color = sparseObj->getColor();
   int nchannel = 3;
   ZIntPoint dsIntv = misc::getDsIntvFor3DVolume(m_doc->getStack()->getBoundBox());
   int xIntv = dsIntv.getX();
@@ -523,7 +525,7 @@ void Z3DVolumeSource::readSparseVolumeWithObject() {
   if(depth > maxTextureSize) {
     zIntv += depth / maxTextureSize;
   }
-  obj.downsampleMax(xIntv, yIntv, zIntv);
+  ZObject3dScan obj = sparseObj->getDownsampledMax(xIntv, yIntv, zIntv);
   int offset[3];
   int rgb[3];
   rgb[0] = color.red();
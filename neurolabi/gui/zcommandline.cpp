@@ -21,6 +21,9 @@
 #include "flyem/zflyemneuronfeatureanalyzer.h"
 #include "flyem/zflyemneuronfeatureset.h"
 #include "zstackskeletonizer.h"
+#include "zstackfile.h"
+#include "zstack.hxx"
+#include "zintpoint.h"
 #include "dvid/zdvidreader.h"
 #include "dvid/zdvidwriter.h"
 #include "neutubeconfig.h"
@@ -682,14 +685,27 @@ int ZCommandLine::runSkeletonize()
                           NeuTube::MSG_ERROR);
         return 1;
       }
-      ZStack stack;
-      stack.load(m_input[0]);
+      //Downsample while reading so that a large stack does not have to fit
+      //in memory. Downsampling by maximum commutes with binarization.
+      int xintv, yintv, zintv;
+      skeletonizer.getDownsampleInterval(&xintv, &yintv, &zintv);
+      ZStackFile stackFile;
+      stackFile.import(m_input[0]);
+      ZStack *stack = stackFile.readStack(ZIntPoint(xintv, yintv, zintv),
+                                          STACK_DOWNSAMPLE_MAX);
+      if (stack == NULL) {
+        m_reporter.report("Skeletonization Failed",
+                          "Cannot read " + m_input[0],
+                          NeuTube::MSG_ERROR);
+        return 1;
+      }
 
-      if (!stack.isBinary()) {
+      if (!stack->isBinary()) {
         std::cout << "The image is not binary. Binarizing..." << std::endl;
-        stack.binarize();
+        stack->binarize();
       }
-      tree = skeletonizer.makeSkeleton(stack);
+      tree = skeletonizer.makeSkeletonFromDownsampled(*stack);
+      delete stack;
     } else if (ZFileType::fileType(m_input[0]) == ZFileType::OBJECT_SCAN_FILE) {
       ZObject3dScan obj;
       obj.load(m_input[0]);
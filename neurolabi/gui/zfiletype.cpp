@@ -70,6 +70,8 @@ ZFileType::EFileType ZFileType::fileType(const std::string &filePath)
     return HDF5_FILE;
   } else if (str.endsWith(".mraw", ZString::CASE_INSENSITIVE)) {
     return MC_STACK_RAW_FILE;
+  } else if (str.endsWith(".zck", ZString::CASE_INSENSITIVE)) {
+    return CHUNKED_STACK_FILE;
   }
   return UNIDENTIFIED_FILE;
 }
@@ -111,6 +113,8 @@ std::string ZFileType::typeName(EFileType type)
     return "Neuron segmentation";
   case HDF5_FILE:
     return "HDF5";
+  case CHUNKED_STACK_FILE:
+    return "Chunked stack";
   default:
     return "Unknown";
   }
@@ -126,7 +130,8 @@ bool ZFileType::isImageFile(EFileType type)
       (type == MYERS_NSP_FILE) || /*(type == OBJECT_SCAN_FILE) ||*/
       (type == JPG_FILE) ||
       (type == DVID_OBJECT_FILE) ||
-      (type == MC_STACK_RAW_FILE);
+      (type == MC_STACK_RAW_FILE) ||
+      (type == CHUNKED_STACK_FILE);
 }
 
 bool ZFileType::isImageFile(const std::string &filePath)
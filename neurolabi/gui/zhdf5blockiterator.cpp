@@ -0,0 +1,109 @@
+#include "zhdf5blockiterator.h"
+
+#include <algorithm>
+
+#include "zhdf5reader.h"
+#include "zarray.h"
+
+ZHdf5BlockIterator::ZHdf5BlockIterator(
+    ZHdf5Reader *reader, const std::string &dataPath) :
+  m_reader(reader), m_dataPath(dataPath), m_dataset(-1), m_isEnd(true)
+{
+  if (m_reader != NULL) {
+    m_datasetDims = m_reader->getDatasetDims(dataPath);
+    m_chunkDims = m_reader->getChunkDims(dataPath);
+    if (!m_datasetDims.empty()) {
+      m_dataset = m_reader->openDataset(dataPath);
+    }
+  }
+
+  if (!m_datasetDims.empty()) {
+    if (m_chunkDims.size() == m_datasetDims.size()) {
+      setBlockDims(m_chunkDims);
+    } else {
+      std::vector<int> dims = m_datasetDims;
+      if (dims.size() > 1) {
+        dims[0] = 1;
+      }
+      setBlockDims(dims);
+    }
+  }
+}
+
+ZHdf5BlockIterator::~ZHdf5BlockIterator()
+{
+  if (m_reader != NULL) {
+    m_reader->closeDataset(m_dataset);
+  }
+}
+
+void ZHdf5BlockIterator::setBlockDims(const std::vector<int> &dims)
+{
+  if (dims.size() != m_datasetDims.size()) {
+    return;
+  }
+
+  bool isChunked = (m_chunkDims.size() == m_datasetDims.size());
+
+  m_blockDims.resize(dims.size());
+  for (size_t i = 0; i < dims.size(); ++i) {
+    int blockSize = std::max(1, dims[i]);
+    if (isChunked) {
+      int chunkSize = m_chunkDims[i];
+      blockSize = (blockSize + chunkSize - 1) / chunkSize * chunkSize;
+    }
+    m_blockDims[i] = std::min(blockSize, m_datasetDims[i]);
+  }
+
+  reset();
+}
+
+size_t ZHdf5BlockIterator::getBlockNumber() const
+{
+  if (m_datasetDims.empty()) {
+    return 0;
+  }
+
+  size_t blockNumber = 1;
+  for (size_t i = 0; i < m_datasetDims.size(); ++i) {
+    if (m_blockDims[i] <= 0) {
+      return 0;
+    }
+    blockNumber *= (m_datasetDims[i] + m_blockDims[i] - 1) / m_blockDims[i];
+  }
+
+  return blockNumber;
+}
+
+bool ZHdf5BlockIterator::hasNext() const
+{
+  return !m_isEnd;
+}
+
+void ZHdf5BlockIterator::reset()
+{
+  m_blockStart.assign(m_datasetDims.size(), 0);
+  m_isEnd = (getBlockNumber() == 0);
+}
+
+ZArray* ZHdf5BlockIterator::next()
+{
+  if (m_isEnd) {
+    return NULL;
+  }
+
+  ZArray *array = m_reader->readArrayBlock(m_dataset, m_blockStart,
+                                           m_blockDims);
+
+  m_isEnd = true;
+  for (int i = (int) m_blockStart.size() - 1; i >= 0; --i) {
+    m_blockStart[i] += m_blockDims[i];
+    if (m_blockStart[i] < m_datasetDims[i]) {
+      m_isEnd = false;
+      break;
+    }
+    m_blockStart[i] = 0;
+  }
+
+  return array;
+}
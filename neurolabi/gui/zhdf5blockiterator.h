@@ -0,0 +1,87 @@
+#ifndef ZHDF5BLOCKITERATOR_H
+#define ZHDF5BLOCKITERATOR_H
+
+#include <string>
+#include <vector>
+
+#include "zhdf5_header.h"
+
+class ZHdf5Reader;
+class ZArray;
+
+/*!
+ * \brief The class of iterating through the blocks of an HDF5 dataset
+ *
+ * The blocks are aligned with the chunks of the dataset so that each chunk is
+ * decompressed only once. By default a block is a chunk, or a slice along the
+ * first dimension if the dataset is not chunked. The blocks are visited with
+ * the last dimension changing fastest. The dataset is kept open while the
+ * iterator exists, so the reader must outlive the iterator.
+ *
+ * Usage:
+ *  ZHdf5Reader reader;
+ *  reader.open("test.h5");
+ *  ZHdf5BlockIterator iter(&reader, "/labels");
+ *  while (iter.hasNext()) {
+ *    ZArray *block = iter.next();
+ *    ...
+ *    delete block;
+ *  }
+ */
+class ZHdf5BlockIterator
+{
+public:
+  ZHdf5BlockIterator(ZHdf5Reader *reader, const std::string &dataPath);
+  ~ZHdf5BlockIterator();
+
+  /*!
+   * \brief Set the size of a block
+   *
+   * Each dimension is rounded up to a multiple of the chunk size and clipped
+   * by the dataset. Nothing is done if \a dims does not match the dataset. The
+   * iterator is reset.
+   */
+  void setBlockDims(const std::vector<int> &dims);
+
+  inline const std::vector<int>& getBlockDims() const {
+    return m_blockDims;
+  }
+  inline const std::vector<int>& getDatasetDims() const {
+    return m_datasetDims;
+  }
+  inline const std::vector<int>& getChunkDims() const {
+    return m_chunkDims;
+  }
+
+  size_t getBlockNumber() const;
+
+  bool hasNext() const;
+
+  /*!
+   * \brief Read the next block
+   *
+   * The start coordinates of the returned array are the position of the block
+   * in the dataset. The caller is responsible for freeing the array.
+   *
+   * \return NULL if there is no block left or the block cannot be read.
+   */
+  ZArray* next();
+
+  void reset();
+
+private:
+  ZHdf5BlockIterator(const ZHdf5BlockIterator&);
+  ZHdf5BlockIterator& operator=(const ZHdf5BlockIterator&);
+
+private:
+  ZHdf5Reader *m_reader;
+  std::string m_dataPath;
+  hid_t m_dataset;
+  std::vector<int> m_datasetDims;
+  std::vector<int> m_chunkDims;
+  std::vector<int> m_blockDims;
+  std::vector<int> m_blockStart; //start of the next block
+  bool m_isEnd;
+};
+
+#endif // ZHDF5BLOCKITERATOR_H
@@ -1,7 +1,9 @@
 #include "zhdf5reader.h"
 
 #include <string>
+#include <algorithm>
 #include "tz_utilities.h"
+#include "zarray.h"
 
 using namespace std;
 
@@ -27,6 +29,9 @@ bool ZHdf5Reader::open(const std::string &source)
 
 #if defined(_ENABLE_HDF5_)
   m_file = H5Fopen(source.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+  if (m_file < 0) {
+    m_file = NULL_FILE;
+  }
 #endif
 
   return (m_file != NULL_FILE);
@@ -42,6 +47,56 @@ void ZHdf5Reader::close()
 #endif
 }
 
+mylib::Value_Type ZHdf5Reader::GetValueType(hid_t datatype, hid_t *nativeType)
+{
+  mylib::Value_Type arrayType = mylib::UNKNOWN_TYPE;
+
+#if defined(_ENABLE_HDF5_)
+  hid_t memType = H5T_NATIVE_CHAR;
+
+  if (H5Tequal(datatype, H5T_STD_U8BE) || H5Tequal(datatype, H5T_STD_U8LE)) {
+    arrayType = mylib::UINT8_TYPE;
+    memType = H5T_NATIVE_UINT8;
+  } else if (H5Tequal(datatype, H5T_STD_I8BE) || H5Tequal(datatype, H5T_STD_I8LE)) {
+    arrayType = mylib::INT8_TYPE;
+    memType = H5T_NATIVE_INT8;
+  } else if (H5Tequal(datatype, H5T_STD_U16BE) || H5Tequal(datatype, H5T_STD_U16LE)) {
+    arrayType = mylib::UINT16_TYPE;
+    memType = H5T_NATIVE_UINT16;
+  } else if (H5Tequal(datatype, H5T_STD_I16BE) || H5Tequal(datatype, H5T_STD_I16LE)) {
+    arrayType = mylib::INT16_TYPE;
+    memType = H5T_NATIVE_INT16;
+  } else if (H5Tequal(datatype, H5T_STD_U32BE) || H5Tequal(datatype, H5T_STD_U32LE)) {
+    arrayType = mylib::UINT32_TYPE;
+    memType = H5T_NATIVE_UINT32;
+  } else if (H5Tequal(datatype, H5T_STD_I32BE) || H5Tequal(datatype, H5T_STD_I32LE)) {
+    arrayType = mylib::INT32_TYPE;
+    memType = H5T_NATIVE_INT32;
+  } else if (H5Tequal(datatype, H5T_STD_I64BE) || H5Tequal(datatype, H5T_STD_I64LE)) {
+    arrayType = mylib::INT64_TYPE;
+    memType = H5T_NATIVE_INT64;
+  } else if (H5Tequal(datatype, H5T_STD_U64BE) || H5Tequal(datatype, H5T_STD_U64LE)) {
+    arrayType = mylib::UINT64_TYPE;
+    memType = H5T_NATIVE_UINT64;
+  } else if (H5Tequal(datatype, H5T_IEEE_F32BE) || H5Tequal(datatype, H5T_IEEE_F32LE)) {
+    arrayType = mylib::FLOAT32_TYPE;
+    memType = H5T_NATIVE_FLOAT;
+  } else if (H5Tequal(datatype, H5T_IEEE_F64BE) || H5Tequal(datatype, H5T_IEEE_F64LE)) {
+    arrayType = mylib::FLOAT64_TYPE;
+    memType = H5T_NATIVE_DOUBLE;
+  }
+
+  if (nativeType != NULL) {
+    *nativeType = memType;
+  }
+#else
+  UNUSED_PARAMETER(datatype);
+  UNUSED_PARAMETER(nativeType);
+#endif
+
+  return arrayType;
+}
+
 std::vector<int> ZHdf5Reader::readIntArray(const string &dataPath)
 {
   std::vector<int> array;
@@ -86,45 +141,8 @@ mylib::Array* ZHdf5Reader::readArray(const std::string &dataPath)
   hid_t dset = H5Dopen(m_file, dataPath.c_str(), H5P_DEFAULT);
   hid_t space = H5Dget_space(dset);
   hid_t datatype = H5Dget_type(dset);
-  //H5T_class_t dataClass = H5Tget_class(datatype);
-  mylib::Value_Type arrayType;
-
   hid_t nativeType;
-
-  if (H5Tequal(datatype, H5T_STD_I8BE) || H5Tequal(datatype, H5T_STD_I8LE)) {
-    arrayType = mylib::UINT8_TYPE;
-    nativeType = H5T_NATIVE_CHAR;
-  } else if (H5Tequal(datatype, H5T_STD_I8BE) || H5Tequal(datatype, H5T_STD_I8LE)) {
-    arrayType = mylib::INT8_TYPE;
-    nativeType = H5T_NATIVE_UCHAR;
-  } else if (H5Tequal(datatype, H5T_STD_U16BE) || H5Tequal(datatype, H5T_STD_U16LE)) {
-    arrayType = mylib::UINT16_TYPE;
-    nativeType = H5T_NATIVE_UINT16;
-  } else if (H5Tequal(datatype, H5T_STD_I16BE) || H5Tequal(datatype, H5T_STD_I16LE)) {
-    arrayType = mylib::INT16_TYPE;
-    nativeType = H5T_NATIVE_INT16;
-  } else if (H5Tequal(datatype, H5T_STD_U32BE) || H5Tequal(datatype, H5T_STD_U32LE)) {
-    arrayType = mylib::UINT32_TYPE;
-    nativeType = H5T_NATIVE_UINT32;
-  } else if (H5Tequal(datatype, H5T_STD_I32BE) || H5Tequal(datatype, H5T_STD_I32LE)) {
-    arrayType = mylib::INT32_TYPE;
-    nativeType = H5T_NATIVE_INT32;
-  } else if (H5Tequal(datatype, H5T_STD_I64BE) || H5Tequal(datatype, H5T_STD_I64LE)) {
-    arrayType = mylib::INT64_TYPE;
-    nativeType = H5T_NATIVE_INT64;
-  } else if (H5Tequal(datatype, H5T_STD_U64BE) || H5Tequal(datatype, H5T_STD_U64LE)) {
-    arrayType = mylib::UINT64_TYPE;
-    nativeType = H5T_NATIVE_UINT64;
-  } else if (H5Tequal(datatype, H5T_IEEE_F32BE) || H5Tequal(datatype, H5T_IEEE_F32LE)) {
-    arrayType = mylib::FLOAT32_TYPE;
-    nativeType = H5T_NATIVE_FLOAT;
-  } else if (H5Tequal(datatype, H5T_IEEE_F64BE) || H5Tequal(datatype, H5T_IEEE_F64LE)) {
-    arrayType = mylib::FLOAT64_TYPE;
-    nativeType = H5T_NATIVE_DOUBLE;
-  } else {
-    arrayType = mylib::UNKNOWN_TYPE;
-    nativeType = H5T_NATIVE_CHAR;
-  }
+  mylib::Value_Type arrayType = GetValueType(datatype, &nativeType);
 
   if (arrayType != mylib::UNKNOWN_TYPE) {
     //int ndim = H5Sget_simple_extent_ndims(datatype);
@@ -160,6 +178,184 @@ mylib::Array* ZHdf5Reader::readArray(const std::string &dataPath)
   return array;
 }
 
+std::vector<int> ZHdf5Reader::getDatasetDims(const std::string &dataPath)
+{
+  std::vector<int> dims;
+
+#if defined(_ENABLE_HDF5_)
+  if (m_file != NULL_FILE) {
+    hid_t dset = H5Dopen(m_file, dataPath.c_str(), H5P_DEFAULT);
+    if (dset >= 0) {
+      hid_t space = H5Dget_space(dset);
+      int ndim = H5Sget_simple_extent_ndims(space);
+      if (ndim > 0) {
+        std::vector<hsize_t> spaceDims(ndim);
+        H5Sget_simple_extent_dims(space, &(spaceDims[0]), NULL);
+        dims.assign(spaceDims.begin(), spaceDims.end());
+      }
+      H5Sclose(space);
+      H5Dclose(dset);
+    }
+  }
+#else
+  UNUSED_PARAMETER(&dataPath);
+#endif
+
+  return dims;
+}
+
+std::vector<int> ZHdf5Reader::getChunkDims(const std::string &dataPath)
+{
+  std::vector<int> dims;
+
+#if defined(_ENABLE_HDF5_)
+  if (m_file != NULL_FILE) {
+    hid_t dset = H5Dopen(m_file, dataPath.c_str(), H5P_DEFAULT);
+    if (dset >= 0) {
+      hid_t plist = H5Dget_create_plist(dset);
+      if (H5Pget_layout(plist) == H5D_CHUNKED) {
+        hsize_t chunkDims[H5S_MAX_RANK];
+        int ndim = H5Pget_chunk(plist, H5S_MAX_RANK, chunkDims);
+        if (ndim > 0) {
+          dims.assign(chunkDims, chunkDims + ndim);
+        }
+      }
+      H5Pclose(plist);
+      H5Dclose(dset);
+    }
+  }
+#else
+  UNUSED_PARAMETER(&dataPath);
+#endif
+
+  return dims;
+}
+
+mylib::Value_Type ZHdf5Reader::getValueType(const std::string &dataPath)
+{
+  mylib::Value_Type arrayType = mylib::UNKNOWN_TYPE;
+
+#if defined(_ENABLE_HDF5_)
+  if (m_file != NULL_FILE) {
+    hid_t dset = H5Dopen(m_file, dataPath.c_str(), H5P_DEFAULT);
+    if (dset >= 0) {
+      hid_t datatype = H5Dget_type(dset);
+      arrayType = GetValueType(datatype, NULL);
+      H5Tclose(datatype);
+      H5Dclose(dset);
+    }
+  }
+#else
+  UNUSED_PARAMETER(&dataPath);
+#endif
+
+  return arrayType;
+}
+
+hid_t ZHdf5Reader::openDataset(const std::string &dataPath)
+{
+  hid_t dset = -1;
+
+#if defined(_ENABLE_HDF5_)
+  if (m_file != NULL_FILE) {
+    dset = H5Dopen(m_file, dataPath.c_str(), H5P_DEFAULT);
+  }
+#else
+  UNUSED_PARAMETER(&dataPath);
+#endif
+
+  return dset;
+}
+
+void ZHdf5Reader::closeDataset(hid_t dataset)
+{
+#if defined(_ENABLE_HDF5_)
+  if (dataset >= 0) {
+    H5Dclose(dataset);
+  }
+#else
+  UNUSED_PARAMETER(&dataset);
+#endif
+}
+
+ZArray* ZHdf5Reader::readArrayBlock(
+    const std::string &dataPath, const std::vector<int> &start,
+    const std::vector<int> &count)
+{
+  hid_t dset = openDataset(dataPath);
+  ZArray *array = readArrayBlock(dset, start, count);
+  closeDataset(dset);
+
+  return array;
+}
+
+ZArray* ZHdf5Reader::readArrayBlock(
+    hid_t dset, const std::vector<int> &start, const std::vector<int> &count)
+{
+  ZArray *array = NULL;
+
+#if defined(_ENABLE_HDF5_)
+  if (dset < 0) {
+    return NULL;
+  }
+
+  hid_t space = H5Dget_space(dset);
+  hid_t datatype = H5Dget_type(dset);
+  hid_t nativeType;
+  mylib::Value_Type arrayType = GetValueType(datatype, &nativeType);
+
+  int ndim = H5Sget_simple_extent_ndims(space);
+  if (arrayType != mylib::UNKNOWN_TYPE && ndim > 0 &&
+      (int) start.size() == ndim && (int) count.size() == ndim) {
+    std::vector<hsize_t> dims(ndim);
+    H5Sget_simple_extent_dims(space, &(dims[0]), NULL);
+
+    //Clip the block by the dataset
+    std::vector<hsize_t> blockStart(ndim);
+    std::vector<hsize_t> blockCount(ndim);
+    std::vector<mylib::Dimn_Type> arrayDims(ndim);
+    bool isEmpty = false;
+    for (int i = 0; i < ndim; ++i) {
+      int64_t x0 = std::max(start[i], 0);
+      int64_t x1 = std::min((int64_t) start[i] + count[i], (int64_t) dims[i]);
+      if (x1 <= x0) {
+        isEmpty = true;
+        break;
+      }
+      blockStart[i] = x0;
+      blockCount[i] = x1 - x0;
+      arrayDims[i] = x1 - x0;
+    }
+
+    if (!isEmpty) {
+      array = new ZArray(arrayType, ndim, &(arrayDims[0]));
+      hid_t memSpace = H5Screate_simple(ndim, &(blockCount[0]), NULL);
+      H5Sselect_hyperslab(space, H5S_SELECT_SET, &(blockStart[0]), NULL,
+                          &(blockCount[0]), NULL);
+      if (H5Dread(dset, nativeType, memSpace, space, H5P_DEFAULT,
+                  array->getDataPointer<void>()) < 0) {
+        delete array;
+        array = NULL;
+      } else {
+        for (int i = 0; i < ndim; ++i) {
+          array->setStartCoordinate(i, blockStart[i]);
+        }
+      }
+      H5Sclose(memSpace);
+    }
+  }
+
+  H5Tclose(datatype);
+  H5Sclose(space);
+#else
+  UNUSED_PARAMETER(&dset);
+  UNUSED_PARAMETER(&start);
+  UNUSED_PARAMETER(&count);
+#endif
+
+  return array;
+}
+
 typedef struct _Hdf5PrintOpData {
   int indent;
   char *path;
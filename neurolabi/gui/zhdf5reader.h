@@ -7,6 +7,8 @@
 #include "zhdf5_header.h"
 #include "mylib/array.h"
 
+class ZArray;
+
 /**
  * @brief The class for reading hdf5 files
  *
@@ -35,6 +37,55 @@ public:
 
   std::vector<int> readIntArray(const std::string &dataPath);
 
+  /*!
+   * \brief Read a block of a dataset
+   *
+   * The block starts at \a start and has the size \a count. Both are in the
+   * dimension order of the dataset, i.e. the slowest dimension comes first. The
+   * block is clipped by the dataset and the start coordinates of the returned
+   * array are set to the start of the clipped block. Only the selected part of
+   * the dataset is read, which allows to process a dataset much larger than the
+   * memory block by block.
+   *
+   * \return NULL if the block is empty or the data type is not supported.
+   */
+  ZArray* readArrayBlock(const std::string &dataPath,
+                         const std::vector<int> &start,
+                         const std::vector<int> &count);
+
+  /*!
+   * \brief Read a block of a dataset opened by openDataset()
+   *
+   * It avoids opening the dataset for each block.
+   */
+  ZArray* readArrayBlock(hid_t dataset, const std::vector<int> &start,
+                         const std::vector<int> &count);
+
+  /*!
+   * \brief Open a dataset for reading blocks repeatedly
+   *
+   * \return A negative value if the dataset cannot be opened. A valid handle
+   *         must be closed by closeDataset().
+   */
+  hid_t openDataset(const std::string &dataPath);
+  void closeDataset(hid_t dataset);
+
+  /*!
+   * \brief Get the dimensions of a dataset
+   *
+   * \return An empty array if the dataset does not exist.
+   */
+  std::vector<int> getDatasetDims(const std::string &dataPath);
+
+  /*!
+   * \brief Get the chunk dimensions of a dataset
+   *
+   * \return An empty array if the dataset is not chunked.
+   */
+  std::vector<int> getChunkDims(const std::string &dataPath);
+
+  mylib::Value_Type getValueType(const std::string &dataPath);
+
   static herr_t printObjectInfo(hid_t loc_id, const char *name, void *opdata);
   void printInfo();
 
@@ -44,6 +95,7 @@ public:
   std::vector<std::string> getAllDatasetName(const std::string &group);
 
 private:
+  static mylib::Value_Type GetValueType(hid_t datatype, hid_t *nativeType);
   static herr_t getDataSetName(hid_t loc_id, const char *name, void *opdata);
 
 private:
@@ -1,16 +1,19 @@
 #include "zhdf5writer.h"
 
 #include <string.h>
+#include <algorithm>
 
 #include "tz_utilities.h"
 #include "mylib/array.h"
 #include "zstring.h"
+#include "zarray.h"
+#include "zstack.hxx"
 
 ZHdf5Writer::ZHdf5Writer() : m_file(NULL_FILE)
 {
 }
 
-ZHdf5Writer::ZHdf5Writer(const std::string &source)
+ZHdf5Writer::ZHdf5Writer(const std::string &source) : m_file(NULL_FILE)
 {
   open(source);
 }
@@ -31,6 +34,9 @@ bool ZHdf5Writer::open(const std::string &filePath)
     m_file = H5Fcreate(filePath.c_str(), H5F_ACC_EXCL, H5P_DEFAULT,
                        H5P_DEFAULT);
   }
+  if (m_file < 0) {
+    m_file = NULL_FILE;
+  }
 #endif
 
   return (m_file != NULL_FILE);
@@ -42,6 +48,9 @@ bool ZHdf5Writer::open(const std::string &filePath, unsigned flags)
 
 #if defined(_ENABLE_HDF5_)
   m_file = H5Fopen(filePath.c_str(), flags, H5P_DEFAULT);
+  if (m_file < 0) {
+    m_file = NULL_FILE;
+  }
 #endif
 
   return (m_file != NULL_FILE);
@@ -77,79 +86,101 @@ void ZHdf5Writer::createGroup(const std::string &group)
 #endif
 }
 
-void ZHdf5Writer::writeArray(const std::string &path, const mylib::Array *array)
+void ZHdf5Writer::createParentGroup(const std::string &path)
 {
-#if defined(_ENABLE_HDF5_)
-  hsize_t dims[array->ndims];
-  for (int i = 0; i < array->ndims; ++i) {
-    dims[i] = array->dims[i];
+  std::vector<std::string> pathArray = ZString::decomposePath(path);
+  if (pathArray.size() > 1) {
+    size_t startIndex = 0;
+    if (pathArray[0] == "/") {
+      ++startIndex;
+    }
+    if (startIndex < pathArray.size() - 1) {
+      std::string group = pathArray[startIndex];
+      createGroup(group);
+      for (size_t i = startIndex + 1; i < pathArray.size() - 1; ++i) {
+        group = group + "/" + pathArray[i];
+        createGroup(group);
+      }
+    }
   }
+}
 
-  hid_t type_id;
-  hid_t mem_type_id;
-
-  switch (array->type) {
+bool ZHdf5Writer::GetHdf5Type(
+    mylib::Value_Type type, hid_t *fileType, hid_t *memType)
+{
+#if defined(_ENABLE_HDF5_)
+  switch (type) {
   case mylib::INT8_TYPE:
-    type_id = H5T_STD_I8BE;
-    mem_type_id = H5T_NATIVE_INT8;
+    *fileType = H5T_STD_I8BE;
+    *memType = H5T_NATIVE_INT8;
     break;
   case mylib::UINT8_TYPE:
-    type_id = H5T_STD_U8BE;
-    mem_type_id = H5T_NATIVE_UINT8;
+    *fileType = H5T_STD_U8BE;
+    *memType = H5T_NATIVE_UINT8;
     break;
   case mylib::INT16_TYPE:
-    type_id = H5T_STD_I16BE;
-    mem_type_id = H5T_NATIVE_INT16;
+    *fileType = H5T_STD_I16BE;
+    *memType = H5T_NATIVE_INT16;
     break;
   case mylib::UINT16_TYPE:
-    type_id = H5T_STD_U16BE;
-    mem_type_id = H5T_NATIVE_UINT16;
+    *fileType = H5T_STD_U16BE;
+    *memType = H5T_NATIVE_UINT16;
     break;
   case mylib::INT32_TYPE:
-    type_id = H5T_STD_I32BE;
-    mem_type_id = H5T_NATIVE_INT32;
+    *fileType = H5T_STD_I32BE;
+    *memType = H5T_NATIVE_INT32;
     break;
   case mylib::UINT32_TYPE:
-    type_id = H5T_STD_U16BE;
-    mem_type_id = H5T_NATIVE_UINT16;
+    *fileType = H5T_STD_U32BE;
+    *memType = H5T_NATIVE_UINT32;
     break;
   case mylib::INT64_TYPE:
-    type_id = H5T_STD_I64BE;
-    mem_type_id = H5T_NATIVE_INT64;
+    *fileType = H5T_STD_I64BE;
+    *memType = H5T_NATIVE_INT64;
     break;
   case mylib::UINT64_TYPE:
-    type_id = H5T_STD_U64BE;
-    mem_type_id = H5T_NATIVE_UINT64;
+    *fileType = H5T_STD_U64BE;
+    *memType = H5T_NATIVE_UINT64;
     break;
   case mylib::FLOAT32_TYPE:
-    type_id = H5T_IEEE_F32BE;
-    mem_type_id = H5T_NATIVE_FLOAT;
+    *fileType = H5T_IEEE_F32BE;
+    *memType = H5T_NATIVE_FLOAT;
     break;
   case mylib::FLOAT64_TYPE:
-    type_id = H5T_IEEE_F64BE;
-    mem_type_id = H5T_NATIVE_DOUBLE;
+    *fileType = H5T_IEEE_F64BE;
+    *memType = H5T_NATIVE_DOUBLE;
     break;
   default:
+    return false;
+  }
+
+  return true;
+#else
+  UNUSED_PARAMETER(type);
+  UNUSED_PARAMETER(fileType);
+  UNUSED_PARAMETER(memType);
+
+  return false;
+#endif
+}
+
+void ZHdf5Writer::writeArray(const std::string &path, const mylib::Array *array)
+{
+#if defined(_ENABLE_HDF5_)
+  hsize_t dims[array->ndims];
+  for (int i = 0; i < array->ndims; ++i) {
+    dims[i] = array->dims[i];
+  }
+
+  hid_t type_id;
+  hid_t mem_type_id;
+
+  if (!GetHdf5Type(array->type, &type_id, &mem_type_id)) {
     type_id = H5T_STD_I8BE;
     mem_type_id = H5T_NATIVE_INT8;
-    break;
   }
 
-  std::vector<std::string> pathArray = ZString::decomposePath(path);
-  if (pathArray.size() > 1) {
-    size_t startIndex = 0;
-    if (pathArray[0] == "/") {
-      ++startIndex;
-    }
-    if (startIndex < pathArray.size() - 1) {
-      std::string group = pathArray[startIndex];
-      createGroup(group);
-      for (size_t i = startIndex + 1; i < pathArray.size() - 1; ++i) {
-        group = group + "/" + pathArray[i];
-        createGroup(group);
-      }
-    }
-  }
+  createParentGroup(path);
 
   hid_t dataSpace = H5Screate_simple(array->ndims, dims, NULL);
   hid_t dataset_id = H5Dcreate1(m_file, path.c_str(), type_id, dataSpace,
@@ -225,3 +256,223 @@ void ZHdf5Writer::writeIntArray(
 
   mylib::Kill_Array(array);
 }
+
+bool ZHdf5Writer::createDataset(
+    const std::string &path, mylib::Value_Type type,
+    const std::vector<int> &dims, const std::vector<int> &chunkDims,
+    int compression)
+{
+  bool succ = false;
+
+#if defined(_ENABLE_HDF5_)
+  hid_t fileType;
+  hid_t memType;
+  if (m_file == NULL_FILE || dims.empty() ||
+      !GetHdf5Type(type, &fileType, &memType)) {
+    return false;
+  }
+
+  int ndim = dims.size();
+  std::vector<hsize_t> spaceDims(ndim);
+  bool isEmpty = false;
+  for (int i = 0; i < ndim; ++i) {
+    spaceDims[i] = dims[i];
+    if (dims[i] <= 0) {
+      isEmpty = true;
+    }
+  }
+
+  hid_t plist = H5Pcreate(H5P_DATASET_CREATE);
+  if (!isEmpty && (int) chunkDims.size() == ndim) {
+    std::vector<hsize_t> chunkSize(ndim);
+    for (int i = 0; i < ndim; ++i) {
+      chunkSize[i] = std::max(1, std::min(chunkDims[i], dims[i]));
+    }
+    H5Pset_chunk(plist, ndim, &(chunkSize[0]));
+    if (compression > 0 && H5Zfilter_avail(H5Z_FILTER_DEFLATE) > 0) {
+      if (ZArray::getValueTypeSize(type) > 1) {
+        //Grouping the bytes of a value helps deflate on multi-byte labels
+        H5Pset_shuffle(plist);
+      }
+      H5Pset_deflate(plist, std::min(compression, 9));
+    }
+  }
+
+  createParentGroup(path);
+
+  //Blocks are stored in the native byte order so that they can be written
+  //without conversion
+  hid_t dataSpace = H5Screate_simple(ndim, &(spaceDims[0]), NULL);
+  hid_t dataset = H5Dcreate(m_file, path.c_str(), memType, dataSpace,
+                            H5P_DEFAULT, plist, H5P_DEFAULT);
+  if (dataset >= 0) {
+    succ = true;
+    H5Dclose(dataset);
+  }
+  H5Sclose(dataSpace);
+  H5Pclose(plist);
+#else
+  UNUSED_PARAMETER(&path);
+  UNUSED_PARAMETER(type);
+  UNUSED_PARAMETER(&dims);
+  UNUSED_PARAMETER(&chunkDims);
+  UNUSED_PARAMETER(compression);
+#endif
+
+  return succ;
+}
+
+bool ZHdf5Writer::writeHyperslab(
+    const std::string &path, mylib::Value_Type type,
+    const std::vector<int> &start, const std::vector<int> &count,
+    const void *data)
+{
+  bool succ = false;
+
+#if defined(_ENABLE_HDF5_)
+  hid_t fileType;
+  hid_t memType;
+  if (m_file == NULL_FILE || data == NULL || start.empty() ||
+      start.size() != count.size() || !GetHdf5Type(type, &fileType, &memType)) {
+    return false;
+  }
+
+  hid_t dataset = H5Dopen(m_file, path.c_str(), H5P_DEFAULT);
+  if (dataset < 0) {
+    return false;
+  }
+
+  hid_t space = H5Dget_space(dataset);
+  int ndim = H5Sget_simple_extent_ndims(space);
+  if (ndim == (int) start.size()) {
+    std::vector<hsize_t> dims(ndim);
+    H5Sget_simple_extent_dims(space, &(dims[0]), NULL);
+    std::vector<hsize_t> blockStart(ndim);
+    std::vector<hsize_t> blockCount(ndim);
+    bool isValid = true;
+    for (int i = 0; i < ndim; ++i) {
+      if (start[i] < 0 || count[i] <= 0 ||
+          (hsize_t) start[i] + count[i] > dims[i]) {
+        isValid = false;
+        break;
+      }
+      blockStart[i] = start[i];
+      blockCount[i] = count[i];
+    }
+
+    if (isValid) {
+      hid_t memSpace = H5Screate_simple(ndim, &(blockCount[0]), NULL);
+      H5Sselect_hyperslab(space, H5S_SELECT_SET, &(blockStart[0]), NULL,
+                          &(blockCount[0]), NULL);
+      succ = (H5Dwrite(dataset, memType, memSpace, space, H5P_DEFAULT,
+                       data) >= 0);
+      H5Sclose(memSpace);
+    }
+  }
+
+  H5Sclose(space);
+  H5Dclose(dataset);
+#else
+  UNUSED_PARAMETER(&path);
+  UNUSED_PARAMETER(type);
+  UNUSED_PARAMETER(&start);
+  UNUSED_PARAMETER(&count);
+  UNUSED_PARAMETER(data);
+#endif
+
+  return succ;
+}
+
+bool ZHdf5Writer::writeBlock(const std::string &path, const ZArray &array)
+{
+  if (array.isEmpty()) {
+    return false;
+  }
+
+  std::vector<int> start(array.ndims());
+  std::vector<int> count(array.ndims());
+  for (int i = 0; i < array.ndims(); ++i) {
+    start[i] = array.getStartCoordinate(i);
+    count[i] = array.dim(i);
+  }
+
+  return writeHyperslab(path, array.valueType(), start, count,
+                        array.getDataPointer<void>());
+}
+
+bool ZHdf5Writer::writeArray(
+    const std::string &path, const ZArray &array,
+    const std::vector<int> &chunkDims, int compression)
+{
+  if (array.isEmpty()) {
+    return false;
+  }
+
+  std::vector<int> start(array.ndims(), 0);
+  std::vector<int> dims(array.ndims());
+  for (int i = 0; i < array.ndims(); ++i) {
+    dims[i] = array.dim(i);
+  }
+
+  if (!createDataset(path, array.valueType(), dims, chunkDims, compression)) {
+    return false;
+  }
+
+  return writeHyperslab(path, array.valueType(), start, dims,
+                        array.getDataPointer<void>());
+}
+
+bool ZHdf5Writer::writeStack(
+    const std::string &path, const ZStack &stack,
+    int chunkWidth, int chunkHeight, int chunkDepth, int compression)
+{
+  if (!stack.hasData()) {
+    return false;
+  }
+
+  mylib::Value_Type type;
+  switch (stack.kind()) {
+  case GREY:
+    type = mylib::UINT8_TYPE;
+    break;
+  case GREY16:
+    type = mylib::UINT16_TYPE;
+    break;
+  case FLOAT32:
+    type = mylib::FLOAT32_TYPE;
+    break;
+  case FLOAT64:
+    type = mylib::FLOAT64_TYPE;
+    break;
+  default:
+    return false;
+  }
+
+  std::vector<int> dims(4);
+  dims[0] = stack.channelNumber();
+  dims[1] = stack.depth();
+  dims[2] = stack.height();
+  dims[3] = stack.width();
+
+  std::vector<int> chunkDims(4);
+  chunkDims[0] = 1;
+  chunkDims[1] = chunkDepth;
+  chunkDims[2] = chunkHeight;
+  chunkDims[3] = chunkWidth;
+
+  if (!createDataset(path, type, dims, chunkDims, compression)) {
+    return false;
+  }
+
+  std::vector<int> start(4, 0);
+  std::vector<int> count = dims;
+  count[0] = 1;
+  for (int c = 0; c < stack.channelNumber(); ++c) {
+    start[0] = c;
+    if (!writeHyperslab(path, type, start, count, stack.c_stack(c)->array)) {
+      return false;
+    }
+  }
+
+  return true;
+}
@@ -7,6 +7,9 @@
 #include "zhdf5_header.h"
 #include "mylib/array.h"
 
+class ZArray;
+class ZStack;
+
 /**
  * @brief The class for writing hdf5 files
  *
@@ -42,6 +45,55 @@ public:
   void writeIntArray(const std::string &path,
                      const std::vector<int> &feature);
 
+  /*!
+   * \brief Create a dataset
+   *
+   * The dataset is stored in chunks of \a chunkDims unless \a chunkDims is
+   * empty. The chunks are clipped by \a dims and compressed by deflate of
+   * level \a compression (1-9) if \a compression is positive. Missing parent
+   * groups are created.
+   *
+   * \return true iff the dataset is created.
+   */
+  bool createDataset(const std::string &path, mylib::Value_Type type,
+                     const std::vector<int> &dims,
+                     const std::vector<int> &chunkDims = std::vector<int>(),
+                     int compression = 0);
+
+  /*!
+   * \brief Write an array into a block of an existing dataset
+   *
+   * The block starts at the start coordinates of \a array. The array must have
+   * the same number of dimensions as the dataset. Writing blocks aligned with
+   * the chunks of the dataset avoids reading back partial chunks.
+   */
+  bool writeBlock(const std::string &path, const ZArray &array);
+
+  /*!
+   * \brief Write an array into a chunked dataset
+   */
+  bool writeArray(const std::string &path, const ZArray &array,
+                  const std::vector<int> &chunkDims, int compression);
+
+  /*!
+   * \brief Write a stack into a chunked dataset
+   *
+   * The dataset has the dimensions (c, z, y, x), which is the default
+   * dimension order of HDF5 stacks read by ZStackFile. COLOR stacks are not
+   * supported.
+   */
+  bool writeStack(const std::string &path, const ZStack &stack,
+                  int chunkWidth, int chunkHeight, int chunkDepth,
+                  int compression);
+
+private:
+  void createParentGroup(const std::string &path);
+  bool writeHyperslab(const std::string &path, mylib::Value_Type type,
+                      const std::vector<int> &start,
+                      const std::vector<int> &count, const void *data);
+  static bool GetHdf5Type(mylib::Value_Type type, hid_t *fileType,
+                          hid_t *memType);
+
 private:
   hid_t m_file;
 };
@@ -0,0 +1,690 @@
+#include "zincrementalwatershed.h"
+
+#include <algorithm>
+#include <iostream>
+
+#include "tz_stack_neighborhood.h"
+#include "zstack.hxx"
+#include "zstackwatershed.h"
+
+namespace {
+
+const int WATERSHED_CONN = 26;
+
+//Parent of a voxel that is not flooded by a neighbor
+const uint8_t NO_PARENT = 255;
+
+//Run a full flooding if more voxels need to be flooded again
+const double MAX_INCREMENTAL_RATIO = 0.5;
+
+//Default limit of the kept state
+const size_t DEFAULT_MAX_STATE_SIZE = 512 * 1024 * 1024;
+
+//Flags of the voxels visited in an incremental run
+const uint8_t FLAG_REGION = 1; //Reset voxel
+const uint8_t FLAG_RELATED = 2; //Kept voxel replayed with the reset voxels
+const uint8_t FLAG_QUEUED = 4; //Related voxel queued by its parent
+
+inline bool IsSeed(int value)
+{
+  return (value >= 1) && (value <= STACK_WATERSHED_MAX_SEED);
+}
+
+inline bool IsSeedIndexLess(const std::pair<int, int> &v1,
+                            const std::pair<int, int> &v2)
+{
+  return v1.first < v2.first;
+}
+
+inline void SetEmptyBox(Cuboid_I *box)
+{
+  Cuboid_I_Set_S(box, 0, 0, 0, 0, 0, 0);
+}
+
+void ExpandBox(Cuboid_I *box, int x, int y, int z)
+{
+  if (!Cuboid_I_Is_Valid(box)) {
+    Cuboid_I_Set_S(box, x, y, z, 1, 1, 1);
+  } else {
+    int pt[3] = {x, y, z};
+    for (int i = 0; i < 3; ++i) {
+      box->cb[i] = std::min(box->cb[i], pt[i]);
+      box->ce[i] = std::max(box->ce[i], pt[i]);
+    }
+  }
+}
+
+void ExpandBox(Cuboid_I *box, const Cuboid_I &subbox)
+{
+  if (Cuboid_I_Is_Valid(&subbox)) {
+    ExpandBox(box, subbox.cb[0], subbox.cb[1], subbox.cb[2]);
+    ExpandBox(box, subbox.ce[0], subbox.ce[1], subbox.ce[2]);
+  }
+}
+
+}
+
+ZIncrementalWatershed::ZIncrementalWatershed() :
+  m_sourceStack(NULL), m_sourceArray(NULL), m_source(NULL), m_startLevel(0),
+  m_mask(NULL), m_label(NULL), m_maxStateSize(DEFAULT_MAX_STATE_SIZE),
+  m_lastRunIncremental(false), m_lastFloodedVoxelNumber(0),
+  m_lastResetBasinNumber(0)
+{
+  SetEmptyBox(&m_range);
+  SetEmptyBox(&m_box);
+  SetEmptyBox(&m_sourceStackBox);
+}
+
+ZIncrementalWatershed::~ZIncrementalWatershed()
+{
+  clear();
+}
+
+void ZIncrementalWatershed::clear()
+{
+  if (m_source != NULL) {
+    C_Stack::kill(m_source);
+    m_source = NULL;
+  }
+
+  if (m_mask != NULL) {
+    C_Stack::kill(m_mask);
+    m_mask = NULL;
+  }
+
+  if (m_label != NULL) {
+    C_Stack::kill(m_label);
+    m_label = NULL;
+  }
+
+  m_sourceStack = NULL;
+  m_sourceArray = NULL;
+
+  std::vector<uint8_t>().swap(m_parent);
+  std::vector<SeedVoxel>().swap(m_seed);
+  std::vector<Cuboid_I>().swap(m_basinBox);
+  std::vector<uint8_t>().swap(m_flag);
+  std::vector<int>().swap(m_region);
+  std::vector<uint8_t>().swap(m_regionLabel);
+  std::vector<uint8_t>().swap(m_regionParent);
+  std::vector<int>().swap(m_related);
+  std::vector<std::vector<int> >().swap(m_queue);
+}
+
+bool ZIncrementalWatershed::isEmpty() const
+{
+  return m_label == NULL;
+}
+
+bool ZIncrementalWatershed::getWorkingBox(Cuboid_I *box) const
+{
+  if (isEmpty()) {
+    return false;
+  }
+
+  *box = m_box;
+
+  return true;
+}
+
+size_t ZIncrementalWatershed::getStateSize() const
+{
+  if (isEmpty()) {
+    return 0;
+  }
+
+  size_t byteNumber =
+      C_Stack::voxelNumber(m_source) * C_Stack::kind(m_source) +
+      C_Stack::voxelNumber(m_mask) + C_Stack::voxelNumber(m_label) +
+      m_parent.capacity() + m_seed.capacity() * sizeof(SeedVoxel) +
+      m_flag.capacity() + m_region.capacity() * sizeof(int) +
+      m_regionLabel.capacity() + m_regionParent.capacity() +
+      m_related.capacity() * sizeof(int);
+  for (std::vector<std::vector<int> >::const_iterator iter = m_queue.begin();
+       iter != m_queue.end(); ++iter) {
+    byteNumber += sizeof(std::vector<int>) + iter->capacity() * sizeof(int);
+  }
+
+  return byteNumber;
+}
+
+void ZIncrementalWatershed::setRange(const Cuboid_I &box)
+{
+  m_range = box;
+}
+
+
+Cuboid_I ZIncrementalWatershed::getSourceBox(const ZStack *stack) const
+{
+  Cuboid_I stackBox;
+  stack->getBoundBox(&stackBox);
+
+  Cuboid_I box = m_range;
+  for (int i = 0; i < 3; ++i) {
+    if (m_range.ce[i] < m_range.cb[i]) {
+      box.ce[i] = stackBox.ce[i];
+    }
+  }
+  Cuboid_I_Intersect(&stackBox, &box, &box);
+
+  return box;
+}
+
+bool ZIncrementalWatershed::isSameSource(
+    const ZStack *stack, const Cuboid_I &box) const
+{
+  if (isEmpty() || stack != m_sourceStack ||
+      stack->data()->array != m_sourceArray ||
+      stack->kind() != C_Stack::kind(m_source)) {
+    return false;
+  }
+
+  Cuboid_I stackBox;
+  stack->getBoundBox(&stackBox);
+  for (int i = 0; i < 3; ++i) {
+    if (box.cb[i] != m_box.cb[i] || box.ce[i] != m_box.ce[i] ||
+        stackBox.cb[i] != m_sourceStackBox.cb[i] ||
+        stackBox.ce[i] != m_sourceStackBox.ce[i]) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/*
+ * The seed voxels are collected in the same way as C_Stack::setBlockValue(),
+ * so a later seed stack overwrites an earlier one and the barriers are not
+ * overwritten.
+ */
+void ZIncrementalWatershed::collectSeed(
+    const std::vector<ZStack*> &seedMask, std::vector<SeedVoxel> *seed) const
+{
+  seed->clear();
+
+  int width = C_Stack::width(m_source);
+  int area = C_Stack::area(m_source);
+
+  for (std::vector<ZStack*>::const_iterator iter = seedMask.begin();
+       iter != seedMask.end(); ++iter) {
+    const ZStack *seedStack = *iter;
+    if (seedStack == NULL || seedStack->kind() != GREY) {
+      continue;
+    }
+
+    Cuboid_I seedBox;
+    seedStack->getBoundBox(&seedBox);
+    Cuboid_I box;
+    Cuboid_I_Intersect(&seedBox, &m_box, &box);
+    if (!Cuboid_I_Is_Valid(&box)) {
+      continue;
+    }
+
+    const uint8_t *array = seedStack->array8();
+    int seedWidth = seedStack->width();
+    int seedArea = seedWidth * seedStack->height();
+    for (int z = box.cb[2]; z <= box.ce[2]; ++z) {
+      for (int y = box.cb[1]; y <= box.ce[1]; ++y) {
+        size_t seedIndex = (size_t) (z - seedBox.cb[2]) * seedArea +
+            (y - seedBox.cb[1]) * seedWidth + box.cb[0] - seedBox.cb[0];
+        int index = (z - m_box.cb[2]) * area + (y - m_box.cb[1]) * width +
+            box.cb[0] - m_box.cb[0];
+        for (int x = box.cb[0]; x <= box.ce[0]; ++x) {
+          if (array[seedIndex] != 0 && getLevel(index) != 0) {
+            seed->push_back(SeedVoxel(index, array[seedIndex]));
+          }
+          ++seedIndex;
+          ++index;
+        }
+      }
+    }
+  }
+
+  std::stable_sort(seed->begin(), seed->end(), IsSeedIndexLess);
+
+  //Keep the last value of each voxel
+  size_t count = 0;
+  for (size_t i = 0; i < seed->size(); ++i) {
+    if (i + 1 < seed->size() && (*seed)[i + 1].first == (*seed)[i].first) {
+      continue;
+    }
+    (*seed)[count++] = (*seed)[i];
+  }
+  seed->resize(count);
+}
+
+void ZIncrementalWatershed::makeSeedMask()
+{
+  m_mask = C_Stack::make(GREY, C_Stack::width(m_source),
+                         C_Stack::height(m_source), C_Stack::depth(m_source));
+
+  size_t voxelNumber = C_Stack::voxelNumber(m_mask);
+  for (size_t i = 0; i < voxelNumber; ++i) {
+    m_mask->array[i] = (getLevel(i) == 0) ? STACK_WATERSHED_BARRIER : 0;
+  }
+
+  for (std::vector<SeedVoxel>::const_iterator iter = m_seed.begin();
+       iter != m_seed.end(); ++iter) {
+    m_mask->array[iter->first] = iter->second;
+  }
+}
+
+int ZIncrementalWatershed::getLevel(size_t index) const
+{
+  if (C_Stack::kind(m_source) == GREY) {
+    return m_source->array[index];
+  }
+
+  return ((const uint16_t*) m_source->array)[index];
+}
+
+int ZIncrementalWatershed::getParent(int index) const
+{
+  return index - m_neighborOffset[m_parent[index]];
+}
+
+void ZIncrementalWatershed::updateBasinBox(int index)
+{
+  int basin = m_label->array[index];
+  if (basin < (int) m_basinBox.size()) {
+    int width = C_Stack::width(m_label);
+    int area = C_Stack::area(m_label);
+    ExpandBox(&(m_basinBox[basin]), index % width, (index % area) / width,
+              index / area);
+  }
+}
+
+void ZIncrementalWatershed::floodAll()
+{
+  C_Stack::setZero(m_label);
+  size_t voxelNumber = C_Stack::voxelNumber(m_label);
+  m_parent.assign(voxelNumber, NO_PARENT);
+
+  ZStackWatershed::Flood(
+        m_source, m_mask, 0, m_startLevel, m_label, NULL, &m_parent);
+
+  Cuboid_I emptyBox;
+  SetEmptyBox(&emptyBox);
+  m_basinBox.assign(STACK_WATERSHED_BARRIER, emptyBox);
+
+  m_lastFloodedVoxelNumber = 0;
+  for (size_t i = 0; i < voxelNumber; ++i) {
+    if (m_mask->array[i] != STACK_WATERSHED_BARRIER) {
+      updateBasinBox(i);
+    }
+    if (m_label->array[i] != 0) {
+      ++m_lastFloodedVoxelNumber;
+    }
+  }
+
+  int seedNumber = 0;
+  for (std::vector<SeedVoxel>::const_iterator iter = m_seed.begin();
+       iter != m_seed.end(); ++iter) {
+    if (IsSeed(iter->second) && seedNumber < iter->second) {
+      seedNumber = iter->second;
+    }
+  }
+
+  m_lastResetBasinNumber = seedNumber;
+}
+
+/*
+ * The region to reset consists of the changed seed voxels, which might be
+ * out of any basin, and the voxels of the affected basins, which are searched
+ * in the bound boxes of the basins. Basin 0 stands for the voxels that are not
+ * flooded. It returns false if the region is too large.
+ */
+bool ZIncrementalWatershed::collectRegion(
+    const std::vector<int> &changed, const std::vector<bool> &affected)
+{
+  m_region.clear();
+  for (std::vector<int>::const_iterator iter = changed.begin();
+       iter != changed.end(); ++iter) {
+    if (m_flag[*iter] == 0) {
+      m_flag[*iter] = FLAG_REGION;
+      m_region.push_back(*iter);
+    }
+  }
+
+  Cuboid_I box;
+  SetEmptyBox(&box);
+  for (size_t i = 0; i < m_basinBox.size(); ++i) {
+    if (affected[i]) {
+      ExpandBox(&box, m_basinBox[i]);
+    }
+  }
+
+  size_t voxelNumber = C_Stack::voxelNumber(m_label);
+  size_t maxRegionSize = voxelNumber * MAX_INCREMENTAL_RATIO;
+
+  if (Cuboid_I_Is_Valid(&box)) {
+    int width = C_Stack::width(m_label);
+    int area = C_Stack::area(m_label);
+    for (int z = box.cb[2]; z <= box.ce[2]; ++z) {
+      for (int y = box.cb[1]; y <= box.ce[1]; ++y) {
+        int index = z * area + y * width + box.cb[0];
+        for (int x = box.cb[0]; x <= box.ce[0]; ++x, ++index) {
+          if (m_flag[index] == 0 && affected[m_label->array[index]] &&
+              m_mask->array[index] != STACK_WATERSHED_BARRIER) {
+            m_flag[index] = FLAG_REGION;
+            m_region.push_back(index);
+          }
+        }
+      }
+      if (m_region.size() > maxRegionSize) {
+        return false;
+      }
+    }
+  }
+
+  if (m_region.size() > maxRegionSize) {
+    return false;
+  }
+
+  m_regionLabel.resize(m_region.size());
+  m_regionParent.resize(m_region.size());
+  for (size_t i = 0; i < m_region.size(); ++i) {
+    m_regionLabel[i] = m_label->array[m_region[i]];
+    m_regionParent[i] = m_parent[m_region[i]];
+  }
+
+  return true;
+}
+
+/*
+ * The kept voxels next to the region are the only kept voxels that can flood
+ * a reset voxel or be reached by one. They are replayed with their ancestors,
+ * which decide when they are flooded.
+ */
+void ZIncrementalWatershed::collectRelated()
+{
+  int width = C_Stack::width(m_label);
+  int height = C_Stack::height(m_label);
+  int depth = C_Stack::depth(m_label);
+  int isInBound[26];
+
+  m_related.clear();
+  for (std::vector<int>::const_iterator iter = m_region.begin();
+       iter != m_region.end(); ++iter) {
+    int nbound = Stack_Neighbor_Bound_Test_I(
+          WATERSHED_CONN, width, height, depth, *iter, isInBound);
+    for (int j = 0; j < WATERSHED_CONN; ++j) {
+      if (nbound == WATERSHED_CONN || isInBound[j]) {
+        int index = *iter + m_neighborOffset[j];
+        if (m_flag[index] == 0 && m_label->array[index] != 0) {
+          m_flag[index] = FLAG_RELATED;
+          m_related.push_back(index);
+          while (m_parent[index] != NO_PARENT) {
+            index = getParent(index);
+            if (m_flag[index] != 0) {
+              break;
+            }
+            m_flag[index] = FLAG_RELATED;
+            m_related.push_back(index);
+          }
+        }
+      }
+    }
+  }
+}
+
+/*
+ * Replay the flooding on the region and the related voxels. The queues are
+ * the same as those of a full run without the other voxels, because the
+ * parent of a replayed voxel is always replayed. A related voxel floods the
+ * reset voxels and queues its kept children that are related. It returns the
+ * label of a kept basin that a reset voxel reaches before the parent of the
+ * kept voxel, 0 if it reaches a voxel that is not flooded before, or -1 if
+ * neither happens.
+ */
+int ZIncrementalWatershed::replay()
+{
+  int width = C_Stack::width(m_label);
+  int height = C_Stack::height(m_label);
+  int depth = C_Stack::depth(m_label);
+  int isInBound[26];
+
+  uint8_t *label = m_label->array;
+  const uint8_t *mask = m_mask->array;
+
+  std::vector<int> seedVoxel;
+  for (std::vector<int>::const_iterator iter = m_region.begin();
+       iter != m_region.end(); ++iter) {
+    label[*iter] = IsSeed(mask[*iter]) ? mask[*iter] : 0;
+    m_parent[*iter] = NO_PARENT;
+    if (IsSeed(mask[*iter])) {
+      seedVoxel.push_back(*iter);
+    }
+  }
+
+  collectRelated();
+  for (std::vector<int>::const_iterator iter = m_related.begin();
+       iter != m_related.end(); ++iter) {
+    if (m_parent[*iter] == NO_PARENT) {
+      seedVoxel.push_back(*iter);
+    }
+  }
+
+  //Seeds are queued first in the order of their indices
+  std::sort(seedVoxel.begin(), seedVoxel.end());
+
+  m_queue.resize(m_startLevel + 1);
+  m_lastFloodedVoxelNumber = 0;
+  for (std::vector<int>::const_iterator iter = seedVoxel.begin();
+       iter != seedVoxel.end(); ++iter) {
+    m_queue[std::min(getLevel(*iter), m_startLevel)].push_back(*iter);
+    if (m_flag[*iter] == FLAG_REGION) {
+      ++m_lastFloodedVoxelNumber;
+    } else {
+      m_flag[*iter] |= FLAG_QUEUED;
+    }
+  }
+
+  int conflictBasin = -1;
+  for (int waterLevel = m_startLevel;
+       waterLevel >= 0 && conflictBasin < 0; --waterLevel) {
+    std::vector<int> &queue = m_queue[waterLevel];
+    for (size_t k = 0; k < queue.size() && conflictBasin < 0; ++k) {
+      int index = queue[k];
+      bool isKept = (m_flag[index] != FLAG_REGION);
+      uint8_t basin = label[index];
+      int nbound = Stack_Neighbor_Bound_Test_I(
+            WATERSHED_CONN, width, height, depth, index, isInBound);
+      for (int j = 0; j < WATERSHED_CONN; ++j) {
+        if (nbound == WATERSHED_CONN || isInBound[j]) {
+          int neighbor = index + m_neighborOffset[j];
+          if (mask[neighbor] != 0) {
+            continue;
+          }
+          if (m_flag[neighbor] == FLAG_REGION) {
+            if (label[neighbor] == 0) {
+              label[neighbor] = basin;
+              m_parent[neighbor] = j;
+              m_queue[std::min(getLevel(neighbor), waterLevel)].
+                  push_back(neighbor);
+              ++m_lastFloodedVoxelNumber;
+            }
+          } else if (isKept) {
+            if ((m_flag[neighbor] & FLAG_RELATED) &&
+                m_parent[neighbor] == j) {
+              m_flag[neighbor] |= FLAG_QUEUED;
+              m_queue[std::min(getLevel(neighbor), waterLevel)].
+                  push_back(neighbor);
+            }
+          } else if (label[neighbor] == 0 ||
+                     !(m_flag[neighbor] & FLAG_QUEUED)) {
+            conflictBasin = label[neighbor];
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  for (std::vector<std::vector<int> >::iterator iter = m_queue.begin();
+       iter != m_queue.end(); ++iter) {
+    iter->clear();
+  }
+
+  return conflictBasin;
+}
+
+void ZIncrementalWatershed::resetFlag()
+{
+  for (std::vector<int>::const_iterator iter = m_region.begin();
+       iter != m_region.end(); ++iter) {
+    m_flag[*iter] = 0;
+  }
+
+  for (std::vector<int>::const_iterator iter = m_related.begin();
+       iter != m_related.end(); ++iter) {
+    m_flag[*iter] = 0;
+  }
+  m_related.clear();
+}
+
+bool ZIncrementalWatershed::updateBasin(
+    const std::vector<int> &changed, std::vector<bool> *affected)
+{
+  while (true) {
+    if (!collectRegion(changed, *affected)) {
+      resetFlag();
+      return false;
+    }
+
+    m_lastResetBasinNumber = 0;
+    for (int i = 1; i <= STACK_WATERSHED_MAX_SEED; ++i) {
+      if ((*affected)[i]) {
+        ++m_lastResetBasinNumber;
+      }
+    }
+
+    int conflictBasin = replay();
+    if (conflictBasin < 0) {
+      break;
+    }
+
+    for (size_t i = 0; i < m_region.size(); ++i) {
+      m_label->array[m_region[i]] = m_regionLabel[i];
+      m_parent[m_region[i]] = m_regionParent[i];
+    }
+    resetFlag();
+    (*affected)[conflictBasin] = true;
+  }
+
+  //Kept basins only grow, and the affected ones are all in the region
+  for (size_t i = 0; i < m_basinBox.size(); ++i) {
+    if ((*affected)[i]) {
+      SetEmptyBox(&(m_basinBox[i]));
+    }
+  }
+  for (std::vector<int>::const_iterator iter = m_region.begin();
+       iter != m_region.end(); ++iter) {
+    updateBasinBox(*iter);
+  }
+
+  resetFlag();
+
+  return true;
+}
+
+ZStack* ZIncrementalWatershed::run(
+    const ZStack *stack, const std::vector<ZStack*> &seedMask)
+{
+  m_lastRunIncremental = false;
+  m_lastFloodedVoxelNumber = 0;
+  m_lastResetBasinNumber = 0;
+
+  if (stack == NULL) {
+    return NULL;
+  }
+
+  if (stack->kind() != GREY && stack->kind() != GREY16) {
+    std::cout << "Unsupported stack kind for watershed: " << stack->kind()
+              << std::endl;
+    return NULL;
+  }
+
+  Cuboid_I box = getSourceBox(stack);
+  if (!Cuboid_I_Is_Valid(&box)) {
+    return NULL;
+  }
+
+  if (isSameSource(stack, box)) {
+    std::vector<SeedVoxel> seed;
+    collectSeed(seedMask, &seed);
+
+    //Basins touched by any changed seed voxel
+    std::vector<bool> affected(STACK_WATERSHED_BARRIER + 1, false);
+    std::vector<int> changed;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < m_seed.size() || j < seed.size()) {
+      int index = 0;
+      int value = 0;
+      if (j >= seed.size() ||
+          (i < m_seed.size() && m_seed[i].first < seed[j].first)) {
+        index = m_seed[i++].first;
+      } else {
+        index = seed[j].first;
+        value = seed[j].second;
+        if (i < m_seed.size() && m_seed[i].first == index) {
+          ++i;
+        }
+        ++j;
+      }
+
+      if (m_mask->array[index] != value) {
+        changed.push_back(index);
+        affected[m_mask->array[index]] = true;
+        affected[value] = true;
+        affected[m_label->array[index]] = true;
+        m_mask->array[index] = value;
+      }
+    }
+    affected[0] = false;
+    affected[STACK_WATERSHED_BARRIER] = false;
+    m_seed.swap(seed);
+
+    if (changed.empty() || updateBasin(changed, &affected)) {
+      m_lastRunIncremental = true;
+    } else {
+      floodAll();
+    }
+  } else {
+    clear();
+
+    Cuboid_I stackBox;
+    stack->getBoundBox(&stackBox);
+    Cuboid_I cropBox = box;
+    Cuboid_I_Translate(
+          &cropBox, -stackBox.cb[0], -stackBox.cb[1], -stackBox.cb[2]);
+    m_source = C_Stack::crop(stack->c_stack(), cropBox, NULL);
+    m_sourceStack = stack;
+    m_sourceArray = stack->data()->array;
+    m_sourceStackBox = stackBox;
+    m_box = box;
+
+    int width = C_Stack::width(m_source);
+    int height = C_Stack::height(m_source);
+    int depth = C_Stack::depth(m_source);
+    m_startLevel = (C_Stack::kind(m_source) == GREY) ? 255 : 65535;
+    Stack_Neighbor_Offset(WATERSHED_CONN, width, height, m_neighborOffset);
+
+    m_label = C_Stack::make(GREY, width, height, depth);
+    m_flag.assign(C_Stack::voxelNumber(m_label), 0);
+    collectSeed(seedMask, &m_seed);
+    makeSeedMask();
+    floodAll();
+  }
+
+  ZStack *result = new ZStack;
+  result->consume(C_Stack::clone(m_label));
+  result->setOffset(m_box.cb[0], m_box.cb[1], m_box.cb[2]);
+
+  if (getStateSize() > m_maxStateSize) {
+    clear();
+  }
+
+  return result;
+}
@@ -0,0 +1,169 @@
+#ifndef ZINCREMENTALWATERSHED_H
+#define ZINCREMENTALWATERSHED_H
+
+#include <vector>
+#include <utility>
+#include <stdint.h>
+
+#include "tz_stack_watershed.h"
+#include "tz_cuboid_i.h"
+
+class ZStack;
+
+/*!
+ * \brief The class of running seeded watershed incrementally
+ *
+ * The flooding is the same as Stack_Watershed() with 26-connectivity, the
+ * zero voxels as barriers and the maximal value of the stack kind as the
+ * start level, so a run gives the same label field as ZStackWatershed. A full
+ * run floods in parallel with ZStackWatershed::Flood().
+ *
+ * After a run, the engine keeps the cropped signal, the seed mask, the label
+ * field, the neighbor that floods each voxel and the bound box of each basin,
+ * which is about 5 bytes per voxel for an 8-bit signal. When it runs again on
+ * the same signal and range, only the seed voxels in the seed stacks are
+ * compared and only the basins touched by the changed seeds are reset. The
+ * flooding is replayed on the reset voxels and the kept voxels that flood
+ * them or their neighbors, so the other voxels are not visited. A kept basin
+ * is reset as well if a reset voxel would reach it before the neighbor that
+ * flooded it. A new signal, a new range or a reset region larger than half of
+ * the range triggers a full run.
+ *
+ * The signal is identified by its stack object, its voxel array and its bound
+ * box, so the voxel values are not compared. The owner must call clear()
+ * after changing the values of a signal in place.
+ *
+ * The state is freed after a run if it is larger than the limit set by
+ * setMaxStateSize().
+ */
+class ZIncrementalWatershed
+{
+public:
+  ZIncrementalWatershed();
+  ~ZIncrementalWatershed();
+
+public:
+  /*!
+   * \brief Run seeded watershed
+   *
+   * The label field returned is a copy of the kept one, so it still takes
+   * time proportional to the range.
+   *
+   * \return Label field of the watershed. The caller is responsible for
+   *         freeing it. It returns NULL if the range is invalid or the stack
+   *         is not 8-bit or 16-bit.
+   */
+  ZStack* run(const ZStack *stack, const std::vector<ZStack*> &seedMask);
+
+  /*!
+   * \brief Set the range of the watershed.
+   *
+   * A range with a first corner greater than its last corner along an axis
+   * extends to the end of the stack along that axis.
+   */
+  void setRange(const Cuboid_I &box);
+
+  /*!
+   * \brief Free the kept state so that the next run is a full run.
+   *
+   * It must be called when the values of the signal are changed.
+   */
+  void clear();
+
+  /*!
+   * \brief Test if there is no state kept.
+   */
+  bool isEmpty() const;
+
+  /*!
+   * \brief Get the box of the kept state in the stack coordinates.
+   *
+   * \return false if there is no state kept.
+   */
+  bool getWorkingBox(Cuboid_I *box) const;
+
+  /*!
+   * \brief Set the maximal size (bytes) of the state kept after a run.
+   */
+  inline void setMaxStateSize(size_t byteNumber) {
+    m_maxStateSize = byteNumber;
+  }
+
+  /*!
+   * \brief Size (bytes) of the kept state.
+   */
+  size_t getStateSize() const;
+
+  inline bool isLastRunIncremental() const {
+    return m_lastRunIncremental;
+  }
+
+  /*!
+   * \brief Number of voxels flooded in the last run.
+   */
+  inline size_t getLastFloodedVoxelNumber() const {
+    return m_lastFloodedVoxelNumber;
+  }
+
+  /*!
+   * \brief Number of basins reset in the last run.
+   */
+  inline int getLastResetBasinNumber() const {
+    return m_lastResetBasinNumber;
+  }
+
+private:
+  typedef std::pair<int, int> SeedVoxel; //(index, label)
+
+  Cuboid_I getSourceBox(const ZStack *stack) const;
+  bool isSameSource(const ZStack *stack, const Cuboid_I &box) const;
+  void collectSeed(const std::vector<ZStack*> &seedMask,
+                   std::vector<SeedVoxel> *seed) const;
+  void makeSeedMask();
+  int getLevel(size_t index) const;
+  int getParent(int index) const;
+  void updateBasinBox(int index);
+  void floodAll();
+  bool collectRegion(const std::vector<int> &changed,
+                     const std::vector<bool> &affected);
+  void collectRelated();
+  bool updateBasin(const std::vector<int> &changed,
+                   std::vector<bool> *affected);
+  int replay();
+  void resetFlag();
+
+private:
+  Cuboid_I m_range;
+  Cuboid_I m_box;
+
+  //Identity of the signal
+  const ZStack *m_sourceStack;
+  const void *m_sourceArray;
+  Cuboid_I m_sourceStackBox;
+
+  Stack *m_source; //Cropped signal
+  int m_startLevel;
+  int m_neighborOffset[26];
+
+  Stack *m_mask;
+  Stack *m_label;
+  std::vector<uint8_t> m_parent; //Neighbor index of the flooding voxel
+  std::vector<SeedVoxel> m_seed; //Seed voxels sorted by index
+  std::vector<Cuboid_I> m_basinBox; //Indexed by label, 0 for unflooded voxels
+
+  //Workspace of incremental runs, which is reset after use
+  std::vector<uint8_t> m_flag;
+  std::vector<int> m_region;
+  std::vector<uint8_t> m_regionLabel;
+  std::vector<uint8_t> m_regionParent;
+  std::vector<int> m_related;
+  std::vector<std::vector<int> > m_queue;
+
+  size_t m_maxStateSize;
+
+  bool m_lastRunIncremental;
+  size_t m_lastFloodedVoxelNumber;
+  int m_lastResetBasinNumber;
+};
+
+#endif // ZINCREMENTALWATERSHED_H
@@ -0,0 +1,613 @@
+#include "zjsonstreamreader.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <sstream>
+
+static const size_t ReaderBufferSize = 65536;
+
+ZJsonStreamReader::ZJsonStreamReader() :
+  m_fp(NULL), m_bufferPos(0), m_bufferEnd(0), m_isOpen(false),
+  m_expectingKey(false), m_separator('\0'), m_separatorRead(false),
+  m_lineNumber(1)
+{
+}
+
+ZJsonStreamReader::~ZJsonStreamReader()
+{
+  close();
+}
+
+bool ZJsonStreamReader::open(const std::string &filePath)
+{
+  close();
+
+  m_fp = fopen(filePath.c_str(), "rb");
+  if (m_fp == NULL) {
+    setError("Cannot open " + filePath);
+    return false;
+  }
+
+  m_buffer.resize(ReaderBufferSize);
+  m_isOpen = true;
+
+  return true;
+}
+
+void ZJsonStreamReader::openString(const std::string &str)
+{
+  close();
+
+  m_buffer.assign(str.begin(), str.end());
+  m_bufferEnd = m_buffer.size();
+  m_isOpen = true;
+}
+
+void ZJsonStreamReader::close()
+{
+  if (m_fp != NULL) {
+    fclose(m_fp);
+    m_fp = NULL;
+  }
+
+  m_buffer.clear();
+  m_bufferPos = 0;
+  m_bufferEnd = 0;
+  m_isOpen = false;
+  m_containerStack.clear();
+  m_expectingKey = false;
+  m_separator = '\0';
+  m_separatorRead = false;
+  m_string.clear();
+  m_errorMessage.clear();
+  m_lineNumber = 1;
+}
+
+bool ZJsonStreamReader::isOpen() const
+{
+  return m_isOpen;
+}
+
+int ZJsonStreamReader::peekChar()
+{
+  if (m_bufferPos == m_bufferEnd && m_fp != NULL) {
+    m_bufferPos = 0;
+    m_bufferEnd = fread(&(m_buffer[0]), 1, m_buffer.size(), m_fp);
+  }
+
+  if (m_bufferPos == m_bufferEnd) {
+    return EOF;
+  }
+
+  return (unsigned char) m_buffer[m_bufferPos];
+}
+
+int ZJsonStreamReader::getChar()
+{
+  int c = peekChar();
+  if (c != EOF) {
+    ++m_bufferPos;
+    if (c == '\n') {
+      ++m_lineNumber;
+    }
+  }
+
+  return c;
+}
+
+void ZJsonStreamReader::skipWhiteSpace()
+{
+  for (;;) {
+    switch (peekChar()) {
+    case ' ':
+    case '\t':
+    case '\n':
+    case '\r':
+      getChar();
+      break;
+    default:
+      return;
+    }
+  }
+}
+
+bool ZJsonStreamReader::readSeparator()
+{
+  skipWhiteSpace();
+
+  int c = peekChar();
+  if (m_separator != '\0') {
+    if (c == m_separator) {
+      getChar();
+      m_separator = '\0';
+      m_separatorRead = true;
+      skipWhiteSpace();
+      c = peekChar();
+    } else if (m_separator == ':' || (c != ']' && c != '}' && c != EOF)) {
+      //A comma can only be left out before the closing bracket
+      setError(std::string("Missing '") + m_separator + "'");
+      return false;
+    }
+  }
+
+  if (c == ',' || c == ':') {
+    setError(std::string("Unexpected '") + (char) c + "'");
+    return false;
+  }
+
+  if (m_separatorRead && (c == ']' || c == '}')) {
+    setError("Missing value");
+    return false;
+  }
+
+  return true;
+}
+
+void ZJsonStreamReader::setError(const std::string &message)
+{
+  if (!hasError()) {
+    std::ostringstream stream;
+    stream << message << " (line " << m_lineNumber << ")";
+    m_errorMessage = stream.str();
+  }
+}
+
+void ZJsonStreamReader::endValue()
+{
+  m_expectingKey = !m_containerStack.empty() && m_containerStack.back();
+  m_separator = m_containerStack.empty() ? '\0' : ',';
+}
+
+ZJsonStreamReader::EToken ZJsonStreamReader::getTokenType(int c) const
+{
+  if (m_expectingKey && c != '"' && c != '}' && c != EOF) {
+    return TOKEN_ERROR;
+  }
+
+  switch (c) {
+  case '{':
+    return TOKEN_START_OBJECT;
+  case '}':
+    return TOKEN_END_OBJECT;
+  case '[':
+    return TOKEN_START_ARRAY;
+  case ']':
+    return TOKEN_END_ARRAY;
+  case '"':
+    return m_expectingKey ? TOKEN_KEY : TOKEN_STRING;
+  case 't':
+    return TOKEN_TRUE;
+  case 'f':
+    return TOKEN_FALSE;
+  case 'n':
+    return TOKEN_NULL;
+  case EOF:
+    return TOKEN_END;
+  default:
+    if (c == '-' || (c >= '0' && c <= '9')) {
+      return TOKEN_NUMBER;
+    }
+    break;
+  }
+
+  return TOKEN_ERROR;
+}
+
+ZJsonStreamReader::EToken ZJsonStreamReader::peek()
+{
+  if (hasError() || !readSeparator()) {
+    return TOKEN_ERROR;
+  }
+
+  return getTokenType(peekChar());
+}
+
+ZJsonStreamReader::EToken ZJsonStreamReader::next()
+{
+  if (hasError() || !readSeparator()) {
+    return TOKEN_ERROR;
+  }
+
+  EToken token = getTokenType(peekChar());
+  m_separatorRead = false;
+  switch (token) {
+  case TOKEN_START_OBJECT:
+  case TOKEN_START_ARRAY:
+    getChar();
+    m_containerStack.push_back(token == TOKEN_START_OBJECT);
+    m_expectingKey = (token == TOKEN_START_OBJECT);
+    break;
+  case TOKEN_END_OBJECT:
+  case TOKEN_END_ARRAY:
+    getChar();
+    if (m_containerStack.empty() ||
+        m_containerStack.back() != (token == TOKEN_END_OBJECT)) {
+      setError("Unmatched closing bracket");
+      return TOKEN_ERROR;
+    }
+    m_containerStack.pop_back();
+    endValue();
+    break;
+  case TOKEN_KEY:
+    if (!readString()) {
+      return TOKEN_ERROR;
+    }
+    m_expectingKey = false;
+    m_separator = ':';
+    break;
+  case TOKEN_STRING:
+    if (!readString()) {
+      return TOKEN_ERROR;
+    }
+    endValue();
+    break;
+  case TOKEN_NUMBER:
+    if (!readNumber()) {
+      return TOKEN_ERROR;
+    }
+    endValue();
+    break;
+  case TOKEN_TRUE:
+  case TOKEN_FALSE:
+  case TOKEN_NULL:
+    if (!readLiteral(token == TOKEN_TRUE ? "true" :
+                     (token == TOKEN_FALSE ? "false" : "null"))) {
+      return TOKEN_ERROR;
+    }
+    endValue();
+    break;
+  case TOKEN_END:
+    if (!m_containerStack.empty()) {
+      setError("Unexpected end of file");
+      return TOKEN_ERROR;
+    }
+    break;
+  case TOKEN_ERROR:
+    setError(m_expectingKey ? "Expecting a key" : "Unexpected character");
+    break;
+  }
+
+  return token;
+}
+
+bool ZJsonStreamReader::readCodePoint(uint32_t *code)
+{
+  *code = 0;
+  for (int i = 0; i < 4; ++i) {
+    int c = getChar();
+    *code <<= 4;
+    if (c >= '0' && c <= '9') {
+      *code += c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+      *code += c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+      *code += c - 'A' + 10;
+    } else {
+      setError("Invalid \\u escape");
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool ZJsonStreamReader::readString()
+{
+  m_string.clear();
+  getChar(); //opening quote
+
+  for (;;) {
+    int c = getChar();
+    if (c == '"') {
+      break;
+    }
+
+    if (c == EOF) {
+      setError("Unterminated string");
+      return false;
+    }
+
+    if (c < 0x20) {
+      setError("Control character in string");
+      return false;
+    }
+
+    if (c != '\\') {
+      m_string.push_back((char) c);
+      continue;
+    }
+
+    c = getChar();
+    switch (c) {
+    case '"':
+    case '\\':
+    case '/':
+      m_string.push_back((char) c);
+      break;
+    case 'b':
+      m_string.push_back('\b');
+      break;
+    case 'f':
+      m_string.push_back('\f');
+      break;
+    case 'n':
+      m_string.push_back('\n');
+      break;
+    case 'r':
+      m_string.push_back('\r');
+      break;
+    case 't':
+      m_string.push_back('\t');
+      break;
+    case 'u':
+    {
+      uint32_t code = 0;
+      if (!readCodePoint(&code)) {
+        return false;
+      }
+      if (code >= 0xD800 && code <= 0xDBFF) {
+        //Surrogate pair
+        uint32_t low = 0;
+        if (getChar() != '\\' || getChar() != 'u' || !readCodePoint(&low) ||
+            low < 0xDC00 || low > 0xDFFF) {
+          setError("Invalid surrogate pair");
+          return false;
+        }
+        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+      } else if (code >= 0xDC00 && code <= 0xDFFF) {
+        setError("Invalid surrogate pair");
+        return false;
+      }
+
+      //UTF-8 encoding
+      if (code < 0x80) {
+        m_string.push_back((char) code);
+      } else if (code < 0x800) {
+        m_string.push_back((char) (0xC0 | (code >> 6)));
+        m_string.push_back((char) (0x80 | (code & 0x3F)));
+      } else if (code < 0x10000) {
+        m_string.push_back((char) (0xE0 | (code >> 12)));
+        m_string.push_back((char) (0x80 | ((code >> 6) & 0x3F)));
+        m_string.push_back((char) (0x80 | (code & 0x3F)));
+      } else {
+        m_string.push_back((char) (0xF0 | (code >> 18)));
+        m_string.push_back((char) (0x80 | ((code >> 12) & 0x3F)));
+        m_string.push_back((char) (0x80 | ((code >> 6) & 0x3F)));
+        m_string.push_back((char) (0x80 | (code & 0x3F)));
+      }
+    }
+      break;
+    default:
+      setError("Invalid escape");
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool ZJsonStreamReader::readNumber()
+{
+  m_string.clear();
+  for (;;) {
+    int c = peekChar();
+    if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' ||
+        c == 'e' || c == 'E') {
+      m_string.push_back((char) getChar());
+    } else {
+      break;
+    }
+  }
+
+  char *end = NULL;
+  strtod(m_string.c_str(), &end);
+  if (end != m_string.c_str() + m_string.size()) {
+    setError("Invalid number " + m_string);
+    return false;
+  }
+
+  return true;
+}
+
+bool ZJsonStreamReader::readLiteral(const char *literal)
+{
+  for (const char *c = literal; *c != '\0'; ++c) {
+    if (getChar() != *c) {
+      setError("Invalid literal");
+      return false;
+    }
+  }
+  m_string = literal;
+
+  return true;
+}
+
+double ZJsonStreamReader::getNumber() const
+{
+  return strtod(m_string.c_str(), NULL);
+}
+
+int64_t ZJsonStreamReader::getInteger() const
+{
+  return strtoll(m_string.c_str(), NULL, 10);
+}
+
+bool ZJsonStreamReader::isInteger() const
+{
+  return !m_string.empty() &&
+      m_string.find_first_of(".eE") == std::string::npos;
+}
+
+bool ZJsonStreamReader::isAtValue()
+{
+  switch (peek()) {
+  case TOKEN_END_OBJECT:
+  case TOKEN_END_ARRAY:
+  case TOKEN_END:
+    return false;
+  case TOKEN_KEY:
+    setError("Unexpected key");
+    return false;
+  case TOKEN_ERROR:
+    next();
+    return false;
+  default:
+    break;
+  }
+
+  return true;
+}
+
+bool ZJsonStreamReader::consumeValue()
+{
+  if (!isAtValue()) {
+    return false;
+  }
+
+  size_t depth = getDepth();
+  do {
+    if (next() == TOKEN_ERROR) {
+      return false;
+    }
+  } while (getDepth() > depth);
+
+  return true;
+}
+
+json_t* ZJsonStreamReader::readJson()
+{
+#if defined(HAVE_LIBJANSSON)
+  if (!isAtValue()) {
+    return NULL;
+  }
+
+  json_t *root = NULL;
+  //Containers being filled, which are owned by the root
+  std::vector<json_t*> containerArray;
+  std::string key;
+  do {
+    json_t *value = NULL;
+    switch (next()) {
+    case TOKEN_START_OBJECT:
+      value = json_object();
+      break;
+    case TOKEN_START_ARRAY:
+      value = json_array();
+      break;
+    case TOKEN_END_OBJECT:
+    case TOKEN_END_ARRAY:
+      containerArray.pop_back();
+      break;
+    case TOKEN_KEY:
+      if (m_string.find('\0') != std::string::npos) {
+        setError("NUL byte in object key");
+      }
+      key = m_string;
+      break;
+    case TOKEN_STRING:
+      if (m_string.find('\0') != std::string::npos) {
+        setError("NUL byte in string");
+      } else {
+        value = json_string(m_string.c_str());
+        if (value == NULL) {
+          setError("Invalid UTF-8 string");
+        }
+      }
+      break;
+    case TOKEN_NUMBER:
+      if (isInteger()) {
+        errno = 0;
+        int64_t number = getInteger();
+        if (errno == ERANGE) {
+          setError("Too big integer " + m_string);
+        } else {
+          value = json_integer(number);
+        }
+      } else {
+        value = json_real(getNumber());
+        if (value == NULL) {
+          setError("Invalid real number " + m_string);
+        }
+      }
+      break;
+    case TOKEN_TRUE:
+      value = json_true();
+      break;
+    case TOKEN_FALSE:
+      value = json_false();
+      break;
+    case TOKEN_NULL:
+      value = json_null();
+      break;
+    case TOKEN_END:
+    case TOKEN_ERROR:
+      break;
+    }
+
+    if (hasError()) {
+      json_decref(root);
+      return NULL;
+    }
+
+    if (value != NULL) {
+      if (containerArray.empty()) {
+        root = value;
+      } else if (json_is_object(containerArray.back())) {
+        json_object_set_new(containerArray.back(), key.c_str(), value);
+      } else {
+        json_array_append_new(containerArray.back(), value);
+      }
+
+      if (json_is_object(value) || json_is_array(value)) {
+        containerArray.push_back(value);
+      }
+    }
+  } while (!containerArray.empty());
+
+  return root;
+#else
+  consumeValue();
+
+  return NULL;
+#endif
+}
+
+ZJsonValue ZJsonStreamReader::readValue()
+{
+  ZJsonValue value;
+
+  json_t *data = readJson();
+  if (data != NULL) {
+    value.set(data, ZJsonValue::SET_AS_IT_IS);
+  }
+
+  return value;
+}
+
+bool ZJsonStreamReader::skipValue()
+{
+  return consumeValue();
+}
+
+bool ZJsonStreamReader::hasNextElement()
+{
+  switch (peek()) {
+  case TOKEN_END_ARRAY:
+    next();
+    return false;
+  case TOKEN_END_OBJECT:
+  case TOKEN_KEY:
+  case TOKEN_END:
+  case TOKEN_ERROR:
+    if (!m_containerStack.empty() && m_containerStack.back()) {
+      setError("Not in an array");
+    } else {
+      next();
+    }
+    return false;
+  default:
+    break;
+  }
+
+  return true;
+}
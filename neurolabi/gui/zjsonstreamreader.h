@@ -0,0 +1,172 @@
+#ifndef ZJSONSTREAMREADER_H
+#define ZJSONSTREAMREADER_H
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "neurolabi_config.h"
+#include "tz_stdint.h"
+#include "zjsonvalue.h"
+
+/*!
+ * \brief The class of reading a JSON document incrementally
+ *
+ * The reader pulls one token at a time from a file, which is read in small
+ * chunks, so a large document never needs to be loaded as a whole. It is
+ * meant for files made of big arrays of small records, such as synapse
+ * annotations. The structure is walked with next(), and each record is then
+ * read by readValue() as a small json value that is released after
+ * conversion:
+ *
+ *   ZJsonStreamReader reader;
+ *   reader.open(path);
+ *   if (reader.next() == ZJsonStreamReader::TOKEN_START_OBJECT) {
+ *     while (reader.next() == ZJsonStreamReader::TOKEN_KEY) {
+ *       if (reader.getString() == "data" &&
+ *           reader.next() == ZJsonStreamReader::TOKEN_START_ARRAY) {
+ *         while (reader.hasNextElement()) {
+ *           ZJsonValue record = reader.readValue();
+ *           ...
+ *         }
+ *       } else {
+ *         reader.skipValue();
+ *       }
+ *     }
+ *   }
+ *
+ * The separators are checked against the container being read, so a missing
+ * or extra comma or colon is an error. The first error stops the reader.
+ */
+class ZJsonStreamReader
+{
+public:
+  ZJsonStreamReader();
+  ~ZJsonStreamReader();
+
+  enum EToken {
+    TOKEN_START_OBJECT, TOKEN_END_OBJECT, TOKEN_START_ARRAY, TOKEN_END_ARRAY,
+    TOKEN_KEY, TOKEN_STRING, TOKEN_NUMBER, TOKEN_TRUE, TOKEN_FALSE,
+    TOKEN_NULL, TOKEN_END, TOKEN_ERROR
+  };
+
+  /*!
+   * \brief Open a file to read.
+   *
+   * \return false if the file cannot be opened.
+   */
+  bool open(const std::string &filePath);
+
+  /*!
+   * \brief Read from a string instead of a file.
+   */
+  void openString(const std::string &str);
+
+  void close();
+  bool isOpen() const;
+
+  /*!
+   * \brief Read the next token.
+   *
+   * A string is returned as TOKEN_KEY if it is at a key position of an
+   * object. TOKEN_END is returned after the whole document is read.
+   */
+  EToken next();
+
+  /*!
+   * \brief Get the type of the next token without reading it.
+   */
+  EToken peek();
+
+  /*!
+   * \brief Get the text of the current token.
+   *
+   * It is the decoded string of a key or a string, or the original text of a
+   * number.
+   */
+  inline const std::string& getString() const { return m_string; }
+
+  double getNumber() const;
+  int64_t getInteger() const;
+
+  /*!
+   * \brief Test if the current number token is an integer.
+   */
+  bool isInteger() const;
+
+  /*!
+   * \brief Read the next value as a whole.
+   *
+   * The value is built from the tokens as they are read, so the text of the
+   * value is never held in memory.
+   *
+   * \return An empty value if there is no value to read or anything goes
+   *         wrong.
+   */
+  ZJsonValue readValue();
+
+  /*!
+   * \brief Skip the next value.
+   *
+   * It is a cheaper way to get rid of the value of an unwanted key because
+   * no json value is created.
+   *
+   * \return true iff a value is skipped.
+   */
+  bool skipValue();
+
+  /*!
+   * \brief Test if there is another element in the current array.
+   *
+   * The closing bracket is consumed when there is no more element, so that
+   * the reader continues with the parent of the array.
+   */
+  bool hasNextElement();
+
+  inline bool hasError() const { return !m_errorMessage.empty(); }
+  inline const std::string& getErrorMessage() const { return m_errorMessage; }
+  inline int getLineNumber() const { return m_lineNumber; }
+
+  /*!
+   * \brief Number of containers that are being read.
+   */
+  inline size_t getDepth() const { return m_containerStack.size(); }
+
+private:
+  int peekChar();
+  int getChar();
+  void skipWhiteSpace();
+  bool readSeparator();
+  void setError(const std::string &message);
+  void endValue();
+  EToken getTokenType(int c) const;
+  bool readString();
+  bool readNumber();
+  bool readLiteral(const char *literal);
+  bool readCodePoint(uint32_t *code);
+  bool isAtValue();
+  bool consumeValue();
+  json_t* readJson();
+
+private:
+  FILE *m_fp;
+  std::vector<char> m_buffer;
+  size_t m_bufferPos;
+  size_t m_bufferEnd;
+  bool m_isOpen;
+
+  //true for an object and false for an array
+  std::vector<bool> m_containerStack;
+  bool m_expectingKey;
+  //The separator expected before the next token, or '\0' if there is none
+  char m_separator;
+  //A separator has been read, so the next token cannot close a container
+  bool m_separatorRead;
+
+  std::string m_string;
+
+  std::string m_errorMessage;
+  int m_lineNumber;
+};
+
+#endif // ZJSONSTREAMREADER_H
@@ -0,0 +1,162 @@
+#include "zlabelmap.h"
+
+static const uint64_t FREE_KEY = ~((uint64_t) 0);
+
+ZLabelMap::ZLabelMap()
+{
+  clear();
+}
+
+void ZLabelMap::clear()
+{
+  m_table.clear();
+  m_hasFullKey = false;
+  m_fullKeyValue = -1;
+  m_size = 0;
+  m_shift = 64;
+  m_maxKey = 0;
+  m_lut.clear();
+}
+
+size_t ZLabelMap::slot(uint64_t key) const
+{
+  return (key * 0x9E3779B97F4A7C15ULL) >> m_shift;
+}
+
+void ZLabelMap::rehash(size_t capacity)
+{
+  int bitNumber = 0;
+  while (((size_t) 1 << bitNumber) < capacity) {
+    ++bitNumber;
+  }
+  if (bitNumber < 4) {
+    bitNumber = 4;
+  }
+
+  std::vector<Entry> oldTable;
+  oldTable.swap(m_table);
+
+  Entry freeEntry;
+  freeEntry.key = FREE_KEY;
+  freeEntry.value = -1;
+  m_table.resize((size_t) 1 << bitNumber, freeEntry);
+  m_shift = 64 - bitNumber;
+
+  size_t mask = m_table.size() - 1;
+  for (std::vector<Entry>::const_iterator iter = oldTable.begin();
+       iter != oldTable.end(); ++iter) {
+    if (iter->key != FREE_KEY) {
+      size_t index = slot(iter->key);
+      while (m_table[index].key != FREE_KEY) {
+        index = (index + 1) & mask;
+      }
+      m_table[index] = *iter;
+    }
+  }
+}
+
+void ZLabelMap::reserve(size_t n)
+{
+  //Keep the load factor under 0.5 for short probes
+  if (n * 2 > m_table.size()) {
+    rehash(n * 2);
+  }
+}
+
+bool ZLabelMap::add(uint64_t key, int64_t value)
+{
+  if (key == FREE_KEY) {
+    if (m_hasFullKey) {
+      return false;
+    }
+    m_hasFullKey = true;
+    m_fullKeyValue = value;
+  } else {
+    reserve(m_size + 1);
+
+    size_t mask = m_table.size() - 1;
+    size_t index = slot(key);
+    while (m_table[index].key != FREE_KEY) {
+      if (m_table[index].key == key) {
+        return false;
+      }
+      index = (index + 1) & mask;
+    }
+    m_table[index].key = key;
+    m_table[index].value = value;
+  }
+
+  if (m_size == 0 || key > m_maxKey) {
+    m_maxKey = key;
+  }
+  ++m_size;
+
+  if (key < m_lut.size()) {
+    m_lut[key] = value;
+  }
+
+  return true;
+}
+
+int64_t ZLabelMap::findValue(uint64_t key) const
+{
+  if (key == FREE_KEY) {
+    return m_hasFullKey ? m_fullKeyValue : -1;
+  }
+
+  if (m_table.empty()) {
+    return -1;
+  }
+
+  size_t mask = m_table.size() - 1;
+  size_t index = slot(key);
+  while (m_table[index].key != FREE_KEY) {
+    if (m_table[index].key == key) {
+      return m_table[index].value;
+    }
+    index = (index + 1) & mask;
+  }
+
+  return -1;
+}
+
+bool ZLabelMap::contains(uint64_t key) const
+{
+  if (key == FREE_KEY) {
+    return m_hasFullKey;
+  }
+
+  if (m_table.empty()) {
+    return false;
+  }
+
+  size_t mask = m_table.size() - 1;
+  size_t index = slot(key);
+  while (m_table[index].key != FREE_KEY) {
+    if (m_table[index].key == key) {
+      return true;
+    }
+    index = (index + 1) & mask;
+  }
+
+  return false;
+}
+
+bool ZLabelMap::optimizeLookup(size_t maxLutSize)
+{
+  m_lut.clear();
+
+  if (m_size == 0 || m_maxKey >= maxLutSize) {
+    return false;
+  }
+
+  m_lut.resize(m_maxKey + 1, -1);
+  for (std::vector<Entry>::const_iterator iter = m_table.begin();
+       iter != m_table.end(); ++iter) {
+    if (iter->key != FREE_KEY) {
+      m_lut[iter->key] = iter->value;
+    }
+  }
+
+  return true;
+}
@@ -0,0 +1,92 @@
+#ifndef ZLABELMAP_H
+#define ZLABELMAP_H
+
+#include <vector>
+#include <cstddef>
+
+#include "tz_stdint.h"
+
+/*!
+ * \brief The class of mapping labels to labels
+ *
+ * The map is a flat hash table with open addressing, which is much faster than
+ * Intpair_Map for the millions of lookups needed to relabel an image plane. A
+ * dense lookup table can be built on top of the hash table by optimizeLookup()
+ * when the keys are small enough.
+ *
+ * Like Intpair_Map, a key keeps the value it is first added with and the value
+ * of a missing key is -1.
+ */
+class ZLabelMap
+{
+public:
+  ZLabelMap();
+
+  void clear();
+
+  /*!
+   * \brief Make room for \a n keys without rehashing.
+   */
+  void reserve(size_t n);
+
+  /*!
+   * \brief Add a key.
+   *
+   * \return false if the key already exists, in which case its value is not
+   * changed.
+   */
+  bool add(uint64_t key, int64_t value);
+
+  /*!
+   * \brief Value of a key.
+   *
+   * \return -1 if the key does not exist.
+   */
+  inline int64_t value(uint64_t key) const {
+    if (key < m_lut.size()) {
+      return m_lut[key];
+    }
+
+    return findValue(key);
+  }
+
+  bool contains(uint64_t key) const;
+
+  inline size_t size() const { return m_size; }
+  inline bool isEmpty() const { return m_size == 0; }
+
+  /*!
+   * \brief Build a dense lookup table for the keys in [0, maxKey].
+   *
+   * The table is built only if it has no more than \a maxLutSize entries. Keys
+   * added later are also put into the table if they are in its range.
+   *
+   * \return true iff the table is built.
+   */
+  bool optimizeLookup(size_t maxLutSize = 1 << 20);
+
+  inline bool hasLookupTable() const { return !m_lut.empty(); }
+
+  uint64_t getMaxKey() const { return m_maxKey; }
+
+private:
+  int64_t findValue(uint64_t key) const;
+  size_t slot(uint64_t key) const;
+  void rehash(size_t capacity);
+
+private:
+  struct Entry {
+    uint64_t key;
+    int64_t value;
+  };
+
+  std::vector<Entry> m_table; //free slots have the key of all bits set
+  bool m_hasFullKey; //whether the key of all bits set is added
+  int64_t m_fullKeyValue;
+  size_t m_size;
+  int m_shift; //for Fibonacci hashing
+  uint64_t m_maxKey;
+  std::vector<int64_t> m_lut;
+};
+
+#endif // ZLABELMAP_H
@@ -459,7 +459,7 @@ void ZNeuronTracer::setConnWorkspace(Connection_Test_Workspace *workspace)
 }
 
 #define MAX_P2P_TRACE_DISTANCE 100
-#define MAX_P2P_TRACE_VOLUME 1000000
+#define MAX_P2P_TRACE_VOLUME 4000000
 
 Swc_Tree* ZNeuronTracer::trace(double x1, double y1, double z1, double r1,
                                double x2, double y2, double z2, double r2)
@@ -502,6 +502,7 @@ Swc_Tree* ZNeuronTracer::trace(double x1, double y1, double z1, double r1,
   }
 
   stackGraph.setResolution(m_resolution);
+  stackGraph.setPathFinder(&m_pathFinder);
 
   if (m_vertexOption == ZStackGraph::VO_SURFACE) {
     stackGraph.setWeightFunction(Stack_Voxel_Weight_I);
@@ -8,6 +8,7 @@
 #include "tz_trace_utils.h"
 #include "neutube_def.h"
 #include "zstackgraph.h"
+#include "zstackpathfinder.h"
 #include "tz_locseg_chain.h"
 #include "zprogressable.h"
 #include "zintpoint.h"
@@ -241,6 +242,9 @@ private:
   double m_greyOffset;
 
   ZNeuronTracerConfig m_config;
+
+  //Path search buffers kept between point-to-point traces
+  ZStackPathFinder m_pathFinder;
   /*
   static const char *m_levelKey;
   static const char *m_minimalScoreKey;
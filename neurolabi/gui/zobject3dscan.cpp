@@ -8,6 +8,11 @@
 #include <stdlib.h>
 #if _QT_GUI_USED_
 #include <QtGui>
+#if defined(_QT_GUI_USED_)
+#include <QFuture>
+#include <QThread>
+#include <QtConcurrentRun>
+#endif
 #endif
 #include "c_stack.h"
 #include "geometry/zgeometry.h"
@@ -42,6 +47,9 @@ const ZObject3dScan::TEvent ZObject3dScan::EVENT_OBJECT_UNCANONIZED =
   0x4 | ZObject3dScan::EVENT_OBJECT_VIEW_CHANGED;
 const ZObject3dScan::TEvent ZObject3dScan::EVENT_OBJECT_CANONIZED =
   0x8 | ZObject3dScan::EVENT_OBJECT_VIEW_CHANGED;
+const int ZObject3dScan::MAX_PYRAMID_LEVEL = 8;
+uint64_t ZObject3dScan::m_visitedStripeCount = 0;
+uint64_t ZObject3dScan::m_paintedSegmentCount = 0;
 ZObject3dScan::ZObject3dScan() {
   init();
 }
@@ -113,6 +121,10 @@ bool ZObject3dScan::isDeprecated(EComponent comp) const {
     return m_slicewiseVoxelNumber.empty();
   case COMPONENT_Z_PROJECTION:
     return m_zProjection == NULL;
+  case COMPONENT_PYRAMID:
+    return m_pyramid.empty();
+  case COMPONENT_SLICE_INDEX:
+    return m_sliceOffsetArray.empty();
   default:
     break;
   }
@@ -137,12 +149,24 @@ void ZObject3dScan::deprecate(EComponent comp) {
     delete m_zProjection;
     m_zProjection = NULL;
     break;
+  case COMPONENT_PYRAMID:
+    for(size_t i = 0; i < m_pyramid.size(); ++i) {
+      delete m_pyramid[i];
+    }
+    m_pyramid.clear();
+    break;
+  case COMPONENT_SLICE_INDEX:
+    m_sliceZArray.clear();
+    m_sliceOffsetArray.clear();
+    break;
   case COMPONENT_ALL:
     deprecate(COMPONENT_STRIPE_INDEX_MAP);
     deprecate(COMPONENT_INDEX_SEGMENT_MAP);
     deprecate(COMPONENT_ACCUMULATED_STRIPE_NUMBER);
     deprecate(COMPONENT_SLICEWISE_VOXEL_NUMBER);
     deprecate(COMPONENT_Z_PROJECTION);
+    deprecate(COMPONENT_PYRAMID);
+    deprecate(COMPONENT_SLICE_INDEX);
     break;
   }
 }
@@ -756,9 +780,47 @@ void ZObject3dScan::downsampleMax(int xintv, int yintv, int zintv) {
     // m_isCanonized = false;
     event |= EVENT_OBJECT_UNCANONIZED;
   }
+  event |= EVENT_OBJECT_MODEL_CHANGED;
   processEvent(event);
   canonize();
-  // deprecate(ALL_COMPONENT);
+}
+const ZObject3dScan* ZObject3dScan::getPyramidLevel(int level) const {
+  if(level < 0 || level > MAX_PYRAMID_LEVEL) {
+    return NULL;
+  }
+  if(level == 0) {
+    return this;
+  }
+  // Max downsampling composes, so each level is made from the one below it
+  while((int)m_pyramid.size() < level) {
+    ZObject3dScan* obj =
+      new ZObject3dScan(m_pyramid.empty() ? *this : *(m_pyramid.back()));
+    obj->downsampleMax(1, 1, 1);
+    m_pyramid.push_back(obj);
+  }
+  return m_pyramid[level - 1];
+}
+int ZObject3dScan::getPyramidLevelForVoxelNumber(size_t maxVoxelNumber) const {
+  for(int level = 0; level < MAX_PYRAMID_LEVEL; ++level) {
+    if(getPyramidLevel(level)->getVoxelNumber() <= maxVoxelNumber) {
+      return level;
+    }
+  }
+  return MAX_PYRAMID_LEVEL;
+}
+ZObject3dScan ZObject3dScan::getDownsampledMax(
+  int xintv, int yintv, int zintv) const {
+  int level = 0;
+  int scale = 1;
+  while(level < MAX_PYRAMID_LEVEL && (xintv + 1) % (scale * 2) == 0 &&
+        (yintv + 1) % (scale * 2) == 0 && (zintv + 1) % (scale * 2) == 0) {
+    ++level;
+    scale *= 2;
+  }
+  ZObject3dScan obj = *getPyramidLevel(level);
+  obj.downsampleMax((xintv + 1) / scale - 1, (yintv + 1) / scale - 1,
+    (zintv + 1) / scale - 1);
+  return obj;
 }
 void ZObject3dScan::upSample(int xIntv, int yIntv, int zIntv) {
   if(xIntv == 0 && yIntv == 0 && zIntv == 0) {
@@ -981,6 +1043,172 @@ const std::map<std::pair<int, int>, size_t>& ZObject3dScan::getStripeMap() const
   }
   return m_stripeMap;
 }
+namespace {
+// Stripe numbers below this are labeled in the calling thread
+const size_t LABEL_SEGMENT_MULTI_THREAD_THRESHOLD = 10000;
+
+size_t FindSegmentRoot(std::vector<size_t>& parent, size_t v) {
+  while(parent[v] != v) {
+    parent[v] = parent[parent[v]];
+    v = parent[v];
+  }
+  return v;
+}
+
+// The root of a component is always its smallest segment index
+void UnionSegment(std::vector<size_t>& parent, size_t v1, size_t v2) {
+  v1 = FindSegmentRoot(parent, v1);
+  v2 = FindSegmentRoot(parent, v2);
+  if(v1 < v2) {
+    parent[v2] = v1;
+  } else if(v2 < v1) {
+    parent[v1] = v2;
+  }
+}
+
+// Two-pointer sweep over the canonized segments of two adjacent stripes.
+// Segments are connected if they overlap after being extended by 1 voxel.
+void UnionStripeSegment(const ZObject3dStripe& stripe1, size_t offset1,
+  const ZObject3dStripe& stripe2, size_t offset2,
+  std::vector<size_t>& parent) {
+  int n1 = stripe1.getSegmentNumber();
+  int n2 = stripe2.getSegmentNumber();
+  int i = 0;
+  int j = 0;
+  while(i < n1 && j < n2) {
+    const int* seg1 = stripe1.getSegment(i);
+    const int* seg2 = stripe2.getSegment(j);
+    if(seg1[1] + 1 < seg2[0]) {
+      ++i;
+    } else if(seg2[1] + 1 < seg1[0]) {
+      ++j;
+    } else {
+      UnionSegment(parent, offset1 + i, offset2 + j);
+      if(seg1[1] < seg2[1]) {
+        ++i;
+      } else {
+        ++j;
+      }
+    }
+  }
+}
+
+bool IsStripeBefore(const ZObject3dStripe& stripe, int z, int y) {
+  return (stripe.getZ() < z) || (stripe.getZ() == z && stripe.getY() < y);
+}
+
+// Label stripes in [begin, end) of a canonized stripe array. Only neighbors
+// inside the range are checked, so that ranges can be labeled in parallel.
+void LabelStripeSegment(const std::vector<ZObject3dStripe>* stripeArrayPtr,
+  const std::vector<size_t>* offsetArrayPtr, size_t begin, size_t end,
+  std::vector<size_t>* parent) {
+  const std::vector<ZObject3dStripe>& stripeArray = *stripeArrayPtr;
+  const std::vector<size_t>& offsetArray = *offsetArrayPtr;
+  size_t k = begin;
+  for(size_t i = begin; i < end; ++i) {
+    const ZObject3dStripe& stripe = stripeArray[i];
+    int z = stripe.getZ();
+    int y = stripe.getY();
+    // Along Y
+    if(i + 1 < end && stripeArray[i + 1].getZ() == z &&
+       stripeArray[i + 1].getY() == y + 1) {
+      UnionStripeSegment(stripe, offsetArray[i], stripeArray[i + 1],
+        offsetArray[i + 1], *parent);
+    }
+    // Along Z, from (z + 1, y - 1) to (z + 1, y + 1)
+    while(k < end && IsStripeBefore(stripeArray[k], z + 1, y - 1)) {
+      ++k;
+    }
+    for(size_t m = k; m < end && IsStripeBefore(stripeArray[m], z + 1, y + 2);
+      ++m) {
+      UnionStripeSegment(stripe, offsetArray[i], stripeArray[m],
+        offsetArray[m], *parent);
+    }
+  }
+}
+}
+
+size_t ZObject3dScan::labelConnectedSegment(std::vector<size_t>* labelArray,
+  bool multithreading) {
+  if(labelArray == NULL) {
+    return 0;
+  }
+  labelArray->clear();
+  if(isEmpty()) {
+    return 0;
+  }
+  canonize();
+  const std::vector<size_t>& offsetArray = getStripeNumberAccumulation();
+  size_t stripeNumber = getStripeNumber();
+  size_t segmentNumber = offsetArray.back();
+  std::vector<size_t>& parent = *labelArray;
+  parent.resize(segmentNumber);
+  for(size_t i = 0; i < segmentNumber; ++i) {
+    parent[i] = i;
+  }
+#if defined(_QT_GUI_USED_)
+  int slabNumber = 1;
+  if(multithreading && stripeNumber >= LABEL_SEGMENT_MULTI_THREAD_THRESHOLD) {
+    slabNumber = std::max(1, QThread::idealThreadCount());
+  }
+  if(slabNumber > 1) {
+    // Split the stripes into Z slabs. A slab never breaks a Z plane, so each
+    // thread only touches the segments of its own slab.
+    std::vector<size_t> slabStart;
+    slabStart.push_back(0);
+    size_t slabSize = stripeNumber / slabNumber + 1;
+    for(size_t i = slabSize; i < stripeNumber; ) {
+      while(i < stripeNumber &&
+            m_stripeArray[i].getZ() == m_stripeArray[i - 1].getZ()) {
+        ++i;
+      }
+      if(i < stripeNumber) {
+        slabStart.push_back(i);
+      }
+      i += slabSize;
+    }
+    slabStart.push_back(stripeNumber);
+    std::vector<QFuture<void> > res(slabStart.size() - 1);
+    for(size_t i = 0; i < res.size(); ++i) {
+      res[i] = QtConcurrent::run(&LabelStripeSegment, &m_stripeArray,
+        &offsetArray, slabStart[i], slabStart[i + 1], &parent);
+    }
+    for(size_t i = 0; i < res.size(); ++i) {
+      res[i].waitForFinished();
+    }
+    // Merge pass over the last plane of each slab and the first plane of the
+    // next one
+    for(size_t i = 1; i + 1 < slabStart.size(); ++i) {
+      size_t begin = slabStart[i] - 1;
+      while(begin > 0 && m_stripeArray[begin - 1].getZ() ==
+            m_stripeArray[slabStart[i] - 1].getZ()) {
+        --begin;
+      }
+      size_t end = slabStart[i] + 1;
+      while(end < stripeNumber &&
+            m_stripeArray[end].getZ() == m_stripeArray[slabStart[i]].getZ()) {
+        ++end;
+      }
+      LabelStripeSegment(&m_stripeArray, &offsetArray, begin, end, &parent);
+    }
+  } else {
+    LabelStripeSegment(&m_stripeArray, &offsetArray, 0, stripeNumber, &parent);
+  }
+#else
+  UNUSED_PARAMETER(multithreading);
+  LabelStripeSegment(&m_stripeArray, &offsetArray, 0, stripeNumber, &parent);
+#endif
+  // Relabel the roots in the order of their segment indices
+  size_t componentNumber = 0;
+  for(size_t i = 0; i < segmentNumber; ++i) {
+    if(parent[i] == i) {
+      parent[i] = componentNumber++;
+    } else {
+      parent[i] = parent[parent[i]];
+    }
+  }
+  return componentNumber;
+}
 ZGraph* ZObject3dScan::buildConnectionGraph() {
   if(isEmpty()) {
     return NULL;
@@ -1100,81 +1328,56 @@ std::vector<size_t> ZObject3dScan::getConnectedObjectSize() {
 std::vector<ZObject3dScan> ZObject3dScan::getConnectedComponent(
   EAction ppAction) {
   std::vector<ZObject3dScan> objArray;
-#if 1
-  std::cout << "Building connection graph ..." << std::endl;
-#endif
-  ZGraph* graph = buildConnectionGraph();
-#if 1
-  std::cout << "Connection graph ready." << std::endl;
-#endif
-  if(graph != NULL) {
-    const std::vector<ZGraph*>& subGraph = graph->getConnectedSubgraph();
-    const std::map<size_t, std::pair<size_t, size_t>>& segMap =
-      getIndexSegmentMap();
-    std::vector<bool> isAdded(segMap.size(), false);
-#if 1
-    std::cout << "Extracting components ..." << std::endl;
-#endif
+  std::vector<size_t> labelArray;
+  size_t componentNumber = labelConnectedSegment(&labelArray);
+  if(componentNumber > 0) {
+    // Components with more than one segment come first, followed by
+    // single-segment components, both in the order of their first segments.
+    std::vector<size_t> segmentCount(componentNumber, 0);
+    for(size_t i = 0; i < labelArray.size(); ++i) {
+      ++segmentCount[labelArray[i]];
+    }
+    std::vector<size_t> objIndex(componentNumber);
     size_t index = 0;
-    for(std::vector<ZGraph*>::const_iterator iter = subGraph.begin();
-      iter != subGraph.end(); ++iter, ++index) {
-#if 1
-      std::cout << "  " << index + 1 << "/" << subGraph.size() << std::endl;
-      std::cout << "  Processing " << (*iter)->getEdgeNumber() << " edges"
-                << std::endl;
-#endif
-      ZObject3dScan subobj;
-      for(int edgeIndex = 0; edgeIndex < (*iter)->getEdgeNumber(); ++edgeIndex) {
-        int v1 = (*iter)->edgeStart(edgeIndex);
-        int v2 = (*iter)->edgeEnd(edgeIndex);
-        int z, y, x1, x2;
-        if(!isAdded[v1]) {
-          getSegment(v1, &z, &y, &x1, &x2);
-          subobj.addSegment(z, y, x1, x2, false);
-          isAdded[v1] = true;
-        }
-        if(!isAdded[v2]) {
-          getSegment(v2, &z, &y, &x1, &x2);
-          subobj.addSegment(z, y, x1, x2, false);
-          isAdded[v2] = true;
+    for(size_t i = 0; i < componentNumber; ++i) {
+      if(segmentCount[i] > 1) {
+        objIndex[i] = index++;
+      }
+    }
+    for(size_t i = 0; i < componentNumber; ++i) {
+      if(segmentCount[i] == 1) {
+        objIndex[i] = index++;
+      }
+    }
+    objArray.resize(componentNumber);
+    // Segments are added in the canonized order, so each component stays
+    // canonized.
+    size_t segmentIndex = 0;
+    for(size_t i = 0; i < getStripeNumber(); ++i) {
+      const ZObject3dStripe& stripe = m_stripeArray[i];
+      for(int j = 0; j < stripe.getSegmentNumber(); ++j) {
+        const int* segment = stripe.getSegment(j);
+        ZObject3dScan& subobj = objArray[objIndex[labelArray[segmentIndex++]]];
+        if(subobj.isEmpty() ||
+           subobj.m_stripeArray.back().getZ() != stripe.getZ() ||
+           subobj.m_stripeArray.back().getY() != stripe.getY()) {
+          subobj.addStripeFast(stripe.getZ(), stripe.getY());
         }
+        subobj.addSegmentFast(segment[0], segment[1]);
       }
-#if _DEBUG_2
-      std::cout << "  Edge processing done." << std::endl;
-#endif
+    }
+    for(std::vector<ZObject3dScan>::iterator iter = objArray.begin();
+      iter != objArray.end(); ++iter) {
+      ZObject3dScan& subobj = *iter;
+      subobj.setCanonized(true);
       switch(ppAction) {
-      case ACTION_CANONIZE:
-        std::cout << "  Canonizing ..." << std::endl;
-        subobj.canonize();
-        break;
       case ACTION_SORT_YZ:
-        std::cout << "  Sorting ..." << std::endl;
         subobj.sort();
         break;
       default:
         break;
       }
-      objArray.push_back(subobj);
-    }
-#if _DEBUG_2
-    std::cout << objArray.size() << " components extracted." << std::endl;
-#endif
-    delete graph;
-#if _DEBUG_2
-    std::cout << "Checking remains ..." << std::endl;
-#endif
-    for(size_t i = 0; i < isAdded.size(); ++i) {
-      if(!isAdded[i]) {
-        ZObject3dScan subobj;
-        int z, y, x1, x2;
-        getSegment(i, &z, &y, &x1, &x2);
-        subobj.addSegment(z, y, x1, x2);
-        objArray.push_back(subobj);
-      }
     }
-#if _DEBUG_2
-    std::cout << objArray.size() << " components extracted." << std::endl;
-#endif
   }
   for(std::vector<ZObject3dScan>::iterator iter = objArray.begin();
     iter != objArray.end(); ++iter) {
@@ -1255,35 +1458,45 @@ void ZObject3dScan::displaySolid(
   if(stride < 1) {
     stride = 1;
   }
-  std::vector<QLine> lineArray;
-  ZObject3dScan slice;
-  //  bool painted = false;
+  // Only the stripes on the slice are visited
+  const ZObject3dScan* source = this;
+  size_t startIndex = 0;
+  size_t endIndex = 0;
   if(isProj) {
-    slice = *getZProjection();
-  } else {
-    slice = getSlice(z);
+    source = getZProjection();
+    endIndex = source->getStripeNumber();
+  } else if(!getSliceRange(z, &startIndex, &endIndex)) {
+    return;
   }
-  size_t stripeNumber = slice.getStripeNumber();
-  for(size_t i = 0; i < stripeNumber; i += stride) {
-    const ZObject3dStripe& stripe = slice.getStripe(i);
-    if(stripe.getZ() == z || isProj) {
-      int nseg = stripe.getSegmentNumber();
-      for(int j = 0; j < nseg; ++j) {
-        int x0 = stripe.getSegmentStart(j); // - offsetX;
-        int x1 = stripe.getSegmentEnd(j);   // - offsetX;
-        int y = stripe.getY();              // - offsetY;
-        lineArray.push_back(QLine(x0, y, x1, y));
-      }
+  std::vector<QLine> lineArray;
+  for(size_t i = startIndex; i < endIndex; i += stride) {
+    const ZObject3dStripe& stripe = source->getStripe(i);
+    int nseg = stripe.getSegmentNumber();
+    int y = stripe.getY();
+    for(int j = 0; j < nseg; ++j) {
+      lineArray.push_back(
+        QLine(stripe.getSegmentStart(j), y, stripe.getSegmentEnd(j), y));
     }
+    ++m_visitedStripeCount;
   }
+  m_paintedSegmentCount += lineArray.size();
   painter.drawLines(lineArray);
+#else
+  UNUSED_PARAMETER(&painter);
+  UNUSED_PARAMETER(z);
+  UNUSED_PARAMETER(isProj);
+  UNUSED_PARAMETER(stride);
 #endif
-  //  if (!lineArray.empty()) {
-  //  painter.drawPoints(pointArray);
-  //    painter.drawLines(&(lineArray[0]), lineArray.size());
-  //    painted = true;
-  //  }
-  //  return painted;
+}
+void ZObject3dScan::ResetPaintCounter() {
+  m_visitedStripeCount = 0;
+  m_paintedSegmentCount = 0;
+}
+uint64_t ZObject3dScan::GetVisitedStripeCount() {
+  return m_visitedStripeCount;
+}
+uint64_t ZObject3dScan::GetPaintedSegmentCount() {
+  return m_paintedSegmentCount;
 }
 void ZObject3dScan::display(ZPainter& painter, int slice, EDisplayStyle style,
   NeuTube::EAxis sliceAxis) const {
@@ -1543,76 +1756,44 @@ ZObject3dScan ZObject3dScan::getMedianSlice() const {
   }
   return getSlice(z);
 }
+bool ZObject3dScan::getSliceRange(int z, size_t* start, size_t* end) const {
+  if(isEmpty()) {
+    return false;
+  }
+  const_cast<ZObject3dScan&>(*this).canonize();
+  // Stripes added without events leave the index short
+  if(isDeprecated(COMPONENT_SLICE_INDEX) ||
+     m_sliceOffsetArray.back() != getStripeNumber()) {
+    m_sliceZArray.clear();
+    m_sliceOffsetArray.clear();
+    for(size_t i = 0; i < getStripeNumber(); ++i) {
+      if(i == 0 || m_stripeArray[i].getZ() != m_stripeArray[i - 1].getZ()) {
+        m_sliceZArray.push_back(m_stripeArray[i].getZ());
+        m_sliceOffsetArray.push_back(i);
+      }
+    }
+    m_sliceOffsetArray.push_back(getStripeNumber());
+  }
+  std::vector<int>::const_iterator iter =
+    std::lower_bound(m_sliceZArray.begin(), m_sliceZArray.end(), z);
+  if(iter == m_sliceZArray.end() || *iter != z) {
+    return false;
+  }
+  size_t sliceIndex = iter - m_sliceZArray.begin();
+  *start = m_sliceOffsetArray[sliceIndex];
+  *end = m_sliceOffsetArray[sliceIndex + 1];
+  return true;
+}
 ZObject3dScan ZObject3dScan::getSlice(int z) const {
   ZObject3dScan slice;
-  if(!isEmpty()) {
-    const_cast<ZObject3dScan&>(*this).canonize();
-    int stripeNumber = getStripeNumber();
-    int pi = stripeNumber / 2;
-    int pz = m_stripeArray[pi].getZ();
-    int minIndex = 0;
-    int maxIndex = stripeNumber - 1;
-    if(z == m_stripeArray[minIndex].getZ() &&
-       z == m_stripeArray[maxIndex].getZ()) {
+  size_t startIndex = 0;
+  size_t endIndex = 0;
+  if(getSliceRange(z, &startIndex, &endIndex)) {
+    if(startIndex == 0 && endIndex == getStripeNumber()) {
       return *this;
     }
-    while(z != pz) {
-      if(z < pz) {
-        maxIndex = pi;
-      } else {
-        minIndex = pi;
-      }
-      pi = (minIndex + maxIndex) / 2;
-      pz = m_stripeArray[pi].getZ();
-      if(minIndex == pi) {
-        if(minIndex == maxIndex) {
-          break;
-        } else {
-          if(z != pz) {
-            pz = m_stripeArray[maxIndex].getZ();
-            pi = maxIndex;
-            break;
-          }
-        }
-      }
-    }
-    if(z == pz) {
-      // slice.addStripe(m_stripeArray[pi]);
-      int index = pi;
-      int startIndex = pi;
-      while(--index >= 0) {
-        pz = m_stripeArray[index].getZ();
-        if(z == pz) {
-          startIndex = index;
-        } else {
-          break;
-        }
-      }
-      for(index = startIndex; index <= pi; ++index) {
-        slice.addStripeFast(m_stripeArray[index]);
-      }
-      index = pi;
-      while(++index < stripeNumber) {
-        pz = m_stripeArray[index].getZ();
-        if(z == pz) {
-          slice.addStripe(m_stripeArray[index]);
-        } else {
-          break;
-        }
-      }
-    }
-#ifdef _DEBUG_2
-    ZObject3dScan testSlice;
-    for(int i = 0; i < stripeNumber; ++i) {
-      const ZObject3dStripe& stripe = m_stripeArray[i];
-      if(stripe.getZ() == z) {
-        testSlice.addStripe(stripe, false);
-      }
-    }
-    TZ_ASSERT(slice.getVoxelNumber() == testSlice.getVoxelNumber(), "Bug?");
-    TZ_ASSERT(slice.getStripeNumber() == testSlice.getStripeNumber(), "Bug?");
-    TZ_ASSERT(slice.getSegmentNumber() == testSlice.getSegmentNumber(), "Bug?");
-#endif
+    slice.m_stripeArray.assign(m_stripeArray.begin() + startIndex,
+      m_stripeArray.begin() + endIndex);
   }
   slice.setCanonized(true);
   return slice;
@@ -2515,6 +2696,7 @@ void ZObject3dScan::processEvent(TEvent event) {
     if(event & EVENT_OBJECT_MODEL_CHANGED & ~EVENT_OBJECT_VIEW_CHANGED) {
       deprecate(COMPONENT_ACCUMULATED_STRIPE_NUMBER);
       deprecate(COMPONENT_SLICEWISE_VOXEL_NUMBER);
+      deprecate(COMPONENT_PYRAMID);
     }
     if(event & EVENT_OBJECT_UNCANONIZED & ~EVENT_OBJECT_VIEW_CHANGED) {
       setCanonized(false);
@@ -2525,6 +2707,7 @@ void ZObject3dScan::processEvent(TEvent event) {
     if(event & EVENT_OBJECT_VIEW_CHANGED) {
       deprecate(COMPONENT_STRIPE_INDEX_MAP);
       deprecate(COMPONENT_INDEX_SEGMENT_MAP);
+      deprecate(COMPONENT_SLICE_INDEX);
     }
   }
 }
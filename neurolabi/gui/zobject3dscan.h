@@ -48,6 +48,8 @@ public:
     COMPONENT_ACCUMULATED_STRIPE_NUMBER,
     COMPONENT_SLICEWISE_VOXEL_NUMBER,
     COMPONENT_Z_PROJECTION,
+    COMPONENT_PYRAMID,
+    COMPONENT_SLICE_INDEX,
     COMPONENT_ALL
   };
 
@@ -55,6 +57,10 @@ public:
     ACTION_NONE, ACTION_CANONIZE, ACTION_SORT_YZ
   };
 
+#ifndef SWIG
+  const static int MAX_PYRAMID_LEVEL;
+#endif
+
   bool isDeprecated(EComponent comp) const;
   void deprecate(EComponent comp);
   void deprecateDependent(EComponent comp);
@@ -231,6 +237,33 @@ public:
   void downsample(int xintv, int yintv, int zintv);
   void downsampleMax(int xintv, int yintv, int zintv);
 
+  /*!
+   * \brief Get a level of the downsampling pyramid.
+   *
+   * Level k is the object after downsampleMax(2^k - 1, 2^k - 1, 2^k - 1) and
+   * level 0 is the object itself. Each level is built from the previous one
+   * on the first request and cached until the object is changed.
+   *
+   * \return NULL if \a level is out of [0, MAX_PYRAMID_LEVEL].
+   */
+  const ZObject3dScan* getPyramidLevel(int level) const;
+
+  /*!
+   * \brief Get the finest pyramid level within a voxel budget.
+   *
+   * \return The smallest level that has no more than \a maxVoxelNumber
+   *         voxels, or MAX_PYRAMID_LEVEL if there is no such level.
+   */
+  int getPyramidLevelForVoxelNumber(size_t maxVoxelNumber) const;
+
+  /*!
+   * \brief Get a downsampled copy of the object.
+   *
+   * The result is the same as calling downsampleMax() on a copy, but it
+   * starts from the coarsest cached pyramid level that the intervals allow.
+   */
+  ZObject3dScan getDownsampledMax(int xintv, int yintv, int zintv) const;
+
   void upSample(int xIntv, int yIntv, int zIntv);
 
   Stack* toStack(int *offset = NULL, int v = 1) const;
@@ -286,6 +319,21 @@ public:
   std::vector<size_t> getConnectedObjectSize();
   std::vector<ZObject3dScan> getConnectedComponent(EAction ppAction);
 
+  /*!
+   * \brief Label 26-connected components of the segments.
+   *
+   * The object is canonized first. Segments of adjacent stripes are merged
+   * by union-find without building a connection graph. Large objects are
+   * labeled in Z slabs in parallel when \a multithreading is true.
+   *
+   * \param labelArray Component label of each segment, which is indexed in
+   *        the same way as getSegment(). The labels start from 0 and are
+   *        ordered by the first segment of each component.
+   * \return Number of components.
+   */
+  size_t labelConnectedSegment(std::vector<size_t> *labelArray,
+                               bool multithreading = true);
+
   inline bool isCanonized() const { return isEmpty() || m_isCanonized; }
   inline void setCanonized(bool canonized) { m_isCanonized = canonized; }
 
@@ -309,6 +357,17 @@ public:
   void duplicateSlice(int depth);
 
   ZObject3dScan getSlice(int z) const;
+
+  /*!
+   * \brief Get the stripes on a slice.
+   *
+   * The object is canonized if it is not. The stripes at \a z are
+   * [\a start, \a end) in the stripe array, which are found from an index
+   * of slices kept until the object is changed.
+   *
+   * \return false if there is no stripe at \a z.
+   */
+  bool getSliceRange(int z, size_t *start, size_t *end) const;
   ZObject3dScan getMedianSlice() const;
 
   ZObject3dScan getSlice(int minZ, int maxZ) const;
@@ -318,6 +377,16 @@ public:
   virtual void display(
       ZPainter &painter, int slice, EDisplayStyle option,
       NeuTube::EAxis sliceAxis) const;
+
+  /*!
+   * \brief Counters of slice painting for profiling.
+   *
+   * The counters are shared by all objects. Each solid painting adds the
+   * number of stripes it visits and the number of segments it draws.
+   */
+  static void ResetPaintCounter();
+  static uint64_t GetVisitedStripeCount();
+  static uint64_t GetPaintedSegmentCount();
   virtual const std::string& className() const;
 
   void dilate();
@@ -574,6 +643,14 @@ protected:
   mutable std::map<std::pair<int, int>, size_t> m_stripeMap;
   mutable std::map<size_t, std::pair<size_t, size_t> > m_indexSegmentMap;
   mutable ZObject3dScan *m_zProjection;
+  //Level k of the pyramid is at k - 1
+  mutable std::vector<ZObject3dScan*> m_pyramid;
+  //Z of each slice and the start of its stripes, with the end appended
+  mutable std::vector<int> m_sliceZArray;
+  mutable std::vector<size_t> m_sliceOffsetArray;
+
+  static uint64_t m_visitedStripeCount;
+  static uint64_t m_paintedSegmentCount;
 
   //SWIG has some problem recognizing const static type
 #ifndef SWIG
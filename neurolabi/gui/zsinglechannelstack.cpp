@@ -1,5 +1,12 @@
 #include "zsinglechannelstack.h"
 #include <string.h>
+#include <algorithm>
+#include <functional>
+#if defined(_QT_GUI_USED_)
+#include <QFuture>
+#include <QThread>
+#include <QtConcurrentRun>
+#endif
 #include "tz_fimage_lib.h"
 #include "tz_image_io.h"
 #include "tz_int_histogram.h"
@@ -24,9 +31,15 @@ bool ZSingleChannelStack::isDeprecated(EComponent component) const {
   case STACK:
     return m_stack == NULL;
   case STACK_MAX_PROJ:
-    return m_maxProj == NULL;
-  case STACK_MIN_PROJ:
-    return m_minProj == NULL;
+  case STACK_MIN_PROJ: {
+    Proj_Mode mode = (component == STACK_MAX_PROJ) ? MAX_PROJ : MIN_PROJ;
+    for(int axis = 0; axis < STACK_AXIS_NUMBER; ++axis) {
+      if(m_proj[mode][axis] != NULL) {
+        return false;
+      }
+    }
+    return true;
+  }
   case STACK_STAT:
     return m_stat == NULL;
   }
@@ -58,12 +71,13 @@ void ZSingleChannelStack::deprecate(EComponent component) {
     m_delloc = NULL;
     break;
   case STACK_MAX_PROJ:
-    delete m_maxProj;
-    m_maxProj = NULL;
-    break;
-  case STACK_MIN_PROJ:
-    delete m_minProj;
-    m_minProj = NULL;
+  case STACK_MIN_PROJ: {
+    Proj_Mode mode = (component == STACK_MAX_PROJ) ? MAX_PROJ : MIN_PROJ;
+    for(int axis = 0; axis < STACK_AXIS_NUMBER; ++axis) {
+      delete m_proj[mode][axis];
+      m_proj[mode][axis] = NULL;
+    }
+  }
     break;
   case STACK_STAT:
     delete m_stat;
@@ -97,30 +111,10 @@ ZStack_Stat* ZSingleChannelStack::getStat() const {
   return m_stat;
 }
 ZStack_Projection* ZSingleChannelStack::getMaxProj() {
-  if(m_stack == NULL) {
-    return NULL;
-  }
-  if(isVirtual()) {
-    return NULL;
-  }
-  if(isDeprecated(STACK_MAX_PROJ)) {
-    m_maxProj = new ZStack_Projection;
-    m_maxProj->update(m_stack, ZSingleChannelStack::MAX_PROJ);
-  }
-  return m_maxProj;
+  return getProj(MAX_PROJ, Z_AXIS);
 }
 ZStack_Projection* ZSingleChannelStack::getMinProj() {
-  if(m_stack == NULL) {
-    return NULL;
-  }
-  if(isVirtual()) {
-    return NULL;
-  }
-  if(isDeprecated(STACK_MIN_PROJ)) {
-    m_minProj = new ZStack_Projection;
-    m_minProj->update(m_stack, ZSingleChannelStack::MIN_PROJ);
-  }
-  return m_minProj;
+  return getProj(MIN_PROJ, Z_AXIS);
 }
 double ZSingleChannelStack::min() const {
   if(getStat() == NULL) {
@@ -185,6 +179,7 @@ void ZSingleChannelStack::setValue(int x, int y, int z, double v) {
       (*array)[1] = (uint8_t)((value & 0x0000FF00) >> 8);
       (*array)[2] = (uint8_t)((value & 0x00FF0000) >> 16);
     }
+    deprecateDependent(STACK);
   }
 }
 void ZSingleChannelStack::setValue(size_t index, double value) {
@@ -198,22 +193,15 @@ void ZSingleChannelStack::setValue(size_t index, double value) {
     } else if(kind() == FLOAT64) {
       *((float64*)(m_stack->array) + index) = value;
     }
+    deprecateDependent(STACK);
   }
 }
 int ZSingleChannelStack::maxIntensityDepth(int x, int y) const {
-  int max_z = 0;
-  if(!isVirtual()) {
-    int z = 0;
-    double max_value = value(x, y, z);
-    for(z = 1; z < depth(); z++) {
-      double cvalue = value(x, y, z);
-      if(cvalue > max_value) {
-        max_value = cvalue;
-        max_z = z;
-      }
-    }
+  const ZStack_Projection* proj = getProj(MAX_PROJ, Z_AXIS);
+  if(proj == NULL || proj->depth() == NULL) {
+    return 0;
   }
-  return max_z;
+  return proj->depth(x, y);
 }
 void ZSingleChannelStack::shiftLocation(int* offset, int width, int height, int depth) {
   if(width == -1)
@@ -239,23 +227,36 @@ void ZSingleChannelStack::setData(Stack* stack,
   m_stack = stack;
   m_delloc = delloc;
 }
-ZStack_Projection* ZSingleChannelStack::getProj(Proj_Mode mode) {
-  switch(mode) {
-  case MAX_PROJ:
-    return getMaxProj();
-  case MIN_PROJ:
-    return getMinProj();
+ZStack_Projection* ZSingleChannelStack::getProj(
+  Proj_Mode mode, Stack_Axis axis) const {
+  if(m_stack == NULL) {
+    return NULL;
+  }
+  if(isVirtual()) {
+    return NULL;
+  }
+  if(m_proj[mode][axis] == NULL) {
+    m_proj[mode][axis] = new ZStack_Projection;
+    m_proj[mode][axis]->update(m_stack, mode, axis);
   }
-  return NULL;
+  return m_proj[mode][axis];
 }
 void* ZSingleChannelStack::projection(
   ZSingleChannelStack::Proj_Mode mode, ZSingleChannelStack::Stack_Axis axis) {
-  UNUSED_PARAMETER(mode);
-  UNUSED_PARAMETER(axis);
-  if(isVirtual()) {
+  ZStack_Projection* proj = getProj(mode, axis);
+  if(proj == NULL) {
     return NULL;
   }
-  return getProj(mode)->data();
+  return proj->data();
+}
+const int* ZSingleChannelStack::projectionDepth(
+  ZSingleChannelStack::Proj_Mode mode,
+  ZSingleChannelStack::Stack_Axis axis) const {
+  ZStack_Projection* proj = getProj(mode, axis);
+  if(proj == NULL) {
+    return NULL;
+  }
+  return proj->depth();
 }
 void ZSingleChannelStack::bcAdjustHint(double* scale, double* offset) {
   ZStack_Stat* stat = getStat();
@@ -346,26 +347,227 @@ void ZSingleChannelStack::init() {
   m_stack = NULL;
   m_delloc = NULL;
   m_data.array = NULL;
-  m_maxProj = NULL;
-  m_minProj = NULL;
+  for(int mode = 0; mode < PROJ_MODE_NUMBER; ++mode) {
+    for(int axis = 0; axis < STACK_AXIS_NUMBER; ++axis) {
+      m_proj[mode][axis] = NULL;
+    }
+  }
   m_stat = NULL;
   // m_isOwner = true;
 }
 void ZSingleChannelStack::copyData(const Stack* stack) {
   Copy_Stack_Array(m_stack, stack);
 }
-void ZStack_Projection::update(Stack* stack, ZSingleChannelStack::Proj_Mode mode) {
+namespace {
+/*
+ * Projection kernel over one channel of a stack. A pixel (u, v) of the
+ * projection image collects the voxels at src + u * su + v * sv + k * sk,
+ * k = 0, ..., nk - 1. Rows [v0, v1) can be computed independently.
+ */
+template <typename T>
+class ZProjectionKernel {
+public:
+  ZProjectionKernel(const T* src, T* dst, int* depth, bool isMax)
+    : m_src(src)
+    , m_dst(dst)
+    , m_depth(depth)
+    , m_isMax(isMax)
+    , m_dstStride(1) {}
+  void setLayout(int nu, int nk, size_t su, size_t sv, size_t sk) {
+    m_nu = nu;
+    m_nk = nk;
+    m_su = su;
+    m_sv = sv;
+    m_sk = sk;
+  }
+  void setDstStride(size_t stride) { m_dstStride = stride; }
+  void run(int v0, int v1) const {
+    if(m_isMax) {
+      runBlock<std::greater<T> >(v0, v1);
+    } else {
+      runBlock<std::less<T> >(v0, v1);
+    }
+  }
+
+private:
+  template <typename Compare>
+  void runBlock(int v0, int v1) const {
+    Compare better;
+    for(int v = v0; v < v1; ++v) {
+      const T* srcRow = m_src + (size_t)v * m_sv;
+      T* dstRow = m_dst + (size_t)v * m_nu * m_dstStride;
+      int* depthRow = (m_depth == NULL) ? NULL : m_depth + (size_t)v * m_nu;
+      if(m_sk < m_su) {
+        // The projection axis is the fastest one; scan each line at once.
+        for(int u = 0; u < m_nu; ++u) {
+          const T* line = srcRow + (size_t)u * m_su;
+          T best = line[0];
+          int bestK = 0;
+          for(int k = 1; k < m_nk; ++k) {
+            if(better(line[(size_t)k * m_sk], best)) {
+              best = line[(size_t)k * m_sk];
+              bestK = k;
+            }
+          }
+          dstRow[(size_t)u * m_dstStride] = best;
+          if(depthRow != NULL) {
+            depthRow[u] = bestK;
+          }
+        }
+      } else {
+        for(int u = 0; u < m_nu; ++u) {
+          dstRow[(size_t)u * m_dstStride] = srcRow[(size_t)u * m_su];
+        }
+        if(depthRow != NULL) {
+          std::fill(depthRow, depthRow + m_nu, 0);
+        }
+        for(int k = 1; k < m_nk; ++k) {
+          const T* plane = srcRow + (size_t)k * m_sk;
+          for(int u = 0; u < m_nu; ++u) {
+            T& current = dstRow[(size_t)u * m_dstStride];
+            if(better(plane[(size_t)u * m_su], current)) {
+              current = plane[(size_t)u * m_su];
+              if(depthRow != NULL) {
+                depthRow[u] = k;
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+private:
+  const T* m_src;
+  T* m_dst;
+  int* m_depth;
+  bool m_isMax;
+  size_t m_dstStride;
+  int m_nu;
+  int m_nk;
+  size_t m_su;
+  size_t m_sv;
+  size_t m_sk;
+};
+
+// Stacks smaller than this are projected in the calling thread
+const size_t PROJECTION_MULTI_THREAD_THRESHOLD = 1024 * 1024;
+
+template <typename T>
+void RunProjectionKernel(const ZProjectionKernel<T>& kernel, int nv,
+  size_t voxelNumber) {
+#if defined(_QT_GUI_USED_)
+  if(voxelNumber >= PROJECTION_MULTI_THREAD_THRESHOLD) {
+    int blockNumber = std::min(nv, std::max(1, QThread::idealThreadCount()));
+    int blockHeight = nv / blockNumber;
+    std::vector<QFuture<void> > res(blockNumber);
+    for(int i = 0; i < blockNumber; ++i) {
+      int v0 = i * blockHeight;
+      int v1 = (i == blockNumber - 1) ? nv : (i + 1) * blockHeight;
+      res[i] = QtConcurrent::run(&kernel, &ZProjectionKernel<T>::run, v0, v1);
+    }
+    for(int i = 0; i < blockNumber; ++i) {
+      res[i].waitForFinished();
+    }
+    return;
+  }
+#else
+  UNUSED_PARAMETER(voxelNumber);
+#endif
+  kernel.run(0, nv);
+}
+
+template <typename T>
+void ProjectStack(const Stack* stack, Image* image, int* depth,
+  ZSingleChannelStack::Proj_Mode mode, ZSingleChannelStack::Stack_Axis axis,
+  int channelNumber) {
+  size_t area = (size_t)stack->width * stack->height;
+  int nu = 0;
+  int nv = 0;
+  int nk = 0;
+  size_t su = 0;
+  size_t sv = 0;
+  size_t sk = 0;
+  switch(axis) {
+  case ZSingleChannelStack::X_AXIS:
+    nu = stack->height;
+    nv = stack->depth;
+    nk = stack->width;
+    su = stack->width;
+    sv = area;
+    sk = 1;
+    break;
+  case ZSingleChannelStack::Y_AXIS:
+    nu = stack->width;
+    nv = stack->depth;
+    nk = stack->height;
+    su = 1;
+    sv = area;
+    sk = stack->width;
+    break;
+  case ZSingleChannelStack::Z_AXIS:
+    nu = stack->width;
+    nv = stack->height;
+    nk = stack->depth;
+    su = 1;
+    sv = stack->width;
+    sk = area;
+    break;
+  }
+  for(int c = 0; c < channelNumber; ++c) {
+    ZProjectionKernel<T> kernel((const T*)(stack->array) + c,
+      (T*)(image->array) + c, (c == 0) ? depth : NULL,
+      mode == ZSingleChannelStack::MAX_PROJ);
+    kernel.setLayout(nu, nk, su * channelNumber, sv * channelNumber,
+      sk * channelNumber);
+    kernel.setDstStride(channelNumber);
+    RunProjectionKernel(kernel, nv, area * stack->depth);
+  }
+}
+} // namespace
+
+void ZStack_Projection::update(Stack* stack, ZSingleChannelStack::Proj_Mode mode,
+  ZSingleChannelStack::Stack_Axis axis) {
   if(m_proj != NULL) {
     Kill_Image(m_proj);
     m_proj = NULL;
   }
+  m_depth.clear();
   if(stack->array != NULL) {
-    switch(mode) {
-    case ZSingleChannelStack::MAX_PROJ:
-      m_proj = Proj_Stack_Zmax(stack);
+    switch(axis) {
+    case ZSingleChannelStack::X_AXIS:
+      m_proj = Make_Image(stack->kind, stack->height, stack->depth);
+      break;
+    case ZSingleChannelStack::Y_AXIS:
+      m_proj = Make_Image(stack->kind, stack->width, stack->depth);
+      break;
+    case ZSingleChannelStack::Z_AXIS:
+      m_proj = Make_Image(stack->kind, stack->width, stack->height);
+      break;
+    }
+    m_depth.resize((size_t)m_proj->width * m_proj->height);
+    int* depth = m_depth.empty() ? NULL : &(m_depth[0]);
+    switch(stack->kind) {
+    case GREY:
+      ProjectStack<uint8_t>(stack, m_proj, depth, mode, axis, 1);
+      break;
+    case COLOR:
+      // The depth map follows the first channel, as ZSingleChannelStack::value
+      ProjectStack<uint8_t>(stack, m_proj, depth, mode, axis, 3);
+      break;
+    case GREY16:
+      ProjectStack<uint16_t>(stack, m_proj, depth, mode, axis, 1);
+      break;
+    case FLOAT32:
+      ProjectStack<float32>(stack, m_proj, depth, mode, axis, 1);
+      break;
+    case FLOAT64:
+      ProjectStack<float64>(stack, m_proj, depth, mode, axis, 1);
       break;
-    case ZSingleChannelStack::MIN_PROJ:
-      m_proj = Proj_Stack_Zmin(stack);
+    default:
+      Kill_Image(m_proj);
+      m_proj = NULL;
+      m_depth.clear();
       break;
     }
   }
@@ -1,5 +1,6 @@
 #ifndef ZSINGLECHANNELSTACK_H
 #define ZSINGLECHANNELSTACK_H
+#include <vector>
 #include "c_stack.h"
 #include "tz_image_lib_defs.h"
 class ZStack_Projection;
@@ -19,6 +20,8 @@ public:
     Y_AXIS,
     Z_AXIS
   };
+  static const int PROJ_MODE_NUMBER = 2;
+  static const int STACK_AXIS_NUMBER = 3;
   inline int width() const { return m_stack->width; }
   inline int height() const { return m_stack->height; }
   inline int depth() const { return m_stack->depth; }
@@ -53,10 +56,18 @@ public:
   ZStack_Stat* getStat() const;
   ZStack_Projection* getMaxProj();
   ZStack_Projection* getMinProj();
-  ZStack_Projection* getProj(Proj_Mode mode);
+  /*!
+   * \brief Get the cached projection along an axis.
+   *
+   * The projection and its depth map are computed together on the first call
+   * and kept until the stack data changes. It returns NULL if the stack is
+   * virtual.
+   */
+  ZStack_Projection* getProj(Proj_Mode mode, Stack_Axis axis = Z_AXIS) const;
   void setValue(int x, int y, int z, double v);
   void setValue(size_t index, double value);
-  // Maximum voxel value along a z-parallel line passing (<x>, <y>).
+  // Depth of the maximum voxel value along a z-parallel line passing (<x>, <y>).
+  // The depth is read from the cached Z projection.
   int maxIntensityDepth(int x, int y) const;
   inline uint8_t* array8() { return m_data.array8; }
   inline uint16_t* array16() { return m_data.array16; }
@@ -75,6 +86,14 @@ public: /* data operation */
 
 public: /* operations */
   void* projection(Proj_Mode mode, Stack_Axis axis = Z_AXIS);
+  /*!
+   * \brief Depth map of a projection.
+   *
+   * Each pixel stores the index along \a axis where the projected value comes
+   * from. The first index is taken when there is a tie. The map has the same
+   * layout as the projection image.
+   */
+  const int* projectionDepth(Proj_Mode mode, Stack_Axis axis = Z_AXIS) const;
   void bcAdjustHint(double* scale, double* offset);
   bool isBinary();
 
@@ -93,11 +112,18 @@ private:
 private:
   Stack* m_stack;
   C_Stack::Stack_Deallocator* m_delloc;
-  ZStack_Projection* m_maxProj;
-  ZStack_Projection* m_minProj;
+  mutable ZStack_Projection* m_proj[PROJ_MODE_NUMBER][STACK_AXIS_NUMBER];
   mutable ZStack_Stat* m_stat;
   Image_Array m_data;
 };
+/*!
+ * \brief Projection of a stack along an axis with its depth (arg-max) map.
+ *
+ * The projection image follows the layout of Proj_Stack_Xmax (height x depth),
+ * Proj_Stack_Ymax (width x depth) and Proj_Stack_Zmax (width x height). The
+ * image rows are split into blocks and computed in parallel when Qt is
+ * available.
+ */
 class ZStack_Projection {
 public:
   ZStack_Projection(Stack* parent = NULL)
@@ -106,12 +132,23 @@ public:
   ~ZStack_Projection() {
     if(m_proj != NULL) { Kill_Image(m_proj); }
   }
-  void update(Stack* stack, ZSingleChannelStack::Proj_Mode mode);
-  inline void* data() { return (void*)m_proj->array; }
+  void update(Stack* stack, ZSingleChannelStack::Proj_Mode mode,
+    ZSingleChannelStack::Stack_Axis axis = ZSingleChannelStack::Z_AXIS);
+  inline void* data() { return m_proj == NULL ? NULL : (void*)m_proj->array; }
+  inline const int* depth() const {
+    return m_depth.empty() ? NULL : &(m_depth[0]);
+  }
+  inline int width() const { return m_proj == NULL ? 0 : m_proj->width; }
+  inline int height() const { return m_proj == NULL ? 0 : m_proj->height; }
+  // Depth of the projected value at (<x>, <y>) of the projection image.
+  inline int depth(int x, int y) const {
+    return m_depth[(size_t)y * width() + x];
+  }
 
 private:
   Stack* m_parent;
   Image* m_proj;
+  std::vector<int> m_depth;
 };
 class ZStack_Stat {
 public:
@@ -122,10 +122,9 @@ ZStack* ZSparseStack::getStack()
       size_t volume = cuboid.getVolume();
       double dsRatio = (double) volume / MAX_STACK_VOLUME;
       if (dsRatio > 1.0) {
-        ZObject3dScan obj = *m_objectMask;
         m_dsIntv = misc::getDsIntvFor3DVolume(dsRatio);
-
-        obj.downsampleMax(m_dsIntv.getX(), m_dsIntv.getY(), m_dsIntv.getZ());
+        ZObject3dScan obj = m_objectMask->getDownsampledMax(
+              m_dsIntv.getX(), m_dsIntv.getY(), m_dsIntv.getZ());
 
         ZStackBlockGrid *dsGrid = m_stackGrid->makeDownsample(
               m_dsIntv.getX(), m_dsIntv.getY(), m_dsIntv.getZ());
@@ -7,6 +7,7 @@
 #include <cmath>
 #include <iostream>
 #include <string.h>
+#include "bigdata/zchunkedstack.h"
 #include "c_stack.h"
 #include "neutubeconfig.h"
 #include "tz_fimage_lib.h"
@@ -130,6 +131,7 @@ void ZStack::consume(Stack* stack) {
 }
 void ZStack::consume(ZStack* stack) {
   this->setData(stack->m_stack, stack->m_dealloc);
+  m_chunkedStack = stack->m_chunkedStack;
   stack->m_dealloc = NULL;
   setSource(stack->source());
   setOffset(stack->getOffset());
@@ -307,6 +309,7 @@ void ZStack::deprecate(EComponent component) {
     }
     m_stack = NULL;
     m_dealloc = NULL;
+    m_chunkedStack.reset();
     break;
   case SINGLE_CHANNEL_VIEW:
     for(size_t i = 0; i < m_singleChannelStack.size(); ++i) {
@@ -565,6 +568,13 @@ string ZStack::save(const string& filepath) const {
 void* ZStack::projection(
   ZSingleChannelStack::Proj_Mode mode, ZSingleChannelStack::Stack_Axis axis,
   int c) {
+  if(hasChunkedData()) {
+    const Stack* proj = NULL;
+    if(axis == ZSingleChannelStack::Z_AXIS) {
+      proj = m_chunkedStack->projection(mode, c);
+    }
+    return proj == NULL ? NULL : proj->array;
+  }
   return singleChannelStack(c)->projection(mode, axis);
 }
 void* ZStack::projection(
@@ -576,7 +586,7 @@ void* ZStack::projection(
   return projection(mode, axis, c);
 }
 double ZStack::value(int x, int y, int z, int c) const {
-  if(isVirtual()) {
+  if(isVirtual() && !hasChunkedData()) {
     return 0.0;
   }
   if(!(IS_IN_CLOSE_RANGE(x, 0, width() - 1) &&
@@ -588,6 +598,10 @@ double ZStack::value(int x, int y, int z, int c) const {
   if(z < 0) {
     z = maxIntensityDepth(x, y, c);
   }
+  if(hasChunkedData()) {
+    return m_chunkedStack->value(
+      x + m_offset.getX(), y + m_offset.getY(), z + m_offset.getZ(), c);
+  }
   return singleChannelStack(c)->value(x, y, z);
 }
 void ZStack::setIntValue(int x, int y, int z, int c, int v) {
@@ -692,6 +706,9 @@ int ZStack::getIntValue8WithXCheckOnly(int x, int y, int z, int c) const {
   return ima.array8[offset];
 }
 int ZStack::getIntValue(int x, int y, int z, int c) const {
+  if(hasChunkedData()) {
+    return m_chunkedStack->getIntValue(x, y, z, c);
+  }
   if(isVirtual()) {
     return 0;
   }
@@ -900,6 +917,10 @@ void ZStack::setValue(size_t index, int c, double value) {
   singleChannelStack(c)->setValue(index, value);
 }
 int ZStack::maxIntensityDepth(int x, int y, int c) const {
+  if(hasChunkedData()) {
+    return m_chunkedStack->maxIntensityDepth(
+      x + m_offset.getX(), y + m_offset.getY(), c);
+  }
   return singleChannelStack(c)->maxIntensityDepth(x, y);
 }
 bool ZStack::isThresholdable() {
@@ -1054,6 +1075,25 @@ bool ZStack::isVirtual() const {
 bool ZStack::hasData() const {
   return !isEmpty() && !isVirtual();
 }
+void ZStack::setChunkedData(const ZSharedPointer<ZChunkedStack>& chunkedStack) {
+  deprecate(MC_STACK);
+  if(chunkedStack && chunkedStack->isOpen()) {
+    Mc_Stack* stack = new Mc_Stack;
+    stack->array = NULL;
+    C_Stack::setAttribute(stack, chunkedStack->kind(), chunkedStack->width(),
+      chunkedStack->height(), chunkedStack->depth(),
+      chunkedStack->channelNumber());
+    setData(stack, C_Stack::cppDelete);
+    m_chunkedStack = chunkedStack;
+    m_offset = chunkedStack->getMinPoint();
+  }
+}
+bool ZStack::hasChunkedData() const {
+  return m_chunkedStack.get() != NULL;
+}
+ZChunkedStack* ZStack::getChunkedData() const {
+  return m_chunkedStack.get();
+}
 void* ZStack::getDataPointer(int c, int slice) const {
   const uint8_t* array = array8(c);
   array += getByteNumber(SINGLE_PLANE) * slice;
@@ -1460,7 +1500,9 @@ ZStack* ZStack::makeCrop(const ZIntCuboid& cuboid) const {
     return NULL;
   }
   ZStack* cropped = NULL;
-  if(isVirtual()) {
+  if(hasChunkedData()) {
+    cropped = m_chunkedStack->makeCrop(cuboid);
+  } else if(isVirtual()) {
     cropped = ZStackFactory::makeVirtualStack(cuboid);
   } else {
     if(!cuboid.isEmpty()) {
@@ -1494,7 +1536,17 @@ void ZStack::crop(const ZIntCuboid& cuboid) {
   if(isEmpty()) {
     return;
   }
-  if(isVirtual()) {
+  if(hasChunkedData()) {
+    ZStack* cropped = m_chunkedStack->makeCrop(cuboid);
+    if(cropped != NULL) {
+      setData(cropped->m_stack, cropped->m_dealloc);
+      cropped->m_dealloc = NULL;
+      m_offset = cuboid.getFirstCorner();
+      delete cropped;
+    } else {
+      deprecate(MC_STACK);
+    }
+  } else if(isVirtual()) {
     m_stack->width = cuboid.getWidth();
     m_stack->height = cuboid.getHeight();
     m_stack->depth = cuboid.getDepth();
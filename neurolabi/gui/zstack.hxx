@@ -20,6 +20,8 @@
 #include "zresolution.h"
 #include "zsinglechannelstack.h"
 #include "zstackfile.h"
+#include "zsharedpointer.h"
+class ZChunkedStack;
 //! Stack class
 /*!
  *It supports multi-channel stacks. But most operations are on the first channel
@@ -257,6 +259,19 @@ public: /* attributes */
    * \return A stack has data if it is not empty and virtual.
    */
   bool hasData() const;
+  /*!
+   * \brief Use a chunked stack as the data.
+   *
+   * The stack becomes a virtual stack with the size and offset of
+   * \a chunkedStack. Voxel values, crops and projections are then read from
+   * the chunks.
+   */
+  void setChunkedData(const ZSharedPointer<ZChunkedStack> &chunkedStack);
+  /*!
+   * \brief Test if the data of a stack is stored in chunks.
+   */
+  bool hasChunkedData() const;
+  ZChunkedStack* getChunkedData() const;
   // make mc_stack
   static Mc_Stack* makeMcStack(
     const Stack* stack1, const Stack* stack2, const Stack* stack3);
@@ -388,6 +403,12 @@ public: /* data operation */
   void* rawChannelData(int c);
   // Stack* channelData(int c);
 public: /* operations */
+  /*!
+   * \brief Projection of a channel.
+   *
+   * A stack with chunked data only has the projection along the Z axis. It
+   * returns NULL for the other axes, or if the chunks cannot be read.
+   */
   void* projection(ZSingleChannelStack::Proj_Mode mode,
     ZSingleChannelStack::Stack_Axis axis = ZSingleChannelStack::Z_AXIS,
     int c = 0);
@@ -516,6 +537,7 @@ private:
   C_Stack::Mc_Stack_Deallocator* m_dealloc; // Dellocator of the master data
   ZIntPoint m_offset;
   ZStackFile m_source;
+  ZSharedPointer<ZChunkedStack> m_chunkedStack;
   mutable std::vector<Stack> m_stackView;
   mutable std::vector<ZSingleChannelStack*> m_singleChannelStack;
   mutable char m_buffer[1]; // Buffer of text field of temporary stack
@@ -8,6 +8,7 @@
 #include <QSet>
 #include <vector>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QInputDialog>
 #include <QApplication>
 #include <QtConcurrentRun>
@@ -85,7 +86,7 @@
 #include "dialogs/swcskeletontransformdialog.h"
 #include "dialogs/swcsizedialog.h"
 #include "tz_stack_watershed.h"
-#include "zstackwatershed.h"
+#include "zincrementalwatershed.h"
 #include "zstackarray.h"
 #include "zstackfactory.h"
 #include "zsparseobject.h"
@@ -120,6 +121,7 @@ ZStackDoc::~ZStackDoc()
   if (m_futureMap.hasThreadAlive()) {
     m_futureMap.waitForFinished();
   }
+  stopReader();
   deprecate(STACK);
   deprecate(SPARSE_STACK);
   qDebug() << "ZStackDoc destroyed";
@@ -132,6 +134,8 @@ ZStackDoc::~ZStackDoc()
   delete m_labelField;
   delete m_stackFactory;
   delete m_actionFactory;
+  delete m_localWatershed;
+  delete m_splitWatershed;
 
   if (m_resDlg != NULL) {
     delete m_resDlg;
@@ -150,6 +154,8 @@ void ZStackDoc::init()
   m_autoSaving = true;
   m_stack = NULL;
   m_sparseStack = NULL;
+  m_localWatershed = NULL;
+  m_splitWatershed = NULL;
   m_labelField = NULL;
   m_parentFrame = NULL;
   m_isTraceMaskObsolete = true;
@@ -219,6 +225,19 @@ void ZStackDoc::clearData()
 //  m_isSegmentationReady = false;
 }
 
+void ZStackDoc::stopReader()
+{
+  if (m_reader.isRunning()) {
+    m_reader.cancel();
+    m_reader.wait();
+  }
+
+  if (m_reader.getStack() != getStack()) {
+    delete m_reader.getStack();
+  }
+  m_reader.clear();
+}
+
 void ZStackDoc::initNeuronTracer()
 {
   m_neuronTracer.initTraceWorkspace(getStack());
@@ -310,6 +329,9 @@ void ZStackDoc::connectSignalSlot()
 
   connect(&m_reader, SIGNAL(finished()), this, SIGNAL(stackReadDone()));
   connect(this, SIGNAL(stackReadDone()), this, SLOT(loadReaderResult()));
+  connect(&m_reader, SIGNAL(stackAllocated()), this, SLOT(loadReaderStack()));
+  connect(&m_reader, SIGNAL(planeLoaded(int,int)),
+          this, SLOT(updateReaderPlane(int,int)));
   connect(this, SIGNAL(stackModified()), this, SIGNAL(volumeModified()));
 
   connect(this, SIGNAL(progressAdvanced(double)),
@@ -1346,6 +1368,17 @@ void ZStackDoc::loadStack(ZStack *zstack)
 
 void ZStackDoc::loadReaderResult()
 {
+  if (m_reader.isRunning() || m_reader.getStackFile() == NULL) {
+    //Outdated result
+    return;
+  }
+
+  if (getStack() != NULL && getStack() == m_reader.getStack()) {
+    //Already loaded progressively
+    updateReaderPlane(0, getStack()->depth() - 1);
+    return;
+  }
+
   deprecate(STACK);
   ZStack*& mainStack = stackRef();
   mainStack = m_reader.getStack();
@@ -1364,6 +1397,36 @@ void ZStackDoc::loadReaderResult()
   emit stackLoaded();
 }
 
+void ZStackDoc::loadReaderStack()
+{
+  if (m_reader.getStackFile() == NULL || m_reader.getStack() == NULL ||
+      m_reader.getStack() == getStack()) {
+    return;
+  }
+
+  deprecate(STACK);
+  ZStack*& mainStack = stackRef();
+  mainStack = m_reader.getStack();
+  initNeuronTracer();
+  setStackSource(m_reader.getStackFile()->firstUrl().c_str());
+
+  emit stackLoaded();
+}
+
+void ZStackDoc::updateReaderPlane(int /*startPlane*/, int /*endPlane*/)
+{
+  ZStack *stack = getStack();
+  if (stack != NULL && stack == m_reader.getStack()) {
+    //The reader leaves the planes to be copied here so that the stack is
+    //never written by another thread while it is in use
+    m_reader.flushLoadedPlanes();
+    for (int c = 0; c < stack->channelNumber(); ++c) {
+      stack->deprecateSingleChannelView(c);
+    }
+    notifyStackModified();
+  }
+}
+
 QAction* ZStackDoc::getAction(ZActionFactory::EAction item) const
 {
   const_cast<ZStackDoc&>(*this).makeAction(item);
@@ -1535,9 +1598,12 @@ void ZStackDoc::selectDownstreamNode()
 
 void ZStackDoc::readStack(const char *filePath, bool newThread)
 {
+  stopReader();
+
   m_stackSource.import(filePath);
   if (newThread) {
     m_reader.setStackFile(&m_stackSource);
+    m_reader.setProgressive(true);
     m_reader.start();
   } else {
     deprecate(STACK);
@@ -4770,6 +4836,10 @@ void ZStackDoc::deprecate(EComponent component)
   deprecateDependent(component);
   switch (component) {
   case STACK:
+    if (stackRef() != NULL && stackRef() == m_reader.getStack()) {
+      //The reader may still be filling the stack
+      stopReader();
+    }
     delete stackRef();
     stackRef() = NULL;
     m_neuronTracer.clear();
@@ -5123,11 +5193,13 @@ void ZStackDoc::notifySparseObjectModified()
 
 void ZStackDoc::notifyStackModified()
 {
+  clearWatershedState();
   emit stackModified();
 }
 
 void ZStackDoc::notifySparseStackModified()
 {
+  clearWatershedState();
   emit sparseStackModified();
 }
 
@@ -8863,6 +8935,32 @@ void ZStackDoc::updateWatershedBoundaryObject(ZStack *out, ZIntPoint dsIntv)
   }
 }
 
+void ZStackDoc::reportWatershedUpdate(
+    const ZIncrementalWatershed *engine, qint64 time)
+{
+  QString msg = QString("Watershed %1 in %2 ms: %3 voxels flooded, "
+                        "%4 basins reset").
+      arg(engine->isLastRunIncremental() ? "updated" : "computed").
+      arg(time).arg(engine->getLastFloodedVoxelNumber()).
+      arg(engine->getLastResetBasinNumber());
+  emit messageGenerated(ZWidgetMessage(msg));
+}
+
+/*
+ * The watershed engines identify the signal by its stack object, so their
+ * states have to be cleared when the signal is changed in place.
+ */
+void ZStackDoc::clearWatershedState()
+{
+  if (m_localWatershed != NULL) {
+    m_localWatershed->clear();
+  }
+
+  if (m_splitWatershed != NULL) {
+    m_splitWatershed->clear();
+  }
+}
+
 ZDvidSparseStack* ZStackDoc::getDvidSparseStack() const
 {
   ZStackObject *obj = getObjectGroup().findFirstSameSource(
@@ -8884,7 +8982,9 @@ void ZStackDoc::localSeededWatershed()
   getProgressSignal()->advanceProgress(0.1);
 
   if (!seedMask.empty()) {
-    ZStackWatershed engine;
+    if (m_localWatershed == NULL) {
+      m_localWatershed = new ZIncrementalWatershed;
+    }
 
     ZStack *signalStack = m_stack;
     ZIntPoint dsIntv(0, 0, 0);
@@ -8896,7 +8996,12 @@ void ZStackDoc::localSeededWatershed()
       } else {
         ZDvidSparseStack *sparseStack = getDvidSparseStack();
         if (sparseStack != NULL) {
-          signalStack = sparseStack->getStack(seedMask.getBoundBox());
+          bool isUpdated = false;
+          signalStack = sparseStack->getStack(
+                seedMask.getBoundBox(), &isUpdated);
+          if (isUpdated) {
+            clearWatershedState();
+          }
 #ifdef _DEBUG_2
           signalStack->save(GET_TEST_DATA_DIR + "/test.tif");
 #endif
@@ -8927,8 +9032,28 @@ void ZStackDoc::localSeededWatershed()
       Cuboid_I_Expand_Y(&box, yMargin);
       Cuboid_I_Expand_Z(&box, zMargin);
 
-      engine.setRange(box);
-      ZStack *out = engine.run(signalStack, seedMask);
+      //Keep working in the previous range to reuse its state
+      Cuboid_I stackBox;
+      signalStack->getBoundBox(&stackBox);
+      Cuboid_I_Intersect(&box, &stackBox, &box);
+      Cuboid_I workingBox;
+      if (m_localWatershed->getWorkingBox(&workingBox)) {
+        bool isInWorkingBox = true;
+        for (int i = 0; i < 3; ++i) {
+          if (box.cb[i] < workingBox.cb[i] || box.ce[i] > workingBox.ce[i]) {
+            isInWorkingBox = false;
+          }
+        }
+        if (isInWorkingBox) {
+          box = workingBox;
+        }
+      }
+
+      QElapsedTimer timer;
+      timer.start();
+      m_localWatershed->setRange(box);
+      ZStack *out = m_localWatershed->run(signalStack, seedMask);
+      reportWatershedUpdate(m_localWatershed, timer.elapsed());
       getProgressSignal()->advanceProgress(0.3);
 
 //      advanceProgress(0.1);
@@ -8964,7 +9089,9 @@ void ZStackDoc::seededWatershed()
 
   getProgressSignal()->advanceProgress(0.1);
   //removeAllObj3d();
-  ZStackWatershed engine;
+  if (m_splitWatershed == NULL) {
+    m_splitWatershed = new ZIncrementalWatershed;
+  }
 
   qDebug() << "Creating seed mask ...";
   ZStackArray seedMask = createWatershedMask(false);
@@ -8982,7 +9109,11 @@ void ZStackDoc::seededWatershed()
       } else {
         ZDvidSparseStack *sparseStack = getDvidSparseStack();
         if (sparseStack != NULL) {
-          signalStack = sparseStack->getStack();
+          bool isUpdated = false;
+          signalStack = sparseStack->getStack(&isUpdated);
+          if (isUpdated) {
+            clearWatershedState();
+          }
           dsIntv = sparseStack->getDownsampleInterval();
         }
       }
@@ -8998,7 +9129,10 @@ void ZStackDoc::seededWatershed()
       signalStack->save(GET_TEST_DATA_DIR + "/test2.tif");
 #endif
 
-      ZStack *out = engine.run(signalStack, seedMask);
+      QElapsedTimer timer;
+      timer.start();
+      ZStack *out = m_splitWatershed->run(signalStack, seedMask);
+      reportWatershedUpdate(m_splitWatershed, timer.elapsed());
       getProgressSignal()->advanceProgress(0.3);
 
       updateWatershedBoundaryObject(out, dsIntv);
@@ -80,6 +80,7 @@ class ZStackMvc;
 class ZProgressSignal;
 class ZWidgetMessage;
 class ZDvidSparseStack;
+class ZIncrementalWatershed;
 
 /*!
  * \brief The class of stack document
@@ -1052,6 +1053,8 @@ public slots:
   void autoSaveSlot();
   bool saveSwc(const std::string &filePath);
   void loadReaderResult();
+  void loadReaderStack();
+  void updateReaderPlane(int startPlane, int endPlane);
   void selectDownstreamNode();
   void selectSwcNodeConnection(Swc_Tree_Node *lastSelectedNode = NULL);
   void selectSwcNodeFloodFilling(Swc_Tree_Node *lastSelectedNode);
@@ -1166,6 +1169,8 @@ private:
 
   void connectSignalSlot();
   void initNeuronTracer();
+  //Stop the stack reader and drop the stack it has not handed over
+  void stopReader();
   //void initTraceWorkspace();
   //void initConnectionTestWorkspace();
   //void loadTraceMask(bool traceMasked);
@@ -1175,6 +1180,9 @@ private:
   virtual std::vector<ZStack*> createWatershedMask(bool selectedOnly);
   ResolutionDialog* getResolutionDialog();
   void updateWatershedBoundaryObject(ZStack *out, ZIntPoint dsIntv);
+  void reportWatershedUpdate(const ZIncrementalWatershed *engine,
+                             qint64 time);
+  void clearWatershedState();
 
   static void expandSwcNodeList(QList<Swc_Tree_Node*> *swcList,
                                 const std::set<Swc_Tree_Node*> &swcSet);
@@ -1191,6 +1199,10 @@ private:
   ZStack *m_stack;
   ZSparseStack *m_sparseStack; //Serve as main data when m_stack is virtual.
 
+  //Watershed states kept between splits
+  ZIncrementalWatershed *m_localWatershed;
+  ZIncrementalWatershed *m_splitWatershed;
+
   ZResolution m_resolution;
 
   ZDocPlayerList m_playerList;
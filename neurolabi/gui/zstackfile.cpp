@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <string.h>
+#include <algorithm>
 
 #include "zstack.hxx"
 #include "tz_image_io.h"
@@ -14,6 +15,10 @@
 #include "zhdf5reader.h"
 #include "zobject3dscan.h"
 #include "zobject3d.h"
+#include "zintcuboid.h"
+#include "zintpoint.h"
+#include "tz_stack_lib.h"
+#include "bigdata/zchunkedstack.h"
 
 using namespace std;
 
@@ -168,6 +173,7 @@ void ZStackFile::import(const string &filePath)
   case ZFileType::DVID_OBJECT_FILE:
   case ZFileType::JPG_FILE:
   case ZFileType::MC_STACK_RAW_FILE:
+  case ZFileType::CHUNKED_STACK_FILE:
 #ifdef _DEBUG_2
     cout << filePath << endl;
     cout << filePath.find("*") << endl;
@@ -512,6 +518,22 @@ ZStack* ZStackFile::readStack(ZStack *data, bool initColor) const
         if (obj.load(m_urlList[0])) {
           data = obj.toStackObject();
         }
+      } else if (ZFileType::fileType(m_urlList[0].c_str()) ==
+                 ZFileType::CHUNKED_STACK_FILE) {
+        ZSharedPointer<ZChunkedStack> chunkedStack(new ZChunkedStack);
+        if (chunkedStack->open(m_urlList[0])) {
+          if (data == NULL) {
+            data = new ZStack();
+          }
+          data->setChunkedData(chunkedStack);
+#ifdef _NEUTUBE_
+          if (initColor) {
+            data->initChannelColors();
+          }
+#endif
+        } else {
+          failed = true;
+        }
       } else {
         C_Stack::readStackOffset(m_urlList[0].c_str(), offset, offset + 1,
             offset + 2);
@@ -788,6 +810,201 @@ ZStack* ZStackFile::readStack(ZStack *data, bool initColor) const
   return data;
 }
 
+ZStack* ZStackFile::readStack(const ZIntCuboid &box, ZStack *data) const
+{
+  if (m_urlList.empty() || box.isEmpty()) {
+    return NULL;
+  }
+
+  int x = std::max(0, box.getFirstCorner().getX());
+  int y = std::max(0, box.getFirstCorner().getY());
+  int z = std::max(0, box.getFirstCorner().getZ());
+  int width = box.getLastCorner().getX() - x + 1;
+  int height = box.getLastCorner().getY() - y + 1;
+  int depth = box.getLastCorner().getZ() - z + 1;
+
+  Mc_Stack *stack = NULL;
+  int offset[3] = {0, 0, 0};
+
+  switch (m_type) {
+  case SINGLE_FILE:
+    switch (ZFileType::fileType(m_urlList[0])) {
+    case ZFileType::TIFF_FILE:
+    case ZFileType::LSM_FILE:
+    case ZFileType::V3D_RAW_FILE:
+      C_Stack::readStackOffset(m_urlList[0].c_str(), offset, offset + 1,
+          offset + 2);
+      stack = Read_Mc_Stack_Block(m_urlList[0].c_str(), m_channel,
+                                  x, y, z, width, height, depth);
+      break;
+    default:
+    {
+      //No partial reading for the format
+      ZStack *whole = readStack(data, false);
+      if (whole != NULL) {
+        const ZIntPoint &stackOffset = whole->getOffset();
+        ZIntCuboid stackBox(
+              x + stackOffset.getX(), y + stackOffset.getY(),
+              z + stackOffset.getZ(), x + width - 1 + stackOffset.getX(),
+              y + height - 1 + stackOffset.getY(),
+              z + depth - 1 + stackOffset.getZ());
+        stackBox.intersect(whole->getBoundBox());
+        if (stackBox.isEmpty()) {
+          if (whole != data) {
+            delete whole;
+          }
+          whole = NULL;
+        } else {
+          whole->crop(stackBox);
+        }
+      }
+      return whole;
+    }
+    }
+    break;
+  case FILE_BUNDLE:
+  case FILE_LIST:
+  case IMAGE_SERIES:
+  {
+    ZFileList *fileList = toFileList();
+    if (fileList != NULL) {
+      int planeNumber = std::min(fileList->size() - z, depth);
+      if (planeNumber > 0) {
+        int nchannel = ZStack::getChannelNumber(fileList->getFilePath(z));
+        bool failed = false;
+        for (int c = 0; c < nchannel && !failed; ++c) {
+          for (int k = 0; k < planeNumber; ++k) {
+            Mc_Stack *plane = Read_Mc_Stack_Block(
+                  fileList->getFilePath(z + k), c, x, y, 0, width, height, 1);
+            if (plane == NULL) {
+              failed = true;
+              break;
+            }
+            if (stack == NULL) {
+              stack = C_Stack::make(
+                    C_Stack::kind(plane), C_Stack::width(plane),
+                    C_Stack::height(plane), planeNumber, nchannel);
+            }
+            C_Stack::copyPlaneValue(stack, plane->array, c, k);
+            C_Stack::kill(plane);
+          }
+        }
+        if (failed) {
+          C_Stack::kill(stack);
+          stack = NULL;
+        }
+      }
+      delete fileList;
+    }
+  }
+    break;
+  default:
+    break;
+  }
+
+  if (stack == NULL) {
+    cout << "Failed to read stack block: " << endl;
+    this->print();
+    return NULL;
+  }
+
+  if (data == NULL) {
+    data = new ZStack;
+  }
+  data->setData(stack);
+  data->setOffset(offset[0] + x, offset[1] + y, offset[2] + z);
+#ifdef _NEUTUBE_
+  data->initChannelColors();
+  if (m_type == SINGLE_FILE) {
+    data->loadLSMInfo(m_urlList[0].c_str());
+  }
+#endif
+  data->setSource(*this);
+
+  return data;
+}
+
+ZStack* ZStackFile::readStack(const ZIntPoint &dsIntv,
+                              Stack_Downsample_Method_e method) const
+{
+  int xintv = std::max(0, dsIntv.getX());
+  int yintv = std::max(0, dsIntv.getY());
+  int zintv = std::max(0, dsIntv.getZ());
+
+  if (m_urlList.empty()) {
+    return NULL;
+  }
+
+  if (xintv == 0 && yintv == 0 && zintv == 0) {
+    return readStack();
+  }
+
+  if (m_type == SINGLE_FILE) {
+    switch (ZFileType::fileType(m_urlList[0])) {
+    case ZFileType::TIFF_FILE:
+    case ZFileType::LSM_FILE:
+    case ZFileType::V3D_RAW_FILE:
+    {
+      Mc_Stack *stack = Read_Mc_Stack_Downsample(
+            m_urlList[0].c_str(), m_channel, xintv, yintv, zintv, method);
+      if (stack == NULL) {
+        cout << "Failed to read stack: " << endl;
+        this->print();
+        return NULL;
+      }
+
+      int offset[3] = {0, 0, 0};
+      C_Stack::readStackOffset(m_urlList[0].c_str(), offset, offset + 1,
+          offset + 2);
+      ZStack *data = new ZStack;
+      data->setData(stack);
+      data->setOffset(offset[0] / (xintv + 1), offset[1] / (yintv + 1),
+                      offset[2] / (zintv + 1));
+#ifdef _NEUTUBE_
+      data->initChannelColors();
+      data->loadLSMInfo(m_urlList[0].c_str());
+#endif
+      return data;
+    }
+    default:
+      break;
+    }
+  }
+
+  //No downsampling while reading for the format
+  ZStack *data = readStack();
+  if (data == NULL) {
+    return NULL;
+  }
+
+  if (data->isVirtual() || data->data() == NULL) {
+    cout << "The stack cannot be downsampled: " << endl;
+    this->print();
+    delete data;
+    return NULL;
+  }
+
+  int width, height, depth;
+  Downsample_Stack_Max_Size(data->width(), data->height(), data->depth(),
+                            xintv, yintv, zintv, &width, &height, &depth);
+  Mc_Stack *result = C_Stack::make(
+        data->kind(), width, height, depth, data->channelNumber());
+  for (int c = 0; c < data->channelNumber(); ++c) {
+    Stack src;
+    Stack dst;
+    C_Stack::view(data->data(), &src, c);
+    C_Stack::view(result, &dst, c);
+    Downsample_Stack_Slab(&src, xintv, yintv, zintv, method, 0, depth - 1,
+                          &dst);
+  }
+  ZIntPoint offset = data->getOffset();
+  data->setData(result);
+  data->setOffset(offset.getX() / (xintv + 1), offset.getY() / (yintv + 1),
+                  offset.getZ() / (zintv + 1));
+
+  return data;
+}
+
 void ZStackFile::print() const
 {
   if (m_urlList.empty()) {
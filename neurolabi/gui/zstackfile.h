@@ -10,6 +10,8 @@
 
 class ZStack;
 class ZFileList;
+class ZIntCuboid;
+class ZIntPoint;
 
 class ZStackFile
 {
@@ -28,6 +30,34 @@ public:
 
 public:
   ZStack *readStack(ZStack *data = NULL, bool initColor = true) const;
+
+  /*!
+   * \brief Read part of the stack.
+   *
+   * \a box is in the voxel coordinates of the file, i.e. the first voxel is
+   * (0, 0, 0) regardless of the stored offset, and it is clipped by the stack
+   * boundary. Only the planes in \a box are decoded for tif, lsm, raw and
+   * plane-per-file stacks. The offset of the result is the stored offset plus
+   * the first corner of the clipped box.
+   *
+   * \return NULL if \a box is outside of the stack or reading fails.
+   */
+  ZStack *readStack(const ZIntCuboid &box, ZStack *data = NULL) const;
+
+  /*!
+   * \brief Read the stack with downsampling.
+   *
+   * Each channel is downsampled with the intervals of \a dsIntv by \a method,
+   * as Downsample_Stack_Slab() does, and the stored offset is divided by the
+   * downsampling steps as ZStack::downsampleMax() does. A tif, lsm or raw file
+   * is reduced block by block while it is read, so the stack is never held in
+   * memory at full resolution. Other stacks are read entirely first.
+   *
+   * \return NULL if reading fails or the stack cannot be downsampled.
+   */
+  ZStack *readStack(const ZIntPoint &dsIntv,
+                    Stack_Downsample_Method_e method) const;
+
   File_Bundle_S toFileBundleS() const;
   ZFileList *toFileList() const;
   void import(const std::string &filePath);
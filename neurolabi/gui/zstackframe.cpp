@@ -247,6 +247,7 @@ void ZStackFrame::updateDocSignalSlot(FConnectAction connectAction)
     connectAction(m_doc.get(), SIGNAL(zoomingToSelectedSwcNode()), this, SLOT(zoomToSelectedSwcNodes()));
   }
   connectAction(m_doc.get(), SIGNAL(stackLoaded()), this, SIGNAL(stackLoaded()));
+  connectAction(m_doc.get(), SIGNAL(stackModified()), m_view, SLOT(clearSlicePyramid()));
   connectAction(m_doc.get(), SIGNAL(stackModified()), m_view, SLOT(updateChannelControl()));
   connectAction(m_doc.get(), SIGNAL(stackModified()), m_view, SLOT(updateThresholdSlider()));
   connectAction(m_doc.get(), SIGNAL(stackModified()), m_view, SLOT(updateSlider()));
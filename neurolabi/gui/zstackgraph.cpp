@@ -1,6 +1,7 @@
 #include "zstackgraph.h"
 
 #include "zgraph.h"
+#include "zstackpathfinder.h"
 #include "tz_error.h"
 #include "c_stack.h"
 #include "tz_stack_neighborhood.h"
@@ -14,7 +15,7 @@
 #include "tz_stack_threshold.h"
 #include "tz_stack_bwmorph.h"
 
-ZStackGraph::ZStackGraph() : m_zMargin(-1)
+ZStackGraph::ZStackGraph() : m_zMargin(-1), m_pathFinder(NULL)
 {
   Default_Stack_Graph_Workspace(&m_workspace);
 }
@@ -129,6 +130,10 @@ std::vector<int> ZStackGraph::computeShortestPath(
   updateRange(startIndex, endIndex, C_Stack::width(stack),
               C_Stack::height(stack), C_Stack::depth(stack));
 
+  if (m_workspace.sp_option == 0) {
+    return computeLatticeShortestPath(stack, startIndex, endIndex, option);
+  }
+
   ZGraph *graph = NULL;
 
   switch (option) {
@@ -183,6 +188,52 @@ std::vector<int> ZStackGraph::computeShortestPath(
   return cleanedPath;
 }
 
+std::vector<int> ZStackGraph::computeLatticeShortestPath(
+    const Stack *stack, int startIndex, int endIndex, EVertexOption option)
+{
+  ZStackPathFinder localFinder;
+  ZStackPathFinder *finder = m_pathFinder;
+  if (finder == NULL) {
+    finder = &localFinder;
+  }
+
+  Stack *surface = NULL;
+
+  switch (option) {
+  case VO_FOREGROUND:
+    finder->setSignalMask(stack);
+    break;
+  case VO_SURFACE:
+  {
+    //The perimeter of the range is the same as that of the whole stack as
+    //long as the neighbors of the range are included.
+    int x0 = imax2(0, m_workspace.range[0] - 1);
+    int y0 = imax2(0, m_workspace.range[2] - 1);
+    int z0 = imax2(0, m_workspace.range[4] - 1);
+    int x1 = imin2(C_Stack::width(stack) - 1, m_workspace.range[1] + 1);
+    int y1 = imin2(C_Stack::height(stack) - 1, m_workspace.range[3] + 1);
+    int z1 = imin2(C_Stack::depth(stack) - 1, m_workspace.range[5] + 1);
+    Stack *crop = C_Stack::crop(
+          stack, x0, y0, z0, x1 - x0 + 1, y1 - y0 + 1, z1 - z0 + 1, NULL);
+    surface = Stack_Perimeter(crop, NULL, 26);
+    C_Stack::kill(crop);
+    finder->setSignalMask(surface, x0, y0, z0);
+  }
+    break;
+  default:
+    finder->setSignalMask(m_workspace.signal_mask);
+    break;
+  }
+
+  std::vector<int> path =
+      finder->findPath(stack, startIndex, endIndex, &m_workspace);
+
+  finder->setSignalMask(NULL);
+  C_Stack::kill(surface);
+
+  return path;
+}
+
 int ZStackGraph::getGroupId(int voxelIndex)
 {
   int groupId = 0;
@@ -7,6 +7,7 @@
 #include "zintcuboid.h"
 
 class ZGraph;
+class ZStackPathFinder;
 
 /*!
  * \brief The ZStackGraph class provides functions to perform graph processing
@@ -102,10 +103,28 @@ public:
     VO_ALL, VO_FOREGROUND, VO_SURFACE
   };
 
+  /*!
+   * \brief Compute the shortest path between two voxels
+   *
+   * The path is searched on the voxel lattice directly by ZStackPathFinder
+   * unless the shortest path option of the workspace is not 0, in which case
+   * the graph of the range is built explicitly.
+   *
+   * \return The voxel indices from \a startIndex to \a endIndex. It is empty
+   *         if there is no path.
+   */
   std::vector<int> computeShortestPath(const Stack *stack,
                                        int startIndex, int endIndex,
                                        EVertexOption option = VO_ALL);
 
+  /*!
+   * \brief Set the path finder used by computeShortestPath()
+   *
+   * The finder is not owned by the object. Sharing a finder between calls
+   * keeps its buffers. A temporary finder is used if it is NULL.
+   */
+  void setPathFinder(ZStackPathFinder *finder) { m_pathFinder = finder; }
+
   //untested
   void updateRange(size_t startIndex, size_t endIndex,
                    int width, int height, int depth);
@@ -126,10 +145,13 @@ public:
 
 private:
   void initRange(const Stack *stack, int *range);
+  std::vector<int> computeLatticeShortestPath(
+      const Stack *stack, int startIndex, int endIndex, EVertexOption option);
 
 private:
   Stack_Graph_Workspace m_workspace;
   int m_zMargin;
+  ZStackPathFinder *m_pathFinder;
 };
 
 #endif // ZSTACKGRAPH_H
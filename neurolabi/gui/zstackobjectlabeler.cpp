@@ -0,0 +1,108 @@
+#include "zstackobjectlabeler.h"
+#include <algorithm>
+#include <cstdlib>
+#if defined(_QT_GUI_USED_)
+#include <QFuture>
+#include <QThread>
+#include <QtConcurrentRun>
+#endif
+#include "c_stack.h"
+
+ZStackObjectLabeler::ZStackObjectLabeler() : m_conn(26), m_objectNumber(0)
+{
+}
+
+void ZStackObjectLabeler::clear()
+{
+  m_objectNumber = 0;
+  std::vector<int>().swap(m_labelArray);
+  m_statArray.clear();
+}
+
+void ZStackObjectLabeler::labelSlab(
+    const Stack *stack, int flag, int z0, int z1)
+{
+  Stack_Label_Components(stack, flag, m_conn, z0, z1, &(m_labelArray[0]));
+}
+
+int ZStackObjectLabeler::label(const Stack *stack, int flag)
+{
+  clear();
+
+  size_t voxelNumber = C_Stack::voxelNumber(stack);
+  if (voxelNumber == 0) {
+    return 0;
+  }
+
+  m_labelArray.resize(voxelNumber);
+
+  int threadNumber = 1;
+#if defined(_QT_GUI_USED_)
+  threadNumber = std::max(1, QThread::idealThreadCount());
+#endif
+
+  int depth = C_Stack::depth(stack);
+  int slabNumber = std::min(threadNumber, depth);
+  std::vector<int> slabStart(slabNumber + 1);
+  for (int i = 0; i <= slabNumber; ++i) {
+    slabStart[i] = depth * i / slabNumber;
+  }
+
+#if defined(_QT_GUI_USED_)
+  if (slabNumber > 1) {
+    std::vector<QFuture<void> > res(slabNumber);
+    for (int i = 0; i < slabNumber; ++i) {
+      res[i] = QtConcurrent::run(
+            this, &ZStackObjectLabeler::labelSlab, stack, flag,
+            slabStart[i], slabStart[i + 1] - 1);
+    }
+    for (int i = 0; i < slabNumber; ++i) {
+      res[i].waitForFinished();
+    }
+  } else {
+    labelSlab(stack, flag, 0, depth - 1);
+  }
+#else
+  for (int i = 0; i < slabNumber; ++i) {
+    labelSlab(stack, flag, slabStart[i], slabStart[i + 1] - 1);
+  }
+#endif
+
+  for (int i = 1; i < slabNumber; ++i) {
+    Stack_Label_Components_Merge(
+          stack, m_conn, slabStart[i], &(m_labelArray[0]));
+  }
+
+  Objlabel_Stat *stat = NULL;
+  m_objectNumber = Stack_Label_Components_Resolve(
+        stack, &(m_labelArray[0]), &stat);
+  if (stat != NULL) {
+    m_statArray.assign(stat, stat + m_objectNumber);
+    free(stat);
+  }
+
+  return m_objectNumber;
+}
+
+int ZStackObjectLabeler::labelObjects(Stack *stack, int flag, int label)
+{
+  this->label(stack, flag);
+  if (m_objectNumber > 0) {
+    Stack_Label_Objects_L(stack, &(m_labelArray[0]), m_objectNumber, label);
+  }
+
+  return m_objectNumber;
+}
+
+int ZStackObjectLabeler::labelLargeObjects(
+    Stack *stack, int flag, int label, int minSize)
+{
+  this->label(stack, flag);
+  if (m_objectNumber == 0) {
+    return 0;
+  }
+
+  return Stack_Label_Large_Objects_L(
+        stack, &(m_labelArray[0]), &(m_statArray[0]), m_objectNumber,
+        label, minSize, 65535);
+}
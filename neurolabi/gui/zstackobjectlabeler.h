@@ -0,0 +1,93 @@
+#ifndef ZSTACKOBJECTLABELER_H
+#define ZSTACKOBJECTLABELER_H
+
+#include <vector>
+
+#include "tz_stack_objlabel.h"
+
+/*!
+ * \brief The class of labeling connected objects in a stack
+ *
+ * The foreground is labeled slab by slab in parallel with a union-find forest
+ * and the slabs are joined at their seams. The result does not depend on the
+ * number of threads and is the same as the one from Stack_Label_Objects_N().
+ */
+class ZStackObjectLabeler
+{
+public:
+  ZStackObjectLabeler();
+
+  /*!
+   * \brief Set the neighborhood system (4, 8, 6, 18 or 26).
+   */
+  inline void setConnectivity(int conn) {
+    m_conn = conn;
+  }
+
+  inline int getConnectivity() const {
+    return m_conn;
+  }
+
+  /*!
+   * \brief Label the objects formed by the voxels with the value \a flag.
+   *
+   * The stack must be GREY or GREY16. The label field has 32-bit labels, which
+   * are 0 for background and 1, 2, ... for the objects in the order of their
+   * first voxels. The size and bounding box of each object are computed in
+   * the same pass.
+   *
+   * \return The number of objects.
+   */
+  int label(const Stack *stack, int flag);
+
+  /*!
+   * \brief Label objects in place.
+   *
+   * It is a parallel version of Stack_Label_Objects_N().
+   */
+  int labelObjects(Stack *stack, int flag, int label);
+
+  /*!
+   * \brief Label large objects in place.
+   *
+   * It is a parallel version of Stack_Label_Large_Objects_N(): objects with
+   * at least \a minSize voxels are labeled from \a label + 1 and the others
+   * are labeled as \a label.
+   *
+   * \return The number of large objects.
+   */
+  int labelLargeObjects(Stack *stack, int flag, int label, int minSize);
+
+  inline int getObjectNumber() const {
+    return m_objectNumber;
+  }
+
+  /*!
+   * \brief Label field of the last labeling.
+   */
+  inline const std::vector<int>& getLabelArray() const {
+    return m_labelArray;
+  }
+
+  /*!
+   * \brief Object statistics of the last labeling.
+   *
+   * The statistics of the object with label k is at k - 1.
+   */
+  inline const std::vector<Objlabel_Stat>& getStatArray() const {
+    return m_statArray;
+  }
+
+  void clear();
+
+private:
+  void labelSlab(const Stack *stack, int flag, int z0, int z1);
+
+private:
+  int m_conn;
+  int m_objectNumber;
+  std::vector<int> m_labelArray;
+  std::vector<Objlabel_Stat> m_statArray;
+};
+
+#endif // ZSTACKOBJECTLABELER_H
@@ -0,0 +1,593 @@
+#include "zstackpathfinder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "c_stack.h"
+#include "tz_stack_neighborhood.h"
+#include "tz_math.h"
+
+namespace {
+
+const uint8_t CLOSED_FORWARD = 1;
+const uint8_t CLOSED_BACKWARD = 2;
+
+//Keep the heuristic strictly below the true cost under rounding errors
+const double HEURISTIC_SCALE = 1.0 - 1e-9;
+
+}
+
+ZStackPathFinder::ZStackPathFinder() : m_stack(NULL), m_workspace(NULL),
+  m_width(0), m_height(0), m_depth(0), m_conn(26), m_xOffset(NULL),
+  m_yOffset(NULL), m_zOffset(NULL), m_rate(0.0), m_usingEuclidean(true),
+  m_signalMask(NULL), m_bidirectional(true), m_currentStamp(0),
+  m_lastPathLength(0.0), m_lastSettledNumber(0)
+{
+  for (int i = 0; i < 6; ++i) {
+    m_range[i] = 0;
+  }
+  for (int i = 0; i < 3; ++i) {
+    m_maskOffset[i] = 0;
+  }
+}
+
+void ZStackPathFinder::setSignalMask(const Stack *mask, int x0, int y0, int z0)
+{
+  m_signalMask = mask;
+  m_maskOffset[0] = x0;
+  m_maskOffset[1] = y0;
+  m_maskOffset[2] = z0;
+}
+
+void ZStackPathFinder::clearBuffer()
+{
+  std::vector<uint32_t>().swap(m_stamp);
+  m_currentStamp = 0;
+  for (int i = 0; i < 2; ++i) {
+    std::vector<double>().swap(m_distance[i]);
+    std::vector<int>().swap(m_parent[i]);
+    std::vector<HeapItem>().swap(m_heap[i]);
+  }
+  std::vector<uint8_t>().swap(m_closed);
+  std::vector<std::vector<int> >().swap(m_groupMember);
+}
+
+double ZStackPathFinder::computeMinWeightRate(
+    const Stack_Graph_Workspace *sgw) const
+{
+  if (sgw->wf == NULL) {
+    return 1.0;
+  }
+
+  //Weight functions of the form d * f(v1, v2), where f is monotonic in v1
+  //and v2, reach their minimal rate at a corner of the intensity range.
+  if (sgw->wf != Stack_Voxel_Weight && sgw->wf != Stack_Voxel_Weight_I &&
+      sgw->wf != Stack_Voxel_Weight_R && sgw->wf != Stack_Voxel_Weight_S &&
+      sgw->wf != Stack_Voxel_Weight_Sr && sgw->wf != Stack_Voxel_Weight_Srb) {
+    return 0.0;
+  }
+
+  double range[2];
+  switch (C_Stack::kind(m_stack)) {
+  case GREY:
+    range[0] = 0.0;
+    range[1] = 255.0;
+    break;
+  case GREY16:
+    range[0] = 0.0;
+    range[1] = 65535.0;
+    break;
+  default:
+    return 0.0;
+  }
+
+  if (sgw->greyFactor != 1.0 || sgw->greyOffset != 0.0) {
+    for (int i = 0; i < 2; ++i) {
+      range[i] = std::max(0.0, range[i] * sgw->greyFactor + sgw->greyOffset);
+    }
+    if (range[0] > range[1]) {
+      std::swap(range[0], range[1]);
+    }
+  }
+
+  double argv[STACK_GRAPH_WORKSPACE_ARGC];
+  std::copy(m_argv, m_argv + STACK_GRAPH_WORKSPACE_ARGC, argv);
+  argv[0] = 1.0;
+
+  double rate = std::numeric_limits<double>::infinity();
+  for (int i = 0; i < 2; ++i) {
+    for (int j = 0; j < 2; ++j) {
+      argv[1] = range[i];
+      argv[2] = range[j];
+      rate = std::min(rate, sgw->wf(argv));
+    }
+  }
+
+  if (!(rate > 0.0) || tz_isinf(rate)) {
+    return 0.0;
+  }
+
+  return rate * HEURISTIC_SCALE;
+}
+
+void ZStackPathFinder::prepare(
+    const Stack *stack, const Stack_Graph_Workspace *sgw)
+{
+  m_stack = stack;
+  m_workspace = sgw;
+
+  if (sgw->range == NULL) {
+    m_range[0] = 0;
+    m_range[1] = C_Stack::width(stack) - 1;
+    m_range[2] = 0;
+    m_range[3] = C_Stack::height(stack) - 1;
+    m_range[4] = 0;
+    m_range[5] = C_Stack::depth(stack) - 1;
+  } else {
+    m_range[0] = imax2(0, sgw->range[0]);
+    m_range[1] = imin2(C_Stack::width(stack) - 1, sgw->range[1]);
+    m_range[2] = imax2(0, sgw->range[2]);
+    m_range[3] = imin2(C_Stack::height(stack) - 1, sgw->range[3]);
+    m_range[4] = imax2(0, sgw->range[4]);
+    m_range[5] = imin2(C_Stack::depth(stack) - 1, sgw->range[5]);
+  }
+
+  m_width = m_range[1] - m_range[0] + 1;
+  m_height = m_range[3] - m_range[2] + 1;
+  m_depth = m_range[5] - m_range[4] + 1;
+
+  m_conn = sgw->conn;
+  Stack_Neighbor_Offset(m_conn, m_width, m_height, m_neighborOffset);
+  m_xOffset = Stack_Neighbor_X_Offset(m_conn);
+  m_yOffset = Stack_Neighbor_Y_Offset(m_conn);
+  m_zOffset = Stack_Neighbor_Z_Offset(m_conn);
+  Stack_Neighbor_Dist_R(m_conn, sgw->resolution, m_dist);
+  m_usingEuclidean = (sgw->resolution[0] > 0.0 && sgw->resolution[1] > 0.0 &&
+      sgw->resolution[2] > 0.0);
+
+  std::copy(sgw->argv, sgw->argv + STACK_GRAPH_WORKSPACE_ARGC, m_argv);
+
+  if (sgw->group_mask == NULL) {
+    m_rate = computeMinWeightRate(sgw);
+  } else {
+    //Zero-weight jumps within a group make any distance bound invalid
+    m_rate = 0.0;
+  }
+
+  if (m_width <= 0 || m_height <= 0 || m_depth <= 0) {
+    return;
+  }
+
+  size_t volume = (size_t) m_width * m_height * m_depth;
+  if (m_stamp.size() < volume) {
+    m_stamp.resize(volume, 0);
+    m_closed.resize(volume);
+    for (int i = 0; i < 2; ++i) {
+      m_distance[i].resize(volume);
+      m_parent[i].resize(volume);
+    }
+  }
+
+  ++m_currentStamp;
+  if (m_currentStamp == 0) {
+    std::fill(m_stamp.begin(), m_stamp.end(), 0);
+    m_currentStamp = 1;
+  }
+
+  for (int i = 0; i < 2; ++i) {
+    m_heap[i].clear();
+  }
+
+  m_groupMember.clear();
+  m_groupExpanded.clear();
+  if (sgw->group_mask != NULL) {
+    m_groupMember.resize(256);
+    m_groupExpanded.resize(256, false);
+  }
+}
+
+void ZStackPathFinder::touch(int index)
+{
+  if (m_stamp[index] != m_currentStamp) {
+    m_stamp[index] = m_currentStamp;
+    m_distance[FORWARD][index] = std::numeric_limits<double>::infinity();
+    m_distance[BACKWARD][index] = std::numeric_limits<double>::infinity();
+    m_parent[FORWARD][index] = -1;
+    m_parent[BACKWARD][index] = -1;
+    m_closed[index] = 0;
+  }
+}
+
+double ZStackPathFinder::getHeuristic(int index, int target) const
+{
+  if (m_rate == 0.0) {
+    return 0.0;
+  }
+
+  int area = m_width * m_height;
+  int dz = index / area - target / area;
+  int dy = (index % area) / m_width - (target % area) / m_width;
+  int dx = index % m_width - target % m_width;
+
+  double dist = 0.0;
+  if (m_usingEuclidean) {
+    const double *res = m_workspace->resolution;
+    dist = sqrt(dx * dx * res[0] * res[0] + dy * dy * res[1] * res[1] +
+        dz * dz * res[2] * res[2]);
+  } else {
+    //Each step has length 1, so at least the chessboard distance is needed
+    dist = imax3(abs(dx), abs(dy), abs(dz));
+  }
+
+  return m_rate * dist;
+}
+
+double ZStackPathFinder::getIntensity(int index) const
+{
+  int area = m_width * m_height;
+  int x = index % m_width + m_range[0];
+  int y = (index % area) / m_width + m_range[2];
+  int z = index / area + m_range[4];
+
+  double v = C_Stack::value(m_stack, x, y, z);
+  if (m_workspace->greyFactor != 1.0 || m_workspace->greyOffset != 0.0) {
+    v = v * m_workspace->greyFactor + m_workspace->greyOffset;
+    if (v < 0) {
+      v = 0;
+    }
+  }
+
+  return v;
+}
+
+double ZStackPathFinder::getWeight(int index, int neighborIndex, int j) const
+{
+  if (m_workspace->wf == NULL) {
+    return m_dist[j];
+  }
+
+  //Same argument order as Stack_Graph_W(), which scans the smaller index first
+  double argv[STACK_GRAPH_WORKSPACE_ARGC];
+  std::copy(m_argv, m_argv + STACK_GRAPH_WORKSPACE_ARGC, argv);
+  argv[0] = m_dist[j];
+  argv[1] = getIntensity(std::min(index, neighborIndex));
+  argv[2] = getIntensity(std::max(index, neighborIndex));
+
+  return m_workspace->wf(argv);
+}
+
+bool ZStackPathFinder::isInSignal(int x, int y, int z) const
+{
+  if (m_signalMask == NULL) {
+    return true;
+  }
+
+  x += m_range[0] - m_maskOffset[0];
+  y += m_range[2] - m_maskOffset[1];
+  z += m_range[4] - m_maskOffset[2];
+
+  if (x < 0 || y < 0 || z < 0 || x >= C_Stack::width(m_signalMask) ||
+      y >= C_Stack::height(m_signalMask) || z >= C_Stack::depth(m_signalMask)) {
+    return false;
+  }
+
+  return m_signalMask->array[C_Stack::indexFromCoord(
+        x, y, z, C_Stack::width(m_signalMask),
+        C_Stack::height(m_signalMask), C_Stack::depth(m_signalMask))] > 0;
+}
+
+bool ZStackPathFinder::isNeighborInRange(int x, int y, int z, int j) const
+{
+  int nx = x + m_xOffset[j];
+  int ny = y + m_yOffset[j];
+  int nz = z + m_zOffset[j];
+
+  return nx >= 0 && nx < m_width && ny >= 0 && ny < m_height &&
+      nz >= 0 && nz < m_depth;
+}
+
+bool ZStackPathFinder::isConnected(int x, int y, int z, int j) const
+{
+  if (m_signalMask == NULL) {
+    return true;
+  }
+
+  bool inSignal = isInSignal(x, y, z);
+  if (m_workspace->including_signal_border == TRUE) {
+    return inSignal ||
+        isInSignal(x + m_xOffset[j], y + m_yOffset[j], z + m_zOffset[j]);
+  }
+
+  return inSignal &&
+      isInSignal(x + m_xOffset[j], y + m_yOffset[j], z + m_zOffset[j]);
+}
+
+int ZStackPathFinder::getGroupId(int index) const
+{
+  int area = m_width * m_height;
+  int x = index % m_width + m_range[0];
+  int y = (index % area) / m_width + m_range[2];
+  int z = index / area + m_range[4];
+
+  const Stack *mask = m_workspace->group_mask;
+
+  return mask->array[C_Stack::indexFromCoord(
+        x, y, z, C_Stack::width(mask), C_Stack::height(mask),
+        C_Stack::depth(mask))];
+}
+
+void ZStackPathFinder::relaxGroup(
+    int index, std::vector<HeapItem> *heap, int end)
+{
+  int groupId = getGroupId(index);
+  if (groupId == 0 || m_groupExpanded[groupId]) {
+    return;
+  }
+
+  m_groupExpanded[groupId] = true;
+
+  std::vector<int> &member = m_groupMember[groupId];
+  if (member.empty()) {
+    int volume = m_width * m_height * m_depth;
+    for (int i = 0; i < volume; ++i) {
+      if (getGroupId(i) == groupId) {
+        member.push_back(i);
+      }
+    }
+  }
+
+  double distance = m_distance[FORWARD][index];
+  for (std::vector<int>::const_iterator iter = member.begin();
+       iter != member.end(); ++iter) {
+    int neighborIndex = *iter;
+    touch(neighborIndex);
+    if ((m_closed[neighborIndex] & CLOSED_FORWARD) == 0 &&
+        distance < m_distance[FORWARD][neighborIndex]) {
+      m_distance[FORWARD][neighborIndex] = distance;
+      m_parent[FORWARD][neighborIndex] = index;
+      heap->push_back(
+            HeapItem(distance + getHeuristic(neighborIndex, end),
+                     neighborIndex));
+      std::push_heap(heap->begin(), heap->end());
+    }
+  }
+}
+
+bool ZStackPathFinder::searchUnidirectional(int start, int end)
+{
+  std::vector<HeapItem> &heap = m_heap[FORWARD];
+  std::vector<double> &distance = m_distance[FORWARD];
+  std::vector<int> &parent = m_parent[FORWARD];
+
+  touch(start);
+  distance[start] = 0.0;
+  heap.push_back(HeapItem(getHeuristic(start, end), start));
+
+  int area = m_width * m_height;
+  while (!heap.empty()) {
+    std::pop_heap(heap.begin(), heap.end());
+    int index = heap.back().index;
+    heap.pop_back();
+
+    if (m_closed[index] & CLOSED_FORWARD) {
+      continue;
+    }
+    m_closed[index] |= CLOSED_FORWARD;
+    ++m_lastSettledNumber;
+
+    if (index == end) {
+      m_lastPathLength = distance[end];
+      return true;
+    }
+
+    if (m_workspace->group_mask != NULL) {
+      relaxGroup(index, &heap, end);
+    }
+
+    int x = index % m_width;
+    int y = (index % area) / m_width;
+    int z = index / area;
+    for (int j = 0; j < m_conn; ++j) {
+      if (isNeighborInRange(x, y, z, j) && isConnected(x, y, z, j)) {
+        int neighborIndex = index + m_neighborOffset[j];
+        touch(neighborIndex);
+        if ((m_closed[neighborIndex] & CLOSED_FORWARD) == 0) {
+          double newDistance =
+              distance[index] + getWeight(index, neighborIndex, j);
+          if (newDistance < distance[neighborIndex]) {
+            distance[neighborIndex] = newDistance;
+            parent[neighborIndex] = index;
+            heap.push_back(
+                  HeapItem(newDistance + getHeuristic(neighborIndex, end),
+                           neighborIndex));
+            std::push_heap(heap.begin(), heap.end());
+          }
+        }
+      }
+    }
+  }
+
+  return false;
+}
+
+/*
+ * Both searches use the average potential p(v) = (h_f(v) - h_b(v)) / 2, which
+ * is consistent for both directions. The forward key is g_f(v) + p(v) and the
+ * backward key is g_b(v) - p(v), so the search can stop once the sum of the
+ * two minimal keys reaches the best path found.
+ */
+bool ZStackPathFinder::searchBidirectional(int start, int end, int *meeting)
+{
+  touch(start);
+  touch(end);
+  m_distance[FORWARD][start] = 0.0;
+  m_distance[BACKWARD][end] = 0.0;
+
+  double potential = (getHeuristic(start, end) - getHeuristic(start, start)) /
+      2.0;
+  m_heap[FORWARD].push_back(HeapItem(potential, start));
+  potential = (getHeuristic(end, end) - getHeuristic(end, start)) / 2.0;
+  m_heap[BACKWARD].push_back(HeapItem(-potential, end));
+
+  double bestLength = std::numeric_limits<double>::infinity();
+  meeting[FORWARD] = -1;
+  meeting[BACKWARD] = -1;
+
+  const uint8_t closedFlag[2] = { CLOSED_FORWARD, CLOSED_BACKWARD };
+  int area = m_width * m_height;
+
+  while (!m_heap[FORWARD].empty() && !m_heap[BACKWARD].empty()) {
+    if (m_heap[FORWARD].front().key + m_heap[BACKWARD].front().key >=
+        bestLength) {
+      break;
+    }
+
+    int direction = FORWARD;
+    if (m_heap[BACKWARD].size() < m_heap[FORWARD].size()) {
+      direction = BACKWARD;
+    }
+    int opposite = 1 - direction;
+
+    std::vector<HeapItem> &heap = m_heap[direction];
+    std::vector<double> &distance = m_distance[direction];
+    std::vector<int> &parent = m_parent[direction];
+    double sign = (direction == FORWARD) ? 1.0 : -1.0;
+
+    std::pop_heap(heap.begin(), heap.end());
+    int index = heap.back().index;
+    heap.pop_back();
+
+    if (m_closed[index] & closedFlag[direction]) {
+      continue;
+    }
+    m_closed[index] |= closedFlag[direction];
+    ++m_lastSettledNumber;
+
+    int x = index % m_width;
+    int y = (index % area) / m_width;
+    int z = index / area;
+    for (int j = 0; j < m_conn; ++j) {
+      if (isNeighborInRange(x, y, z, j) && isConnected(x, y, z, j)) {
+        int neighborIndex = index + m_neighborOffset[j];
+        touch(neighborIndex);
+        double newDistance =
+            distance[index] + getWeight(index, neighborIndex, j);
+        if ((m_closed[neighborIndex] & closedFlag[direction]) == 0 &&
+            newDistance < distance[neighborIndex]) {
+          distance[neighborIndex] = newDistance;
+          parent[neighborIndex] = index;
+          double potential = (getHeuristic(neighborIndex, end) -
+                              getHeuristic(neighborIndex, start)) / 2.0;
+          heap.push_back(
+                HeapItem(newDistance + sign * potential, neighborIndex));
+          std::push_heap(heap.begin(), heap.end());
+        }
+
+        double length = newDistance + m_distance[opposite][neighborIndex];
+        if (length < bestLength) {
+          bestLength = length;
+          if (direction == FORWARD) {
+            meeting[FORWARD] = index;
+            meeting[BACKWARD] = neighborIndex;
+          } else {
+            meeting[FORWARD] = neighborIndex;
+            meeting[BACKWARD] = index;
+          }
+        }
+      }
+    }
+  }
+
+  if (meeting[FORWARD] >= 0) {
+    m_lastPathLength = bestLength;
+    return true;
+  }
+
+  return false;
+}
+
+std::vector<int> ZStackPathFinder::tracePath(
+    int forwardEnd, int backwardStart) const
+{
+  std::vector<int> path;
+
+  for (int v = forwardEnd; v >= 0; v = m_parent[FORWARD][v]) {
+    path.push_back(v);
+  }
+  std::reverse(path.begin(), path.end());
+
+  for (int v = backwardStart; v >= 0; v = m_parent[BACKWARD][v]) {
+    path.push_back(v);
+  }
+
+  return path;
+}
+
+std::vector<int> ZStackPathFinder::findPath(
+    const Stack *stack, int startIndex, int endIndex,
+    const Stack_Graph_Workspace *sgw)
+{
+  std::vector<int> path;
+
+  m_lastPathLength = 0.0;
+  m_lastSettledNumber = 0;
+
+  if (stack == NULL || sgw == NULL) {
+    return path;
+  }
+
+  prepare(stack, sgw);
+
+  int width = C_Stack::width(stack);
+  int height = C_Stack::height(stack);
+  int depth = C_Stack::depth(stack);
+
+  int x1, y1, z1, x2, y2, z2;
+  C_Stack::indexToCoord(startIndex, width, height, &x1, &y1, &z1);
+  C_Stack::indexToCoord(endIndex, width, height, &x2, &y2, &z2);
+
+  x1 -= m_range[0];
+  y1 -= m_range[2];
+  z1 -= m_range[4];
+  x2 -= m_range[0];
+  y2 -= m_range[2];
+  z2 -= m_range[4];
+
+  if (x1 < 0 || y1 < 0 || z1 < 0 || x1 >= m_width || y1 >= m_height ||
+      z1 >= m_depth || x2 < 0 || y2 < 0 || z2 < 0 || x2 >= m_width ||
+      y2 >= m_height || z2 >= m_depth) {
+    return path;
+  }
+
+  int start = C_Stack::indexFromCoord(x1, y1, z1, m_width, m_height, m_depth);
+  int end = C_Stack::indexFromCoord(x2, y2, z2, m_width, m_height, m_depth);
+
+  if (start == end) {
+    path.push_back(startIndex);
+    return path;
+  }
+
+  std::vector<int> localPath;
+  if (m_bidirectional && sgw->group_mask == NULL) {
+    int meeting[2];
+    if (searchBidirectional(start, end, meeting)) {
+      localPath = tracePath(meeting[FORWARD], meeting[BACKWARD]);
+    }
+  } else {
+    if (searchUnidirectional(start, end)) {
+      localPath = tracePath(end, -1);
+    }
+  }
+
+  path.resize(localPath.size());
+  int area = m_width * m_height;
+  for (size_t i = 0; i < localPath.size(); ++i) {
+    int index = localPath[i];
+    path[i] = C_Stack::indexFromCoord(
+          index % m_width + m_range[0], (index % area) / m_width + m_range[2],
+          index / area + m_range[4], width, height, depth);
+  }
+
+  return path;
+}
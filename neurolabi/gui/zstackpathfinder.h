@@ -0,0 +1,152 @@
+#ifndef ZSTACKPATHFINDER_H
+#define ZSTACKPATHFINDER_H
+
+#include <vector>
+#include <stdint.h>
+
+#include "tz_image_lib_defs.h"
+#include "tz_stack_graph.h"
+
+/*!
+ * \brief The class of finding the shortest path on the voxel lattice of a
+ *        stack.
+ *
+ * The path finder searches the same graph as Stack_Graph_W() builds from a
+ * Stack_Graph_Workspace, including the range, the connectivity, the weight
+ * function, the signal mask and the group mask, but it generates the edges on
+ * the fly instead of storing them. The search is A* with a heuristic of the
+ * minimal weight per unit length times the distance to the target, which is
+ * admissible for the weight functions in tz_stack_graph.h that are monotonic
+ * in the intensities; it falls back to Dijkstra for any other weight function
+ * or when a group mask is set. The buffers are kept between calls, so an
+ * object can be reused for interactive tracing without reallocation.
+ */
+class ZStackPathFinder
+{
+public:
+  ZStackPathFinder();
+
+public:
+  /*!
+   * \brief Find the shortest path between two voxels.
+   *
+   * \param stack Signal stack.
+   * \param startIndex Index of the start voxel in \a stack.
+   * \param endIndex Index of the end voxel in \a stack.
+   * \param sgw Graph parameters. Its signal mask is ignored and the one set
+   *        by setSignalMask() is used instead.
+   * \return The voxel indices (in \a stack) from \a startIndex to \a endIndex.
+   *         It is empty if there is no path or either end is out of the
+   *         range.
+   */
+  std::vector<int> findPath(const Stack *stack, int startIndex, int endIndex,
+                            const Stack_Graph_Workspace *sgw);
+
+  /*!
+   * \brief Set the signal mask.
+   *
+   * The first voxel of \a mask is at (\a x0, \a y0, \a z0) of the signal
+   * stack. Voxels out of the mask are treated as background. The mask is not
+   * copied, so it must be valid during findPath(). NULL means no mask.
+   */
+  void setSignalMask(const Stack *mask, int x0 = 0, int y0 = 0, int z0 = 0);
+
+  /*!
+   * \brief Search from both ends at the same time.
+   *
+   * It is ignored when a group mask is used.
+   */
+  inline void setBidirectional(bool on) {
+    m_bidirectional = on;
+  }
+
+  inline bool isBidirectional() const {
+    return m_bidirectional;
+  }
+
+  /*!
+   * \brief Total weight of the last path found.
+   */
+  inline double getLastPathLength() const {
+    return m_lastPathLength;
+  }
+
+  /*!
+   * \brief Number of voxels settled by the last search.
+   */
+  inline size_t getLastSettledNumber() const {
+    return m_lastSettledNumber;
+  }
+
+  /*!
+   * \brief Free the buffers.
+   */
+  void clearBuffer();
+
+private:
+  struct HeapItem {
+    HeapItem(double key, int index) : key(key), index(index) {}
+    bool operator< (const HeapItem &item) const {
+      return key > item.key;
+    }
+    double key;
+    int index;
+  };
+
+  enum EDirection {
+    FORWARD = 0, BACKWARD = 1
+  };
+
+  void prepare(const Stack *stack, const Stack_Graph_Workspace *sgw);
+  void touch(int index);
+  double getHeuristic(int index, int target) const;
+  double getIntensity(int index) const;
+  double getWeight(int index, int neighborIndex, int j) const;
+  bool isInSignal(int x, int y, int z) const;
+  bool isConnected(int x, int y, int z, int j) const;
+  bool isNeighborInRange(int x, int y, int z, int j) const;
+  int getGroupId(int index) const;
+  double computeMinWeightRate(const Stack_Graph_Workspace *sgw) const;
+
+  bool searchUnidirectional(int start, int end);
+  bool searchBidirectional(int start, int end, int meeting[2]);
+  void relaxGroup(int index, std::vector<HeapItem> *heap, int end);
+  std::vector<int> tracePath(int forwardEnd, int backwardStart) const;
+
+private:
+  //Parameters of the current search
+  const Stack *m_stack;
+  const Stack_Graph_Workspace *m_workspace;
+  int m_range[6];
+  int m_width;
+  int m_height;
+  int m_depth;
+  int m_conn;
+  int m_neighborOffset[26];
+  const int *m_xOffset;
+  const int *m_yOffset;
+  const int *m_zOffset;
+  double m_dist[26];
+  double m_argv[STACK_GRAPH_WORKSPACE_ARGC];
+  double m_rate;
+  bool m_usingEuclidean;
+
+  const Stack *m_signalMask;
+  int m_maskOffset[3];
+  bool m_bidirectional;
+
+  //Buffers kept between calls
+  std::vector<uint32_t> m_stamp;
+  uint32_t m_currentStamp;
+  std::vector<double> m_distance[2];
+  std::vector<int> m_parent[2];
+  std::vector<uint8_t> m_closed;
+  std::vector<HeapItem> m_heap[2];
+  std::vector<std::vector<int> > m_groupMember;
+  std::vector<bool> m_groupExpanded;
+
+  double m_lastPathLength;
+  size_t m_lastSettledNumber;
+};
+
+#endif // ZSTACKPATHFINDER_H
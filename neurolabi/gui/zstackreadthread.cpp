@@ -1,12 +1,25 @@
 #include "zstackreadthread.h"
 
 #include <iostream>
+#include <algorithm>
+#include <cstring>
 
 #include "zstack.hxx"
 #include "zstackfile.h"
+#include "zfiletype.h"
+#include "zintcuboid.h"
+#include "c_stack.h"
+#include "tz_image_io.h"
+
+namespace {
+
+//Approximate number of bytes read in each batch of progressive reading
+const size_t PROGRESSIVE_BATCH_BYTES = (size_t) 64 * 1024 * 1024;
+
+}
 
 ZStackReadThread::ZStackReadThread(QObject *parent) :
-  QThread(parent), m_stackFile(NULL), m_stack(NULL)
+  QThread(parent), m_stackFile(NULL), m_stack(NULL), m_progressive(false)
 {
 }
 
@@ -14,12 +27,184 @@ void ZStackReadThread::clear()
 {
   m_stackFile = NULL;
   m_stack = NULL;
+  clearLoadedBatch();
+}
+
+void ZStackReadThread::cancel()
+{
+  m_canceled.storeRelease(1);
+}
+
+bool ZStackReadThread::isCanceled() const
+{
+  return m_canceled.loadAcquire() != 0;
+}
+
+void ZStackReadThread::addLoadedBatch(int startPlane, ZStack *batch)
+{
+  QMutexLocker locker(&m_batchMutex);
+  m_loadedBatch.append(qMakePair(startPlane, batch));
+}
+
+void ZStackReadThread::clearLoadedBatch()
+{
+  QMutexLocker locker(&m_batchMutex);
+  for (int i = 0; i < m_loadedBatch.size(); ++i) {
+    delete m_loadedBatch[i].second;
+  }
+  m_loadedBatch.clear();
+}
+
+void ZStackReadThread::flushLoadedPlanes()
+{
+  QList<QPair<int, ZStack*> > batchList;
+  m_batchMutex.lock();
+  batchList.swap(m_loadedBatch);
+  m_batchMutex.unlock();
+
+  for (int i = 0; i < batchList.size(); ++i) {
+    int z = batchList[i].first;
+    ZStack *batch = batchList[i].second;
+    if (m_stack != NULL) {
+      int planeNumber = std::min(batch->depth(), m_stack->depth() - z);
+      size_t planeByteNumber = m_stack->getByteNumber(ZStack::SINGLE_PLANE);
+      for (int c = 0; c < m_stack->channelNumber(); ++c) {
+        memcpy(m_stack->getDataPointer(c, z), batch->getDataPointer(c, 0),
+               planeByteNumber * planeNumber);
+      }
+    }
+    delete batch;
+  }
+}
+
+/*
+ * A single tif, lsm or raw file is read through one Mc_Stack_Plane_Reader,
+ * which stays at the last plane read, so each batch continues from there
+ * instead of walking the IFD chain from the start. The planes are decoded on
+ * this thread only: the genelib TIFF reader keeps global free lists
+ * (Reset_Tiff_Image/Reset_Tiff_IFD), so IFDs cannot be decoded concurrently.
+ * The file is not memory mapped either, since each plane is read once.
+ */
+bool ZStackReadThread::readProgressively()
+{
+  Mc_Stack_Plane_Reader *reader = NULL;
+  int offset[3] = {0, 0, 0};
+
+  switch (m_stackFile->type()) {
+  case ZStackFile::SINGLE_FILE:
+    switch (ZFileType::fileType(m_stackFile->firstUrl())) {
+    case ZFileType::TIFF_FILE:
+    case ZFileType::LSM_FILE:
+    case ZFileType::V3D_RAW_FILE:
+      reader = Open_Mc_Stack_Plane_Reader(m_stackFile->firstUrl().c_str(),
+                                          m_stackFile->channel());
+      if (reader == NULL) {
+        return false;
+      }
+      C_Stack::readStackOffset(m_stackFile->firstUrl(), offset, offset + 1,
+                               offset + 2);
+      break;
+    default:
+      return false;
+    }
+    break;
+  case ZStackFile::FILE_BUNDLE:
+  case ZStackFile::FILE_LIST:
+  case ZStackFile::IMAGE_SERIES:
+    break;
+  default:
+    return false;
+  }
+
+  int kind = 0;
+  int width = 0;
+  int height = 0;
+  int depth = 0;
+  if (reader != NULL) {
+    int nchannel = 0;
+    Mc_Stack_Plane_Reader_Attribute(
+          reader, &kind, &width, &height, &depth, &nchannel);
+  } else {
+    m_stackFile->retrieveAttribute(&kind, &width, &height, &depth);
+  }
+  if (kind <= 0 || width <= 0 || height <= 0 || depth <= 1) {
+    Kill_Mc_Stack_Plane_Reader(reader);
+    return false;
+  }
+
+  int batchDepth = std::max(
+        1, (int) (PROGRESSIVE_BATCH_BYTES / ((size_t) kind * width * height)));
+
+  for (int z = 0; z < depth && !isCanceled(); z += batchDepth) {
+    ZStack *batch = NULL;
+    if (reader != NULL) {
+      Mc_Stack *planes = Read_Mc_Stack_Next_Planes(reader, batchDepth);
+      if (planes != NULL) {
+        batch = new ZStack;
+        batch->setData(planes);
+        batch->setOffset(offset[0], offset[1], offset[2] + z);
+      }
+    } else {
+      ZIntCuboid box(0, 0, z, width - 1, height - 1, z + batchDepth - 1);
+      batch = m_stackFile->readStack(box);
+    }
+
+    if (batch == NULL) {
+      break;
+    }
+
+    if (m_stack == NULL) {
+      ZStack *stack = new ZStack(batch->kind(), batch->width(),
+                                 batch->height(), depth,
+                                 batch->channelNumber());
+      stack->setOffset(batch->getOffset());
+      stack->setSource(*m_stackFile);
+#ifdef _NEUTUBE_
+      stack->initChannelColors();
+      if (m_stackFile->type() == ZStackFile::SINGLE_FILE) {
+        stack->loadLSMInfo(m_stackFile->firstUrl().c_str());
+      }
+#endif
+      m_stack = stack;
+    } else if (batch->kind() != m_stack->kind() ||
+               batch->width() != m_stack->width() ||
+               batch->height() != m_stack->height() ||
+               batch->channelNumber() != m_stack->channelNumber()) {
+      std::cout << "Inconsistent planes from " << m_stackFile->firstUrl()
+                << std::endl;
+      delete batch;
+      break;
+    }
+
+    int endPlane = std::min(z + batch->depth(), depth) - 1;
+    if (z == 0) {
+      //Nobody else sees the stack until stackAllocated() is emitted
+      addLoadedBatch(z, batch);
+      flushLoadedPlanes();
+      emit stackAllocated();
+    } else {
+      addLoadedBatch(z, batch);
+    }
+    emit planeLoaded(z, endPlane);
+  }
+
+  Kill_Mc_Stack_Plane_Reader(reader);
+
+  return m_stack != NULL;
 }
 
 void ZStackReadThread::run()
 {
+  m_stack = NULL;
+  clearLoadedBatch();
+  m_canceled.storeRelease(0);
+
   if (m_stackFile != NULL) {
-    m_stack = m_stackFile->readStack();
+    if (!(m_progressive && readProgressively())) {
+      if (!isCanceled()) {
+        m_stack = m_stackFile->readStack();
+      }
+    }
 
 #ifdef _DEBUG_
     std::cout << "Stack read done" << std::endl;
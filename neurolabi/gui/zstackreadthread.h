@@ -2,6 +2,10 @@
 #define ZSTACKREADTHREAD_H
 
 #include <QThread>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QList>
+#include <QPair>
 
 class ZStackFile;
 class ZStack;
@@ -23,15 +27,60 @@ public:
     m_stackFile = stackFile;
   }
 
+  /*!
+   * \brief Turn on or off progressive reading.
+   *
+   * A progressive reading loads the stack in batches of planes. The whole
+   * stack is allocated after the first batch is read and it can be obtained by
+   * getStack() once stackAllocated() is emitted. The thread does not touch
+   * the stack after that. Each later batch is kept aside and planeLoaded() is
+   * emitted, and flushLoadedPlanes() copies the batches into the stack from
+   * the thread that uses it. Files that cannot be read plane by plane are read
+   * as a whole.
+   */
+  inline void setProgressive(bool progressive) {
+    m_progressive = progressive;
+  }
+
+  /*!
+   * \brief Stop reading as soon as possible.
+   *
+   * Reading stops after the current batch in the progressive mode.
+   */
+  void cancel();
+  bool isCanceled() const;
+
+  /*!
+   * \brief Copy the batches read so far into the stack.
+   *
+   * It must be called from the thread that uses the stack returned by
+   * getStack(), usually in the slot connected to planeLoaded(). The planes of
+   * the stack are blank until they are copied.
+   */
+  void flushLoadedPlanes();
+
   void clear();
 
 signals:
+  void stackAllocated();
+  void planeLoaded(int startPlane, int endPlane);
 
 public slots:
 
+private:
+  bool readProgressively();
+  void addLoadedBatch(int startPlane, ZStack *batch);
+  void clearLoadedBatch();
+
 private:
   ZStackFile *m_stackFile;
   ZStack *m_stack;
+  bool m_progressive;
+  QAtomicInt m_canceled;
+
+  //Batches waiting to be copied into m_stack, along with their first planes
+  QList<QPair<int, ZStack*> > m_loadedBatch;
+  QMutex m_batchMutex;
 };
 
 #endif // ZSTACKREADTHREAD_H
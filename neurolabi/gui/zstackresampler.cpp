@@ -0,0 +1,147 @@
+#include "zstackresampler.h"
+#include <algorithm>
+#include <vector>
+#if defined(_QT_GUI_USED_)
+#include <QFuture>
+#include <QThread>
+#include <QtConcurrentRun>
+#endif
+#include "c_stack.h"
+#include "tz_stack_lib.h"
+
+// Stacks smaller than this are resampled in the calling thread
+const size_t RESAMPLE_MULTI_THREAD_THRESHOLD = 1024 * 1024;
+
+ZStackResampler::ZStackResampler() : m_method(STACK_DOWNSAMPLE_MAX)
+{
+  m_intv[0] = 0;
+  m_intv[1] = 0;
+  m_intv[2] = 0;
+}
+
+int ZStackResampler::getSlabNumber(int depth, size_t voxelNumber)
+{
+  int slabNumber = 1;
+#if defined(_QT_GUI_USED_)
+  if (voxelNumber >= RESAMPLE_MULTI_THREAD_THRESHOLD) {
+    slabNumber = std::max(1, QThread::idealThreadCount());
+  }
+#else
+  UNUSED_PARAMETER(voxelNumber);
+#endif
+
+  return std::max(1, std::min(slabNumber, depth));
+}
+
+void ZStackResampler::downsampleSlab(
+    const Stack *stack, int k0, int k1, Stack *out)
+{
+  Downsample_Stack_Slab(stack, m_intv[0], m_intv[1], m_intv[2], m_method,
+                        k0, k1, out);
+}
+
+void ZStackResampler::upsampleSlab(
+    const Stack *stack, int k0, int k1, Stack *out, bool depthPass)
+{
+  if (depthPass) {
+    Upsample_Stack_Depth(stack, m_intv[0], m_intv[1], m_intv[2], k0, k1, out);
+  } else {
+    Upsample_Stack_Plane(stack, m_intv[0], m_intv[1], m_intv[2], k0, k1, out);
+  }
+}
+
+Stack* ZStackResampler::downsample(
+    const Stack *stack, int xintv, int yintv, int zintv,
+    Stack_Downsample_Method_e method, Stack *out)
+{
+  m_intv[0] = xintv;
+  m_intv[1] = yintv;
+  m_intv[2] = zintv;
+  m_method = method;
+
+  int width = 0;
+  int height = 0;
+  int depth = 0;
+  Downsample_Stack_Max_Size(
+        C_Stack::width(stack), C_Stack::height(stack), C_Stack::depth(stack),
+        xintv, yintv, zintv, &width, &height, &depth);
+
+  if (out == NULL) {
+    out = C_Stack::make(C_Stack::kind(stack), width, height, depth);
+  }
+
+#if defined(_QT_GUI_USED_)
+  //Downsampling in place is done in one slab
+  int slabNumber = 1;
+  if (out != stack) {
+    slabNumber = getSlabNumber(depth, C_Stack::voxelNumber(stack));
+  }
+
+  if (slabNumber > 1) {
+    std::vector<QFuture<void> > res(slabNumber);
+    for (int i = 0; i < slabNumber; ++i) {
+      res[i] = QtConcurrent::run(
+            this, &ZStackResampler::downsampleSlab, stack,
+            depth * i / slabNumber, depth * (i + 1) / slabNumber - 1, out);
+    }
+    for (int i = 0; i < slabNumber; ++i) {
+      res[i].waitForFinished();
+    }
+  } else {
+    downsampleSlab(stack, 0, depth - 1, out);
+  }
+#else
+  downsampleSlab(stack, 0, depth - 1, out);
+#endif
+
+  out->kind = C_Stack::kind(stack);
+  out->width = width;
+  out->height = height;
+  out->depth = depth;
+
+  return out;
+}
+
+Stack* ZStackResampler::upsample(
+    const Stack *stack, int xintv, int yintv, int zintv, Stack *out)
+{
+  m_intv[0] = xintv;
+  m_intv[1] = yintv;
+  m_intv[2] = zintv;
+
+  if (out == NULL) {
+    out = C_Stack::make(C_Stack::kind(stack),
+                        C_Stack::width(stack) * (xintv + 1),
+                        C_Stack::height(stack) * (yintv + 1),
+                        C_Stack::depth(stack) * (zintv + 1));
+  }
+
+  int depth = C_Stack::depth(stack);
+
+#if defined(_QT_GUI_USED_)
+  int slabNumber = getSlabNumber(depth, C_Stack::voxelNumber(out));
+  if (slabNumber > 1) {
+    std::vector<QFuture<void> > res(slabNumber);
+    //The depth pass reads the planes of the next slab
+    for (int pass = 0; pass < 2; ++pass) {
+      for (int i = 0; i < slabNumber; ++i) {
+        res[i] = QtConcurrent::run(
+              this, &ZStackResampler::upsampleSlab, stack,
+              depth * i / slabNumber, depth * (i + 1) / slabNumber - 1, out,
+              pass == 1);
+      }
+      for (int i = 0; i < slabNumber; ++i) {
+        res[i].waitForFinished();
+      }
+    }
+  } else {
+    upsampleSlab(stack, 0, depth - 1, out, false);
+    upsampleSlab(stack, 0, depth - 1, out, true);
+  }
+#else
+  upsampleSlab(stack, 0, depth - 1, out, false);
+  upsampleSlab(stack, 0, depth - 1, out, true);
+#endif
+
+  return out;
+}
@@ -0,0 +1,53 @@
+#ifndef ZSTACKRESAMPLER_H
+#define ZSTACKRESAMPLER_H
+
+#include "tz_image_lib_defs.h"
+
+/*!
+ * \brief The class of resampling a stack in parallel
+ *
+ * The output slices are split into slabs, which are computed by
+ * Downsample_Stack_Slab(), Upsample_Stack_Plane() and Upsample_Stack_Depth()
+ * in parallel. The result is the same as the one from the serial routines in
+ * tz_stack_lib.h.
+ */
+class ZStackResampler
+{
+public:
+  ZStackResampler();
+
+  /*!
+   * \brief Downsample a stack.
+   *
+   * Each block of (\a xintv + 1) x (\a yintv + 1) x (\a zintv + 1) voxels is
+   * reduced to one voxel by \a method. The result is stored in \a out if it is
+   * not NULL, otherwise a new stack is returned. \a out can be \a stack, in
+   * which case the stack is downsampled in the calling thread.
+   */
+  Stack* downsample(const Stack *stack, int xintv, int yintv, int zintv,
+                    Stack_Downsample_Method_e method, Stack *out = NULL);
+
+  /*!
+   * \brief Upsample a stack with linear interpolation.
+   *
+   * It is a parallel version of Upsample_Stack().
+   */
+  Stack* upsample(const Stack *stack, int xintv, int yintv, int zintv,
+                  Stack *out = NULL);
+
+private:
+  void downsampleSlab(const Stack *stack, int k0, int k1, Stack *out);
+  void upsampleSlab(const Stack *stack, int k0, int k1, Stack *out,
+                    bool depthPass);
+
+  /*!
+   * \brief Number of slabs for \a depth slices of \a voxelNumber voxels.
+   */
+  static int getSlabNumber(int depth, size_t voxelNumber);
+
+private:
+  int m_intv[3];
+  Stack_Downsample_Method_e m_method;
+};
+
+#endif // ZSTACKRESAMPLER_H
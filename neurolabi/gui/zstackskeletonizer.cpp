@@ -21,6 +21,8 @@
 #include "tz_math.h"
 #include "swc/zswcresampler.h"
 #include "tz_stack_threshold.h"
+#include "zstackobjectlabeler.h"
+#include "zstackresampler.h"
 
 using namespace std;
 
@@ -48,6 +50,19 @@ ZSwcTree* ZStackSkeletonizer::makeSkeleton(const ZStack &stack)
   return tree;
 }
 
+ZSwcTree* ZStackSkeletonizer::makeSkeletonFromDownsampled(const ZStack &stack)
+{
+  ZSwcTree *tree = makeSkeletonWithoutDs(C_Stack::clone(stack.c_stack()));
+  if (tree != NULL) {
+    const ZIntPoint &pt = stack.getOffset();
+    tree->translate(pt.getX() * (m_downsampleInterval[0] + 1),
+                    pt.getY() * (m_downsampleInterval[1] + 1),
+                    pt.getZ() * (m_downsampleInterval[2] + 1));
+  }
+
+  return tree;
+}
+
 ZSwcTree* ZStackSkeletonizer::makeSkeleton(
     const std::vector<ZStack*> &stackArray)
 {
@@ -172,8 +187,10 @@ ZSwcTree* ZStackSkeletonizer::makeSkeletonWithoutDsTest(Stack *stackData)
   cout << "Label objects ...\n" << endl;
   int minObjSize = m_minObjSize;
   minObjSize /= dsVol;
-  int nobj = Stack_Label_Large_Objects_N(
-        stackData, NULL, 1, 2, minObjSize, 26);
+  ZStackObjectLabeler labeler;
+  labeler.setConnectivity(26);
+  int nobj = labeler.labelLargeObjects(stackData, 1, 2, minObjSize);
+  labeler.clear();
   //int nobj = Stack_Label_Objects_N(stackData, NULL, 1, 2, 26);
   if (nobj == 0) {
     cout << "No object found in the image. No skeleton generated." << endl;
@@ -534,18 +551,10 @@ ZSwcTree* ZStackSkeletonizer::makeSkeletonWithoutDs(Stack *stackData)
   int minObjSize = m_minObjSize;
   minObjSize /= dsVol;
 
-  Objlabel_Workspace ow;
-  Default_Objlabel_Workspace(&ow);
-  ow.conn = 26;
-  ow.chord = NULL;
-  ow.init_chord = TRUE;
-  ow.inc_label = TRUE;
-
-  int nobj = Stack_Label_Large_Objects_W(stackData, 1, 2, minObjSize, &ow);
-  /*
-  int nobj = Stack_Label_Large_Objects_N(
-        stackData, NULL, 1, 2, minObjSize, 26);
-        */
+  ZStackObjectLabeler labeler;
+  labeler.setConnectivity(26);
+  int nobj = labeler.labelLargeObjects(stackData, 1, 2, minObjSize);
+  labeler.clear();
   //int nobj = Stack_Label_Objects_N(stackData, NULL, 1, 2, 26);
   if (nobj == 0) {
     cout << "No object found in the image. No skeleton generated." << endl;
@@ -825,8 +834,10 @@ ZSwcTree* ZStackSkeletonizer::makeSkeletonWithoutDs(Stack *stackData)
 
 ZSwcTree* ZStackSkeletonizer::makeSkeleton(const Stack *stack)
 {
-  Stack *stackData = Downsample_Stack_Max(stack, m_downsampleInterval[0],
-      m_downsampleInterval[1], m_downsampleInterval[2], NULL);
+  ZStackResampler resampler;
+  Stack *stackData = resampler.downsample(
+        stack, m_downsampleInterval[0], m_downsampleInterval[1],
+        m_downsampleInterval[2], STACK_DOWNSAMPLE_MAX);
   return makeSkeletonWithoutDs(stackData);
 }
 
@@ -90,6 +90,17 @@ public:
   ZSwcTree* makeSkeleton(const ZStack &stack);
   ZSwcTree* makeSkeleton(const ZObject3dScan &obj);
 
+  /*!
+   * \brief Make a skeleton from a stack that is already downsampled.
+   *
+   * \a stack is supposed to be downsampled with the downsampling interval of
+   * the skeletonizer by maximum, e.g. by reading it with
+   * ZStackFile::readStack(const ZIntPoint&, Stack_Downsample_Method_e), and
+   * its offset is in the downsampled space. The skeleton is in the original
+   * space, as makeSkeleton(const ZStack&) returns.
+   */
+  ZSwcTree* makeSkeletonFromDownsampled(const ZStack &stack);
+
   /*!
    * \brief Make a skeleton from an array of masks
    */
@@ -0,0 +1,126 @@
+#include "zstackslicepyramid.h"
+#include "c_stack.h"
+#include "tz_stack_lib.h"
+
+ZStackSlicePyramid::ZStackSlicePyramid() :
+  m_source(NULL), m_memoryLimit(128 * 1024 * 1024), m_memoryUsage(0)
+{
+  m_sourceInfo.kind = 0;
+  m_sourceInfo.width = 0;
+  m_sourceInfo.height = 0;
+  m_sourceInfo.depth = 0;
+  m_sourceInfo.nchannel = 0;
+  m_sourceInfo.array = NULL;
+}
+
+ZStackSlicePyramid::~ZStackSlicePyramid()
+{
+  clear();
+}
+
+void ZStackSlicePyramid::clear()
+{
+  for (std::map<TKey, Entry>::iterator iter = m_entryMap.begin();
+       iter != m_entryMap.end(); ++iter) {
+    std::vector<Stack*> &levelArray = iter->second.levelArray;
+    for (size_t i = 0; i < levelArray.size(); ++i) {
+      C_Stack::kill(levelArray[i]);
+    }
+  }
+
+  m_entryMap.clear();
+  m_lru.clear();
+  m_memoryUsage = 0;
+  m_source = NULL;
+}
+
+void ZStackSlicePyramid::setMemoryLimit(size_t limit)
+{
+  m_memoryLimit = limit;
+  evict();
+}
+
+size_t ZStackSlicePyramid::getMemoryLimit() const
+{
+  return m_memoryLimit;
+}
+
+size_t ZStackSlicePyramid::getMemoryUsage() const
+{
+  return m_memoryUsage;
+}
+
+int ZStackSlicePyramid::GetLevelSize(int size, int level)
+{
+  int scale = 1 << level;
+
+  return (size + scale - 1) / scale;
+}
+
+bool ZStackSlicePyramid::isSameSource(const Mc_Stack *stack) const
+{
+  return m_source == stack && m_sourceInfo.array == stack->array &&
+      m_sourceInfo.kind == stack->kind &&
+      m_sourceInfo.width == stack->width &&
+      m_sourceInfo.height == stack->height &&
+      m_sourceInfo.depth == stack->depth &&
+      m_sourceInfo.nchannel == stack->nchannel;
+}
+
+Stack ZStackSlicePyramid::getSlice(
+    const Mc_Stack *stack, int channel, int slice, int level)
+{
+  Stack levelSlice = C_Stack::sliceView(stack, slice, channel);
+  if (level <= 0) {
+    return levelSlice;
+  }
+
+  if (!isSameSource(stack)) {
+    clear();
+    m_source = stack;
+    m_sourceInfo = *stack;
+  }
+
+  TKey key(slice, channel);
+  std::map<TKey, Entry>::iterator iter = m_entryMap.find(key);
+  if (iter == m_entryMap.end()) {
+    m_lru.push_front(key);
+    iter = m_entryMap.insert(std::make_pair(key, Entry())).first;
+    iter->second.lruIter = m_lru.begin();
+  } else {
+    m_lru.splice(m_lru.begin(), m_lru, iter->second.lruIter);
+  }
+
+  std::vector<Stack*> &levelArray = iter->second.levelArray;
+  for (int k = (int) levelArray.size() + 1; k <= level; ++k) {
+    const Stack *source = (k == 1) ? &levelSlice : levelArray[k - 2];
+    Stack *out = C_Stack::make(
+          C_Stack::kind(source), GetLevelSize(C_Stack::width(&levelSlice), k),
+          GetLevelSize(C_Stack::height(&levelSlice), k), 1);
+    Downsample_Stack_Slab(source, 1, 1, 0, STACK_DOWNSAMPLE_MAX, 0, 0, out);
+    levelArray.push_back(out);
+    m_memoryUsage += C_Stack::voxelNumber(out) * C_Stack::kind(out);
+  }
+
+  levelSlice = *levelArray[level - 1];
+
+  //The requested slice is at the front and is never dropped here
+  evict();
+
+  return levelSlice;
+}
+
+void ZStackSlicePyramid::evict()
+{
+  while (m_memoryUsage > m_memoryLimit && m_lru.size() > 1) {
+    std::map<TKey, Entry>::iterator iter = m_entryMap.find(m_lru.back());
+    std::vector<Stack*> &levelArray = iter->second.levelArray;
+    for (size_t i = 0; i < levelArray.size(); ++i) {
+      m_memoryUsage -=
+          C_Stack::voxelNumber(levelArray[i]) * C_Stack::kind(levelArray[i]);
+      C_Stack::kill(levelArray[i]);
+    }
+    m_entryMap.erase(iter);
+    m_lru.pop_back();
+  }
+}
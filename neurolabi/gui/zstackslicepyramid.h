@@ -0,0 +1,76 @@
+#ifndef ZSTACKSLICEPYRAMID_H
+#define ZSTACKSLICEPYRAMID_H
+
+#include <map>
+#include <list>
+#include <vector>
+#include <utility>
+
+#include "tz_image_lib_defs.h"
+#include "tz_mc_stack.h"
+
+/*!
+ * \brief The class of caching downsampled slices of a stack
+ *
+ * Level k of a slice is the slice downsampled by 2^k along X and Y with the
+ * maximum of each block, which is how the other multiresolution canvases are
+ * downsampled. A level is computed from the level below it on the first
+ * request and kept with the slice, so zooming and panning on a slice only
+ * read the level matching the screen resolution. The least recently used
+ * slices are dropped when the cache exceeds its size limit.
+ */
+class ZStackSlicePyramid
+{
+public:
+  ZStackSlicePyramid();
+  ~ZStackSlicePyramid();
+
+  /*!
+   * \brief Get a slice at a resolution level.
+   *
+   * Level 0 is a view of the slice of \a stack. The returned stack has depth 1
+   * and its array belongs to \a stack or the pyramid. It stays valid until
+   * the next call, which may drop old slices.
+   *
+   * The cache is cleared automatically if \a stack is not the stack of the
+   * cached slices, but it has to be cleared explicitly after the stack is
+   * modified in place.
+   */
+  Stack getSlice(const Mc_Stack *stack, int channel, int slice, int level);
+
+  void clear();
+
+  /*!
+   * \brief Set the size limit (bytes) of the cache.
+   */
+  void setMemoryLimit(size_t limit);
+  size_t getMemoryLimit() const;
+  size_t getMemoryUsage() const;
+
+  /*!
+   * \brief Size of a dimension at a level.
+   */
+  static int GetLevelSize(int size, int level);
+
+private:
+  typedef std::pair<int, int> TKey; //(slice, channel)
+
+  struct Entry {
+    std::vector<Stack*> levelArray; //from level 1
+    std::list<TKey>::iterator lruIter;
+  };
+
+  bool isSameSource(const Mc_Stack *stack) const;
+  void evict();
+
+private:
+  const Mc_Stack *m_source;
+  Mc_Stack m_sourceInfo;
+
+  std::map<TKey, Entry> m_entryMap;
+  std::list<TKey> m_lru; //most recent first
+  size_t m_memoryLimit;
+  size_t m_memoryUsage;
+};
+
+#endif // ZSTACKSLICEPYRAMID_H
@@ -1,4 +1,6 @@
 #include <iostream>
+#include <cstring>
+#include <algorithm>
 #include <QElapsedTimer>
 
 #include "zstackview.h"
@@ -12,6 +14,7 @@
 #include "zslider.h"
 #include "zinteractivecontext.h"
 #include "zstack.hxx"
+#include "c_stack.h"
 #include "zstackdoc.h"
 #include "zclickablelabel.h"
 #include "tz_error.h"
@@ -36,6 +39,8 @@
 #include "zbenchtimer.h"
 #include "zstackobjectpainter.h"
 #include "dvid/zdvidlabelslice.h"
+#include "bigdata/zchunkedstack.h"
+#include "tz_stack_lib.h"
 
 #include <QtGui>
 #include <QtWidgets>
@@ -175,6 +180,7 @@ void ZStackView::init()
 
   //m_parent = parent;
   m_image = NULL;
+  m_imageCanvasLevel = 0;
   m_imageMask = NULL;
 //  m_objectCanvas = NULL;
   m_activeDecorationCanvas = NULL;
@@ -442,7 +448,7 @@ void ZStackView::updateChannelControl()
       m_zSpinBox->setVisible(true);
     }
 
-    if (!stack->isVirtual()) {
+    if (!stack->isVirtual() || stack->hasChunkedData()) {
       std::vector<ZVec3Parameter*>& channelColors = stack->channelColors();
       for (int i=0; i<stack->channelNumber(); ++i) {
         m_chVisibleState.push_back(new ZBoolParameter("", true, this));
@@ -611,6 +617,11 @@ void ZStackView::updateImageScreen(EUpdateOption option)
 #endif
 
   if (option != UPDATE_NONE) {
+    //Panning or zooming moves the view out of the stack canvas
+    if (isImageCanvasOutdated()) {
+      paintStackBuffer();
+    }
+
     updatePaintBundle();
 
     bool blockingPaint = m_isRedrawBlocked || !buddyDocument()->isReadyForPaint();
@@ -774,6 +785,9 @@ void ZStackView::mouseRolledInImageWidget(QWheelEvent *event)
 void ZStackView::resizeEvent(QResizeEvent *event)
 {
   setInfo();
+  if (isImageCanvasOutdated()) {
+    paintStackBuffer();
+  }
   event->accept();
 }
 
@@ -927,15 +941,15 @@ void ZStackView::paintSingleChannelStackSlice(ZStack *stack, int slice)
   switch (m_sliceAxis) {
   case NeuTube::Z_AXIS:
   {
-    void *dataArray = stack->getDataPointer(0, slice);
+    const void *dataArray = getImageCanvasData(stack, 0, slice);
 
     switch (stack->kind()) {
     case GREY:
       if (stack->isBinary()) {
-        m_image->setBinaryData(static_cast<uint8_t*>(dataArray),
+        m_image->setBinaryData(static_cast<const uint8_t*>(dataArray),
                                (uint8_t) (stack->min()), getIntensityThreshold());
       } else {
-        ZImage::DataSource<uint8_t> stackData(static_cast<uint8_t*>(dataArray),
+        ZImage::DataSource<uint8_t> stackData(static_cast<const uint8_t*>(dataArray),
                                               buddyPresenter()->greyScale(0),
                                               buddyPresenter()->greyOffset(0),
                                               stack->getChannelColor(0));
@@ -945,10 +959,10 @@ void ZStackView::paintSingleChannelStackSlice(ZStack *stack, int slice)
       break;
     case GREY16:
       if (stack->isBinary()) {
-        m_image->setBinaryData(static_cast<uint16_t*>(dataArray),
+        m_image->setBinaryData(static_cast<const uint16_t*>(dataArray),
                                (uint16) (stack->min()), getIntensityThreshold());
       } else {
-        ZImage::DataSource<uint16_t> stackData(static_cast<uint16_t*>(dataArray),
+        ZImage::DataSource<uint16_t> stackData(static_cast<const uint16_t*>(dataArray),
                                                buddyPresenter()->greyScale(0),
                                                buddyPresenter()->greyOffset(0),
                                                stack->getChannelColor(0));
@@ -979,7 +993,7 @@ void ZStackView::paintMultipleChannelStackSlice(ZStack *stack, int slice)
 {
   bool usingMt = false;
 
-  if (stack->width() * stack->height() > MULTI_THREAD_VIEW_SIZE_THRESHOLD) {
+  if (m_image->width() * m_image->height() > MULTI_THREAD_VIEW_SIZE_THRESHOLD) {
     usingMt = true;
   }
 
@@ -990,7 +1004,8 @@ void ZStackView::paintMultipleChannelStackSlice(ZStack *stack, int slice)
       if (m_chVisibleState[i]->get()) {
         stackData8.push_back(
               ZImage::DataSource<uint8_t>(
-                static_cast<uint8_t*>(stack->getDataPointer(i, slice)),
+                static_cast<const uint8_t*>(
+                  getImageCanvasData(stack, i, slice)),
                 buddyPresenter()->greyScale(i),
                 buddyPresenter()->greyOffset(i),
                 stack->getChannelColor(i)));
@@ -1008,7 +1023,8 @@ void ZStackView::paintMultipleChannelStackSlice(ZStack *stack, int slice)
       if (m_chVisibleState[i]->get()) {
         stackData16.push_back(
               ZImage::DataSource<uint16_t>(
-                static_cast<uint16_t*>(stack->getDataPointer(i, slice)),
+                static_cast<const uint16_t*>(
+                  getImageCanvasData(stack, i, slice)),
                 buddyPresenter()->greyScale(i),
                 buddyPresenter()->greyOffset(i),
                 stack->getChannelColor(i)));
@@ -1027,6 +1043,10 @@ void ZStackView::paintSingleChannelStackMip(ZStack *stack)
   Image_Array ima;
   ima.array = (uint8*) stack->projection(
         buddyDocument()->getStackBackground(), ZSingleChannelStack::Z_AXIS);
+  //A chunked stack has no projection if its chunks cannot be read
+  if (ima.array == NULL) {
+    return;
+  }
 
   switch (stack->kind()) {
   case GREY:
@@ -1071,6 +1091,9 @@ void ZStackView::paintMultipleChannelStackMip(ZStack *stack)
         Image_Array ima;
         ima.array8 = (uint8*) stack->projection(
               buddyDocument()->getStackBackground(), ZSingleChannelStack::Z_AXIS, i);
+        if (ima.array8 == NULL) {
+          return;
+        }
         stackData8.push_back(
               ZImage::DataSource<uint8_t>(ima.array8,
                                           buddyPresenter()->greyScale(i),
@@ -1088,6 +1111,9 @@ void ZStackView::paintMultipleChannelStackMip(ZStack *stack)
         Image_Array ima;
         ima.array16 = (uint16*) stack->projection(
               buddyDocument()->getStackBackground(), ZSingleChannelStack::Z_AXIS, i);
+        if (ima.array16 == NULL) {
+          return;
+        }
         stackData16.push_back(ZImage::DataSource<uint16_t>(ima.array16,
                                                            buddyPresenter()->greyScale(i),
                                                            buddyPresenter()->greyOffset(i),
@@ -1105,6 +1131,8 @@ void ZStackView::clearCanvas()
   m_imagePainter.end();
   delete m_image;
   m_image = NULL;
+  m_imageCanvasRect = QRect();
+  m_imageCanvasLevel = 0;
 
   m_imageWidget->setImage(NULL);
 }
@@ -1130,30 +1158,192 @@ void ZStackView::resetCanvasWithStack(T &canvas, ZPainter *painter)
   }
 }
 
+bool ZStackView::isViewportCanvasEnabled() const
+{
+  if (m_sliceAxis != NeuTube::Z_AXIS || buddyPresenter() == NULL) {
+    return false;
+  }
+
+  if (buddyPresenter()->interactiveContext().isProjectView()) {
+    return false;
+  }
+
+  ZStack *stack = stackData();
+  if (stack == NULL || (stack->isVirtual() && !stack->hasChunkedData())) {
+    return false;
+  }
+
+  for (size_t i = 0; i < m_chVisibleState.size(); ++i) {
+    if (m_chVisibleState[i]->get()) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+QRect ZStackView::getImageCanvasRect(int *level) const
+{
+  *level = 0;
+
+  if (!isViewportCanvasEnabled()) {
+    return QRect();
+  }
+
+  ZIntCuboid box = getViewBoundBox();
+  QRect viewPort = m_imageWidget->viewPort().translated(
+        -box.getFirstCorner().getX(), -box.getFirstCorner().getY());
+  viewPort = viewPort.intersected(QRect(0, 0, box.getWidth(), box.getHeight()));
+  if (viewPort.isEmpty() || m_imageWidget->projectSize().isEmpty()) {
+    return QRect();
+  }
+
+  //Use the coarsest level that still has a pixel for each screen pixel
+  double zoomRatio = getProjZoomRatio();
+  int maxSize = std::max(box.getWidth(), box.getHeight());
+  while ((2 << *level) <= maxSize && zoomRatio * (2 << *level) <= 1.0) {
+    ++(*level);
+  }
+
+  int scale = 1 << *level;
+
+  return QRect(QPoint(viewPort.left() / scale, viewPort.top() / scale),
+               QPoint(viewPort.right() / scale, viewPort.bottom() / scale));
+}
+
+bool ZStackView::isImageCanvasOutdated() const
+{
+  if (m_image == NULL) {
+    return false;
+  }
+
+  int level = 0;
+  QRect rect = getImageCanvasRect(&level);
+
+  return (rect != m_imageCanvasRect) || (level != m_imageCanvasLevel);
+}
+
+const void* ZStackView::getImageCanvasData(
+    ZStack *stack, int channel, int slice)
+{
+  if (stack->hasChunkedData()) {
+    return getChunkedImageCanvasData(stack, channel, slice);
+  }
+
+  if (m_imageCanvasRect.isEmpty()) {
+    return stack->getDataPointer(channel, slice);
+  }
+
+  Stack levelSlice = m_slicePyramid.getSlice(
+        stack->data(), channel, slice, m_imageCanvasLevel);
+  size_t byteNumber = C_Stack::kind(&levelSlice);
+  size_t rowByteNumber = byteNumber * C_Stack::width(&levelSlice);
+  const uint8_t *data = levelSlice.array +
+      rowByteNumber * m_imageCanvasRect.top() +
+      byteNumber * m_imageCanvasRect.left();
+
+  //Slices in the pyramid may be dropped by the request of another channel
+  if (m_imageCanvasLevel == 0 &&
+      m_imageCanvasRect.width() == C_Stack::width(&levelSlice)) {
+    return data;
+  }
+
+  if ((int) m_imageCanvasBuffer.size() <= channel) {
+    m_imageCanvasBuffer.resize(channel + 1);
+  }
+  std::vector<uint8_t> &buffer = m_imageCanvasBuffer[channel];
+  size_t canvasRowByteNumber = byteNumber * m_imageCanvasRect.width();
+  buffer.resize(canvasRowByteNumber * m_imageCanvasRect.height());
+  for (int y = 0; y < m_imageCanvasRect.height(); ++y) {
+    memcpy(&(buffer[0]) + canvasRowByteNumber * y, data, canvasRowByteNumber);
+    data += rowByteNumber;
+  }
+
+  return &(buffer[0]);
+}
+
+const void* ZStackView::getChunkedImageCanvasData(
+    ZStack *stack, int channel, int slice)
+{
+  QRect rect = m_imageCanvasRect;
+  if (rect.isEmpty()) {
+    rect = QRect(0, 0, stack->width(), stack->height());
+  }
+
+  if ((int) m_imageCanvasBuffer.size() <= channel) {
+    m_imageCanvasBuffer.resize(channel + 1);
+  }
+  std::vector<uint8_t> &buffer = m_imageCanvasBuffer[channel];
+  buffer.resize((size_t) stack->kind() * rect.width() * rect.height());
+
+  Stack canvas;
+  C_Stack::setAttribute(&canvas, stack->kind(), rect.width(), rect.height(), 1);
+  canvas.array = &(buffer[0]);
+  canvas.text = NULL;
+
+  int scale = 1 << m_imageCanvasLevel;
+  const ZIntPoint &offset = stack->getOffset();
+  ZIntCuboid box;
+  box.setFirstCorner(offset.getX() + rect.left() * scale,
+                     offset.getY() + rect.top() * scale,
+                     offset.getZ() + slice);
+  box.setSize(rect.width() * scale, rect.height() * scale, 1);
+
+  ZChunkedStack *chunkedStack = stack->getChunkedData();
+  if (scale == 1) {
+    chunkedStack->readBlock(box, channel, &canvas);
+  } else {
+    Stack *block = chunkedStack->readBlock(box, channel);
+    Downsample_Stack_Slab(block, scale - 1, scale - 1, 0, STACK_DOWNSAMPLE_MAX,
+                          0, 0, &canvas);
+    C_Stack::kill(block);
+  }
+
+  return &(buffer[0]);
+}
+
+void ZStackView::clearSlicePyramid()
+{
+  m_slicePyramid.clear();
+}
+
 void ZStackView::updateImageCanvas()
 {
-  resetCanvasWithStack(m_image, &m_imagePainter);
-  if (buddyDocument()->hasStackPaint()) {
-    ZIntCuboid box = getViewBoundBox();
-    if (m_image != NULL) {
-      m_image->setOffset(-box.getFirstCorner().getX(),
-                         -box.getFirstCorner().getY());
-      if ((m_image->width() != box.getWidth()) ||
-          (m_image->height() != box.getHeight())) {
-        clearCanvas();
-      }
+  ZIntCuboid box = getViewBoundBox();
+  int level = 0;
+  QRect rect = getImageCanvasRect(&level);
+  double scale = 1.0 / (1 << level);
+  double tx = -box.getFirstCorner().getX() * scale;
+  double ty = -box.getFirstCorner().getY() * scale;
+  int width = box.getWidth();
+  int height = box.getHeight();
+  if (!rect.isEmpty()) {
+    tx -= rect.left();
+    ty -= rect.top();
+    width = rect.width();
+    height = rect.height();
+  }
+
+  if (m_image != NULL) {
+    const ZStTransform &transform = m_image->getTransform();
+    if (m_image->width() != width || m_image->height() != height ||
+        transform.getSx() != scale || transform.getTx() != tx ||
+        transform.getTy() != ty) {
+      clearCanvas();
     }
+  }
 
+  if (buddyDocument()->hasStackPaint()) {
     if (m_image == NULL) {
-//      double scale = 0.5;
-      m_image = new ZImage(box.getWidth(), box.getHeight());
-      m_image->setOffset(-box.getFirstCorner().getX(),
-                         -box.getFirstCorner().getY());
-//      m_image->setScale(scale, scale);
+      m_image = new ZImage(width, height);
+      m_image->setScale(scale, scale);
+      m_image->setOffset(tx, ty);
       m_imagePainter.begin(m_image);
       m_imagePainter.setZOffset(box.getFirstCorner().getZ());
       m_imageWidget->setImage(m_image);
     }
+    m_imageCanvasRect = rect;
+    m_imageCanvasLevel = level;
   }
 }
 
@@ -1165,15 +1355,16 @@ void ZStackView::updateMaskCanvas()
     return;
   }
 
+  //The mask covers the whole plane even if the stack canvas does not
+  QSize canvasSize = getCanvasSize();
   if (m_imageMask != NULL) {
-    if (m_imageMask->width() != m_image->width() ||
-        m_imageMask->height() != m_image->height()) {
+    if (m_imageMask->size() != canvasSize) {
       delete m_imageMask;
       m_imageMask = NULL;
     }
   }
   if (m_imageMask == NULL) {
-    m_imageMask = m_image->createMask();
+    m_imageMask = ZImage::createMask(canvasSize);
     m_imageWidget->setMask(m_imageMask, 0);
   }
 }
@@ -1417,7 +1608,9 @@ void ZStackView::paintStackBuffer()
 
   if (buddyPresenter() != NULL) {
     if (!buddyPresenter()->interactiveContext().isProjectView()) {
-      if (!stack->isVirtual() && showImage) {
+      if ((!stack->isVirtual() ||
+           (stack->hasChunkedData() && m_sliceAxis == NeuTube::Z_AXIS)) &&
+          showImage) {
         if (stack->channelNumber() == 1) {   //grey
           paintSingleChannelStackSlice(stack, m_depthControl->value());
         } else { // multi channel image
@@ -1441,7 +1634,7 @@ void ZStackView::paintStackBuffer()
       //m_scrollEnabled = true;
     } else if (buddyPresenter()->interactiveContext().isProjectView()) {
       //m_scrollEnabled = false;
-      if (!stack->isVirtual() && showImage) {
+      if ((!stack->isVirtual() || stack->hasChunkedData()) && showImage) {
         if (stack->channelNumber() == 1) {
           paintSingleChannelStackMip(stack);
         } else {    // for color image
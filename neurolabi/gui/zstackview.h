@@ -20,6 +20,7 @@
 #include "zmessageprocessor.h"
 #include "zpainter.h"
 #include "zmultiscalepixmap.h"
+#include "zstackslicepyramid.h"
 
 class ZStackDoc;
 class ZStackPresenter;
@@ -217,6 +218,12 @@ public slots:
   void paintObject(const QSet<ZStackObject::ETarget> &targetSet);
   void dump(const QString &msg);
   void hideThresholdControl();
+  /*!
+   * \brief Drop the downsampled slices of the stack.
+   *
+   * It must be called after the stack is modified in place.
+   */
+  void clearSlicePyramid();
 signals:
   void viewChanged(ZStackViewParam param);
   void messageGenerated(const ZWidgetMessage &message);
@@ -276,6 +283,41 @@ protected:
   bool reloadObjectCanvas(bool repaint = false);
   void reloadCanvas();
   virtual void updateImageCanvas();
+  /*!
+   * \brief Check if the stack canvas only covers the visible region.
+   *
+   * Z slices of a regular or chunked stack are rendered for the viewport at
+   * about the screen resolution. Projections, sparse stacks and X/Y slices still use a
+   * canvas of the whole plane.
+   */
+  virtual bool isViewportCanvasEnabled() const;
+  /*!
+   * \brief Get the region of the stack canvas.
+   *
+   * The region is in the pixel grid of the slice downsampled by 2^\a level,
+   * with (0, 0) at the first corner of the view bound box.
+   */
+  QRect getImageCanvasRect(int *level) const;
+  /*!
+   * \brief Check if the stack canvas no longer matches the view.
+   */
+  bool isImageCanvasOutdated() const;
+  /*!
+   * \brief Get slice data aligned with the stack canvas.
+   *
+   * The returned array has the size of the canvas. It points to the stack or
+   * the slice pyramid if the canvas rows are contiguous there, or to a buffer
+   * of the view otherwise.
+   */
+  const void* getImageCanvasData(ZStack *stack, int channel, int slice);
+  /*!
+   * \brief Read the canvas region of a slice from a chunked stack.
+   *
+   * Only the chunks overlapping the canvas are read. The region is downsampled
+   * in the same way as the slice pyramid.
+   */
+  const void* getChunkedImageCanvasData(
+      ZStack *stack, int channel, int slice);
   void updateMaskCanvas();
   void clearObjectCanvas();
   void clearTileCanvas();
@@ -303,6 +345,10 @@ protected:
   QLabel *m_activeLabel;
   ZImage *m_image;
   ZPainter m_imagePainter;
+  QRect m_imageCanvasRect;
+  int m_imageCanvasLevel;
+  ZStackSlicePyramid m_slicePyramid;
+  std::vector<std::vector<uint8_t> > m_imageCanvasBuffer;
   ZImage *m_imageMask;
   ZMultiscalePixmap m_objectCanvas;
   ZPainter m_objectCanvasPainter;
@@ -1,9 +1,332 @@
 #include "zstackwatershed.h"
+#include <algorithm>
+#include <climits>
+#if defined(_QT_GUI_USED_)
+#include <QAtomicInt>
+#include <QFuture>
+#include <QThread>
+#include <QtConcurrentRun>
+#endif
 #include "neutubeconfig.h"
 #include "tz_cuboid_i.h"
 #include "tz_math.h"
+#include "tz_stack_neighborhood.h"
 #include "zstack.hxx"
 
+namespace {
+
+const int WATERSHED_CONN = 26;
+
+//Layers smaller than this are flooded in the calling thread
+const size_t MIN_THREAD_LAYER_SIZE = 4096;
+
+//Claim keys of a batch must fit in an integer
+const size_t MAX_BATCH_SIZE = INT_MAX / WATERSHED_CONN - 1;
+
+const int NO_OWNER = INT_MAX;
+
+#if defined(_QT_GUI_USED_)
+typedef QAtomicInt FloodOwner;
+
+inline int GetOwner(const FloodOwner &owner)
+{
+  return owner.loadAcquire();
+}
+
+inline void SetOwner(FloodOwner &owner, int key)
+{
+  owner.storeRelease(key);
+}
+
+//The smallest key wins
+inline void ClaimOwner(FloodOwner &owner, int key)
+{
+  int current = owner.loadAcquire();
+  while (key < current) {
+    if (owner.testAndSetOrdered(current, key)) {
+      break;
+    }
+    current = owner.loadAcquire();
+  }
+}
+#else
+typedef int FloodOwner;
+
+inline int GetOwner(const FloodOwner &owner)
+{
+  return owner;
+}
+
+inline void SetOwner(FloodOwner &owner, int key)
+{
+  owner = key;
+}
+
+inline void ClaimOwner(FloodOwner &owner, int key)
+{
+  if (key < owner) {
+    owner = key;
+  }
+}
+#endif
+
+/*
+ * The queues of Stack_Watershed() are FIFO, so the voxels at the water
+ * level are processed in layers: the first layer is the queue when the level
+ * starts and each layer floods the next one. Processing a layer in parallel
+ * gives the same result if every voxel is taken by the first voxel in the
+ * layer (and then the first neighbor index) that reaches it, and the taken
+ * voxels are queued in that order.
+ */
+template <typename T>
+class WatershedFlooder
+{
+public:
+  WatershedFlooder(const Stack *level, const Stack *mask, int minLevel,
+                   int startLevel, Stack *out, std::vector<int> *order,
+                   std::vector<uint8_t> *parent) :
+    m_level((const T*) level->array), m_mask(mask->array), m_out(out->array),
+    m_width(C_Stack::width(level)), m_height(C_Stack::height(level)),
+    m_depth(C_Stack::depth(level)), m_minLevel(minLevel),
+    m_startLevel(startLevel), m_order(order), m_parent(parent),
+    m_threadNumber(1)
+  {
+#if defined(_QT_GUI_USED_)
+    m_threadNumber = std::max(1, QThread::idealThreadCount());
+#endif
+    Stack_Neighbor_Offset(WATERSHED_CONN, m_width, m_height, m_neighborOffset);
+  }
+
+  void run()
+  {
+    if (m_startLevel < m_minLevel) {
+      labelSeed();
+      return;
+    }
+
+    size_t voxelNumber = (size_t) m_width * m_height * m_depth;
+    m_link.resize(voxelNumber);
+    m_queueHead.assign(m_startLevel - m_minLevel + 1, -1);
+    m_queueTail.assign(m_startLevel - m_minLevel + 1, -1);
+    if (m_threadNumber > 1) {
+      m_owner = std::vector<FloodOwner>(voxelNumber, FloodOwner(NO_OWNER));
+    }
+
+    labelSeed();
+
+    std::vector<int> layer;
+    std::vector<int> nextLayer;
+    for (int waterLevel = m_startLevel; waterLevel >= m_minLevel;
+         --waterLevel) {
+      layer.clear();
+      int index = m_queueHead[waterLevel - m_minLevel];
+      while (index >= 0) {
+        layer.push_back(index);
+        index = m_link[index];
+      }
+
+      while (!layer.empty()) {
+        nextLayer.clear();
+        for (size_t first = 0; first < layer.size();
+             first += MAX_BATCH_SIZE) {
+          size_t last = std::min(layer.size(), first + MAX_BATCH_SIZE);
+          floodBatch(layer, first, last, waterLevel, &nextLayer);
+        }
+        if (m_order != NULL) {
+          m_order->insert(m_order->end(), layer.begin(), layer.end());
+        }
+        layer.swap(nextLayer);
+      }
+    }
+  }
+
+private:
+  int getLevel(int index) const {
+    return (int) m_level[index];
+  }
+
+  bool isFloodable(int index) const {
+    return (m_out[index] == 0) && (m_mask[index] == 0) &&
+        (getLevel(index) >= m_minLevel);
+  }
+
+  void enqueue(int level, int index)
+  {
+    m_link[index] = -1;
+    int &head = m_queueHead[level - m_minLevel];
+    int &tail = m_queueTail[level - m_minLevel];
+    if (head < 0) {
+      head = index;
+    } else {
+      m_link[tail] = index;
+    }
+    tail = index;
+  }
+
+  void labelSeed()
+  {
+    size_t voxelNumber = (size_t) m_width * m_height * m_depth;
+    for (size_t i = 0; i < voxelNumber; ++i) {
+      int seed = m_mask[i];
+      if (seed >= 1 && seed <= STACK_WATERSHED_MAX_SEED) {
+        m_out[i] = seed;
+        int level = getLevel(i);
+        //A seed below the minimal level is labeled but never flooded
+        if (level >= m_minLevel && m_startLevel >= m_minLevel) {
+          enqueue(std::min(level, m_startLevel), i);
+        }
+      }
+    }
+  }
+
+  //Queue a voxel taken from a layer at the water level
+  void push(int index, int waterLevel, std::vector<int> *nextLayer)
+  {
+    int level = getLevel(index);
+    if (level >= waterLevel) {
+      nextLayer->push_back(index);
+    } else {
+      enqueue(level, index);
+    }
+  }
+
+  void floodBatch(const std::vector<int> &layer, size_t first, size_t last,
+                  int waterLevel, std::vector<int> *nextLayer)
+  {
+    size_t chunkNumber = std::min(
+          (size_t) m_threadNumber, (last - first) / MIN_THREAD_LAYER_SIZE);
+    if (chunkNumber <= 1) {
+      int isInBound[26];
+      for (size_t i = first; i < last; ++i) {
+        int index = layer[i];
+        int nbound = Stack_Neighbor_Bound_Test_I(
+              WATERSHED_CONN, m_width, m_height, m_depth, index, isInBound);
+        for (int j = 0; j < WATERSHED_CONN; ++j) {
+          if (nbound == WATERSHED_CONN || isInBound[j]) {
+            int neighbor = index + m_neighborOffset[j];
+            if (isFloodable(neighbor)) {
+              m_out[neighbor] = m_out[index];
+              if (m_parent != NULL) {
+                (*m_parent)[neighbor] = j;
+              }
+              push(neighbor, waterLevel, nextLayer);
+            }
+          }
+        }
+      }
+      return;
+    }
+
+    std::vector<size_t> chunkStart(chunkNumber + 1);
+    for (size_t i = 0; i <= chunkNumber; ++i) {
+      chunkStart[i] = first + (last - first) * i / chunkNumber;
+    }
+    std::vector<std::vector<int> > taken(chunkNumber);
+
+#if defined(_QT_GUI_USED_)
+    std::vector<QFuture<void> > res(chunkNumber);
+    for (size_t i = 0; i < chunkNumber; ++i) {
+      res[i] = QtConcurrent::run(
+            this, &WatershedFlooder<T>::claim, &layer, first,
+            chunkStart[i], chunkStart[i + 1]);
+    }
+    for (size_t i = 0; i < chunkNumber; ++i) {
+      res[i].waitForFinished();
+    }
+    for (size_t i = 0; i < chunkNumber; ++i) {
+      res[i] = QtConcurrent::run(
+            this, &WatershedFlooder<T>::take, &layer, first,
+            chunkStart[i], chunkStart[i + 1], &(taken[i]));
+    }
+    for (size_t i = 0; i < chunkNumber; ++i) {
+      res[i].waitForFinished();
+    }
+#else
+    for (size_t i = 0; i < chunkNumber; ++i) {
+      claim(&layer, first, chunkStart[i], chunkStart[i + 1]);
+    }
+    for (size_t i = 0; i < chunkNumber; ++i) {
+      take(&layer, first, chunkStart[i], chunkStart[i + 1], &(taken[i]));
+    }
+#endif
+
+    for (size_t i = 0; i < chunkNumber; ++i) {
+      for (std::vector<int>::const_iterator iter = taken[i].begin();
+           iter != taken[i].end(); ++iter) {
+        SetOwner(m_owner[*iter], NO_OWNER);
+        push(*iter, waterLevel, nextLayer);
+      }
+    }
+  }
+
+  //Mark each reachable voxel with the smallest key of the voxels reaching it
+  void claim(const std::vector<int> *layer, size_t base, size_t first,
+             size_t last)
+  {
+    int isInBound[26];
+    for (size_t i = first; i < last; ++i) {
+      int index = (*layer)[i];
+      int nbound = Stack_Neighbor_Bound_Test_I(
+            WATERSHED_CONN, m_width, m_height, m_depth, index, isInBound);
+      int key = (i - base) * WATERSHED_CONN;
+      for (int j = 0; j < WATERSHED_CONN; ++j) {
+        if (nbound == WATERSHED_CONN || isInBound[j]) {
+          int neighbor = index + m_neighborOffset[j];
+          if (isFloodable(neighbor)) {
+            ClaimOwner(m_owner[neighbor], key + j);
+          }
+        }
+      }
+    }
+  }
+
+  //Label the voxels won by the voxels in [first, last) in the queue order
+  void take(const std::vector<int> *layer, size_t base, size_t first,
+            size_t last, std::vector<int> *taken)
+  {
+    int isInBound[26];
+    for (size_t i = first; i < last; ++i) {
+      int index = (*layer)[i];
+      int nbound = Stack_Neighbor_Bound_Test_I(
+            WATERSHED_CONN, m_width, m_height, m_depth, index, isInBound);
+      int key = (i - base) * WATERSHED_CONN;
+      for (int j = 0; j < WATERSHED_CONN; ++j) {
+        if (nbound == WATERSHED_CONN || isInBound[j]) {
+          int neighbor = index + m_neighborOffset[j];
+          if (GetOwner(m_owner[neighbor]) == key + j) {
+            m_out[neighbor] = m_out[index];
+            if (m_parent != NULL) {
+              (*m_parent)[neighbor] = j;
+            }
+            taken->push_back(neighbor);
+          }
+        }
+      }
+    }
+  }
+
+private:
+  const T *m_level;
+  const uint8_t *m_mask;
+  uint8_t *m_out;
+  int m_width;
+  int m_height;
+  int m_depth;
+  int m_minLevel;
+  int m_startLevel;
+  std::vector<int> *m_order;
+  std::vector<uint8_t> *m_parent;
+  int m_threadNumber;
+  int m_neighborOffset[26];
+
+  std::vector<int> m_link;
+  std::vector<int> m_queueHead;
+  std::vector<int> m_queueTail;
+  std::vector<FloodOwner> m_owner;
+};
+
+}
+
 
 ZStackWatershed::ZStackWatershed() : m_floodingZero(false)
 {
@@ -19,11 +342,6 @@ Stack_Watershed_Workspace* ZStackWatershed::createWorkspace(const Stack *stack)
 {
   Stack_Watershed_Workspace *ws = Make_Stack_Watershed_Workspace(stack);
   ws->conn =26;
-  if (C_Stack::kind(stack) == GREY) {
-    ws->start_level = 255;
-  } else {
-    ws->start_level = 65535;
-  }
   std::cout << "workspace mask size: " << C_Stack::width(stack) << "x"
             << C_Stack::height(stack) << "x" << C_Stack::depth(stack)
             << std::endl;
@@ -33,8 +351,7 @@ Stack_Watershed_Workspace* ZStackWatershed::createWorkspace(const Stack *stack)
   C_Stack::setZero(mask);
   size_t voxelNumber = C_Stack::voxelNumber(stack);
   for (size_t i = 0; i < voxelNumber; ++i) {
-    //Need modifcation to handle 16bit data
-    if (stack->array[i] == 0) {
+    if (C_Stack::value(stack, i) == 0.0) {
       mask->array[i] = STACK_WATERSHED_BARRIER;
     }
   }
@@ -126,7 +443,7 @@ ZStack *ZStackWatershed::run(
       Zero_Stack(out2);
       Stack *out = C_Stack::watershed(source, ws, out2);
 #else
-      Stack *out = Stack_Watershed(source, ws);
+      Stack *out = flood(source, ws);
 #endif
       std::cout << "Creating result ..." << std::endl;
       result = new ZStack;
@@ -146,6 +463,108 @@ ZStack *ZStackWatershed::run(
   return result;
 }
 
+Stack* ZStackWatershed::MakeLevelStack(
+    const Stack *source, int *minLevel, int *startLevel)
+{
+  switch (C_Stack::kind(source)) {
+  case GREY:
+    *minLevel = 0;
+    *startLevel = 255;
+    return const_cast<Stack*>(source);
+  case GREY16:
+    *minLevel = 0;
+    *startLevel = 65535;
+    return const_cast<Stack*>(source);
+  default:
+    break;
+  }
+
+  size_t voxelNumber = C_Stack::voxelNumber(source);
+  std::vector<int> levelArray;
+  for (size_t i = 0; i < voxelNumber; ++i) {
+    int level = (int) C_Stack::value(source, i);
+    if (level >= 0) {
+      levelArray.push_back(level);
+    }
+  }
+  std::sort(levelArray.begin(), levelArray.end());
+  levelArray.erase(std::unique(levelArray.begin(), levelArray.end()),
+                   levelArray.end());
+
+  //Rank 0 is below the minimal level
+  *minLevel = 1;
+  *startLevel = levelArray.size();
+
+  Stack *out = C_Stack::make(levelArray.size() < 65536 ? GREY16 : GREY32,
+                             C_Stack::width(source), C_Stack::height(source),
+                             C_Stack::depth(source));
+  for (size_t i = 0; i < voxelNumber; ++i) {
+    int level = (int) C_Stack::value(source, i);
+    uint32_t rank = 0;
+    if (level >= 0) {
+      rank = std::lower_bound(levelArray.begin(), levelArray.end(), level) -
+          levelArray.begin() + 1;
+    }
+    if (C_Stack::kind(out) == GREY16) {
+      ((uint16_t*) out->array)[i] = rank;
+    } else {
+      ((uint32_t*) out->array)[i] = rank;
+    }
+  }
+
+  return out;
+}
+
+void ZStackWatershed::Flood(
+    const Stack *level, const Stack *mask, int minLevel, int startLevel,
+    Stack *out, std::vector<int> *order, std::vector<uint8_t> *parent)
+{
+  switch (C_Stack::kind(level)) {
+  case GREY:
+  {
+    WatershedFlooder<uint8_t> flooder(
+          level, mask, minLevel, startLevel, out, order, parent);
+    flooder.run();
+  }
+    break;
+  case GREY16:
+  {
+    WatershedFlooder<uint16_t> flooder(
+          level, mask, minLevel, startLevel, out, order, parent);
+    flooder.run();
+  }
+    break;
+  case GREY32:
+  {
+    WatershedFlooder<uint32_t> flooder(
+          level, mask, minLevel, startLevel, out, order, parent);
+    flooder.run();
+  }
+    break;
+  default:
+    break;
+  }
+}
+
+Stack* ZStackWatershed::flood(
+    const Stack *source, Stack_Watershed_Workspace *ws) const
+{
+  int minLevel = 0;
+  int startLevel = 0;
+  Stack *level = MakeLevelStack(source, &minLevel, &startLevel);
+
+  Stack *out = C_Stack::make(GREY, C_Stack::width(source),
+                             C_Stack::height(source), C_Stack::depth(source));
+  C_Stack::setZero(out);
+  Flood(level, ws->mask, minLevel, startLevel, out);
+
+  if (level != source) {
+    C_Stack::kill(level);
+  }
+
+  return out;
+}
+
 #if 0
 ZStack* ZStackWatershed::run(const Stack *stack,
                              const std::vector<ZStack *> &seedMask)
@@ -2,6 +2,7 @@
 #define ZSTACKWATERSHED_H
 
 #include <vector>
+#include <stdint.h>
 
 #include "tz_stack_watershed.h"
 #include "tz_cuboid_i.h"
@@ -35,8 +36,47 @@ public:
     m_floodingZero = status;
   }
 
+  /*!
+   * \brief Flood the seeds of \a mask.
+   *
+   * The result is the same as Stack_Watershed() with 26-connectivity and the
+   * levels from \a minLevel to \a startLevel. \a level is a GREY, GREY16 or
+   * GREY32 stack of levels, and a GREY32 level is an unsigned integer. \a out
+   * must be zeroed. The voxels at the same level are flooded layer by layer,
+   * and a large layer is split among threads. A voxel reached by several
+   * threads is taken by the first one in the queue order, so the result does
+   * not depend on the number of threads.
+   *
+   * \param order Voxels in the order of flooding if it is not NULL.
+   * \param parent The neighbor index of the voxel that floods each voxel if
+   *        it is not NULL. The elements of seeds and unflooded voxels are not
+   *        changed.
+   */
+  static void Flood(const Stack *level, const Stack *mask, int minLevel,
+                    int startLevel, Stack *out, std::vector<int> *order = NULL,
+                    std::vector<uint8_t> *parent = NULL);
+
 private:
   Stack_Watershed_Workspace* createWorkspace(const Stack *stack);
+
+  /*!
+   * \brief Compute the watershed of \a source in parallel.
+   *
+   * The result is identical to Stack_Watershed().
+   */
+  Stack* flood(const Stack *source, Stack_Watershed_Workspace *ws) const;
+
+  /*!
+   * \brief Make the level stack of \a source for Flood().
+   *
+   * 8-bit and 16-bit stacks are used directly. Other stacks are truncated to
+   * integers and replaced by their ranks among the distinct non-negative
+   * levels, so the number of levels never exceeds the number of voxels.
+   *
+   * \return \a source itself or a new stack.
+   */
+  static Stack* MakeLevelStack(const Stack *source, int *minLevel,
+                               int *startLevel);
   void addSeed(Stack_Watershed_Workspace *ws, const ZIntPoint &offset,
                const std::vector<ZStack*> &seedMask);
 
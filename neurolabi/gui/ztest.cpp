@@ -92,20 +92,28 @@ using namespace std;
 #include "swctreenode.h"
 #include "test/z3dgraphtest.h"
 #include "test/zblockgridtest.h"
+#include "test/zchunkedstacktest.h"
+#include "test/zhdf5test.h"
+#include "test/zlabelmaptest.h"
 #include "test/zcuboidtest.h"
 #include "test/zdocplayertest.h"
 #include "test/zdvidtest.h"
+#include "test/zdvidmockserver.h"
 #include "test/zellipsoidtest.h"
 #include "test/zflyemneuronfiltertest.h"
 #include "test/zflyemneuronimagefactorytest.h"
 #include "test/zflyemneuronmatchtest.h"
+#include "test/zflyemneuronmodelcachetest.h"
 #include "test/zflyemneuronrangetest.h"
 #include "test/zflyemqualitycontroltest.h"
 #include "test/zflyemsynaseannotationtest.h"
+#include "test/zsynapsestoretest.h"
 #include "test/zgraphtest.h"
 #include "test/zhistogramtest.h"
 #include "test/zimagetest.h"
+#include "test/zincrementalwatershedtest.h"
 #include "test/zjsontest.h"
+#include "test/zjsonstreamreadertest.h"
 #include "test/zmatrixtest.h"
 #include "test/zobject3dfactorytest.h"
 #include "test/zobject3dscantest.h"
@@ -116,7 +124,12 @@ using namespace std;
 #include "test/zspgrowtest.h"
 #include "test/zstackdoctest.h"
 #include "test/zstackgraphtest.h"
+#include "test/zstackobjectlabelertest.h"
+#include "test/zstackresamplertest.h"
+#include "test/zstackslicepyramidtest.h"
+#include "test/zstackpathfindertest.h"
 #include "test/zstacktest.h"
+#include "test/zstackwatershedtest.h"
 #include "test/zstitchgridtest.h"
 #include "test/zstringtest.h"
 #include "test/zsttransformtest.h"
@@ -249,6 +262,7 @@ using namespace std;
 #include "test/zclosedcurvetest.h"
 #include "test/zdvidiotest.h"
 #include "test/zflyembodymergertest.h"
+#include "test/zflyemconnectivitymatrixtest.h"
 #include "test/zlinesegmenttest.h"
 #include "test/zstackobjectgrouptest.h"
 #include "tz_int_histogram.h"
@@ -17790,6 +17804,11 @@ void ZTest::test(MainWindow* host) {
   for (int z = 0; z < 10000; ++z) {
     std::cout << ">>>>>> z = " << z << std::endl;
     ensemble.update(tileIndices, 0, z);
+    while (ensemble.getFrameLatency() < 0) {
+      ZSleeper::msleep(1);
+    }
+    std::cout << "First paint: " << ensemble.getFirstPaintLatency() << "ms; "
+              << "frame: " << ensemble.getFrameLatency() << "ms" << std::endl;
   }
 #endif
 #if 0
@@ -18975,6 +18994,227 @@ void ZTest::test(MainWindow* host) {
 
   tree.save(GET_TEST_DATA_DIR + "/test.swc");
 #endif
+#if 0
+  //Benchmark of connected component labeling on real bodies
+  ZObject3dScan obj;
+  obj.load(GET_TEST_DATA_DIR + "/flyem/FIB/21784.sobj");
+  obj.canonize();
+  std::cout << obj.getVoxelNumber() << " voxels; "
+            << obj.getStripeNumber() << " stripes; "
+            << obj.getSegmentNumber() << " segments" << std::endl;
+
+  tic();
+  ZGraph *graph = obj.buildConnectionGraph();
+  std::cout << graph->getConnectedSubgraph().size() << " components" << std::endl;
+  delete graph;
+  std::cout << "Connection graph: ";
+  ptoc();
+
+  std::vector<size_t> labelArray;
+  tic();
+  std::cout << obj.labelConnectedSegment(&labelArray, false) << " components"
+            << std::endl;
+  std::cout << "Union-find: ";
+  ptoc();
+
+  tic();
+  std::cout << obj.labelConnectedSegment(&labelArray, true) << " components"
+            << std::endl;
+  std::cout << "Union-find (Z slabs): ";
+  ptoc();
+#endif
+#if 0
+  //Benchmark of synapse loading. The peak memory only grows, so run one
+  //method at a time.
+  std::string synapsePath =
+      GET_TEST_DATA_DIR + "/flyem/FIB/fib25_synapse_annotation.json";
+  bool streaming = true;
+
+  FlyEm::ZSynapseAnnotationArray synapseArray;
+  tic();
+  if (streaming) {
+    synapseArray.loadJsonStream(synapsePath);
+    std::cout << "Streaming: ";
+  } else {
+    ZJsonObject synapseJson;
+    synapseJson.load(synapsePath);
+    synapseArray.loadJson(synapseJson);
+    std::cout << "DOM: ";
+  }
+  ptoc();
+  std::cout << synapseArray.size() << " synapses" << std::endl;
+
+  std::ifstream statusStream("/proc/self/status");
+  std::string statusLine;
+  while (std::getline(statusStream, statusLine)) {
+    if (ZString(statusLine).startsWith("VmHWM")) {
+      std::cout << statusLine << std::endl;
+    }
+  }
+#endif
+#if 0
+  //Benchmark of body connection counting
+  FlyEm::ZSynapseAnnotationArray synapseArray;
+  synapseArray.loadJsonStream(
+        GET_TEST_DATA_DIR + "/flyem/FIB/fib25_synapse_annotation.json");
+
+  tic();
+  ZGraph *graph = synapseArray.getConnectionGraph();
+  std::cout << graph->getEdgeNumber() << " edges" << std::endl;
+  std::cout << "Connection graph: ";
+  ptoc();
+
+  tic();
+  ZFlyEmConnectivityMatrix matrix;
+  matrix.build(synapseArray);
+  std::cout << matrix.getNonzeroNumber() << " edges" << std::endl;
+  std::cout << "Connectivity matrix: ";
+  ptoc();
+
+  tic();
+  matrix.exportBinary(GET_TEST_DATA_DIR + "/test.bin");
+  std::cout << "Binary export: ";
+  ptoc();
+#endif
+#if 0
+  //Benchmark of the body pyramid against downsampling on demand
+  ZObject3dScan obj;
+  obj.load(GET_TEST_DATA_DIR + "/flyem/FIB/skeletonization/session19/"
+           "bodies/stacked/1.sobj");
+  std::cout << obj.getVoxelNumber() << " voxels" << std::endl;
+
+  tic();
+  for (int level = 1; level <= 4; ++level) {
+    int intv = (1 << level) - 1;
+    ZObject3dScan dsObj = obj;
+    dsObj.downsampleMax(intv, intv, intv);
+  }
+  std::cout << "Downsampling each level: ";
+  ptoc();
+
+  tic();
+  obj.getPyramidLevel(4);
+  std::cout << "Pyramid: ";
+  ptoc();
+
+  tic();
+  for (int i = 0; i < 10; ++i) {
+    ZObject3dScan dsObj = obj.getDownsampledMax(7, 7, 3);
+  }
+  std::cout << "Cached downsampling x10: ";
+  ptoc();
+#endif
+#if 0
+  //Benchmark of painting a body slice by slice
+  ZObject3dScan obj;
+  obj.load(GET_TEST_DATA_DIR + "/flyem/FIB/skeletonization/session19/"
+           "bodies/stacked/1.sobj");
+  obj.setColor(255, 0, 0);
+  ZIntCuboid box = obj.getBoundBox();
+
+  ZImage image(box.getWidth(), box.getHeight());
+  ZStTransform transform;
+  transform.setOffset(-box.getFirstCorner().getX(),
+                      -box.getFirstCorner().getY());
+  image.setTransform(transform);
+  ZPainter painter(&image);
+
+  ZObject3dScan::ResetPaintCounter();
+  tic();
+  for (int z = box.getFirstCorner().getZ(); z <= box.getLastCorner().getZ();
+       ++z) {
+    obj.display(painter, z, ZStackObject::SOLID, NeuTube::Z_AXIS);
+  }
+  std::cout << "Painting " << box.getDepth() << " slices: ";
+  ptoc();
+  std::cout << obj.getStripeNumber() << " stripes; "
+            << ZObject3dScan::GetVisitedStripeCount() << " visited; "
+            << ZObject3dScan::GetPaintedSegmentCount() << " segments painted"
+            << std::endl;
+#endif
+#if 0
+  //Benchmark of reading body annotations from a mock DVID server, which
+  //answers each request after 5 ms
+  ZDvidMockServer server;
+  server.setLatency(5);
+  server.setKeyNumber(1000);
+  ZDvidTarget target;
+  ZDvidReader reader;
+  reader.setVerbose(false);
+  if (server.startListening()) {
+    target.set("127.0.0.1", "3ca7", server.getPort());
+  }
+  if (reader.open(target)) {
+    QString dataName = ZDvidData::GetName(
+          ZDvidData::ROLE_BODY_ANNOTATION,
+          ZDvidData::ROLE_BODY_LABEL,
+          target.getBodyLabelName()).c_str();
+
+    tic();
+    QStringList keyList = reader.readKeys(dataName);
+    int count = 0;
+    foreach (const QString &key, keyList) {
+      if (!reader.readKeyValue(dataName, key).isEmpty()) {
+        ++count;
+      }
+    }
+    std::cout << count << " annotations read one by one: ";
+    ptoc();
+
+    tic();
+    std::vector<uint64_t> bodyIdArray;
+    foreach (const QString &key, keyList) {
+      bool ok = false;
+      uint64_t bodyId = key.toULongLong(&ok);
+      if (ok) {
+        bodyIdArray.push_back(bodyId);
+      }
+    }
+    std::cout << reader.readBodyAnnotations(bodyIdArray).size()
+              << " annotations read in batches: ";
+    ptoc();
+
+    tic();
+    std::cout << reader.readAllBodyAnnotations().size()
+              << " annotations read by key range: ";
+    ptoc();
+  }
+  std::cout << server.getConnectionCount() << " connections opened for "
+            << server.getRequestCount() << " requests" << std::endl;
+#endif
+#if 0
+  //Benchmark of slab-parallel resampling against the serial functions
+  Stack *stack = C_Stack::readSc(GET_TEST_DATA_DIR + "/benchmark/fork.tif");
+  ZStackResampler resampler;
+
+  tic();
+  Stack *ds = Downsample_Stack_Max(stack, 3, 3, 1, NULL);
+  std::cout << "Serial max downsampling: ";
+  ptoc();
+  C_Stack::kill(ds);
+
+  tic();
+  ds = resampler.downsample(stack, 3, 3, 1, STACK_DOWNSAMPLE_MAX);
+  std::cout << "Parallel max downsampling: ";
+  ptoc();
+  C_Stack::kill(ds);
+
+  tic();
+  Mc_Stack *mcDs = Read_Mc_Stack_Downsample(
+        (GET_TEST_DATA_DIR + "/benchmark/fork.tif").c_str(), 0, 3, 3, 1,
+        STACK_DOWNSAMPLE_MAX);
+  std::cout << "Downsampling while reading: ";
+  ptoc();
+  Kill_Mc_Stack(mcDs);
+
+  tic();
+  Stack *us = resampler.upsample(stack, 1, 1, 1);
+  std::cout << "Parallel upsampling: ";
+  ptoc();
+  C_Stack::kill(us);
+
+  C_Stack::kill(stack);
+#endif
 #if 1
   ZSwcExportSvgDialog* dlg = new ZSwcExportSvgDialog(host);
   dlg->exec();